@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <cairo.h>
+#include <math.h>
 
 #include "broadway-output.h"
 
@@ -14,27 +15,47 @@
  *                Basic I/O primitives                                  *
  ************************************************************************/
 
+/* The start of the buffer is kept free for the websocket frame header,
+ * so every message goes out with a single write. The socket has
+ * TCP_NODELAY set, so a separate write for the header would be sent
+ * as a packet of its own. */
+#define MAX_HEADER_SIZE 10
+
+/* With permessage-deflate, every message ends with the empty block of a
+ * sync flush, which is stripped before sending (RFC 7692, 7.2.1) */
+static const guchar deflate_trailer[] = { 0x00, 0x00, 0xff, 0xff };
+
 struct BroadwayOutput {
   GOutputStream *out;
   GString *buf;
   int error;
   guint32 serial;
+  guint64 bytes_written;
+
+  /* Set if the client negotiated permessage-deflate. The context is
+   * kept across messages. */
+  GConverter *compressor;
+  GString *compressed;
 };
 
-static void
-broadway_output_send_cmd (BroadwayOutput *output,
-                          gboolean fin, BroadwayWSOpCode code,
-                          const void *buf, gsize count)
+/* Writes the header for a message of @count bytes so it ends at @end,
+ * and returns its size */
+static gsize
+write_header (guchar             *end,
+              gboolean            fin,
+              gboolean            compressed,
+              BroadwayWSOpCode    code,
+              gsize               count)
 {
   gboolean mask = FALSE;
-  guchar header[16];
+  guchar header[MAX_HEADER_SIZE];
   size_t p;
 
   gboolean mid_header = count > 125 && count <= 65535;
   gboolean long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -48,10 +69,40 @@ broadway_output_send_cmd (BroadwayOutput *output,
       *(guint64 *)(header + p) = GUINT64_TO_BE( count );
       p += 8;
     }
+
+  memcpy (end - p, header, p);
+
+  return p;
+}
+
+static void
+broadway_output_write (BroadwayOutput *output,
+                       const guchar   *data,
+                       gsize           count)
+{
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+  if (!g_output_stream_write_all (output->out, data, count, NULL, NULL, NULL))
+    output->error = TRUE;
+
+  output->bytes_written += count;
+}
+
+static void
+broadway_output_send_cmd (BroadwayOutput *output,
+                          gboolean fin, BroadwayWSOpCode code,
+                          const void *buf, gsize count)
+{
+  guchar *data;
+  gsize header_size;
+
+  data = g_malloc (MAX_HEADER_SIZE + count);
+  header_size = write_header (data + MAX_HEADER_SIZE, fin, FALSE, code, count);
+  if (count > 0)
+    memcpy (data + MAX_HEADER_SIZE, buf, count);
+
+  broadway_output_write (output, data + MAX_HEADER_SIZE - header_size, header_size + count);
+
+  g_free (data);
 }
 
 void broadway_output_pong (BroadwayOutput *output)
@@ -59,21 +110,141 @@ void broadway_output_pong (BroadwayOutput *output)
   broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
 }
 
+/**
+ * broadway_convert_flush:
+ * @converter: a #GConverter
+ * @data: the data to convert
+ * @count: the size of @data
+ * @out: the string to append the result to
+ *
+ * Converts all of @data and flushes @converter, so the result
+ * can be decoded without any further input.
+ *
+ * Returns: %FALSE if @converter failed
+ **/
+gboolean
+broadway_convert_flush (GConverter   *converter,
+                        const guchar *data,
+                        gsize         count,
+                        GString      *out)
+{
+  GConverterResult res;
+  gsize bytes_read, bytes_written, old_len, space;
+  GError *error = NULL;
+
+  /* Like zlib itself, we know that everything got flushed once there is
+   * output space left over after the input ran out */
+  do
+    {
+      old_len = out->len;
+      space = MAX (count, 1024);
+      g_string_set_size (out, old_len + space);
+
+      res = g_converter_convert (converter,
+                                 data, count,
+                                 out->str + old_len, space,
+                                 G_CONVERTER_FLUSH,
+                                 &bytes_read, &bytes_written,
+                                 &error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          bytes_read = bytes_written = 0;
+          if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE) &&
+              !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT))
+            {
+              g_warning ("Failed to convert websocket message: %s", error->message);
+              g_error_free (error);
+              g_string_set_size (out, old_len);
+              return FALSE;
+            }
+          g_clear_error (&error);
+        }
+
+      g_string_set_size (out, old_len + bytes_written);
+      data += bytes_read;
+      count -= bytes_read;
+    }
+  while (res != G_CONVERTER_FLUSHED &&
+         (count > 0 || bytes_written == space));
+
+  return TRUE;
+}
+
 int
 broadway_output_flush (BroadwayOutput *output)
 {
-  if (output->buf->len == 0)
+  guchar *payload;
+  gsize count, header_size;
+  GString *buf;
+
+  if (output->buf->len == MAX_HEADER_SIZE)
     return TRUE;
 
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
-                            output->buf->str, output->buf->len);
+  buf = output->buf;
+
+  if (output->compressor)
+    {
+      g_string_set_size (output->compressed, MAX_HEADER_SIZE);
+      if (!broadway_convert_flush (output->compressor,
+                                   (guchar *) output->buf->str + MAX_HEADER_SIZE,
+                                   output->buf->len - MAX_HEADER_SIZE,
+                                   output->compressed))
+        {
+          output->error = TRUE;
+          g_string_set_size (output->buf, MAX_HEADER_SIZE);
+          return FALSE;
+        }
 
-  g_string_set_size (output->buf, 0);
+      buf = output->compressed;
+      if (buf->len >= MAX_HEADER_SIZE + sizeof (deflate_trailer) &&
+          memcmp (buf->str + buf->len - sizeof (deflate_trailer),
+                  deflate_trailer, sizeof (deflate_trailer)) == 0)
+        g_string_truncate (buf, buf->len - sizeof (deflate_trailer));
+    }
+
+  payload = (guchar *) buf->str + MAX_HEADER_SIZE;
+  count = buf->len - MAX_HEADER_SIZE;
+  header_size = write_header (payload, TRUE, output->compressor != NULL,
+                              BROADWAY_WS_BINARY, count);
+
+  broadway_output_write (output, payload - header_size, header_size + count);
+
+  g_string_set_size (output->buf, MAX_HEADER_SIZE);
 
   return !output->error;
 
 }
 
+/* Compresses all following messages with permessage-deflate */
+void
+broadway_output_enable_deflate (BroadwayOutput *output)
+{
+  g_return_if_fail (output->compressor == NULL);
+
+  output->compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1));
+  output->compressed = g_string_new (NULL);
+}
+
+/* Appends the messages queued in @source since its last flush to
+ * @output, so they can be sent to another client without encoding
+ * them again */
+void
+broadway_output_append_pending (BroadwayOutput *output,
+                                BroadwayOutput *source)
+{
+  g_string_append_len (output->buf,
+                       source->buf->str + MAX_HEADER_SIZE,
+                       source->buf->len - MAX_HEADER_SIZE);
+}
+
+/* The number of bytes sent to the client so far, including
+ * the websocket framing */
+guint64
+broadway_output_get_bytes_written (BroadwayOutput *output)
+{
+  return output->bytes_written;
+}
+
 BroadwayOutput *
 broadway_output_new (GOutputStream *out, guint32 serial)
 {
@@ -83,6 +254,7 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 
   output->out = g_object_ref (out);
   output->buf = g_string_new ("");
+  g_string_set_size (output->buf, MAX_HEADER_SIZE);
   output->serial = serial;
 
   return output;
@@ -92,6 +264,9 @@ void
 broadway_output_free (BroadwayOutput *output)
 {
   g_object_unref (output->out);
+  g_clear_object (&output->compressor);
+  if (output->compressed)
+    g_string_free (output->compressed, TRUE);
   free (output);
 }
 
@@ -169,6 +344,102 @@ patch_uint32 (BroadwayOutput *output, guint32 v, gsize offset)
   buf[3] = (v >> 24) & 0xff;
 }
 
+/* Node data is a stream of 32-bit words, most of which are small ids,
+ * types and counts, or coordinates that are multiples of a quarter
+ * pixel. Every word is sent with the shortest of these encodings that
+ * gives back the exact same bits, so the encoding does not need to know
+ * which words are floats:
+ *
+ *   0xxxxxxx                      values up to 127
+ *   10xxxxxx xxxxxxxx             values up to 16383
+ *   110xxxxx xxxxxxxx xxxxxxxx    floats that are a 21-bit signed
+ *                                 integer divided by 4
+ *   1110xxxx xxxxxxxx xxxxxxxx    values up to 2^20 - 1
+ *   11110000 + 4 bytes            anything else, little endian
+ *
+ * The x bits are most significant first. broadway.js expands the stream
+ * back to words before decoding the nodes. */
+#define MAX_FIXED (1 << 20)
+
+static gboolean
+word_to_fixed (guint32  word,
+               guint32 *fixed)
+{
+  union {
+    float f;
+    guint32 i;
+  } u;
+  float quarters;
+  int value;
+
+  u.i = word;
+  quarters = u.f * 4;
+  if (!(quarters >= -MAX_FIXED && quarters < MAX_FIXED) ||
+      quarters != floorf (quarters))
+    return FALSE;
+
+  value = quarters;
+  u.f = value / 4.0f;
+  if (u.i != word)
+    return FALSE; /* -0.0 */
+
+  *fixed = value & (2 * MAX_FIXED - 1);
+  return TRUE;
+}
+
+static void
+append_compact_word (BroadwayOutput *output, guint32 v)
+{
+  guint32 fixed;
+
+  if (v < (1 << 7))
+    append_uint8 (output, v);
+  else if (v < (1 << 14))
+    {
+      append_uint8 (output, 0x80 | (v >> 8));
+      append_uint8 (output, v & 0xff);
+    }
+  else if (word_to_fixed (v, &fixed))
+    {
+      append_uint8 (output, 0xc0 | (fixed >> 16));
+      append_uint8 (output, (fixed >> 8) & 0xff);
+      append_uint8 (output, fixed & 0xff);
+    }
+  else if (v < (1 << 20))
+    {
+      append_uint8 (output, 0xe0 | (v >> 16));
+      append_uint8 (output, (v >> 8) & 0xff);
+      append_uint8 (output, v & 0xff);
+    }
+  else
+    {
+      append_uint8 (output, 0xf0);
+      append_uint32 (output, v);
+    }
+}
+
+/* Replaces the words after @start with their compact encoding */
+static void
+compact_words (BroadwayOutput *output,
+               gsize           start)
+{
+  gsize i, n_words;
+  guint8 *words;
+
+  n_words = (output->buf->len - start) / 4;
+  words = g_memdup (output->buf->str + start, n_words * 4);
+  g_string_truncate (output->buf, start);
+
+  for (i = 0; i < n_words; i++)
+    {
+      const guint8 *w = words + i * 4;
+
+      append_compact_word (output, w[0] | (w[1] << 8) | (w[2] << 16) | ((guint32) w[3] << 24));
+    }
+
+  g_free (words);
+}
+
 
 static void
 write_header(BroadwayOutput *output, char op)
@@ -587,8 +858,10 @@ broadway_output_surface_set_nodes (BroadwayOutput *output,
 
   append_uint16 (output, id);
 
+  /* Number of words, and number of bytes they are encoded in */
   size_pos = output->buf->len;
   append_uint32 (output, 0);
+  append_uint32 (output, 0);
 
   start = output->buf->len;
 #ifdef DEBUG_NODE_SENDING
@@ -599,6 +872,9 @@ broadway_output_surface_set_nodes (BroadwayOutput *output,
     append_node_removes (output, old_root);
   end = output->buf->len;
   patch_uint32 (output, (end - start) / 4, size_pos);
+
+  compact_words (output, start);
+  patch_uint32 (output, output->buf->len - start, size_pos + 4);
 }
 
 void
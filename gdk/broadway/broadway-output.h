@@ -22,6 +22,14 @@ BroadwayOutput *broadway_output_new                 (GOutputStream  *out,
 void            broadway_output_free                (BroadwayOutput *output);
 int             broadway_output_flush               (BroadwayOutput *output);
 int             broadway_output_has_error           (BroadwayOutput *output);
+guint64         broadway_output_get_bytes_written   (BroadwayOutput *output);
+void            broadway_output_enable_deflate      (BroadwayOutput *output);
+void            broadway_output_append_pending      (BroadwayOutput *output,
+                                                     BroadwayOutput *source);
+gboolean        broadway_convert_flush              (GConverter     *converter,
+                                                     const guchar   *data,
+                                                     gsize           count,
+                                                     GString        *out);
 void            broadway_output_set_next_serial     (BroadwayOutput *output,
                                                      guint32         serial);
 guint32         broadway_output_get_next_serial     (BroadwayOutput *output);
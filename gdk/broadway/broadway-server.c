@@ -38,8 +38,16 @@
 typedef struct {
   int id;
   guint32 tag;
+  gint64 send_time;
 } BroadwayOutstandingRoundtrip;
 
+/* How often the statistics of the web client get logged, in µs */
+#define STATS_INTERVAL (10 * G_USEC_PER_SEC)
+
+/* How much data of textures that are not used anymore is kept in the
+ * web client, so they don't need to be sent again if they come back */
+#define MAX_UNUSED_TEXTURE_BYTES (16 * 1024 * 1024)
+
 typedef struct BroadwayInput BroadwayInput;
 typedef struct BroadwaySurface BroadwaySurface;
 struct _BroadwayServer {
@@ -55,6 +63,7 @@ struct _BroadwayServer {
   guint32 saved_serial;
   guint64 last_seen_time;
   BroadwayInput *input;
+  GList *viewers; /* BroadwayInput of read-only clients */
   GList *input_messages;
   guint process_input_idle;
 
@@ -66,6 +75,9 @@ struct _BroadwayServer {
 
   guint32 next_texture_id;
   GHashTable *textures;
+  GHashTable *texture_contents; /* GBytes => BroadwayTexture */
+  GQueue unused_textures; /* Least recently used first */
+  gsize unused_texture_bytes;
 
   guint32 screen_width;
   guint32 screen_height;
@@ -88,6 +100,13 @@ struct _BroadwayServer {
   int future_mouse_in_surface;
 
   GList *outstanding_roundtrips;
+
+  /* Statistics of the current web client since stats_start_time */
+  gint64 stats_start_time;
+  guint64 stats_start_bytes;
+  guint stats_n_roundtrips;
+  gint64 stats_total_latency;
+  gint64 stats_max_latency;
 };
 
 struct _BroadwayServerClass
@@ -112,6 +131,9 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  gboolean viewer; /* Only watches, its input is ignored */
+  GConverter *decompressor; /* Set if permessage-deflate was negotiated */
+  GString *decompressed;
 };
 
 struct BroadwaySurface {
@@ -133,10 +155,15 @@ struct _BroadwayTexture {
   grefcount refcount;
   guint32 id;
   GBytes *bytes;
+  GList unused_link; /* In unused_textures when nothing uses it */
 };
 
-static void broadway_server_resync_surfaces (BroadwayServer *server);
+static void broadway_server_resync_surfaces (BroadwayServer *server,
+                                             BroadwayOutput *output);
+static void broadway_server_drop_viewers (BroadwayServer *server);
 static void send_outstanding_roundtrips (BroadwayServer *server);
+static void broadway_server_update_stats (BroadwayServer *server,
+                                          gint64          latency);
 
 static void broadway_server_ref_texture (BroadwayServer   *server,
                                          guint32           id);
@@ -265,6 +292,7 @@ broadway_server_init (BroadwayServer *server)
   server->id_counter = 0;
   server->textures = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
                                             (GDestroyNotify)broadway_texture_free);
+  server->texture_contents = g_hash_table_new (g_bytes_hash, g_bytes_equal);
 
   root = g_new0 (BroadwaySurface, 1);
   root->id = server->id_counter++;
@@ -287,6 +315,7 @@ broadway_server_finalize (GObject *object)
   g_free (server->address);
   g_free (server->ssl_cert);
   g_free (server->ssl_key);
+  g_hash_table_destroy (server->texture_contents);
   g_hash_table_destroy (server->textures);
 
   G_OBJECT_CLASS (broadway_server_parent_class)->finalize (object);
@@ -336,9 +365,19 @@ broadway_input_free (BroadwayInput *input)
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
   g_source_destroy (input->source);
+  g_clear_object (&input->decompressor);
+  if (input->decompressed)
+    g_string_free (input->decompressed, TRUE);
   g_free (input);
 }
 
+static void
+broadway_viewer_free (BroadwayInput *viewer)
+{
+  broadway_output_free (viewer->output);
+  broadway_input_free (viewer);
+}
+
 static void
 update_event_state (BroadwayServer *server,
                     BroadwayInputMsg *message)
@@ -542,6 +581,8 @@ process_input_messages (BroadwayServer *server)
       process_input_message (server, message);
       g_free (message);
     }
+
+  broadway_events_flush ();
 }
 
 static void
@@ -607,7 +648,8 @@ queue_input_message (BroadwayServer *server, BroadwayInputMsg *msg)
   server->input_messages = g_list_append (server->input_messages, g_memdup (msg, sizeof (BroadwayInputMsg)));
 }
 
-static void
+/* Returns the size of the message */
+static gsize
 parse_input_message (BroadwayInput *input, const unsigned char *message)
 {
   BroadwayServer *server = input->server;
@@ -713,6 +755,8 @@ parse_input_message (BroadwayInput *input, const unsigned char *message)
       {
         BroadwayOutstandingRoundtrip *rt = l->data;
 
+        broadway_server_update_stats (server, g_get_monotonic_time () - rt->send_time);
+
         server->outstanding_roundtrips = g_list_delete_link (server->outstanding_roundtrips, l);
         g_free (rt);
       }
@@ -726,10 +770,29 @@ parse_input_message (BroadwayInput *input, const unsigned char *message)
 
   default:
     g_printerr ("parse_input_message - Unknown input command %c (%s)\n", msg.base.type, message);
-    break;
+    return 0;
   }
 
   queue_input_message (server, &msg);
+
+  return (const unsigned char *) p - message;
+}
+
+/* The web client sends the motion of an animation frame in one
+ * websocket message, so there can be more than one input message */
+static void
+parse_input_messages (BroadwayInput       *input,
+                      const unsigned char *data,
+                      gsize                len)
+{
+  gsize pos, size;
+
+  for (pos = 0; len - pos >= 3 * sizeof (guint32); pos += size)
+    {
+      size = parse_input_message (input, data + pos);
+      if (size == 0)
+        break;
+    }
 }
 
 static inline void
@@ -761,11 +824,12 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
-static void
+/* Returns %FALSE if a viewer closed the connection */
+static gboolean
 parse_input (BroadwayInput *input)
 {
   if (!input->buffer->len)
-    return;
+    return TRUE;
 
   hex_dump (input->buffer->data, input->buffer->len);
 
@@ -773,7 +837,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -784,6 +848,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -792,14 +857,14 @@ parse_input (BroadwayInput *input)
       if (payload_len == 126)
         {
           if (len < 4)
-            return;
+            return TRUE;
           payload_len = GUINT16_FROM_BE( *(guint16 *) data );
           data += 2;
         }
       else if (payload_len == 127)
         {
           if (len < 10)
-            return;
+            return TRUE;
           payload_len = GUINT64_FROM_BE( *(guint64 *) data );
           data += 8;
         }
@@ -808,13 +873,13 @@ parse_input (BroadwayInput *input)
       if (is_mask)
         {
           if (data - buf + 4 > len)
-            return;
+            return TRUE;
           mask = data;
           data += 4;
         }
 
       if (data - buf + payload_len > len)
-        return; /* wait to accumulate more */
+        return TRUE; /* wait to accumulate more */
 
       if (is_mask)
         {
@@ -825,17 +890,34 @@ parse_input (BroadwayInput *input)
 
       switch (code) {
       case BROADWAY_WS_CNX_CLOSE:
+        if (input->viewer)
+          return FALSE;
         break; /* hang around anyway */
       case BROADWAY_WS_BINARY:
-        if (!fin)
+        if (input->viewer)
+          {
+            /* Viewers only watch, drop their input */
+          }
+        else if (!fin)
           {
 #ifdef DEBUG_WEBSOCKETS
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed && input->decompressor)
+          {
+            /* The end of the sync flush was stripped, see RFC 7692, 7.2.2 */
+            static const guchar trailer[] = { 0x00, 0x00, 0xff, 0xff };
+
+            g_string_set_size (input->decompressed, 0);
+            if (broadway_convert_flush (input->decompressor, data, payload_len, input->decompressed) &&
+                broadway_convert_flush (input->decompressor, trailer, sizeof (trailer), input->decompressed))
+              parse_input_messages (input, (guchar *) input->decompressed->str,
+                                    input->decompressed->len);
+          }
         else
           {
-            parse_input_message (input, data);
+            parse_input_messages (input, data, payload_len);
           }
         break;
       case BROADWAY_WS_CNX_PING:
@@ -854,6 +936,8 @@ parse_input (BroadwayInput *input)
 
       g_byte_array_remove_range (input->buffer, 0, data - buf + payload_len);
     }
+
+  return TRUE;
 }
 
 
@@ -904,7 +988,13 @@ broadway_server_read_all_input_nonblocking (BroadwayInput *input)
 
           input->server->input = NULL;
         }
-      broadway_input_free (input);
+      if (input->viewer)
+        {
+          input->server->viewers = g_list_remove (input->server->viewers, input);
+          broadway_viewer_free (input);
+        }
+      else
+        broadway_input_free (input);
       if (res < 0)
         {
           g_printerr ("input error %s\n", error->message);
@@ -915,7 +1005,13 @@ broadway_server_read_all_input_nonblocking (BroadwayInput *input)
 
   g_byte_array_append (input->buffer, buffer, res);
 
-  parse_input (input);
+  if (!parse_input (input))
+    {
+      input->server->viewers = g_list_remove (input->server->viewers, input);
+      broadway_viewer_free (input);
+      return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -985,13 +1081,33 @@ broadway_server_fake_roundtrip_reply (BroadwayServer *server,
 void
 broadway_server_flush (BroadwayServer *server)
 {
-  if (server->output &&
-      !broadway_output_flush (server->output))
+  GList *l, *next;
+
+  if (server->output == NULL)
+    return;
+
+  /* The viewers get the same messages as the controlling client, they
+   * are only framed (and compressed) separately for each connection */
+  for (l = server->viewers; l != NULL; l = next)
+    {
+      BroadwayInput *viewer = l->data;
+
+      next = l->next;
+      broadway_output_append_pending (viewer->output, server->output);
+      if (!broadway_output_flush (viewer->output))
+        {
+          server->viewers = g_list_delete_link (server->viewers, l);
+          broadway_viewer_free (viewer);
+        }
+    }
+
+  if (!broadway_output_flush (server->output))
     {
       server->saved_serial = broadway_output_get_next_serial (server->output);
       broadway_output_free (server->output);
       server->output = NULL;
       send_outstanding_roundtrips (server);
+      broadway_server_drop_viewers (server);
     }
 }
 
@@ -1005,6 +1121,7 @@ broadway_server_roundtrip (BroadwayServer *server,
       BroadwayOutstandingRoundtrip *rt = g_new0 (BroadwayOutstandingRoundtrip, 1);
       rt->id = id;
       rt->tag = tag;
+      rt->send_time = g_get_monotonic_time ();
       server->outstanding_roundtrips = g_list_prepend (server->outstanding_roundtrips, rt);
 
       broadway_output_roundtrip (server->output, id, tag);
@@ -1078,14 +1195,18 @@ generate_handshake_response_wsietf_v7 (const gchar *key)
   return g_base64_encode (digest, digest_len);
 }
 
+static void start_viewer (BroadwayInput *input);
+
 static void
-start_input (HttpRequest *request)
+start_input (HttpRequest *request,
+             gboolean     viewer)
 {
   char **lines;
   const char *p;
   int i;
   char *res;
   const char *origin, *host;
+  gboolean deflate;
   BroadwayInput *input;
   const void *data_buffer;
   gsize data_buffer_size;
@@ -1102,10 +1223,19 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  deflate = FALSE;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
         key = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        {
+          /* We can't make zlib use a smaller window, so we can only
+           * accept offers that don't ask for one */
+          if (strstr (p, "permessage-deflate") != NULL &&
+              strstr (p, "server_max_window_bits") == NULL)
+            deflate = TRUE;
+        }
       else if ((p = parse_line (lines[i], "Origin")))
         origin = p;
       else if ((p = parse_line (lines[i], "Host")))
@@ -1121,6 +1251,13 @@ start_input (HttpRequest *request)
       return;
     }
 
+  if (viewer && request->server->output == NULL)
+    {
+      g_strfreev (lines);
+      send_error (request, 503, "No session to watch");
+      return;
+    }
+
   if (key != NULL)
     {
       char* accept = generate_handshake_response_wsietf_v7 (key);
@@ -1131,9 +1268,11 @@ start_input (HttpRequest *request)
                              "%s%s%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
+                             "%s"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
-                             host);
+                             host,
+                             deflate?"Sec-WebSocket-Extensions: permessage-deflate\r\n":"");
       g_free (accept);
 
 #ifdef DEBUG_WEBSOCKETS
@@ -1158,6 +1297,7 @@ start_input (HttpRequest *request)
   input = g_new0 (BroadwayInput, 1);
   input->server = request->server;
   input->connection = g_object_ref (request->connection);
+  input->viewer = viewer;
 
   data_buffer = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (request->data), &data_buffer_size);
   input->buffer = g_byte_array_sized_new (data_buffer_size);
@@ -1166,6 +1306,13 @@ start_input (HttpRequest *request)
   input->output =
     broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
 
+  if (deflate)
+    {
+      broadway_output_enable_deflate (input->output);
+      input->decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+      input->decompressed = g_string_new (NULL);
+    }
+
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
 
@@ -1175,6 +1322,13 @@ start_input (HttpRequest *request)
   g_source_set_callback (input->source, (GSourceFunc)input_data_cb, input, NULL);
   g_source_attach (input->source, NULL);
 
+  if (viewer)
+    {
+      start_viewer (input);
+      g_strfreev (lines);
+      return;
+    }
+
   start (input);
 
   /* Process any data in the pipe already */
@@ -1183,6 +1337,46 @@ start_input (HttpRequest *request)
   g_strfreev (lines);
 }
 
+static void
+broadway_server_reset_stats (BroadwayServer *server)
+{
+  server->stats_start_time = g_get_monotonic_time ();
+  server->stats_start_bytes = server->output ? broadway_output_get_bytes_written (server->output) : 0;
+  server->stats_n_roundtrips = 0;
+  server->stats_total_latency = 0;
+  server->stats_max_latency = 0;
+}
+
+/* Every frame of a surface waits for a roundtrip to the web client, so
+ * the roundtrips tell how many frames the client keeps up with, and how
+ * long it takes from sending a frame to the client having shown it. */
+static void
+broadway_server_update_stats (BroadwayServer *server,
+                              gint64          latency)
+{
+  gint64 now, elapsed;
+  guint64 bytes;
+
+  server->stats_n_roundtrips++;
+  server->stats_total_latency += latency;
+  server->stats_max_latency = MAX (server->stats_max_latency, latency);
+
+  now = g_get_monotonic_time ();
+  elapsed = now - server->stats_start_time;
+  if (elapsed < STATS_INTERVAL || server->output == NULL)
+    return;
+
+  bytes = broadway_output_get_bytes_written (server->output) - server->stats_start_bytes;
+
+  g_debug ("Web client: %.1f kB/s, %.1f frames/s, latency %.1f ms average, %.1f ms max",
+           (double) bytes * G_USEC_PER_SEC / elapsed / 1024,
+           (double) server->stats_n_roundtrips * G_USEC_PER_SEC / elapsed,
+           (double) server->stats_total_latency / server->stats_n_roundtrips / 1000,
+           (double) server->stats_max_latency / 1000);
+
+  broadway_server_reset_stats (server);
+}
+
 static void
 send_outstanding_roundtrips (BroadwayServer *server)
 {
@@ -1207,6 +1401,8 @@ start (BroadwayInput *input)
 
   server = BROADWAY_SERVER (input->server);
 
+  broadway_server_drop_viewers (server);
+
   if (server->output)
     {
       send_outstanding_roundtrips (server);
@@ -1233,7 +1429,10 @@ start (BroadwayInput *input)
   broadway_output_set_next_serial (server->output, server->saved_serial);
   broadway_output_flush (server->output);
 
-  broadway_server_resync_surfaces (server);
+  broadway_server_reset_stats (server);
+
+  broadway_server_resync_surfaces (server, server->output);
+  broadway_server_flush (server);
 
   if (server->pointer_grab_surface_id != -1)
     broadway_output_grab_pointer (server->output,
@@ -1243,6 +1442,56 @@ start (BroadwayInput *input)
   process_input_messages (server);
 }
 
+/* Viewers see the session of the controlling client, so they are
+ * disconnected when it goes away or another client takes over */
+static void
+broadway_server_drop_viewers (BroadwayServer *server)
+{
+  GList *l;
+
+  for (l = server->viewers; l != NULL; l = l->next)
+    {
+      BroadwayInput *viewer = l->data;
+
+      broadway_output_disconnected (viewer->output);
+      broadway_output_flush (viewer->output);
+      broadway_viewer_free (viewer);
+    }
+
+  g_list_free (server->viewers);
+  server->viewers = NULL;
+}
+
+static void
+start_viewer (BroadwayInput *input)
+{
+  BroadwayServer *server = input->server;
+
+  /* Send out what is queued first, so that the viewer's keyframe is
+   * the state the following messages apply to */
+  broadway_server_flush (server);
+
+  if (server->output == NULL)
+    {
+      broadway_output_disconnected (input->output);
+      broadway_output_flush (input->output);
+      broadway_viewer_free (input);
+      return;
+    }
+
+  broadway_output_set_next_serial (input->output,
+                                   broadway_output_get_next_serial (server->output));
+  broadway_server_resync_surfaces (server, input->output);
+
+  if (!broadway_output_flush (input->output))
+    {
+      broadway_viewer_free (input);
+      return;
+    }
+
+  server->viewers = g_list_prepend (server->viewers, input);
+}
+
 static void
 send_data (HttpRequest *request,
            const char *mimetype,
@@ -1307,7 +1556,7 @@ got_request (HttpRequest *request)
   else if (strcmp (escaped, "/broadway.js") == 0)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
-    start_input (request);
+    start_input (request, query != NULL && strcmp (query + 1, "viewer") == 0);
   else
     send_error (request, 404, "File not found");
 
@@ -1891,12 +2140,32 @@ broadway_server_surface_update_nodes (BroadwayServer   *server,
   broadway_node_add_to_lookup (root, surface->node_lookup);
 }
 
+/* Textures are looked up by their contents, so the web client only
+ * gets the same texture once, even if it is used by several surfaces
+ * or applications, or if it got released and then uploaded again
+ * while the client still has it. */
 guint32
 broadway_server_upload_texture (BroadwayServer   *server,
                                 GBytes           *bytes)
 {
   BroadwayTexture *texture;
 
+  texture = g_hash_table_lookup (server->texture_contents, bytes);
+  if (texture)
+    {
+      if (texture->unused_link.data)
+        {
+          g_queue_unlink (&server->unused_textures, &texture->unused_link);
+          texture->unused_link.data = NULL;
+          server->unused_texture_bytes -= g_bytes_get_size (texture->bytes);
+          g_ref_count_init (&texture->refcount);
+        }
+      else
+        g_ref_count_inc (&texture->refcount);
+
+      return texture->id;
+    }
+
   texture = g_new0 (BroadwayTexture, 1);
   g_ref_count_init (&texture->refcount);
   texture->id = ++server->next_texture_id;
@@ -1905,6 +2174,7 @@ broadway_server_upload_texture (BroadwayServer   *server,
   g_hash_table_replace (server->textures,
                         GINT_TO_POINTER (texture->id),
                         texture);
+  g_hash_table_insert (server->texture_contents, texture->bytes, texture);
 
   if (server->output)
     broadway_output_upload_texture (server->output, texture->id, texture->bytes);
@@ -1931,8 +2201,21 @@ broadway_server_release_texture (BroadwayServer   *server,
 
   texture = g_hash_table_lookup (server->textures, GINT_TO_POINTER (id));
 
-  if (texture && g_ref_count_dec (&texture->refcount))
+  if (texture == NULL || !g_ref_count_dec (&texture->refcount))
+    return;
+
+  texture->unused_link.data = texture;
+  g_queue_push_tail_link (&server->unused_textures, &texture->unused_link);
+  server->unused_texture_bytes += g_bytes_get_size (texture->bytes);
+
+  while (server->unused_texture_bytes > MAX_UNUSED_TEXTURE_BYTES)
     {
+      texture = g_queue_pop_head_link (&server->unused_textures)->data;
+      texture->unused_link.data = NULL;
+      server->unused_texture_bytes -= g_bytes_get_size (texture->bytes);
+
+      id = texture->id;
+      g_hash_table_remove (server->texture_contents, texture->bytes);
       g_hash_table_remove (server->textures, GINT_TO_POINTER (id));
 
       if (server->output)
@@ -1999,6 +2282,7 @@ broadway_server_focus_surface (BroadwayServer *server,
   focus_msg.focus.new_id = new_focused_surface;
 
   broadway_events_got_input (&focus_msg, -1);
+  broadway_events_flush ();
 
   /* Keep track of the new focused surface */
   server->focused_surface_id = new_focused_surface;
@@ -2112,21 +2396,19 @@ broadway_server_new_surface (BroadwayServer *server,
 }
 
 static void
-broadway_server_resync_surfaces (BroadwayServer *server)
+broadway_server_resync_surfaces (BroadwayServer *server,
+                                 BroadwayOutput *output)
 {
   GHashTableIter iter;
   gpointer key, value;
   GList *l;
 
-  if (server->output == NULL)
-    return;
-
   /* First upload all textures */
   g_hash_table_iter_init (&iter, server->textures);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
       BroadwayTexture *texture = value;
-      broadway_output_upload_texture (server->output,
+      broadway_output_upload_texture (output,
                                       GPOINTER_TO_INT (key),
                                       texture->bytes);
     }
@@ -2139,7 +2421,7 @@ broadway_server_resync_surfaces (BroadwayServer *server)
       if (surface->id == 0)
         continue; /* Skip root */
 
-      broadway_output_new_surface (server->output,
+      broadway_output_new_surface (output,
                                    surface->id,
                                    surface->x,
                                    surface->y,
@@ -2157,20 +2439,18 @@ broadway_server_resync_surfaces (BroadwayServer *server)
         continue; /* Skip root */
 
       if (surface->transient_for != -1)
-        broadway_output_set_transient_for (server->output, surface->id,
+        broadway_output_set_transient_for (output, surface->id,
                                            surface->transient_for);
 
       if (surface->nodes)
-        broadway_output_surface_set_nodes (server->output, surface->id,
+        broadway_output_surface_set_nodes (output, surface->id,
                                            surface->nodes,
                                            NULL, NULL);
 
       if (surface->visible)
-        broadway_output_show_surface (server->output, surface->id);
+        broadway_output_show_surface (output, surface->id);
     }
 
   if (server->show_keyboard)
-    broadway_output_set_show_keyboard (server->output, TRUE);
-
-  broadway_server_flush (server);
+    broadway_output_set_show_keyboard (output, TRUE);
 }
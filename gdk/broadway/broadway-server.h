@@ -7,6 +7,7 @@
 
 void broadway_events_got_input (BroadwayInputMsg *message,
 				gint32 client_id);
+void broadway_events_flush (void);
 
 typedef struct _BroadwayServer BroadwayServer;
 typedef struct _BroadwayServerClass BroadwayServerClass;
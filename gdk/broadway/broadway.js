@@ -95,6 +95,8 @@ const GDK_RELEASE_MASK  = 1 << 30;
 
 
 var useDataUrls = window.location.search.includes("datauri");
+/* Viewers only watch the session, the server ignores their input */
+var viewOnly = window.location.search.includes("viewer");
 
 /* This base64code is based on https://github.com/beatgammit/base64-js/blob/master/index.js which is MIT licensed */
 
@@ -1283,11 +1285,40 @@ BinCommands.prototype.get_32 = function() {
     this.pos = this.pos + 4;
     return v;
 };
-BinCommands.prototype.get_nodes = function() {
-    var len = this.get_32();
-    var node_data = new DataView(this.arraybuffer, this.pos, len * 4);
-    this.pos = this.pos + len * 4;
+// See append_compact_word() in broadway-output.c
+function expandNodeData(bytes, n_words) {
+    var node_data = new DataView(new ArrayBuffer(n_words * 4));
+    var pos = 0;
+    for (var i = 0; i < n_words; i++) {
+        var b = bytes[pos++];
+        if (b < 0x80) {
+            node_data.setUint32(i * 4, b, true);
+        } else if (b < 0xc0) {
+            node_data.setUint32(i * 4, ((b & 0x3f) << 8) | bytes[pos], true);
+            pos += 1;
+        } else if (b < 0xe0) {
+            var fixed = ((b & 0x1f) << 16) | (bytes[pos] << 8) | bytes[pos + 1];
+            if (fixed & 0x100000)
+                fixed -= 0x200000;
+            node_data.setFloat32(i * 4, fixed / 4, true);
+            pos += 2;
+        } else if (b < 0xf0) {
+            node_data.setUint32(i * 4, ((b & 0x0f) << 16) | (bytes[pos] << 8) | bytes[pos + 1], true);
+            pos += 2;
+        } else {
+            node_data.setUint32(i * 4, bytes[pos] | (bytes[pos + 1] << 8) | (bytes[pos + 2] << 16) | (bytes[pos + 3] << 24), true);
+            pos += 4;
+        }
+    }
     return node_data;
+}
+
+BinCommands.prototype.get_nodes = function() {
+    var n_words = this.get_32();
+    var size = this.get_32();
+    var bytes = new Uint8Array(this.arraybuffer, this.pos, size);
+    this.pos = this.pos + size;
+    return expandNodeData(bytes, n_words);
 };
 BinCommands.prototype.get_data = function() {
     var size = this.get_32();
@@ -1322,21 +1353,63 @@ function getSurfaceId(ev) {
     return target.surface.id;
 }
 
-function sendInput(cmd, args)
+function sendWords(words)
 {
-    if (inputSocket == null)
-        return;
-
-    var fullArgs = [cmd, lastSerial, lastTimeStamp].concat(args);
-    var buffer = new ArrayBuffer(fullArgs.length * 4);
+    var buffer = new ArrayBuffer(words.length * 4);
     var view = new DataView(buffer);
-    fullArgs.forEach(function(arg, i) {
+    words.forEach(function(arg, i) {
         view.setInt32(i*4, arg, false);
     });
 
     inputSocket.send(buffer);
 }
 
+/* Pointer motion is sent once per animation frame, with all the
+ * positions since the last frame in one websocket message, so the
+ * application gets them as one motion event with history. */
+const MAX_MOTION_HISTORY = 16;
+var pendingMotion = [];
+var motionFrameRequested = false;
+
+function flushMotion()
+{
+    if (pendingMotion.length == 0)
+        return;
+
+    var words = [].concat.apply([], pendingMotion);
+    pendingMotion = [];
+    sendWords(words);
+}
+
+function sendMotion(args)
+{
+    if (inputSocket == null || viewOnly)
+        return;
+
+    if (pendingMotion.length == MAX_MOTION_HISTORY)
+        pendingMotion.shift();
+    pendingMotion.push([BROADWAY_EVENT_POINTER_MOVE, lastSerial, lastTimeStamp].concat(args));
+
+    if (!motionFrameRequested) {
+        motionFrameRequested = true;
+        window.requestAnimationFrame(function() {
+            motionFrameRequested = false;
+            if (inputSocket != null)
+                flushMotion();
+        });
+    }
+}
+
+function sendInput(cmd, args)
+{
+    if (inputSocket == null || viewOnly)
+        return;
+
+    /* Everything else is sent right away, after the motion before it */
+    flushMotion();
+    sendWords([cmd, lastSerial, lastTimeStamp].concat(args));
+}
+
 function getPositionsFromAbsCoord(absX, absY, relativeId) {
     var res = Object();
 
@@ -1402,7 +1475,7 @@ function onMouseMove (ev) {
     var id = getSurfaceId(ev);
     id = getEffectiveEventTarget (id);
     var pos = getPositionsFromEvent(ev, id);
-    sendInput (BROADWAY_EVENT_POINTER_MOVE, [realSurfaceWithMouse, id, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
+    sendMotion ([realSurfaceWithMouse, id, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
 }
 
 function onMouseOver (ev) {
@@ -3216,6 +3289,8 @@ function connect()
 
     var loc = window.location.toString().replace("http:", "ws:").replace("https:", "wss:");
     loc = loc.substr(0, loc.lastIndexOf('/')) + "/socket";
+    if (viewOnly)
+        loc += "?viewer";
     ws = new WebSocket(loc, "broadway");
     ws.binaryType = "arraybuffer";
 
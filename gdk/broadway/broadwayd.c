@@ -58,6 +58,7 @@ typedef struct  {
   guint disconnect_idle;
   GList *fds;
   GHashTable *textures;
+  GString *events; /* Event replies not sent yet, see broadway_events_flush() */
 } BroadwayClient;
 
 static void
@@ -75,6 +76,7 @@ client_free (BroadwayClient *client)
   g_object_unref (client->connection);
   g_object_unref (client->in);
   g_string_free (client->buffer, TRUE);
+  g_string_free (client->events, TRUE);
   g_slist_free_full (client->serial_mappings, g_free);
   g_list_free_full (client->fds, close_fd);
   g_hash_table_destroy (client->textures);
@@ -131,6 +133,31 @@ client_disconnect_in_idle (BroadwayClient *client)
       g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc)disconnect_idle_cb, client, NULL);
 }
 
+static void
+write_to_client (BroadwayClient *client,
+                 gconstpointer   data,
+                 gsize           size)
+{
+  GOutputStream *output;
+
+  output = g_io_stream_get_output_stream (G_IO_STREAM (client->connection));
+  if (!g_output_stream_write_all (output, data, size, NULL, NULL, NULL))
+    {
+      g_printerr ("can't write to client");
+      client_disconnect_in_idle (client);
+    }
+}
+
+static void
+flush_events (BroadwayClient *client)
+{
+  if (client->events->len == 0)
+    return;
+
+  write_to_client (client, client->events->str, client->events->len);
+  g_string_truncate (client->events, 0);
+}
+
 static void
 send_reply (BroadwayClient *client,
             BroadwayRequest *request,
@@ -138,18 +165,13 @@ send_reply (BroadwayClient *client,
             gsize size,
             guint32 type)
 {
-  GOutputStream *output;
-
   reply->base.size = size;
   reply->base.in_reply_to = request ? request->base.serial : 0;
   reply->base.type = type;
 
-  output = g_io_stream_get_output_stream (G_IO_STREAM (client->connection));
-  if (!g_output_stream_write_all (output, reply, size, NULL, NULL, NULL))
-    {
-      g_printerr ("can't write to client");
-      client_disconnect_in_idle (client);
-    }
+  /* Keep the replies in order with the events before them */
+  flush_events (client);
+  write_to_client (client, reply, size);
 }
 
 static void
@@ -480,6 +502,10 @@ client_input_cb (GPollableInputStream *stream,
 
   g_string_erase (client->buffer, 0, client->buffer->len - buffer_len);
 
+  /* Requests without a reply, like moving a surface, can queue
+   * events, e.g. a faked configure when no browser is connected */
+  broadway_events_flush ();
+
   return G_SOURCE_CONTINUE;
 }
 
@@ -500,6 +526,7 @@ incoming_client (GSocketService    *service,
   input = g_io_stream_get_input_stream (G_IO_STREAM (client->connection));
   client->in = input;
   client->buffer = g_string_sized_new (INPUT_BUFFER_SIZE);
+  client->events = g_string_new (NULL);
   client->source = g_pollable_input_stream_create_source (G_POLLABLE_INPUT_STREAM (input), NULL);
 
   g_source_set_callback (client->source, (GSourceFunc) client_input_cb, client, NULL);
@@ -517,6 +544,7 @@ incoming_client (GSocketService    *service,
 
   broadway_events_got_input (&ev,
                              client->id);
+  broadway_events_flush ();
 
   return TRUE;
 }
@@ -689,6 +717,10 @@ broadway_events_got_input (BroadwayInputMsg *message,
 
   memcpy (&reply_event.msg, message, size);
 
+  reply_event.base.size = G_STRUCT_OFFSET (BroadwayReplyEvent, msg) + size;
+  reply_event.base.in_reply_to = 0;
+  reply_event.base.type = BROADWAY_REPLY_EVENT;
+
   for (l = clients; l != NULL; l = l->next)
     {
       BroadwayClient *client = l->data;
@@ -698,9 +730,20 @@ broadway_events_got_input (BroadwayInputMsg *message,
         {
           reply_event.msg.base.serial = get_client_serial (client, daemon_serial);
 
-          send_reply (client, NULL, (BroadwayReply *)&reply_event,
-                      G_STRUCT_OFFSET (BroadwayReplyEvent, msg) + size,
-                      BROADWAY_REPLY_EVENT);
+          g_string_append_len (client->events, (const char *) &reply_event,
+                               reply_event.base.size);
         }
     }
 }
+
+/* Events are queued until this is called, so that the events of all
+ * the input that came in at once reach the clients in one write. The
+ * clients can then compress the motion events among them. */
+void
+broadway_events_flush (void)
+{
+  GList *l;
+
+  for (l = clients; l != NULL; l = l->next)
+    flush_events (l->data);
+}
@@ -13,6 +13,7 @@
 #include "gdkbroadway-server.h"
 
 #include "gdkprivate-broadway.h"
+#include <gdk/gdkpixbuf.h>
 #include <gdk/gdktextureprivate.h>
 
 #include <glib.h>
@@ -615,32 +616,43 @@ open_shared_memory (void)
   return ret;
 }
 
+/* The zlib level for texture uploads. Textures are sent to the browser
+ * once and then thrown away, so compressing fast matters more than
+ * compressing well. */
+#define TEXTURE_PNG_COMPRESSION "1"
+
 typedef struct {
   int fd;
   gsize size;
 } PngData;
 
-static cairo_status_t
-write_png_cb (void         *closure,
-              const guchar *data,
-              unsigned int  length)
+static gboolean
+write_png_cb (const char  *buf,
+              gsize        count,
+              GError     **error,
+              gpointer     closure)
 {
   PngData *png_data = closure;
   int fd = png_data->fd;
 
-  while (length)
+  while (count)
     {
-      gssize ret = write (fd, data, length);
+      gssize ret = write (fd, buf, count);
 
       if (ret <= 0)
-        return CAIRO_STATUS_WRITE_ERROR;
+        {
+          g_set_error_literal (error, G_IO_ERROR,
+                               g_io_error_from_errno (errno),
+                               g_strerror (errno));
+          return FALSE;
+        }
 
       png_data->size += ret;
-      length -= ret;
-      data += ret;
+      count -= ret;
+      buf += ret;
     }
 
-  return CAIRO_STATUS_SUCCESS;
+  return TRUE;
 }
 
 guint32
@@ -648,15 +660,31 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
                                     GdkTexture        *texture)
 {
   guint32 id;
-  cairo_surface_t *surface = gdk_texture_download_surface (texture);
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
   BroadwayRequestUploadTexture msg;
   PngData data;
+  GError *error = NULL;
 
   id = server->next_texture_id++;
 
+  surface = gdk_texture_download_surface (texture);
+  pixbuf = gdk_pixbuf_get_from_surface (surface,
+                                        0, 0,
+                                        gdk_texture_get_width (texture),
+                                        gdk_texture_get_height (texture));
+  cairo_surface_destroy (surface);
+
   data.fd = open_shared_memory ();
   data.size = 0;
-  cairo_surface_write_to_png_stream (surface, write_png_cb, &data);
+  if (!gdk_pixbuf_save_to_callback (pixbuf, write_png_cb, &data, "png", &error,
+                                    "compression", TEXTURE_PNG_COMPRESSION,
+                                    NULL))
+    {
+      g_warning ("Failed to encode texture: %s", error->message);
+      g_error_free (error);
+    }
+  g_object_unref (pixbuf);
 
   msg.id = id;
   msg.offset = 0;
@@ -669,7 +697,6 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   return id;
 }
 
-
 void
 gdk_broadway_server_release_texture (GdkBroadwayServer *server,
                                      guint32            id)
@@ -637,18 +637,61 @@ pixbuf_serializer (GdkContentSerializer *serializer)
   g_object_unref (pixbuf);
 }
 
+/* Text is written in chunks, so the charset converter never has to
+ * hold a converted copy of all of it.
+ */
+#define STRING_CHUNK_SIZE 65536
+
+typedef struct
+{
+  const char *text;
+  gsize remaining;
+} StringWrite;
+
+static void string_serializer_write_next (GdkContentSerializer *serializer,
+                                          GOutputStream        *stream);
+
 static void
 string_serializer_finish (GObject      *source,
                           GAsyncResult *result,
                           gpointer      serializer)
 {
   GOutputStream *stream = G_OUTPUT_STREAM (source);
+  StringWrite *data = gdk_content_serializer_get_task_data (serializer);
   GError *error = NULL;
+  gsize written;
 
-  if (!g_output_stream_write_all_finish (stream, result, NULL, &error))
-    gdk_content_serializer_return_error (serializer, error);
-  else
-    gdk_content_serializer_return_success (serializer);
+  if (!g_output_stream_write_all_finish (stream, result, &written, &error))
+    {
+      gdk_content_serializer_return_error (serializer, error);
+      return;
+    }
+
+  data->text += written;
+  data->remaining -= written;
+
+  string_serializer_write_next (serializer, stream);
+}
+
+static void
+string_serializer_write_next (GdkContentSerializer *serializer,
+                              GOutputStream        *stream)
+{
+  StringWrite *data = gdk_content_serializer_get_task_data (serializer);
+
+  if (data->remaining == 0)
+    {
+      gdk_content_serializer_return_success (serializer);
+      return;
+    }
+
+  g_output_stream_write_all_async (stream,
+                                   data->text,
+                                   MIN (data->remaining, STRING_CHUNK_SIZE),
+                                   gdk_content_serializer_get_priority (serializer),
+                                   gdk_content_serializer_get_cancellable (serializer),
+                                   string_serializer_finish,
+                                   serializer);
 }
 
 static void
@@ -657,7 +700,7 @@ string_serializer (GdkContentSerializer *serializer)
   GOutputStream *filter;
   GCharsetConverter *converter;
   GError *error = NULL;
-  const char *text;
+  StringWrite *data;
 
   converter = g_charset_converter_new (gdk_content_serializer_get_user_data (serializer),
                                        "utf-8",
@@ -673,17 +716,14 @@ string_serializer (GdkContentSerializer *serializer)
                                           G_CONVERTER (converter));
   g_object_unref (converter);
 
-  text = g_value_get_string (gdk_content_serializer_get_value (serializer));
-  if (text == NULL)
-    text = "";
+  data = g_new (StringWrite, 1);
+  data->text = g_value_get_string (gdk_content_serializer_get_value (serializer));
+  if (data->text == NULL)
+    data->text = "";
+  data->remaining = strlen (data->text) + 1;
+  gdk_content_serializer_set_task_data (serializer, data, g_free);
 
-  g_output_stream_write_all_async (filter,
-                                   text,
-                                   strlen (text) + 1,
-                                   gdk_content_serializer_get_priority (serializer),
-                                   gdk_content_serializer_get_cancellable (serializer),
-                                   string_serializer_finish,
-                                   serializer);
+  string_serializer_write_next (serializer, filter);
   g_object_unref (filter);
 }
 
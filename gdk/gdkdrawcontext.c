@@ -24,6 +24,7 @@
 
 #include "gdkinternals.h"
 #include "gdkintl.h"
+#include "gdkprofilerprivate.h"
 
 /**
  * SECTION:gdkdrawcontext
@@ -331,6 +332,9 @@ void
 gdk_draw_context_end_frame (GdkDrawContext *context)
 {
   GdkDrawContextPrivate *priv = gdk_draw_context_get_instance_private (context);
+#ifdef G_ENABLE_DEBUG
+  gint64 before = 0;
+#endif
 
   g_return_if_fail (GDK_IS_DRAW_CONTEXT (context));
 
@@ -352,8 +356,19 @@ gdk_draw_context_end_frame (GdkDrawContext *context)
       return;
     }
 
+#ifdef G_ENABLE_DEBUG
+  if (gdk_profiler_is_running ())
+    before = g_get_monotonic_time ();
+#endif
+
   GDK_DRAW_CONTEXT_GET_CLASS (context)->end_frame (context, priv->frame_region);
 
+#ifdef G_ENABLE_DEBUG
+  if (before != 0)
+    gdk_profiler_add_mark (before * 1000, (g_get_monotonic_time () - before) * 1000,
+                           "end frame", G_OBJECT_TYPE_NAME (context));
+#endif
+
   g_clear_pointer (&priv->frame_region, cairo_region_destroy);
   g_clear_object (&priv->surface->paint_context);
 }
@@ -346,26 +346,35 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+/* Appends the position of @history_event, and the history it collected
+ * itself, to the history of @event. The history is kept in one array
+ * per event, in chronological order, so compressing a burst of motion
+ * from a fast device doesn't allocate per event.
+ */
 static void
 gdk_event_push_history (GdkEvent       *event,
                         const GdkEvent *history_event)
 {
   GdkTimeCoord *hist;
-  GdkDevice *device;
-  gint i, n_axes;
+  gint i;
 
   g_assert (event->any.type == GDK_MOTION_NOTIFY);
   g_assert (history_event->any.type == GDK_MOTION_NOTIFY);
 
-  hist = g_new0 (GdkTimeCoord, 1);
+  if (event->motion.history == NULL)
+    event->motion.history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
 
-  device = gdk_event_get_device (history_event);
-  n_axes = gdk_device_get_n_axes (device);
+  if (history_event->motion.history)
+    g_array_append_vals (event->motion.history,
+                         history_event->motion.history->data,
+                         history_event->motion.history->len);
 
-  for (i = 0; i <= MIN (n_axes, GDK_MAX_TIMECOORD_AXES); i++)
-    gdk_event_get_axis (history_event, i, &hist->axes[i]);
+  g_array_set_size (event->motion.history, event->motion.history->len + 1);
+  hist = &g_array_index (event->motion.history, GdkTimeCoord, event->motion.history->len - 1);
 
-  event->motion.history = g_list_prepend (event->motion.history, hist);
+  hist->time = history_event->motion.time;
+  for (i = GDK_AXIS_X; i < GDK_AXIS_LAST; i++)
+    gdk_event_get_axis (history_event, i, &hist->axes[i]);
 }
 
 void
@@ -376,6 +385,7 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   GdkSurface *pending_motion_surface = NULL;
   GdkDevice *pending_motion_device = NULL;
   GdkEvent *last_motion = NULL;
+  GArray *last_history;
 
   /* If the last N events in the event queue are motion notify
    * events for the same surface, drop all but the last */
@@ -410,6 +420,9 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
       tmp_list = tmp_list->prev;
     }
 
+  /* The history of the event we keep goes after the events we drop */
+  last_history = last_motion ? g_steal_pointer (&last_motion->motion.history) : NULL;
+
   while (pending_motions && pending_motions->next != NULL)
     {
       GList *next = pending_motions->next;
@@ -425,6 +438,17 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
       pending_motions = next;
     }
 
+  if (last_history)
+    {
+      if (last_motion->motion.history)
+        {
+          g_array_append_vals (last_motion->motion.history, last_history->data, last_history->len);
+          g_array_unref (last_history);
+        }
+      else
+        last_motion->motion.history = last_history;
+    }
+
   if (g_queue_get_length (&display->queued_events) == 1 &&
       g_queue_peek_head_link (&display->queued_events) == pending_motions)
     {
@@ -563,12 +587,6 @@ gdk_event_get_pointer_emulated (GdkEvent *event)
   return (event->any.flags & GDK_EVENT_POINTER_EMULATED) != 0;
 }
 
-static GdkTimeCoord *
-copy_time_coord (const GdkTimeCoord *coord)
-{
-  return g_memdup (coord, sizeof (GdkTimeCoord));
-}
-
 /**
  * gdk_event_copy:
  * @event: a #GdkEvent
@@ -649,8 +667,11 @@ gdk_event_copy (const GdkEvent *event)
 
       if (event->motion.history)
         {
-          new_event->motion.history = g_list_copy_deep (event->motion.history,
-                                                        (GCopyFunc) copy_time_coord, NULL);
+          new_event->motion.history = g_array_sized_new (FALSE, FALSE, sizeof (GdkTimeCoord),
+                                                         event->motion.history->len);
+          g_array_append_vals (new_event->motion.history,
+                               event->motion.history->data,
+                               event->motion.history->len);
         }
       break;
 
@@ -704,7 +725,7 @@ gdk_event_finalize (GObject *object)
     case GDK_MOTION_NOTIFY:
       g_clear_object (&event->motion.tool);
       g_free (event->motion.axes);
-      g_list_free_full (event->motion.history, g_free);
+      g_clear_pointer (&event->motion.history, g_array_unref);
       break;
 
     default:
@@ -2454,7 +2475,8 @@ gdk_event_get_axes (GdkEvent  *event,
  * @event: a #GdkEvent of type %GDK_MOTION_NOTIFY
  *
  * Retrieves the history of the @event motion, as a list of time and
- * coordinates.
+ * coordinates, oldest first. These are the motion events that were
+ * compressed into @event. The coordinates are owned by @event.
  *
  * Returns: (transfer container) (element-type GdkTimeCoord) (nullable): a list
  *   of time and coordinates
@@ -2462,7 +2484,14 @@ gdk_event_get_axes (GdkEvent  *event,
 GList *
 gdk_event_get_motion_history (const GdkEvent *event)
 {
-  if (event->any.type != GDK_MOTION_NOTIFY)
+  GList *history = NULL;
+  guint i;
+
+  if (event->any.type != GDK_MOTION_NOTIFY || event->motion.history == NULL)
     return NULL;
-  return g_list_reverse (g_list_copy (event->motion.history));
+
+  for (i = event->motion.history->len; i > 0; i--)
+    history = g_list_prepend (history, &g_array_index (event->motion.history, GdkTimeCoord, i - 1));
+
+  return history;
 }
@@ -88,6 +88,7 @@ enum {
 static guint signals[LAST_SIGNAL];
 
 static guint fps_counter;
+static guint latency_counter;
 
 #define FRAME_HISTORY_MAX_LENGTH 16
 
@@ -258,6 +259,8 @@ gdk_frame_clock_init (GdkFrameClock *clock)
 #ifdef G_ENABLE_DEBUG
   if (fps_counter == 0)
     fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
+  if (latency_counter == 0)
+    latency_counter = gdk_profiler_define_counter ("latency", "Frame start to presentation (ms)");
 #endif
 }
 
@@ -745,9 +748,14 @@ _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock   *clock,
                             "paint", "");
 
   if (timings->presentation_time != 0)
-    gdk_profiler_add_mark (timings->presentation_time * 1000,
-                           0,
-                           "presentation", "");
+    {
+      gdk_profiler_add_mark (timings->presentation_time * 1000,
+                             0,
+                             "presentation", "");
+      gdk_profiler_set_counter (latency_counter,
+                                timings->presentation_time * 1000,
+                                (timings->presentation_time - timings->frame_time) / 1000.);
+    }
 
   gdk_profiler_set_counter (fps_counter,
                             timings->frame_end_time * 1000,
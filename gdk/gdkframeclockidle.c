@@ -36,11 +36,13 @@
 #endif
 
 #define FRAME_INTERVAL 16667 /* microseconds */
+#define FRAME_DEADLINE_MARGIN 1000 /* microseconds */
 
 struct _GdkFrameClockIdlePrivate
 {
   gint64 frame_time;
   gint64 min_next_frame_time;
+  gint64 frame_duration; /* estimate of how long a frame takes */
   gint64 sleep_serial;
 #ifdef G_ENABLE_DEBUG
   gint64 freeze_time;
@@ -268,12 +270,30 @@ maybe_stop_idle (GdkFrameClockIdle *clock_idle)
     }
 }
 
+/* Keeps track of how long frames take. Longer frames are taken into
+ * account right away so we don't miss the next vblank, shorter ones
+ * only slowly, so one cheap frame doesn't make us start too late.
+ */
+static void
+update_frame_duration (GdkFrameClockIdle *clock_idle,
+                       gint64             duration)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+
+  if (duration > priv->frame_duration)
+    priv->frame_duration = duration;
+  else
+    priv->frame_duration = (7 * priv->frame_duration + duration) / 8;
+}
+
 static gint64
 compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
                              gint64             last_frame_time)
 {
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gint64 presentation_time;
   gint64 refresh_interval;
+  gint64 budget;
 
   gdk_frame_clock_get_refresh_info (GDK_FRAME_CLOCK (clock_idle),
                                     last_frame_time,
@@ -281,8 +301,17 @@ compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
 
   if (presentation_time == 0)
     return last_frame_time + refresh_interval;
+
+  /* The last frame is shown at presentation_time. Start the next one
+   * just early enough to be done before the vblank after that, so
+   * the input it handles is as recent as possible.
+   */
+  if (priv->frame_duration == 0)
+    budget = refresh_interval / 2;
   else
-    return presentation_time + refresh_interval / 2;
+    budget = CLAMP (priv->frame_duration + FRAME_DEADLINE_MARGIN, 0, refresh_interval);
+
+  return presentation_time + refresh_interval - budget;
 }
 
 static gboolean
@@ -319,6 +348,7 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
+  gint64 frame_start_time = 0;
 
   priv->paint_idle_id = 0;
   priv->in_paint_idle = TRUE;
@@ -343,15 +373,23 @@ gdk_frame_clock_paint_idle (void *data)
         case GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT:
           if (priv->freeze_count == 0)
             {
-              gint64 frame_interval = FRAME_INTERVAL;
+              gint64 frame_interval;
+              gint64 presentation_time;
               gint64 reset_frame_time;
               gint64 smoothest_frame_time;
               gint64 frame_time_error;
               GdkFrameTimings *prev_timings =
                 gdk_frame_clock_get_current_timings (clock);
 
+              /* The previous frame usually isn't presented yet, so fall
+               * back to the refresh interval of the last one that was,
+               * which keeps displays that don't run at 60Hz smooth.
+               */
               if (prev_timings && prev_timings->refresh_interval)
                 frame_interval = prev_timings->refresh_interval;
+              else
+                gdk_frame_clock_get_refresh_info (clock, priv->frame_time,
+                                                  &frame_interval, &presentation_time);
 
               /* We are likely not getting precisely even callbacks in real
                * time, particularly if the event loop is busy.
@@ -366,6 +404,7 @@ gdk_frame_clock_paint_idle (void *data)
                */
               smoothest_frame_time = priv->frame_time + frame_interval;
               reset_frame_time = compute_frame_time (clock_idle);
+              frame_start_time = reset_frame_time;
               frame_time_error = ABS (reset_frame_time - smoothest_frame_time);
               if (frame_time_error >= frame_interval)
                 priv->frame_time = reset_frame_time;
@@ -488,6 +527,9 @@ gdk_frame_clock_paint_idle (void *data)
 
   priv->in_paint_idle = FALSE;
 
+  if (frame_start_time != 0)
+    update_frame_duration (clock_idle, g_get_monotonic_time () - frame_start_time);
+
   /* If there is throttling in the backend layer, then we'll do another
    * update as soon as the backend unthrottles (if there is work to do),
    * otherwise we need to figure when the next frame should be.
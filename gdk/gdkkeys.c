@@ -24,6 +24,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gdkkeysyms.h"
 #include "gdkkeysprivate.h"
 #include "gdkdisplay.h"
@@ -901,3 +903,86 @@ gdk_keyval_convert_case (guint symbol,
   if (upper)
     *upper = xupper;
 }
+
+static inline GdkKeymapTranslation *
+translation_cache_slot (GdkKeymapTranslationCache *cache,
+                        guint                      hardware_keycode,
+                        GdkModifierType            state,
+                        gint                       group)
+{
+  guint hash;
+
+  /* keycodes of consecutive keys differ in the low bits, and the
+   * state mostly in Shift and Lock
+   */
+  hash = hardware_keycode ^ (state * 0x9e3779b1) ^ ((guint) group << 4);
+
+  return &cache->entries[hash % GDK_KEYMAP_TRANSLATION_CACHE_SIZE];
+}
+
+void
+gdk_keymap_translation_cache_clear (GdkKeymapTranslationCache *cache)
+{
+  memset (cache, 0, sizeof (GdkKeymapTranslationCache));
+}
+
+/* Returns %TRUE and fills in the out arguments if the translation is
+ * in the cache. result is the return value of the translation.
+ */
+gboolean
+gdk_keymap_translation_cache_lookup (GdkKeymapTranslationCache *cache,
+                                     guint                      hardware_keycode,
+                                     GdkModifierType            state,
+                                     gint                       group,
+                                     guint                     *keyval,
+                                     gint                      *effective_group,
+                                     gint                      *level,
+                                     GdkModifierType           *consumed_modifiers,
+                                     gboolean                  *result)
+{
+  GdkKeymapTranslation *entry;
+
+  entry = translation_cache_slot (cache, hardware_keycode, state, group);
+  if (!entry->used ||
+      entry->keycode != hardware_keycode ||
+      entry->state != state ||
+      entry->group != group)
+    return FALSE;
+
+  if (keyval)
+    *keyval = entry->keyval;
+  if (effective_group)
+    *effective_group = entry->effective_group;
+  if (level)
+    *level = entry->level;
+  if (consumed_modifiers)
+    *consumed_modifiers = entry->consumed_modifiers;
+  *result = entry->result;
+
+  return TRUE;
+}
+
+void
+gdk_keymap_translation_cache_insert (GdkKeymapTranslationCache *cache,
+                                     guint                      hardware_keycode,
+                                     GdkModifierType            state,
+                                     gint                       group,
+                                     guint                      keyval,
+                                     gint                       effective_group,
+                                     gint                       level,
+                                     GdkModifierType            consumed_modifiers,
+                                     gboolean                   result)
+{
+  GdkKeymapTranslation *entry;
+
+  entry = translation_cache_slot (cache, hardware_keycode, state, group);
+  entry->keycode = hardware_keycode;
+  entry->state = state;
+  entry->group = group;
+  entry->keyval = keyval;
+  entry->effective_group = effective_group;
+  entry->level = level;
+  entry->consumed_modifiers = consumed_modifiers;
+  entry->used = TRUE;
+  entry->result = result != FALSE;
+}
@@ -77,6 +77,50 @@ struct _GdkKeymap
   GdkDisplay *display;
 };
 
+/* Backends cache the results of translate_keyboard_state(), which is
+ * called several times for every key event. The cache only depends on
+ * the keymap, so it must be cleared when the keys change.
+ */
+#define GDK_KEYMAP_TRANSLATION_CACHE_SIZE 64
+
+typedef struct
+{
+  guint keycode;
+  GdkModifierType state;
+  gint group;
+  guint keyval;
+  gint effective_group;
+  gint level;
+  GdkModifierType consumed_modifiers;
+  guint used   : 1;
+  guint result : 1;
+} GdkKeymapTranslation;
+
+typedef struct
+{
+  GdkKeymapTranslation entries[GDK_KEYMAP_TRANSLATION_CACHE_SIZE];
+} GdkKeymapTranslationCache;
+
+void     gdk_keymap_translation_cache_clear  (GdkKeymapTranslationCache *cache);
+gboolean gdk_keymap_translation_cache_lookup (GdkKeymapTranslationCache *cache,
+                                              guint                      hardware_keycode,
+                                              GdkModifierType            state,
+                                              gint                       group,
+                                              guint                     *keyval,
+                                              gint                      *effective_group,
+                                              gint                      *level,
+                                              GdkModifierType           *consumed_modifiers,
+                                              gboolean                  *result);
+void     gdk_keymap_translation_cache_insert (GdkKeymapTranslationCache *cache,
+                                              guint                      hardware_keycode,
+                                              GdkModifierType            state,
+                                              gint                       group,
+                                              guint                      keyval,
+                                              gint                       effective_group,
+                                              gint                       level,
+                                              GdkModifierType            consumed_modifiers,
+                                              gboolean                   result);
+
 G_END_DECLS
 
 #endif
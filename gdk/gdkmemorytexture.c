@@ -168,6 +168,12 @@ convert_memcpy (guchar       *dest_data,
 {
   gsize y;
 
+  if (dest_stride == src_stride && dest_stride == 4 * width)
+    {
+      memcpy (dest_data, src_data, 4 * width * height);
+      return;
+    }
+
   for (y = 0; y < height; y++)
     memcpy (dest_data + y * dest_stride, src_data + y * src_stride, 4 * width);
 }
@@ -232,6 +238,8 @@ SWIZZLE_OPAQUE(0,1,2,3)
 SWIZZLE_OPAQUE(0,3,2,1)
 
 #define PREMULTIPLY(d,c,a) G_STMT_START { guint t = c * a + 0x80; d = ((t >> 8) + t) >> 8; } G_STMT_END
+/* Most pixels of most images are either opaque or fully transparent,
+ * so those skip the multiplications */
 #define SWIZZLE_PREMULTIPLY(A,R,G,B, A2,R2,G2,B2) \
 static void \
 convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2 \
@@ -248,10 +256,27 @@ convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2 \
     { \
       for (x = 0; x < width; x++) \
         { \
-          dest_data[4 * x + A] = src_data[4 * x + A2]; \
-          PREMULTIPLY(dest_data[4 * x + R], src_data[4 * x + R2], src_data[4 * x + A2]); \
-          PREMULTIPLY(dest_data[4 * x + G], src_data[4 * x + G2], src_data[4 * x + A2]); \
-          PREMULTIPLY(dest_data[4 * x + B], src_data[4 * x + B2], src_data[4 * x + A2]); \
+          guchar alpha = src_data[4 * x + A2]; \
+\
+          dest_data[4 * x + A] = alpha; \
+          if (alpha == 0xFF) \
+            { \
+              dest_data[4 * x + R] = src_data[4 * x + R2]; \
+              dest_data[4 * x + G] = src_data[4 * x + G2]; \
+              dest_data[4 * x + B] = src_data[4 * x + B2]; \
+            } \
+          else if (alpha == 0) \
+            { \
+              dest_data[4 * x + R] = 0; \
+              dest_data[4 * x + G] = 0; \
+              dest_data[4 * x + B] = 0; \
+            } \
+          else \
+            { \
+              PREMULTIPLY(dest_data[4 * x + R], src_data[4 * x + R2], alpha); \
+              PREMULTIPLY(dest_data[4 * x + G], src_data[4 * x + G2], alpha); \
+              PREMULTIPLY(dest_data[4 * x + B], src_data[4 * x + B2], alpha); \
+            } \
         } \
 \
       dest_data += dest_stride; \
@@ -36,6 +36,8 @@
 
 static SpCaptureWriter *writer = NULL;
 static gboolean running = FALSE;
+/* Marks shorter than this many nanoseconds are dropped */
+static gint64 min_duration = 0;
 
 static void
 profiler_stop (void)
@@ -67,6 +69,11 @@ gdk_profiler_start (int fd)
   if (writer)
     running = TRUE;
 
+  /* Per-widget marks can be very many, so allow only
+   * keeping the slow ones, in microseconds */
+  if (g_getenv ("GTK_TRACE_MIN_DURATION"))
+    min_duration = g_ascii_strtoll (g_getenv ("GTK_TRACE_MIN_DURATION"), NULL, 10) * 1000;
+
   atexit (profiler_stop);
 }
 
@@ -91,6 +98,9 @@ gdk_profiler_add_mark (gint64      start,
   if (!running)
     return;
 
+  if ((gint64) duration < min_duration)
+    return;
+
   sp_capture_writer_add_mark (writer,
                               start,
                               -1, getpid (),
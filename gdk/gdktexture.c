@@ -416,6 +416,171 @@ gdk_texture_new_from_file (GFile   *file,
   return texture;
 }
 
+typedef struct {
+  GFile *file;
+  int max_width;
+  int max_height;
+} LoadData;
+
+static void
+load_data_free (gpointer data)
+{
+  LoadData *load = data;
+
+  g_object_unref (load->file);
+  g_slice_free (LoadData, load);
+}
+
+static void
+on_loader_size_prepared (GdkPixbufLoader *loader,
+                         int              width,
+                         int              height,
+                         gpointer         user_data)
+{
+  LoadData *load = user_data;
+  double scale;
+
+  scale = 1.0;
+  if (load->max_width >= 0 && width > load->max_width)
+    scale = MIN (scale, (double) load->max_width / width);
+  if (load->max_height >= 0 && height > load->max_height)
+    scale = MIN (scale, (double) load->max_height / height);
+
+  /* Setting a size lets loaders decode at a lower resolution,
+   * like the JPEG loader does with DCT scaling, so the full size
+   * image never needs to be in memory.
+   */
+  if (scale < 1.0)
+    gdk_pixbuf_loader_set_size (loader,
+                                MAX (1, (int) (width * scale + 0.5)),
+                                MAX (1, (int) (height * scale + 0.5)));
+}
+
+static void
+load_texture_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  LoadData *load = task_data;
+  GdkPixbufLoader *loader;
+  GInputStream *stream;
+  GError *error = NULL;
+  GdkPixbuf *pixbuf;
+  guchar buffer[65536];
+  gssize n_read;
+
+  stream = G_INPUT_STREAM (g_file_read (load->file, cancellable, &error));
+  if (stream == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  loader = gdk_pixbuf_loader_new ();
+  g_signal_connect (loader, "size-prepared", G_CALLBACK (on_loader_size_prepared), load);
+
+  while ((n_read = g_input_stream_read (stream, buffer, sizeof (buffer), cancellable, &error)) > 0)
+    {
+      if (!gdk_pixbuf_loader_write (loader, buffer, n_read, &error))
+        break;
+    }
+
+  g_object_unref (stream);
+
+  if (error != NULL)
+    {
+      gdk_pixbuf_loader_close (loader, NULL);
+      g_object_unref (loader);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  if (!gdk_pixbuf_loader_close (loader, &error))
+    {
+      g_object_unref (loader);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (pixbuf == NULL)
+    g_task_return_new_error (task,
+                             GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED,
+                             "Failed to load image");
+  else
+    g_task_return_pointer (task, gdk_texture_new_for_pixbuf (pixbuf), g_object_unref);
+
+  g_object_unref (loader);
+}
+
+/**
+ * gdk_texture_new_from_file_async:
+ * @file: #GFile to load
+ * @max_width: the maximum width of the texture, or -1 for no limit
+ * @max_height: the maximum height of the texture, or -1 for no limit
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @callback: (scope async): callback to call when the texture is loaded
+ * @user_data: (closure): data to pass to @callback
+ *
+ * Asynchronously creates a new texture by loading an image from a file,
+ * like gdk_texture_new_from_file(). Reading and decoding the file happens
+ * in a thread.
+ *
+ * If the image is larger than @max_width or @max_height, it is scaled down
+ * to fit, keeping its aspect ratio. Image formats that support it are
+ * decoded at the smaller size directly, which is a lot cheaper than
+ * decoding large photos at full size and scaling them later.
+ *
+ * When the operation is finished, @callback will be called. You can then
+ * call gdk_texture_new_from_file_finish() to get the result.
+ */
+void
+gdk_texture_new_from_file_async (GFile               *file,
+                                 int                  max_width,
+                                 int                  max_height,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  LoadData *load;
+  GTask *task;
+
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  load = g_slice_new (LoadData);
+  load->file = g_object_ref (file);
+  load->max_width = max_width;
+  load->max_height = max_height;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_texture_new_from_file_async);
+  g_task_set_task_data (task, load, load_data_free);
+  g_task_run_in_thread (task, load_texture_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gdk_texture_new_from_file_finish:
+ * @result: a #GAsyncResult
+ * @error: Return location for an error
+ *
+ * Finishes an operation started with gdk_texture_new_from_file_async().
+ *
+ * Return value: (transfer full): A newly-created #GdkTexture or %NULL if
+ *     an error occured.
+ **/
+GdkTexture *
+gdk_texture_new_from_file_finish (GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_texture_new_from_file_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * gdk_texture_get_width:
  * @texture: a #GdkTexture
@@ -49,6 +49,16 @@ GdkTexture *            gdk_texture_new_from_resource          (const char
 GDK_AVAILABLE_IN_ALL
 GdkTexture *            gdk_texture_new_from_file              (GFile           *file,
                                                                 GError         **error);
+GDK_AVAILABLE_IN_ALL
+void                    gdk_texture_new_from_file_async        (GFile           *file,
+                                                                int              max_width,
+                                                                int              max_height,
+                                                                GCancellable    *cancellable,
+                                                                GAsyncReadyCallback callback,
+                                                                gpointer         user_data);
+GDK_AVAILABLE_IN_ALL
+GdkTexture *            gdk_texture_new_from_file_finish       (GAsyncResult    *result,
+                                                                GError         **error);
 
 GDK_AVAILABLE_IN_ALL
 int                     gdk_texture_get_width                  (GdkTexture      *texture);
@@ -53,13 +53,20 @@
 
 typedef struct _GdkVulkanContextPrivate GdkVulkanContextPrivate;
 
+/* Every frame acquires its image with the next semaphore of a ring,
+ * so a renderer can have several frames in flight and a semaphore is
+ * only reused long after the present that waited on it.
+ */
+#define N_DRAW_SEMAPHORES 4
+
 struct _GdkVulkanContextPrivate {
 #ifdef GDK_RENDERING_VULKAN
   VkSurfaceKHR surface;
   VkSurfaceFormatKHR image_format;
 
   VkSwapchainKHR swapchain;
-  VkSemaphore draw_semaphore;
+  VkSemaphore draw_semaphores[N_DRAW_SEMAPHORES];
+  guint draw_semaphore_index;
 
   guint n_images;
   VkImage *images;
@@ -225,12 +232,15 @@ gdk_vulkan_context_dispose (GObject *gobject)
 
   device = gdk_vulkan_context_get_device (context);
 
-  if (priv->draw_semaphore != VK_NULL_HANDLE)
+  for (i = 0; i < N_DRAW_SEMAPHORES; i++)
     {
-      vkDestroySemaphore (device,
-                           priv->draw_semaphore,
-                           NULL);
-      priv->draw_semaphore = VK_NULL_HANDLE;
+      if (priv->draw_semaphores[i] != VK_NULL_HANDLE)
+        {
+          vkDestroySemaphore (device,
+                              priv->draw_semaphores[i],
+                              NULL);
+          priv->draw_semaphores[i] = VK_NULL_HANDLE;
+        }
     }
 
   if (priv->swapchain != VK_NULL_HANDLE)
@@ -257,6 +267,39 @@ gdk_vulkan_context_dispose (GObject *gobject)
   G_OBJECT_CLASS (gdk_vulkan_context_parent_class)->dispose (gobject);
 }
 
+/* MAILBOX never blocks in vkQueuePresentKHR() and replaces queued
+ * images with newer ones, so frames can be prepared while the previous
+ * one waits for the vblank, without tearing. FIFO is always supported.
+ * IMMEDIATE is not used, GTK paces its frames already and tearing is
+ * not acceptable for user interfaces.
+ */
+static VkPresentModeKHR
+gdk_vulkan_context_choose_present_mode (GdkVulkanContext *context)
+{
+  GdkVulkanContextPrivate *priv = gdk_vulkan_context_get_instance_private (context);
+  VkPresentModeKHR *modes;
+  uint32_t i, n_modes;
+
+  if (GDK_VK_CHECK (vkGetPhysicalDeviceSurfacePresentModesKHR, gdk_vulkan_context_get_physical_device (context),
+                                                               priv->surface,
+                                                               &n_modes, NULL) != VK_SUCCESS)
+    return VK_PRESENT_MODE_FIFO_KHR;
+
+  modes = g_newa (VkPresentModeKHR, MAX (n_modes, 1));
+  if (GDK_VK_CHECK (vkGetPhysicalDeviceSurfacePresentModesKHR, gdk_vulkan_context_get_physical_device (context),
+                                                               priv->surface,
+                                                               &n_modes, modes) != VK_SUCCESS)
+    return VK_PRESENT_MODE_FIFO_KHR;
+
+  for (i = 0; i < n_modes; i++)
+    {
+      if (modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+
+  return VK_PRESENT_MODE_FIFO_KHR;
+}
+
 static gboolean
 gdk_vulkan_context_check_swapchain (GdkVulkanContext  *context,
                                     GError           **error)
@@ -328,7 +371,7 @@ gdk_vulkan_context_check_swapchain (GdkVulkanContext  *context,
                                                 },
                                                 .preTransform = capabilities.currentTransform,
                                                 .compositeAlpha = composite_alpha,
-                                                .presentMode = VK_PRESENT_MODE_FIFO_KHR,
+                                                .presentMode = gdk_vulkan_context_choose_present_mode (context),
                                                 .clipped = VK_FALSE,
                                                 .oldSwapchain = priv->swapchain
                                             },
@@ -337,6 +380,8 @@ gdk_vulkan_context_check_swapchain (GdkVulkanContext  *context,
 
   if (priv->swapchain != VK_NULL_HANDLE)
     {
+      /* Frames in flight may still draw into the old images */
+      GDK_VK_CHECK (vkQueueWaitIdle, gdk_vulkan_context_get_queue (context));
       vkDestroySwapchainKHR (device,
                              priv->swapchain,
                              NULL);
@@ -398,10 +443,12 @@ gdk_vulkan_context_begin_frame (GdkDrawContext *draw_context,
       cairo_region_union (priv->regions[i], region);
     }
 
+  priv->draw_semaphore_index = (priv->draw_semaphore_index + 1) % N_DRAW_SEMAPHORES;
+
   GDK_VK_CHECK (vkAcquireNextImageKHR, gdk_vulkan_context_get_device (context),
                                        priv->swapchain,
                                        UINT64_MAX,
-                                       priv->draw_semaphore,
+                                       priv->draw_semaphores[priv->draw_semaphore_index],
                                        VK_NULL_HANDLE,
                                        &priv->draw_index);
 
@@ -420,7 +467,7 @@ gdk_vulkan_context_end_frame (GdkDrawContext *draw_context,
                                        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
                                        .waitSemaphoreCount = 1,
                                        .pWaitSemaphores = (VkSemaphore[]) {
-                                           priv->draw_semaphore
+                                           priv->draw_semaphores[priv->draw_semaphore_index]
                                        },
                                        .swapchainCount = 1,
                                        .pSwapchains = (VkSwapchainKHR[]) { 
@@ -547,12 +594,15 @@ gdk_vulkan_context_real_init (GInitable     *initable,
       if (!gdk_vulkan_context_check_swapchain (context, error))
         goto out_surface;
 
-      GDK_VK_CHECK (vkCreateSemaphore, gdk_vulkan_context_get_device (context),
-                                       &(VkSemaphoreCreateInfo) {
-                                           .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-                                       },
-                                       NULL,
-                                       &priv->draw_semaphore);
+      for (i = 0; i < N_DRAW_SEMAPHORES; i++)
+        {
+          GDK_VK_CHECK (vkCreateSemaphore, gdk_vulkan_context_get_device (context),
+                                           &(VkSemaphoreCreateInfo) {
+                                               .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                                           },
+                                           NULL,
+                                           &priv->draw_semaphores[i]);
+        }
 
       return TRUE;
     }
@@ -751,7 +801,7 @@ gdk_vulkan_context_get_draw_semaphore (GdkVulkanContext *context)
   g_return_val_if_fail (GDK_IS_VULKAN_CONTEXT (context), VK_NULL_HANDLE);
   g_return_val_if_fail (gdk_draw_context_is_in_frame (GDK_DRAW_CONTEXT (context)), VK_NULL_HANDLE);
 
-  return priv->draw_semaphore;
+  return priv->draw_semaphores[priv->draw_semaphore_index];
 }
 
 static gboolean
@@ -114,8 +114,11 @@ static const struct wl_buffer_listener buffer_listener = {
   gdk_wayland_cairo_context_buffer_release
 };
 
+/* If @reuse is given, it must be a released surface, and its
+ * shared memory is used for the new surface */
 static cairo_surface_t *
-gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
+gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self,
+                                          cairo_surface_t        *reuse)
 {
   GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)));
   GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
@@ -126,9 +129,14 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
 
   width = gdk_surface_get_width (surface);
   height = gdk_surface_get_height (surface);
-  cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
-                                                           width, height,
-                                                           gdk_surface_get_scale_factor (surface));
+  if (reuse)
+    cairo_surface = _gdk_wayland_shm_surface_resize (reuse,
+                                                     width, height,
+                                                     gdk_surface_get_scale_factor (surface));
+  else
+    cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
+                                                             width, height,
+                                                             gdk_surface_get_scale_factor (surface));
   buffer = _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface);
   wl_buffer_add_listener (buffer, &buffer_listener, cairo_surface);
   gdk_wayland_cairo_context_add_surface (self, cairo_surface);
@@ -152,7 +160,7 @@ gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
   if (self->cached_surface)
     self->paint_surface = g_steal_pointer (&self->cached_surface);
   else
-    self->paint_surface = gdk_wayland_cairo_context_create_surface (self);
+    self->paint_surface = gdk_wayland_cairo_context_create_surface (self, NULL);
 
   surface_region = gdk_wayland_cairo_context_surface_get_region (self->paint_surface);
   if (surface_region)
@@ -197,8 +205,21 @@ static void
 gdk_wayland_cairo_context_surface_resized (GdkDrawContext *draw_context)
 {
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (draw_context);
+  cairo_surface_t *cached;
+
+  /* Keep the memory of the released surface, so that interactive
+   * resizes don't create and fault in new shared memory every frame */
+  cached = self->cached_surface;
+  if (cached)
+    cairo_surface_reference (cached);
 
   gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
+
+  if (cached)
+    {
+      self->cached_surface = gdk_wayland_cairo_context_create_surface (self, cached);
+      cairo_surface_destroy (cached);
+    }
 }
 
 static cairo_t *
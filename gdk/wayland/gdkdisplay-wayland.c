@@ -1197,6 +1197,7 @@ static const cairo_user_data_key_t gdk_wayland_shm_surface_cairo_key;
 typedef struct _GdkWaylandCairoSurfaceData {
   gpointer buf;
   size_t buf_length;
+  int fd; /* kept open so the pool can grow */
   struct wl_shm_pool *pool;
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
@@ -1266,6 +1267,7 @@ open_shared_memory (void)
 static struct wl_shm_pool *
 create_shm_pool (struct wl_shm  *shm,
                  int             size,
+                 int            *fd_out,
                  size_t         *buf_length,
                  void          **data_out)
 {
@@ -1296,14 +1298,50 @@ create_shm_pool (struct wl_shm  *shm,
 
   pool = wl_shm_create_pool (shm, fd, size);
 
-  close (fd);
-
+  *fd_out = fd;
   *data_out = data;
   *buf_length = size;
 
   return pool;
 }
 
+/* Pools can only grow, and they grow by half their size at least,
+ * so that a window that is resized continuously only needs to
+ * remap its memory every few frames.
+ */
+static gboolean
+grow_shm_pool (GdkWaylandCairoSurfaceData *data,
+               size_t                      size)
+{
+  void *buf;
+
+  if (size <= data->buf_length)
+    return TRUE;
+
+  size = MAX (size, data->buf_length + data->buf_length / 2);
+
+  if (ftruncate (data->fd, size) < 0)
+    {
+      g_critical (G_STRLOC ": Truncating shared memory file failed: %m");
+      return FALSE;
+    }
+
+  buf = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, data->fd, 0);
+  if (buf == MAP_FAILED)
+    {
+      g_critical (G_STRLOC ": mmap'ping shared memory file failed: %m");
+      return FALSE;
+    }
+
+  munmap (data->buf, data->buf_length);
+  data->buf = buf;
+  data->buf_length = size;
+
+  wl_shm_pool_resize (data->pool, size);
+
+  return TRUE;
+}
+
 static void
 gdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1315,10 +1353,49 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->pool)
     wl_shm_pool_destroy (data->pool);
 
-  munmap (data->buf, data->buf_length);
+  if (data->buf)
+    munmap (data->buf, data->buf_length);
+
+  if (data->fd >= 0)
+    close (data->fd);
+
   g_free (data);
 }
 
+static cairo_surface_t *
+create_shm_surface_for_data (GdkWaylandCairoSurfaceData *data,
+                             int                         width,
+                             int                         height,
+                             int                         stride)
+{
+  cairo_surface_t *surface;
+  cairo_status_t status;
+
+  surface = cairo_image_surface_create_for_data (data->buf,
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 width*data->scale,
+                                                 height*data->scale,
+                                                 stride);
+
+  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
+                                            width*data->scale, height*data->scale,
+                                            stride, WL_SHM_FORMAT_ARGB8888);
+
+  cairo_surface_set_user_data (surface, &gdk_wayland_shm_surface_cairo_key,
+                               data, gdk_wayland_cairo_surface_destroy);
+
+  cairo_surface_set_device_scale (surface, data->scale, data->scale);
+
+  status = cairo_surface_status (surface);
+  if (status != CAIRO_STATUS_SUCCESS)
+    {
+      g_critical (G_STRLOC ": Unable to create Cairo image surface: %s",
+                  cairo_status_to_string (status));
+    }
+
+  return surface;
+}
+
 cairo_surface_t *
 _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
                                          int                width,
@@ -1326,45 +1403,73 @@ _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
                                          guint              scale)
 {
   GdkWaylandCairoSurfaceData *data;
-  cairo_surface_t *surface = NULL;
-  cairo_status_t status;
   int stride;
 
   data = g_new (GdkWaylandCairoSurfaceData, 1);
   data->display = display;
+  data->buf = NULL;
+  data->buf_length = 0;
   data->buffer = NULL;
+  data->fd = -1;
   data->scale = scale;
 
   stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width*scale);
 
   data->pool = create_shm_pool (display->shm,
                                 height*scale*stride,
+                                &data->fd,
                                 &data->buf_length,
                                 &data->buf);
 
-  surface = cairo_image_surface_create_for_data (data->buf,
-                                                 CAIRO_FORMAT_ARGB32,
-                                                 width*scale,
-                                                 height*scale,
-                                                 stride);
+  return create_shm_surface_for_data (data, width, height, stride);
+}
 
-  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
-                                            width*scale, height*scale,
-                                            stride, WL_SHM_FORMAT_ARGB8888);
+/**
+ * _gdk_wayland_shm_surface_resize:
+ * @surface: a shm surface whose buffer was released by the compositor
+ * @width: the new width
+ * @height: the new height
+ * @scale: the new scale
+ *
+ * Creates a new shm surface of the given size that takes over the
+ * shared memory of @surface, growing it if needed. The buffer of
+ * @surface must not be used anymore afterwards, but @surface itself
+ * still needs to be destroyed.
+ *
+ * Returns: the new surface
+ **/
+cairo_surface_t *
+_gdk_wayland_shm_surface_resize (cairo_surface_t *surface,
+                                 int              width,
+                                 int              height,
+                                 guint            scale)
+{
+  GdkWaylandCairoSurfaceData *old_data = cairo_surface_get_user_data (surface, &gdk_wayland_shm_surface_cairo_key);
+  GdkWaylandCairoSurfaceData *data;
+  int stride;
 
-  cairo_surface_set_user_data (surface, &gdk_wayland_shm_surface_cairo_key,
-                               data, gdk_wayland_cairo_surface_destroy);
+  if (old_data->pool == NULL)
+    return _gdk_wayland_display_create_shm_surface (old_data->display, width, height, scale);
+
+  data = g_new (GdkWaylandCairoSurfaceData, 1);
+  data->display = old_data->display;
+  data->buffer = NULL;
+  data->scale = scale;
+  data->pool = g_steal_pointer (&old_data->pool);
+  data->buf = g_steal_pointer (&old_data->buf);
+  data->buf_length = old_data->buf_length;
+  data->fd = old_data->fd;
+  old_data->fd = -1;
 
-  cairo_surface_set_device_scale (surface, scale, scale);
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width*scale);
 
-  status = cairo_surface_status (surface);
-  if (status != CAIRO_STATUS_SUCCESS)
+  if (!grow_shm_pool (data, height*scale*stride))
     {
-      g_critical (G_STRLOC ": Unable to create Cairo image surface: %s",
-                  cairo_status_to_string (status));
+      gdk_wayland_cairo_surface_destroy (data);
+      return _gdk_wayland_display_create_shm_surface (old_data->display, width, height, scale);
     }
 
-  return surface;
+  return create_shm_surface_for_data (data, width, height, stride);
 }
 
 struct wl_buffer *
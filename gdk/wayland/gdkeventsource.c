@@ -20,8 +20,11 @@
 #include "gdkinternals.h"
 #include "gdkprivate-wayland.h"
 
+#include <glib-unix.h>
+
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 
 typedef struct _GdkWaylandEventSource {
   GSource source;
@@ -29,8 +32,81 @@ typedef struct _GdkWaylandEventSource {
   uint32_t mask;
   GdkDisplay *display;
   gboolean reading;
+
+  /* see read_thread_func() */
+  GThread *read_thread;
+  struct wl_event_queue *read_queue;
+  int stop_fds[2];
 } GdkWaylandEventSource;
 
+/* Reads events from the socket while the main thread is busy, so
+ * the compositor doesn't have to buffer them and they are ready to
+ * be dispatched as soon as the main loop gets to them.
+ *
+ * libwayland allows any number of threads to read: each of them
+ * prepares to read, polls, and then reads or cancels, and the events
+ * end up in the queues of their proxies. This thread prepares on a
+ * queue that has no proxies, so it never dispatches anything itself;
+ * all events still go to the default queue, which is only dispatched
+ * in the main thread. After reading, the main context is woken up,
+ * because the socket doesn't poll as readable there anymore.
+ */
+static gpointer
+read_thread_func (gpointer data)
+{
+  GdkWaylandEventSource *source = data;
+  GdkWaylandDisplay *display_wayland = (GdkWaylandDisplay *) source->display;
+  struct wl_display *wl_display = display_wayland->wl_display;
+  GMainContext *context = g_source_get_context ((GSource *) source);
+  struct pollfd fds[2];
+
+  fds[0].fd = wl_display_get_fd (wl_display);
+  fds[0].events = POLLIN;
+  fds[1].fd = source->stop_fds[0];
+  fds[1].events = POLLIN;
+
+  while (TRUE)
+    {
+      if (wl_display_prepare_read_queue (wl_display, source->read_queue) != 0)
+        break;
+
+      if (poll (fds, G_N_ELEMENTS (fds), -1) < 0)
+        {
+          wl_display_cancel_read (wl_display);
+          if (errno == EINTR)
+            continue;
+          break;
+        }
+
+      if (fds[1].revents)
+        {
+          wl_display_cancel_read (wl_display);
+          break;
+        }
+
+      if (fds[0].revents & POLLIN)
+        {
+          /* this waits for the main thread if it is preparing to read too */
+          if (wl_display_read_events (wl_display) < 0)
+            {
+              g_main_context_wakeup (context);
+              break;
+            }
+        }
+      else
+        {
+          /* errors and hangups are handled by the main thread */
+          wl_display_cancel_read (wl_display);
+          g_main_context_wakeup (context);
+          break;
+        }
+
+      g_main_context_wakeup (context);
+    }
+
+  return NULL;
+}
+
 static gboolean
 gdk_event_source_prepare (GSource *base,
                           gint    *timeout)
@@ -136,6 +212,20 @@ gdk_event_source_finalize (GSource *base)
   if (source->reading)
     wl_display_cancel_read (display->wl_display);
   source->reading = FALSE;
+
+  if (source->read_thread)
+    {
+      char c = 0;
+
+      if (write (source->stop_fds[1], &c, 1) < 0)
+        g_warning ("Failed to stop the Wayland read thread: %s", g_strerror (errno));
+      g_thread_join (source->read_thread);
+      source->read_thread = NULL;
+
+      close (source->stop_fds[0]);
+      close (source->stop_fds[1]);
+      wl_event_queue_destroy (source->read_queue);
+    }
 }
 
 static GSourceFuncs wl_glib_source_funcs = {
@@ -185,6 +275,12 @@ _gdk_wayland_display_event_source_new (GdkDisplay *display)
   g_source_set_can_recurse (source, TRUE);
   g_source_attach (source, NULL);
 
+  if (g_unix_open_pipe (wl_source->stop_fds, FD_CLOEXEC, NULL))
+    {
+      wl_source->read_queue = wl_display_create_queue (display_wayland->wl_display);
+      wl_source->read_thread = g_thread_new ("gdk-wayland-read", read_thread_func, wl_source);
+    }
+
   return source;
 }
 
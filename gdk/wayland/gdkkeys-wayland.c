@@ -54,6 +54,8 @@ struct _GdkWaylandKeymap
 
   PangoDirection *direction;
   gboolean bidi;
+
+  GdkKeymapTranslationCache translations;
 };
 
 struct _GdkWaylandKeymapClass
@@ -326,6 +328,7 @@ gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 					     gint            *effective_level,
 					     GdkModifierType *consumed_modifiers)
 {
+  GdkWaylandKeymap *keymap_wayland;
   struct xkb_keymap *xkb_keymap;
   struct xkb_state *xkb_state;
   guint32 modifiers;
@@ -333,11 +336,19 @@ gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
   xkb_layout_index_t layout;
   xkb_level_index_t level;
   xkb_keysym_t sym;
+  gboolean result;
 
   g_return_val_if_fail (keymap == NULL || GDK_IS_KEYMAP (keymap), FALSE);
   g_return_val_if_fail (group < 4, FALSE);
 
-  xkb_keymap = GDK_WAYLAND_KEYMAP (keymap)->xkb_keymap;
+  keymap_wayland = GDK_WAYLAND_KEYMAP (keymap);
+  xkb_keymap = keymap_wayland->xkb_keymap;
+
+  if (gdk_keymap_translation_cache_lookup (&keymap_wayland->translations,
+                                           hardware_keycode, state, group,
+                                           keyval, effective_group, effective_level,
+                                           consumed_modifiers, &result))
+    return result;
 
   modifiers = get_xkb_modifiers (xkb_keymap, state);
 
@@ -352,6 +363,12 @@ gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 
   xkb_state_unref (xkb_state);
 
+  gdk_keymap_translation_cache_insert (&keymap_wayland->translations,
+                                       hardware_keycode, state, group,
+                                       sym, layout, level,
+                                       get_gdk_modifiers (xkb_keymap, consumed),
+                                       sym != XKB_KEY_NoSymbol);
+
   if (keyval)
     *keyval = sym;
   if (effective_group)
@@ -647,6 +664,8 @@ _gdk_wayland_keymap_update_from_fd (GdkKeymap *keymap,
   xkb_state_unref (keymap_wayland->xkb_state);
   keymap_wayland->xkb_state = xkb_state_new (keymap_wayland->xkb_keymap);
 
+  gdk_keymap_translation_cache_clear (&keymap_wayland->translations);
+
   xkb_context_unref (context);
 
   update_direction (keymap_wayland);
@@ -178,6 +178,10 @@ cairo_surface_t * _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *di
                                                            int                width,
                                                            int                height,
                                                            guint              scale);
+cairo_surface_t * _gdk_wayland_shm_surface_resize (cairo_surface_t *surface,
+                                                   int              width,
+                                                   int              height,
+                                                   guint            scale);
 struct wl_buffer *_gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface);
 gboolean _gdk_wayland_is_shm_surface (cairo_surface_t *surface);
 
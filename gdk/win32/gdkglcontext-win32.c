@@ -138,8 +138,13 @@ gdk_win32_gl_context_end_frame (GdkDrawContext *draw_context,
     }
 
   whole_window = (GdkRectangle) { 0, 0, gdk_surface_get_width (surface), gdk_surface_get_height (surface) };
-  if (cairo_region_contains_rectangle (painted, &whole_window) == CAIRO_REGION_OVERLAP_IN)
+  if (context_win32->swap_copy ||
+      cairo_region_contains_rectangle (painted, &whole_window) == CAIRO_REGION_OVERLAP_IN)
     {
+      /* With a copying swap the parts of the back buffer that were not
+       * repainted are still valid, so this presents the frame in one
+       * step instead of drawing into the visible front buffer.
+       */
       SwapBuffers (context_win32->gl_hdc);
     }
   else if (gdk_gl_context_has_framebuffer_blit (context))
@@ -192,6 +197,9 @@ gdk_win32_gl_context_begin_frame (GdkDrawContext *draw_context,
   if (gdk_gl_context_get_shared_context (context))
     return;
 
+  if (GDK_WIN32_GL_CONTEXT (context)->swap_copy)
+    return;
+
   if (gdk_gl_context_has_framebuffer_blit (context))
     return;
 
@@ -279,24 +287,29 @@ _get_dummy_window_hwnd (GdkWGLDummy *dummy)
 static gint
 _gdk_init_dummy_context (GdkWGLDummy *dummy);
 
-#define PIXEL_ATTRIBUTES 17
+#define PIXEL_ATTRIBUTES 19
 
 static gint
 _get_wgl_pfd (HDC                    hdc,
               PIXELFORMATDESCRIPTOR *pfd,
-              GdkWin32Display       *display)
+              GdkWin32Display       *display,
+              gboolean              *swap_copy)
 {
   gint best_pf = 0;
 
   pfd->nSize = sizeof (PIXELFORMATDESCRIPTOR);
 
+  if (swap_copy != NULL)
+    *swap_copy = FALSE;
+
   if (display != NULL && display->hasWglARBPixelFormat)
     {
       GdkWGLDummy dummy;
-      UINT num_formats;
+      UINT num_formats = 0;
       gint colorbits = GetDeviceCaps (hdc, BITSPIXEL);
       guint extra_fields = 1;
       gint i = 0;
+      gint swap_method_idx;
       int pixelAttribs[PIXEL_ATTRIBUTES];
 
       /* Save up the HDC and HGLRC that we are currently using, to restore back to it when we are done here */
@@ -311,7 +324,7 @@ _get_wgl_pfd (HDC                    hdc,
 
       /* Update PIXEL_ATTRIBUTES above if any groups are added here! */
       /* one group contains a value pair for both pixelAttribs and pixelAttribsNoAlpha */
-      pixelAttribs[i] = WGL_DRAW_TO_WINDOW_ARB;
+      pixelAttribs[i++] = WGL_DRAW_TO_WINDOW_ARB;
       pixelAttribs[i++] = GL_TRUE;
 
       pixelAttribs[i++] = WGL_SUPPORT_OPENGL_ARB;
@@ -340,6 +353,16 @@ _get_wgl_pfd (HDC                    hdc,
           pixelAttribs[i++] = 8;
         }
 
+      /* Prefer formats that keep the contents of the back buffer
+       * across SwapBuffers(), so that only the damaged parts of a
+       * frame need to be repainted, see begin_frame(). This must
+       * stay the last group, as it is dropped again if no such
+       * format exists.
+       */
+      swap_method_idx = i;
+      pixelAttribs[i++] = WGL_SWAP_METHOD_ARB;
+      pixelAttribs[i++] = WGL_SWAP_COPY_ARB;
+
       pixelAttribs[i++] = 0; /* end of pixelAttribs */
 
       memset (&dummy, 0, sizeof (GdkWGLDummy));
@@ -355,12 +378,27 @@ _get_wgl_pfd (HDC                    hdc,
           return 0;
         }
 
-      wglChoosePixelFormatARB (hdc,
-                               pixelAttribs,
-                               NULL,
-                               1,
-                               &best_pf,
-                               &num_formats);
+      if (wglChoosePixelFormatARB (hdc,
+                                   pixelAttribs,
+                                   NULL,
+                                   1,
+                                   &best_pf,
+                                   &num_formats) &&
+          num_formats > 0)
+        {
+          if (swap_copy != NULL)
+            *swap_copy = TRUE;
+        }
+      else
+        {
+          pixelAttribs[swap_method_idx] = 0;
+          wglChoosePixelFormatARB (hdc,
+                                   pixelAttribs,
+                                   NULL,
+                                   1,
+                                   &best_pf,
+                                   &num_formats);
+        }
 
       /* Go back to the HDC that we were using, since we are done with the dummy HDC and GL Context */
       wglMakeCurrent (hdc_current, hglrc_current);
@@ -396,7 +434,7 @@ _gdk_init_dummy_context (GdkWGLDummy *dummy)
   dummy->hdc = GetDC (dummy->hwnd);
   memset (&pfd, 0, sizeof (PIXELFORMATDESCRIPTOR));
 
-  best_idx = _get_wgl_pfd (dummy->hdc, &pfd, NULL);
+  best_idx = _get_wgl_pfd (dummy->hdc, &pfd, NULL, NULL);
 
   if (best_idx != 0)
     set_pixel_format_result = SetPixelFormat (dummy->hdc,
@@ -629,7 +667,8 @@ gl_fail:
 static gboolean
 _set_pixformat_for_hdc (HDC              hdc,
                         gint            *best_idx,
-                        GdkWin32Display *display)
+                        GdkWin32Display *display,
+                        gboolean        *swap_copy)
 {
   PIXELFORMATDESCRIPTOR pfd;
   gboolean set_pixel_format_result = FALSE;
@@ -637,7 +676,7 @@ _set_pixformat_for_hdc (HDC              hdc,
   /* one is only allowed to call SetPixelFormat(), and so ChoosePixelFormat()
    * one single time per window HDC
    */
-  *best_idx = _get_wgl_pfd (hdc, &pfd, display);
+  *best_idx = _get_wgl_pfd (hdc, &pfd, display, swap_copy);
 
   if (*best_idx != 0)
     set_pixel_format_result = SetPixelFormat (hdc, *best_idx, &pfd);
@@ -659,6 +698,7 @@ gdk_win32_gl_context_realize (GdkGLContext *context,
   /* These are the real WGL context items that we will want to use later */
   HGLRC hglrc;
   gint pixel_format;
+  gboolean swap_copy;
   gboolean debug_bit, compat_bit, legacy_bit;
 
   /* request flags and specific versions for core (3.2+) WGL context */
@@ -672,7 +712,8 @@ gdk_win32_gl_context_realize (GdkGLContext *context,
 
   if (!_set_pixformat_for_hdc (context_win32->gl_hdc,
                                &pixel_format,
-                               win32_display))
+                               win32_display,
+                               &swap_copy))
     {
       g_set_error_literal (error, GDK_GL_ERROR,
                            GDK_GL_ERROR_UNSUPPORTED_FORMAT,
@@ -681,6 +722,8 @@ gdk_win32_gl_context_realize (GdkGLContext *context,
       return FALSE;
     }
 
+  context_win32->swap_copy = swap_copy;
+
   gdk_gl_context_get_required_version (context, &glver_major, &glver_minor);
   debug_bit = gdk_gl_context_get_debug_enabled (context);
   compat_bit = gdk_gl_context_get_forward_compatible (context);
@@ -39,6 +39,7 @@ struct _GdkWin32GLContext
   HGLRC hglrc;
   HDC gl_hdc;
   guint need_alpha_bits : 1;
+  guint swap_copy : 1;
 
   /* other items */
   guint is_attached : 1;
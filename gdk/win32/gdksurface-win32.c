@@ -278,6 +278,7 @@ gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
 {
   DWM_TIMING_INFO timing_info;
   LARGE_INTEGER tick_frequency;
+  LARGE_INTEGER now;
   GdkFrameTimings *timings;
 
   timings = gdk_frame_clock_get_timings (clock, gdk_frame_clock_get_frame_counter (clock));
@@ -296,8 +297,19 @@ gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
 
           if (SUCCEEDED (hr))
             {
+              QPC_TIME compose = timing_info.qpcCompose;
+
+              /* qpcCompose is the last composition that happened, but
+               * the frame that was just painted is only shown by the
+               * next one.
+               */
+              if (timing_info.qpcRefreshPeriod > 0 &&
+                  QueryPerformanceCounter (&now) &&
+                  compose <= (QPC_TIME) now.QuadPart)
+                compose += ((now.QuadPart - compose) / timing_info.qpcRefreshPeriod + 1) * timing_info.qpcRefreshPeriod;
+
               timings->refresh_interval = timing_info.qpcRefreshPeriod * (gdouble)G_USEC_PER_SEC / tick_frequency.QuadPart;
-              timings->presentation_time = timing_info.qpcCompose * (gdouble)G_USEC_PER_SEC / tick_frequency.QuadPart;
+              timings->presentation_time = compose * (gdouble)G_USEC_PER_SEC / tick_frequency.QuadPart;
             }
         }
 
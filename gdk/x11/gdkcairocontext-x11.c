@@ -53,27 +53,56 @@ create_cairo_surface_for_surface (GdkSurface *surface)
   return cairo_surface;
 }
 
+static void
+gdk_x11_cairo_context_surface_resized (GdkDrawContext *draw_context)
+{
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
+
+  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+  g_clear_pointer (&self->window_surface, cairo_surface_destroy);
+}
+
+/* Both surfaces are kept from one frame to the next until the
+ * surface is resized, so that frames don't have to allocate and
+ * fault in a new image or create a new Picture on the server.
+ */
 static void
 gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
                                    cairo_region_t *region)
 {
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
-  GdkRectangle clip_box;
   GdkSurface *surface;
-  double sx, sy;
+  cairo_t *cr;
+  int scale;
 
   surface = gdk_draw_context_get_surface (draw_context);
-  cairo_region_get_extents (region, &clip_box);
-
-  self->window_surface = create_cairo_surface_for_surface (surface);
-  self->paint_surface = gdk_surface_create_similar_surface (surface,
-                                                            cairo_surface_get_content (self->window_surface),
-                                                            MAX (clip_box.width, 1),
-                                                            MAX (clip_box.height, 1));
+  scale = gdk_surface_get_scale_factor (surface);
 
-  sx = sy = 1;
-  cairo_surface_get_device_scale (self->paint_surface, &sx, &sy);
-  cairo_surface_set_device_offset (self->paint_surface, -clip_box.x*sx, -clip_box.y*sy);
+  /* Not every size or scale change is announced with surface_resized */
+  if (self->paint_surface &&
+      (cairo_image_surface_get_width (self->paint_surface) != MAX (gdk_surface_get_width (surface), 1) * scale ||
+       cairo_image_surface_get_height (self->paint_surface) != MAX (gdk_surface_get_height (surface), 1) * scale))
+    gdk_x11_cairo_context_surface_resized (draw_context);
+
+  if (self->window_surface == NULL)
+    self->window_surface = create_cairo_surface_for_surface (surface);
+
+  if (self->paint_surface == NULL)
+    {
+      self->paint_surface = gdk_surface_create_similar_surface (surface,
+                                                                cairo_surface_get_content (self->window_surface),
+                                                                MAX (gdk_surface_get_width (surface), 1),
+                                                                MAX (gdk_surface_get_height (surface), 1));
+    }
+  else
+    {
+      /* clear the repaint area */
+      cr = cairo_create (self->paint_surface);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      gdk_cairo_region (cr, region);
+      cairo_fill (cr);
+      cairo_destroy (cr);
+    }
 }
 
 static void
@@ -95,9 +124,6 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   cairo_destroy (cr);
 
   cairo_surface_flush (self->window_surface);
-
-  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
-  g_clear_pointer (&self->window_surface, cairo_surface_destroy);
 }
 
 static cairo_t *
@@ -108,14 +134,29 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+  g_clear_pointer (&self->window_surface, cairo_surface_destroy);
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  gobject_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
+  draw_context_class->surface_resized = gdk_x11_cairo_context_surface_resized;
 
   cairo_context_class->cairo_create = gdk_x11_cairo_context_cairo_create;
 }
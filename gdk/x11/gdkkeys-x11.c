@@ -81,6 +81,9 @@ struct _GdkX11Keymap
   guint modifier_state;
   guint current_serial;
 
+  GdkKeymapTranslationCache translations;
+  guint translations_serial;
+
 #ifdef HAVE_XKB
   XkbDescPtr xkb_desc;
   /* We cache the directions */
@@ -1295,11 +1298,28 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
                                          GdkModifierType *consumed_modifiers)
 {
   GdkX11Keymap *keymap_x11 = GDK_X11_KEYMAP (keymap);
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (keymap->display);
+  GdkModifierType requested_state = state;
   KeySym tmp_keyval = NoSymbol;
   guint tmp_modifiers;
+  gint tmp_group = 0;
+  gint tmp_level = 0;
+  gboolean result;
 
   g_return_val_if_fail (group < 4, FALSE);
 
+  if (keymap_x11->translations_serial != display_x11->keymap_serial)
+    {
+      gdk_keymap_translation_cache_clear (&keymap_x11->translations);
+      keymap_x11->translations_serial = display_x11->keymap_serial;
+    }
+
+  if (gdk_keymap_translation_cache_lookup (&keymap_x11->translations,
+                                           hardware_keycode, state, group,
+                                           keyval, effective_group, level,
+                                           consumed_modifiers, &result))
+    return result;
+
   if (keyval)
     *keyval = NoSymbol;
   if (effective_group)
@@ -1329,8 +1349,8 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
                                      state,
                                      &tmp_modifiers,
                                      &tmp_keyval,
-                                     effective_group,
-                                     level);
+                                     &tmp_group,
+                                     &tmp_level);
 
       if (state & ~tmp_modifiers & LockMask)
         tmp_keyval = gdk_keyval_to_upper (tmp_keyval);
@@ -1372,9 +1392,21 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 
       tmp_keyval = translate_keysym (keymap_x11, hardware_keycode,
                                      group, state,
-                                     level, effective_group);
+                                     &tmp_level, &tmp_group);
     }
 
+  gdk_keymap_translation_cache_insert (&keymap_x11->translations,
+                                       hardware_keycode, requested_state, group,
+                                       tmp_keyval, tmp_group, tmp_level,
+                                       tmp_modifiers,
+                                       tmp_keyval != NoSymbol);
+
+  if (effective_group)
+    *effective_group = tmp_group;
+
+  if (level)
+    *level = tmp_level;
+
   if (consumed_modifiers)
     *consumed_modifiers = tmp_modifiers;
 
@@ -188,6 +188,24 @@ gdk_x11_selection_output_stream_needs_flush_unlocked (GdkX11SelectionOutputStrea
   return priv->data->len >= gdk_x11_display_get_max_request_size (priv->display);
 }
 
+/* Limits writes to what fits into the next property change, so large
+ * writes are sent in chunks as the requestor reads them instead of
+ * being copied into our buffer all at once.
+ */
+static gsize
+gdk_x11_selection_output_stream_get_write_size_unlocked (GdkX11SelectionOutputStream *stream,
+                                                         gsize                        count)
+{
+  GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
+  gsize max_size;
+
+  max_size = gdk_x11_display_get_max_request_size (priv->display);
+  if (priv->data->len >= max_size)
+    return count;
+
+  return MIN (count, max_size - priv->data->len);
+}
+
 static gboolean
 gdk_x11_selection_output_stream_needs_flush (GdkX11SelectionOutputStream *stream)
 {
@@ -335,6 +353,7 @@ gdk_x11_selection_output_stream_write (GOutputStream  *output_stream,
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
 
   g_mutex_lock (&priv->mutex);
+  count = gdk_x11_selection_output_stream_get_write_size_unlocked (stream, count);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: wrote %zu bytes, %u total now\n",
                                   priv->selection, priv->target, count, priv->data->len));
@@ -368,6 +387,7 @@ gdk_x11_selection_output_stream_write_async (GOutputStream        *output_stream
   g_task_set_priority (task, io_priority);
 
   g_mutex_lock (&priv->mutex);
+  count = gdk_x11_selection_output_stream_get_write_size_unlocked (stream, count);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: async wrote %zu bytes, %u total now\n",
                                   priv->selection, priv->target, count, priv->data->len));
@@ -24,6 +24,13 @@ struct _GskBroadwayRenderer
   /* Kept from last frame */
   GHashTable *last_node_lookup;
   GskRenderNode *last_root; /* Owning refs to the things in last_node_lookup */
+
+  /* Fallback renderings by their area, see add_fallback_node() */
+  GHashTable *fallbacks;
+  guint frame;
+
+  /* GlyphKey => GdkTexture, see add_text_node() */
+  GHashTable *glyphs;
 };
 
 struct _GskBroadwayRendererClass
@@ -56,6 +63,8 @@ static void
 gsk_broadway_renderer_unrealize (GskRenderer *renderer)
 {
   GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  g_hash_table_remove_all (self->fallbacks);
+  g_hash_table_remove_all (self->glyphs);
   g_clear_object (&self->draw_context);
 }
 
@@ -245,6 +254,8 @@ collect_reused_child_nodes (GskRenderer *renderer,
     case GSK_COLOR_MATRIX_NODE:
     case GSK_TEXT_NODE:
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     case GSK_REPEAT_NODE:
     case GSK_BLEND_NODE:
     case GSK_CROSS_FADE_NODE:
@@ -466,6 +477,457 @@ get_colorized_texture (GdkTexture *texture,
 }
 
 
+/* When a fallback node gets rendered again with the same area, its
+ * texture is usually mostly the same as before, like for a label whose
+ * text changed. So we keep the last texture uploaded for every area and
+ * only upload the part that changed. The browser then shows the old
+ * texture around the changed part. */
+typedef struct {
+  int x, y, width, height;
+} FallbackKey;
+
+typedef struct {
+  FallbackKey key;
+  cairo_surface_t *surface;
+  GdkTexture *texture;
+  guint frame; /* Last frame it was used in */
+} Fallback;
+
+/* Above this fraction of the area we upload the whole texture again */
+#define MAX_FALLBACK_PATCH_FRACTION 0.5
+
+/* Renderings not used for this many frames are dropped */
+#define MAX_FALLBACK_AGE 60
+
+static guint
+fallback_key_hash (gconstpointer data)
+{
+  const FallbackKey *key = data;
+
+  return (guint) key->x ^ ((guint) key->y << 8) ^
+         ((guint) key->width << 16) ^ ((guint) key->height << 24);
+}
+
+static gboolean
+fallback_key_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  const FallbackKey *ka = a;
+  const FallbackKey *kb = b;
+
+  return ka->x == kb->x && ka->y == kb->y &&
+         ka->width == kb->width && ka->height == kb->height;
+}
+
+static void
+fallback_free (Fallback *fallback)
+{
+  cairo_surface_destroy (fallback->surface);
+  g_object_unref (fallback->texture);
+  g_free (fallback);
+}
+
+static gboolean
+fallback_is_stale (gpointer key,
+                   gpointer value,
+                   gpointer user_data)
+{
+  Fallback *fallback = value;
+
+  return GPOINTER_TO_UINT (user_data) - fallback->frame > MAX_FALLBACK_AGE;
+}
+
+/* Finds the smallest rectangle containing all pixels that differ
+ * between two ARGB32 surfaces of the same size. Returns FALSE if
+ * there is none. */
+static gboolean
+get_changed_area (cairo_surface_t       *old_surface,
+                  cairo_surface_t       *new_surface,
+                  cairo_rectangle_int_t *area)
+{
+  const guchar *old_data = cairo_image_surface_get_data (old_surface);
+  const guchar *new_data = cairo_image_surface_get_data (new_surface);
+  int width = cairo_image_surface_get_width (new_surface);
+  int height = cairo_image_surface_get_height (new_surface);
+  int stride = cairo_image_surface_get_stride (new_surface);
+  int x, y, first_y, last_y, first_x, last_x;
+
+  for (first_y = 0; first_y < height; first_y++)
+    if (memcmp (old_data + first_y * stride, new_data + first_y * stride, width * 4) != 0)
+      break;
+
+  if (first_y == height)
+    return FALSE;
+
+  for (last_y = height - 1; last_y > first_y; last_y--)
+    if (memcmp (old_data + last_y * stride, new_data + last_y * stride, width * 4) != 0)
+      break;
+
+  first_x = width;
+  last_x = -1;
+  for (y = first_y; y <= last_y; y++)
+    {
+      const guint32 *old_row = (const guint32 *) (old_data + y * stride);
+      const guint32 *new_row = (const guint32 *) (new_data + y * stride);
+
+      for (x = 0; x < first_x; x++)
+        if (old_row[x] != new_row[x])
+          {
+            first_x = x;
+            break;
+          }
+
+      for (x = width - 1; x > last_x; x--)
+        if (old_row[x] != new_row[x])
+          {
+            last_x = x;
+            break;
+          }
+    }
+
+  area->x = first_x;
+  area->y = first_y;
+  area->width = last_x - first_x + 1;
+  area->height = last_y - first_y + 1;
+
+  return TRUE;
+}
+
+static void
+add_texture (GskBroadwayRenderer *self,
+             float                x,
+             float                y,
+             float                width,
+             float                height,
+             guint32              texture_id)
+{
+  add_uint32 (self->nodes, BROADWAY_NODE_TEXTURE);
+  add_uint32 (self->nodes, ++self->next_node_id);
+  add_xy (self->nodes, x, y, 0, 0);
+  add_float (self->nodes, width);
+  add_float (self->nodes, height);
+  add_uint32 (self->nodes, texture_id);
+}
+
+/* Shows the part of @texture inside the given rectangle, which is
+ * relative to its origin */
+static void
+add_clipped_texture (GskBroadwayRenderer *self,
+                     float                x,
+                     float                y,
+                     GdkTexture          *texture,
+                     guint32              texture_id,
+                     int                  clip_x,
+                     int                  clip_y,
+                     int                  clip_width,
+                     int                  clip_height)
+{
+  add_uint32 (self->nodes, BROADWAY_NODE_CLIP);
+  add_uint32 (self->nodes, ++self->next_node_id);
+  add_xy (self->nodes, x + clip_x, y + clip_y, 0, 0);
+  add_float (self->nodes, clip_width);
+  add_float (self->nodes, clip_height);
+  add_texture (self, - clip_x, - clip_y,
+               gdk_texture_get_width (texture), gdk_texture_get_height (texture),
+               texture_id);
+}
+
+static void
+add_fallback_node (GskRenderer   *renderer,
+                   GskRenderNode *node,
+                   float          offset_x,
+                   float          offset_y)
+{
+  GdkDisplay *display = gdk_surface_get_display (gsk_renderer_get_surface (renderer));
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  GArray *nodes = self->nodes;
+  FallbackKey key;
+  Fallback *fallback;
+  cairo_rectangle_int_t area;
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint32 texture_id;
+  float x, y;
+
+  /* Reused nodes don't need to be rendered at all */
+  if (self->last_node_lookup && g_hash_table_contains (self->last_node_lookup, node))
+    {
+      add_new_node (renderer, node, BROADWAY_NODE_TEXTURE);
+      return;
+    }
+
+  key.x = floorf (node->bounds.origin.x);
+  key.y = floorf (node->bounds.origin.y);
+  key.width = ceil (node->bounds.origin.x + node->bounds.size.width) - key.x;
+  key.height = ceil (node->bounds.origin.y + node->bounds.size.height) - key.y;
+  x = key.x - offset_x;
+  y = key.y - offset_y;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, key.width, key.height);
+  cr = cairo_create (surface);
+  cairo_translate (cr, -key.x, -key.y);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  fallback = g_hash_table_lookup (self->fallbacks, &key);
+  if (fallback == NULL || fallback->frame == self->frame)
+    {
+      /* Nothing to compare to, or another node already used this one */
+    }
+  else if (!get_changed_area (fallback->surface, surface, &area))
+    {
+      fallback->frame = self->frame;
+      add_new_node (renderer, node, BROADWAY_NODE_TEXTURE);
+      add_xy (nodes, x, y, 0, 0);
+      add_float (nodes, key.width);
+      add_float (nodes, key.height);
+      add_uint32 (nodes, gdk_broadway_display_ensure_texture (display, fallback->texture));
+
+      cairo_surface_destroy (surface);
+      return;
+    }
+  else if (area.width * area.height <= MAX_FALLBACK_PATCH_FRACTION * key.width * key.height)
+    {
+      cairo_surface_t *patch;
+      guint32 n_children;
+      int right, bottom;
+
+      fallback->frame = self->frame;
+      texture_id = gdk_broadway_display_ensure_texture (display, fallback->texture);
+
+      patch = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, area.width, area.height);
+      cr = cairo_create (patch);
+      cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface (cr, surface, -area.x, -area.y);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+      cairo_surface_destroy (surface);
+
+      texture = gdk_texture_new_for_surface (patch);
+      g_ptr_array_add (self->node_textures, texture); /* Transfers ownership to node_textures */
+      cairo_surface_destroy (patch);
+
+      right = area.x + area.width;
+      bottom = area.y + area.height;
+      n_children = 1 + (area.y > 0) + (bottom < key.height) +
+                   (area.x > 0) + (right < key.width);
+
+      /* The old texture above, below, left and right of the patch */
+      add_new_node (renderer, node, BROADWAY_NODE_CONTAINER);
+      add_uint32 (nodes, n_children);
+      if (area.y > 0)
+        add_clipped_texture (self, x, y, fallback->texture, texture_id,
+                             0, 0, key.width, area.y);
+      if (bottom < key.height)
+        add_clipped_texture (self, x, y, fallback->texture, texture_id,
+                             0, bottom, key.width, key.height - bottom);
+      if (area.x > 0)
+        add_clipped_texture (self, x, y, fallback->texture, texture_id,
+                             0, area.y, area.x, area.height);
+      if (right < key.width)
+        add_clipped_texture (self, x, y, fallback->texture, texture_id,
+                             right, area.y, key.width - right, area.height);
+      add_texture (self, x + area.x, y + area.y, area.width, area.height,
+                   gdk_broadway_display_ensure_texture (display, texture));
+      return;
+    }
+
+  texture = gdk_texture_new_for_surface (surface);
+  texture_id = gdk_broadway_display_ensure_texture (display, texture);
+
+  if (fallback != NULL && fallback->frame == self->frame)
+    {
+      /* Another node already shows the cached one this frame */
+      g_ptr_array_add (self->node_textures, texture); /* Transfers ownership to node_textures */
+      cairo_surface_destroy (surface);
+    }
+  else
+    {
+      if (fallback == NULL)
+        {
+          fallback = g_new0 (Fallback, 1);
+          fallback->key = key;
+          g_hash_table_insert (self->fallbacks, &fallback->key, fallback);
+        }
+      else
+        {
+          cairo_surface_destroy (fallback->surface);
+          g_object_unref (fallback->texture);
+        }
+
+      fallback->surface = surface; /* Transfers ownership to the fallback */
+      fallback->texture = texture;
+      fallback->frame = self->frame;
+    }
+
+  add_new_node (renderer, node, BROADWAY_NODE_TEXTURE);
+  add_xy (nodes, x, y, 0, 0);
+  add_float (nodes, key.width);
+  add_float (nodes, key.height);
+  add_uint32 (nodes, texture_id);
+}
+
+/* Text nodes are sent as one texture node per glyph. Every glyph is
+ * rendered and uploaded once per font and color, so redrawing text
+ * only sends the positions of the glyphs. */
+typedef struct {
+  PangoFont *font;
+  PangoGlyph glyph;
+  guint32 color;
+} GlyphKey;
+
+/* The cache is emptied at the start of a frame once it gets bigger */
+#define MAX_CACHED_GLYPHS 4096
+
+static guint
+glyph_key_hash (gconstpointer data)
+{
+  const GlyphKey *key = data;
+
+  return g_direct_hash (key->font) ^ (key->glyph << 8) ^ key->color;
+}
+
+static gboolean
+glyph_key_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const GlyphKey *ka = a;
+  const GlyphKey *kb = b;
+
+  return ka->font == kb->font && ka->glyph == kb->glyph && ka->color == kb->color;
+}
+
+static void
+glyph_key_free (GlyphKey *key)
+{
+  g_object_unref (key->font);
+  g_free (key);
+}
+
+/* Returns the texture for the ink rect of a glyph, or %NULL if the
+ * glyph does not draw anything */
+static GdkTexture *
+get_glyph_texture (GskBroadwayRenderer *self,
+                   PangoFont           *font,
+                   PangoGlyph           glyph,
+                   const GdkRGBA       *color,
+                   PangoRectangle      *ink_rect)
+{
+  GlyphKey lookup = { font, glyph, rgba_to_uint32 (color) };
+  GlyphKey *key;
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  PangoGlyphString glyph_string;
+  PangoGlyphInfo glyph_info;
+
+  pango_font_get_glyph_extents (font, glyph, ink_rect, NULL);
+  pango_extents_to_pixels (ink_rect, NULL);
+
+  if (ink_rect->width <= 0 || ink_rect->height <= 0)
+    return NULL;
+
+  texture = g_hash_table_lookup (self->glyphs, &lookup);
+  if (texture)
+    return texture;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, ink_rect->width, ink_rect->height);
+  cr = cairo_create (surface);
+  gdk_cairo_set_source_rgba (cr, color);
+
+  glyph_info.glyph = glyph;
+  glyph_info.geometry.width = ink_rect->width * PANGO_SCALE;
+  if (glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+    glyph_info.geometry.x_offset = 0;
+  else
+    glyph_info.geometry.x_offset = - ink_rect->x * PANGO_SCALE;
+  glyph_info.geometry.y_offset = - ink_rect->y * PANGO_SCALE;
+
+  glyph_string.num_glyphs = 1;
+  glyph_string.glyphs = &glyph_info;
+  glyph_string.log_clusters = NULL;
+
+  pango_cairo_show_glyph_string (cr, font, &glyph_string);
+  cairo_destroy (cr);
+
+  texture = gdk_texture_new_for_surface (surface);
+  cairo_surface_destroy (surface);
+
+  key = g_new (GlyphKey, 1);
+  key->font = g_object_ref (font);
+  key->glyph = glyph;
+  key->color = lookup.color;
+  g_hash_table_insert (self->glyphs, key, texture);
+
+  return texture;
+}
+
+static void
+add_text_node (GskRenderer   *renderer,
+               GskRenderNode *node,
+               float          offset_x,
+               float          offset_y)
+{
+  GdkDisplay *display = gdk_surface_get_display (gsk_renderer_get_surface (renderer));
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  PangoFont *font = (PangoFont *) gsk_text_node_peek_font (node);
+  const PangoGlyphInfo *glyphs = gsk_text_node_peek_glyphs (node);
+  const GdkRGBA *color = gsk_text_node_peek_color (node);
+  guint num_glyphs = gsk_text_node_get_num_glyphs (node);
+  float x = gsk_text_node_get_x (node) - offset_x;
+  float y = gsk_text_node_get_y (node) - offset_y;
+  GdkTexture **textures;
+  PangoRectangle *ink_rects;
+  guint i, n_children;
+  int x_position;
+
+  if (!add_new_node (renderer, node, BROADWAY_NODE_CONTAINER))
+    return;
+
+  textures = g_new (GdkTexture *, num_glyphs);
+  ink_rects = g_new (PangoRectangle, num_glyphs);
+
+  n_children = 0;
+  for (i = 0; i < num_glyphs; i++)
+    {
+      if (glyphs[i].glyph == PANGO_GLYPH_EMPTY)
+        textures[i] = NULL;
+      else
+        textures[i] = get_glyph_texture (self, font, glyphs[i].glyph, color, &ink_rects[i]);
+
+      if (textures[i])
+        n_children++;
+    }
+
+  add_uint32 (self->nodes, n_children);
+
+  x_position = 0;
+  for (i = 0; i < num_glyphs; i++)
+    {
+      const PangoGlyphInfo *gi = &glyphs[i];
+
+      if (textures[i])
+        {
+          float cx = (float) (x_position + gi->geometry.x_offset) / PANGO_SCALE;
+          float cy = (float) gi->geometry.y_offset / PANGO_SCALE;
+
+          add_texture (self,
+                       x + cx + ink_rects[i].x,
+                       y + cy + ink_rects[i].y,
+                       ink_rects[i].width,
+                       ink_rects[i].height,
+                       gdk_broadway_display_ensure_texture (display, textures[i]));
+        }
+
+      x_position += gi->geometry.width;
+    }
+
+  g_free (textures);
+  g_free (ink_rects);
+}
+
 /* Note: This tracks the offset so that we can convert
    the absolute coordinates of the GskRenderNodes to
    parent-relative which is what the dom uses, and
@@ -732,7 +1194,12 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
       break; /* Fallback */
 
     case GSK_TEXT_NODE:
+      add_text_node (renderer, node, offset_x, offset_y);
+      return;
+
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     case GSK_REPEAT_NODE:
     case GSK_BLEND_NODE:
     case GSK_CROSS_FADE_NODE:
@@ -741,33 +1208,7 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
       break; /* Fallback */
     }
 
-  if (add_new_node (renderer, node, BROADWAY_NODE_TEXTURE))
-    {
-      GdkTexture *texture;
-      cairo_surface_t *surface;
-      cairo_t *cr;
-      guint32 texture_id;
-      int x = floorf (node->bounds.origin.x);
-      int y = floorf (node->bounds.origin.y);
-      int width = ceil (node->bounds.origin.x + node->bounds.size.width) - x;
-      int height = ceil (node->bounds.origin.y + node->bounds.size.height) - y;
-
-      surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
-      cr = cairo_create (surface);
-      cairo_translate (cr, -x, -y);
-      gsk_render_node_draw (node, cr);
-      cairo_destroy (cr);
-
-      texture = gdk_texture_new_for_surface (surface);
-      g_ptr_array_add (self->node_textures, texture); /* Transfers ownership to node_textures */
-
-      texture_id = gdk_broadway_display_ensure_texture (display, texture);
-      add_float (nodes, x - offset_x);
-      add_float (nodes, y - offset_y);
-      add_float (nodes, gdk_texture_get_width (texture));
-      add_float (nodes, gdk_texture_get_height (texture));
-      add_uint32 (nodes, texture_id);
-    }
+  add_fallback_node (renderer, node, offset_x, offset_y);
 }
 
 static void
@@ -778,6 +1219,10 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
   GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
 
   self->node_lookup = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->frame++;
+
+  if (g_hash_table_size (self->glyphs) > MAX_CACHED_GLYPHS)
+    g_hash_table_remove_all (self->glyphs);
 
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->draw_context), update_area);
 
@@ -802,6 +1247,8 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
     gsk_render_node_unref (self->last_root);
   self->last_root = gsk_render_node_ref (root);
 
+  g_hash_table_foreach_remove (self->fallbacks, fallback_is_stale, GUINT_TO_POINTER (self->frame));
+
   if (self->next_node_id > G_MAXUINT32 / 2)
     {
       /* We're "near" a wrap of the ids, lets avoid reusing any of
@@ -813,11 +1260,25 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
     }
 }
 
+static void
+gsk_broadway_renderer_finalize (GObject *object)
+{
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (object);
+
+  g_hash_table_unref (self->fallbacks);
+  g_hash_table_unref (self->glyphs);
+
+  G_OBJECT_CLASS (gsk_broadway_renderer_parent_class)->finalize (object);
+}
+
 static void
 gsk_broadway_renderer_class_init (GskBroadwayRendererClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
 
+  object_class->finalize = gsk_broadway_renderer_finalize;
+
   renderer_class->realize = gsk_broadway_renderer_realize;
   renderer_class->unrealize = gsk_broadway_renderer_unrealize;
   renderer_class->render = gsk_broadway_renderer_render;
@@ -827,6 +1288,10 @@ gsk_broadway_renderer_class_init (GskBroadwayRendererClass *klass)
 static void
 gsk_broadway_renderer_init (GskBroadwayRenderer *self)
 {
+  self->fallbacks = g_hash_table_new_full (fallback_key_hash, fallback_key_equal,
+                                           NULL, (GDestroyNotify) fallback_free);
+  self->glyphs = g_hash_table_new_full (glyph_key_hash, glyph_key_equal,
+                                        (GDestroyNotify) glyph_key_free, g_object_unref);
 }
 
 /**
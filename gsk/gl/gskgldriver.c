@@ -11,6 +11,23 @@
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
 
+/* Memory textures with at least this many pixels get uploaded through a
+ * pixel buffer object by gsk_gl_driver_get_texture_for_texture_async(),
+ * and at most MAX_ASYNC_UPLOAD_BYTES of them get started per frame. */
+#define MIN_ASYNC_UPLOAD_PIXELS (256 * 256)
+#define MAX_ASYNC_UPLOAD_BYTES (8 * 1024 * 1024)
+
+/* Mipmaps are only a quality improvement, so we stop generating them
+ * once the textures of all the drivers of a display take up more than
+ * this. */
+#define MAX_MIPMAPPED_TEXTURE_BYTES (256 * 1024 * 1024)
+
+/* Every window has its own driver, so the texture memory is also
+ * accounted per display, where it is shared by all windows. */
+typedef struct {
+  gsize texture_bytes;
+} DisplayTextures;
+
  typedef struct {
   GLuint fbo_id;
   GLuint depth_stencil_id;
@@ -22,8 +39,12 @@ typedef struct {
   int height;
   GLuint min_filter;
   GLuint mag_filter;
+  /* Approximate GPU memory used, including mipmaps */
+  gsize n_bytes;
   Fbo fbo;
   GdkTexture *user;
+  /* Signalled once an asynchronous upload is done */
+  GLsync upload_fence;
   guint in_use : 1;
   guint permanent : 1;
 
@@ -42,23 +63,72 @@ struct _GskGLDriver
     GQuark created_textures;
     GQuark reused_textures;
     GQuark surface_uploads;
+    GQuark upload_bytes;
   } counters;
 
   Fbo default_fbo;
 
   GHashTable *textures;
-  GHashTable *pointer_textures;
+  GHashTable *key_textures;
 
   const Texture *bound_source_texture;
   const Fbo *bound_fbo;
 
   int max_texture_size;
 
+  /* Sum of the n_bytes of all textures, updated every frame */
+  gsize texture_bytes;
+
+  GdkDisplay *display;
+  DisplayTextures *display_textures;
+  /* The part of display_textures->texture_bytes that is ours */
+  gsize reported_texture_bytes;
+
+  /* Bytes of asynchronous uploads we may still start this frame */
+  gsize async_upload_budget;
+  guint has_async_uploads : 1;
+
+  /* Kept across frames, see gsk_gl_driver_upload_vertices() */
+  guint vertex_array_id;
+  guint vertex_buffer_id;
+  gsize vertex_buffer_size;
+
   gboolean in_frame : 1;
 };
 
 G_DEFINE_TYPE (GskGLDriver, gsk_gl_driver, G_TYPE_OBJECT)
 
+static DisplayTextures *
+get_display_textures (GdkDisplay *display)
+{
+  DisplayTextures *display_textures;
+
+  display_textures = g_object_get_data (G_OBJECT (display), "gsk-gl-display-textures");
+  if (display_textures == NULL)
+    {
+      display_textures = g_new0 (DisplayTextures, 1);
+      g_object_set_data_full (G_OBJECT (display), "gsk-gl-display-textures",
+                              display_textures, g_free);
+    }
+
+  return display_textures;
+}
+
+static void
+gsk_gl_driver_report_texture_bytes (GskGLDriver *self)
+{
+  self->display_textures->texture_bytes -= self->reported_texture_bytes;
+  self->display_textures->texture_bytes += self->texture_bytes;
+  self->reported_texture_bytes = self->texture_bytes;
+}
+
+/* The texture memory of the display, with our own part up to date */
+static gsize
+gsk_gl_driver_get_display_texture_bytes (GskGLDriver *self)
+{
+  return self->display_textures->texture_bytes - self->reported_texture_bytes + self->texture_bytes;
+}
+
 static Texture *
 texture_new (void)
 {
@@ -86,6 +156,9 @@ texture_free (gpointer data)
   if (t->fbo.fbo_id != 0)
     fbo_clear (&t->fbo);
 
+  if (t->upload_fence != NULL)
+    glDeleteSync (t->upload_fence);
+
   if (t->texture_id != 0)
     {
       glDeleteTextures (1, &t->texture_id);
@@ -101,6 +174,48 @@ texture_free (gpointer data)
   g_slice_free (Texture, t);
 }
 
+static guint
+texture_key_hash (gconstpointer v)
+{
+  const GskTextureKey *k = v;
+
+  /* Only the node and the scale, the rest is checked in texture_key_equal() */
+  return GPOINTER_TO_UINT (k->node) ^ ((guint) (k->scale * 100) << 16);
+}
+
+static gboolean
+texture_key_equal (gconstpointer v1,
+                   gconstpointer v2)
+{
+  const GskTextureKey *k1 = v1;
+  const GskTextureKey *k2 = v2;
+
+  return k1->node == k2->node &&
+         k1->scale == k2->scale &&
+         k1->opacity == k2->opacity &&
+         graphene_rect_equal (&k1->bounds, &k2->bounds) &&
+         graphene_rect_equal (&k1->clip, &k2->clip);
+}
+
+static void
+texture_key_free (gpointer data)
+{
+  GskTextureKey *k = data;
+
+  gsk_render_node_unref (k->node);
+  g_slice_free (GskTextureKey, k);
+}
+
+static gboolean
+texture_key_is_stale (gpointer key,
+                      gpointer value,
+                      gpointer user_data)
+{
+  GHashTable *textures = user_data;
+
+  return !g_hash_table_contains (textures, value);
+}
+
 static void
 gsk_gl_driver_set_texture_parameters (GskGLDriver *self,
                                       int          min_filter,
@@ -121,9 +236,18 @@ gsk_gl_driver_finalize (GObject *gobject)
   gdk_gl_context_make_current (self->gl_context);
 
   g_clear_pointer (&self->textures, g_hash_table_unref);
-  g_clear_pointer (&self->pointer_textures, g_hash_table_unref);
+  g_clear_pointer (&self->key_textures, g_hash_table_unref);
   g_clear_object (&self->profiler);
 
+  self->display_textures->texture_bytes -= self->reported_texture_bytes;
+  g_object_unref (self->display);
+
+  if (self->vertex_array_id != 0)
+    {
+      glDeleteVertexArrays (1, &self->vertex_array_id);
+      glDeleteBuffers (1, &self->vertex_buffer_id);
+    }
+
   if (self->gl_context == gdk_gl_context_get_current ())
     gdk_gl_context_clear_current ();
 
@@ -142,6 +266,8 @@ static void
 gsk_gl_driver_init (GskGLDriver *self)
 {
   self->textures = g_hash_table_new_full (NULL, NULL, NULL, texture_free);
+  self->key_textures = g_hash_table_new_full (texture_key_hash, texture_key_equal,
+                                              texture_key_free, NULL);
 
   self->max_texture_size = -1;
 
@@ -159,6 +285,10 @@ gsk_gl_driver_init (GskGLDriver *self)
                                                              "surface_uploads",
                                                              "Texture uploads from surfaces this frame",
                                                              TRUE);
+  self->counters.upload_bytes = gsk_profiler_add_counter (self->profiler,
+                                                          "upload_bytes",
+                                                          "Bytes of texture data uploaded this frame",
+                                                          TRUE);
 #endif
 }
 
@@ -170,6 +300,8 @@ gsk_gl_driver_new (GdkGLContext *context)
 
   self = (GskGLDriver *) g_object_new (GSK_TYPE_GL_DRIVER, NULL);
   self->gl_context = context;
+  self->display = g_object_ref (gdk_gl_context_get_display (context));
+  self->display_textures = get_display_textures (self->display);
 
   return self;
 }
@@ -184,10 +316,36 @@ gsk_gl_driver_begin_frame (GskGLDriver *self)
 
   if (self->max_texture_size < 0)
     {
+      int maj, min;
+
       glGetIntegerv (GL_MAX_TEXTURE_SIZE, (GLint *) &self->max_texture_size);
       GSK_NOTE (OPENGL, g_message ("GL max texture size: %d", self->max_texture_size));
+
+      /* We need pixel buffer objects, mapping buffer ranges and fences. We
+       * upload in the same format as gdk_gl_context_upload_texture(), which
+       * only avoids a conversion on desktop GL. */
+      gdk_gl_context_get_version (self->gl_context, &maj, &min);
+      self->has_async_uploads = !gdk_gl_context_get_use_es (self->gl_context) &&
+                                !gdk_gl_context_is_legacy (self->gl_context) &&
+                                (maj > 3 || (maj == 3 && min >= 2));
+      GSK_NOTE (OPENGL, g_message ("Asynchronous texture uploads: %s",
+                                   self->has_async_uploads ? "yes" : "no"));
     }
 
+  self->async_upload_budget = MAX_ASYNC_UPLOAD_BYTES;
+
+  {
+    GHashTableIter iter;
+    gpointer value_p;
+
+    self->texture_bytes = 0;
+    g_hash_table_iter_init (&iter, self->textures);
+    while (g_hash_table_iter_next (&iter, NULL, &value_p))
+      self->texture_bytes += ((Texture *) value_p)->n_bytes;
+  }
+
+  gsk_gl_driver_report_texture_bytes (self);
+
   glBindFramebuffer (GL_FRAMEBUFFER, 0);
   self->bound_fbo = &self->default_fbo;
 
@@ -207,6 +365,34 @@ gsk_gl_driver_begin_frame (GskGLDriver *self)
 #endif
 }
 
+/* Keeps track of texture uploads for the profiler. Everything that
+ * copies pixels into a texture should call this. */
+void
+gsk_gl_driver_count_upload (GskGLDriver *self,
+                            gsize        n_bytes)
+{
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
+  gsk_profiler_counter_add (self->profiler, self->counters.upload_bytes, n_bytes);
+#endif
+}
+
+/* Gets the number of texture uploads and their size in bytes since the
+ * start of the frame. Both are 0 without G_ENABLE_DEBUG. */
+void
+gsk_gl_driver_get_upload_stats (GskGLDriver *self,
+                                guint       *n_uploads,
+                                gsize       *n_bytes)
+{
+#ifdef G_ENABLE_DEBUG
+  *n_uploads = gsk_profiler_counter_get (self->profiler, self->counters.surface_uploads);
+  *n_bytes = gsk_profiler_counter_get (self->profiler, self->counters.upload_bytes);
+#else
+  *n_uploads = 0;
+  *n_bytes = 0;
+#endif
+}
+
 gboolean
 gsk_gl_driver_in_frame (GskGLDriver *self)
 {
@@ -235,8 +421,12 @@ gsk_gl_driver_end_frame (GskGLDriver *self)
 #endif
 
   GSK_NOTE (OPENGL,
-            g_message ("*** Frame end: textures=%d",
-                     g_hash_table_size (self->textures)));
+            g_message ("*** Frame end: textures=%d (%" G_GSIZE_FORMAT " kB, %" G_GSIZE_FORMAT " kB for the display)",
+                     g_hash_table_size (self->textures),
+                     self->texture_bytes / 1024,
+                     gsk_gl_driver_get_display_texture_bytes (self) / 1024));
+
+  gsk_gl_driver_report_texture_bytes (self);
 
   self->in_frame = FALSE;
 }
@@ -273,33 +463,75 @@ gsk_gl_driver_collect_textures (GskGLDriver *self)
         }
       else
         {
-          /* Remove from self->pointer_textures. */
-          /* TODO: Is there a better way for this? */
-          if (self->pointer_textures)
-            {
-              GHashTableIter pointer_iter;
-              gpointer value;
-              gpointer p;
-
-              g_hash_table_iter_init (&pointer_iter, self->pointer_textures);
-              while (g_hash_table_iter_next (&pointer_iter, &p, &value))
-                {
-                  if (GPOINTER_TO_INT (value) == t->texture_id)
-                    {
-                      g_hash_table_iter_remove (&pointer_iter);
-                      break;
-                    }
-                }
-            }
-
           g_hash_table_iter_remove (&iter);
         }
     }
 
+  /* Drop the cache entries whose texture just got collected. This also
+   * releases the render nodes they kept alive. */
+  g_hash_table_foreach_remove (self->key_textures, texture_key_is_stale, self->textures);
+
   return old_size - g_hash_table_size (self->textures);
 }
 
 
+/* Uploads the vertices for this frame and leaves the vertex array bound.
+ *
+ * The vertex array and buffer are reused from frame to frame. The buffer
+ * storage gets orphaned before every upload, so the driver does not need
+ * to wait for the previous frame to finish using it. */
+guint
+gsk_gl_driver_upload_vertices (GskGLDriver         *self,
+                               const GskQuadVertex *vertices,
+                               gsize                n_vertices)
+{
+  const gsize size = n_vertices * sizeof (GskQuadVertex);
+
+  g_return_val_if_fail (GSK_IS_GL_DRIVER (self), 0);
+
+  if (self->vertex_array_id == 0)
+    {
+      glGenVertexArrays (1, &self->vertex_array_id);
+      glBindVertexArray (self->vertex_array_id);
+
+      glGenBuffers (1, &self->vertex_buffer_id);
+      glBindBuffer (GL_ARRAY_BUFFER, self->vertex_buffer_id);
+
+      /* 0 = position location */
+      glEnableVertexAttribArray (0);
+      glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
+                             sizeof (GskQuadVertex),
+                             (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
+      /* 1 = texture coord location */
+      glEnableVertexAttribArray (1);
+      glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
+                             sizeof (GskQuadVertex),
+                             (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
+    }
+  else
+    {
+      glBindVertexArray (self->vertex_array_id);
+      glBindBuffer (GL_ARRAY_BUFFER, self->vertex_buffer_id);
+    }
+
+  /* Grow in powers of two so we don't reallocate every frame */
+  if (size > self->vertex_buffer_size)
+    {
+      gsize new_size = MAX (self->vertex_buffer_size, 4096);
+
+      while (new_size < size)
+        new_size *= 2;
+
+      self->vertex_buffer_size = new_size;
+    }
+
+  glBufferData (GL_ARRAY_BUFFER, self->vertex_buffer_size, NULL, GL_STREAM_DRAW);
+  if (size > 0)
+    glBufferSubData (GL_ARRAY_BUFFER, 0, size, vertices);
+
+  return self->vertex_array_id;
+}
+
 GdkGLContext *
 gsk_gl_driver_get_gl_context (GskGLDriver *self)
 {
@@ -375,8 +607,10 @@ create_texture (GskGLDriver *self,
   t->height = height;
   t->min_filter = GL_NEAREST;
   t->mag_filter = GL_NEAREST;
+  t->n_bytes = (gsize) width * height * 4;
   t->in_use = TRUE;
   g_hash_table_insert (self->textures, GINT_TO_POINTER (texture_id), t);
+  self->texture_bytes += t->n_bytes;
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (self->profiler, self->counters.created_textures);
 #endif
@@ -384,6 +618,58 @@ create_texture (GskGLDriver *self,
   return t;
 }
 
+static inline gboolean
+filter_uses_mipmaps (int filter)
+{
+  return filter != GL_NEAREST && filter != GL_LINEAR;
+}
+
+/* Returns the min filter to use for @t, which is @min_filter unless
+ * that needs mipmaps and we are over budget for them. */
+static int
+gsk_gl_driver_choose_min_filter (GskGLDriver   *self,
+                                 const Texture *t,
+                                 int            min_filter)
+{
+  if (filter_uses_mipmaps (min_filter) &&
+      gsk_gl_driver_get_display_texture_bytes (self) + t->n_bytes / 3 > MAX_MIPMAPPED_TEXTURE_BYTES)
+    return GL_LINEAR;
+
+  return min_filter;
+}
+
+/* Mipmaps take up another third of the base level */
+static void
+gsk_gl_driver_add_mipmaps (GskGLDriver *self,
+                           Texture     *t)
+{
+  glGenerateMipmap (GL_TEXTURE_2D);
+
+  self->texture_bytes += t->n_bytes / 3;
+  t->n_bytes += t->n_bytes / 3;
+}
+
+/* Switches an uploaded texture to a mipmapped min filter. We never go
+ * back, mipmaps don't hurt when the texture is drawn at a larger scale
+ * later and that saves us from uploading it again. */
+static void
+gsk_gl_driver_upgrade_min_filter (GskGLDriver *self,
+                                  Texture     *t,
+                                  int          min_filter)
+{
+  if (!filter_uses_mipmaps (min_filter) || filter_uses_mipmaps (t->min_filter))
+    return;
+
+  min_filter = gsk_gl_driver_choose_min_filter (self, t, min_filter);
+  if (!filter_uses_mipmaps (min_filter))
+    return;
+
+  gsk_gl_driver_bind_source_texture (self, t->texture_id);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+  t->min_filter = min_filter;
+  gsk_gl_driver_add_mipmaps (self, t);
+}
+
 static void
 gsk_gl_driver_release_texture (gpointer data)
 {
@@ -459,9 +745,7 @@ gsk_gl_driver_slice_texture (GskGLDriver   *self,
           gsk_gl_driver_set_texture_parameters (self, GL_NEAREST, GL_NEAREST);
           gdk_cairo_surface_upload_to_gl (surface, GL_TEXTURE_2D, slice_width, slice_height, NULL);
 
-#ifdef G_ENABLE_DEBUG
-          gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
-#endif
+          gsk_gl_driver_count_upload (self, (gsize) stride * slice_height);
 
           slices[slice_index].rect = (GdkRectangle){x, y, slice_width, slice_height};
           slices[slice_index].texture_id = texture_id;
@@ -494,6 +778,21 @@ gsk_gl_driver_slice_texture (GskGLDriver   *self,
   *out_n_slices = cols * rows;
 }
 
+static gboolean
+gl_contexts_share_textures (GdkGLContext *a,
+                            GdkGLContext *b)
+{
+  GdkGLContext *shared_a = gdk_gl_context_get_shared_context (a);
+  GdkGLContext *shared_b = gdk_gl_context_get_shared_context (b);
+
+  if (shared_a == NULL)
+    shared_a = a;
+  if (shared_b == NULL)
+    shared_b = b;
+
+  return shared_a == shared_b;
+}
+
 int
 gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
                                        GdkTexture  *texture,
@@ -507,7 +806,11 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
     {
       GdkGLContext *texture_context = gdk_gl_texture_get_context ((GdkGLTexture *)texture);
 
-      if (texture_context != self->gl_context)
+      /* Contexts created for the same surface share their textures with
+       * its paint context, so their textures can be used without a copy.
+       * Making our context current flushes the texture's context. */
+      if (texture_context != self->gl_context &&
+          !gl_contexts_share_textures (texture_context, self->gl_context))
         {
           /* In this case, we have to temporarily make the texture's context the current one,
            * download its data into our context and then create a texture from it. */
@@ -517,7 +820,7 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
         }
       else
         {
-          /* A GL texture from the same GL context is a simple task... */
+          /* A GL texture from the same share group is a simple task... */
           return gdk_gl_texture_get_id ((GdkGLTexture *)texture);
         }
     }
@@ -525,10 +828,10 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
     {
       t = gdk_texture_get_render_data (texture, self);
 
-      if (t)
+      if (t && t->mag_filter == mag_filter)
         {
-          if (t->min_filter == min_filter && t->mag_filter == mag_filter)
-            return t->texture_id;
+          gsk_gl_driver_upgrade_min_filter (self, t, min_filter);
+          return t->texture_id;
         }
 
       surface = gdk_texture_download_surface (texture);
@@ -543,7 +846,7 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
   gsk_gl_driver_init_texture_with_surface (self,
                                            t->texture_id,
                                            surface,
-                                           min_filter,
+                                           gsk_gl_driver_choose_min_filter (self, t, min_filter),
                                            mag_filter);
   gdk_gl_context_label_object_printf (self->gl_context, GL_TEXTURE, t->texture_id,
                                       "GdkTexture<%p> %d", texture, t->texture_id);
@@ -553,48 +856,179 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
   return t->texture_id;
 }
 
+/* Starts uploading @texture through a pixel buffer object. Writing
+ * into the mapped buffer is the only copy we do on the CPU, the
+ * transfer into the texture happens while the GPU does other work.
+ *
+ * Returns %FALSE if the buffer could not be mapped, in which case
+ * nothing has been created. */
+static gboolean
+gsk_gl_driver_start_upload (GskGLDriver *self,
+                            GdkTexture  *texture,
+                            int          min_filter,
+                            int          mag_filter)
+{
+  const int width = gdk_texture_get_width (texture);
+  const int height = gdk_texture_get_height (texture);
+  const gsize stride = width * 4;
+  Texture *t;
+  GLuint pbo_id;
+  guchar *data;
+
+  glGenBuffers (1, &pbo_id);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, pbo_id);
+  glBufferData (GL_PIXEL_UNPACK_BUFFER, stride * height, NULL, GL_STREAM_DRAW);
+
+  data = glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, stride * height,
+                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (data == NULL)
+    {
+      glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers (1, &pbo_id);
+      return FALSE;
+    }
+
+  gdk_texture_download (texture, data, stride);
+  glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+
+  t = create_texture (self, width, height);
+
+  if (gdk_texture_set_render_data (texture, self, t, gsk_gl_driver_release_texture))
+    t->user = texture;
+
+  min_filter = gsk_gl_driver_choose_min_filter (self, t, min_filter);
+
+  gsk_gl_driver_bind_source_texture (self, t->texture_id);
+  gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
+
+  glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+  glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+                GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+
+  t->min_filter = min_filter;
+  t->mag_filter = mag_filter;
+
+  if (filter_uses_mipmaps (t->min_filter))
+    gsk_gl_driver_add_mipmaps (self, t);
+
+  /* GL keeps the buffer alive until the transfer is done */
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+  glDeleteBuffers (1, &pbo_id);
+
+  t->upload_fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  gdk_gl_context_label_object_printf (self->gl_context, GL_TEXTURE, t->texture_id,
+                                      "GdkTexture<%p> %d (async)", texture, t->texture_id);
+
+  gsk_gl_driver_count_upload (self, stride * height);
+
+  return TRUE;
+}
+
+/* Like gsk_gl_driver_get_texture_for_texture(), but large memory textures
+ * get uploaded asynchronously. Returns 0 as long as the upload has not
+ * finished, or could not be started yet because too much data has been
+ * uploaded this frame already. The caller is supposed to draw a
+ * placeholder in that case and schedule another frame.
+ *
+ * Using the texture right away would be correct as well, since GL orders
+ * the upload before any use, but the GPU would then wait for the transfer
+ * in the middle of the frame. */
 int
-gsk_gl_driver_get_texture_for_pointer (GskGLDriver *self,
-                                       gpointer     pointer)
+gsk_gl_driver_get_texture_for_texture_async (GskGLDriver *self,
+                                             GdkTexture  *texture,
+                                             int          min_filter,
+                                             int          mag_filter)
 {
-  int id = 0;
+  Texture *t;
+  gsize size;
 
-  if (G_UNLIKELY (self->pointer_textures == NULL))
-    self->pointer_textures = g_hash_table_new (NULL, NULL);
+  /* Textures that some other renderer holds on to can't keep track of
+   * our upload, so they always get uploaded synchronously. */
+  if (!self->has_async_uploads ||
+      GDK_IS_GL_TEXTURE (texture) ||
+      (texture->render_key != NULL && texture->render_key != self) ||
+      gdk_texture_get_width (texture) * gdk_texture_get_height (texture) < MIN_ASYNC_UPLOAD_PIXELS)
+    return gsk_gl_driver_get_texture_for_texture (self, texture, min_filter, mag_filter);
 
-  id = GPOINTER_TO_INT (g_hash_table_lookup (self->pointer_textures, pointer));
+  t = gdk_texture_get_render_data (texture, self);
 
-  if (id != 0)
+  if (t != NULL)
     {
-      GHashTableIter iter;
-      gpointer value_p;
-      /* Find the texture in self->textures and mark it used */
+      /* Changing the mag filter needs a new upload, just do that synchronously */
+      if (t->mag_filter != mag_filter)
+        return gsk_gl_driver_get_texture_for_texture (self, texture, min_filter, mag_filter);
 
-      g_hash_table_iter_init (&iter, self->textures);
-      while (g_hash_table_iter_next (&iter, NULL, &value_p))
+      gsk_gl_driver_upgrade_min_filter (self, t, min_filter);
+
+      if (t->upload_fence != NULL)
         {
-          Texture *t = value_p;
+          if (glClientWaitSync (t->upload_fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            return 0;
 
-          if (t->texture_id == id)
-            {
-              t->in_use = TRUE;
-              break;
-            }
+          glDeleteSync (t->upload_fence);
+          t->upload_fence = NULL;
         }
+
+      return t->texture_id;
+    }
+
+  size = (gsize) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) * 4;
+  if (size > self->async_upload_budget)
+    {
+      /* Always allow at least one upload per frame, so huge textures
+       * don't wait forever */
+      if (self->async_upload_budget < MAX_ASYNC_UPLOAD_BYTES)
+        return 0;
+
+      self->async_upload_budget = 0;
+    }
+  else
+    {
+      self->async_upload_budget -= size;
     }
 
+  if (!gsk_gl_driver_start_upload (self, texture, min_filter, mag_filter))
+    return gsk_gl_driver_get_texture_for_texture (self, texture, min_filter, mag_filter);
+
+  return 0;
+}
+
+int
+gsk_gl_driver_get_texture_for_key (GskGLDriver         *self,
+                                   const GskTextureKey *key)
+{
+  Texture *t;
+  int id;
+
+  id = GPOINTER_TO_INT (g_hash_table_lookup (self->key_textures, key));
+
+  if (id == 0)
+    return 0;
+
+  t = g_hash_table_lookup (self->textures, GINT_TO_POINTER (id));
+  if (t == NULL)
+    return 0;
+
+  t->in_use = TRUE;
+
   return id;
 }
 
+/* The cache holds a reference on key->node for as long as the texture
+ * stays around, so the address of the node can't be reused by a different
+ * node while we still have a texture for it. */
 void
-gsk_gl_driver_set_texture_for_pointer (GskGLDriver *self,
-                                       gpointer     pointer,
-                                       int          texture_id)
+gsk_gl_driver_set_texture_for_key (GskGLDriver         *self,
+                                   const GskTextureKey *key,
+                                   int                  texture_id)
 {
-  if (G_UNLIKELY (self->pointer_textures == NULL))
-    self->pointer_textures = g_hash_table_new (NULL, NULL);
+  GskTextureKey *k = g_slice_new (GskTextureKey);
+
+  *k = *key;
+  gsk_render_node_ref (k->node);
 
-  g_hash_table_insert (self->pointer_textures, pointer, GINT_TO_POINTER (texture_id));
+  g_hash_table_insert (self->key_textures, k, GINT_TO_POINTER (texture_id));
 }
 
 int
@@ -816,13 +1250,11 @@ gsk_gl_driver_init_texture_with_surface (GskGLDriver     *self,
 
   gdk_cairo_surface_upload_to_gl (surface, GL_TEXTURE_2D, t->width, t->height, NULL);
 
-#ifdef G_ENABLE_DEBUG
-  gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
-#endif
+  gsk_gl_driver_count_upload (self, (gsize) t->width * t->height * 4);
 
   t->min_filter = min_filter;
   t->mag_filter = mag_filter;
 
-  if (t->min_filter != GL_NEAREST)
-    glGenerateMipmap (GL_TEXTURE_2D);
+  if (filter_uses_mipmaps (t->min_filter))
+    gsk_gl_driver_add_mipmaps (self, t);
 }
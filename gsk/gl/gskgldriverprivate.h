@@ -4,6 +4,7 @@
 #include <cairo.h>
 #include <gdk/gdk.h>
 #include <graphene.h>
+#include <gsk/gskrendernode.h>
 
 G_BEGIN_DECLS
 
@@ -21,6 +22,18 @@ typedef struct {
   guint texture_id;
 } TextureSlice;
 
+/* Identifies the result of drawing @node into a texture. Everything
+ * that influences the rendered pixels besides the node itself has to
+ * be part of the key, otherwise a cached texture might get reused in
+ * a context it doesn't fit. */
+typedef struct {
+  GskRenderNode *node;
+  float scale;
+  graphene_rect_t bounds;
+  graphene_rect_t clip;
+  float opacity;
+} GskTextureKey;
+
 
 GskGLDriver *   gsk_gl_driver_new                       (GdkGLContext    *context);
 GdkGLContext   *gsk_gl_driver_get_gl_context            (GskGLDriver     *driver);
@@ -34,10 +47,14 @@ int             gsk_gl_driver_get_texture_for_texture   (GskGLDriver     *driver
                                                          GdkTexture      *texture,
                                                          int              min_filter,
                                                          int              mag_filter);
-int             gsk_gl_driver_get_texture_for_pointer   (GskGLDriver     *driver,
-                                                         gpointer         pointer);
-void            gsk_gl_driver_set_texture_for_pointer   (GskGLDriver     *driver,
-                                                         gpointer         pointer,
+int             gsk_gl_driver_get_texture_for_texture_async (GskGLDriver *driver,
+                                                         GdkTexture      *texture,
+                                                         int              min_filter,
+                                                         int              mag_filter);
+int             gsk_gl_driver_get_texture_for_key       (GskGLDriver     *driver,
+                                                         const GskTextureKey *key);
+void            gsk_gl_driver_set_texture_for_key       (GskGLDriver     *driver,
+                                                         const GskTextureKey *key,
                                                          int              texture_id);
 int             gsk_gl_driver_create_permanent_texture  (GskGLDriver     *driver,
                                                          float            width,
@@ -67,6 +84,14 @@ void            gsk_gl_driver_destroy_texture           (GskGLDriver     *driver
                                                          int              texture_id);
 
 int             gsk_gl_driver_collect_textures          (GskGLDriver     *driver);
+guint           gsk_gl_driver_upload_vertices           (GskGLDriver         *driver,
+                                                         const GskQuadVertex *vertices,
+                                                         gsize                n_vertices);
+void            gsk_gl_driver_count_upload              (GskGLDriver     *driver,
+                                                         gsize            n_bytes);
+void            gsk_gl_driver_get_upload_stats          (GskGLDriver     *driver,
+                                                         guint           *n_uploads,
+                                                         gsize           *n_bytes);
 void            gsk_gl_driver_slice_texture             (GskGLDriver     *self,
                                                          GdkTexture      *texture,
                                                          TextureSlice   **out_slices,
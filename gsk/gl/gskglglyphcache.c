@@ -10,6 +10,8 @@
 #include <graphene.h>
 #include <cairo.h>
 #include <epoxy/gl.h>
+#include <math.h>
+#include <string.h>
 
 /* Parameters for our cache eviction strategy.
  *
@@ -17,14 +19,39 @@
  * Glyphs that have not been used for the MAX_AGE frames are considered old. We keep
  * count of the pixels of each atlas that are taken up by old glyphs. We check the
  * fraction of old pixels every CHECK_INTERVAL frames, and if it is above MAX_OLD, then
- * we drop the atlas an all the glyphs contained in it from the cache.
+ * we compact the atlas: old glyphs are dropped from the cache and the remaining ones
+ * are packed again from scratch. To spread the cost, at most one atlas gets compacted
+ * per check. Atlases that have no glyphs left in use are dropped altogether.
  */
 
 #define MAX_AGE 60
 #define CHECK_INTERVAL 10
 #define MAX_OLD 0.333
 
-#define ATLAS_SIZE 512
+/* Atlases are MAX_ATLAS_SIZE pixels square, unless the GPU can't handle that.
+ * Glyphs are allocated with a skyline packer. */
+#define MAX_ATLAS_SIZE 1024
+
+/* GSK_SDF_TEXT=1 draws text that is at least SDF_MIN_SIZE pixels
+ * high on screen from signed distance fields. Those are made once per
+ * glyph at a font size of SDF_GLYPH_SIZE pixels, with a border of
+ * SDF_SPREAD pixels, and serve every larger scale. Zooming and
+ * animated scales then don't fill the atlases with copies of the
+ * same glyphs. */
+#define SDF_MIN_SIZE 48
+#define SDF_GLYPH_SIZE 64
+#define SDF_SPREAD 8
+
+/* GSK_GLYPH_CACHE=file keeps the rasterized glyphs in file when the
+ * renderer goes away, and uses them instead of rasterizing glyphs
+ * again in later runs. Glyphs are found by a description of their
+ * font including the font options, and thrown away when their
+ * extents changed. The file is limited to MAX_PERSISTED_BYTES of
+ * pixels, and glyphs of this run go first. */
+#define PERSISTED_GLYPHS_VERSION 1
+#define PERSISTED_GLYPHS_TYPE "(ua(suuiiiiay))"
+#define PERSISTED_GLYPH_TYPE "(suuiiiiay)"
+#define MAX_PERSISTED_BYTES (16 * 1024 * 1024)
 
 static guint    glyph_cache_hash       (gconstpointer v);
 static gboolean glyph_cache_equal      (gconstpointer v1,
@@ -32,22 +59,391 @@ static gboolean glyph_cache_equal      (gconstpointer v1,
 static void     glyph_cache_key_free   (gpointer      v);
 static void     glyph_cache_value_free (gpointer      v);
 
+static void
+skyline_reset (GskGLGlyphAtlas *atlas)
+{
+  /* Leave a 1 pixel border around the atlas */
+  g_array_set_size (atlas->skyline, 0);
+  g_array_append_val (atlas->skyline, ((SkylineNode) { 1, 1, atlas->width - 1 }));
+}
+
+/* Checks whether a width x height rectangle fits with its left edge at
+ * the skyline node @index and returns the lowest y it can go to. */
+static gboolean
+skyline_fit (const GskGLGlyphAtlas *atlas,
+             guint                  index,
+             int                    width,
+             int                    height,
+             int                   *out_y)
+{
+  const SkylineNode *node = &g_array_index (atlas->skyline, SkylineNode, index);
+  int width_left = width;
+  int y = node->y;
+  guint i;
+
+  if (node->x + width > atlas->width)
+    return FALSE;
+
+  /* The skyline covers the whole atlas width, so this stays in bounds */
+  for (i = index; width_left > 0; i++)
+    {
+      node = &g_array_index (atlas->skyline, SkylineNode, i);
+
+      y = MAX (y, node->y);
+      if (y + height > atlas->height)
+        return FALSE;
+
+      width_left -= node->width;
+    }
+
+  *out_y = y;
+  return TRUE;
+}
+
+static gboolean
+skyline_allocate (GskGLGlyphAtlas *atlas,
+                  int              width,
+                  int              height,
+                  int             *out_x,
+                  int             *out_y)
+{
+  int best_index = -1;
+  int best_top = G_MAXINT;
+  int best_width = G_MAXINT;
+  int best_x = 0, best_y = 0;
+  guint i;
+
+  /* 1 pixel of padding between glyphs */
+  width += 1;
+  height += 1;
+
+  /* Bottom-left heuristic: lowest resulting top edge wins, ties go to
+   * the narrowest node to keep wide gaps for wide glyphs. */
+  for (i = 0; i < atlas->skyline->len; i++)
+    {
+      const SkylineNode *node = &g_array_index (atlas->skyline, SkylineNode, i);
+      int y;
+
+      if (!skyline_fit (atlas, i, width, height, &y))
+        continue;
+
+      if (y + height < best_top ||
+          (y + height == best_top && node->width < best_width))
+        {
+          best_index = i;
+          best_top = y + height;
+          best_width = node->width;
+          best_x = node->x;
+          best_y = y;
+        }
+    }
+
+  if (best_index < 0)
+    return FALSE;
+
+  g_array_insert_val (atlas->skyline, best_index,
+                      ((SkylineNode) { best_x, best_top, width }));
+
+  /* Cut away the parts of the following nodes that are now covered */
+  for (i = best_index + 1; i < atlas->skyline->len; )
+    {
+      SkylineNode *prev = &g_array_index (atlas->skyline, SkylineNode, i - 1);
+      SkylineNode *node = &g_array_index (atlas->skyline, SkylineNode, i);
+      int shrink;
+
+      if (node->x >= prev->x + prev->width)
+        break;
+
+      shrink = prev->x + prev->width - node->x;
+      node->x += shrink;
+      node->width -= shrink;
+
+      if (node->width > 0)
+        break;
+
+      g_array_remove_index (atlas->skyline, i);
+    }
+
+  /* Merge neighbouring nodes at the same height */
+  for (i = 0; i + 1 < atlas->skyline->len; )
+    {
+      SkylineNode *node = &g_array_index (atlas->skyline, SkylineNode, i);
+      const SkylineNode *next = &g_array_index (atlas->skyline, SkylineNode, i + 1);
+
+      if (node->y == next->y)
+        {
+          node->width += next->width;
+          g_array_remove_index (atlas->skyline, i + 1);
+        }
+      else
+        i++;
+    }
+
+  *out_x = best_x;
+  *out_y = best_y;
+
+  return TRUE;
+}
+
 static GskGLGlyphAtlas *
-create_atlas (GskGLGlyphCache *cache)
+create_atlas (GskGLGlyphCache *cache,
+              gboolean         sdf)
 {
   GskGLGlyphAtlas *atlas;
 
+  if (cache->atlas_size == 0)
+    {
+      int max_size = gsk_gl_driver_get_max_texture_size (cache->gl_driver);
+
+      cache->atlas_size = MIN (max_size, MAX_ATLAS_SIZE);
+    }
+
   atlas = g_new0 (GskGLGlyphAtlas, 1);
-  atlas->width = ATLAS_SIZE;
-  atlas->height = ATLAS_SIZE;
-  atlas->y0 = 1;
-  atlas->y = 1;
-  atlas->x = 1;
+  atlas->width = cache->atlas_size;
+  atlas->height = cache->atlas_size;
+  atlas->skyline = g_array_new (FALSE, FALSE, sizeof (SkylineNode));
+  skyline_reset (atlas);
   atlas->image = NULL;
+  atlas->surface = NULL;
+  atlas->dirty_glyphs = g_array_new (FALSE, FALSE, sizeof (DirtyGlyph));
+  atlas->sdf = sdf;
 
   return atlas;
 }
 
+static const char *
+get_font_key (PangoFont *font)
+{
+  static GQuark font_key_quark = 0;
+  char *font_key;
+
+  if (G_UNLIKELY (font_key_quark == 0))
+    font_key_quark = g_quark_from_static_string ("gsk-gl-glyph-cache-font-key");
+
+  font_key = g_object_get_qdata (G_OBJECT (font), font_key_quark);
+  if (font_key == NULL)
+    {
+      PangoFontDescription *desc;
+      cairo_scaled_font_t *scaled_font;
+      cairo_font_options_t *options;
+      cairo_matrix_t ctm;
+      char *desc_string;
+
+      desc = pango_font_describe_with_absolute_size (font);
+      desc_string = pango_font_description_to_string (desc);
+
+      options = cairo_font_options_create ();
+      cairo_matrix_init_identity (&ctm);
+      scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *)font);
+      if (scaled_font != NULL)
+        {
+          cairo_scaled_font_get_font_options (scaled_font, options);
+          cairo_scaled_font_get_ctm (scaled_font, &ctm);
+        }
+
+      font_key = g_strdup_printf ("%s %lx %g %g %g %g",
+                                  desc_string,
+                                  cairo_font_options_hash (options),
+                                  ctm.xx, ctm.yx, ctm.xy, ctm.yy);
+      g_object_set_qdata_full (G_OBJECT (font), font_key_quark, font_key, g_free);
+
+      cairo_font_options_destroy (options);
+      g_free (desc_string);
+      pango_font_description_free (desc);
+    }
+
+  return font_key;
+}
+
+static char *
+get_persisted_glyph_name (const char *font_key,
+                          PangoGlyph  glyph,
+                          guint       scale)
+{
+  return g_strdup_printf ("%s/%u/%u", font_key, glyph, scale);
+}
+
+static void
+load_persisted_glyphs (GskGLGlyphCache *self)
+{
+  GError *error = NULL;
+  GMappedFile *file;
+  GBytes *bytes;
+  GVariant *glyphs;
+  GVariantIter iter;
+  GVariant *entry;
+  guint32 version;
+
+  file = g_mapped_file_new (self->persist_path, FALSE, &error);
+  if (file == NULL)
+    {
+      GSK_RENDERER_NOTE (self->renderer, GLYPH_CACHE,
+                         g_message ("No persisted glyphs: %s", error->message));
+      g_error_free (error);
+      return;
+    }
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  self->persisted_glyphs = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (PERSISTED_GLYPHS_TYPE),
+                                                                         bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  g_variant_get (self->persisted_glyphs, "(u@a" PERSISTED_GLYPH_TYPE ")", &version, &glyphs);
+  if (version != PERSISTED_GLYPHS_VERSION)
+    {
+      g_variant_unref (glyphs);
+      return;
+    }
+
+  g_variant_iter_init (&iter, glyphs);
+  while ((entry = g_variant_iter_next_value (&iter)))
+    {
+      const char *font_key;
+      guint32 glyph, scale;
+
+      g_variant_get (entry, "(&suuiiii@ay)", &font_key, &glyph, &scale,
+                     NULL, NULL, NULL, NULL, NULL);
+      g_hash_table_insert (self->persisted,
+                           get_persisted_glyph_name (font_key, glyph, scale),
+                           entry);
+    }
+
+  GSK_RENDERER_NOTE (self->renderer, GLYPH_CACHE,
+                     g_message ("Loaded %u persisted glyphs", g_hash_table_size (self->persisted)));
+
+  g_variant_unref (glyphs);
+}
+
+static const guchar *
+lookup_persisted_glyph (GskGLGlyphCache        *self,
+                        const GlyphCacheKey    *key,
+                        const GskGLCachedGlyph *value)
+{
+  GVariant *entry, *pixels;
+  gint32 draw_x, draw_y, draw_width, draw_height;
+  const guchar *data;
+  gsize n_bytes;
+  char *name;
+
+  if (g_hash_table_size (self->persisted) == 0)
+    return NULL;
+
+  name = get_persisted_glyph_name (get_font_key (key->font), key->glyph, key->scale);
+  entry = g_hash_table_lookup (self->persisted, name);
+  g_free (name);
+
+  if (entry == NULL)
+    return NULL;
+
+  g_variant_get (entry, "(&suuiiii@ay)", NULL, NULL, NULL,
+                 &draw_x, &draw_y, &draw_width, &draw_height, &pixels);
+  data = g_variant_get_fixed_array (pixels, &n_bytes, 1);
+  /* @entry keeps the data alive */
+  g_variant_unref (pixels);
+
+  /* A different font under the same name */
+  if (draw_x != value->draw_x || draw_y != value->draw_y ||
+      draw_width != value->draw_width || draw_height != value->draw_height ||
+      n_bytes != (gsize) (draw_width * key->scale / 1024) * (draw_height * key->scale / 1024) * 4)
+    return NULL;
+
+  return data;
+}
+
+/* Adds the glyphs in the atlases, followed by the ones from earlier
+ * runs that were not used this time */
+static void
+save_persisted_glyphs (GskGLGlyphCache *self)
+{
+  GError *error = NULL;
+  GVariantBuilder builder;
+  GHashTable *written;
+  GHashTableIter iter;
+  GlyphCacheKey *key;
+  GskGLCachedGlyph *value;
+  const char *name;
+  GVariant *entry;
+  GVariant *result;
+  gsize n_bytes = 0;
+
+  written = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" PERSISTED_GLYPH_TYPE));
+
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+    {
+      const GskGLGlyphAtlas *atlas = value->atlas;
+      const char *font_key;
+      const guchar *data;
+      guchar *pixels;
+      int x, y, width, height, stride, i;
+
+      /* Dirty glyphs have not been rasterized yet. Distance fields
+       * are cheap to make again for the few glyphs that need them. */
+      if (atlas == NULL || atlas->surface == NULL || atlas->dirty_glyphs->len > 0 ||
+          key->sdf)
+        continue;
+
+      x = roundf (value->tx * atlas->width);
+      y = roundf (value->ty * atlas->height);
+      width = value->draw_width * key->scale / 1024;
+      height = value->draw_height * key->scale / 1024;
+
+      if (n_bytes + width * height * 4 > MAX_PERSISTED_BYTES)
+        continue;
+
+      font_key = get_font_key (key->font);
+      if (!g_hash_table_add (written, get_persisted_glyph_name (font_key, key->glyph, key->scale)))
+        continue;
+
+      data = cairo_image_surface_get_data (atlas->surface);
+      stride = cairo_image_surface_get_stride (atlas->surface);
+      pixels = g_malloc (width * height * 4);
+      for (i = 0; i < height; i++)
+        memcpy (pixels + i * width * 4, data + (y + i) * stride + x * 4, width * 4);
+
+      g_variant_builder_add (&builder, "(suuiiii@ay)",
+                             font_key, key->glyph, key->scale,
+                             value->draw_x, value->draw_y,
+                             value->draw_width, value->draw_height,
+                             g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                      pixels, width * height * 4,
+                                                      TRUE, g_free, pixels));
+      n_bytes += width * height * 4;
+    }
+
+  g_hash_table_iter_init (&iter, self->persisted);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&name, (gpointer *)&entry))
+    {
+      gsize size = g_variant_get_size (entry);
+
+      if (g_hash_table_contains (written, name) || n_bytes + size > MAX_PERSISTED_BYTES)
+        continue;
+
+      g_variant_builder_add_value (&builder, entry);
+      n_bytes += size;
+    }
+
+  result = g_variant_ref_sink (g_variant_new ("(u@a" PERSISTED_GLYPH_TYPE ")",
+                                              PERSISTED_GLYPHS_VERSION,
+                                              g_variant_builder_end (&builder)));
+
+  if (!g_file_set_contents (self->persist_path,
+                            g_variant_get_data (result),
+                            g_variant_get_size (result),
+                            &error))
+    {
+      GSK_RENDERER_NOTE (self->renderer, GLYPH_CACHE,
+                         g_message ("Failed to persist glyphs: %s", error->message));
+      g_error_free (error);
+    }
+
+  g_variant_unref (result);
+  g_hash_table_unref (written);
+}
+
 static void
 free_atlas (gpointer v)
 {
@@ -59,6 +455,10 @@ free_atlas (gpointer v)
       g_free (atlas->image);
     }
 
+  g_clear_pointer (&atlas->surface, cairo_surface_destroy);
+  g_array_free (atlas->dirty_glyphs, TRUE);
+  g_array_free (atlas->skyline, TRUE);
+
   g_free (atlas);
 }
 
@@ -70,10 +470,19 @@ gsk_gl_glyph_cache_init (GskGLGlyphCache *self,
   self->hash_table = g_hash_table_new_full (glyph_cache_hash, glyph_cache_equal,
                                             glyph_cache_key_free, glyph_cache_value_free);
   self->atlases = g_ptr_array_new_with_free_func (free_atlas);
-  g_ptr_array_add (self->atlases, create_atlas (self));
+  self->atlas_size = 0; /* Determined when creating the first atlas */
 
   self->renderer = renderer;
   self->gl_driver = gl_driver;
+
+  self->persist_path = g_strdup (g_getenv ("GSK_GLYPH_CACHE"));
+  self->persisted_glyphs = NULL;
+  self->persisted = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free, (GDestroyNotify) g_variant_unref);
+  if (self->persist_path != NULL)
+    load_persisted_glyphs (self);
+
+  self->use_sdf = g_getenv ("GSK_SDF_TEXT") != NULL;
 }
 
 void
@@ -81,6 +490,9 @@ gsk_gl_glyph_cache_free (GskGLGlyphCache *self)
 {
   guint i;
 
+  if (self->persist_path != NULL)
+    save_persisted_glyphs (self);
+
   for (i = 0; i < self->atlases->len; i ++)
     {
       GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
@@ -94,6 +506,33 @@ gsk_gl_glyph_cache_free (GskGLGlyphCache *self)
 
   g_ptr_array_unref (self->atlases);
   g_hash_table_unref (self->hash_table);
+
+  g_hash_table_unref (self->persisted);
+  g_clear_pointer (&self->persisted_glyphs, g_variant_unref);
+  g_free (self->persist_path);
+}
+
+/* Drops all glyphs and atlases. Unlike gsk_gl_glyph_cache_free(), this
+ * keeps the persisted glyphs in memory and doesn't write them back, so
+ * it is cheap to call whenever a window is hidden. */
+void
+gsk_gl_glyph_cache_trim (GskGLGlyphCache *self)
+{
+  guint i;
+
+  for (i = 0; i < self->atlases->len; i ++)
+    {
+      GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+      if (atlas->image)
+        {
+          gsk_gl_image_destroy (atlas->image, self->gl_driver);
+          atlas->image->texture_id = 0;
+        }
+    }
+
+  g_hash_table_remove_all (self->hash_table);
+  g_ptr_array_set_size (self->atlases, 0);
 }
 
 static gboolean
@@ -104,7 +543,8 @@ glyph_cache_equal (gconstpointer v1, gconstpointer v2)
 
   return key1->font == key2->font &&
          key1->glyph == key2->glyph &&
-         key1->scale == key2->scale;
+         key1->scale == key2->scale &&
+         key1->sdf == key2->sdf;
 }
 
 static guint
@@ -133,56 +573,52 @@ glyph_cache_value_free (gpointer v)
 static void
 add_to_cache (GskGLGlyphCache  *cache,
               GlyphCacheKey    *key,
-              GskGLCachedGlyph *value)
+              GskGLCachedGlyph *value,
+              const guchar     *pixels)
 {
-  GskGLGlyphAtlas *atlas;
+  GskGLGlyphAtlas *atlas = NULL;
   int i;
+  int x = 0, y = 0;
   int width = value->draw_width * key->scale / 1024;
   int height = value->draw_height * key->scale / 1024;
 
-  for (i = 0; i < cache->atlases->len; i++)
+  if (key->sdf)
     {
-      int x, y, y0;
+      width += 2 * SDF_SPREAD;
+      height += 2 * SDF_SPREAD;
+    }
 
+  for (i = 0; i < cache->atlases->len; i++)
+    {
       atlas = g_ptr_array_index (cache->atlases, i);
-      x = atlas->x;
-      y = atlas->y;
-      y0 = atlas->y0;
-
-      if (atlas->x + width + 1 >= atlas->width)
-        {
-          /* start a new row */
-          y0 = y + 1;
-          x = 1;
-        }
 
-      if (y0 + height + 1 >= atlas->height)
-        continue;
-
-      atlas->y0 = y0;
-      atlas->x = x;
-      atlas->y = y;
-      break;
+      if (atlas->sdf == key->sdf &&
+          skyline_allocate (atlas, width, height, &x, &y))
+        break;
     }
 
   if (i == cache->atlases->len)
     {
-      atlas = create_atlas (cache);
+      atlas = create_atlas (cache, key->sdf);
       g_ptr_array_add (cache->atlases, atlas);
+
+      if (!skyline_allocate (atlas, width, height, &x, &y))
+        {
+          /* Larger than a whole atlas, draw nothing */
+          GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
+                             g_message ("Glyph of size %dx%d does not fit in an atlas", width, height));
+          return;
+        }
     }
 
-  value->tx = (float)atlas->x / atlas->width;
-  value->ty = (float)atlas->y0 / atlas->height;
+  value->tx = (float)x / atlas->width;
+  value->ty = (float)y / atlas->height;
   value->tw = (float)width / atlas->width;
   value->th = (float)height / atlas->height;
 
   value->atlas = atlas;
 
-  atlas->pending_glyph.key = key;
-  atlas->pending_glyph.value = value;
-
-  atlas->x = atlas->x + width + 1;
-  atlas->y = MAX (atlas->y, atlas->y0 + height + 1);
+  g_array_append_val (atlas->dirty_glyphs, ((DirtyGlyph) { key, value, pixels }));
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (cache->renderer, GLYPH_CACHE))
@@ -191,90 +627,335 @@ add_to_cache (GskGLGlyphCache  *cache,
       for (i = 0; i < cache->atlases->len; i++)
         {
           atlas = g_ptr_array_index (cache->atlases, i);
-          g_print ("\tGskGLGlyphAtlas %d (%dx%d): %.2g%% old pixels, filled to %d, %d / %d\n",
+          g_print ("\tGskGLGlyphAtlas %d (%dx%d): %.2g%% old pixels, %u skyline nodes\n",
                    i, atlas->width, atlas->height,
                    100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height),
-                   atlas->x, atlas->y0, atlas->y);
+                   atlas->skyline->len);
         }
     }
 #endif
 }
 
-static void
-render_glyph (const GskGLGlyphAtlas *atlas,
-              DirtyGlyph            *glyph,
-              GskImageRegion        *region)
+/* Returns whether the glyph still needs to be drawn, into @render */
+static gboolean
+prepare_glyph (const GskGLGlyphAtlas   *atlas,
+               const DirtyGlyph        *glyph,
+               cairo_rectangle_int_t   *area,
+               GskRenderGlyph          *render)
 {
   GlyphCacheKey *key = glyph->key;
   GskGLCachedGlyph *value = glyph->value;
-  cairo_surface_t *surface;
-  cairo_t *cr;
   cairo_scaled_font_t *scaled_font;
-  PangoGlyphString glyph_string;
-  PangoGlyphInfo glyph_info;
+  guchar *data;
+  int stride;
+
+  area->x = roundf (value->tx * atlas->width);
+  area->y = roundf (value->ty * atlas->height);
+  area->width = value->draw_width * key->scale / 1024;
+  area->height = value->draw_height * key->scale / 1024;
+
+  if (key->sdf)
+    {
+      area->width += 2 * SDF_SPREAD;
+      area->height += 2 * SDF_SPREAD;
+    }
+
+  data = cairo_image_surface_get_data (atlas->surface);
+  stride = cairo_image_surface_get_stride (atlas->surface);
+
+  if (glyph->pixels != NULL)
+    {
+      int i;
+
+      for (i = 0; i < area->height; i++)
+        memcpy (data + (area->y + i) * stride + area->x * 4,
+                glyph->pixels + i * area->width * 4,
+                area->width * 4);
+      return FALSE;
+    }
 
   scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *)key->font);
   if (G_UNLIKELY (!scaled_font || cairo_scaled_font_status (scaled_font) != CAIRO_STATUS_SUCCESS))
-    return;
+    return FALSE;
+
+  /* Draw straight into the glyph's slot of the atlas memory. Glyphs
+   * don't share memory, so they can be drawn in parallel. */
+  render->font = key->font;
+  render->glyph = key->glyph;
+  render->draw_x = value->draw_x;
+  render->draw_y = value->draw_y;
+  render->draw_width = value->draw_width;
+  if (key->sdf)
+    /* The distance field is made from this, see write_sdf() */
+    render->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                  area->width - 2 * SDF_SPREAD,
+                                                  area->height - 2 * SDF_SPREAD);
+  else
+    render->surface = cairo_image_surface_create_for_data (data + area->y * stride + area->x * 4,
+                                                           CAIRO_FORMAT_ARGB32,
+                                                           area->width, area->height,
+                                                           stride);
+  cairo_surface_set_device_scale (render->surface, key->scale / 1024.0, key->scale / 1024.0);
 
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-                                        value->draw_width * key->scale / 1024,
-                                        value->draw_height * key->scale / 1024);
-  cairo_surface_set_device_scale (surface, key->scale / 1024.0, key->scale / 1024.0);
+  return TRUE;
+}
 
-  cr = cairo_create (surface);
+#define SDF_INF 1e20f
 
-  cairo_set_scaled_font (cr, scaled_font);
-  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+/* Felzenszwalb and Huttenlocher's squared distance transform of the
+ * n samples of f, with v and z as scratch space of n and n + 1 */
+static void
+distance_transform_1d (const float *f,
+                       float       *d,
+                       int         *v,
+                       float       *z,
+                       int          n)
+{
+  int k = 0;
+  int q;
 
-  glyph_info.glyph = key->glyph;
-  glyph_info.geometry.width = value->draw_width * 1024;
-  if (key->glyph & PANGO_GLYPH_UNKNOWN_FLAG)
-    glyph_info.geometry.x_offset = 0;
-  else
-    glyph_info.geometry.x_offset = - value->draw_x * 1024;
-  glyph_info.geometry.y_offset = - value->draw_y * 1024;
+  v[0] = 0;
+  z[0] = -SDF_INF;
+  z[1] = SDF_INF;
 
-  glyph_string.num_glyphs = 1;
-  glyph_string.glyphs = &glyph_info;
+  for (q = 1; q < n; q++)
+    {
+      float s;
 
-  pango_cairo_show_glyph_string (cr, key->font, &glyph_string);
-  cairo_destroy (cr);
+      /* z[0] is -SDF_INF, so this stops at k == 0 */
+      s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+      while (s <= z[k])
+        {
+          k--;
+          s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = SDF_INF;
+    }
+
+  k = 0;
+  for (q = 0; q < n; q++)
+    {
+      while (z[k + 1] < q)
+        k++;
+      d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+static void
+distance_transform_2d (float *grid,
+                       int    width,
+                       int    height)
+{
+  int n = MAX (width, height);
+  float *f = g_new (float, n);
+  float *d = g_new (float, n);
+  float *z = g_new (float, n + 1);
+  int *v = g_new (int, n);
+  int x, y;
+
+  for (x = 0; x < width; x++)
+    {
+      for (y = 0; y < height; y++)
+        f[y] = grid[y * width + x];
+      distance_transform_1d (f, d, v, z, height);
+      for (y = 0; y < height; y++)
+        grid[y * width + x] = d[y];
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      distance_transform_1d (grid + y * width, d, v, z, width);
+      memcpy (grid + y * width, d, width * sizeof (float));
+    }
+
+  g_free (f);
+  g_free (d);
+  g_free (z);
+  g_free (v);
+}
+
+/* Turns the glyph drawn into @surface into a distance field in @area
+ * of the atlas. 0.5 is the outline of the glyph, and the values go
+ * to 1 inside and 0 outside of it within SDF_SPREAD pixels. */
+static void
+write_sdf (const GskGLGlyphAtlas       *atlas,
+           const cairo_rectangle_int_t *area,
+           cairo_surface_t             *surface)
+{
+  const guchar *src = cairo_image_surface_get_data (surface);
+  int src_stride = cairo_image_surface_get_stride (surface);
+  guchar *dest = cairo_image_surface_get_data (atlas->surface);
+  int dest_stride = cairo_image_surface_get_stride (atlas->surface);
+  float *outside, *inside;
+  int x, y;
 
   cairo_surface_flush (surface);
 
-  region->width = cairo_image_surface_get_width (surface);
-  region->height = cairo_image_surface_get_height (surface);
-  region->stride = cairo_image_surface_get_stride (surface);
-  region->data = g_memdup (cairo_image_surface_get_data (surface),
-                           region->stride * region->height * sizeof (guchar));
-  region->x = (gsize)(value->tx * atlas->width);
-  region->y = (gsize)(value->ty * atlas->height);
+  outside = g_new (float, area->width * area->height);
+  inside = g_new (float, area->width * area->height);
+
+  for (y = 0; y < area->height; y++)
+    for (x = 0; x < area->width; x++)
+      {
+        int sx = x - SDF_SPREAD;
+        int sy = y - SDF_SPREAD;
+        gboolean is_inside = FALSE;
+
+        if (sx >= 0 && sx < area->width - 2 * SDF_SPREAD &&
+            sy >= 0 && sy < area->height - 2 * SDF_SPREAD)
+          {
+            guint32 pixel = *(const guint32 *) (src + sy * src_stride + sx * 4);
+
+            is_inside = (pixel >> 24) >= 128;
+          }
+
+        outside[y * area->width + x] = is_inside ? 0 : SDF_INF;
+        inside[y * area->width + x] = is_inside ? SDF_INF : 0;
+      }
+
+  distance_transform_2d (outside, area->width, area->height);
+  distance_transform_2d (inside, area->width, area->height);
+
+  for (y = 0; y < area->height; y++)
+    {
+      guint32 *row = (guint32 *) (dest + (area->y + y) * dest_stride + area->x * 4);
+
+      for (x = 0; x < area->width; x++)
+        {
+          float to_inside = sqrtf (outside[y * area->width + x]);
+          float to_outside = sqrtf (inside[y * area->width + x]);
+          float dist, value;
+          guint32 a;
+
+          /* The outline is halfway between the pixels */
+          if (to_inside > 0)
+            dist = to_inside - 0.5f;
+          else
+            dist = 0.5f - to_outside;
+
+          value = CLAMP (0.5f - dist / (2 * SDF_SPREAD), 0.f, 1.f);
+          a = (guint32) roundf (value * 255);
+
+          /* White, premultiplied */
+          row[x] = a << 24 | a << 16 | a << 8 | a;
+        }
+    }
 
-  cairo_surface_destroy (surface);
+  g_free (outside);
+  g_free (inside);
 }
 
 static void
-upload_dirty_glyph (GskGLGlyphCache *self,
+ensure_atlas_image (GskGLGlyphCache *self,
                     GskGLGlyphAtlas *atlas)
 {
+  if (atlas->image != NULL)
+    return;
+
+  atlas->image = g_new0 (GskGLImage, 1);
+  gsk_gl_image_create (atlas->image, self->gl_driver, atlas->width, atlas->height);
+  gdk_gl_context_label_object_printf (gsk_gl_driver_get_gl_context (self->gl_driver),
+                                      GL_TEXTURE, atlas->image->texture_id,
+                                      "Glyph atlas %d", atlas->image->texture_id);
+
+  /* gsk_gl_image_create() leaves the texture bound */
+  if (atlas->sdf)
+    {
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+}
+
+static void
+upload_dirty_glyphs (GskGLGlyphCache *self,
+                     GskGLGlyphAtlas *atlas)
+{
+  cairo_rectangle_int_t dirty = { 0, };
   GskImageRegion region;
+  GskRenderGlyph *render;
+  cairo_rectangle_int_t *render_areas;
+  const DirtyGlyph **render_glyphs;
+  guint n_render;
+  guchar *data;
+  int stride;
+  guint i;
 
-  g_assert (atlas->pending_glyph.key != NULL);
+  g_assert (atlas->dirty_glyphs->len > 0);
 
   gdk_gl_context_push_debug_group_printf (gsk_gl_driver_get_gl_context (self->gl_driver),
-                                          "Uploading glyph %d", atlas->pending_glyph.key->glyph);
+                                          "Uploading %u glyphs", atlas->dirty_glyphs->len);
+
+  ensure_atlas_image (self, atlas);
+
+  /* Image surfaces start out cleared, so unused parts of the atlas
+   * stay transparent. */
+  if (atlas->surface == NULL)
+    atlas->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, atlas->width, atlas->height);
+
+  /* The glyphs are drawn into the memory of the surface */
+  cairo_surface_flush (atlas->surface);
+
+  render = g_new (GskRenderGlyph, atlas->dirty_glyphs->len);
+  render_areas = g_new (cairo_rectangle_int_t, atlas->dirty_glyphs->len);
+  render_glyphs = g_new (const DirtyGlyph *, atlas->dirty_glyphs->len);
+  n_render = 0;
+
+  for (i = 0; i < atlas->dirty_glyphs->len; i++)
+    {
+      const DirtyGlyph *glyph = &g_array_index (atlas->dirty_glyphs, DirtyGlyph, i);
+      cairo_rectangle_int_t area;
+
+      if (prepare_glyph (atlas, glyph, &area, &render[n_render]))
+        {
+          render_areas[n_render] = area;
+          render_glyphs[n_render] = glyph;
+          n_render++;
+        }
+
+      if (i == 0)
+        dirty = area;
+      else
+        gdk_rectangle_union (&dirty, &area, &dirty);
+    }
 
-  render_glyph (atlas, &atlas->pending_glyph, &region);
+  gsk_render_glyphs (render, n_render);
+
+  for (i = 0; i < n_render; i++)
+    {
+      if (render_glyphs[i]->key->sdf)
+        write_sdf (atlas, &render_areas[i], render[i].surface);
+
+      cairo_surface_destroy (render[i].surface);
+    }
+  g_free (render);
+  g_free (render_areas);
+  g_free (render_glyphs);
+
+  cairo_surface_mark_dirty_rectangle (atlas->surface,
+                                      dirty.x, dirty.y,
+                                      dirty.width, dirty.height);
+
+  /* Everything in the dirty rectangle is either a new glyph or already
+   * present in the texture, so a single upload covers all glyphs. */
+  data = cairo_image_surface_get_data (atlas->surface);
+  stride = cairo_image_surface_get_stride (atlas->surface);
+
+  region.x = dirty.x;
+  region.y = dirty.y;
+  region.width = dirty.width;
+  region.height = dirty.height;
+  region.stride = stride;
+  region.data = data + dirty.y * stride + dirty.x * 4;
 
   gsk_gl_image_upload_regions (atlas->image, self->gl_driver, 1, &region);
 
   gdk_gl_context_pop_debug_group (gsk_gl_driver_get_gl_context (self->gl_driver));
 
-  g_free (region.data);
-
-  atlas->pending_glyph.key = NULL;
-  atlas->pending_glyph.value = NULL;
+  g_array_set_size (atlas->dirty_glyphs, 0);
 }
 
 const GskGLCachedGlyph *
@@ -282,7 +963,8 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
                            gboolean         create,
                            PangoFont       *font,
                            PangoGlyph       glyph,
-                           float            scale)
+                           float            scale,
+                           gboolean         sdf)
 {
   GskGLCachedGlyph *value;
 
@@ -290,7 +972,8 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
                                &(GlyphCacheKey) {
                                  .font = font,
                                  .glyph = glyph,
-                                 .scale = (guint)(scale * 1024)
+                                 .scale = (guint)(scale * 1024),
+                                 .sdf = sdf
                                });
 
   if (value)
@@ -302,10 +985,11 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
           GskGLGlyphAtlas *atlas = value->atlas;
 
           if (atlas)
-            atlas->old_pixels -= value->draw_width * value->draw_height;
-
-          value->timestamp = cache->timestamp;
+            atlas->old_pixels -= MIN (atlas->old_pixels, value->draw_width * value->draw_height);
         }
+
+      /* Keep the age accurate, compaction throws away everything that is old */
+      value->timestamp = cache->timestamp;
     }
 
   if (create && value == NULL)
@@ -313,6 +997,8 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
       GlyphCacheKey *key;
       PangoRectangle ink_rect;
 
+      cache->n_misses++;
+
       key = g_new0 (GlyphCacheKey, 1);
       value = g_new0 (GskGLCachedGlyph, 1);
 
@@ -330,9 +1016,13 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
       key->font = g_object_ref (font);
       key->glyph = glyph;
       key->scale = (guint)(scale * 1024);
+      key->sdf = sdf;
+
+      if (sdf && key->scale > 0)
+        value->sdf_padding = SDF_SPREAD * 1024.f / key->scale;
 
       if (ink_rect.width > 0 && ink_rect.height > 0 && key->scale > 0)
-        add_to_cache (cache, key, value);
+        add_to_cache (cache, key, value, sdf ? NULL : lookup_persisted_glyph (cache, key, value));
 
       g_hash_table_insert (cache->hash_table, key, value);
     }
@@ -340,6 +1030,42 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
   return value;
 }
 
+/* Returns the scale to look up distance field glyphs of @font with,
+ * or 0 if text drawn at @scale should use normal glyphs */
+float
+gsk_gl_glyph_cache_get_sdf_scale (GskGLGlyphCache *self,
+                                  PangoFont       *font,
+                                  float            scale)
+{
+  static GQuark font_size_quark = 0;
+  gpointer data;
+  float size;
+
+  if (!self->use_sdf)
+    return 0;
+
+  if (G_UNLIKELY (font_size_quark == 0))
+    font_size_quark = g_quark_from_static_string ("gsk-gl-glyph-cache-font-size");
+
+  /* The size in Pango units, plus one to tell 0 from unset */
+  data = g_object_get_qdata (G_OBJECT (font), font_size_quark);
+  if (data == NULL)
+    {
+      PangoFontDescription *desc = pango_font_describe_with_absolute_size (font);
+
+      data = GINT_TO_POINTER (pango_font_description_get_size (desc) + 1);
+      g_object_set_qdata (G_OBJECT (font), font_size_quark, data);
+
+      pango_font_description_free (desc);
+    }
+
+  size = (float) (GPOINTER_TO_INT (data) - 1) / PANGO_SCALE;
+  if (size <= 0 || size * scale < SDF_MIN_SIZE)
+    return 0;
+
+  return SDF_GLYPH_SIZE / size;
+}
+
 GskGLImage *
 gsk_gl_glyph_cache_get_glyph_image (GskGLGlyphCache        *self,
                                     const GskGLCachedGlyph *glyph)
@@ -348,19 +1074,179 @@ gsk_gl_glyph_cache_get_glyph_image (GskGLGlyphCache        *self,
 
   g_assert (atlas != NULL);
 
-  if (atlas->image == NULL)
+  ensure_atlas_image (self, atlas);
+
+  return atlas->image;
+}
+
+/* Rasterizes and uploads all glyphs that were added to the cache since
+ * the last call. This needs to happen after all text nodes of a frame
+ * have been looked up and before the render ops are executed. */
+void
+gsk_gl_glyph_cache_upload (GskGLGlyphCache *self)
+{
+  guint i;
+
+  for (i = 0; i < self->atlases->len; i++)
     {
-      atlas->image = g_new0 (GskGLImage, 1);
-      gsk_gl_image_create (atlas->image, self->gl_driver, atlas->width, atlas->height);
-      gdk_gl_context_label_object_printf (gsk_gl_driver_get_gl_context (self->gl_driver),
-                                          GL_TEXTURE, atlas->image->texture_id,
-                                          "Glyph atlas %d", atlas->image->texture_id);
+      GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+      if (atlas->dirty_glyphs->len > 0)
+        upload_dirty_glyphs (self, atlas);
     }
+}
 
-  if (atlas->pending_glyph.key != NULL)
-    upload_dirty_glyph (self, atlas);
+static guint
+live_glyphs_in_atlas (GskGLGlyphCache *self,
+                      GskGLGlyphAtlas *atlas)
+{
+  GHashTableIter iter;
+  GskGLCachedGlyph *value;
+  guint n = 0;
 
-  return atlas->image;
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&value))
+    {
+      if (value->atlas == atlas &&
+          self->timestamp - value->timestamp < MAX_AGE)
+        n++;
+    }
+
+  return n;
+}
+
+static int
+compare_glyph_height (gconstpointer a,
+                      gconstpointer b)
+{
+  const GskGLCachedGlyph *ga = *(const GskGLCachedGlyph **)a;
+  const GskGLCachedGlyph *gb = *(const GskGLCachedGlyph **)b;
+
+  if (ga->th > gb->th)
+    return -1;
+  else if (ga->th < gb->th)
+    return 1;
+
+  return 0;
+}
+
+/* Drops the old glyphs of @atlas and packs the remaining ones again,
+ * relocating their pixels. Returns FALSE if there is nothing to keep,
+ * in which case the atlas can be dropped instead. */
+static gboolean
+compact_atlas (GskGLGlyphCache *self,
+               GskGLGlyphAtlas *atlas,
+               guint           *dropped)
+{
+  GHashTableIter iter;
+  GlyphCacheKey *key;
+  GskGLCachedGlyph *value;
+  GPtrArray *live;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  GskImageRegion region;
+  guint i;
+
+  /* The surface only goes away together with the atlas, and all dirty
+   * glyphs have been uploaded at the end of the last frame */
+  if (atlas->surface == NULL || atlas->image == NULL)
+    return FALSE;
+
+  g_assert (atlas->dirty_glyphs->len == 0);
+
+  live = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+    {
+      if (value->atlas != atlas)
+        continue;
+
+      if (self->timestamp - value->timestamp >= MAX_AGE)
+        {
+          g_hash_table_iter_remove (&iter);
+          (*dropped)++;
+        }
+      else
+        g_ptr_array_add (live, value);
+    }
+
+  if (live->len == 0)
+    {
+      g_ptr_array_free (live, TRUE);
+      return FALSE;
+    }
+
+  GSK_RENDERER_NOTE (self->renderer, GLYPH_CACHE,
+                     g_message ("Compacting atlas with %u live glyphs (%.2g%% old)", live->len,
+                                100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height)));
+
+  /* Packing tall glyphs first gives a much flatter skyline */
+  g_ptr_array_sort (live, compare_glyph_height);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, atlas->width, atlas->height);
+  cr = cairo_create (surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+
+  skyline_reset (atlas);
+
+  for (i = 0; i < live->len; i++)
+    {
+      int old_x, old_y, x, y, width, height;
+
+      value = g_ptr_array_index (live, i);
+      old_x = roundf (value->tx * atlas->width);
+      old_y = roundf (value->ty * atlas->height);
+      width = roundf (value->tw * atlas->width);
+      height = roundf (value->th * atlas->height);
+
+      /* Everything fit before, so this can only fail if the packer does
+       * worse on the new order. Forget about the glyph in that case, it
+       * will be added to another atlas when needed. */
+      if (!skyline_allocate (atlas, width, height, &x, &y))
+        {
+          GskGLCachedGlyph *v;
+
+          g_hash_table_iter_init (&iter, self->hash_table);
+          while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&v))
+            {
+              if (v == value)
+                {
+                  g_hash_table_iter_remove (&iter);
+                  (*dropped)++;
+                  break;
+                }
+            }
+          continue;
+        }
+
+      cairo_set_source_surface (cr, atlas->surface, x - old_x, y - old_y);
+      cairo_rectangle (cr, x, y, width, height);
+      cairo_fill (cr);
+
+      value->tx = (float)x / atlas->width;
+      value->ty = (float)y / atlas->height;
+    }
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  cairo_surface_destroy (atlas->surface);
+  atlas->surface = surface;
+  atlas->old_pixels = 0;
+
+  region.x = 0;
+  region.y = 0;
+  region.width = atlas->width;
+  region.height = atlas->height;
+  region.stride = cairo_image_surface_get_stride (surface);
+  region.data = cairo_image_surface_get_data (surface);
+
+  gsk_gl_image_upload_regions (atlas->image, self->gl_driver, 1, &region);
+
+  g_ptr_array_free (live, TRUE);
+
+  return TRUE;
 }
 
 void
@@ -371,9 +1257,10 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
   GlyphCacheKey *key;
   GskGLCachedGlyph *value;
   guint dropped = 0;
+  gboolean compacted = FALSE;
 
   self->timestamp++;
-
+  self->n_misses = 0;
 
   if ((self->timestamp - 1) % CHECK_INTERVAL != 0)
     return;
@@ -393,15 +1280,24 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
         }
     }
 
-  /* look for atlases to drop, and create a mapping of updated texture indices */
+  /* look for atlases to compact or drop */
   for (i = self->atlases->len - 1; i >= 0; i--)
     {
       GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
 
       if (atlas->old_pixels > MAX_OLD * atlas->width * atlas->height)
         {
+          if (!compacted && compact_atlas (self, atlas, &dropped))
+            {
+              compacted = TRUE;
+              continue;
+            }
+
+          if (live_glyphs_in_atlas (self, atlas) > 0)
+            continue;
+
           GSK_RENDERER_NOTE(self->renderer, GLYPH_CACHE,
-                   g_message ("Dropping atlas %d (%g.2%% old)",
+                   g_message ("Dropping atlas %d (%.2g%% old)",
                             i, 100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height)));
 
           if (atlas->image)
@@ -415,9 +1311,11 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
           while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
             {
               if (value->atlas == atlas)
-                g_hash_table_iter_remove (&iter);
+                {
+                  g_hash_table_iter_remove (&iter);
+                  dropped++;
+                }
             }
-          /* TODO: The above loop inside this other loop could be slow... */
 
           g_ptr_array_remove_index (self->atlases, i);
         }
@@ -14,8 +14,20 @@ typedef struct
 
   GHashTable *hash_table;
   GPtrArray *atlases;
+  int atlas_size;
 
   guint64 timestamp;
+
+  /* Glyphs that were not in the cache, since the start of the frame */
+  guint n_misses;
+
+  /* Glyphs rasterized by earlier runs, see GSK_GLYPH_CACHE */
+  char *persist_path;
+  GVariant *persisted_glyphs;
+  GHashTable *persisted;
+
+  /* Whether large text uses distance fields, see GSK_SDF_TEXT */
+  guint use_sdf : 1;
 } GskGLGlyphCache;
 
 typedef struct
@@ -23,6 +35,7 @@ typedef struct
   PangoFont *font;
   PangoGlyph glyph;
   guint scale; /* times 1024 */
+  guint sdf : 1;
 } GlyphCacheKey;
 
 typedef struct _DirtyGlyph DirtyGlyph;
@@ -32,16 +45,31 @@ struct _DirtyGlyph
 {
   GlyphCacheKey *key;
   GskGLCachedGlyph *value;
+  /* Pixels from an earlier run, or %NULL to rasterize the glyph */
+  const guchar *pixels;
 };
 
+typedef struct
+{
+  int x;
+  int y;
+  int width;
+} SkylineNode;
+
 typedef struct
 {
   GskGLImage *image;
   int width, height;
-  int x, y, y0;
+  GArray *skyline;
   guint old_pixels;
 
-  DirtyGlyph pending_glyph;
+  /* CPU-side copy of the atlas contents. Dirty glyphs are rasterized
+   * into it and uploaded in one go, see gsk_gl_glyph_cache_upload() */
+  cairo_surface_t *surface;
+  GArray *dirty_glyphs;
+
+  /* Holds distance fields, which are sampled with linear filtering */
+  guint sdf : 1;
 } GskGLGlyphAtlas;
 
 struct _GskGLCachedGlyph
@@ -58,6 +86,9 @@ struct _GskGLCachedGlyph
   int draw_width;
   int draw_height;
 
+  /* The border around distance fields, in the units of draw_x */
+  float sdf_padding;
+
   float scale;
 
   guint64 timestamp;
@@ -68,13 +99,19 @@ void                     gsk_gl_glyph_cache_init            (GskGLGlyphCache
                                                              GskRenderer            *renderer,
                                                              GskGLDriver            *gl_driver);
 void                     gsk_gl_glyph_cache_free            (GskGLGlyphCache        *self);
+void                     gsk_gl_glyph_cache_trim            (GskGLGlyphCache        *self);
 void                     gsk_gl_glyph_cache_begin_frame     (GskGLGlyphCache        *self);
+void                     gsk_gl_glyph_cache_upload          (GskGLGlyphCache        *self);
 GskGLImage *             gsk_gl_glyph_cache_get_glyph_image (GskGLGlyphCache        *self,
                                                              const GskGLCachedGlyph *glyph);
+float                    gsk_gl_glyph_cache_get_sdf_scale   (GskGLGlyphCache        *self,
+                                                             PangoFont              *font,
+                                                             float                   scale);
 const GskGLCachedGlyph * gsk_gl_glyph_cache_lookup          (GskGLGlyphCache        *self,
                                                              gboolean                create,
                                                              PangoFont              *font,
                                                              PangoGlyph              glyph,
-                                                             float                   scale);
+                                                             float                   scale,
+                                                             gboolean                sdf);
 
 #endif
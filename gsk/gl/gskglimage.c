@@ -1,5 +1,8 @@
 
 #include "gskglimageprivate.h"
+
+#include "gdk/gdkglcontextprivate.h"
+
 #include <epoxy/gl.h>
 
 void
@@ -47,8 +50,13 @@ gsk_gl_image_upload_regions (GskGLImage           *self,
                              guint                 n_regions,
                              const GskImageRegion *regions)
 {
+  GdkGLContext *context = gsk_gl_driver_get_gl_context (gl_driver);
+  gboolean has_row_length;
   guint i;
 
+  has_row_length = !gdk_gl_context_get_use_es (context) ||
+                   gdk_gl_context_has_unpack_subimage (context);
+
   for (i = 0; i < n_regions; i ++)
     {
       const GskImageRegion *region = &regions[i];
@@ -56,8 +64,29 @@ gsk_gl_image_upload_regions (GskGLImage           *self,
       gsk_gl_driver_bind_source_texture (gl_driver, self->texture_id);
       glBindTexture (GL_TEXTURE_2D, self->texture_id);
 
-      glTexSubImage2D (GL_TEXTURE_2D, 0, region->x, region->y, region->width, region->height,
-                       GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, region->data);
+      if (region->stride == region->width * 4)
+        {
+          glTexSubImage2D (GL_TEXTURE_2D, 0, region->x, region->y, region->width, region->height,
+                           GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, region->data);
+        }
+      else if (has_row_length)
+        {
+          glPixelStorei (GL_UNPACK_ROW_LENGTH, region->stride / 4);
+          glTexSubImage2D (GL_TEXTURE_2D, 0, region->x, region->y, region->width, region->height,
+                           GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, region->data);
+          glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+        }
+      else
+        {
+          gsize y;
+
+          /* No GL_UNPACK_ROW_LENGTH, go row by row */
+          for (y = 0; y < region->height; y++)
+            glTexSubImage2D (GL_TEXTURE_2D, 0, region->x, region->y + y, region->width, 1,
+                             GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, region->data + y * region->stride);
+        }
+
+      gsk_gl_driver_count_upload (gl_driver, (gsize) region->width * region->height * 4);
     }
 
 #ifdef G_ENABLE_DEBUG
@@ -49,3 +49,28 @@ node_sample_print (const NodeSample *self,
         }
     }
 }
+
+/* Returns a one-line summary like "12 nodes: GskColorNode 8, GskTextNode 4",
+ * short enough for a sysprof mark */
+char *
+node_sample_to_string (const NodeSample *self)
+{
+  const char *separator = ": ";
+  GString *string;
+  guint i;
+
+  string = g_string_new (NULL);
+  g_string_append_printf (string, "%u nodes", self->count);
+
+  for (i = 0; i < N_NODE_TYPES; i ++)
+    {
+      if (self->nodes[i].count > 0)
+        {
+          g_string_append_printf (string, "%s%s %u", separator,
+                                  self->nodes[i].class_name, self->nodes[i].count);
+          separator = ", ";
+        }
+    }
+
+  return g_string_free (string, FALSE);
+}
@@ -7,7 +7,7 @@
 #include "gskrendernode.h"
 
 /* TODO: We have no other way for this...? */
-#define N_NODE_TYPES (GSK_DEBUG_NODE + 1)
+#define N_NODE_TYPES (GSK_REPEATING_RADIAL_GRADIENT_NODE + 1)
 
 typedef struct
 {
@@ -24,5 +24,6 @@ void node_sample_add   (NodeSample       *self,
                         GskRenderNode    *node);
 void node_sample_print (const NodeSample *self,
                         const char       *prefix);
+char *node_sample_to_string (const NodeSample *self);
 
 #endif
@@ -3,9 +3,27 @@
 #include "gskglprofilerprivate.h"
 
 #include <epoxy/gl.h>
+#include <string.h>
 
 #define N_QUERIES       4
 
+/* Upper bound on the section marks recorded per frame. Frames with more
+ * program or render target changes than this get the remainder
+ * attributed to the last recorded section.
+ */
+#define MAX_MARKS       512
+
+#define NO_SECTION      G_MAXUINT
+
+typedef struct
+{
+  GLuint *queries;
+  guint *sections;
+  guint n_queries;
+  guint n_marks;
+  guint32 offscreen_marks[MAX_MARKS / 32];
+} SectionFrame;
+
 struct _GskGLProfiler
 {
   GObject parent_instance;
@@ -18,6 +36,15 @@ struct _GskGLProfiler
   GLuint gl_queries[N_QUERIES];
   GLuint active_query;
 
+  /* Timestamp queries issued whenever the renderer switches to another
+   * section of the frame. The frames share the circular buffer index with
+   * gl_queries, so a frame's results are only read back when its slot is
+   * about to be reused, N_QUERIES frames later, and never stall.
+   */
+  SectionFrame section_frames[N_QUERIES];
+  guint64 section_times[GSK_GL_PROFILER_MAX_SECTIONS];
+  guint64 offscreen_time;
+
   gboolean has_timer : 1;
   gboolean first_frame : 1;
 };
@@ -37,8 +64,21 @@ gsk_gl_profiler_finalize (GObject *gobject)
 {
   GskGLProfiler *self = GSK_GL_PROFILER (gobject);
 
+  guint i;
+
   glDeleteQueries (N_QUERIES, self->gl_queries);
 
+  for (i = 0; i < N_QUERIES; i++)
+    {
+      SectionFrame *frame = &self->section_frames[i];
+
+      if (frame->n_queries > 0)
+        glDeleteQueries (frame->n_queries, frame->queries);
+
+      g_free (frame->queries);
+      g_free (frame->sections);
+    }
+
   g_clear_object (&self->gl_context);
 
   G_OBJECT_CLASS (gsk_gl_profiler_parent_class)->finalize (gobject);
@@ -120,9 +160,90 @@ gsk_gl_profiler_new (GdkGLContext *context)
   return g_object_new (GSK_TYPE_GL_PROFILER, "gl-context", context, NULL);
 }
 
+static void
+section_frame_add_mark (SectionFrame *frame,
+                        guint         section,
+                        gboolean      offscreen)
+{
+  guint mark;
+
+  /* Keep the last slot for the mark terminating the frame */
+  if (frame->n_marks == MAX_MARKS ||
+      (frame->n_marks == MAX_MARKS - 1 && section != NO_SECTION))
+    return;
+
+  mark = frame->n_marks;
+
+  /* Queries are created on demand and kept around for later frames */
+  if (mark == frame->n_queries)
+    {
+      guint n_queries = MIN (MAX (frame->n_queries * 2, 16), MAX_MARKS);
+
+      frame->queries = g_renew (GLuint, frame->queries, n_queries);
+      frame->sections = g_renew (guint, frame->sections, n_queries);
+      glGenQueries (n_queries - frame->n_queries, frame->queries + frame->n_queries);
+      frame->n_queries = n_queries;
+    }
+
+  glQueryCounter (frame->queries[mark], GL_TIMESTAMP);
+  frame->sections[mark] = section;
+
+  if (offscreen)
+    frame->offscreen_marks[mark / 32] |= 1u << (mark % 32);
+  else
+    frame->offscreen_marks[mark / 32] &= ~(1u << (mark % 32));
+
+  frame->n_marks++;
+}
+
+static void
+gsk_gl_profiler_collect_sections (GskGLProfiler *profiler,
+                                  SectionFrame  *frame)
+{
+  GLuint64 previous = 0;
+  GLint available;
+  guint i;
+
+  if (frame->n_marks < 2)
+    return;
+
+  /* Timestamps complete in order, so the last one being available means
+   * all of them are. If it is not, the GPU is lagging more than N_QUERIES
+   * frames behind and we keep reporting the previous numbers.
+   */
+  glGetQueryObjectiv (frame->queries[frame->n_marks - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return;
+
+  memset (profiler->section_times, 0, sizeof (profiler->section_times));
+  profiler->offscreen_time = 0;
+
+  for (i = 0; i < frame->n_marks; i++)
+    {
+      GLuint64 timestamp;
+
+      glGetQueryObjectui64v (frame->queries[i], GL_QUERY_RESULT, &timestamp);
+
+      if (i > 0)
+        {
+          guint section = frame->sections[i - 1];
+          guint64 elapsed = timestamp > previous ? timestamp - previous : 0;
+
+          if (section < GSK_GL_PROFILER_MAX_SECTIONS)
+            profiler->section_times[section] += elapsed;
+
+          if (frame->offscreen_marks[(i - 1) / 32] & (1u << ((i - 1) % 32)))
+            profiler->offscreen_time += elapsed;
+        }
+
+      previous = timestamp;
+    }
+}
+
 void
 gsk_gl_profiler_begin_gpu_region (GskGLProfiler *profiler)
 {
+  SectionFrame *frame;
   GLuint query_id;
 
   g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
@@ -130,6 +251,12 @@ gsk_gl_profiler_begin_gpu_region (GskGLProfiler *profiler)
   if (!profiler->has_timer)
     return;
 
+  /* This slot was last used N_QUERIES frames ago, so its section marks
+   * should have landed by now */
+  frame = &profiler->section_frames[profiler->active_query];
+  gsk_gl_profiler_collect_sections (profiler, frame);
+  frame->n_marks = 0;
+
   query_id = profiler->gl_queries[profiler->active_query];
   glBeginQuery (GL_TIME_ELAPSED, query_id);
 }
@@ -148,6 +275,10 @@ gsk_gl_profiler_end_gpu_region (GskGLProfiler *profiler)
 
   glEndQuery (GL_TIME_ELAPSED);
 
+  /* Terminate the last section of the frame */
+  if (profiler->section_frames[profiler->active_query].n_marks > 0)
+    section_frame_add_mark (&profiler->section_frames[profiler->active_query], NO_SECTION, FALSE);
+
   if (profiler->active_query == 0)
     last_query_id = N_QUERIES - 1;
   else
@@ -173,3 +304,51 @@ gsk_gl_profiler_end_gpu_region (GskGLProfiler *profiler)
 
   return elapsed;
 }
+
+/**
+ * gsk_gl_profiler_mark_section:
+ * @profiler: a #GskGLProfiler
+ * @section: the section the following GPU commands belong to, smaller
+ *   than %GSK_GL_PROFILER_MAX_SECTIONS
+ * @offscreen: whether the following commands render to an offscreen
+ *   framebuffer
+ *
+ * Records a GPU timestamp between gsk_gl_profiler_begin_gpu_region() and
+ * gsk_gl_profiler_end_gpu_region(). The GPU time until the next mark is
+ * attributed to @section.
+ *
+ * The per-section times are read back a few frames later, when the
+ * queries are known to have completed, so they lag behind the frame
+ * being rendered.
+ */
+void
+gsk_gl_profiler_mark_section (GskGLProfiler *profiler,
+                              guint          section,
+                              gboolean       offscreen)
+{
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+  g_return_if_fail (section < GSK_GL_PROFILER_MAX_SECTIONS);
+
+  if (!profiler->has_timer)
+    return;
+
+  section_frame_add_mark (&profiler->section_frames[profiler->active_query], section, offscreen);
+}
+
+guint64
+gsk_gl_profiler_get_section_time (GskGLProfiler *profiler,
+                                  guint          section)
+{
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), 0);
+  g_return_val_if_fail (section < GSK_GL_PROFILER_MAX_SECTIONS, 0);
+
+  return profiler->section_times[section];
+}
+
+guint64
+gsk_gl_profiler_get_offscreen_time (GskGLProfiler *profiler)
+{
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), 0);
+
+  return profiler->offscreen_time;
+}
@@ -5,6 +5,8 @@
 
 G_BEGIN_DECLS
 
+#define GSK_GL_PROFILER_MAX_SECTIONS 32
+
 #define GSK_TYPE_GL_PROFILER (gsk_gl_profiler_get_type ())
 G_DECLARE_FINAL_TYPE (GskGLProfiler, gsk_gl_profiler, GSK, GL_PROFILER, GObject)
 
@@ -13,6 +15,13 @@ GskGLProfiler * gsk_gl_profiler_new                     (GdkGLContext  *context)
 void            gsk_gl_profiler_begin_gpu_region        (GskGLProfiler *profiler);
 guint64         gsk_gl_profiler_end_gpu_region          (GskGLProfiler *profiler);
 
+void            gsk_gl_profiler_mark_section            (GskGLProfiler *profiler,
+                                                         guint          section,
+                                                         gboolean       offscreen);
+guint64         gsk_gl_profiler_get_section_time        (GskGLProfiler *profiler,
+                                                         guint          section);
+guint64         gsk_gl_profiler_get_offscreen_time      (GskGLProfiler *profiler);
+
 G_END_DECLS
 
 #endif /* __GSK_GL_PROFILER_PRIVATE_H__ */
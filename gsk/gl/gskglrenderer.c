@@ -8,12 +8,14 @@
 #include "gskglprofilerprivate.h"
 #include "gskprofilerprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodeprivate.h"
 #include "gsktransformprivate.h"
 #include "gskshaderbuilderprivate.h"
 #include "gskglglyphcacheprivate.h"
 #include "gskglrenderopsprivate.h"
 #include "gskcairoblurprivate.h"
 #include "gskglshadowcacheprivate.h"
+#include "gskglscrollcacheprivate.h"
 #include "gskglnodesampleprivate.h"
 #include "gsktransform.h"
 
@@ -21,10 +23,12 @@
 
 #include "gdk/gdkgltextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #include <epoxy/gl.h>
 #include <cairo-ft.h>
+#include <string.h>
 
 #define SHADER_VERSION_GLES             100
 #define SHADER_VERSION_GL2_LEGACY       110
@@ -58,6 +62,14 @@
                               glGetUniformLocation(program_ptr->id, "u_" #uniform_basename);\
               }G_STMT_END
 
+#define INIT_TEXT_ATTRIBUTE_LOCATIONS(program_ptr) \
+              G_STMT_START{\
+                (program_ptr)->text.glyph_rect_location = glGetAttribLocation ((program_ptr)->id, "aGlyphRect");\
+                (program_ptr)->text.glyph_uv_location = glGetAttribLocation ((program_ptr)->id, "aGlyphUv");\
+                g_assert_cmpint ((program_ptr)->text.glyph_rect_location, >, -1); \
+                g_assert_cmpint ((program_ptr)->text.glyph_uv_location, >, -1); \
+              }G_STMT_END
+
 typedef enum
 {
   FORCE_OFFSCREEN  = 1 << 0,
@@ -186,12 +198,27 @@ font_has_color_glyphs (const PangoFont *font)
   return has_color;
 }
 
+/* Texture nodes that get shrunk to less than half their size on screen
+ * sample from mipmaps, so they don't alias and don't read all of the
+ * texture for a handful of pixels. */
+#define MIPMAP_SCALE_THRESHOLD 0.5f
+
 static void
-get_gl_scaling_filters (GskRenderNode *node,
-                        int           *min_filter_r,
-                        int           *mag_filter_r)
+get_gl_scaling_filters (GskRenderNode   *node,
+                        RenderOpBuilder *builder,
+                        int             *min_filter_r,
+                        int             *mag_filter_r)
 {
-  *min_filter_r = GL_LINEAR;
+  GdkTexture *texture = gsk_texture_node_get_texture (node);
+  const float scale = ops_get_scale (builder);
+  const float scale_x = node->bounds.size.width * scale / gdk_texture_get_width (texture);
+  const float scale_y = node->bounds.size.height * scale / gdk_texture_get_height (texture);
+
+  if (MAX (scale_x, scale_y) < MIPMAP_SCALE_THRESHOLD)
+    *min_filter_r = GL_LINEAR_MIPMAP_LINEAR;
+  else
+    *min_filter_r = GL_LINEAR;
+
   *mag_filter_r = GL_LINEAR;
 }
 
@@ -261,7 +288,7 @@ gsk_rounded_rect_shrink_to_minimum (GskRoundedRect *self)
                                          MAX (self->corner[2].height, self->corner[3].height)) * 2);
 }
 
-static inline gboolean
+static gboolean
 node_supports_transform (GskRenderNode *node)
 {
   /* Some nodes can't handle non-trivial transforms without being
@@ -280,10 +307,28 @@ node_supports_transform (GskRenderNode *node)
       case GSK_TRANSFORM_NODE:
       case GSK_CROSS_FADE_NODE:
       case GSK_LINEAR_GRADIENT_NODE:
-      case GSK_DEBUG_NODE:
+      case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      case GSK_REPEAT_NODE:
       case GSK_TEXT_NODE:
         return TRUE;
 
+      /* These don't draw anything themselves */
+      case GSK_DEBUG_NODE:
+        return node_supports_transform (gsk_debug_node_get_child (node));
+
+      case GSK_CONTAINER_NODE:
+        {
+          guint i, p;
+
+          for (i = 0, p = gsk_container_node_get_n_children (node); i < p; i ++)
+            {
+              if (!node_supports_transform (gsk_container_node_get_child (node, i)))
+                return FALSE;
+            }
+
+          return TRUE;
+        }
+
       default:
         return FALSE;
     }
@@ -328,24 +373,65 @@ struct _GskGLRenderer
       Program border_program;
       Program cross_fade_program;
       Program blend_program;
+      Program text_program;
+      Program text_blit_program;
+      Program repeat_program;
+      Program sdf_text_program;
+      Program radial_gradient_program;
     };
   };
 
   RenderOpBuilder op_builder;
   GArray *render_ops;
+  GArray *vertices;
+  GArray *glyph_instances;
+
+  /* Programs get compiled on first use, see gsk_gl_renderer_ensure_program() */
+  GskShaderBuilder *shader_builder;
+  guint32 started_programs;  /* bitmask of program indexes */
+  guint32 ready_programs;
+  guint warmup_id;
+
+  /* Whether text_program, text_blit_program and sdf_text_program are available */
+  guint use_instanced_text : 1;
+
+  /* Texture nodes may show a placeholder while their texture gets
+   * uploaded, see gsk_gl_driver_get_texture_for_texture_async().
+   * Only used when rendering to the surface. */
+  guint async_uploads : 1;
+  guint pending_uploads : 1;
+
+  /* Whether clips of scrolled content keep what they showed in a
+   * GskGLScrollLayer, see render_scroll_layer(). Set with
+   * GSK_SCROLL_LAYERS=1. */
+  guint use_scroll_layers : 1;
+
+  /* Nesting of GSK_DEBUG_REGIONS_IGNORE debug nodes */
+  guint debug_regions_ignored;
 
   GskGLGlyphCache glyph_cache;
   GskGLShadowCache shadow_cache;
+  GskGLScrollCache scroll_cache;
 
 #ifdef G_ENABLE_DEBUG
   struct {
     GQuark frames;
     GQuark draw_calls;
+    GQuark unbatched_draw_calls;
+    GQuark transform_offscreens;
+    GQuark culled_nodes;
+    GQuark scroll_layers;
   } profile_counters;
   struct {
     GQuark cpu_time;
     GQuark gpu_time;
+    GQuark gpu_offscreen_time;
+    GQuark gpu_program_time[GL_N_PROGRAMS];
   } profile_timers;
+
+  /* Nodes drawn this frame, only collected for sysprof captures */
+  NodeSample node_sample;
+  guint sample_nodes : 1;
 #endif
 
   cairo_region_t *render_region;
@@ -427,17 +513,74 @@ rounded_rect_to_floats (GskGLRenderer        *self,
     }
 }
 
+static inline void
+init_texture_key (GskTextureKey         *key,
+                  const RenderOpBuilder *builder,
+                  GskRenderNode         *node,
+                  const graphene_rect_t *bounds,
+                  gboolean               keep_clip,
+                  gboolean               keep_opacity)
+{
+  key->node = node;
+  key->scale = ops_get_scale (builder);
+  key->bounds = *bounds;
+
+  if (keep_clip && builder->current_clip != NULL)
+    key->clip = builder->current_clip->bounds;
+  else
+    graphene_rect_init (&key->clip, 0, 0, 0, 0);
+
+  key->opacity = keep_opacity ? builder->current_opacity : 1.0f;
+}
+
+/* Fallbacks get rasterized at a slightly bigger scale, so small changes
+ * of the scale, like during an animated transform, can keep using the
+ * same texture. Scales like 1, 1.5 or 2 stay exact. */
+#define FALLBACK_SCALE_STEPS 16
+
+static inline float
+get_fallback_scale (const RenderOpBuilder *builder)
+{
+  /* Don't let rounding errors of the modelview push us to the next step */
+  return ceilf (ops_get_scale (builder) * FALLBACK_SCALE_STEPS - 0.01f) / FALLBACK_SCALE_STEPS;
+}
+
+/* Tells the inspector about what gets drawn where, see
+ * gsk_renderer_record_debug_regions(). Only drawing to the surface
+ * is recorded, not the contents of offscreens. */
+static void
+add_debug_region (GskGLRenderer         *self,
+                  RenderOpBuilder       *builder,
+                  GskDebugRegion         kind,
+                  const graphene_rect_t *bounds)
+{
+  graphene_rect_t rect;
+
+  if (builder->current_render_target != 0 ||
+      self->debug_regions_ignored > 0 ||
+      !gsk_renderer_get_recording_debug_regions (GSK_RENDERER (self)))
+    return;
+
+  ops_transform_bounds_modelview (builder, bounds, &rect);
+  if (!graphene_rect_intersection (&builder->current_clip->bounds, &rect, &rect))
+    return;
+
+  graphene_rect_scale (&rect, 1.0f / self->scale_factor, 1.0f / self->scale_factor, &rect);
+  gsk_renderer_add_debug_region (GSK_RENDERER (self), kind, &rect);
+}
+
 static inline void
 render_fallback_node (GskGLRenderer       *self,
                       GskRenderNode       *node,
                       RenderOpBuilder     *builder,
                       const GskQuadVertex *vertex_data)
 {
-  const float scale = ops_get_scale (builder);
+  const float scale = get_fallback_scale (builder);
   const int surface_width = ceilf (node->bounds.size.width) * scale;
   const int surface_height = ceilf (node->bounds.size.height) * scale;
   cairo_surface_t *surface;
   cairo_t *cr;
+  GskTextureKey key;
   int cached_id;
   int texture_id;
 
@@ -445,7 +588,13 @@ render_fallback_node (GskGLRenderer       *self,
       surface_height <= 0)
     return;
 
-  cached_id = gsk_gl_driver_get_texture_for_pointer (self->gl_driver, node);
+  add_debug_region (self, builder, GSK_DEBUG_REGION_FALLBACK, &node->bounds);
+
+  /* The fallback surface doesn't depend on the clip or opacity, both get
+   * applied when drawing the texture. */
+  init_texture_key (&key, builder, node, &node->bounds, FALSE, FALSE);
+  key.scale = scale;
+  cached_id = gsk_gl_driver_get_texture_for_key (self->gl_driver, &key);
 
   if (cached_id != 0)
     {
@@ -492,7 +641,7 @@ render_fallback_node (GskGLRenderer       *self,
 
   cairo_surface_destroy (surface);
 
-  gsk_gl_driver_set_texture_for_pointer (self->gl_driver, node, texture_id);
+  gsk_gl_driver_set_texture_for_key (self->gl_driver, &key, texture_id);
 
   ops_set_program (builder, &self->blit_program);
   ops_set_texture (builder, texture_id);
@@ -510,6 +659,7 @@ render_text_node (GskGLRenderer   *self,
   const PangoGlyphInfo *glyphs = gsk_text_node_peek_glyphs (node);
   const float text_scale = ops_get_scale (builder);
   guint num_glyphs = gsk_text_node_get_num_glyphs (node);
+  float sdf_scale = 0;
   int i;
   int x_position = 0;
   float x = gsk_text_node_get_x (node) + builder->dx;
@@ -518,11 +668,20 @@ render_text_node (GskGLRenderer   *self,
   /* If the font has color glyphs, we don't need to recolor anything */
   if (!force_color && font_has_color_glyphs (font))
     {
-      ops_set_program (builder, &self->blit_program);
+      ops_set_program (builder, self->use_instanced_text ? &self->text_blit_program
+                                                         : &self->blit_program);
     }
   else
     {
-      ops_set_program (builder, &self->coloring_program);
+      /* Large text can use distance fields, which look the same at any scale */
+      if (self->use_instanced_text)
+        sdf_scale = gsk_gl_glyph_cache_get_sdf_scale (&self->glyph_cache, (PangoFont *)font, text_scale);
+
+      if (sdf_scale > 0)
+        ops_set_program (builder, &self->sdf_text_program);
+      else
+        ops_set_program (builder, self->use_instanced_text ? &self->text_program
+                                                           : &self->coloring_program);
       ops_set_color (builder, color);
     }
 
@@ -544,10 +703,12 @@ render_text_node (GskGLRenderer   *self,
                                          TRUE,
                                          (PangoFont *)font,
                                          gi->glyph,
-                                         text_scale);
+                                         sdf_scale > 0 ? sdf_scale : text_scale,
+                                         sdf_scale > 0);
 
-      /* e.g. whitespace */
-      if (glyph->draw_width <= 0 || glyph->draw_height <= 0 || glyph->scale <= 0)
+      /* e.g. whitespace, or glyphs too large for the atlas */
+      if (glyph->draw_width <= 0 || glyph->draw_height <= 0 || glyph->scale <= 0 ||
+          glyph->atlas == NULL)
         goto next;
 
       cx = (double)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
@@ -561,10 +722,19 @@ render_text_node (GskGLRenderer   *self,
       tx2 = tx + glyph->tw;
       ty2 = ty + glyph->th;
 
-      glyph_x = x + cx + glyph->draw_x;
-      glyph_y = y + cy + glyph->draw_y;
-      glyph_w = glyph->draw_width;
-      glyph_h = glyph->draw_height;
+      glyph_x = x + cx + glyph->draw_x - glyph->sdf_padding;
+      glyph_y = y + cy + glyph->draw_y - glyph->sdf_padding;
+      glyph_w = glyph->draw_width + 2 * glyph->sdf_padding;
+      glyph_h = glyph->draw_height + 2 * glyph->sdf_padding;
+
+      if (self->use_instanced_text)
+        {
+          ops_draw_glyph (builder, &(GlyphInstance) {
+            { glyph_x, glyph_y, glyph_w, glyph_h },
+            { tx, ty, glyph->tw, glyph->th },
+          });
+          goto next;
+        }
 
       ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
         { { glyph_x,           glyph_y           }, { tx,  ty  }, },
@@ -788,12 +958,26 @@ render_texture_node (GskGLRenderer       *self,
       int gl_min_filter = GL_NEAREST, gl_mag_filter = GL_NEAREST;
       int texture_id;
 
-      get_gl_scaling_filters (node, &gl_min_filter, &gl_mag_filter);
+      get_gl_scaling_filters (node, builder, &gl_min_filter, &gl_mag_filter);
+
+      if (self->async_uploads)
+        texture_id = gsk_gl_driver_get_texture_for_texture_async (self->gl_driver,
+                                                                  texture,
+                                                                  gl_min_filter,
+                                                                  gl_mag_filter);
+      else
+        texture_id = gsk_gl_driver_get_texture_for_texture (self->gl_driver,
+                                                            texture,
+                                                            gl_min_filter,
+                                                            gl_mag_filter);
+
+      /* Still uploading, leave the area empty for this frame */
+      if (texture_id == 0)
+        {
+          self->pending_uploads = TRUE;
+          return;
+        }
 
-      texture_id = gsk_gl_driver_get_texture_for_texture (self->gl_driver,
-                                                          texture,
-                                                          gl_min_filter,
-                                                          gl_mag_filter);
       ops_set_program (builder, &self->blit_program);
       ops_set_texture (builder, texture_id);
 
@@ -877,6 +1061,10 @@ render_transform_node (GskGLRenderer   *self,
              *       part (e.g. the rotation) and use that. We want to keep the scale
              *       for the texture.
              */
+#ifdef G_ENABLE_DEBUG
+            gsk_profiler_counter_inc (gsk_renderer_get_profiler (GSK_RENDERER (self)),
+                                      self->profile_counters.transform_offscreens);
+#endif
             add_offscreen_ops (self, builder,
                                &child->bounds,
                                child,
@@ -965,6 +1153,7 @@ render_linear_gradient_node (GskGLRenderer       *self,
   ops_set_program (builder, &self->linear_gradient_program);
   op.op = OP_CHANGE_LINEAR_GRADIENT;
   op.linear_gradient.n_color_stops = n_color_stops;
+  op.linear_gradient.repeat = gsk_render_node_get_node_type (node) == GSK_REPEATING_LINEAR_GRADIENT_NODE;
   op.linear_gradient.start_point = *start;
   op.linear_gradient.start_point.x += builder->dx;
   op.linear_gradient.start_point.y += builder->dy;
@@ -976,6 +1165,292 @@ render_linear_gradient_node (GskGLRenderer       *self,
   ops_draw (builder, vertex_data);
 }
 
+static inline void
+render_radial_gradient_node (GskGLRenderer       *self,
+                             GskRenderNode       *node,
+                             RenderOpBuilder     *builder,
+                             const GskQuadVertex *vertex_data)
+{
+  RenderOp op;
+  const int n_color_stops = gsk_radial_gradient_node_get_n_color_stops (node);
+  const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+  const graphene_point_t *center = gsk_radial_gradient_node_peek_center (node);
+  int i;
+
+  for (i = 0; i < n_color_stops; i ++)
+    {
+      const GskColorStop *stop = stops + i;
+
+      op.radial_gradient.color_stops[(i * 4) + 0] = stop->color.red;
+      op.radial_gradient.color_stops[(i * 4) + 1] = stop->color.green;
+      op.radial_gradient.color_stops[(i * 4) + 2] = stop->color.blue;
+      op.radial_gradient.color_stops[(i * 4) + 3] = stop->color.alpha;
+      op.radial_gradient.color_offsets[i] = stop->offset;
+    }
+
+  ops_set_program (builder, &self->radial_gradient_program);
+  op.op = OP_CHANGE_RADIAL_GRADIENT;
+  op.radial_gradient.n_color_stops = n_color_stops;
+  op.radial_gradient.repeat = gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE;
+  op.radial_gradient.center = *center;
+  op.radial_gradient.center.x += builder->dx;
+  op.radial_gradient.center.y += builder->dy;
+  op.radial_gradient.radius[0] = gsk_radial_gradient_node_get_hradius (node);
+  op.radial_gradient.radius[1] = gsk_radial_gradient_node_get_vradius (node);
+  op.radial_gradient.start = gsk_radial_gradient_node_get_start (node);
+  op.radial_gradient.end = gsk_radial_gradient_node_get_end (node);
+  ops_add (builder, &op);
+
+  ops_draw (builder, vertex_data);
+}
+
+static inline gboolean
+is_integral (float f)
+{
+  return fabsf (f - roundf (f)) < 0.001f;
+}
+
+/* Draws @child, a translated node, into the layer at @target. When
+ * @source_texture is not 0, it is the previous frame of the layer,
+ * which gets drawn @shift_x, @shift_y device pixels away so only the
+ * strips that it doesn't cover need to be drawn from @child. */
+static void
+draw_scroll_layer (GskGLRenderer         *self,
+                   RenderOpBuilder       *builder,
+                   const graphene_rect_t *clip,
+                   GskRenderNode         *child,
+                   int                    target,
+                   int                    source_texture,
+                   float                  shift_x,
+                   float                  shift_y)
+{
+  const float scale = ops_get_scale (builder);
+  const float x = clip->origin.x * scale;
+  const float y = clip->origin.y * scale;
+  const float width = roundf (clip->size.width * scale);
+  const float height = roundf (clip->size.height * scale);
+  const float dx = builder->dx;
+  const float dy = builder->dy;
+  graphene_rect_t strips[2];
+  guint n_strips = 0;
+  int prev_render_target;
+  RenderOp op;
+  graphene_matrix_t modelview;
+  graphene_matrix_t prev_projection;
+  graphene_rect_t prev_viewport;
+  graphene_matrix_t item_proj;
+  float prev_opacity;
+  gboolean prev_async_uploads;
+  guint i;
+
+  graphene_matrix_init_ortho (&item_proj,
+                              x, x + width,
+                              y, y + height,
+                              ORTHO_NEAR_PLANE, ORTHO_FAR_PLANE);
+  graphene_matrix_scale (&item_proj, 1, -1, 1);
+  graphene_matrix_init_scale (&modelview, scale, scale, 1);
+
+  prev_render_target = ops_set_render_target (builder, target);
+  op.op = OP_CLEAR;
+  ops_add (builder, &op);
+  prev_projection = ops_set_projection (builder, &item_proj);
+  ops_set_modelview (builder, &modelview,
+                     scale == 1 ? GSK_TRANSFORM_CATEGORY_IDENTITY : GSK_TRANSFORM_CATEGORY_2D_AFFINE);
+  prev_viewport = ops_set_viewport (builder, &GRAPHENE_RECT_INIT (x, y, width, height));
+  ops_push_clip (builder, &GSK_ROUNDED_RECT_INIT (x, y, width, height));
+  builder->dx = 0;
+  builder->dy = 0;
+  prev_opacity = ops_set_opacity (builder, 1.0);
+
+  if (source_texture != 0)
+    {
+      const float min_x = clip->origin.x + shift_x / scale;
+      const float min_y = clip->origin.y + shift_y / scale;
+      const float max_x = min_x + clip->size.width;
+      const float max_y = min_y + clip->size.height;
+
+      ops_set_program (builder, &self->blit_program);
+      ops_set_texture (builder, source_texture);
+      ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+        { { min_x, min_y }, { 0, 1 }, },
+        { { min_x, max_y }, { 0, 0 }, },
+        { { max_x, min_y }, { 1, 1 }, },
+
+        { { max_x, max_y }, { 1, 0 }, },
+        { { min_x, max_y }, { 0, 0 }, },
+        { { max_x, min_y }, { 1, 1 }, },
+      });
+
+      /* The rows that got scrolled into view, then what's left of the
+       * columns next to them */
+      if (shift_y > 0)
+        strips[n_strips++] = GRAPHENE_RECT_INIT (x, y, width, shift_y);
+      else if (shift_y < 0)
+        strips[n_strips++] = GRAPHENE_RECT_INIT (x, y + height + shift_y, width, - shift_y);
+
+      if (shift_x > 0)
+        strips[n_strips++] = GRAPHENE_RECT_INIT (x, y + MAX (shift_y, 0),
+                                                 shift_x, height - fabsf (shift_y));
+      else if (shift_x < 0)
+        strips[n_strips++] = GRAPHENE_RECT_INIT (x + width + shift_x, y + MAX (shift_y, 0),
+                                                 - shift_x, height - fabsf (shift_y));
+    }
+  else
+    {
+      strips[n_strips++] = GRAPHENE_RECT_INIT (x, y, width, height);
+    }
+
+  /* The layer is kept, so it must not contain placeholders */
+  prev_async_uploads = self->async_uploads;
+  self->async_uploads = FALSE;
+  for (i = 0; i < n_strips; i++)
+    {
+      /* Everything outside of the strip gets culled */
+      ops_push_clip (builder,
+                     &GSK_ROUNDED_RECT_INIT (strips[i].origin.x, strips[i].origin.y,
+                                             strips[i].size.width, strips[i].size.height));
+      gsk_gl_renderer_add_render_ops (self, child, builder);
+      ops_pop_clip (builder);
+    }
+  self->async_uploads = prev_async_uploads;
+
+  ops_set_opacity (builder, prev_opacity);
+  builder->dx = dx;
+  builder->dy = dy;
+  ops_pop_clip (builder);
+  ops_set_viewport (builder, &prev_viewport);
+  ops_pop_modelview (builder);
+  ops_set_projection (builder, &prev_projection);
+  ops_set_render_target (builder, prev_render_target);
+}
+
+/* Draws a clip node whose child is only translated, like the child of
+ * a viewport, from a scroll layer. When just the translation changed
+ * since the last frame, the layer gets shifted and only the parts that
+ * got scrolled into view are drawn. Returns %FALSE when the node needs
+ * to be drawn as usual. */
+static gboolean
+render_scroll_layer (GskGLRenderer   *self,
+                     GskRenderNode   *node,
+                     RenderOpBuilder *builder)
+{
+  const graphene_rect_t *clip = gsk_clip_node_peek_clip (node);
+  GskRenderNode *child = gsk_clip_node_get_child (node);
+  GskRenderNode *content;
+  GskTransform *transform;
+  GskGLScrollLayer *layer;
+  graphene_rect_t bounds;
+  graphene_point_t offset;
+  float scale;
+
+  /* Layers are only kept for what gets drawn on the surface, not for
+   * offscreens or other layers */
+  if (!self->use_scroll_layers || builder->current_render_target != 0)
+    return FALSE;
+
+  if (gsk_render_node_get_node_type (child) != GSK_TRANSFORM_NODE)
+    return FALSE;
+
+  transform = gsk_transform_node_get_transform (child);
+  if (gsk_transform_get_category (transform) != GSK_TRANSFORM_CATEGORY_2D_TRANSLATE ||
+      ops_get_modelview_category (builder) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    return FALSE;
+
+  /* The layer has to cover whole pixels, or drawing it would blur it */
+  scale = ops_get_scale (builder);
+  ops_transform_bounds_modelview (builder, clip, &bounds);
+  if (!is_integral (bounds.origin.x) || !is_integral (bounds.origin.y) ||
+      !is_integral (bounds.size.width) || !is_integral (bounds.size.height))
+    return FALSE;
+
+  bounds.origin.x = roundf (bounds.origin.x);
+  bounds.origin.y = roundf (bounds.origin.y);
+  bounds.size.width = roundf (bounds.size.width);
+  bounds.size.height = roundf (bounds.size.height);
+
+  if (bounds.size.width < 1 || bounds.size.height < 1 ||
+      bounds.size.width > gsk_gl_driver_get_max_texture_size (self->gl_driver) ||
+      bounds.size.height > gsk_gl_driver_get_max_texture_size (self->gl_driver) ||
+      fabsf (clip->size.width * scale - bounds.size.width) > 0.001f ||
+      fabsf (clip->size.height * scale - bounds.size.height) > 0.001f ||
+      !graphene_rect_intersection (&bounds, &builder->current_clip->bounds, NULL))
+    return FALSE;
+
+  layer = gsk_gl_scroll_cache_get_layer (&self->scroll_cache, &bounds, scale);
+  if (layer == NULL)
+    return FALSE;
+
+  content = gsk_transform_node_get_child (child);
+  gsk_transform_to_translate (transform, &offset.x, &offset.y);
+
+  if (layer->content != content || !layer->has_contents)
+    {
+      const gboolean scrolled = layer->content == content &&
+                                !graphene_point_equal (&layer->offset, &offset);
+
+      gsk_gl_scroll_layer_set_content (layer, content, &offset);
+
+      /* Only content that gets scrolled is worth keeping, everything
+       * else is just as fast to draw directly */
+      if (!scrolled)
+        return FALSE;
+
+      gsk_gl_scroll_layer_ensure_textures (layer, self->gl_driver);
+      draw_scroll_layer (self, builder, clip, child,
+                         layer->render_targets[layer->current], 0, 0, 0);
+      layer->has_contents = TRUE;
+    }
+  else if (!graphene_point_equal (&layer->offset, &offset))
+    {
+      const float shift_x = (offset.x - layer->offset.x) * scale;
+      const float shift_y = (offset.y - layer->offset.y) * scale;
+      const guint next = 1 - layer->current;
+
+      if (is_integral (shift_x) && is_integral (shift_y) &&
+          fabsf (shift_x) < bounds.size.width && fabsf (shift_y) < bounds.size.height)
+        {
+          draw_scroll_layer (self, builder, clip, child,
+                             layer->render_targets[next],
+                             layer->texture_ids[layer->current],
+                             roundf (shift_x), roundf (shift_y));
+          layer->current = next;
+        }
+      else
+        {
+          draw_scroll_layer (self, builder, clip, child,
+                             layer->render_targets[layer->current], 0, 0, 0);
+        }
+
+      layer->offset = offset;
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (gsk_renderer_get_profiler (GSK_RENDERER (self)),
+                            self->profile_counters.scroll_layers);
+#endif
+
+  {
+    const float min_x = builder->dx + clip->origin.x;
+    const float min_y = builder->dy + clip->origin.y;
+    const float max_x = min_x + clip->size.width;
+    const float max_y = min_y + clip->size.height;
+
+    ops_set_program (builder, &self->blit_program);
+    ops_set_texture (builder, layer->texture_ids[layer->current]);
+    ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+      { { min_x, min_y }, { 0, 1 }, },
+      { { min_x, max_y }, { 0, 0 }, },
+      { { max_x, min_y }, { 1, 1 }, },
+
+      { { max_x, max_y }, { 1, 0 }, },
+      { { min_x, max_y }, { 0, 0 }, },
+      { { max_x, min_y }, { 1, 1 }, },
+    });
+  }
+
+  return TRUE;
+}
+
 static inline void
 render_clip_node (GskGLRenderer   *self,
                   GskRenderNode   *node,
@@ -986,6 +1461,9 @@ render_clip_node (GskGLRenderer   *self,
   graphene_rect_t intersection;
   GskRoundedRect child_clip;
 
+  if (render_scroll_layer (self, node, builder))
+    return;
+
   transformed_clip = *gsk_clip_node_peek_clip (node);
   ops_transform_bounds_modelview (builder, &transformed_clip, &transformed_clip);
 
@@ -1116,6 +1594,43 @@ gsk_rounded_rect_intersection (const GskRoundedRect *outer,
         }
     }
 
+  /* Cutting a rounded rectangle with a rectangle keeps it rounded
+   * as long as the cuts don't go through a curved corner. */
+  if (gsk_rounded_rect_is_rectilinear (outer))
+    {
+      graphene_rect_t bounds;
+      int i;
+
+      if (!graphene_rect_intersection (outer_bounds, inner_bounds, &bounds))
+        return FALSE;
+
+      for (i = 0; i < 4; i ++)
+        {
+          const graphene_size_t *corner = &inner->corner[i];
+          graphene_rect_t corner_rect;
+          graphene_rect_t cut;
+
+          corner_rect.origin.x = inner_bounds->origin.x;
+          corner_rect.origin.y = inner_bounds->origin.y;
+          if (i == GSK_CORNER_TOP_RIGHT || i == GSK_CORNER_BOTTOM_RIGHT)
+            corner_rect.origin.x += inner_bounds->size.width - corner->width;
+          if (i == GSK_CORNER_BOTTOM_RIGHT || i == GSK_CORNER_BOTTOM_LEFT)
+            corner_rect.origin.y += inner_bounds->size.height - corner->height;
+          corner_rect.size = *corner;
+
+          if (graphene_rect_contains_rect (&bounds, &corner_rect))
+            out_intersection->corner[i] = *corner;
+          else if (!graphene_rect_intersection (&bounds, &corner_rect, &cut) ||
+                   cut.size.width == 0 || cut.size.height == 0)
+            graphene_size_init (&out_intersection->corner[i], 0, 0);
+          else
+            return FALSE;
+        }
+
+      out_intersection->bounds = bounds;
+      return TRUE;
+    }
+
   /* Actually not possible or just too much work. */
   return FALSE;
 }
@@ -1130,13 +1645,31 @@ render_rounded_clip_node (GskGLRenderer       *self,
   GskRoundedRect transformed_clip;
   GskRenderNode *child = gsk_rounded_clip_node_get_child (node);
   GskRoundedRect intersection;
+  graphene_rect_t child_bounds;
   gboolean need_offscreen;
   int i;
 
   transformed_clip = child_clip;
   ops_transform_bounds_modelview (builder, &child_clip.bounds, &transformed_clip.bounds);
+  for (i = 0; i < 4; i ++)
+    {
+      transformed_clip.corner[i].width *= scale;
+      transformed_clip.corner[i].height *= scale;
+    }
+
+  /* Only the part of the clips the child draws to matters. The
+   * child is usually a texture, color or gradient filling
+   * the clip, so one of the clips often doesn't cut it. */
+  if (gsk_rounded_rect_contains_rect (&child_clip, &child->bounds))
+    {
+      gsk_gl_renderer_add_render_ops (self, child, builder);
+      return;
+    }
 
-  if (!ops_has_clip (builder))
+  ops_transform_bounds_modelview (builder, &child->bounds, &child_bounds);
+
+  if (!ops_has_clip (builder) ||
+      gsk_rounded_rect_contains_rect (builder->current_clip, &child_bounds))
     {
       intersection = transformed_clip;
       need_offscreen = FALSE;
@@ -1152,12 +1685,6 @@ render_rounded_clip_node (GskGLRenderer       *self,
     {
       /* If they don't intersect at all, we can simply set
        * the new clip and add the render ops */
-      for (i = 0; i < 4; i ++)
-        {
-          intersection.corner[i].width *= scale;
-          intersection.corner[i].height *= scale;
-        }
-
       ops_push_clip (builder, &intersection);
       gsk_gl_renderer_add_render_ops (self, child, builder);
       ops_pop_clip (builder);
@@ -1462,10 +1989,11 @@ render_outset_shadow_node (GskGLRenderer       *self,
       ops_set_modelview (builder, &identity, GSK_TRANSFORM_CATEGORY_IDENTITY);
       prev_viewport = ops_set_viewport (builder, &GRAPHENE_RECT_INIT (0, 0, texture_width, texture_height));
 
-      /* Draw outline */
+      /* Draw outline. We draw it in white, the outset shadow program
+       * tints it, so shadows of all colors can share the texture. */
       ops_set_program (builder, &self->color_program);
       ops_push_clip (builder, &offset_outline);
-      ops_set_color (builder, gsk_outset_shadow_node_peek_color (node));
+      ops_set_color (builder, &(GdkRGBA) { 1, 1, 1, 1 });
       ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
         { { 0,                            }, { 0, 1 }, },
         { { 0,             texture_height }, { 0, 0 }, },
@@ -1522,7 +2050,9 @@ render_outset_shadow_node (GskGLRenderer       *self,
       gsk_gl_shadow_cache_commit (&self->shadow_cache,
                                   &offset_outline,
                                   blur_radius,
-                                  blurred_texture_id);
+                                  blurred_texture_id,
+                                  texture_width,
+                                  texture_height);
     }
   else
     {
@@ -1532,6 +2062,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
   ops_set_program (builder, &self->outset_shadow_program);
   ops_set_texture (builder, blurred_texture_id);
   op.op = OP_CHANGE_OUTSET_SHADOW;
+  rgba_to_float (gsk_outset_shadow_node_peek_color (node), op.outset_shadow.color);
   rounded_rect_to_floats (self, builder,
                           outline,
                           op.outset_shadow.outline,
@@ -1957,6 +2488,55 @@ render_blend_node (GskGLRenderer   *self,
   ops_draw (builder, vertex_data);
 }
 
+static inline void
+render_repeat_node (GskGLRenderer   *self,
+                    GskRenderNode   *node,
+                    RenderOpBuilder *builder)
+{
+  GskRenderNode *child = gsk_repeat_node_get_child (node);
+  const graphene_rect_t *child_bounds = gsk_repeat_node_peek_child_bounds (node);
+  const float min_x = builder->dx + node->bounds.origin.x;
+  const float min_y = builder->dy + node->bounds.origin.y;
+  const float max_x = min_x + node->bounds.size.width;
+  const float max_y = min_y + node->bounds.size.height;
+  float min_u, min_v, max_u, max_v;
+  int texture_id;
+  gboolean is_offscreen;
+
+  if (child_bounds->size.width <= 0 || child_bounds->size.height <= 0)
+    return;
+
+  /* Only one tile of the child gets drawn, the repeat program
+   * wraps the texture coordinates around it */
+  add_offscreen_ops (self, builder,
+                     child_bounds,
+                     child,
+                     &texture_id, &is_offscreen,
+                     FORCE_OFFSCREEN | RESET_CLIP | RESET_OPACITY);
+
+  min_u = (node->bounds.origin.x - child_bounds->origin.x) / child_bounds->size.width;
+  max_u = min_u + node->bounds.size.width / child_bounds->size.width;
+  /* Offscreens are upside down */
+  max_v = 1 - (node->bounds.origin.y - child_bounds->origin.y) / child_bounds->size.height;
+  min_v = max_v - node->bounds.size.height / child_bounds->size.height;
+
+  {
+    const GskQuadVertex vertex_data[GL_N_VERTICES] = {
+      { { min_x, min_y }, { min_u, max_v }, },
+      { { min_x, max_y }, { min_u, min_v }, },
+      { { max_x, min_y }, { max_u, max_v }, },
+
+      { { max_x, max_y }, { max_u, min_v }, },
+      { { min_x, max_y }, { min_u, min_v }, },
+      { { max_x, min_y }, { max_u, max_v }, },
+    };
+
+    ops_set_program (builder, &self->repeat_program);
+    ops_set_texture (builder, texture_id);
+    ops_draw (builder, vertex_data);
+  }
+}
+
 static inline void
 apply_viewport_op (const Program  *program,
                    const RenderOp *op)
@@ -2139,11 +2719,37 @@ apply_outset_shadow_op (const Program  *program,
                         const RenderOp *op)
 {
   OP_PRINT (" -> outset shadow");
+  glUniform4fv (program->outset_shadow.color_location, 1, op->outset_shadow.color);
   glUniform4fv (program->outset_shadow.outline_location, 1, op->outset_shadow.outline);
   glUniform4fv (program->outset_shadow.corner_widths_location, 1, op->outset_shadow.corner_widths);
   glUniform4fv (program->outset_shadow.corner_heights_location, 1, op->outset_shadow.corner_heights);
 }
 
+static inline void
+apply_radial_gradient_op (const Program  *program,
+                          const RenderOp *op)
+{
+  OP_PRINT (" -> Radial gradient");
+  glUniform1i (program->radial_gradient.num_color_stops_location,
+               op->radial_gradient.n_color_stops);
+  glUniform4fv (program->radial_gradient.color_stops_location,
+                op->radial_gradient.n_color_stops,
+                op->radial_gradient.color_stops);
+  glUniform1fv (program->radial_gradient.color_offsets_location,
+                op->radial_gradient.n_color_stops,
+                op->radial_gradient.color_offsets);
+  glUniform2f (program->radial_gradient.center_location,
+               op->radial_gradient.center.x, op->radial_gradient.center.y);
+  glUniform2fv (program->radial_gradient.radius_location, 1,
+                op->radial_gradient.radius);
+  glUniform1f (program->radial_gradient.start_location,
+               op->radial_gradient.start);
+  glUniform1f (program->radial_gradient.end_location,
+               op->radial_gradient.end);
+  glUniform1i (program->radial_gradient.repeat_location,
+               op->radial_gradient.repeat);
+}
+
 static inline void
 apply_linear_gradient_op (const Program  *program,
                           const RenderOp *op)
@@ -2161,6 +2767,8 @@ apply_linear_gradient_op (const Program  *program,
                op->linear_gradient.start_point.x, op->linear_gradient.start_point.y);
   glUniform2f (program->linear_gradient.end_point_location,
                op->linear_gradient.end_point.x, op->linear_gradient.end_point.y);
+  glUniform1i (program->linear_gradient.repeat_location,
+               op->linear_gradient.repeat);
 }
 
 static inline void
@@ -2243,16 +2851,319 @@ apply_blend_op (const Program  *program,
   glUniform1i (program->blend.mode_location, op->blend.mode);
 }
 
+static inline void
+apply_draw_instanced_op (const Program  *program,
+                         const RenderOp *op,
+                         guint           vao_id,
+                         guint           buffer_id)
+{
+  const gsize offset = op->draw_instanced.instance_offset * sizeof (GlyphInstance);
+
+  OP_PRINT (" -> draw instanced %ld, %ld instances and program %d\n",
+            op->draw_instanced.instance_offset, op->draw_instanced.n_instances, program->index);
+
+  /* The attribute pointers change with every draw, so they live in
+   * their own VAO to leave the one for the quad vertices alone. */
+  glBindVertexArray (vao_id);
+  glBindBuffer (GL_ARRAY_BUFFER, buffer_id);
+
+  glEnableVertexAttribArray (program->text.glyph_rect_location);
+  glVertexAttribPointer (program->text.glyph_rect_location, 4, GL_FLOAT, GL_FALSE,
+                         sizeof (GlyphInstance),
+                         (void *) (offset + G_STRUCT_OFFSET (GlyphInstance, rect)));
+  glVertexAttribDivisor (program->text.glyph_rect_location, 1);
+
+  glEnableVertexAttribArray (program->text.glyph_uv_location);
+  glVertexAttribPointer (program->text.glyph_uv_location, 4, GL_FLOAT, GL_FALSE,
+                         sizeof (GlyphInstance),
+                         (void *) (offset + G_STRUCT_OFFSET (GlyphInstance, uv)));
+  glVertexAttribDivisor (program->text.glyph_uv_location, 1);
+
+  glDrawArraysInstanced (GL_TRIANGLES, 0, GL_N_VERTICES, op->draw_instanced.n_instances);
+}
+
 static void
 gsk_gl_renderer_dispose (GObject *gobject)
 {
   GskGLRenderer *self = GSK_GL_RENDERER (gobject);
 
   g_clear_pointer (&self->render_ops, g_array_unref);
+  g_clear_pointer (&self->vertices, g_array_unref);
+  g_clear_pointer (&self->glyph_instances, g_array_unref);
 
   G_OBJECT_CLASS (gsk_gl_renderer_parent_class)->dispose (gobject);
 }
 
+static const struct {
+  const char *name;
+  const char *fs;
+  const char *vs; /* NULL for the common blit.vs.glsl */
+} program_definitions[GL_N_PROGRAMS] = {
+  { "blit",            "blit.fs.glsl" },
+  { "color",           "color.fs.glsl" },
+  { "coloring",        "coloring.fs.glsl" },
+  { "color matrix",    "color_matrix.fs.glsl" },
+  { "linear gradient", "linear_gradient.fs.glsl" },
+  { "blur",            "blur.fs.glsl" },
+  { "inset shadow",    "inset_shadow.fs.glsl" },
+  { "outset shadow",   "outset_shadow.fs.glsl" },
+  { "unblurred outset shadow",   "unblurred_outset_shadow.fs.glsl" },
+  { "border",          "border.fs.glsl" },
+  { "cross fade",      "cross_fade.fs.glsl" },
+  { "blend",           "blend.fs.glsl" },
+  { "text",            "coloring.fs.glsl", "text.vs.glsl" },
+  { "text blit",       "blit.fs.glsl",     "text.vs.glsl" },
+  { "repeat",          "repeat.fs.glsl" },
+  { "sdf text",        "sdf_text.fs.glsl", "text.vs.glsl" },
+  { "radial gradient", "radial_gradient.fs.glsl" },
+};
+
+/* Programs are the sections of the GPU profile */
+G_STATIC_ASSERT (GL_N_PROGRAMS <= GSK_GL_PROFILER_MAX_SECTIONS);
+
+#ifdef G_ENABLE_DEBUG
+/* sysprof counters, shared by all GL renderers */
+static guint render_nodes_counter;
+static guint glyph_misses_counter;
+static guint texture_uploads_counter;
+static guint texture_upload_bytes_counter;
+#endif
+
+static void
+gsk_gl_renderer_init_program_locations (GskGLRenderer *self,
+                                        Program       *prog)
+{
+  INIT_COMMON_UNIFORM_LOCATION (prog, alpha);
+  INIT_COMMON_UNIFORM_LOCATION (prog, source);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_widths);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_heights);
+  INIT_COMMON_UNIFORM_LOCATION (prog, viewport);
+  INIT_COMMON_UNIFORM_LOCATION (prog, projection);
+  INIT_COMMON_UNIFORM_LOCATION (prog, modelview);
+
+  if (prog == &self->color_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (color, color);
+    }
+  else if (prog == &self->coloring_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (coloring, color);
+    }
+  else if (prog == &self->color_matrix_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
+      INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
+    }
+  else if (prog == &self->linear_gradient_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_offsets);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, num_color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, start_point);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, end_point);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, repeat);
+    }
+  else if (prog == &self->radial_gradient_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_offsets);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, num_color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, center);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, radius);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, start);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, end);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, repeat);
+    }
+  else if (prog == &self->blur_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_radius);
+      INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_size);
+      /*INIT_PROGRAM_UNIFORM_LOCATION (blur, dir);*/
+    }
+  else if (prog == &self->inset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, spread);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, offset);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_heights);
+    }
+  else if (prog == &self->outset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_heights);
+    }
+  else if (prog == &self->unblurred_outset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, spread);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, offset);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_heights);
+    }
+  else if (prog == &self->border_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (border, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (border, widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (border, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (border, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (border, corner_heights);
+    }
+  else if (prog == &self->cross_fade_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, progress);
+      INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, source2);
+    }
+  else if (prog == &self->blend_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (blend, source2);
+      INIT_PROGRAM_UNIFORM_LOCATION (blend, mode);
+    }
+  else if (prog == &self->text_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (text, color);
+      INIT_TEXT_ATTRIBUTE_LOCATIONS (&self->text_program);
+    }
+  else if (prog == &self->text_blit_program)
+    {
+      INIT_TEXT_ATTRIBUTE_LOCATIONS (&self->text_blit_program);
+    }
+  else if (prog == &self->sdf_text_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (sdf_text, color);
+      INIT_TEXT_ATTRIBUTE_LOCATIONS (&self->sdf_text_program);
+    }
+}
+
+static gboolean
+gsk_gl_renderer_program_is_available (GskGLRenderer *self,
+                                      int            index)
+{
+  /* Custom vertex shaders are GL3 only */
+  return program_definitions[index].vs == NULL || self->use_instanced_text;
+}
+
+static void
+gsk_gl_renderer_begin_program (GskGLRenderer  *self,
+                               int             index,
+                               GError        **error)
+{
+  Program *prog = &self->programs[index];
+
+  g_assert ((self->started_programs & (1 << index)) == 0);
+
+  self->started_programs |= 1 << index;
+  prog->id = gsk_shader_builder_begin_program (self->shader_builder,
+                                               program_definitions[index].vs,
+                                               program_definitions[index].fs,
+                                               error);
+}
+
+static void
+gsk_gl_renderer_finish_program (GskGLRenderer  *self,
+                                int             index,
+                                GError        **error)
+{
+  Program *prog = &self->programs[index];
+
+  self->ready_programs |= 1 << index;
+
+  if (prog->id > 0 &&
+      gsk_shader_builder_finish_program (self->shader_builder, prog->id, error))
+    gsk_gl_renderer_init_program_locations (self, prog);
+  else
+    prog->id = 0;
+}
+
+/* Makes sure @prog is compiled, linked and its locations are known.
+ * Failing to build a program is an error in our shaders, so just make
+ * some noise and draw nothing with it. */
+static void
+gsk_gl_renderer_ensure_program (GskGLRenderer *self,
+                                Program       *prog)
+{
+  const int index = prog->index;
+  GError *error = NULL;
+
+  if (G_LIKELY (self->ready_programs & (1 << index)))
+    return;
+
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), SHADERS,
+                     g_message ("Compiling '%s' program on first use", program_definitions[index].name));
+
+  if ((self->started_programs & (1 << index)) == 0)
+    gsk_gl_renderer_begin_program (self, index, &error);
+
+  if (error == NULL)
+    gsk_gl_renderer_finish_program (self, index, &error);
+
+  if (error != NULL)
+    {
+      g_critical ("Unable to create '%s' program (from %s and %s): %s",
+                  program_definitions[index].name,
+                  program_definitions[index].vs ? program_definitions[index].vs : "blit.vs.glsl",
+                  program_definitions[index].fs,
+                  error->message);
+      g_error_free (error);
+      prog->id = 0;
+      self->ready_programs |= 1 << index;
+    }
+}
+
+/* With GL_KHR_parallel_shader_compile, the driver compiles programs
+ * in its own threads. Start all remaining programs once we are idle and
+ * collect them as they finish, so they are ready before first use
+ * without ever blocking the main loop. */
+static gboolean
+gsk_gl_renderer_warmup_programs (gpointer data)
+{
+  GskGLRenderer *self = data;
+  gboolean all_ready = TRUE;
+  int i;
+
+  gdk_gl_context_make_current (self->gl_context);
+
+  for (i = 0; i < GL_N_PROGRAMS; i ++)
+    {
+      GError *error = NULL;
+
+      if (!gsk_gl_renderer_program_is_available (self, i) ||
+          (self->ready_programs & (1 << i)))
+        continue;
+
+      if ((self->started_programs & (1 << i)) == 0)
+        gsk_gl_renderer_begin_program (self, i, &error);
+
+      if (error == NULL &&
+          self->programs[i].id > 0 &&
+          !gsk_shader_builder_program_is_ready (self->shader_builder, self->programs[i].id))
+        {
+          all_ready = FALSE;
+          continue;
+        }
+
+      /* Errors get reported on first use */
+      g_clear_error (&error);
+      if (self->programs[i].id > 0)
+        gsk_gl_renderer_finish_program (self, i, NULL);
+      else
+        self->started_programs &= ~(1 << i);
+    }
+
+  if (all_ready)
+    {
+      self->warmup_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
 static gboolean
 gsk_gl_renderer_create_programs (GskGLRenderer  *self,
                                  GError        **error)
@@ -2260,23 +3171,6 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
   GskShaderBuilder *builder;
   GError *shader_error = NULL;
   int i;
-  static const struct {
-    const char *name;
-    const char *fs;
-  } program_definitions[] = {
-    { "blit",            "blit.fs.glsl" },
-    { "color",           "color.fs.glsl" },
-    { "coloring",        "coloring.fs.glsl" },
-    { "color matrix",    "color_matrix.fs.glsl" },
-    { "linear gradient", "linear_gradient.fs.glsl" },
-    { "blur",            "blur.fs.glsl" },
-    { "inset shadow",    "inset_shadow.fs.glsl" },
-    { "outset shadow",   "outset_shadow.fs.glsl" },
-    { "unblurred outset shadow",   "unblurred_outset_shadow.fs.glsl" },
-    { "border",          "border.fs.glsl" },
-    { "cross fade",      "cross_fade.fs.glsl" },
-    { "blend",           "blend.fs.glsl" },
-  };
 
   builder = gsk_shader_builder_new ();
 
@@ -2309,8 +3203,17 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
       gsk_shader_builder_set_vertex_preamble (builder, "gl3_common.vs.glsl");
       gsk_shader_builder_set_fragment_preamble (builder, "gl3_common.fs.glsl");
       gsk_shader_builder_add_define (builder, "GSK_GL3", "1");
+
+      /* glDrawArraysInstanced() is core in 3.1, but we need the divisor too */
+      self->use_instanced_text = epoxy_gl_version () >= 33 ||
+                                 epoxy_has_gl_extension ("GL_ARB_instanced_arrays");
     }
 
+#ifdef G_ENABLE_DEBUG
+  if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), NO_INSTANCING))
+    self->use_instanced_text = FALSE;
+#endif
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), SHADERS))
     gsk_shader_builder_add_define (builder, "GSK_DEBUG", "1");
@@ -2321,96 +3224,49 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
 
   g_assert_no_error (shader_error);
 
+  self->shader_builder = builder;
+  self->started_programs = 0;
+  self->ready_programs = 0;
+
   for (i = 0; i < GL_N_PROGRAMS; i ++)
     {
       Program *prog = &self->programs[i];
 
       prog->index = i;
-      prog->id = gsk_shader_builder_create_program (builder,
-                                                    program_definitions[i].fs,
-                                                    &shader_error);
+      prog->id = 0;
 
-      if (shader_error != NULL)
-        {
-          g_propagate_prefixed_error (error, shader_error,
-                                      "Unable to create '%s' program (from %s and %s):\n",
-                                      program_definitions[i].name,
-                                      "blit.vs.glsl",
-                                      program_definitions[i].fs);
-
-          g_object_unref (builder);
-          return FALSE;
-        }
+      /* Never used, so consider them done */
+      if (!gsk_gl_renderer_program_is_available (self, i))
+        self->ready_programs |= 1 << i;
+    }
+
+  /* The blit program is used by pretty much every frame, and building
+   * it right away tells us early if our shaders work at all. */
+  gsk_gl_renderer_begin_program (self, 0, &shader_error);
+  if (shader_error == NULL)
+    gsk_gl_renderer_finish_program (self, 0, &shader_error);
+
+  if (shader_error != NULL)
+    {
+      g_propagate_prefixed_error (error, shader_error,
+                                  "Unable to create '%s' program (from %s and %s):\n",
+                                  program_definitions[0].name,
+                                  "blit.vs.glsl",
+                                  program_definitions[0].fs);
+
+      g_clear_object (&self->shader_builder);
+      return FALSE;
+    }
+
+  if (epoxy_has_gl_extension ("GL_KHR_parallel_shader_compile"))
+    {
+      glMaxShaderCompilerThreadsKHR (0xffffffff);
+      self->warmup_id = g_idle_add_full (G_PRIORITY_LOW,
+                                         gsk_gl_renderer_warmup_programs,
+                                         self, NULL);
+      g_source_set_name_by_id (self->warmup_id, "[gtk] gsk_gl_renderer_warmup_programs");
+    }
 
-      INIT_COMMON_UNIFORM_LOCATION (prog, alpha);
-      INIT_COMMON_UNIFORM_LOCATION (prog, source);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_widths);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_heights);
-      INIT_COMMON_UNIFORM_LOCATION (prog, viewport);
-      INIT_COMMON_UNIFORM_LOCATION (prog, projection);
-      INIT_COMMON_UNIFORM_LOCATION (prog, modelview);
-    }
-
-  /* color */
-  INIT_PROGRAM_UNIFORM_LOCATION (color, color);
-
-  /* coloring */
-  INIT_PROGRAM_UNIFORM_LOCATION (coloring, color);
-
-  /* color matrix */
-  INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
-  INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
-
-  /* linear gradient */
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_offsets);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, num_color_stops);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, start_point);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, end_point);
-
-  /* blur */
-  INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_radius);
-  INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_size);
-  /*INIT_PROGRAM_UNIFORM_LOCATION (blur, dir);*/
-
-  /* inset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, spread);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, offset);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_heights);
-
-  /* outset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_heights);
-
-  /* unblurred outset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, spread);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, offset);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_heights);
-
-  /* border */
-  INIT_PROGRAM_UNIFORM_LOCATION (border, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (border, widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (border, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (border, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (border, corner_heights);
-
-  /* cross fade */
-  INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, progress);
-  INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, source2);
-
-  /* blend */
-  INIT_PROGRAM_UNIFORM_LOCATION (blend, source2);
-  INIT_PROGRAM_UNIFORM_LOCATION (blend, mode);
-
-  g_object_unref (builder);
   return TRUE;
 }
 
@@ -2446,6 +3302,7 @@ gsk_gl_renderer_realize (GskRenderer  *renderer,
 
   gsk_gl_glyph_cache_init (&self->glyph_cache, renderer, self->gl_driver);
   gsk_gl_shadow_cache_init (&self->shadow_cache);
+  gsk_gl_scroll_cache_init (&self->scroll_cache);
 
   return TRUE;
 }
@@ -2465,12 +3322,28 @@ gsk_gl_renderer_unrealize (GskRenderer *renderer)
    * as they will be dropped when we finalize the GskGLDriver
    */
   g_array_set_size (self->render_ops, 0);
+  g_array_set_size (self->vertices, 0);
+  g_array_set_size (self->glyph_instances, 0);
+
+  if (self->warmup_id != 0)
+    {
+      g_source_remove (self->warmup_id);
+      self->warmup_id = 0;
+    }
 
   for (i = 0; i < GL_N_PROGRAMS; i ++)
-    glDeleteProgram (self->programs[i].id);
+    {
+      if (self->programs[i].id > 0)
+        glDeleteProgram (self->programs[i].id);
+      self->programs[i].id = 0;
+    }
+  self->started_programs = 0;
+  self->ready_programs = 0;
+  g_clear_object (&self->shader_builder);
 
   gsk_gl_glyph_cache_free (&self->glyph_cache);
   gsk_gl_shadow_cache_free (&self->shadow_cache, self->gl_driver);
+  gsk_gl_scroll_cache_free (&self->scroll_cache, self->gl_driver);
 
   g_clear_object (&self->gl_profiler);
   g_clear_object (&self->gl_driver);
@@ -2481,6 +3354,28 @@ gsk_gl_renderer_unrealize (GskRenderer *renderer)
   g_clear_object (&self->gl_context);
 }
 
+static void
+gsk_gl_renderer_trim_caches (GskRenderer *renderer)
+{
+  GskGLRenderer *self = GSK_GL_RENDERER (renderer);
+  int removed_textures;
+
+  if (self->gl_context == NULL)
+    return;
+
+  gdk_gl_context_make_current (self->gl_context);
+
+  gsk_gl_glyph_cache_trim (&self->glyph_cache);
+  gsk_gl_shadow_cache_free (&self->shadow_cache, self->gl_driver);
+  gsk_gl_shadow_cache_init (&self->shadow_cache);
+  gsk_gl_scroll_cache_free (&self->scroll_cache, self->gl_driver);
+  gsk_gl_scroll_cache_init (&self->scroll_cache);
+
+  removed_textures = gsk_gl_driver_collect_textures (self->gl_driver);
+
+  GSK_RENDERER_NOTE (renderer, OPENGL, g_message ("Trimmed caches, collected %d textures", removed_textures));
+}
+
 static void
 gsk_gl_renderer_clear_tree (GskGLRenderer *self)
 {
@@ -2492,6 +3387,8 @@ gsk_gl_renderer_clear_tree (GskGLRenderer *self)
   gdk_gl_context_make_current (self->gl_context);
 
   g_array_remove_range (self->render_ops, 0, self->render_ops->len);
+  g_array_set_size (self->vertices, 0);
+  g_array_set_size (self->glyph_instances, 0);
   removed_textures = gsk_gl_driver_collect_textures (self->gl_driver);
 
   GSK_RENDERER_NOTE (GSK_RENDERER (self), OPENGL, g_message ("Collected: %d textures", removed_textures));
@@ -2532,6 +3429,76 @@ gsk_gl_renderer_setup_render_mode (GskGLRenderer *self)
 }
 
 
+/* Returns the index of the last child of @node that hides all the
+ * children before it inside the current clip, like a full-window
+ * video covering the window background, so those don't get drawn.
+ */
+static guint
+container_node_get_first_visible_child (RenderOpBuilder *builder,
+                                        GskRenderNode   *node)
+{
+  graphene_rect_t opaque, transformed_opaque;
+  guint i;
+
+  /* With opacity, the children below shine through, and other
+   * transforms don't map rectangles to rectangles. */
+  if (builder->current_opacity < 1.0f ||
+      ops_get_modelview_category (builder) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    return 0;
+
+  for (i = gsk_container_node_get_n_children (node); i-- > 1; )
+    {
+      if (!gsk_render_node_get_opaque_rect (gsk_container_node_get_child (node, i), &opaque))
+        continue;
+
+      ops_transform_bounds_modelview (builder, &opaque, &transformed_opaque);
+      if (graphene_rect_contains_rect (&transformed_opaque, &builder->current_clip->bounds))
+        return i;
+    }
+
+  return 0;
+}
+
+static inline void
+render_container_node (GskGLRenderer   *self,
+                       GskRenderNode   *node,
+                       RenderOpBuilder *builder)
+{
+  const guint n_children = gsk_container_node_get_n_children (node);
+  const guint first = container_node_get_first_visible_child (builder, node);
+  guint8 *hidden = NULL;
+  guint n_hidden = 0;
+  guint i;
+
+  /* With opacity, the children below shine through */
+  if (builder->current_opacity >= 1.0f && n_children - first > 1)
+    {
+      if (n_children - first <= 512)
+        hidden = g_alloca (n_children - first);
+      else
+        hidden = g_malloc (n_children - first);
+
+      n_hidden = gsk_container_node_get_hidden_children (node, first, hidden);
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_add (gsk_renderer_get_profiler (GSK_RENDERER (self)),
+                            self->profile_counters.culled_nodes,
+                            first + n_hidden);
+#endif
+
+  for (i = first; i < n_children; i ++)
+    {
+      if (n_hidden > 0 && hidden[i - first])
+        continue;
+
+      gsk_gl_renderer_add_render_ops (self, gsk_container_node_get_child (node, i), builder);
+    }
+
+  if (n_children - first > 512)
+    g_free (hidden);
+}
+
 static void
 gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
                                 GskRenderNode   *node,
@@ -2572,30 +3539,57 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
       return;
   }
 
+#ifdef G_ENABLE_DEBUG
+  if (self->sample_nodes)
+    node_sample_add (&self->node_sample, node);
+#endif
+
+  /* Nodes that put pixels on the screen themselves, for the overdraw
+   * debug regions */
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_COLOR_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_CAIRO_NODE:
+      add_debug_region (self, builder, GSK_DEBUG_REGION_DRAW, &node->bounds);
+      break;
+
+    default:
+      break;
+    }
+
   switch (gsk_render_node_get_node_type (node))
     {
     case GSK_NOT_A_RENDER_NODE:
       g_assert_not_reached ();
 
     case GSK_CONTAINER_NODE:
-      {
-        guint i, p;
-
-        for (i = 0, p = gsk_container_node_get_n_children (node); i < p; i ++)
-          {
-            GskRenderNode *child = gsk_container_node_get_child (node, i);
-
-            gsk_gl_renderer_add_render_ops (self, child, builder);
-          }
-      }
+      render_container_node (self, node, builder);
     break;
 
     case GSK_DEBUG_NODE:
-      ops_push_debug_group (builder, gsk_debug_node_get_message (node));
-      gsk_gl_renderer_add_render_ops (self,
-                                      gsk_debug_node_get_child (node),
-                                      builder);
-      ops_pop_debug_group (builder);
+      {
+        const gboolean ignore = strcmp (gsk_debug_node_get_message (node),
+                                        GSK_DEBUG_REGIONS_IGNORE) == 0;
+
+        if (ignore)
+          self->debug_regions_ignored++;
+        ops_push_debug_group (builder, gsk_debug_node_get_message (node));
+        gsk_gl_renderer_add_render_ops (self,
+                                        gsk_debug_node_get_child (node),
+                                        builder);
+        ops_pop_debug_group (builder);
+        if (ignore)
+          self->debug_regions_ignored--;
+      }
     break;
 
     case GSK_COLOR_NODE:
@@ -2615,9 +3609,18 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
     break;
 
     case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
       render_linear_gradient_node (self, node, builder, vertex_data);
     break;
 
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      if (gsk_radial_gradient_node_get_n_color_stops (node) <= 8)
+        render_radial_gradient_node (self, node, builder, vertex_data);
+      else
+        render_fallback_node (self, node, builder, vertex_data);
+    break;
+
     case GSK_CLIP_NODE:
       render_clip_node (self, node, builder);
     break;
@@ -2666,8 +3669,10 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
       render_blend_node (self, node, builder);
     break;
 
-    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
     case GSK_REPEAT_NODE:
+      render_repeat_node (self, node, builder);
+    break;
+
     case GSK_CAIRO_NODE:
     default:
       {
@@ -2698,6 +3703,8 @@ add_offscreen_ops (GskGLRenderer         *self,
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
   float prev_opacity;
+  gboolean prev_async_uploads;
+  GskTextureKey key;
   int texture_id = 0;
 
   /* We need the child node as a texture. If it already is one, we don't need to draw
@@ -2708,7 +3715,7 @@ add_offscreen_ops (GskGLRenderer         *self,
       GdkTexture *texture = gsk_texture_node_get_texture (child_node);
       int gl_min_filter = GL_NEAREST, gl_mag_filter = GL_NEAREST;
 
-      get_gl_scaling_filters (child_node, &gl_min_filter, &gl_mag_filter);
+      get_gl_scaling_filters (child_node, builder, &gl_min_filter, &gl_mag_filter);
 
       *texture_id_out = gsk_gl_driver_get_texture_for_texture (self->gl_driver,
                                                                texture,
@@ -2718,9 +3725,16 @@ add_offscreen_ops (GskGLRenderer         *self,
       return;
     }
 
-  /* Check if we've already cached the drawn texture. */
+  add_debug_region (self, builder, GSK_DEBUG_REGION_OFFSCREEN, bounds);
+
+  /* Check if we've already cached the drawn texture. Unless they get reset,
+   * the current clip and opacity end up in the offscreen pixels, so they are
+   * part of the key. */
+  init_texture_key (&key, builder, child_node, bounds,
+                    (flags & RESET_CLIP) == 0,
+                    (flags & RESET_OPACITY) == 0);
   {
-    const int cached_id = gsk_gl_driver_get_texture_for_pointer (self->gl_driver, child_node);
+    const int cached_id = gsk_gl_driver_get_texture_for_key (self->gl_driver, &key);
 
     if (cached_id != 0)
       {
@@ -2772,7 +3786,11 @@ add_offscreen_ops (GskGLRenderer         *self,
   if (flags & RESET_OPACITY)
     prev_opacity = ops_set_opacity (builder, 1.0);
 
+  /* Offscreens get cached, so they must not contain placeholders */
+  prev_async_uploads = self->async_uploads;
+  self->async_uploads = FALSE;
   gsk_gl_renderer_add_render_ops (self, child_node, builder);
+  self->async_uploads = prev_async_uploads;
 
 #ifdef G_ENABLE_DEBUG
   if (G_UNLIKELY (flags & DUMP_FRAMEBUFFER))
@@ -2803,64 +3821,43 @@ add_offscreen_ops (GskGLRenderer         *self,
   *is_offscreen = TRUE;
   *texture_id_out = texture_id;
 
-  gsk_gl_driver_set_texture_for_pointer (self->gl_driver, child_node, texture_id);
+  gsk_gl_driver_set_texture_for_key (self->gl_driver, &key, texture_id);
 }
 
 static void
 gsk_gl_renderer_render_ops (GskGLRenderer *self,
-                            gsize          vertex_data_size)
+                            GLuint         fbo_id)
 {
   guint i;
   guint n_ops = self->render_ops->len;
   const Program *program = NULL;
-  gsize buffer_index = 0;
-  float *vertex_data = g_malloc (vertex_data_size);
-
-  /*g_message ("%s: Buffer size: %ld", __FUNCTION__, vertex_data_size);*/
-
-
-  GLuint buffer_id, vao_id;
-  glGenVertexArrays (1, &vao_id);
-  glBindVertexArray (vao_id);
-
-  glGenBuffers (1, &buffer_id);
-  glBindBuffer (GL_ARRAY_BUFFER, buffer_id);
+#ifdef G_ENABLE_DEBUG
+  gboolean offscreen = FALSE;
+#endif
+  GLuint vao_id;
+  GLuint instance_buffer_id = 0, instance_vao_id = 0;
 
+  vao_id = gsk_gl_driver_upload_vertices (self->gl_driver,
+                                          (const GskQuadVertex *) self->vertices->data,
+                                          self->vertices->len);
 
-  // Fill buffer data
-  for (i = 0; i < n_ops; i ++)
+  /* Per-glyph data for instanced text drawing */
+  if (self->glyph_instances->len > 0)
     {
-      const RenderOp *op = &g_array_index (self->render_ops, RenderOp, i);
-
-      if (op->op == OP_CHANGE_VAO)
-        {
-          memcpy (vertex_data + buffer_index, &op->vertex_data, sizeof (GskQuadVertex) * GL_N_VERTICES);
-          buffer_index += sizeof (GskQuadVertex) * GL_N_VERTICES / sizeof (float);
-        }
+      glGenVertexArrays (1, &instance_vao_id);
+      glGenBuffers (1, &instance_buffer_id);
+      glBindBuffer (GL_ARRAY_BUFFER, instance_buffer_id);
+      glBufferData (GL_ARRAY_BUFFER,
+                    self->glyph_instances->len * sizeof (GlyphInstance),
+                    self->glyph_instances->data,
+                    GL_STREAM_DRAW);
     }
 
-  // Set buffer data
-  glBufferData (GL_ARRAY_BUFFER, vertex_data_size, vertex_data, GL_STATIC_DRAW);
-
-  // Describe buffer contents
-
-  /* 0 = position location */
-  glEnableVertexAttribArray (0);
-  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
-  /* 1 = texture coord location */
-  glEnableVertexAttribArray (1);
-  glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
-
   for (i = 0; i < n_ops; i ++)
     {
       const RenderOp *op = &g_array_index (self->render_ops, RenderOp, i);
 
-      if (op->op == OP_NONE ||
-          op->op == OP_CHANGE_VAO)
+      if (op->op == OP_NONE)
         continue;
 
       if (op->op != OP_PUSH_DEBUG_GROUP &&
@@ -2884,12 +3881,21 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           break;
 
         case OP_CHANGE_PROGRAM:
+          gsk_gl_renderer_ensure_program (self, &self->programs[op->program->index]);
           apply_program_op (program, op);
           program = op->program;
+#ifdef G_ENABLE_DEBUG
+          gsk_gl_profiler_mark_section (self->gl_profiler, program->index, offscreen);
+#endif
           break;
 
         case OP_CHANGE_RENDER_TARGET:
           apply_render_target_op (self, program, op);
+#ifdef G_ENABLE_DEBUG
+          offscreen = op->render_target_id != fbo_id;
+          if (program != NULL)
+            gsk_gl_profiler_mark_section (self->gl_profiler, program->index, offscreen);
+#endif
           break;
 
         case OP_CLEAR:
@@ -2941,6 +3947,10 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           apply_linear_gradient_op (program, op);
           break;
 
+        case OP_CHANGE_RADIAL_GRADIENT:
+          apply_radial_gradient_op (program, op);
+          break;
+
         case OP_CHANGE_BLUR:
           apply_blur_op (program, op);
           break;
@@ -2971,6 +3981,11 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           glDrawArrays (GL_TRIANGLES, op->draw.vao_offset, op->draw.vao_size);
           break;
 
+        case OP_DRAW_INSTANCED:
+          apply_draw_instanced_op (program, op, instance_vao_id, instance_buffer_id);
+          glBindVertexArray (vao_id);
+          break;
+
         case OP_DUMP_FRAMEBUFFER:
           dump_framebuffer (op->dump.filename, op->dump.width, op->dump.height);
           break;
@@ -2990,11 +4005,13 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
       OP_PRINT ("\n");
     }
 
-  /* Done drawing, destroy the buffer again.
-   * TODO: Can we reuse the memory, though? */
-  g_free (vertex_data);
-  glDeleteVertexArrays (1, &vao_id);
-  glDeleteBuffers (1, &buffer_id);
+  glBindVertexArray (0);
+
+  if (instance_vao_id != 0)
+    {
+      glDeleteVertexArrays (1, &instance_vao_id);
+      glDeleteBuffers (1, &instance_buffer_id);
+    }
 }
 
 static void
@@ -3006,14 +4023,17 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
 {
   GskGLRenderer *self = GSK_GL_RENDERER (renderer);
   graphene_matrix_t modelview, projection;
-  gsize buffer_size;
+  guint n_draws_before, n_draws_after;
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 gpu_time, cpu_time, start_time;
+  guint i;
 #endif
 
 #ifdef G_ENABLE_DEBUG
   profiler = gsk_renderer_get_profiler (renderer);
+  self->sample_nodes = gdk_profiler_is_running ();
+  node_sample_reset (&self->node_sample);
 #endif
 
   if (self->gl_context == NULL)
@@ -3037,6 +4057,7 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
 
   gsk_gl_glyph_cache_begin_frame (&self->glyph_cache);
   gsk_gl_shadow_cache_begin_frame (&self->shadow_cache, self->gl_driver);
+  gsk_gl_scroll_cache_begin_frame (&self->scroll_cache, self->gl_driver);
 
   ops_set_projection (&self->op_builder, &projection);
   ops_set_viewport (&self->op_builder, viewport);
@@ -3079,13 +4100,19 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   gsk_gl_renderer_add_render_ops (self, root, &self->op_builder);
   gdk_gl_context_pop_debug_group (self->gl_context);
 
+  /* Upload all glyphs that were missing from the cache in one go */
+  gsk_gl_glyph_cache_upload (&self->glyph_cache);
+
   /* We correctly reset the state everywhere */
   g_assert_cmpint (self->op_builder.current_render_target, ==, fbo_id);
   ops_pop_modelview (&self->op_builder);
   ops_pop_clip (&self->op_builder);
-  buffer_size = self->op_builder.buffer_size;
   ops_finish (&self->op_builder);
 
+  ops_batch_draws (&self->op_builder, &n_draws_before, &n_draws_after);
+  GSK_RENDERER_NOTE (renderer, OPENGL,
+                     g_message ("Batching: %u draws -> %u draws", n_draws_before, n_draws_after));
+
   /*g_message ("Ops: %u", self->render_ops->len);*/
 
   /* Now actually draw things... */
@@ -3111,11 +4138,13 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   glBlendEquation (GL_FUNC_ADD);
 
   gdk_gl_context_push_debug_group (self->gl_context, "Rendering ops");
-  gsk_gl_renderer_render_ops (self, buffer_size);
+  gsk_gl_renderer_render_ops (self, fbo_id);
   gdk_gl_context_pop_debug_group (self->gl_context);
 
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (profiler, self->profile_counters.frames);
+  gsk_profiler_counter_add (profiler, self->profile_counters.draw_calls, n_draws_after);
+  gsk_profiler_counter_add (profiler, self->profile_counters.unbatched_draw_calls, n_draws_before);
 
   start_time = gsk_profiler_timer_get_start (profiler, self->profile_timers.cpu_time);
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -3124,11 +4153,42 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   gpu_time = gsk_gl_profiler_end_gpu_region (self->gl_profiler);
   gsk_profiler_timer_set (profiler, self->profile_timers.gpu_time, gpu_time);
 
+  /* These lag a few frames behind gpu-time, see gsk_gl_profiler_mark_section() */
+  for (i = 0; i < GL_N_PROGRAMS; i++)
+    gsk_profiler_timer_set (profiler, self->profile_timers.gpu_program_time[i],
+                            gsk_gl_profiler_get_section_time (self->gl_profiler, i));
+  gsk_profiler_timer_set (profiler, self->profile_timers.gpu_offscreen_time,
+                          gsk_gl_profiler_get_offscreen_time (self->gl_profiler));
+
   gsk_profiler_push_samples (profiler);
 
   if (gdk_profiler_is_running ())
-    gdk_profiler_add_mark (start_time, cpu_time, "render", "");
+    {
+      char *nodes;
+      guint n_uploads;
+      gsize n_upload_bytes;
+
+      gsk_gl_driver_get_upload_stats (self->gl_driver, &n_uploads, &n_upload_bytes);
+      nodes = node_sample_to_string (&self->node_sample);
+
+      gdk_profiler_add_mark (start_time, cpu_time, "render", nodes);
+      gdk_profiler_set_int_counter (render_nodes_counter,
+                                    start_time + cpu_time,
+                                    self->node_sample.count);
+      gdk_profiler_set_int_counter (glyph_misses_counter,
+                                    start_time + cpu_time,
+                                    self->glyph_cache.n_misses);
+      gdk_profiler_set_int_counter (texture_uploads_counter,
+                                    start_time + cpu_time,
+                                    n_uploads);
+      gdk_profiler_set_int_counter (texture_upload_bytes_counter,
+                                    start_time + cpu_time,
+                                    n_upload_bytes);
+
+      g_free (nodes);
+    }
 
+  self->sample_nodes = FALSE;
 #endif
 }
 
@@ -3208,11 +4268,13 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   gdk_gl_context_push_debug_group_printf (self->gl_context,
                                           "Render root node %p", root);
 
+  /* The frame region is in surface coordinates, the scale factor only
+   * gets applied when setting up the scissor rectangle. */
   surface = gsk_renderer_get_surface (renderer);
   whole_surface = (GdkRectangle) {
                       0, 0,
-                      gdk_surface_get_width (surface) * self->scale_factor,
-                      gdk_surface_get_height (surface) * self->scale_factor
+                      gdk_surface_get_width (surface),
+                      gdk_surface_get_height (surface)
                   };
 
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->gl_context),
@@ -3234,6 +4296,11 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
         self->render_region = NULL;
       else
         self->render_region = cairo_region_create_rectangle (&extents);
+
+      GSK_RENDERER_NOTE (renderer, OPENGL,
+                         g_message ("Partial redraw: %d %d %d %d of %d %d",
+                                    extents.x, extents.y, extents.width, extents.height,
+                                    whole_surface.width, whole_surface.height));
     }
 
   self->scale_factor = gdk_surface_get_scale_factor (surface);
@@ -3244,10 +4311,15 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   viewport.size.width = gdk_surface_get_width (surface) * self->scale_factor;
   viewport.size.height = gdk_surface_get_height (surface) * self->scale_factor;
 
+  self->async_uploads = TRUE;
+  self->pending_uploads = FALSE;
+
   gsk_gl_driver_begin_frame (self->gl_driver);
   gsk_gl_renderer_do_render (renderer, root, &viewport, 0, self->scale_factor);
   gsk_gl_driver_end_frame (self->gl_driver);
 
+  self->async_uploads = FALSE;
+
   gdk_gl_context_make_current (self->gl_context);
   gsk_gl_renderer_clear_tree (self);
 
@@ -3256,6 +4328,10 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   gdk_gl_context_pop_debug_group (self->gl_context);
 
   g_clear_pointer (&self->render_region, cairo_region_destroy);
+
+  /* Draw again once the textures we left out are uploaded */
+  if (self->pending_uploads)
+    gdk_surface_invalidate_rect (surface, NULL);
 }
 
 static void
@@ -3268,6 +4344,7 @@ gsk_gl_renderer_class_init (GskGLRendererClass *klass)
 
   renderer_class->realize = gsk_gl_renderer_realize;
   renderer_class->unrealize = gsk_gl_renderer_unrealize;
+  renderer_class->trim_caches = gsk_gl_renderer_trim_caches;
   renderer_class->render = gsk_gl_renderer_render;
   renderer_class->render_texture = gsk_gl_renderer_render_texture;
 }
@@ -3278,20 +4355,56 @@ gsk_gl_renderer_init (GskGLRenderer *self)
   gsk_ensure_resources ();
 
   self->render_ops = g_array_new (FALSE, FALSE, sizeof (RenderOp));
+  self->vertices = g_array_new (FALSE, FALSE, sizeof (GskQuadVertex));
+  self->glyph_instances = g_array_new (FALSE, FALSE, sizeof (GlyphInstance));
 
   ops_init (&self->op_builder);
   self->op_builder.renderer = self;
   self->op_builder.render_ops = self->render_ops;
+  self->op_builder.vertices = self->vertices;
+  self->op_builder.glyph_instances = self->glyph_instances;
+
+  self->use_scroll_layers = g_getenv ("GSK_SCROLL_LAYERS") != NULL;
 
 #ifdef G_ENABLE_DEBUG
   {
     GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
+    guint i;
 
     self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
     self->profile_counters.draw_calls = gsk_profiler_add_counter (profiler, "draws", "glDrawArrays", TRUE);
+    self->profile_counters.unbatched_draw_calls = gsk_profiler_add_counter (profiler, "unbatched-draws", "Draws before batching", TRUE);
+    self->profile_counters.transform_offscreens = gsk_profiler_add_counter (profiler, "transform-offscreens", "Transforms drawn via an offscreen", TRUE);
+    self->profile_counters.culled_nodes = gsk_profiler_add_counter (profiler, "culled-nodes", "Nodes hidden by opaque nodes", TRUE);
+    self->profile_counters.scroll_layers = gsk_profiler_add_counter (profiler, "scroll-layers", "Clips drawn from a scroll layer", TRUE);
 
     self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
     self->profile_timers.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU time", FALSE, TRUE);
+    self->profile_timers.gpu_offscreen_time = gsk_profiler_add_timer (profiler, "gpu-offscreen-time", "GPU time in offscreen passes", FALSE, TRUE);
+
+    for (i = 0; i < GL_N_PROGRAMS; i++)
+      {
+        char *name, *description, *p;
+
+        name = g_strconcat ("gpu-", program_definitions[i].name, NULL);
+        for (p = name; *p != '\0'; p++)
+          if (*p == ' ')
+            *p = '-';
+        description = g_strdup_printf ("GPU time in the %s program", program_definitions[i].name);
+
+        self->profile_timers.gpu_program_time[i] = gsk_profiler_add_timer (profiler, name, description, FALSE, TRUE);
+
+        g_free (description);
+        g_free (name);
+      }
+
+    if (render_nodes_counter == 0)
+      {
+        render_nodes_counter = gdk_profiler_define_int_counter ("render-nodes", "Render nodes drawn");
+        glyph_misses_counter = gdk_profiler_define_int_counter ("glyph-cache-misses", "Glyphs not in the cache");
+        texture_uploads_counter = gdk_profiler_define_int_counter ("texture-uploads", "Texture uploads");
+        texture_upload_bytes_counter = gdk_profiler_define_int_counter ("texture-upload-bytes", "Bytes of texture uploads");
+      }
   }
 #endif
 }
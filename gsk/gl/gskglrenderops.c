@@ -18,7 +18,6 @@ ops_finish (RenderOpBuilder *builder)
     g_array_free (builder->clip_stack, TRUE);
   builder->clip_stack = NULL;
 
-  builder->buffer_size = 0;
   builder->dx = 0;
   builder->dy = 0;
   builder->current_modelview = NULL;
@@ -95,6 +94,19 @@ ops_get_scale (const RenderOpBuilder *builder)
               head->metadata.scale_y);
 }
 
+GskTransformCategory
+ops_get_modelview_category (const RenderOpBuilder *builder)
+{
+  const MatrixStackEntry *head;
+
+  g_assert (builder->mv_stack != NULL);
+  g_assert (builder->mv_stack->len >= 1);
+
+  head = &g_array_index (builder->mv_stack, MatrixStackEntry, builder->mv_stack->len - 1);
+
+  return head->metadata.category;
+}
+
 static void
 extract_matrix_metadata (const graphene_matrix_t *m,
                          OpsMatrixMetadata       *md)
@@ -752,41 +764,48 @@ ops_draw (RenderOpBuilder     *builder,
    * And the offsets into the vao are in order as well, so make it one draw call. */
   if (last_op->op == OP_DRAW)
     {
-      /* We allow ourselves a little trick here. We still have to add a CHANGE_VAO op for
-       * this draw call so we can add our vertex data there, but we want it to be placed before
-       * the last draw call, so we reorder those. */
-      RenderOp new_draw;
-      new_draw.op = OP_DRAW;
-      new_draw.draw.vao_offset = last_op->draw.vao_offset;
-      new_draw.draw.vao_size = last_op->draw.vao_size + GL_N_VERTICES;
-
-      last_op->op = OP_CHANGE_VAO;
-      memcpy (&last_op->vertex_data, vertex_data, sizeof(GskQuadVertex) * GL_N_VERTICES);
-
-      /* Now add the DRAW */
-      g_array_append_val (builder->render_ops, new_draw);
+      last_op->draw.vao_size += GL_N_VERTICES;
     }
   else
     {
-      const gsize n_ops = builder->render_ops->len;
-      RenderOp *op;
-      gsize offset = builder->buffer_size / sizeof (GskQuadVertex);
+      RenderOp op;
+
+      op.op = OP_DRAW;
+      op.draw.vao_offset = builder->vertices->len;
+      op.draw.vao_size = GL_N_VERTICES;
+      g_array_append_val (builder->render_ops, op);
+    }
+
+  /* The vertices go straight into the array that gets uploaded, which keeps
+   * its allocation from frame to frame */
+  g_array_append_vals (builder->vertices, vertex_data, GL_N_VERTICES);
+}
 
-      /* We will add two render ops here. */
-      g_array_set_size (builder->render_ops, n_ops + 2);
+/* Like ops_draw(), but for the instanced text programs. Consecutive
+ * glyphs with the same state end up in one instanced draw call. */
+void
+ops_draw_glyph (RenderOpBuilder     *builder,
+                const GlyphInstance *instance)
+{
+  RenderOp *last_op;
 
-      op = &g_array_index (builder->render_ops, RenderOp, n_ops);
-      op->op = OP_CHANGE_VAO;
-      memcpy (&op->vertex_data, vertex_data, sizeof(GskQuadVertex) * GL_N_VERTICES);
+  last_op = &g_array_index (builder->render_ops, RenderOp, builder->render_ops->len - 1);
+
+  if (last_op->op == OP_DRAW_INSTANCED)
+    {
+      last_op->draw_instanced.n_instances ++;
+    }
+  else
+    {
+      RenderOp op;
 
-      op = &g_array_index (builder->render_ops, RenderOp, n_ops + 1);
-      op->op = OP_DRAW;
-      op->draw.vao_offset = offset;
-      op->draw.vao_size = GL_N_VERTICES;
+      op.op = OP_DRAW_INSTANCED;
+      op.draw_instanced.instance_offset = builder->glyph_instances->len;
+      op.draw_instanced.n_instances = 1;
+      g_array_append_val (builder->render_ops, op);
     }
 
-  /* We added new vertex data in both cases so increase the buffer size */
-  builder->buffer_size += sizeof (GskQuadVertex) * GL_N_VERTICES;
+  g_array_append_vals (builder->glyph_instances, instance, 1);
 }
 
 /* The offset is only valid for the current modelview.
@@ -807,3 +826,502 @@ ops_add (RenderOpBuilder *builder,
 {
   g_array_append_val (builder->render_ops, *op);
 }
+
+/* Batching of draw calls.
+ *
+ * The render ops are built in tree order, so interleaved nodes of different
+ * types cause lots of program and texture changes. The pass below looks at
+ * runs of ops that only change the program, the source texture or the color
+ * and draw, and moves draws back to an earlier draw with the same state,
+ * as long as they don't overlap anything drawn in between. Draws with the
+ * same state are then merged into a single draw call.
+ *
+ * Everything else (clip, modelview, render target changes, ...) ends a run,
+ * so the uniforms of all programs are constant within a run. */
+
+#define MAX_BATCH_LOOKBACK 32
+
+typedef struct
+{
+  guint op;
+  const Program *program;
+  int texture_id;
+  gboolean has_color;
+  GdkRGBA color;
+} DrawState;
+
+typedef struct
+{
+  guint op_index;
+  graphene_rect_t bounds;
+  int next; /* Next draw in the same batch */
+} DrawInfo;
+
+typedef struct
+{
+  DrawState state;
+  graphene_rect_t bounds;
+  int first;
+  int last;
+  gsize size;
+} Batch;
+
+typedef struct
+{
+  const Program *program;
+  int texture_id;
+  gboolean has_color[GL_N_PROGRAMS];
+  GdkRGBA color[GL_N_PROGRAMS];
+} OpsState;
+
+static inline gboolean
+is_batchable_op (guint op)
+{
+  return op == OP_NONE ||
+         op == OP_CHANGE_PROGRAM ||
+         op == OP_CHANGE_SOURCE_TEXTURE ||
+         op == OP_CHANGE_COLOR ||
+         op == OP_DRAW ||
+         op == OP_DRAW_INSTANCED;
+}
+
+static inline void
+ops_state_apply (OpsState       *state,
+                 const RenderOp *op)
+{
+  switch (op->op)
+    {
+    case OP_CHANGE_PROGRAM:
+      state->program = op->program;
+      break;
+
+    case OP_CHANGE_SOURCE_TEXTURE:
+      state->texture_id = op->texture_id;
+      break;
+
+    case OP_CHANGE_COLOR:
+      if (state->program != NULL)
+        {
+          state->has_color[state->program->index] = TRUE;
+          state->color[state->program->index] = op->color;
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+static inline gboolean
+draw_state_equal (const DrawState *a,
+                  const DrawState *b)
+{
+  return a->op == b->op &&
+         a->program == b->program &&
+         a->texture_id == b->texture_id &&
+         a->has_color == b->has_color &&
+         (!a->has_color || gdk_rgba_equal (&a->color, &b->color));
+}
+
+static inline gboolean
+rects_overlap (const graphene_rect_t *a,
+               const graphene_rect_t *b)
+{
+  return a->origin.x < b->origin.x + b->size.width &&
+         b->origin.x < a->origin.x + a->size.width &&
+         a->origin.y < b->origin.y + b->size.height &&
+         b->origin.y < a->origin.y + a->size.height;
+}
+
+static void
+get_draw_bounds (RenderOpBuilder *builder,
+                 const RenderOp  *op,
+                 graphene_rect_t *bounds)
+{
+  float min_x = G_MAXFLOAT, min_y = G_MAXFLOAT;
+  float max_x = -G_MAXFLOAT, max_y = -G_MAXFLOAT;
+  gsize i;
+
+  if (op->op == OP_DRAW)
+    {
+      for (i = 0; i < op->draw.vao_size; i ++)
+        {
+          const GskQuadVertex *v = &g_array_index (builder->vertices, GskQuadVertex,
+                                                   op->draw.vao_offset + i);
+
+          min_x = MIN (min_x, v->position[0]);
+          min_y = MIN (min_y, v->position[1]);
+          max_x = MAX (max_x, v->position[0]);
+          max_y = MAX (max_y, v->position[1]);
+        }
+    }
+  else
+    {
+      for (i = 0; i < op->draw_instanced.n_instances; i ++)
+        {
+          const GlyphInstance *g = &g_array_index (builder->glyph_instances, GlyphInstance,
+                                                   op->draw_instanced.instance_offset + i);
+
+          min_x = MIN (min_x, g->rect[0]);
+          min_y = MIN (min_y, g->rect[1]);
+          max_x = MAX (max_x, g->rect[0] + g->rect[2]);
+          max_y = MAX (max_y, g->rect[1] + g->rect[3]);
+        }
+    }
+
+  graphene_rect_init (bounds, min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+static inline gsize
+draw_offset (const RenderOp *op)
+{
+  return op->op == OP_DRAW ? op->draw.vao_offset : op->draw_instanced.instance_offset;
+}
+
+static inline gsize
+draw_size (const RenderOp *op)
+{
+  return op->op == OP_DRAW ? op->draw.vao_size : op->draw_instanced.n_instances;
+}
+
+/* Emits one draw op for all draws in @batch. If their data is not
+ * contiguous already, it is copied to the end of the vertex or
+ * instance array. */
+static void
+emit_batch_draw (RenderOpBuilder *builder,
+                 const GArray    *ops,
+                 const DrawInfo  *draws,
+                 const Batch     *batch,
+                 GArray          *out)
+{
+  const RenderOp *first = &g_array_index (ops, RenderOp, draws[batch->first].op_index);
+  GArray *data = batch->state.op == OP_DRAW ? builder->vertices : builder->glyph_instances;
+  gsize offset = draw_offset (first);
+  gsize end = offset;
+  gboolean contiguous = TRUE;
+  RenderOp op;
+  int d;
+
+  for (d = batch->first; d != -1; d = draws[d].next)
+    {
+      const RenderOp *draw = &g_array_index (ops, RenderOp, draws[d].op_index);
+
+      if (draw_offset (draw) != end)
+        {
+          contiguous = FALSE;
+          break;
+        }
+      end += draw_size (draw);
+    }
+
+  if (!contiguous)
+    {
+      const guint element_size = g_array_get_element_size (data);
+      gsize dest;
+
+      offset = data->len;
+      g_array_set_size (data, data->len + batch->size);
+
+      dest = offset;
+      for (d = batch->first; d != -1; d = draws[d].next)
+        {
+          const RenderOp *draw = &g_array_index (ops, RenderOp, draws[d].op_index);
+
+          memcpy (data->data + dest * element_size,
+                  data->data + draw_offset (draw) * element_size,
+                  draw_size (draw) * element_size);
+          dest += draw_size (draw);
+        }
+    }
+
+  op.op = batch->state.op;
+  if (op.op == OP_DRAW)
+    {
+      op.draw.vao_offset = offset;
+      op.draw.vao_size = batch->size;
+    }
+  else
+    {
+      op.draw_instanced.instance_offset = offset;
+      op.draw_instanced.n_instances = batch->size;
+    }
+  g_array_append_val (out, op);
+}
+
+static inline void
+emit_program (GArray        *out,
+              OpsState      *state,
+              const Program *program)
+{
+  RenderOp op;
+
+  if (state->program == program)
+    return;
+
+  op.op = OP_CHANGE_PROGRAM;
+  op.program = program;
+  g_array_append_val (out, op);
+  state->program = program;
+}
+
+static inline void
+emit_texture (GArray   *out,
+              OpsState *state,
+              int       texture_id)
+{
+  RenderOp op;
+
+  if (texture_id == 0 || state->texture_id == texture_id)
+    return;
+
+  op.op = OP_CHANGE_SOURCE_TEXTURE;
+  op.texture_id = texture_id;
+  g_array_append_val (out, op);
+  state->texture_id = texture_id;
+}
+
+static inline void
+emit_color (GArray        *out,
+            OpsState      *state,
+            const GdkRGBA *color)
+{
+  const int index = state->program->index;
+  RenderOp op;
+
+  if (state->has_color[index] && gdk_rgba_equal (&state->color[index], color))
+    return;
+
+  op.op = OP_CHANGE_COLOR;
+  op.color = *color;
+  g_array_append_val (out, op);
+  state->has_color[index] = TRUE;
+  state->color[index] = *color;
+}
+
+/* Reorders the @n_draws draws in [start, end), which must all be batchable.
+ * @state is the state at @start and gets updated to the state at @end.
+ * Returns the number of draws after batching. */
+static guint
+batch_run (RenderOpBuilder *builder,
+           guint            start,
+           guint            end,
+           guint            n_draws,
+           OpsState        *state,
+           GArray          *draws_array,
+           GArray          *batches_array,
+           GArray          *out)
+{
+  GArray *ops = builder->render_ops;
+  OpsState current = *state;
+  OpsState emitted = *state;
+  DrawInfo *draws;
+  Batch *batches;
+  guint n_batches;
+  guint i;
+  int b;
+
+  /* Whatever we do, the state after the run stays the same */
+  for (i = start; i < end; i ++)
+    ops_state_apply (state, &g_array_index (ops, RenderOp, i));
+
+  g_array_set_size (draws_array, 0);
+  g_array_set_size (batches_array, 0);
+
+  /* Put every draw into the latest batch with the same state that it
+   * can be moved back to without changing the result */
+  for (i = start; i < end; i ++)
+    {
+      const RenderOp *op = &g_array_index (ops, RenderOp, i);
+      DrawState draw_state;
+      DrawInfo info;
+      Batch *target = NULL;
+      int index;
+
+      if (op->op != OP_DRAW && op->op != OP_DRAW_INSTANCED)
+        {
+          ops_state_apply (&current, op);
+          continue;
+        }
+
+      if (current.program == NULL)
+        return n_draws;
+
+      draw_state.op = op->op;
+      draw_state.program = current.program;
+      draw_state.texture_id = current.texture_id;
+      draw_state.has_color = current.has_color[current.program->index];
+      draw_state.color = current.color[current.program->index];
+
+      info.op_index = i;
+      info.next = -1;
+      get_draw_bounds (builder, op, &info.bounds);
+      index = draws_array->len;
+      g_array_append_val (draws_array, info);
+
+      for (b = (int) batches_array->len - 1;
+           b >= 0 && b >= (int) batches_array->len - MAX_BATCH_LOOKBACK;
+           b --)
+        {
+          Batch *batch = &g_array_index (batches_array, Batch, b);
+
+          if (draw_state_equal (&batch->state, &draw_state))
+            {
+              target = batch;
+              break;
+            }
+
+          /* Can't move the draw before something it overlaps */
+          if (rects_overlap (&batch->bounds, &info.bounds))
+            break;
+        }
+
+      if (target != NULL)
+        {
+          Batch *batch = target;
+
+          g_array_index (draws_array, DrawInfo, batch->last).next = index;
+          batch->last = index;
+          batch->size += draw_size (op);
+          graphene_rect_union (&batch->bounds, &info.bounds, &batch->bounds);
+        }
+      else
+        {
+          Batch batch;
+
+          batch.state = draw_state;
+          batch.bounds = info.bounds;
+          batch.first = index;
+          batch.last = index;
+          batch.size = draw_size (op);
+          g_array_append_val (batches_array, batch);
+        }
+    }
+
+  n_batches = batches_array->len;
+
+  /* Nothing to gain */
+  if (n_batches == n_draws)
+    return n_draws;
+
+  draws = (DrawInfo *) draws_array->data;
+  batches = (Batch *) batches_array->data;
+
+  g_array_set_size (out, 0);
+
+  for (b = 0; b < n_batches; b ++)
+    {
+      const Batch *batch = &batches[b];
+
+      emit_program (out, &emitted, batch->state.program);
+      emit_texture (out, &emitted, batch->state.texture_id);
+      if (batch->state.has_color)
+        emit_color (out, &emitted, &batch->state.color);
+
+      emit_batch_draw (builder, ops, draws, batch, out);
+    }
+
+  /* The ops after this run expect the state they had originally */
+  for (i = 0; i < GL_N_PROGRAMS; i ++)
+    {
+      if (state->has_color[i] &&
+          (!emitted.has_color[i] || !gdk_rgba_equal (&emitted.color[i], &state->color[i])))
+        {
+          const Program *program = NULL;
+          guint j;
+
+          /* Find the program, it must have been used in this run */
+          for (j = 0; j < n_batches && program == NULL; j ++)
+            {
+              if (batches[j].state.program->index == i)
+                program = batches[j].state.program;
+            }
+
+          /* Can't restore, leave the run alone */
+          if (program == NULL)
+            return n_draws;
+
+          emit_program (out, &emitted, program);
+          emit_color (out, &emitted, &state->color[i]);
+        }
+    }
+
+  emit_texture (out, &emitted, state->texture_id);
+  if (state->program != NULL)
+    emit_program (out, &emitted, state->program);
+
+  /* Only replace the run if we don't need more ops than before */
+  if (out->len > end - start)
+    return n_draws;
+
+  memcpy (&g_array_index (ops, RenderOp, start), out->data, out->len * sizeof (RenderOp));
+  for (i = start + out->len; i < end; i ++)
+    g_array_index (ops, RenderOp, i).op = OP_NONE;
+
+  return n_batches;
+}
+
+/* Merges and reorders draw ops, see above. Returns the number of draw
+ * calls before and after. */
+void
+ops_batch_draws (RenderOpBuilder *builder,
+                 guint           *n_draws_before,
+                 guint           *n_draws_after)
+{
+  GArray *ops = builder->render_ops;
+  GArray *draws, *batches, *out;
+  OpsState state = { 0, };
+  guint before = 0, after = 0;
+  guint i, start;
+
+  draws = g_array_new (FALSE, FALSE, sizeof (DrawInfo));
+  batches = g_array_new (FALSE, FALSE, sizeof (Batch));
+  out = g_array_new (FALSE, FALSE, sizeof (RenderOp));
+
+  for (i = 0; i < ops->len; )
+    {
+      const RenderOp *op = &g_array_index (ops, RenderOp, i);
+      guint n_run_draws = 0;
+
+      if (!is_batchable_op (op->op))
+        {
+          i ++;
+          continue;
+        }
+
+      start = i;
+      for (; i < ops->len; i ++)
+        {
+          op = &g_array_index (ops, RenderOp, i);
+
+          if (!is_batchable_op (op->op))
+            break;
+
+          if (op->op == OP_DRAW || op->op == OP_DRAW_INSTANCED)
+            n_run_draws ++;
+        }
+
+      before += n_run_draws;
+
+      if (n_run_draws > 1)
+        {
+          after += batch_run (builder, start, i, n_run_draws, &state, draws, batches, out);
+        }
+      else
+        {
+          guint j;
+
+          for (j = start; j < i; j ++)
+            ops_state_apply (&state, &g_array_index (ops, RenderOp, j));
+          after += n_run_draws;
+        }
+    }
+
+  g_array_free (draws, TRUE);
+  g_array_free (batches, TRUE);
+  g_array_free (out, TRUE);
+
+  if (n_draws_before)
+    *n_draws_before = before;
+  if (n_draws_after)
+    *n_draws_after = after;
+}
@@ -11,7 +11,7 @@
 #include "gskrendernodeprivate.h"
 
 #define GL_N_VERTICES 6
-#define GL_N_PROGRAMS 12
+#define GL_N_PROGRAMS 17
 
 
 
@@ -45,7 +45,6 @@ enum {
   OP_CHANGE_CLIP            =  7,
   OP_CHANGE_VIEWPORT        =  8,
   OP_CHANGE_SOURCE_TEXTURE  =  9,
-  OP_CHANGE_VAO             =  10,
   OP_CHANGE_LINEAR_GRADIENT =  11,
   OP_CHANGE_COLOR_MATRIX    =  12,
   OP_CHANGE_BLUR            =  13,
@@ -62,8 +61,17 @@ enum {
   OP_PUSH_DEBUG_GROUP       =  24,
   OP_POP_DEBUG_GROUP        =  25,
   OP_CHANGE_BLEND           =  26,
+  OP_DRAW_INSTANCED         =  27,
+  OP_CHANGE_RADIAL_GRADIENT =  28,
 };
 
+/* Instance data for the text programs, one per glyph */
+typedef struct
+{
+  float rect[4]; /* x, y, width, height */
+  float uv[4];   /* tx, ty, tw, th */
+} GlyphInstance;
+
 typedef struct
 {
   int index;        /* Into the renderer's program array */
@@ -99,7 +107,18 @@ typedef struct
       int color_offsets_location;
       int start_point_location;
       int end_point_location;
+      int repeat_location;
     } linear_gradient;
+    struct {
+      int num_color_stops_location;
+      int color_stops_location;
+      int color_offsets_location;
+      int center_location;
+      int radius_location;
+      int start_location;
+      int end_location;
+      int repeat_location;
+    } radial_gradient;
     struct {
       int blur_radius_location;
       int blur_size_location;
@@ -114,6 +133,7 @@ typedef struct
       int corner_heights_location;
     } inset_shadow;
     struct {
+      int color_location;
       int outline_location;
       int corner_widths_location;
       int corner_heights_location;
@@ -141,6 +161,16 @@ typedef struct
       int source2_location;
       int mode_location;
     } blend;
+    struct {
+      int color_location; /* Must come first, like in color and coloring */
+      int glyph_rect_location;
+      int glyph_uv_location;
+    } text;
+    struct {
+      int color_location; /* Like text */
+      int glyph_rect_location;
+      int glyph_uv_location;
+    } sdf_text;
   };
 
 } Program;
@@ -157,20 +187,34 @@ typedef struct
     int texture_id;
     int render_target_id;
     GdkRGBA color;
-    GskQuadVertex vertex_data[6];
     GskRoundedRect clip;
     graphene_rect_t viewport;
     struct {
       int n_color_stops;
+      gboolean repeat;
       float color_offsets[8];
       float color_stops[4 * 8];
       graphene_point_t start_point;
       graphene_point_t end_point;
     } linear_gradient;
+    struct {
+      int n_color_stops;
+      gboolean repeat;
+      float color_offsets[8];
+      float color_stops[4 * 8];
+      graphene_point_t center;
+      float radius[2];
+      float start;
+      float end;
+    } radial_gradient;
     struct {
       gsize vao_offset;
       gsize vao_size;
     } draw;
+    struct {
+      gsize instance_offset;
+      gsize n_instances;
+    } draw_instanced;
     struct {
       graphene_matrix_t matrix;
       graphene_vec4_t offset;
@@ -229,7 +273,7 @@ typedef struct
       int height;
     } dump;
     struct {
-      char text[180]; /* Size of linear_gradient, so 'should be enough' without growing RenderOp */
+      char text[184]; /* Size of linear_gradient, so 'should be enough' without growing RenderOp */
     } debug_group;
   };
 } RenderOp;
@@ -271,9 +315,9 @@ typedef struct
   float current_opacity;
   float dx, dy;
 
-  gsize buffer_size;
-
   GArray *render_ops;
+  GArray *vertices;
+  GArray *glyph_instances;
   GskGLRenderer *renderer;
 
   /* Stack of modelview matrices */
@@ -305,6 +349,7 @@ void              ops_set_modelview      (RenderOpBuilder         *builder,
                                           GskTransformCategory     mv_category);
 void              ops_pop_modelview      (RenderOpBuilder         *builder);
 float             ops_get_scale          (const RenderOpBuilder   *builder);
+GskTransformCategory ops_get_modelview_category (const RenderOpBuilder *builder);
 
 void              ops_set_program        (RenderOpBuilder         *builder,
                                           const Program           *program);
@@ -350,6 +395,9 @@ void              ops_set_border_color   (RenderOpBuilder         *builder,
 void              ops_draw               (RenderOpBuilder        *builder,
                                           const GskQuadVertex     vertex_data[GL_N_VERTICES]);
 
+void              ops_draw_glyph         (RenderOpBuilder        *builder,
+                                          const GlyphInstance    *instance);
+
 void              ops_offset             (RenderOpBuilder        *builder,
                                           float                   x,
                                           float                   y);
@@ -357,4 +405,8 @@ void              ops_offset             (RenderOpBuilder        *builder,
 void              ops_add                (RenderOpBuilder        *builder,
                                           const RenderOp         *op);
 
+void              ops_batch_draws        (RenderOpBuilder        *builder,
+                                          guint                  *n_draws_before,
+                                          guint                  *n_draws_after);
+
 #endif
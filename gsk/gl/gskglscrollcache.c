@@ -0,0 +1,155 @@
+
+#include "gskglscrollcacheprivate.h"
+
+/* Scroll layers keep what was drawn for a clip node whose child is a
+ * translated node, like the child of a viewport, so that the renderer
+ * only has to draw the part that got scrolled into view when only the
+ * translation changes.
+ *
+ * There are only ever a few of them, so they are kept in a list that
+ * is ordered by last use. Layers that have not been used for
+ * MAX_UNUSED_FRAMES are dropped in begin_frame, since textures used in
+ * the current frame are still referenced by queued render ops.
+ */
+#define MAX_UNUSED_FRAMES (16 * 2)
+
+static void
+scroll_layer_free (GskGLScrollLayer *layer,
+                   GskGLDriver      *gl_driver)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (layer->texture_ids); i++)
+    {
+      if (layer->texture_ids[i] != 0)
+        gsk_gl_driver_destroy_texture (gl_driver, layer->texture_ids[i]);
+    }
+
+  g_clear_pointer (&layer->content, gsk_render_node_unref);
+  g_slice_free (GskGLScrollLayer, layer);
+}
+
+void
+gsk_gl_scroll_cache_init (GskGLScrollCache *self)
+{
+  g_queue_init (&self->lru);
+  self->timestamp = 0;
+}
+
+void
+gsk_gl_scroll_cache_free (GskGLScrollCache *self,
+                          GskGLDriver      *gl_driver)
+{
+  while (self->lru.head != NULL)
+    {
+      GskGLScrollLayer *layer = self->lru.head->data;
+
+      g_queue_unlink (&self->lru, &layer->link);
+      scroll_layer_free (layer, gl_driver);
+    }
+}
+
+void
+gsk_gl_scroll_cache_begin_frame (GskGLScrollCache *self,
+                                 GskGLDriver      *gl_driver)
+{
+  self->timestamp++;
+
+  while (self->lru.tail != NULL)
+    {
+      GskGLScrollLayer *layer = self->lru.tail->data;
+
+      if (self->timestamp - layer->last_used <= MAX_UNUSED_FRAMES)
+        break;
+
+      g_queue_unlink (&self->lru, &layer->link);
+      scroll_layer_free (layer, gl_driver);
+    }
+}
+
+/* Returns the layer at @bounds, creating an empty one if there is none.
+ * Every layer can only be used once per frame, so this returns %NULL
+ * when two clips of the frame end up at the same place. */
+GskGLScrollLayer *
+gsk_gl_scroll_cache_get_layer (GskGLScrollCache      *self,
+                               const graphene_rect_t *bounds,
+                               float                  scale)
+{
+  GskGLScrollLayer *layer = NULL;
+  GList *l;
+
+  g_assert (self != NULL);
+  g_assert (bounds != NULL);
+
+  for (l = self->lru.head; l != NULL; l = l->next)
+    {
+      GskGLScrollLayer *item = l->data;
+
+      if (graphene_rect_equal (&item->bounds, bounds) &&
+          item->scale == scale)
+        {
+          layer = item;
+          break;
+        }
+    }
+
+  if (layer == NULL)
+    {
+      layer = g_slice_new0 (GskGLScrollLayer);
+      layer->bounds = *bounds;
+      layer->scale = scale;
+      layer->link.data = layer;
+    }
+  else if (layer->last_used == self->timestamp)
+    {
+      return NULL;
+    }
+  else
+    {
+      g_queue_unlink (&self->lru, &layer->link);
+    }
+
+  layer->last_used = self->timestamp;
+  g_queue_push_head_link (&self->lru, &layer->link);
+
+  return layer;
+}
+
+/* Remembers what the layer is used for. The textures keep their
+ * contents only when they show the same content. */
+void
+gsk_gl_scroll_layer_set_content (GskGLScrollLayer       *layer,
+                                 GskRenderNode          *content,
+                                 const graphene_point_t *offset)
+{
+  if (layer->content != content)
+    {
+      g_clear_pointer (&layer->content, gsk_render_node_unref);
+      layer->content = gsk_render_node_ref (content);
+      layer->has_contents = FALSE;
+    }
+
+  layer->offset = *offset;
+}
+
+void
+gsk_gl_scroll_layer_ensure_textures (GskGLScrollLayer *layer,
+                                     GskGLDriver      *gl_driver)
+{
+  const int width = layer->bounds.size.width;
+  const int height = layer->bounds.size.height;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (layer->texture_ids); i++)
+    {
+      if (layer->texture_ids[i] != 0)
+        continue;
+
+      layer->texture_ids[i] = gsk_gl_driver_create_permanent_texture (gl_driver, width, height);
+      gsk_gl_driver_bind_source_texture (gl_driver, layer->texture_ids[i]);
+      gsk_gl_driver_init_texture_empty (gl_driver, layer->texture_ids[i]);
+      layer->render_targets[i] = gsk_gl_driver_create_render_target (gl_driver,
+                                                                     layer->texture_ids[i],
+                                                                     TRUE, TRUE);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef __GSK_GL_SCROLL_CACHE_H__
+#define __GSK_GL_SCROLL_CACHE_H__
+
+#include <glib.h>
+#include "gskgldriverprivate.h"
+#include "gskrendernode.h"
+
+typedef struct
+{
+  /* Where the layer is on the render target, in device pixels */
+  graphene_rect_t bounds;
+  float scale;
+
+  /* What the textures show, the content is offset by the translation of
+   * the transform node it is the child of. */
+  GskRenderNode *content;
+  graphene_point_t offset;
+  guint has_contents : 1;
+
+  /* The texture at current holds the contents, the other one is where
+   * the next frame gets drawn when the content has been scrolled. */
+  int texture_ids[2];
+  int render_targets[2];
+  guint current;
+
+  GList link;
+  guint last_used;
+} GskGLScrollLayer;
+
+typedef struct
+{
+  GQueue lru;
+  guint timestamp;
+} GskGLScrollCache;
+
+
+void              gsk_gl_scroll_cache_init            (GskGLScrollCache       *self);
+void              gsk_gl_scroll_cache_free            (GskGLScrollCache       *self,
+                                                       GskGLDriver            *gl_driver);
+void              gsk_gl_scroll_cache_begin_frame     (GskGLScrollCache       *self,
+                                                       GskGLDriver            *gl_driver);
+GskGLScrollLayer *gsk_gl_scroll_cache_get_layer       (GskGLScrollCache       *self,
+                                                       const graphene_rect_t  *bounds,
+                                                       float                   scale);
+void              gsk_gl_scroll_layer_set_content     (GskGLScrollLayer       *layer,
+                                                       GskRenderNode          *content,
+                                                       const graphene_point_t *offset);
+void              gsk_gl_scroll_layer_ensure_textures (GskGLScrollLayer       *layer,
+                                                       GskGLDriver            *gl_driver);
+
+
+#endif
@@ -1,58 +1,116 @@
 
 #include "gskglshadowcacheprivate.h"
 
+#include <string.h>
+
+/* Parameters for our cache eviction strategy.
+ *
+ * Cached shadows only depend on the corner sizes of the shadow (the
+ * renderer shrinks the outline to the minimum size holding all corners
+ * and stretches the sides of the texture as a nine-slice), the blur
+ * radius, and are drawn as a coverage mask that gets tinted when drawing.
+ * Entries that have not been used for MAX_UNUSED_FRAMES are dropped.
+ * In addition, the size of all textures is kept below MAX_CACHE_BYTES
+ * by dropping the least recently used ones. Eviction only happens in
+ * begin_frame, since textures used in the current frame are still
+ * referenced by queued render ops.
+ */
 #define MAX_UNUSED_FRAMES (16 * 5) /* 5 seconds? */
+#define MAX_CACHE_BYTES (16 * 1024 * 1024)
 
 typedef struct
 {
-  GskRoundedRect outline;
+  graphene_size_t corner[4];
+  graphene_size_t size;
   float blur_radius;
 } CacheKey;
 
 typedef struct
 {
-  GskRoundedRect outline;
-  float blur_radius;
+  CacheKey key;
 
+  GList link;
   int texture_id;
-  int unused_frames;
+  gsize n_bytes;
+  guint last_used;
 } CacheItem;
 
+static guint
+key_hash (gconstpointer v)
+{
+  const guint32 *data = v;
+  guint hash = 0;
+  guint i;
+
+  G_STATIC_ASSERT (sizeof (CacheKey) % sizeof (guint32) == 0);
+
+  /* CacheKey consists only of floats, so hash their bits */
+  for (i = 0; i < sizeof (CacheKey) / sizeof (guint32); i++)
+    hash = (hash << 5) - hash + data[i];
+
+  return hash;
+}
+
 static gboolean
-key_equal (const void *x,
-           const void *y)
+key_equal (gconstpointer x,
+           gconstpointer y)
 {
   const CacheKey *a = x;
   const CacheKey *b = y;
 
-  return graphene_size_equal (&a->outline.corner[0], &b->outline.corner[0]) &&
-         graphene_size_equal (&a->outline.corner[1], &b->outline.corner[1]) &&
-         graphene_size_equal (&a->outline.corner[2], &b->outline.corner[2]) &&
-         graphene_size_equal (&a->outline.corner[3], &b->outline.corner[3]) &&
-         graphene_rect_equal (&a->outline.bounds, &b->outline.bounds) &&
+  return graphene_size_equal (&a->corner[0], &b->corner[0]) &&
+         graphene_size_equal (&a->corner[1], &b->corner[1]) &&
+         graphene_size_equal (&a->corner[2], &b->corner[2]) &&
+         graphene_size_equal (&a->corner[3], &b->corner[3]) &&
+         graphene_size_equal (&a->size, &b->size) &&
          a->blur_radius == b->blur_radius;
 }
 
+static void
+key_init (CacheKey             *key,
+          const GskRoundedRect *shadow_rect,
+          float                 blur_radius)
+{
+  /* Zero the struct first, key_hash() looks at all of its bytes */
+  memset (key, 0, sizeof (CacheKey));
+
+  key->corner[0] = shadow_rect->corner[0];
+  key->corner[1] = shadow_rect->corner[1];
+  key->corner[2] = shadow_rect->corner[2];
+  key->corner[3] = shadow_rect->corner[3];
+  key->size = shadow_rect->bounds.size;
+  key->blur_radius = blur_radius;
+}
+
+static void
+cache_item_free (GskGLShadowCache *self,
+                 GskGLDriver      *gl_driver,
+                 CacheItem        *item)
+{
+  g_queue_unlink (&self->lru, &item->link);
+  self->n_bytes -= item->n_bytes;
+
+  gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
+  g_slice_free (CacheItem, item);
+}
+
 void
 gsk_gl_shadow_cache_init (GskGLShadowCache *self)
 {
-  self->textures = g_array_new (FALSE, TRUE, sizeof (CacheItem));
+  self->textures = g_hash_table_new (key_hash, key_equal);
+  g_queue_init (&self->lru);
+  self->n_bytes = 0;
+  self->timestamp = 0;
 }
 
 void
 gsk_gl_shadow_cache_free (GskGLShadowCache *self,
                           GskGLDriver      *gl_driver)
 {
-  guint i, p;
-
-  for (i = 0, p = self->textures->len; i < p; i ++)
-    {
-      const CacheItem *item = &g_array_index (self->textures, CacheItem, i);
-
-      gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
-    }
+  while (self->lru.head != NULL)
+    cache_item_free (self, gl_driver, self->lru.head->data);
 
-  g_array_free (self->textures, TRUE);
+  g_hash_table_unref (self->textures);
   self->textures = NULL;
 }
 
@@ -60,62 +118,45 @@ void
 gsk_gl_shadow_cache_begin_frame (GskGLShadowCache *self,
                                  GskGLDriver      *gl_driver)
 {
-  guint i, p;
+  self->timestamp++;
 
-  /* We remove all textures with used = FALSE since those have not been used in the
-   * last frame. For all others, we reset the `used` value to FALSE instead and see
-   * if they end up with TRUE in the next call to begin_frame. */
-  for (i = 0, p = self->textures->len; i < p; i ++)
+  /* The queue is ordered by last use, with the most recently used
+   * item at the head, so we only ever need to look at the tail. */
+  while (self->lru.tail != NULL)
     {
-      CacheItem *item = &g_array_index (self->textures, CacheItem, i);
-
-      if (item->unused_frames > MAX_UNUSED_FRAMES)
-        {
-          gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
-          g_array_remove_index_fast (self->textures, i);
-          p --;
-          i --;
-        }
-      else
-        {
-          item->unused_frames ++;
-        }
+      CacheItem *item = self->lru.tail->data;
+
+      if (self->timestamp - item->last_used <= MAX_UNUSED_FRAMES &&
+          self->n_bytes <= MAX_CACHE_BYTES)
+        break;
+
+      g_hash_table_remove (self->textures, &item->key);
+      cache_item_free (self, gl_driver, item);
     }
 }
 
-/* XXX
- * The offset origin should always be at 0/0, or the blur radius should just go
- * away since it defines the origin position anyway?
- */
 int
 gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache     *self,
                                     GskGLDriver          *gl_driver,
                                     const GskRoundedRect *shadow_rect,
                                     float                 blur_radius)
 {
-  CacheItem *item= NULL;
-  guint i;
+  CacheKey key;
+  CacheItem *item;
 
   g_assert (self != NULL);
   g_assert (gl_driver != NULL);
   g_assert (shadow_rect != NULL);
 
-  for (i = 0; i < self->textures->len; i ++)
-    {
-      CacheItem *k = &g_array_index (self->textures, CacheItem, i);
-
-      if (key_equal (&(CacheKey){*shadow_rect, blur_radius},
-                     &(CacheKey){k->outline, k->blur_radius}))
-        {
-          item = k;
-          break;
-        }
-    }
+  key_init (&key, shadow_rect, blur_radius);
 
+  item = g_hash_table_lookup (self->textures, &key);
   if (item == NULL)
     return 0;
 
-  item->unused_frames = 0;
+  item->last_used = self->timestamp;
+  g_queue_unlink (&self->lru, &item->link);
+  g_queue_push_head_link (&self->lru, &item->link);
 
   g_assert (item->texture_id != 0);
 
@@ -126,7 +167,9 @@ void
 gsk_gl_shadow_cache_commit (GskGLShadowCache     *self,
                             const GskRoundedRect *shadow_rect,
                             float                 blur_radius,
-                            int                   texture_id)
+                            int                   texture_id,
+                            int                   texture_width,
+                            int                   texture_height)
 {
   CacheItem *item;
 
@@ -134,11 +177,16 @@ gsk_gl_shadow_cache_commit (GskGLShadowCache     *self,
   g_assert (shadow_rect != NULL);
   g_assert (texture_id > 0);
 
-  g_array_set_size (self->textures, self->textures->len + 1);
-  item = &g_array_index (self->textures, CacheItem, self->textures->len - 1);
-
-  item->outline = *shadow_rect;
-  item->blur_radius = blur_radius;
-  item->unused_frames = 0;
+  item = g_slice_new0 (CacheItem);
+  key_init (&item->key, shadow_rect, blur_radius);
+  item->link.data = item;
   item->texture_id = texture_id;
+  item->n_bytes = (gsize) texture_width * texture_height * 4;
+  item->last_used = self->timestamp;
+
+  g_assert (g_hash_table_lookup (self->textures, &item->key) == NULL);
+
+  g_hash_table_insert (self->textures, &item->key, item);
+  g_queue_push_head_link (&self->lru, &item->link);
+  self->n_bytes += item->n_bytes;
 }
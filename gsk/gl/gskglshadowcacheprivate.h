@@ -9,7 +9,10 @@
 
 typedef struct
 {
-  GArray *textures;
+  GHashTable *textures;
+  GQueue lru;
+  gsize n_bytes;
+  guint timestamp;
 } GskGLShadowCache;
 
 
@@ -25,7 +28,9 @@ int  gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache     *self,
 void gsk_gl_shadow_cache_commit         (GskGLShadowCache     *self,
                                          const GskRoundedRect *shadow_rect,
                                          float                 blur_radius,
-                                         int                   texture_id);
+                                         int                   texture_id,
+                                         int                   texture_width,
+                                         int                   texture_height);
 
 
 #endif
@@ -6,6 +6,13 @@
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <string.h>
+
+typedef struct _PendingProgram PendingProgram;
+
+static void pending_program_free (PendingProgram *pending);
 
 struct _GskShaderBuilder
 {
@@ -15,15 +22,30 @@ struct _GskShaderBuilder
   char *vertex_preamble;
   char *fragment_preamble;
 
-
+  /* Only compiled when a program actually needs it, see
+   * gsk_shader_builder_create_program_full() */
+  char *common_vertex_shader;
   int common_vertex_shader_id;
 
   int version;
 
   GPtrArray *defines;
 
-  /* We reuse this one for all the shaders */
-  GString *shader_code;
+  /* We reuse these for all the shaders */
+  GString *vertex_code;
+  GString *fragment_code;
+
+  /* Only valid if use_program_binaries is set */
+  char *program_cache_dir;
+  char *gl_identity;
+
+  /* program id => PendingProgram */
+  GHashTable *pending_programs;
+
+  guint checked_program_binaries : 1;
+  guint use_program_binaries : 1;
+  guint checked_parallel_compile : 1;
+  guint use_parallel_compile : 1;
 };
 
 G_DEFINE_TYPE (GskShaderBuilder, gsk_shader_builder, G_TYPE_OBJECT)
@@ -36,9 +58,14 @@ gsk_shader_builder_finalize (GObject *gobject)
   g_free (self->resource_base_path);
   g_free (self->vertex_preamble);
   g_free (self->fragment_preamble);
-  g_string_free (self->shader_code, TRUE);
+  g_free (self->common_vertex_shader);
+  g_free (self->program_cache_dir);
+  g_free (self->gl_identity);
+  g_string_free (self->vertex_code, TRUE);
+  g_string_free (self->fragment_code, TRUE);
 
   g_clear_pointer (&self->defines, g_ptr_array_unref);
+  g_clear_pointer (&self->pending_programs, g_hash_table_unref);
 
   if (self->common_vertex_shader_id > 0)
     glDeleteShader (self->common_vertex_shader_id);
@@ -56,7 +83,10 @@ static void
 gsk_shader_builder_init (GskShaderBuilder *self)
 {
   self->defines = g_ptr_array_new_with_free_func (g_free);
-  self->shader_code = g_string_new (NULL);
+  self->vertex_code = g_string_new (NULL);
+  self->fragment_code = g_string_new (NULL);
+  self->pending_programs = g_hash_table_new_full (NULL, NULL, NULL,
+                                                  (GDestroyNotify) pending_program_free);
 }
 
 GskShaderBuilder *
@@ -144,22 +174,17 @@ lookup_shader_code (GString *code,
   return TRUE;
 }
 
-static int
-gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
-                                   int               shader_type,
-                                   const char       *shader_preamble,
-                                   const char       *shader_source,
-                                   GError          **error)
+static gboolean
+gsk_shader_builder_build_source (GskShaderBuilder *builder,
+                                 GString          *code,
+                                 const char       *shader_preamble,
+                                 const char       *shader_source,
+                                 GError          **error)
 {
-  GString *code;
-  const char *source;
-  int shader_id;
-  int status;
   int i;
 
   /* Clear possibly previously set shader code */
-  g_string_erase (builder->shader_code, 0, -1);
-  code = builder->shader_code;
+  g_string_erase (code, 0, -1);
 
   if (builder->version > 0)
     {
@@ -183,18 +208,24 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
   g_string_append_c (code, '\n');
 
   if (!lookup_shader_code (code, builder->resource_base_path, shader_preamble, error))
-    {
-      return -1;
-    }
+    return FALSE;
 
   g_string_append_c (code, '\n');
 
   if (!lookup_shader_code (code, builder->resource_base_path, shader_source, error))
-    {
-      return -1;
-    }
+    return FALSE;
+
+  return TRUE;
+}
 
-  source = code->str;
+static int
+gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
+                                   int               shader_type,
+                                   const char       *shader_preamble,
+                                   const char       *shader_source,
+                                   const char       *source)
+{
+  int shader_id;
 
   shader_id = glCreateShader (shader_type);
   glShaderSource (shader_id, 1, (const GLchar **) &source, NULL);
@@ -211,6 +242,18 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
     }
 #endif
 
+  return shader_id;
+}
+
+/* Querying the status waits for the compilation to finish, so this is
+ * kept apart from gsk_shader_builder_compile_shader(). */
+static gboolean
+gsk_shader_builder_check_shader (int      shader_id,
+                                 int      shader_type,
+                                 GError **error)
+{
+  int status;
+
   glGetShaderiv (shader_id, GL_COMPILE_STATUS, &status);
   if (status == GL_FALSE)
     {
@@ -228,12 +271,10 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
                    buffer);
       g_free (buffer);
 
-      glDeleteShader (shader_id);
-
-      return -1;
+      return FALSE;
     }
 
-  return shader_id;
+  return TRUE;
 }
 
 void
@@ -241,82 +282,365 @@ gsk_shader_builder_set_common_vertex_shader (GskShaderBuilder  *self,
                                              const char        *vertex_shader,
                                              GError           **error)
 {
-  int shader_id;
+  g_return_if_fail (GSK_IS_SHADER_BUILDER (self));
+  g_return_if_fail (vertex_shader != NULL);
+
+  g_free (self->common_vertex_shader);
+  self->common_vertex_shader = g_strdup (vertex_shader);
+
+  if (self->common_vertex_shader_id > 0)
+    {
+      glDeleteShader (self->common_vertex_shader_id);
+      self->common_vertex_shader_id = 0;
+    }
+}
+
+/* Program binaries are cached on disk, keyed by the GL implementation
+ * and the full source of both shaders. Drivers may still reject a cached
+ * binary, e.g. after an update that didn't change the version string,
+ * in which case we compile from source and replace the cached one. */
+static gboolean
+gsk_shader_builder_check_program_binaries (GskShaderBuilder *builder)
+{
+  int n_formats = 0;
+
+  if (builder->checked_program_binaries)
+    return builder->use_program_binaries;
+
+  builder->checked_program_binaries = TRUE;
+
+#ifdef G_ENABLE_DEBUG
+  /* Make sure we get to see the shaders */
+  if (GSK_DEBUG_CHECK (SHADERS))
+    return FALSE;
+#endif
+
+  if (epoxy_is_desktop_gl ())
+    {
+      if (epoxy_gl_version () < 41 && !epoxy_has_gl_extension ("GL_ARB_get_program_binary"))
+        return FALSE;
+    }
+  else
+    {
+      if (epoxy_gl_version () < 30 && !epoxy_has_gl_extension ("GL_OES_get_program_binary"))
+        return FALSE;
+    }
+
+  glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+  if (n_formats == 0)
+    return FALSE;
+
+  builder->gl_identity = g_strdup_printf ("%s\n%s\n%s\n",
+                                          (const char *) glGetString (GL_VENDOR),
+                                          (const char *) glGetString (GL_RENDERER),
+                                          (const char *) glGetString (GL_VERSION));
+  builder->program_cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                                 "gtk-4.0", "gl-program-cache",
+                                                 NULL);
+  builder->use_program_binaries = TRUE;
+
+  return TRUE;
+}
+
+static char *
+gsk_shader_builder_get_program_cache_path (GskShaderBuilder *builder)
+{
+  GChecksum *checksum;
+  char *path;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) builder->gl_identity, -1);
+  g_checksum_update (checksum, (const guchar *) builder->vertex_code->str, builder->vertex_code->len + 1);
+  g_checksum_update (checksum, (const guchar *) builder->fragment_code->str, builder->fragment_code->len + 1);
+
+  path = g_build_filename (builder->program_cache_dir, g_checksum_get_string (checksum), NULL);
+  g_checksum_free (checksum);
+
+  return path;
+}
+
+static int
+gsk_shader_builder_load_program_binary (GskShaderBuilder *builder,
+                                        const char       *path)
+{
+  guint32 format;
+  char *data;
+  gsize size;
+  int program_id = 0;
+  int status = GL_FALSE;
+
+  if (!g_file_get_contents (path, &data, &size, NULL))
+    return -1;
+
+  if (size > sizeof (guint32))
+    {
+      memcpy (&format, data, sizeof (guint32));
+
+      program_id = glCreateProgram ();
+      glProgramBinary (program_id, format, data + sizeof (guint32), size - sizeof (guint32));
+      glGetProgramiv (program_id, GL_LINK_STATUS, &status);
+    }
+
+  g_free (data);
+
+  if (status == GL_FALSE)
+    {
+      GSK_NOTE (SHADERS, g_message ("Cached program binary %s rejected", path));
+      if (program_id > 0)
+        glDeleteProgram (program_id);
+      g_unlink (path);
+      return -1;
+    }
+
+  return program_id;
+}
+
+static void
+gsk_shader_builder_save_program_binary (GskShaderBuilder *builder,
+                                        int               program_id,
+                                        const char       *path)
+{
+  GError *error = NULL;
+  GLenum format;
+  int length = 0;
+  char *data;
 
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
 
-  shader_id = gsk_shader_builder_compile_shader (self,
-                                                 GL_VERTEX_SHADER,
-                                                 self->vertex_preamble,
-                                                 vertex_shader,
-                                                 error);
+  data = g_malloc (sizeof (guint32) + length);
+  glGetProgramBinary (program_id, length, &length, &format, data + sizeof (guint32));
+  memcpy (data, &(guint32) { format }, sizeof (guint32));
 
-  g_assert (shader_id > 0);
-  self->common_vertex_shader_id = shader_id;
+  if (g_mkdir_with_parents (builder->program_cache_dir, 0700) != 0 ||
+      !g_file_set_contents (path, data, sizeof (guint32) + length, &error))
+    {
+      GSK_NOTE (SHADERS, g_message ("Failed to save program binary: %s",
+                                    error ? error->message : g_strerror (errno)));
+      g_clear_error (&error);
+    }
+
+  g_free (data);
 }
 
 int
 gsk_shader_builder_create_program (GskShaderBuilder *builder,
                                    const char       *fragment_shader,
                                    GError          **error)
+{
+  return gsk_shader_builder_create_program_full (builder, NULL, fragment_shader, error);
+}
+
+/* Like gsk_shader_builder_create_program(), but uses @vertex_shader
+ * instead of the common vertex shader, unless it is %NULL. */
+int
+gsk_shader_builder_create_program_full (GskShaderBuilder *builder,
+                                        const char       *vertex_shader,
+                                        const char       *fragment_shader,
+                                        GError          **error)
+{
+  int program_id;
+
+  program_id = gsk_shader_builder_begin_program (builder, vertex_shader, fragment_shader, error);
+  if (program_id < 0)
+    return -1;
+
+  if (!gsk_shader_builder_finish_program (builder, program_id, error))
+    return -1;
+
+  return program_id;
+}
+
+struct _PendingProgram
 {
+  int vertex_id;
+  int fragment_id;
+  gboolean owns_vertex_shader;
+  char *cache_path;
+};
+
+static void
+pending_program_free (PendingProgram *pending)
+{
+  if (pending->owns_vertex_shader)
+    glDeleteShader (pending->vertex_id);
+  glDeleteShader (pending->fragment_id);
+  g_free (pending->cache_path);
+  g_slice_free (PendingProgram, pending);
+}
+
+/* Starts compiling and linking a program, without waiting for the
+ * result. With GL_KHR_parallel_shader_compile, the driver can do this
+ * in the background and gsk_shader_builder_program_is_ready() tells
+ * when gsk_shader_builder_finish_program() won't block any more.
+ *
+ * Programs loaded from the binary cache are returned ready. */
+int
+gsk_shader_builder_begin_program (GskShaderBuilder *builder,
+                                  const char       *vertex_shader,
+                                  const char       *fragment_shader,
+                                  GError          **error)
+{
+  PendingProgram *pending;
+  const char *vertex_file;
+  char *cache_path = NULL;
   int vertex_id;
   int fragment_id;
   int program_id;
-  int status;
 
   g_return_val_if_fail (GSK_IS_SHADER_BUILDER (builder), -1);
   g_return_val_if_fail (fragment_shader != NULL, -1);
-  g_return_val_if_fail (builder->common_vertex_shader_id != 0, -1);
+  g_return_val_if_fail (vertex_shader != NULL || builder->common_vertex_shader != NULL, -1);
+
+  vertex_file = vertex_shader != NULL ? vertex_shader : builder->common_vertex_shader;
+
+  if (!gsk_shader_builder_build_source (builder, builder->vertex_code,
+                                        builder->vertex_preamble, vertex_file,
+                                        error) ||
+      !gsk_shader_builder_build_source (builder, builder->fragment_code,
+                                        builder->fragment_preamble, fragment_shader,
+                                        error))
+    return -1;
+
+  if (gsk_shader_builder_check_program_binaries (builder))
+    {
+      cache_path = gsk_shader_builder_get_program_cache_path (builder);
+      program_id = gsk_shader_builder_load_program_binary (builder, cache_path);
+      if (program_id > 0)
+        {
+          g_free (cache_path);
+          return program_id;
+        }
+    }
+
+  if (vertex_shader != NULL)
+    {
+      vertex_id = gsk_shader_builder_compile_shader (builder, GL_VERTEX_SHADER,
+                                                     builder->vertex_preamble,
+                                                     vertex_shader,
+                                                     builder->vertex_code->str);
+    }
+  else
+    {
+      /* The common one is shared, so it is checked right away */
+      if (builder->common_vertex_shader_id == 0)
+        {
+          vertex_id = gsk_shader_builder_compile_shader (builder, GL_VERTEX_SHADER,
+                                                         builder->vertex_preamble,
+                                                         builder->common_vertex_shader,
+                                                         builder->vertex_code->str);
+          if (!gsk_shader_builder_check_shader (vertex_id, GL_VERTEX_SHADER, error))
+            {
+              glDeleteShader (vertex_id);
+              g_free (cache_path);
+              return -1;
+            }
+
+          builder->common_vertex_shader_id = vertex_id;
+        }
+
+      vertex_id = builder->common_vertex_shader_id;
+    }
 
-  vertex_id = builder->common_vertex_shader_id;
   fragment_id = gsk_shader_builder_compile_shader (builder, GL_FRAGMENT_SHADER,
                                                    builder->fragment_preamble,
                                                    fragment_shader,
-                                                   error);
-  if (fragment_id < 0)
-    {
-      glDeleteShader (vertex_id);
-      return -1;
-    }
+                                                   builder->fragment_code->str);
 
   program_id = glCreateProgram ();
   glAttachShader (program_id, vertex_id);
   glAttachShader (program_id, fragment_id);
+  /* GLES 2 only has the OES extension, which doesn't have the hint */
+  if (cache_path != NULL && (epoxy_is_desktop_gl () || epoxy_gl_version () >= 30))
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram (program_id);
 
+  pending = g_slice_new (PendingProgram);
+  pending->vertex_id = vertex_id;
+  pending->fragment_id = fragment_id;
+  pending->owns_vertex_shader = vertex_shader != NULL;
+  pending->cache_path = cache_path;
+
+  g_hash_table_insert (builder->pending_programs, GINT_TO_POINTER (program_id), pending);
+
+  return program_id;
+}
+
+gboolean
+gsk_shader_builder_program_is_ready (GskShaderBuilder *builder,
+                                     int               program_id)
+{
+  int done = GL_TRUE;
+
+  g_return_val_if_fail (GSK_IS_SHADER_BUILDER (builder), TRUE);
+
+  if (!g_hash_table_contains (builder->pending_programs, GINT_TO_POINTER (program_id)))
+    return TRUE;
+
+  if (!builder->checked_parallel_compile)
+    {
+      builder->checked_parallel_compile = TRUE;
+      builder->use_parallel_compile = epoxy_has_gl_extension ("GL_KHR_parallel_shader_compile");
+    }
+
+  if (builder->use_parallel_compile)
+    glGetProgramiv (program_id, GL_COMPLETION_STATUS_KHR, &done);
+
+  return done != GL_FALSE;
+}
+
+/* Waits for a program started with gsk_shader_builder_begin_program().
+ * If it failed to compile or link, the program is deleted. */
+gboolean
+gsk_shader_builder_finish_program (GskShaderBuilder *builder,
+                                   int               program_id,
+                                   GError          **error)
+{
+  PendingProgram *pending;
+  int status;
+
+  g_return_val_if_fail (GSK_IS_SHADER_BUILDER (builder), FALSE);
+
+  pending = g_hash_table_lookup (builder->pending_programs, GINT_TO_POINTER (program_id));
+  if (pending == NULL)
+    return TRUE;
+
+  g_hash_table_steal (builder->pending_programs, GINT_TO_POINTER (program_id));
+
   glGetProgramiv (program_id, GL_LINK_STATUS, &status);
   if (status == GL_FALSE)
     {
-      char *buffer = NULL;
-      int log_len = 0;
+      if (gsk_shader_builder_check_shader (pending->fragment_id, GL_FRAGMENT_SHADER, error) &&
+          (!pending->owns_vertex_shader ||
+           gsk_shader_builder_check_shader (pending->vertex_id, GL_VERTEX_SHADER, error)))
+        {
+          char *buffer = NULL;
+          int log_len = 0;
 
-      glGetProgramiv (program_id, GL_INFO_LOG_LENGTH, &log_len);
+          glGetProgramiv (program_id, GL_INFO_LOG_LENGTH, &log_len);
 
-      buffer = g_malloc0 (log_len + 1);
-      glGetProgramInfoLog (program_id, log_len, NULL, buffer);
+          buffer = g_malloc0 (log_len + 1);
+          glGetProgramInfoLog (program_id, log_len, NULL, buffer);
 
-      g_set_error (error, GDK_GL_ERROR, GDK_GL_ERROR_LINK_FAILED,
-                   "Linking failure in shader:\n%s", buffer);
-      g_free (buffer);
+          g_set_error (error, GDK_GL_ERROR, GDK_GL_ERROR_LINK_FAILED,
+                       "Linking failure in shader:\n%s", buffer);
+          g_free (buffer);
+        }
 
       glDeleteProgram (program_id);
-      program_id = -1;
+      pending_program_free (pending);
 
-      goto out;
+      return FALSE;
     }
 
-out:
-  if (vertex_id > 0)
-    {
-      /* We delete the common vertex shader when destroying the shader builder */
-      glDetachShader (program_id, vertex_id);
-    }
+  if (pending->cache_path != NULL)
+    gsk_shader_builder_save_program_binary (builder, program_id, pending->cache_path);
 
-  if (fragment_id > 0)
-    {
-      glDetachShader (program_id, fragment_id);
-      glDeleteShader (fragment_id);
-    }
+  /* We delete the common vertex shader when destroying the shader builder */
+  glDetachShader (program_id, pending->vertex_id);
+  glDetachShader (program_id, pending->fragment_id);
+  pending_program_free (pending);
 
-  return program_id;
+  return TRUE;
 }
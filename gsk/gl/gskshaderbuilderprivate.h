@@ -32,6 +32,20 @@ void                    gsk_shader_builder_set_common_vertex_shader     (GskShad
 int                     gsk_shader_builder_create_program               (GskShaderBuilder *builder,
                                                                          const char       *fragment_shader,
                                                                          GError          **error);
+int                     gsk_shader_builder_create_program_full          (GskShaderBuilder *builder,
+                                                                         const char       *vertex_shader,
+                                                                         const char       *fragment_shader,
+                                                                         GError          **error);
+
+int                     gsk_shader_builder_begin_program                (GskShaderBuilder *builder,
+                                                                         const char       *vertex_shader,
+                                                                         const char       *fragment_shader,
+                                                                         GError          **error);
+gboolean                gsk_shader_builder_program_is_ready             (GskShaderBuilder *builder,
+                                                                         int               program_id);
+gboolean                gsk_shader_builder_finish_program               (GskShaderBuilder *builder,
+                                                                         int               program_id,
+                                                                         GError          **error);
 
 G_END_DECLS
 
@@ -51,6 +51,23 @@
 #define BOX_FILTER_SIZE_9 16
 #define BOX_FILTER_SIZE_10 18
 
+/* Dividing by the filter size is the most expensive part of the blur.
+ * Multiplying by (2^24 / d), rounded up, and keeping the upper 8 bits
+ * gives the exact same result for all n < 2^24 / d. The largest value we
+ * divide is 256 * d, so that holds for all d <= 256 and we fall back to
+ * dividing for anything bigger. Everything fits into 32 bits, so this
+ * vectorizes well.
+ */
+#define MAX_RECIPROCAL_FILTER_SIZE 256
+
+static inline guint32
+get_reciprocal (int d)
+{
+  return ((1 << 24) - 1) / d + 1;
+}
+
+#define DIVIDE_RECIPROCAL(n, reciprocal) (((guint32) (n) * (reciprocal)) >> 24)
+
 /* This applies a single box blur pass to a horizontal range of pixels;
  * since the box blur has the same weight for all pixels, we can
  * implement an efficient sliding window algorithm where we add
@@ -68,6 +85,7 @@ blur_xspan (guchar *row,
             int     d,
             int     shift)
 {
+  guint32 reciprocal = get_reciprocal (d);
   int offset;
   int sum = 0;
   int i;
@@ -80,14 +98,10 @@ blur_xspan (guchar *row,
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win.
    */
 
-#define BLUR_ROW_KERNEL(D)                                      \
+#define BLUR_ROW_KERNEL(D, DIV)                                 \
   for (i = -(D) + offset; i < row_width + offset; i++)		\
     {                                                           \
       if (i >= 0 && i < row_width)                              \
@@ -98,27 +112,34 @@ blur_xspan (guchar *row,
 	  if (i >= (D))						\
 	    sum -= row[i - (D)];				\
                                                                 \
-	  tmp_buffer[i - offset] = (sum + (D) / 2) / (D);	\
+	  tmp_buffer[i - offset] = DIV (sum + (D) / 2, D);	\
 	}							\
     }								\
   break;
 
+#define CONSTANT_DIVIDE(n, D) ((n) / (D))
+#define RECIPROCAL_DIVIDE(n, D) ((D) <= MAX_RECIPROCAL_FILTER_SIZE ? DIVIDE_RECIPROCAL (n, reciprocal) : (n) / (D))
+
   /* We unroll the values for d for radius 2-10 to avoid a generic
    * divide operation (not radius 1, because its a no-op) */
   switch (d)
     {
-    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2);
-    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3);
-    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4);
-    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5);
-    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6);
-    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7);
-    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8);
-    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9);
-    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10);
-    default: BLUR_ROW_KERNEL (d);
+    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9, CONSTANT_DIVIDE);
+    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10, CONSTANT_DIVIDE);
+    default: BLUR_ROW_KERNEL (d, RECIPROCAL_DIVIDE);
     }
 
+#undef CONSTANT_DIVIDE
+#undef RECIPROCAL_DIVIDE
+#undef BLUR_ROW_KERNEL
+
   memcpy (row, tmp_buffer, row_width);
 }
 
@@ -156,33 +177,94 @@ blur_rows (guchar *dst_buffer,
     }
 }
 
-/* Swaps width and height.
+/* This is the same sliding window as blur_xspan(), but it runs down
+ * all columns at once, keeping one sum per column. That way we only
+ * ever touch memory row by row and don't need to transpose the buffer,
+ * and the loops over a row have no branches, so the compiler can
+ * vectorize them.
  */
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+blur_yspan (const guchar *src_buffer,
+            guchar       *dst_buffer,
+            guint32      *sums,
+            int           width,
+            int           height,
+            int           d,
+            int           shift)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
-   */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  guint32 reciprocal = get_reciprocal (d);
+  int offset;
+  int i, x;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  memset (sums, 0, sizeof (guint32) * width);
+
+  for (i = -d + offset; i < height + offset; i++)
+    {
+      if (i >= 0 && i < height)
+        {
+          const guchar *row = src_buffer + i * width;
+
+          for (x = 0; x < width; x++)
+            sums[x] += row[x];
+        }
+
+      if (i >= offset)
+        {
+          guchar *out = dst_buffer + (i - offset) * width;
+
+          if (i >= d)
+            {
+              const guchar *row = src_buffer + (i - d) * width;
+
+              for (x = 0; x < width; x++)
+                sums[x] -= row[x];
+            }
+
+          if (d <= MAX_RECIPROCAL_FILTER_SIZE)
+            {
+              for (x = 0; x < width; x++)
+                out[x] = DIVIDE_RECIPROCAL (sums[x] + d / 2, reciprocal);
+            }
+          else
+            {
+              for (x = 0; x < width; x++)
+                out[x] = (sums[x] + d / 2) / d;
+            }
+        }
+    }
+}
+
+static void
+blur_cols (guchar *buffer,
+           guchar *tmp_buffer,
+           int     width,
+           int     height,
+           int     d)
+{
+  guint32 *sums = g_new (guint32, width);
+
+  /* See blur_rows() for why even sizes are special */
+  if (d % 2 == 1)
+    {
+      blur_yspan (buffer, tmp_buffer, sums, width, height, d, 0);
+      blur_yspan (tmp_buffer, buffer, sums, width, height, d, 0);
+      blur_yspan (buffer, tmp_buffer, sums, width, height, d, 0);
+    }
+  else
+    {
+      blur_yspan (buffer, tmp_buffer, sums, width, height, d, 1);
+      blur_yspan (tmp_buffer, buffer, sums, width, height, d, -1);
+      blur_yspan (buffer, tmp_buffer, sums, width, height, d + 1, 0);
+    }
+
+  memcpy (buffer, tmp_buffer, width * height);
+
+  g_free (sums);
 }
 
 static void
@@ -192,30 +274,18 @@ _boxblur (guchar      *buffer,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
+  guchar *tmp_buffer;
   int d = get_box_filter_size (radius);
 
-  flipped_buffer = g_malloc (width * height);
+  tmp_buffer = g_malloc (width * height);
 
   if (flags & GSK_BLUR_Y)
-    {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
-
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
-
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
-    }
+    blur_cols (buffer, tmp_buffer, width, height, d);
 
   if (flags & GSK_BLUR_X)
-    {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
-    }
+    blur_rows (buffer, tmp_buffer, width, height, d);
 
-  g_free (flipped_buffer);
+  g_free (tmp_buffer);
 }
 
 /*
@@ -27,6 +27,11 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <stdlib.h>
+
+/* Size of a tile in device pixels */
+#define TILE_SIZE 256
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark cpu_time;
@@ -40,6 +45,13 @@ struct _GskCairoRenderer
 
   GdkCairoContext *cairo_context;
 
+  /* For tiled rendering, see gsk_cairo_renderer_render_tiled() */
+  guint n_threads;
+  GThreadPool *tile_pool;
+  GMutex tile_lock;
+  GCond tile_cond;
+  guint n_pending_tiles;
+
 #ifdef G_ENABLE_DEBUG
   ProfileTimers profile_timers;
 #endif
@@ -52,6 +64,233 @@ struct _GskCairoRendererClass
 
 G_DEFINE_TYPE (GskCairoRenderer, gsk_cairo_renderer, GSK_TYPE_RENDERER)
 
+typedef struct {
+  GskRenderNode *root;
+  cairo_surface_t *surface;
+  graphene_rect_t area;
+} RenderTile;
+
+/* Skip all children of containers that don't touch the tile. Other
+ * nodes are left to cairo's clipping. */
+static void
+draw_node_for_area (GskRenderNode         *node,
+                    cairo_t               *cr,
+                    const graphene_rect_t *area)
+{
+  if (!graphene_rect_intersection (&node->bounds, area, NULL))
+    return;
+
+  if (gsk_render_node_get_node_type (node) == GSK_CONTAINER_NODE)
+    {
+      guint i;
+
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        draw_node_for_area (gsk_container_node_get_child (node, i), cr, area);
+    }
+  else
+    {
+      gsk_render_node_draw (node, cr);
+    }
+}
+
+static void
+gsk_cairo_renderer_render_tile_thread (gpointer data,
+                                       gpointer user_data)
+{
+  GskCairoRenderer *self = user_data;
+  RenderTile *tile = data;
+  cairo_t *cr;
+
+  cr = cairo_create (tile->surface);
+  cairo_translate (cr, - tile->area.origin.x, - tile->area.origin.y);
+  draw_node_for_area (tile->root, cr, &tile->area);
+  cairo_destroy (cr);
+
+  g_mutex_lock (&self->tile_lock);
+  self->n_pending_tiles--;
+  if (self->n_pending_tiles == 0)
+    g_cond_signal (&self->tile_cond);
+  g_mutex_unlock (&self->tile_lock);
+}
+
+/* Checks if drawing @node only reads data that can be shared
+ * between threads. */
+static gboolean
+node_can_render_tiled (GskRenderNode *node)
+{
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        {
+          if (!node_can_render_tiled (gsk_container_node_get_child (node, i)))
+            return FALSE;
+        }
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      /* Downloading GL textures needs the GL context */
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_CAIRO_NODE:
+      {
+        const cairo_surface_t *surface = gsk_cairo_node_peek_surface (node);
+
+        return surface == NULL ||
+               cairo_surface_get_type ((cairo_surface_t *) surface) == CAIRO_SURFACE_TYPE_IMAGE ||
+               cairo_surface_get_type ((cairo_surface_t *) surface) == CAIRO_SURFACE_TYPE_RECORDING;
+      }
+
+    case GSK_BLUR_NODE:
+      /* Blurring only looks at the clipped area, so it would show seams */
+      return FALSE;
+
+    case GSK_TRANSFORM_NODE:
+      return node_can_render_tiled (gsk_transform_node_get_child (node));
+    case GSK_OPACITY_NODE:
+      return node_can_render_tiled (gsk_opacity_node_get_child (node));
+    case GSK_COLOR_MATRIX_NODE:
+      return node_can_render_tiled (gsk_color_matrix_node_get_child (node));
+    case GSK_REPEAT_NODE:
+      return node_can_render_tiled (gsk_repeat_node_get_child (node));
+    case GSK_CLIP_NODE:
+      return node_can_render_tiled (gsk_clip_node_get_child (node));
+    case GSK_ROUNDED_CLIP_NODE:
+      return node_can_render_tiled (gsk_rounded_clip_node_get_child (node));
+    case GSK_SHADOW_NODE:
+      return node_can_render_tiled (gsk_shadow_node_get_child (node));
+    case GSK_DEBUG_NODE:
+      return node_can_render_tiled (gsk_debug_node_get_child (node));
+    case GSK_BLEND_NODE:
+      return node_can_render_tiled (gsk_blend_node_get_bottom_child (node)) &&
+             node_can_render_tiled (gsk_blend_node_get_top_child (node));
+    case GSK_CROSS_FADE_NODE:
+      return node_can_render_tiled (gsk_cross_fade_node_get_start_child (node)) &&
+             node_can_render_tiled (gsk_cross_fade_node_get_end_child (node));
+
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_TEXT_NODE:
+      return TRUE;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+/* Splits the area to draw into tiles and draws each of them in
+ * a thread of the tile pool. All tiles share the memory of one image
+ * surface that gets painted to @cr in the end.
+ *
+ * Returns %FALSE if @root can't be drawn this way. */
+static gboolean
+gsk_cairo_renderer_render_tiled (GskCairoRenderer     *self,
+                                 cairo_t              *cr,
+                                 GskRenderNode        *root,
+                                 const cairo_region_t *region)
+{
+  cairo_rectangle_int_t extents;
+  cairo_surface_t *surface;
+  RenderTile *tiles;
+  double scale_x, scale_y;
+  int width, height, stride;
+  int n_tiles, n_columns, n_rows;
+  guchar *data;
+  int x, y, i;
+
+  if (self->tile_pool == NULL || !node_can_render_tiled (root))
+    return FALSE;
+
+  cairo_region_get_extents (region, &extents);
+  if (extents.width <= 0 || extents.height <= 0)
+    return TRUE;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &scale_x, &scale_y);
+  width = ceil (extents.width * scale_x);
+  height = ceil (extents.height * scale_y);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cairo_surface_set_device_scale (surface, scale_x, scale_y);
+  cairo_surface_flush (surface);
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  n_columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+  n_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+  tiles = g_new (RenderTile, n_columns * n_rows);
+  n_tiles = 0;
+
+  for (y = 0; y < height; y += TILE_SIZE)
+    for (x = 0; x < width; x += TILE_SIZE)
+      {
+        RenderTile *tile = &tiles[n_tiles];
+        int tile_width = MIN (TILE_SIZE, width - x);
+        int tile_height = MIN (TILE_SIZE, height - y);
+
+        graphene_rect_init (&tile->area,
+                            extents.x + x / scale_x,
+                            extents.y + y / scale_y,
+                            tile_width / scale_x,
+                            tile_height / scale_y);
+
+        if (cairo_region_contains_rectangle (region,
+                                             &(cairo_rectangle_int_t) {
+                                               floor (tile->area.origin.x),
+                                               floor (tile->area.origin.y),
+                                               ceil (tile->area.size.width) + 1,
+                                               ceil (tile->area.size.height) + 1
+                                             }) == CAIRO_REGION_OVERLAP_OUT)
+          continue;
+
+        tile->root = root;
+        tile->surface = cairo_image_surface_create_for_data (data + y * stride + x * 4,
+                                                             CAIRO_FORMAT_ARGB32,
+                                                             tile_width, tile_height,
+                                                             stride);
+        cairo_surface_set_device_scale (tile->surface, scale_x, scale_y);
+        n_tiles++;
+      }
+
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), RENDERER,
+                     g_message ("Rendering %d tiles of %dx%d", n_tiles, width, height));
+
+  self->n_pending_tiles = n_tiles;
+  for (i = 0; i < n_tiles; i++)
+    g_thread_pool_push (self->tile_pool, &tiles[i], NULL);
+
+  g_mutex_lock (&self->tile_lock);
+  while (self->n_pending_tiles > 0)
+    g_cond_wait (&self->tile_cond, &self->tile_lock);
+  g_mutex_unlock (&self->tile_lock);
+
+  for (i = 0; i < n_tiles; i++)
+    cairo_surface_destroy (tiles[i].surface);
+  g_free (tiles);
+
+  cairo_surface_mark_dirty (surface);
+
+  cairo_save (cr);
+  gdk_cairo_region (cr, region);
+  cairo_clip (cr);
+  cairo_set_source_surface (cr, surface, extents.x, extents.y);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  cairo_surface_destroy (surface);
+
+  return TRUE;
+}
+
 static gboolean
 gsk_cairo_renderer_realize (GskRenderer  *renderer,
                             GdkSurface   *surface,
@@ -61,6 +300,16 @@ gsk_cairo_renderer_realize (GskRenderer  *renderer,
 
   self->cairo_context = gdk_surface_create_cairo_context (surface);
 
+  if (self->n_threads > 1)
+    {
+      self->tile_pool = g_thread_pool_new (gsk_cairo_renderer_render_tile_thread,
+                                           self,
+                                           self->n_threads,
+                                           FALSE,
+                                           NULL);
+      GSK_RENDERER_NOTE (renderer, RENDERER, g_message ("Rendering tiles with %u threads", self->n_threads));
+    }
+
   return TRUE;
 }
 
@@ -70,15 +319,22 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
 
   g_clear_object (&self->cairo_context);
+
+  if (self->tile_pool)
+    {
+      g_thread_pool_free (self->tile_pool, FALSE, TRUE);
+      self->tile_pool = NULL;
+    }
 }
 
 static void
-gsk_cairo_renderer_do_render (GskRenderer   *renderer,
-                              cairo_t       *cr,
-                              GskRenderNode *root)
+gsk_cairo_renderer_do_render (GskRenderer          *renderer,
+                              cairo_t              *cr,
+                              GskRenderNode        *root,
+                              const cairo_region_t *region)
 {
-#ifdef G_ENABLE_DEBUG
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+#ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
 #endif
@@ -88,7 +344,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (region == NULL || !gsk_cairo_renderer_render_tiled (self, cr, root, region))
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -112,7 +369,7 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
 
   cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  gsk_cairo_renderer_do_render (renderer, cr, root, NULL);
 
   cairo_destroy (cr);
 
@@ -152,17 +409,31 @@ gsk_cairo_renderer_render (GskRenderer          *renderer,
     }
 #endif
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  gsk_cairo_renderer_do_render (renderer, cr, root, region);
 
   cairo_destroy (cr);
 
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->cairo_context));
 }
 
+static void
+gsk_cairo_renderer_finalize (GObject *gobject)
+{
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (gobject);
+
+  g_mutex_clear (&self->tile_lock);
+  g_cond_clear (&self->tile_cond);
+
+  G_OBJECT_CLASS (gsk_cairo_renderer_parent_class)->finalize (gobject);
+}
+
 static void
 gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 {
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gsk_cairo_renderer_finalize;
 
   renderer_class->realize = gsk_cairo_renderer_realize;
   renderer_class->unrealize = gsk_cairo_renderer_unrealize;
@@ -173,11 +444,25 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 static void
 gsk_cairo_renderer_init (GskCairoRenderer *self)
 {
+  const char *threads;
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
 #endif
+
+  g_mutex_init (&self->tile_lock);
+  g_cond_init (&self->tile_cond);
+
+  /* GSK_CAIRO_THREADS=n renders in tiles using n threads,
+   * any other value uses one thread per CPU. */
+  threads = g_getenv ("GSK_CAIRO_THREADS");
+  if (threads != NULL)
+    {
+      int n = atoi (threads);
+
+      self->n_threads = n > 0 ? n : g_get_num_processors ();
+    }
 }
 
 /**
@@ -192,6 +477,10 @@ gsk_cairo_renderer_init (GskCairoRenderer *self)
  * content and will instead render an error marker. Its usage should be
  * avoided.
  *
+ * If the `GSK_CAIRO_THREADS` environment variable is set, the Cairo
+ * renderer splits the surface into tiles and renders them in parallel
+ * using that many threads.
+ *
  * Returns: a new Cairo renderer.
  **/
 GskRenderer *
@@ -1,6 +1,11 @@
 #include "gskresources.h"
 #include "gskprivate.h"
 
+/* Glyph caches get many glyphs at once when new text shows up. With
+ * at least MIN_THREADED_GLYPHS of them, they are drawn in a pool of
+ * one thread per CPU, in batches of at least that many glyphs. */
+#define MIN_THREADED_GLYPHS 32
+
 static gpointer
 register_resources (gpointer data)
 {
@@ -35,3 +40,151 @@ pango_glyph_string_num_glyphs (PangoGlyphString *glyphs)
   return count;
 }
 
+
+/* Pango is not thread-safe, so the hex boxes of unknown glyphs are
+ * drawn with it before any threads start. All other glyphs are drawn
+ * with the cairo scaled font of their font, which is safe to use from
+ * multiple threads. */
+static void
+render_unknown_glyph (const GskRenderGlyph *glyph)
+{
+  PangoGlyphString glyph_string;
+  PangoGlyphInfo glyph_info;
+  cairo_t *cr;
+
+  cr = cairo_create (glyph->surface);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+  glyph_info.glyph = glyph->glyph;
+  glyph_info.geometry.width = glyph->draw_width * PANGO_SCALE;
+  glyph_info.geometry.x_offset = 0;
+  glyph_info.geometry.y_offset = - glyph->draw_y * PANGO_SCALE;
+
+  glyph_string.num_glyphs = 1;
+  glyph_string.glyphs = &glyph_info;
+
+  pango_cairo_show_glyph_string (cr, glyph->font, &glyph_string);
+  cairo_destroy (cr);
+}
+
+static void
+render_glyph (const GskRenderGlyph *glyph)
+{
+  cairo_glyph_t cairo_glyph;
+  cairo_t *cr;
+
+  if (glyph->scaled_font == NULL)
+    return;
+
+  cr = cairo_create (glyph->surface);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+  cairo_set_scaled_font (cr, glyph->scaled_font);
+
+  cairo_glyph.index = glyph->glyph;
+  cairo_glyph.x = - glyph->draw_x;
+  cairo_glyph.y = - glyph->draw_y;
+
+  cairo_show_glyphs (cr, &cairo_glyph, 1);
+  cairo_destroy (cr);
+}
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} RenderGlyphsTask;
+
+typedef struct
+{
+  RenderGlyphsTask *task;
+  const GskRenderGlyph *glyphs;
+  guint n_glyphs;
+} RenderGlyphsBatch;
+
+static void
+render_glyphs_thread (gpointer data,
+                      gpointer user_data)
+{
+  RenderGlyphsBatch *batch = data;
+  RenderGlyphsTask *task = batch->task;
+  guint i;
+
+  for (i = 0; i < batch->n_glyphs; i++)
+    render_glyph (&batch->glyphs[i]);
+
+  g_mutex_lock (&task->lock);
+  task->n_pending--;
+  if (task->n_pending == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->lock);
+}
+
+static gpointer
+create_glyph_pool (gpointer data)
+{
+  if (g_get_num_processors () < 2)
+    return NULL;
+
+  return g_thread_pool_new (render_glyphs_thread, NULL,
+                            g_get_num_processors (), FALSE, NULL);
+}
+
+/* Draws @glyphs, which must all have their own surfaces or draw
+ * to separate parts of the memory of one surface. */
+void
+gsk_render_glyphs (GskRenderGlyph *glyphs,
+                   guint           n_glyphs)
+{
+  static GOnce glyph_pool_once = G_ONCE_INIT;
+  RenderGlyphsTask task;
+  RenderGlyphsBatch *batches;
+  GThreadPool *pool;
+  guint i, n_batches;
+
+  /* This is the only place that calls into Pango */
+  for (i = 0; i < n_glyphs; i++)
+    {
+      if (glyphs[i].glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+        {
+          glyphs[i].scaled_font = NULL;
+          render_unknown_glyph (&glyphs[i]);
+        }
+      else
+        glyphs[i].scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *) glyphs[i].font);
+    }
+
+  pool = n_glyphs >= 2 * MIN_THREADED_GLYPHS ? g_once (&glyph_pool_once, create_glyph_pool, NULL) : NULL;
+
+  if (pool == NULL)
+    {
+      for (i = 0; i < n_glyphs; i++)
+        render_glyph (&glyphs[i]);
+      return;
+    }
+
+  n_batches = MIN (g_get_num_processors (), n_glyphs / MIN_THREADED_GLYPHS);
+  batches = g_newa (RenderGlyphsBatch, n_batches);
+
+  g_mutex_init (&task.lock);
+  g_cond_init (&task.cond);
+  task.n_pending = n_batches;
+
+  for (i = 0; i < n_batches; i++)
+    {
+      batches[i].task = &task;
+      batches[i].glyphs = glyphs + i * n_glyphs / n_batches;
+      batches[i].n_glyphs = (i + 1) * n_glyphs / n_batches - i * n_glyphs / n_batches;
+    }
+
+  for (i = 0; i < n_batches; i++)
+    g_thread_pool_push (pool, &batches[i], NULL);
+
+  g_mutex_lock (&task.lock);
+  while (task.n_pending > 0)
+    g_cond_wait (&task.cond, &task.lock);
+  g_mutex_unlock (&task.lock);
+
+  g_cond_clear (&task.cond);
+  g_mutex_clear (&task.lock);
+}
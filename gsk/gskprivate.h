@@ -2,7 +2,7 @@
 #define __GSK_PRIVATE_H__
 
 #include <glib.h>
-#include <pango/pango.h>
+#include <pango/pangocairo.h>
 
 G_BEGIN_DECLS
 
@@ -10,6 +10,23 @@ void gsk_ensure_resources (void);
 
 int pango_glyph_string_num_glyphs (PangoGlyphString *glyphs);
 
+/* A glyph to draw in white into @surface, with the top left corner
+ * of its ink rectangle at the origin. @surface has the device scale
+ * of the glyph. @scaled_font is set by gsk_render_glyphs(). */
+typedef struct
+{
+  PangoFont *font;
+  PangoGlyph glyph;
+  int draw_x;
+  int draw_y;
+  int draw_width;
+  cairo_surface_t *surface;
+  cairo_scaled_font_t *scaled_font;
+} GskRenderGlyph;
+
+void gsk_render_glyphs (GskRenderGlyph *glyphs,
+                        guint           n_glyphs);
+
 typedef struct _GskVulkanRender GskVulkanRender;
 typedef struct _GskVulkanRenderPass GskVulkanRenderPass;
 
@@ -2,7 +2,10 @@
 
 #include "gskprofilerprivate.h"
 
-#define MAX_SAMPLES     32
+/* Samples of all timers share this ring, so it needs to be large enough
+ * for the per-program GPU timers of the GL renderer too.
+ */
+#define MAX_SAMPLES     512
 
 typedef struct {
   GQuark id;
@@ -73,6 +73,11 @@ typedef struct
 
   GskDebugFlags debug_flags;
 
+  /* See gsk_renderer_record_debug_regions() */
+  guint record_debug_regions;
+  GArray *debug_regions[GSK_N_DEBUG_REGIONS];
+  GArray *last_debug_regions[GSK_N_DEBUG_REGIONS];
+
   gboolean is_realized : 1;
 } GskRendererPrivate;
 
@@ -123,11 +128,17 @@ gsk_renderer_real_render (GskRenderer          *self,
   GSK_RENDERER_WARN_NOT_IMPLEMENTED_METHOD (self, render);
 }
 
+static void
+gsk_renderer_real_trim_caches (GskRenderer *self)
+{
+}
+
 static void
 gsk_renderer_dispose (GObject *gobject)
 {
   GskRenderer *self = GSK_RENDERER (gobject);
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (self);
+  guint i;
 
   /* We can't just unrealize here because superclasses have already run dispose.
    * So we insist that unrealize must be called before unreffing. */
@@ -135,6 +146,12 @@ gsk_renderer_dispose (GObject *gobject)
 
   g_clear_object (&priv->profiler);
 
+  for (i = 0; i < GSK_N_DEBUG_REGIONS; i++)
+    {
+      g_clear_pointer (&priv->debug_regions[i], g_array_unref);
+      g_clear_pointer (&priv->last_debug_regions[i], g_array_unref);
+    }
+
   G_OBJECT_CLASS (gsk_renderer_parent_class)->dispose (gobject);
 }
 
@@ -172,6 +189,7 @@ gsk_renderer_class_init (GskRendererClass *klass)
   klass->unrealize = gsk_renderer_real_unrealize;
   klass->render = gsk_renderer_real_render;
   klass->render_texture = gsk_renderer_real_render_texture;
+  klass->trim_caches = gsk_renderer_real_trim_caches;
 
   gobject_class->get_property = gsk_renderer_get_property;
   gobject_class->dispose = gsk_renderer_dispose;
@@ -313,6 +331,31 @@ gsk_renderer_unrealize (GskRenderer *renderer)
   priv->is_realized = FALSE;
 }
 
+/*
+ * gsk_renderer_trim_caches:
+ * @renderer: a #GskRenderer
+ *
+ * Releases the resources that @renderer keeps around to speed up
+ * rendering, such as glyph atlases and cached textures, as well as the
+ * node tree of the last frame. This is meant to be called when nothing
+ * will be rendered for a while, for example when the surface is hidden.
+ * The next frame is then drawn completely and repopulates the caches.
+ */
+void
+gsk_renderer_trim_caches (GskRenderer *renderer)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  g_return_if_fail (GSK_IS_RENDERER (renderer));
+
+  if (!priv->is_realized)
+    return;
+
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+
+  GSK_RENDERER_GET_CLASS (renderer)->trim_caches (renderer);
+}
+
 /**
  * gsk_renderer_render_texture:
  * @renderer: a realized #GdkRenderer
@@ -401,13 +444,17 @@ gsk_renderer_render (GskRenderer          *renderer,
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
   cairo_region_t *clip;
+  guint i;
 
   g_return_if_fail (GSK_IS_RENDERER (renderer));
   g_return_if_fail (priv->is_realized);
   g_return_if_fail (GSK_IS_RENDER_NODE (root));
   g_return_if_fail (priv->root_node == NULL);
 
-  if (region == NULL || priv->prev_node == NULL || GSK_RENDERER_DEBUG_CHECK (renderer, FULL_REDRAW))
+  /* Debug regions are collected while drawing, so they need everything
+   * to be drawn */
+  if (region == NULL || priv->prev_node == NULL || GSK_RENDERER_DEBUG_CHECK (renderer, FULL_REDRAW) ||
+      priv->record_debug_regions > 0)
     {
       clip = cairo_region_create_rectangle (&(GdkRectangle) {
                                                 0, 0,
@@ -429,8 +476,22 @@ gsk_renderer_render (GskRenderer          *renderer,
 
   priv->root_node = gsk_render_node_ref (root);
 
+  for (i = 0; i < GSK_N_DEBUG_REGIONS; i++)
+    {
+      if (priv->debug_regions[i])
+        g_array_set_size (priv->debug_regions[i], 0);
+    }
+
   GSK_RENDERER_GET_CLASS (renderer)->render (renderer, root, clip);
 
+  for (i = 0; i < GSK_N_DEBUG_REGIONS; i++)
+    {
+      GArray *tmp = priv->last_debug_regions[i];
+
+      priv->last_debug_regions[i] = priv->debug_regions[i];
+      priv->debug_regions[i] = tmp;
+    }
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
     {
@@ -472,6 +533,102 @@ gsk_renderer_get_profiler (GskRenderer *renderer)
   return priv->profiler;
 }
 
+/*< private >
+ * gsk_renderer_record_debug_regions:
+ * @renderer: a #GskRenderer
+ * @record: %TRUE to start recording, %FALSE to stop
+ *
+ * Makes the renderer record where it draws fallbacks, offscreens and
+ * drawing nodes, see gsk_renderer_get_debug_regions(). Calls must be
+ * balanced, recording stops when every start has been matched by a
+ * stop. While recording, every frame is drawn completely.
+ *
+ * This is used by the inspector. Renderers that have nothing to report
+ * don't call gsk_renderer_add_debug_region().
+ */
+void
+gsk_renderer_record_debug_regions (GskRenderer *renderer,
+                                   gboolean     record)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  guint i;
+
+  g_return_if_fail (GSK_IS_RENDERER (renderer));
+
+  if (record)
+    {
+      priv->record_debug_regions++;
+      return;
+    }
+
+  g_return_if_fail (priv->record_debug_regions > 0);
+
+  priv->record_debug_regions--;
+  if (priv->record_debug_regions > 0)
+    return;
+
+  for (i = 0; i < GSK_N_DEBUG_REGIONS; i++)
+    {
+      g_clear_pointer (&priv->debug_regions[i], g_array_unref);
+      g_clear_pointer (&priv->last_debug_regions[i], g_array_unref);
+    }
+}
+
+gboolean
+gsk_renderer_get_recording_debug_regions (GskRenderer *renderer)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  return priv->record_debug_regions > 0;
+}
+
+/*< private >
+ * gsk_renderer_add_debug_region:
+ * @renderer: a #GskRenderer
+ * @kind: what happened in @rect
+ * @rect: the affected area, in the coordinates of the root node
+ *
+ * Called by renderers while rendering to a surface and recording
+ * debug regions.
+ */
+void
+gsk_renderer_add_debug_region (GskRenderer           *renderer,
+                               GskDebugRegion         kind,
+                               const graphene_rect_t *rect)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  if (priv->record_debug_regions == 0)
+    return;
+
+  if (priv->debug_regions[kind] == NULL)
+    priv->debug_regions[kind] = g_array_new (FALSE, FALSE, sizeof (graphene_rect_t));
+
+  g_array_append_val (priv->debug_regions[kind], *rect);
+}
+
+/*< private >
+ * gsk_renderer_get_debug_regions:
+ * @renderer: a #GskRenderer
+ * @kind: the kind of regions
+ *
+ * Gets the regions of the given kind that were recorded while
+ * rendering the last frame.
+ *
+ * Returns: (transfer none) (nullable) (element-type graphene_rect_t):
+ *   the regions, or %NULL if none were recorded
+ */
+GArray *
+gsk_renderer_get_debug_regions (GskRenderer    *renderer,
+                                GskDebugRegion  kind)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
+
+  return priv->last_debug_regions[kind];
+}
+
 static GType
 get_renderer_for_name (const char *renderer_name)
 {
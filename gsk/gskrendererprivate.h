@@ -29,6 +29,18 @@ G_BEGIN_DECLS
 #define GSK_IS_RENDERER_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), GSK_TYPE_RENDERER))
 #define GSK_RENDERER_GET_CLASS(obj)	(G_TYPE_INSTANCE_GET_CLASS ((obj), GSK_TYPE_RENDERER, GskRendererClass))
 
+typedef enum {
+  GSK_DEBUG_REGION_FALLBACK,            /* drawn with cairo and uploaded */
+  GSK_DEBUG_REGION_OFFSCREEN,           /* rendered to an offscreen first */
+  GSK_DEBUG_REGION_DRAW,                /* a drawing node, for overdraw */
+  GSK_N_DEBUG_REGIONS
+} GskDebugRegion;
+
+/* Renderers leave the children of debug nodes with this message out of
+ * the debug regions, so the inspector can draw them without them
+ * showing up in the next frame's regions. */
+#define GSK_DEBUG_REGIONS_IGNORE "debug regions ignore"
+
 struct _GskRenderer
 {
   GObject parent_instance;
@@ -49,8 +61,11 @@ struct _GskRendererClass
   void                 (* render)                               (GskRenderer            *renderer,
                                                                  GskRenderNode          *root,
                                                                  const cairo_region_t   *invalid);
+  void                 (* trim_caches)                          (GskRenderer            *renderer);
 };
 
+void                    gsk_renderer_trim_caches                (GskRenderer    *renderer);
+
 GskRenderNode *         gsk_renderer_get_root_node              (GskRenderer    *renderer);
 
 GskProfiler *           gsk_renderer_get_profiler               (GskRenderer    *renderer);
@@ -59,6 +74,15 @@ GskDebugFlags           gsk_renderer_get_debug_flags            (GskRenderer
 void                    gsk_renderer_set_debug_flags            (GskRenderer    *renderer,
                                                                  GskDebugFlags   flags);
 
+void                    gsk_renderer_record_debug_regions       (GskRenderer    *renderer,
+                                                                 gboolean        record);
+gboolean                gsk_renderer_get_recording_debug_regions (GskRenderer   *renderer);
+void                    gsk_renderer_add_debug_region           (GskRenderer    *renderer,
+                                                                 GskDebugRegion  kind,
+                                                                 const graphene_rect_t *rect);
+GArray *                gsk_renderer_get_debug_regions          (GskRenderer    *renderer,
+                                                                 GskDebugRegion  kind);
+
 G_END_DECLS
 
 #endif /* __GSK_RENDERER_PRIVATE_H__ */
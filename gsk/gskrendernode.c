@@ -41,12 +41,14 @@
 #include "gskrendernodeprivate.h"
 
 #include "gskdebugprivate.h"
+#include "gskrendernodebinaryprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeparserprivate.h"
 
 #include <graphene-gobject.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <gobject/gvaluecollector.h>
 
@@ -62,14 +64,151 @@ G_DEFINE_BOXED_TYPE (GskRenderNode, gsk_render_node,
 
 G_DEFINE_QUARK (gsk-serialization-error-quark, gsk_serialization_error)
 
+/* Nodes created while an arena is pushed get carved out of a chunk
+ * of memory instead of going through malloc() one by one.
+ *
+ * Nodes regularly outlive the snapshot that created them - widgets
+ * cache their nodes and renderers keep them around as cache keys - so
+ * every node holds a reference on its chunk and a chunk is only freed
+ * once all of its nodes are gone. The arena itself just hands out
+ * memory from its current chunk.
+ *
+ * Chunks are kept small so that a few long-lived nodes cannot pin much
+ * memory.
+ */
+#define ARENA_CHUNK_SIZE  (8 * 1024)
+#define ARENA_MAX_NODE_SIZE (ARENA_CHUNK_SIZE / 4)
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(gsize) (ARENA_ALIGNMENT - 1))
+
+struct _GskRenderNodeChunk
+{
+  volatile int ref_count;
+  gsize used;
+};
+
+struct _GskRenderNodeArena
+{
+  GskRenderNodeChunk *chunk;
+};
+
+static GPrivate current_arenas;
+
+static GskRenderNodeChunk *
+gsk_render_node_chunk_new (void)
+{
+  GskRenderNodeChunk *chunk;
+
+  chunk = g_malloc (ARENA_CHUNK_SIZE);
+  chunk->ref_count = 1;
+  chunk->used = ARENA_ALIGN (sizeof (GskRenderNodeChunk));
+
+  return chunk;
+}
+
+static void
+gsk_render_node_chunk_unref (GskRenderNodeChunk *chunk)
+{
+  if (g_atomic_int_dec_and_test (&chunk->ref_count))
+    g_free (chunk);
+}
+
+static gpointer
+gsk_render_node_arena_alloc (GskRenderNodeArena  *arena,
+                             gsize                size,
+                             GskRenderNodeChunk **out_chunk)
+{
+  gpointer mem;
+
+  size = ARENA_ALIGN (size);
+
+  if (arena->chunk == NULL || arena->chunk->used + size > ARENA_CHUNK_SIZE)
+    {
+      g_clear_pointer (&arena->chunk, gsk_render_node_chunk_unref);
+      arena->chunk = gsk_render_node_chunk_new ();
+    }
+
+  mem = (guchar *) arena->chunk + arena->chunk->used;
+  arena->chunk->used += size;
+  g_atomic_int_inc (&arena->chunk->ref_count);
+  *out_chunk = arena->chunk;
+
+  memset (mem, 0, size);
+
+  return mem;
+}
+
+/*< private >
+ * gsk_render_node_arena_new:
+ *
+ * Creates a new arena to allocate render nodes from. See
+ * gsk_render_node_arena_push() on how to use it.
+ *
+ * Returns: (transfer full): a new arena
+ */
+GskRenderNodeArena *
+gsk_render_node_arena_new (void)
+{
+  return g_slice_new0 (GskRenderNodeArena);
+}
+
+/*< private >
+ * gsk_render_node_arena_free:
+ * @arena: an arena
+ *
+ * Frees @arena. Nodes allocated from it stay valid.
+ */
+void
+gsk_render_node_arena_free (GskRenderNodeArena *arena)
+{
+  g_clear_pointer (&arena->chunk, gsk_render_node_chunk_unref);
+  g_slice_free (GskRenderNodeArena, arena);
+}
+
+/*< private >
+ * gsk_render_node_arena_push:
+ * @arena: an arena
+ *
+ * Makes all nodes created in the current thread get allocated
+ * from @arena until gsk_render_node_arena_pop() is called.
+ */
+void
+gsk_render_node_arena_push (GskRenderNodeArena *arena)
+{
+  GSList *arenas = g_private_get (&current_arenas);
+
+  g_private_set (&current_arenas, g_slist_prepend (arenas, arena));
+}
+
+/*< private >
+ * gsk_render_node_arena_pop:
+ * @arena: the arena to pop
+ *
+ * Undoes gsk_render_node_arena_push(). Arenas don't need to be
+ * popped in order.
+ */
+void
+gsk_render_node_arena_pop (GskRenderNodeArena *arena)
+{
+  GSList *arenas = g_private_get (&current_arenas);
+
+  g_private_set (&current_arenas, g_slist_remove (arenas, arena));
+}
+
 static void
 gsk_render_node_finalize (GskRenderNode *self)
 {
   self->node_class->finalize (self);
 
-  g_free (self);
+  if (self->chunk)
+    gsk_render_node_chunk_unref (self->chunk);
+  else
+    g_free (self);
 }
 
+/* Not atomic, the count only needs to be good enough for statistics */
+static guint n_nodes_created;
+
 /*< private >
  * gsk_render_node_new:
  * @node_class: class structure for this node
@@ -80,19 +219,50 @@ GskRenderNode *
 gsk_render_node_new (const GskRenderNodeClass *node_class, gsize extra_size)
 {
   GskRenderNode *self;
+  GSList *arenas;
+  gsize size;
 
   g_return_val_if_fail (node_class != NULL, NULL);
   g_return_val_if_fail (node_class->node_type != GSK_NOT_A_RENDER_NODE, NULL);
 
-  self = g_malloc0 (node_class->struct_size + extra_size);
+  size = node_class->struct_size + extra_size;
+  arenas = g_private_get (&current_arenas);
+
+  if (arenas != NULL && size <= ARENA_MAX_NODE_SIZE)
+    {
+      GskRenderNodeChunk *chunk;
+
+      self = gsk_render_node_arena_alloc (arenas->data, size, &chunk);
+      self->chunk = chunk;
+    }
+  else
+    {
+      self = g_malloc0 (size);
+    }
 
   self->node_class = node_class;
 
   self->ref_count = 1;
 
+  n_nodes_created++;
+
   return self;
 }
 
+/*< private >
+ * gsk_render_node_get_n_created:
+ *
+ * Returns the number of render nodes that have been created so far.
+ * This is used by the inspector to show how many nodes a frame creates.
+ *
+ * Returns: the number of created render nodes
+ */
+guint
+gsk_render_node_get_n_created (void)
+{
+  return n_nodes_created;
+}
+
 /**
  * gsk_render_node_ref:
  * @node: a #GskRenderNode
@@ -338,6 +508,44 @@ gsk_render_node_serialize (GskRenderNode *node)
   return result;
 }
 
+/**
+ * gsk_render_node_serialize_binary:
+ * @node: a #GskRenderNode
+ *
+ * Serializes the @node into a compact binary format that
+ * gsk_render_node_deserialize() can load.
+ *
+ * Compared to gsk_render_node_serialize(), this is a lot faster
+ * and smaller for nodes with textures, but the result is not human
+ * readable and can only be loaded on machines with the same byte order.
+ * The same restrictions on compatibility between versions of GTK+
+ * apply.
+ *
+ * Returns: a #GBytes representing the node.
+ **/
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  GskRenderNodeWriter *writer;
+  GOutputStream *stream;
+  GBytes *result;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), NULL);
+
+  stream = g_memory_output_stream_new_resizable ();
+  writer = gsk_render_node_writer_new (stream);
+
+  /* Writing to memory can't fail */
+  gsk_render_node_writer_add_frame (writer, node, 0, NULL, NULL);
+
+  gsk_render_node_writer_free (writer);
+  g_output_stream_close (stream, NULL, NULL);
+  result = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+  g_object_unref (stream);
+
+  return result;
+}
+
 /**
  * gsk_render_node_write_to_file:
  * @node: a #GskRenderNode
@@ -380,8 +588,11 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  * @bytes: the bytes containing the data
  * @error: (allow-none): location to store error or %NULL
  *
- * Loads data previously created via gsk_render_node_serialize(). For a
- * discussion of the supported format, see that function.
+ * Loads data previously created via gsk_render_node_serialize() or
+ * gsk_render_node_serialize_binary(). For a discussion of the supported
+ * formats, see those functions.
+ *
+ * If the binary data contains multiple frames, the first one is returned.
  *
  * Returns: (nullable) (transfer full): a new #GskRenderNode or %NULL on
  *     error.
@@ -393,6 +604,33 @@ gsk_render_node_deserialize (GBytes            *bytes,
 {
   GskRenderNode *node = NULL;
 
+  if (gsk_render_node_is_binary (bytes))
+    {
+      GskRenderNodeReader *reader;
+      GError *error = NULL;
+
+      reader = gsk_render_node_reader_new (bytes, &error);
+      if (reader == NULL)
+        {
+          if (error_func)
+            {
+              GtkCssLocation location = { 0, };
+              GtkCssSection *section = gtk_css_section_new (NULL, &location, &location);
+
+              error_func (section, error, user_data);
+              gtk_css_section_unref (section);
+            }
+          g_error_free (error);
+          return NULL;
+        }
+
+      if (gsk_render_node_reader_get_n_frames (reader) > 0)
+        node = gsk_render_node_ref (gsk_render_node_reader_get_frame (reader, 0, NULL));
+      gsk_render_node_reader_free (reader);
+
+      return node;
+    }
+
   node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
 
   return node;
@@ -0,0 +1,1459 @@
+/* GSK - The GTK Scene Kit
+ *
+ * Copyright 2019  GNOME Foundation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The binary render node format
+ *
+ * The format is meant for recording lots of frames quickly, not for
+ * exchanging files between machines: all values are stored in host byte
+ * order and files from a host with a different byte order are rejected.
+ *
+ * A file starts with a 16 byte header:
+ *
+ *   guint8  magic[8]      "\x89GSKNODE"
+ *   guint32 version       GSK_RENDER_NODE_BINARY_VERSION
+ *   guint32 byte_order    0x01020304 in host byte order
+ *
+ * followed by any number of records. Every record starts at an offset
+ * that is a multiple of 8:
+ *
+ *   guint32 type          RECORD_TEXTURE, RECORD_NODE or RECORD_FRAME
+ *   guint32 size          size of the data, not including padding
+ *   guint8  data[size]
+ *   guint8  padding[]     up to the next multiple of 8
+ *
+ * Textures and nodes are numbered in the order their records appear
+ * and nodes refer to their children and textures by that number.
+ * Everything is only written once, so a subtree that is shared between
+ * frames - like the cached render node of a widget that did not change -
+ * only takes space in the first frame it appears in. Records only ever
+ * refer to earlier records, which allows appending frames to a file
+ * as they are recorded.
+ *
+ * Texture data is stored uncompressed and suitably aligned, so a file
+ * that is mapped into memory can be used without copying pixels.
+ */
+
+#include "config.h"
+
+#include "gskrendernodebinaryprivate.h"
+
+#include "gskrendernodeprivate.h"
+
+#include "gdk/gdktextureprivate.h"
+
+#include <pango/pangocairo.h>
+
+#include <math.h>
+#include <string.h>
+
+#define GSK_RENDER_NODE_BINARY_MAGIC "\x89GSKNODE"
+#define GSK_RENDER_NODE_BINARY_VERSION 1
+#define GSK_RENDER_NODE_BINARY_BYTE_ORDER 0x01020304
+
+#define HEADER_SIZE 16
+#define RECORD_HEADER_SIZE 8
+#define RECORD_ALIGN(size) (((size) + 7) & ~(gsize) 7)
+
+typedef enum {
+  RECORD_TEXTURE = 1,
+  RECORD_NODE,
+  RECORD_FRAME
+} RecordType;
+
+gboolean
+gsk_render_node_is_binary (GBytes *bytes)
+{
+  gsize size;
+  const guchar *data = g_bytes_get_data (bytes, &size);
+
+  return size >= strlen (GSK_RENDER_NODE_BINARY_MAGIC) &&
+         memcmp (data, GSK_RENDER_NODE_BINARY_MAGIC, strlen (GSK_RENDER_NODE_BINARY_MAGIC)) == 0;
+}
+
+struct _GskRenderNodeWriter
+{
+  GOutputStream *stream;
+
+  GHashTable *nodes;    /* GskRenderNode => index + 1 */
+  GHashTable *textures; /* GdkTexture => index + 1 */
+  guint n_nodes;
+  guint n_textures;
+
+  /* Records of the frame that is being written */
+  GByteArray *buffer;
+
+  guint header_written : 1;
+};
+
+/*< private >
+ * gsk_render_node_writer_new:
+ * @stream: the stream to write to
+ *
+ * Creates a new writer for the binary render node format. Use
+ * gsk_render_node_writer_add_frame() to write nodes to @stream.
+ *
+ * The writer keeps a reference to all nodes it has written, so that
+ * it can recognize them when they show up in later frames.
+ *
+ * Returns: (transfer full): a new writer
+ */
+GskRenderNodeWriter *
+gsk_render_node_writer_new (GOutputStream *stream)
+{
+  GskRenderNodeWriter *self;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), NULL);
+
+  self = g_slice_new0 (GskRenderNodeWriter);
+
+  self->stream = g_object_ref (stream);
+  self->nodes = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gsk_render_node_unref, NULL);
+  self->textures = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  self->buffer = g_byte_array_new ();
+
+  return self;
+}
+
+void
+gsk_render_node_writer_free (GskRenderNodeWriter *self)
+{
+  g_object_unref (self->stream);
+  g_hash_table_unref (self->nodes);
+  g_hash_table_unref (self->textures);
+  g_byte_array_unref (self->buffer);
+
+  g_slice_free (GskRenderNodeWriter, self);
+}
+
+static void
+append_data (GskRenderNodeWriter *self,
+             gconstpointer        data,
+             gsize                size)
+{
+  g_byte_array_append (self->buffer, data, size);
+}
+
+static void
+append_u32 (GskRenderNodeWriter *self,
+            guint32              value)
+{
+  append_data (self, &value, sizeof (value));
+}
+
+static void
+append_float (GskRenderNodeWriter *self,
+              float                value)
+{
+  append_data (self, &value, sizeof (value));
+}
+
+static void
+append_double (GskRenderNodeWriter *self,
+               double               value)
+{
+  append_data (self, &value, sizeof (value));
+}
+
+static void
+append_point (GskRenderNodeWriter    *self,
+              const graphene_point_t *point)
+{
+  append_float (self, point->x);
+  append_float (self, point->y);
+}
+
+static void
+append_rect (GskRenderNodeWriter   *self,
+             const graphene_rect_t *rect)
+{
+  append_float (self, rect->origin.x);
+  append_float (self, rect->origin.y);
+  append_float (self, rect->size.width);
+  append_float (self, rect->size.height);
+}
+
+static void
+append_rounded_rect (GskRenderNodeWriter  *self,
+                     const GskRoundedRect *rect)
+{
+  guint i;
+
+  append_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i ++)
+    {
+      append_float (self, rect->corner[i].width);
+      append_float (self, rect->corner[i].height);
+    }
+}
+
+static void
+append_rgba (GskRenderNodeWriter *self,
+             const GdkRGBA       *rgba)
+{
+  append_double (self, rgba->red);
+  append_double (self, rgba->green);
+  append_double (self, rgba->blue);
+  append_double (self, rgba->alpha);
+}
+
+static void
+append_string (GskRenderNodeWriter *self,
+               const char          *string)
+{
+  gsize len = strlen (string);
+
+  append_u32 (self, len);
+  append_data (self, string, len);
+}
+
+static gsize
+begin_record (GskRenderNodeWriter *self,
+              RecordType           type)
+{
+  gsize start = self->buffer->len;
+
+  append_u32 (self, type);
+  append_u32 (self, 0);
+
+  return start;
+}
+
+static void
+end_record (GskRenderNodeWriter *self,
+            gsize                start)
+{
+  guint32 size = self->buffer->len - start - RECORD_HEADER_SIZE;
+  static const guchar padding[8] = { 0, };
+
+  memcpy (self->buffer->data + start + sizeof (guint32), &size, sizeof (guint32));
+  append_data (self, padding, RECORD_ALIGN (self->buffer->len) - self->buffer->len);
+}
+
+static guint32
+write_texture (GskRenderNodeWriter *self,
+               GdkTexture          *texture)
+{
+  gpointer index;
+  gsize start, size;
+  int width, height;
+  gsize stride;
+
+  if (g_hash_table_lookup_extended (self->textures, texture, NULL, &index))
+    return GPOINTER_TO_UINT (index) - 1;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  stride = width * 4;
+
+  start = begin_record (self, RECORD_TEXTURE);
+  append_u32 (self, width);
+  append_u32 (self, height);
+  append_u32 (self, stride);
+  append_u32 (self, GDK_MEMORY_DEFAULT);
+
+  size = self->buffer->len;
+  g_byte_array_set_size (self->buffer, size + stride * height);
+  gdk_texture_download (texture, self->buffer->data + size, stride);
+  end_record (self, start);
+
+  g_hash_table_insert (self->textures, g_object_ref (texture), GUINT_TO_POINTER (self->n_textures + 1));
+
+  return self->n_textures++;
+}
+
+/* Cairo nodes can contain any kind of surface, so we just store
+ * what they look like. */
+static GdkTexture *
+texture_for_cairo_node (GskRenderNode *node)
+{
+  cairo_surface_t *surface;
+  GdkTexture *texture;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        ceilf (node->bounds.size.width),
+                                        ceilf (node->bounds.size.height));
+  cr = cairo_create (surface);
+  cairo_translate (cr, - node->bounds.origin.x, - node->bounds.origin.y);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+
+  texture = gdk_texture_new_for_surface (surface);
+  cairo_surface_destroy (surface);
+
+  return texture;
+}
+
+static gsize
+begin_node (GskRenderNodeWriter *self,
+            GskRenderNode       *node)
+{
+  gsize start = begin_record (self, RECORD_NODE);
+
+  append_u32 (self, gsk_render_node_get_node_type (node));
+  append_rect (self, &node->bounds);
+
+  return start;
+}
+
+static guint32
+write_node (GskRenderNodeWriter *self,
+            GskRenderNode       *node)
+{
+  gpointer index;
+  gsize start;
+
+  if (g_hash_table_lookup_extended (self->nodes, node, NULL, &index))
+    return GPOINTER_TO_UINT (index) - 1;
+
+  /* Children are always written before their parents, so
+   * their records need to be written before begin_node(). */
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n_children = gsk_container_node_get_n_children (node);
+        guint32 *children = g_new (guint32, n_children);
+
+        for (i = 0; i < n_children; i ++)
+          children[i] = write_node (self, gsk_container_node_get_child (node, i));
+
+        start = begin_node (self, node);
+        append_u32 (self, n_children);
+        append_data (self, children, sizeof (guint32) * n_children);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        guint32 texture = G_MAXUINT32;
+
+        if (gsk_cairo_node_peek_surface (node) != NULL &&
+            node->bounds.size.width >= 1 && node->bounds.size.height >= 1)
+          {
+            GdkTexture *t = texture_for_cairo_node (node);
+            texture = write_texture (self, t);
+            g_object_unref (t);
+          }
+
+        start = begin_node (self, node);
+        append_u32 (self, texture);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      start = begin_node (self, node);
+      append_rgba (self, gsk_color_node_peek_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        const GskColorStop *stops = gsk_linear_gradient_node_peek_color_stops (node);
+        gsize i, n_stops = gsk_linear_gradient_node_get_n_color_stops (node);
+
+        start = begin_node (self, node);
+        append_point (self, gsk_linear_gradient_node_peek_start (node));
+        append_point (self, gsk_linear_gradient_node_peek_end (node));
+        append_u32 (self, n_stops);
+        for (i = 0; i < n_stops; i ++)
+          {
+            append_double (self, stops[i].offset);
+            append_rgba (self, &stops[i].color);
+          }
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+        gsize i, n_stops = gsk_radial_gradient_node_get_n_color_stops (node);
+
+        start = begin_node (self, node);
+        append_point (self, gsk_radial_gradient_node_peek_center (node));
+        append_float (self, gsk_radial_gradient_node_get_hradius (node));
+        append_float (self, gsk_radial_gradient_node_get_vradius (node));
+        append_float (self, gsk_radial_gradient_node_get_start (node));
+        append_float (self, gsk_radial_gradient_node_get_end (node));
+        append_u32 (self, n_stops);
+        for (i = 0; i < n_stops; i ++)
+          {
+            append_double (self, stops[i].offset);
+            append_rgba (self, &stops[i].color);
+          }
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const float *widths = gsk_border_node_peek_widths (node);
+        const GdkRGBA *colors = gsk_border_node_peek_colors (node);
+        guint i;
+
+        start = begin_node (self, node);
+        append_rounded_rect (self, gsk_border_node_peek_outline (node));
+        for (i = 0; i < 4; i ++)
+          append_float (self, widths[i]);
+        for (i = 0; i < 4; i ++)
+          append_rgba (self, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        guint32 texture = write_texture (self, gsk_texture_node_get_texture (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, texture);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      start = begin_node (self, node);
+      append_rounded_rect (self, gsk_inset_shadow_node_peek_outline (node));
+      append_rgba (self, gsk_inset_shadow_node_peek_color (node));
+      append_float (self, gsk_inset_shadow_node_get_dx (node));
+      append_float (self, gsk_inset_shadow_node_get_dy (node));
+      append_float (self, gsk_inset_shadow_node_get_spread (node));
+      append_float (self, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      start = begin_node (self, node);
+      append_rounded_rect (self, gsk_outset_shadow_node_peek_outline (node));
+      append_rgba (self, gsk_outset_shadow_node_peek_color (node));
+      append_float (self, gsk_outset_shadow_node_get_dx (node));
+      append_float (self, gsk_outset_shadow_node_get_dy (node));
+      append_float (self, gsk_outset_shadow_node_get_spread (node));
+      append_float (self, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        guint32 child = write_node (self, gsk_transform_node_get_child (node));
+        char *transform = gsk_transform_to_string (gsk_transform_node_get_transform (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_string (self, transform);
+        g_free (transform);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        guint32 child = write_node (self, gsk_opacity_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_double (self, gsk_opacity_node_get_opacity (node));
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        guint32 child = write_node (self, gsk_color_matrix_node_get_child (node));
+        float values[16];
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        graphene_matrix_to_float (gsk_color_matrix_node_peek_color_matrix (node), values);
+        append_data (self, values, sizeof (float) * 16);
+        graphene_vec4_to_float (gsk_color_matrix_node_peek_color_offset (node), values);
+        append_data (self, values, sizeof (float) * 4);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        guint32 child = write_node (self, gsk_repeat_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_rect (self, gsk_repeat_node_peek_child_bounds (node));
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        guint32 child = write_node (self, gsk_clip_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_rect (self, gsk_clip_node_peek_clip (node));
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        guint32 child = write_node (self, gsk_rounded_clip_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_rounded_rect (self, gsk_rounded_clip_node_peek_clip (node));
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        guint32 child = write_node (self, gsk_shadow_node_get_child (node));
+        gsize i, n_shadows = gsk_shadow_node_get_n_shadows (node);
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_u32 (self, n_shadows);
+        for (i = 0; i < n_shadows; i ++)
+          {
+            const GskShadow *shadow = gsk_shadow_node_peek_shadow (node, i);
+
+            append_rgba (self, &shadow->color);
+            append_float (self, shadow->dx);
+            append_float (self, shadow->dy);
+            append_float (self, shadow->radius);
+          }
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        guint32 bottom = write_node (self, gsk_blend_node_get_bottom_child (node));
+        guint32 top = write_node (self, gsk_blend_node_get_top_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, bottom);
+        append_u32 (self, top);
+        append_u32 (self, gsk_blend_node_get_blend_mode (node));
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        guint32 start_child = write_node (self, gsk_cross_fade_node_get_start_child (node));
+        guint32 end_child = write_node (self, gsk_cross_fade_node_get_end_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, start_child);
+        append_u32 (self, end_child);
+        append_double (self, gsk_cross_fade_node_get_progress (node));
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        const PangoGlyphInfo *glyphs = gsk_text_node_peek_glyphs (node);
+        guint i, n_glyphs = gsk_text_node_get_num_glyphs (node);
+        PangoFontDescription *desc;
+        char *font_name;
+
+        desc = pango_font_describe ((PangoFont *) gsk_text_node_peek_font (node));
+        font_name = pango_font_description_to_string (desc);
+
+        start = begin_node (self, node);
+        append_string (self, font_name);
+        append_float (self, gsk_text_node_get_x (node));
+        append_float (self, gsk_text_node_get_y (node));
+        append_rgba (self, gsk_text_node_peek_color (node));
+        append_u32 (self, n_glyphs);
+        for (i = 0; i < n_glyphs; i ++)
+          {
+            append_u32 (self, glyphs[i].glyph);
+            append_u32 (self, glyphs[i].geometry.width);
+            append_u32 (self, glyphs[i].geometry.x_offset);
+            append_u32 (self, glyphs[i].geometry.y_offset);
+            append_u32 (self, glyphs[i].attr.is_cluster_start);
+          }
+
+        g_free (font_name);
+        pango_font_description_free (desc);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        guint32 child = write_node (self, gsk_blur_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_double (self, gsk_blur_node_get_radius (node));
+      }
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        guint32 child = write_node (self, gsk_debug_node_get_child (node));
+
+        start = begin_node (self, node);
+        append_u32 (self, child);
+        append_string (self, gsk_debug_node_get_message (node));
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+
+  end_record (self, start);
+
+  g_hash_table_insert (self->nodes, gsk_render_node_ref (node), GUINT_TO_POINTER (self->n_nodes + 1));
+
+  return self->n_nodes++;
+}
+
+/*< private >
+ * gsk_render_node_writer_add_frame:
+ * @self: a writer
+ * @node: the root node of the frame
+ * @timestamp: the time of the frame, in the same units as g_get_monotonic_time()
+ * @cancellable: (nullable): a #GCancellable
+ * @error: return location for an error
+ *
+ * Writes @node and all of its children, that have not been written
+ * before, and a frame pointing to @node to the stream of @self.
+ *
+ * If this function fails, the data written so far is incomplete and
+ * the writer should not be used anymore.
+ *
+ * Returns: %TRUE if the data was written successfully
+ */
+gboolean
+gsk_render_node_writer_add_frame (GskRenderNodeWriter  *self,
+                                  GskRenderNode        *node,
+                                  gint64                timestamp,
+                                  GCancellable         *cancellable,
+                                  GError              **error)
+{
+  guint32 root;
+  gsize start;
+  gboolean result;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), FALSE);
+
+  if (!self->header_written)
+    {
+      append_data (self, GSK_RENDER_NODE_BINARY_MAGIC, strlen (GSK_RENDER_NODE_BINARY_MAGIC));
+      append_u32 (self, GSK_RENDER_NODE_BINARY_VERSION);
+      append_u32 (self, GSK_RENDER_NODE_BINARY_BYTE_ORDER);
+      self->header_written = TRUE;
+    }
+
+  root = write_node (self, node);
+
+  start = begin_record (self, RECORD_FRAME);
+  append_data (self, &timestamp, sizeof (gint64));
+  append_u32 (self, root);
+  end_record (self, start);
+
+  result = g_output_stream_write_all (self->stream,
+                                      self->buffer->data,
+                                      self->buffer->len,
+                                      NULL,
+                                      cancellable,
+                                      error);
+  g_byte_array_set_size (self->buffer, 0);
+
+  return result;
+}
+
+typedef struct
+{
+  gint64 timestamp;
+  GskRenderNode *node;
+} Frame;
+
+struct _GskRenderNodeReader
+{
+  GBytes *bytes;
+
+  GPtrArray *nodes;
+  GPtrArray *textures;
+  GArray *frames;
+};
+
+typedef struct
+{
+  GskRenderNodeReader *reader;
+  const guchar *data;
+  gsize size;
+  gsize pos;
+  gboolean failed;
+} Cursor;
+
+static gconstpointer
+read_data (Cursor *cursor,
+           gsize   size)
+{
+  gconstpointer data;
+
+  if (cursor->failed || cursor->size - cursor->pos < size)
+    {
+      cursor->failed = TRUE;
+      return NULL;
+    }
+
+  data = cursor->data + cursor->pos;
+  cursor->pos += size;
+
+  return data;
+}
+
+static guint32
+read_u32 (Cursor *cursor)
+{
+  gconstpointer data = read_data (cursor, sizeof (guint32));
+  guint32 value = 0;
+
+  if (data)
+    memcpy (&value, data, sizeof (guint32));
+
+  return value;
+}
+
+static float
+read_float (Cursor *cursor)
+{
+  gconstpointer data = read_data (cursor, sizeof (float));
+  float value = 0;
+
+  if (data)
+    memcpy (&value, data, sizeof (float));
+
+  return value;
+}
+
+static double
+read_double (Cursor *cursor)
+{
+  gconstpointer data = read_data (cursor, sizeof (double));
+  double value = 0;
+
+  if (data)
+    memcpy (&value, data, sizeof (double));
+
+  return value;
+}
+
+static void
+read_point (Cursor           *cursor,
+            graphene_point_t *point)
+{
+  point->x = read_float (cursor);
+  point->y = read_float (cursor);
+}
+
+static void
+read_rect (Cursor          *cursor,
+           graphene_rect_t *rect)
+{
+  rect->origin.x = read_float (cursor);
+  rect->origin.y = read_float (cursor);
+  rect->size.width = read_float (cursor);
+  rect->size.height = read_float (cursor);
+}
+
+static void
+read_rounded_rect (Cursor         *cursor,
+                   GskRoundedRect *rect)
+{
+  guint i;
+
+  read_rect (cursor, &rect->bounds);
+  for (i = 0; i < 4; i ++)
+    {
+      rect->corner[i].width = read_float (cursor);
+      rect->corner[i].height = read_float (cursor);
+    }
+}
+
+static void
+read_rgba (Cursor  *cursor,
+           GdkRGBA *rgba)
+{
+  rgba->red = read_double (cursor);
+  rgba->green = read_double (cursor);
+  rgba->blue = read_double (cursor);
+  rgba->alpha = read_double (cursor);
+}
+
+static char *
+read_string (Cursor *cursor)
+{
+  guint32 len = read_u32 (cursor);
+  const char *data = read_data (cursor, len);
+
+  if (data == NULL)
+    return NULL;
+
+  return g_strndup (data, len);
+}
+
+/* Reads a count of items that take up at least @item_size bytes each,
+ * so we don't allocate huge amounts of memory for broken files. */
+static guint32
+read_count (Cursor *cursor,
+            gsize   item_size)
+{
+  guint32 count = read_u32 (cursor);
+
+  if ((cursor->size - cursor->pos) / item_size < count)
+    {
+      cursor->failed = TRUE;
+      return 0;
+    }
+
+  return count;
+}
+
+static GskRenderNode *
+read_node_ref (Cursor *cursor)
+{
+  guint32 index = read_u32 (cursor);
+
+  if (cursor->failed || index >= cursor->reader->nodes->len)
+    {
+      cursor->failed = TRUE;
+      return NULL;
+    }
+
+  return g_ptr_array_index (cursor->reader->nodes, index);
+}
+
+static GdkTexture *
+read_texture_ref (Cursor *cursor)
+{
+  guint32 index = read_u32 (cursor);
+
+  if (cursor->failed || index >= cursor->reader->textures->len)
+    {
+      cursor->failed = TRUE;
+      return NULL;
+    }
+
+  return g_ptr_array_index (cursor->reader->textures, index);
+}
+
+static GdkTexture *
+read_texture (Cursor *cursor)
+{
+  guint32 width, height, stride, format;
+  GdkTexture *texture;
+  GBytes *bytes;
+  gsize offset;
+
+  width = read_u32 (cursor);
+  height = read_u32 (cursor);
+  stride = read_u32 (cursor);
+  format = read_u32 (cursor);
+
+  if (cursor->failed ||
+      width == 0 || height == 0 || width > G_MAXINT / 4 || height > G_MAXINT ||
+      stride < width * 4 ||
+      format != GDK_MEMORY_DEFAULT)
+    return NULL;
+
+  offset = cursor->data + cursor->pos - (const guchar *) g_bytes_get_data (cursor->reader->bytes, NULL);
+  if (read_data (cursor, (gsize) stride * height) == NULL)
+    return NULL;
+
+  /* No copy, so this works straight from a mapped file */
+  bytes = g_bytes_new_from_bytes (cursor->reader->bytes, offset, (gsize) stride * height);
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static GskRenderNode *
+read_node (Cursor *cursor)
+{
+  GskRenderNodeType node_type;
+  graphene_rect_t bounds;
+  GskRenderNode *node = NULL;
+
+  node_type = read_u32 (cursor);
+  read_rect (cursor, &bounds);
+
+  if (cursor->failed)
+    return NULL;
+
+  switch (node_type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n_children = read_count (cursor, sizeof (guint32));
+        GskRenderNode **children = g_new (GskRenderNode *, MAX (n_children, 1));
+
+        for (i = 0; i < n_children; i ++)
+          children[i] = read_node_ref (cursor);
+
+        if (!cursor->failed)
+          node = gsk_container_node_new (children, n_children);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        guint32 index = read_u32 (cursor);
+        cairo_surface_t *surface;
+
+        if (cursor->failed)
+          break;
+
+        if (index == G_MAXUINT32)
+          {
+            node = gsk_cairo_node_new (&bounds);
+            break;
+          }
+
+        if (index >= cursor->reader->textures->len)
+          break;
+
+        surface = gdk_texture_download_surface (g_ptr_array_index (cursor->reader->textures, index));
+        node = gsk_cairo_node_new_for_surface (&bounds, surface);
+        cairo_surface_destroy (surface);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      {
+        GdkRGBA color;
+
+        read_rgba (cursor, &color);
+        if (!cursor->failed)
+          node = gsk_color_node_new (&color, &bounds);
+      }
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_point_t start, end;
+        GskColorStop *stops;
+        guint i, n_stops;
+
+        read_point (cursor, &start);
+        read_point (cursor, &end);
+        n_stops = read_count (cursor, sizeof (double) * 5);
+        if (cursor->failed || n_stops < 2)
+          break;
+
+        stops = g_new (GskColorStop, n_stops);
+        for (i = 0; i < n_stops; i ++)
+          {
+            stops[i].offset = read_double (cursor);
+            read_rgba (cursor, &stops[i].color);
+          }
+
+        if (!cursor->failed)
+          {
+            if (node_type == GSK_LINEAR_GRADIENT_NODE)
+              node = gsk_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+            else
+              node = gsk_repeating_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+          }
+        g_free (stops);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        GskColorStop *stops;
+        guint i, n_stops;
+
+        read_point (cursor, &center);
+        hradius = read_float (cursor);
+        vradius = read_float (cursor);
+        start = read_float (cursor);
+        end = read_float (cursor);
+        n_stops = read_count (cursor, sizeof (double) * 5);
+        if (cursor->failed || n_stops < 2 ||
+            !(hradius > 0 && vradius > 0 && start >= 0 && end > start))
+          break;
+
+        stops = g_new (GskColorStop, n_stops);
+        for (i = 0; i < n_stops; i ++)
+          {
+            stops[i].offset = read_double (cursor);
+            read_rgba (cursor, &stops[i].color);
+          }
+
+        if (!cursor->failed)
+          {
+            if (node_type == GSK_RADIAL_GRADIENT_NODE)
+              node = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+            else
+              node = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+          }
+        g_free (stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+        guint i;
+
+        read_rounded_rect (cursor, &outline);
+        for (i = 0; i < 4; i ++)
+          widths[i] = read_float (cursor);
+        for (i = 0; i < 4; i ++)
+          read_rgba (cursor, &colors[i]);
+
+        if (!cursor->failed)
+          node = gsk_border_node_new (&outline, widths, colors);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = read_texture_ref (cursor);
+
+        if (texture)
+          node = gsk_texture_node_new (texture, &bounds);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float dx, dy, spread, blur;
+
+        read_rounded_rect (cursor, &outline);
+        read_rgba (cursor, &color);
+        dx = read_float (cursor);
+        dy = read_float (cursor);
+        spread = read_float (cursor);
+        blur = read_float (cursor);
+
+        if (cursor->failed)
+          break;
+
+        if (node_type == GSK_INSET_SHADOW_NODE)
+          node = gsk_inset_shadow_node_new (&outline, &color, dx, dy, spread, blur);
+        else
+          node = gsk_outset_shadow_node_new (&outline, &color, dx, dy, spread, blur);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        char *string = read_string (cursor);
+        GskTransform *transform = NULL;
+
+        if (!cursor->failed && gsk_transform_parse (string, &transform))
+          node = gsk_transform_node_new (child, transform);
+
+        gsk_transform_unref (transform);
+        g_free (string);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        double opacity = read_double (cursor);
+
+        if (!cursor->failed)
+          node = gsk_opacity_node_new (child, opacity);
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        const float *values = read_data (cursor, sizeof (float) * 20);
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        float v[20];
+
+        if (cursor->failed)
+          break;
+
+        memcpy (v, values, sizeof (v));
+        graphene_matrix_init_from_float (&matrix, v);
+        graphene_vec4_init_from_float (&offset, v + 16);
+        node = gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        graphene_rect_t child_bounds;
+
+        read_rect (cursor, &child_bounds);
+        if (!cursor->failed)
+          node = gsk_repeat_node_new (&bounds, child, &child_bounds);
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        graphene_rect_t clip;
+
+        read_rect (cursor, &clip);
+        if (!cursor->failed)
+          node = gsk_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        GskRoundedRect clip;
+
+        read_rounded_rect (cursor, &clip);
+        if (!cursor->failed)
+          node = gsk_rounded_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        guint i, n_shadows = read_count (cursor, sizeof (double) * 4 + sizeof (float) * 3);
+        GskShadow *shadows;
+
+        if (cursor->failed || n_shadows == 0)
+          break;
+
+        shadows = g_new (GskShadow, n_shadows);
+        for (i = 0; i < n_shadows; i ++)
+          {
+            read_rgba (cursor, &shadows[i].color);
+            shadows[i].dx = read_float (cursor);
+            shadows[i].dy = read_float (cursor);
+            shadows[i].radius = read_float (cursor);
+          }
+
+        if (!cursor->failed)
+          node = gsk_shadow_node_new (child, shadows, n_shadows);
+        g_free (shadows);
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        GskRenderNode *bottom = read_node_ref (cursor);
+        GskRenderNode *top = read_node_ref (cursor);
+        GskBlendMode mode = read_u32 (cursor);
+
+        if (!cursor->failed && mode <= GSK_BLEND_MODE_LUMINOSITY)
+          node = gsk_blend_node_new (bottom, top, mode);
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        GskRenderNode *start = read_node_ref (cursor);
+        GskRenderNode *end = read_node_ref (cursor);
+        double progress = read_double (cursor);
+
+        if (!cursor->failed)
+          node = gsk_cross_fade_node_new (start, end, progress);
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFontDescription *desc;
+        PangoFontMap *font_map;
+        PangoContext *context;
+        PangoFont *font;
+        PangoGlyphString *glyphs;
+        char *font_name;
+        GdkRGBA color;
+        float x, y;
+        guint i, n_glyphs;
+
+        font_name = read_string (cursor);
+        x = read_float (cursor);
+        y = read_float (cursor);
+        read_rgba (cursor, &color);
+        n_glyphs = read_count (cursor, sizeof (guint32) * 5);
+
+        if (cursor->failed || n_glyphs == 0)
+          {
+            g_free (font_name);
+            break;
+          }
+
+        glyphs = pango_glyph_string_new ();
+        pango_glyph_string_set_size (glyphs, n_glyphs);
+        for (i = 0; i < n_glyphs; i ++)
+          {
+            glyphs->glyphs[i].glyph = read_u32 (cursor);
+            glyphs->glyphs[i].geometry.width = (gint32) read_u32 (cursor);
+            glyphs->glyphs[i].geometry.x_offset = (gint32) read_u32 (cursor);
+            glyphs->glyphs[i].geometry.y_offset = (gint32) read_u32 (cursor);
+            glyphs->glyphs[i].attr.is_cluster_start = read_u32 (cursor);
+          }
+
+        desc = pango_font_description_from_string (font_name);
+        font_map = pango_cairo_font_map_get_default ();
+        context = pango_font_map_create_context (font_map);
+        font = pango_font_map_load_font (font_map, context, desc);
+
+        if (!cursor->failed && font != NULL)
+          node = gsk_text_node_new (font, glyphs, &color, x, y);
+
+        g_clear_object (&font);
+        g_object_unref (context);
+        pango_font_description_free (desc);
+        pango_glyph_string_free (glyphs);
+        g_free (font_name);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        double radius = read_double (cursor);
+
+        if (!cursor->failed)
+          node = gsk_blur_node_new (child, radius);
+      }
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        GskRenderNode *child = read_node_ref (cursor);
+        char *message = read_string (cursor);
+
+        if (!cursor->failed)
+          node = gsk_debug_node_new (child, message);
+        else
+          g_free (message);
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      break;
+    }
+
+  return node;
+}
+
+static gboolean
+gsk_render_node_reader_load (GskRenderNodeReader  *self,
+                             GError              **error)
+{
+  const guchar *data;
+  gsize size, pos;
+  guint32 version, byte_order;
+
+  data = g_bytes_get_data (self->bytes, &size);
+
+  if (!gsk_render_node_is_binary (self->bytes) || size < HEADER_SIZE)
+    {
+      g_set_error_literal (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                           "Data is not in the binary render node format");
+      return FALSE;
+    }
+
+  memcpy (&version, data + 8, sizeof (guint32));
+  memcpy (&byte_order, data + 12, sizeof (guint32));
+
+  if (byte_order != GSK_RENDER_NODE_BINARY_BYTE_ORDER)
+    {
+      g_set_error_literal (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                           "Data was written on a machine with a different byte order");
+      return FALSE;
+    }
+
+  if (version != GSK_RENDER_NODE_BINARY_VERSION)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                   "Unsupported version %u of the binary render node format", version);
+      return FALSE;
+    }
+
+  for (pos = HEADER_SIZE; pos < size; )
+    {
+      Cursor cursor = { self, };
+      guint32 type, record_size;
+
+      if (size - pos < RECORD_HEADER_SIZE)
+        goto fail;
+
+      memcpy (&type, data + pos, sizeof (guint32));
+      memcpy (&record_size, data + pos + sizeof (guint32), sizeof (guint32));
+      if (size - pos - RECORD_HEADER_SIZE < record_size)
+        goto fail;
+
+      cursor.data = data + pos + RECORD_HEADER_SIZE;
+      cursor.size = record_size;
+
+      switch ((RecordType) type)
+        {
+        case RECORD_TEXTURE:
+          {
+            GdkTexture *texture = read_texture (&cursor);
+
+            if (texture == NULL)
+              goto fail;
+
+            g_ptr_array_add (self->textures, texture);
+          }
+          break;
+
+        case RECORD_NODE:
+          {
+            GskRenderNode *node = read_node (&cursor);
+
+            if (node == NULL)
+              goto fail;
+
+            g_ptr_array_add (self->nodes, node);
+          }
+          break;
+
+        case RECORD_FRAME:
+          {
+            const gint64 *timestamp = read_data (&cursor, sizeof (gint64));
+            Frame frame;
+
+            frame.node = read_node_ref (&cursor);
+            if (cursor.failed)
+              goto fail;
+
+            memcpy (&frame.timestamp, timestamp, sizeof (gint64));
+            gsk_render_node_ref (frame.node);
+            g_array_append_val (self->frames, frame);
+          }
+          break;
+
+        default:
+          /* Unknown records can be skipped */
+          break;
+        }
+
+      pos += RECORD_ALIGN (RECORD_HEADER_SIZE + record_size);
+    }
+
+  return TRUE;
+
+fail:
+  g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA,
+               "Invalid data at offset %" G_GSIZE_FORMAT, pos);
+  return FALSE;
+}
+
+static void
+frame_clear (gpointer data)
+{
+  Frame *frame = data;
+
+  gsk_render_node_unref (frame->node);
+}
+
+/*< private >
+ * gsk_render_node_reader_new:
+ * @bytes: data in the binary render node format
+ * @error: return location for an error
+ *
+ * Loads all frames from @bytes. Texture data is not copied, so if @bytes
+ * comes from a #GMappedFile, pixels are only read from disk when they are
+ * needed.
+ *
+ * Returns: (nullable) (transfer full): a new reader or %NULL on error
+ */
+GskRenderNodeReader *
+gsk_render_node_reader_new (GBytes  *bytes,
+                            GError **error)
+{
+  GskRenderNodeReader *self;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  self = g_slice_new0 (GskRenderNodeReader);
+
+  self->bytes = g_bytes_ref (bytes);
+  self->nodes = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_render_node_unref);
+  self->textures = g_ptr_array_new_with_free_func (g_object_unref);
+  self->frames = g_array_new (FALSE, FALSE, sizeof (Frame));
+  g_array_set_clear_func (self->frames, frame_clear);
+
+  if (!gsk_render_node_reader_load (self, error))
+    {
+      gsk_render_node_reader_free (self);
+      return NULL;
+    }
+
+  /* Nodes that are not part of a frame are not needed anymore */
+  g_ptr_array_set_size (self->nodes, 0);
+  g_ptr_array_set_size (self->textures, 0);
+
+  return self;
+}
+
+void
+gsk_render_node_reader_free (GskRenderNodeReader *self)
+{
+  g_bytes_unref (self->bytes);
+  g_ptr_array_unref (self->nodes);
+  g_ptr_array_unref (self->textures);
+  g_array_unref (self->frames);
+
+  g_slice_free (GskRenderNodeReader, self);
+}
+
+guint
+gsk_render_node_reader_get_n_frames (GskRenderNodeReader *self)
+{
+  return self->frames->len;
+}
+
+/*< private >
+ * gsk_render_node_reader_get_frame:
+ * @self: a reader
+ * @i: the index of the frame
+ * @timestamp: (out) (optional): return location for the time of the frame
+ *
+ * Returns: (transfer none): the root node of the frame
+ */
+GskRenderNode *
+gsk_render_node_reader_get_frame (GskRenderNodeReader *self,
+                                  guint                i,
+                                  gint64              *timestamp)
+{
+  Frame *frame;
+
+  g_return_val_if_fail (i < self->frames->len, NULL);
+
+  frame = &g_array_index (self->frames, Frame, i);
+
+  if (timestamp)
+    *timestamp = frame->timestamp;
+
+  return frame->node;
+}
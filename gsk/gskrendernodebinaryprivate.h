@@ -0,0 +1,31 @@
+#ifndef __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+#define __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+
+#include "gskrendernode.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GskRenderNodeWriter GskRenderNodeWriter;
+typedef struct _GskRenderNodeReader GskRenderNodeReader;
+
+gboolean                gsk_render_node_is_binary               (GBytes                 *bytes);
+
+GskRenderNodeWriter *   gsk_render_node_writer_new              (GOutputStream          *stream);
+void                    gsk_render_node_writer_free             (GskRenderNodeWriter    *self);
+gboolean                gsk_render_node_writer_add_frame        (GskRenderNodeWriter    *self,
+                                                                 GskRenderNode          *node,
+                                                                 gint64                  timestamp,
+                                                                 GCancellable           *cancellable,
+                                                                 GError                **error);
+
+GskRenderNodeReader *   gsk_render_node_reader_new              (GBytes                 *bytes,
+                                                                 GError                **error);
+void                    gsk_render_node_reader_free             (GskRenderNodeReader    *self);
+guint                   gsk_render_node_reader_get_n_frames     (GskRenderNodeReader    *self);
+GskRenderNode *         gsk_render_node_reader_get_frame        (GskRenderNodeReader    *self,
+                                                                 guint                   i,
+                                                                 gint64                 *timestamp);
+
+G_END_DECLS
+
+#endif /* __GSK_RENDER_NODE_BINARY_PRIVATE_H__ */
@@ -27,6 +27,7 @@
 #include "gskroundedrectprivate.h"
 #include "gsktransformprivate.h"
 
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdktextureprivate.h"
 
 static void
@@ -365,6 +366,297 @@ gsk_linear_gradient_node_peek_color_stops (GskRenderNode *node)
   return self->stops;
 }
 
+/*** GSK_RADIAL_GRADIENT_NODE ***/
+
+typedef struct _GskRadialGradientNode GskRadialGradientNode;
+
+struct _GskRadialGradientNode
+{
+  GskRenderNode render_node;
+
+  graphene_point_t center;
+  float hradius;
+  float vradius;
+  float start;
+  float end;
+
+  gsize n_stops;
+  GskColorStop stops[];
+};
+
+static void
+gsk_radial_gradient_node_finalize (GskRenderNode *node)
+{
+}
+
+static void
+gsk_radial_gradient_node_draw (GskRenderNode *node,
+                               cairo_t       *cr)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+  cairo_pattern_t *pattern;
+  cairo_matrix_t matrix;
+  gsize i;
+
+  pattern = cairo_pattern_create_radial (0, 0, self->hradius * self->start,
+                                         0, 0, self->hradius * self->end);
+
+  /* Ellipses are circles in the pattern space */
+  cairo_matrix_init_scale (&matrix, 1.0, self->hradius / self->vradius);
+  cairo_matrix_translate (&matrix, - self->center.x, - self->center.y);
+  cairo_pattern_set_matrix (pattern, &matrix);
+
+  if (gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE)
+    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_REPEAT);
+  else
+    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+
+  for (i = 0; i < self->n_stops; i++)
+    {
+      cairo_pattern_add_color_stop_rgba (pattern,
+                                         self->stops[i].offset,
+                                         self->stops[i].color.red,
+                                         self->stops[i].color.green,
+                                         self->stops[i].color.blue,
+                                         self->stops[i].color.alpha);
+    }
+
+  cairo_set_source (cr, pattern);
+  cairo_pattern_destroy (pattern);
+
+  cairo_rectangle (cr,
+                   node->bounds.origin.x, node->bounds.origin.y,
+                   node->bounds.size.width, node->bounds.size.height);
+  cairo_fill (cr);
+}
+
+static void
+gsk_radial_gradient_node_diff (GskRenderNode  *node1,
+                               GskRenderNode  *node2,
+                               cairo_region_t *region)
+{
+  GskRadialGradientNode *self1 = (GskRadialGradientNode *) node1;
+  GskRadialGradientNode *self2 = (GskRadialGradientNode *) node2;
+
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      graphene_point_equal (&self1->center, &self2->center) &&
+      self1->hradius == self2->hradius &&
+      self1->vradius == self2->vradius &&
+      self1->start == self2->start &&
+      self1->end == self2->end &&
+      self1->n_stops == self2->n_stops)
+    {
+      gsize i;
+
+      for (i = 0; i < self1->n_stops; i++)
+        {
+          GskColorStop *stop1 = &self1->stops[i];
+          GskColorStop *stop2 = &self2->stops[i];
+
+          if (stop1->offset == stop2->offset &&
+              gdk_rgba_equal (&stop1->color, &stop2->color))
+            continue;
+
+          gsk_render_node_diff_impossible (node1, node2, region);
+          return;
+        }
+
+      return;
+    }
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
+static const GskRenderNodeClass GSK_RADIAL_GRADIENT_NODE_CLASS = {
+  GSK_RADIAL_GRADIENT_NODE,
+  sizeof (GskRadialGradientNode),
+  "GskRadialGradientNode",
+  gsk_radial_gradient_node_finalize,
+  gsk_radial_gradient_node_draw,
+  gsk_render_node_can_diff_true,
+  gsk_radial_gradient_node_diff,
+};
+
+static const GskRenderNodeClass GSK_REPEATING_RADIAL_GRADIENT_NODE_CLASS = {
+  GSK_REPEATING_RADIAL_GRADIENT_NODE,
+  sizeof (GskRadialGradientNode),
+  "GskRepeatingRadialGradientNode",
+  gsk_radial_gradient_node_finalize,
+  gsk_radial_gradient_node_draw,
+  gsk_render_node_can_diff_true,
+  gsk_radial_gradient_node_diff,
+};
+
+static GskRenderNode *
+gsk_radial_gradient_node_new_for_class (const GskRenderNodeClass *node_class,
+                                        const graphene_rect_t    *bounds,
+                                        const graphene_point_t   *center,
+                                        float                     hradius,
+                                        float                     vradius,
+                                        float                     start,
+                                        float                     end,
+                                        const GskColorStop       *color_stops,
+                                        gsize                     n_color_stops)
+{
+  GskRadialGradientNode *self;
+  gsize i;
+
+  g_return_val_if_fail (bounds != NULL, NULL);
+  g_return_val_if_fail (center != NULL, NULL);
+  g_return_val_if_fail (hradius > 0., NULL);
+  g_return_val_if_fail (vradius > 0., NULL);
+  g_return_val_if_fail (start >= 0., NULL);
+  g_return_val_if_fail (end > start, NULL);
+  g_return_val_if_fail (color_stops != NULL, NULL);
+  g_return_val_if_fail (n_color_stops >= 2, NULL);
+  g_return_val_if_fail (color_stops[0].offset >= 0, NULL);
+  for (i = 1; i < n_color_stops; i++)
+    g_return_val_if_fail (color_stops[i].offset >= color_stops[i-1].offset, NULL);
+  g_return_val_if_fail (color_stops[n_color_stops - 1].offset <= 1, NULL);
+
+  self = (GskRadialGradientNode *) gsk_render_node_new (node_class, sizeof (GskColorStop) * n_color_stops);
+
+  graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
+  graphene_point_init_from_point (&self->center, center);
+  self->hradius = hradius;
+  self->vradius = vradius;
+  self->start = start;
+  self->end = end;
+
+  memcpy (&self->stops, color_stops, sizeof (GskColorStop) * n_color_stops);
+  self->n_stops = n_color_stops;
+
+  return &self->render_node;
+}
+
+/**
+ * gsk_radial_gradient_node_new:
+ * @bounds: the bounds of the node
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius
+ * @vradius: the vertical radius
+ * @start: a percentage >= 0 that defines the start of the gradient around @center
+ * @end: a percentage > @start that defines the end of the gradient around @center
+ * @color_stops: (array length=n_color_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_color_stops: the number of elements in @color_stops
+ *
+ * Creates a #GskRenderNode that draws a radial gradient. The radial gradient
+ * starts around @center. The size of the gradient is dictated by @hradius
+ * in horizontal orientation and by @vradius in vertical orientation.
+ *
+ * The color stops are spread between @start and @end, which are fractions
+ * of the radii. Outside of that range, the colors of the first and last
+ * color stop are used.
+ *
+ * Returns: A new #GskRenderNode
+ */
+GskRenderNode *
+gsk_radial_gradient_node_new (const graphene_rect_t  *bounds,
+                              const graphene_point_t *center,
+                              float                   hradius,
+                              float                   vradius,
+                              float                   start,
+                              float                   end,
+                              const GskColorStop     *color_stops,
+                              gsize                   n_color_stops)
+{
+  return gsk_radial_gradient_node_new_for_class (&GSK_RADIAL_GRADIENT_NODE_CLASS,
+                                                 bounds, center,
+                                                 hradius, vradius,
+                                                 start, end,
+                                                 color_stops, n_color_stops);
+}
+
+/**
+ * gsk_repeating_radial_gradient_node_new:
+ * @bounds: the bounds of the node
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius
+ * @vradius: the vertical radius
+ * @start: a percentage >= 0 that defines the start of the gradient around @center
+ * @end: a percentage > @start that defines the end of the gradient around @center
+ * @color_stops: (array length=n_color_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_color_stops: the number of elements in @color_stops
+ *
+ * Creates a #GskRenderNode that draws a radial gradient like
+ * gsk_radial_gradient_node_new(), but repeats the color stops
+ * between @start and @end to the center and beyond @end.
+ *
+ * Returns: A new #GskRenderNode
+ */
+GskRenderNode *
+gsk_repeating_radial_gradient_node_new (const graphene_rect_t  *bounds,
+                                        const graphene_point_t *center,
+                                        float                   hradius,
+                                        float                   vradius,
+                                        float                   start,
+                                        float                   end,
+                                        const GskColorStop     *color_stops,
+                                        gsize                   n_color_stops)
+{
+  return gsk_radial_gradient_node_new_for_class (&GSK_REPEATING_RADIAL_GRADIENT_NODE_CLASS,
+                                                 bounds, center,
+                                                 hradius, vradius,
+                                                 start, end,
+                                                 color_stops, n_color_stops);
+}
+
+const graphene_point_t *
+gsk_radial_gradient_node_peek_center (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return &self->center;
+}
+
+float
+gsk_radial_gradient_node_get_hradius (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->hradius;
+}
+
+float
+gsk_radial_gradient_node_get_vradius (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->vradius;
+}
+
+float
+gsk_radial_gradient_node_get_start (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->start;
+}
+
+float
+gsk_radial_gradient_node_get_end (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->end;
+}
+
+gsize
+gsk_radial_gradient_node_get_n_color_stops (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->n_stops;
+}
+
+const GskColorStop *
+gsk_radial_gradient_node_peek_color_stops (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->stops;
+}
+
 /*** GSK_BORDER_NODE ***/
 
 typedef struct _GskBorderNode GskBorderNode;
@@ -821,6 +1113,8 @@ corner_mask_equal (CornerMask *mask1,
     mask1->corner.height == mask2->corner.height;
 }
 
+G_LOCK_DEFINE_STATIC (corner_mask_cache);
+
 static void
 draw_shadow_corner (cairo_t               *cr,
                     gboolean               inset,
@@ -927,6 +1221,9 @@ draw_shadow_corner (cairo_t               *cr,
    * mask, so we cache rendered masks based on the blur radius and the
    * corner radius.
    */
+  /* The cairo renderer may draw from multiple threads */
+  G_LOCK (corner_mask_cache);
+
   if (corner_mask_cache == NULL)
     corner_mask_cache = g_hash_table_new_full ((GHashFunc)corner_mask_hash,
                                                (GEqualFunc)corner_mask_equal,
@@ -951,6 +1248,9 @@ draw_shadow_corner (cairo_t               *cr,
       g_hash_table_insert (corner_mask_cache, g_memdup (&key, sizeof (key)), mask);
     }
 
+  /* Masks never leave the cache, so we can use it unlocked */
+  G_UNLOCK (corner_mask_cache);
+
   gdk_cairo_set_source_rgba (cr, color);
   pattern = cairo_pattern_create_for_surface (mask);
   cairo_matrix_init_identity (&matrix);
@@ -1773,6 +2073,149 @@ gsk_container_node_get_diff_settings (void)
   return settings;
 }
 
+/* Containers with at least this many children first try to match
+ * their children by key, see gsk_container_node_diff_keyed() */
+#define GSK_CONTAINER_NODE_KEYED_DIFF_MIN 32
+
+/* Widgets keep their render node between frames, but their parent
+ * wraps it in new transform and debug nodes every time, so the node
+ * inside of those identifies the child.
+ */
+static gconstpointer
+gsk_container_node_get_child_key (GskRenderNode *node)
+{
+  while (TRUE)
+    {
+      switch (gsk_render_node_get_node_type (node))
+        {
+        case GSK_TRANSFORM_NODE:
+          node = gsk_transform_node_get_child (node);
+          break;
+
+        case GSK_DEBUG_NODE:
+          node = gsk_debug_node_get_child (node);
+          break;
+
+        default:
+          return node;
+        }
+    }
+}
+
+/* Diffs a range of children of two containers with the generic diff.
+ * If that gives up, all of them are changed, but not the whole container.
+ */
+static void
+gsk_container_node_diff_range (GskRenderNode  **children1,
+                               guint            n_children1,
+                               GskRenderNode  **children2,
+                               guint            n_children2,
+                               cairo_region_t  *region)
+{
+  guint i;
+
+  if (gsk_diff ((gconstpointer *) children1,
+                n_children1,
+                (gconstpointer *) children2,
+                n_children2,
+                gsk_container_node_get_diff_settings (),
+                region) == GSK_DIFF_OK)
+    return;
+
+  for (i = 0; i < n_children1; i++)
+    gsk_render_node_add_to_region (children1[i], region);
+  for (i = 0; i < n_children2; i++)
+    gsk_render_node_add_to_region (children2[i], region);
+}
+
+/* Matches children with the same key in linear time and only uses
+ * the generic diff for the children between those. This keeps long
+ * lists where rows are added or removed from aborting the diff, and a
+ * row that only moved is diffed against itself, so just its old and
+ * new position are damaged.
+ *
+ * Returns FALSE if the children can't be matched this way, because
+ * keys are used twice or the children were reordered.
+ */
+static gboolean
+gsk_container_node_diff_keyed (GskContainerNode *self1,
+                               GskContainerNode *self2,
+                               cairo_region_t   *region)
+{
+  GHashTable *keys;
+  guint *matches;
+  guint i, j, start1, start2, last, n_matches;
+
+  keys = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < self1->n_children; i++)
+    {
+      if (!g_hash_table_insert (keys,
+                                (gpointer) gsk_container_node_get_child_key (self1->children[i]),
+                                GUINT_TO_POINTER (i + 1)))
+        {
+          g_hash_table_unref (keys);
+          return FALSE;
+        }
+    }
+
+  /* matches[j] is 1 + the index of the matching child of self1, or 0 */
+  matches = g_new (guint, self2->n_children);
+  last = 0;
+  n_matches = 0;
+  for (j = 0; j < self2->n_children; j++)
+    {
+      matches[j] = GPOINTER_TO_UINT (g_hash_table_lookup (keys, gsk_container_node_get_child_key (self2->children[j])));
+      if (matches[j] == 0)
+        continue;
+
+      if (matches[j] <= last)
+        {
+          g_free (matches);
+          g_hash_table_unref (keys);
+          return FALSE;
+        }
+
+      last = matches[j];
+      n_matches++;
+    }
+
+  g_hash_table_unref (keys);
+
+  if (n_matches == 0)
+    {
+      g_free (matches);
+      return FALSE;
+    }
+
+  start1 = 0;
+  start2 = 0;
+  for (j = 0; j < self2->n_children; j++)
+    {
+      if (matches[j] == 0)
+        continue;
+
+      i = matches[j] - 1;
+      if (start1 < i || start2 < j)
+        gsk_container_node_diff_range (self1->children + start1, i - start1,
+                                       self2->children + start2, j - start2,
+                                       region);
+
+      gsk_render_node_diff (self1->children[i], self2->children[j], region);
+
+      start1 = i + 1;
+      start2 = j + 1;
+    }
+
+  if (start1 < self1->n_children || start2 < self2->n_children)
+    gsk_container_node_diff_range (self1->children + start1, self1->n_children - start1,
+                                   self2->children + start2, self2->n_children - start2,
+                                   region);
+
+  g_free (matches);
+
+  return TRUE;
+}
+
 static void
 gsk_container_node_diff (GskRenderNode  *node1,
                          GskRenderNode  *node2,
@@ -1781,6 +2224,11 @@ gsk_container_node_diff (GskRenderNode  *node1,
   GskContainerNode *self1 = (GskContainerNode *) node1;
   GskContainerNode *self2 = (GskContainerNode *) node2;
 
+  if (self1->n_children >= GSK_CONTAINER_NODE_KEYED_DIFF_MIN &&
+      self2->n_children >= GSK_CONTAINER_NODE_KEYED_DIFF_MIN &&
+      gsk_container_node_diff_keyed (self1, self2, region))
+    return;
+
   if (gsk_diff ((gconstpointer *) self1->children,
                 self1->n_children,
                 (gconstpointer *) self2->children,
@@ -1887,6 +2335,134 @@ gsk_container_node_get_child (GskRenderNode *node,
   return container->children[idx];
 }
 
+/* Finds a rectangle that @node covers with opaque pixels. This only
+ * looks through nodes that don't change what their child draws, so
+ * it stays cheap enough to call for every child of a container.
+ */
+gboolean
+gsk_render_node_get_opaque_rect (GskRenderNode   *node,
+                                 graphene_rect_t *rect)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_COLOR_NODE:
+      if (gsk_color_node_peek_color (node)->alpha < 1.0f)
+        return FALSE;
+      *rect = node->bounds;
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = gsk_texture_node_get_texture (node);
+
+        if (!GDK_IS_MEMORY_TEXTURE (texture))
+          return FALSE;
+
+        switch (gdk_memory_texture_get_format (GDK_MEMORY_TEXTURE (texture)))
+          {
+          case GDK_MEMORY_R8G8B8:
+          case GDK_MEMORY_B8G8R8:
+            *rect = node->bounds;
+            return TRUE;
+
+          default:
+            return FALSE;
+          }
+      }
+
+    case GSK_DEBUG_NODE:
+      return gsk_render_node_get_opaque_rect (gsk_debug_node_get_child (node), rect);
+
+    case GSK_CLIP_NODE:
+      if (!gsk_render_node_get_opaque_rect (gsk_clip_node_get_child (node), rect))
+        return FALSE;
+      return graphene_rect_intersection (rect, gsk_clip_node_peek_clip (node), rect);
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskTransform *transform = gsk_transform_node_get_transform (node);
+        float dx, dy;
+
+        if (gsk_transform_get_category (transform) < GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
+          return FALSE;
+
+        if (!gsk_render_node_get_opaque_rect (gsk_transform_node_get_child (node), rect))
+          return FALSE;
+
+        gsk_transform_to_translate (transform, &dx, &dy);
+        graphene_rect_offset (rect, dx, dy);
+        return TRUE;
+      }
+
+    default:
+      return FALSE;
+    }
+}
+
+/* Marks the children of @node from @first on that are completely
+ * covered by opaque children drawn after them, so renderers can skip
+ * drawing them. @hidden needs room for a flag per child from @first
+ * on. Returns the number of hidden children.
+ */
+guint
+gsk_container_node_get_hidden_children (GskRenderNode *node,
+                                        guint          first,
+                                        guint8        *hidden)
+{
+  GskContainerNode *container = (GskContainerNode *) node;
+  cairo_region_t *opaque = NULL;
+  graphene_rect_t rect;
+  guint i, n_hidden = 0;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE_TYPE (node, GSK_CONTAINER_NODE), 0);
+
+  /* From the top down, so the region holds what covers each child */
+  for (i = container->n_children; i-- > first; )
+    {
+      GskRenderNode *child = container->children[i];
+      cairo_rectangle_int_t extents;
+
+      hidden[i - first] = FALSE;
+
+      if (opaque != NULL)
+        {
+          /* Round outwards, so partly covered pixels count as visible */
+          extents.x = floorf (child->bounds.origin.x);
+          extents.y = floorf (child->bounds.origin.y);
+          extents.width = ceilf (child->bounds.origin.x + child->bounds.size.width) - extents.x;
+          extents.height = ceilf (child->bounds.origin.y + child->bounds.size.height) - extents.y;
+
+          if (cairo_region_contains_rectangle (opaque, &extents) == CAIRO_REGION_OVERLAP_IN)
+            {
+              hidden[i - first] = TRUE;
+              n_hidden++;
+              continue;
+            }
+        }
+
+      if (!gsk_render_node_get_opaque_rect (child, &rect))
+        continue;
+
+      /* Round inwards, so only fully covered pixels count as opaque */
+      extents.x = ceilf (rect.origin.x);
+      extents.y = ceilf (rect.origin.y);
+      extents.width = floorf (rect.origin.x + rect.size.width) - extents.x;
+      extents.height = floorf (rect.origin.y + rect.size.height) - extents.y;
+
+      if (extents.width <= 0 || extents.height <= 0)
+        continue;
+
+      if (opaque == NULL)
+        opaque = cairo_region_create_rectangle (&extents);
+      else
+        cairo_region_union_rectangle (opaque, &extents);
+    }
+
+  g_clear_pointer (&opaque, cairo_region_destroy);
+
+  return n_hidden;
+}
+
 /*** GSK_TRANSFORM_NODE ***/
 
 typedef struct _GskTransformNode GskTransformNode;
@@ -3450,6 +4026,8 @@ gsk_text_node_finalize (GskRenderNode *node)
 
 #define STACK_ARRAY_LENGTH(T) (STACK_BUFFER_SIZE / sizeof(T))
 
+G_LOCK_DEFINE_STATIC (text_node_draw);
+
 static void
 gsk_text_node_draw (GskRenderNode *node,
                     cairo_t       *cr)
@@ -3465,7 +4043,12 @@ gsk_text_node_draw (GskRenderNode *node,
 
   gdk_cairo_set_source_rgba (cr, &self->color);
   cairo_translate (cr, self->x, self->y);
+
+  /* Pango is not thread-safe, but the cairo renderer may
+   * draw from multiple threads */
+  G_LOCK (text_node_draw);
   pango_cairo_show_glyph_string (cr, self->font, &glyphs);
+  G_UNLOCK (text_node_draw);
 
   cairo_restore (cr);
 }
@@ -11,8 +11,19 @@
 #include "gtk/css/gtkcssparserprivate.h"
 #include "gtk/css/gtkcssdataurlprivate.h"
 
+typedef struct _Context Context;
 typedef struct _Declaration Declaration;
 
+struct _Context
+{
+  GskParseErrorFunc error_func;
+  gpointer error_user_data;
+
+  /* Recordings contain the same textures many times, so decode each
+   * data URL only once. Maps URL => GdkTexture */
+  GHashTable *textures;
+};
+
 struct _Declaration
 {
   const char *name;
@@ -55,11 +66,19 @@ parse_texture (GtkCssParser *parser,
   scheme = g_uri_parse_scheme (url);
   if (scheme && g_ascii_strcasecmp (scheme, "data") == 0)
     {
+      Context *context = gtk_css_parser_get_user_data (parser);
       GInputStream *stream;
       GdkPixbuf *pixbuf;
       GBytes *bytes;
 
-      texture = NULL;
+      texture = g_hash_table_lookup (context->textures, url);
+      if (texture)
+        {
+          g_free (scheme);
+          g_free (url);
+          *(GdkTexture **) out_data = g_object_ref (texture);
+          return TRUE;
+        }
 
       bytes = gtk_css_data_url_parse (url, NULL, &error);
       if (bytes)
@@ -67,10 +86,12 @@ parse_texture (GtkCssParser *parser,
           stream = g_memory_input_stream_new_from_bytes (bytes);
           pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, &error);
           g_object_unref (stream);
+          g_bytes_unref (bytes);
           if (pixbuf != NULL)
             {
               texture = gdk_texture_new_for_pixbuf (pixbuf);
               g_object_unref (pixbuf);
+              g_hash_table_insert (context->textures, g_strdup (url), g_object_ref (texture));
             }
         }
     }
@@ -664,6 +685,65 @@ parse_linear_gradient_node (GtkCssParser *parser)
   return result;
 }
 
+static GskRenderNode *
+parse_radial_gradient_node_internal (GtkCssParser *parser,
+                                     gboolean      repeating)
+{
+  graphene_rect_t bounds = GRAPHENE_RECT_INIT (0, 0, 0, 0);
+  graphene_point_t center = GRAPHENE_POINT_INIT (0, 0);
+  double hradius = 1.0;
+  double vradius = 1.0;
+  double start = 0;
+  double end = 1.0;
+  GArray *stops = NULL;
+  const Declaration declarations[] = {
+    { "bounds", parse_rect, NULL, &bounds },
+    { "center", parse_point, NULL, &center },
+    { "hradius", parse_double, NULL, &hradius },
+    { "vradius", parse_double, NULL, &vradius },
+    { "start", parse_double, NULL, &start },
+    { "end", parse_double, NULL, &end },
+    { "stops", parse_stops, clear_stops, &stops },
+  };
+  GskRenderNode *result;
+
+  parse_declarations (parser, declarations, G_N_ELEMENTS(declarations));
+  if (stops == NULL)
+    {
+      gtk_css_parser_error_syntax (parser, "No color stops given");
+      return NULL;
+    }
+  if (hradius <= 0 || vradius <= 0 || start < 0 || end <= start)
+    {
+      gtk_css_parser_error_value (parser, "Radii must be positive and \"end\" must be larger than \"start\"");
+      g_array_free (stops, TRUE);
+      return NULL;
+    }
+
+  if (repeating)
+    result = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end,
+                                                     (GskColorStop *) stops->data, stops->len);
+  else
+    result = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end,
+                                           (GskColorStop *) stops->data, stops->len);
+
+  g_array_free (stops, TRUE);
+
+  return result;
+}
+
+static GskRenderNode *
+parse_radial_gradient_node (GtkCssParser *parser)
+{
+  return parse_radial_gradient_node_internal (parser, FALSE);
+}
+
+static GskRenderNode *
+parse_repeating_radial_gradient_node (GtkCssParser *parser)
+{
+  return parse_radial_gradient_node_internal (parser, TRUE);
+}
+
 static GskRenderNode *
 parse_inset_shadow_node (GtkCssParser *parser)
 {
@@ -1109,6 +1189,8 @@ parse_node (GtkCssParser *parser,
     { "container", parse_container_node },
     { "color", parse_color_node },
     { "linear-gradient", parse_linear_gradient_node },
+    { "radial-gradient", parse_radial_gradient_node },
+    { "repeating-radial-gradient", parse_repeating_radial_gradient_node },
     { "border", parse_border_node },
     { "texture", parse_texture_node },
     { "inset-shadow", parse_inset_shadow_node },
@@ -1174,16 +1256,13 @@ gsk_render_node_parser_error (GtkCssParser         *parser,
                               const GError         *error,
                               gpointer              user_data)
 {
-  struct {
-    GskParseErrorFunc error_func;
-    gpointer user_data;
-  } *error_func_pair = user_data;
+  Context *context = user_data;
 
-  if (error_func_pair->error_func)
+  if (context->error_func)
     {
       GtkCssSection *section = gtk_css_section_new (gtk_css_parser_get_file (parser), start, end);
 
-      error_func_pair->error_func (section, error, error_func_pair->user_data);
+      context->error_func (section, error, context->error_user_data);
       gtk_css_section_unref (section);
     }
 }
@@ -1195,13 +1274,14 @@ gsk_render_node_deserialize_from_bytes (GBytes            *bytes,
 {
   GskRenderNode *root = NULL;
   GtkCssParser *parser;
-  struct {
-    GskParseErrorFunc error_func;
-    gpointer user_data;
-  } error_func_pair = { error_func, user_data };
+  Context context;
+
+  context.error_func = error_func;
+  context.error_user_data = user_data;
+  context.textures = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
   parser = gtk_css_parser_new_for_bytes (bytes, NULL, NULL, gsk_render_node_parser_error,
-                                         &error_func_pair, NULL);
+                                         &context, NULL);
   root = parse_container_node (parser);
 
   if (root && gsk_container_node_get_n_children (root) == 1)
@@ -1214,6 +1294,7 @@ gsk_render_node_deserialize_from_bytes (GBytes            *bytes,
     }
 
   gtk_css_parser_unref (parser);
+  g_hash_table_unref (context.textures);
 
   return root;
 }
@@ -1435,6 +1516,28 @@ append_point_param (Printer                *p,
   g_string_append_c (p->str, '\n');
 }
 
+static void
+append_stops_param (Printer            *p,
+                    const char         *param_name,
+                    const GskColorStop *stops,
+                    gsize               n_stops)
+{
+  gsize i;
+
+  _indent (p);
+  g_string_append_printf (p->str, "%s:", param_name);
+  for (i = 0; i < n_stops; i ++)
+    {
+      if (i > 0)
+        g_string_append_c (p->str, ',');
+      g_string_append_c (p->str, ' ');
+      string_append_double (p->str, stops[i].offset);
+      g_string_append_c (p->str, ' ');
+      append_rgba (p->str, &stops[i].color);
+    }
+  g_string_append (p->str, ";\n");
+}
+
 static void
 append_vec4_param (Printer               *p,
                    const char            *param_name,
@@ -1546,35 +1649,37 @@ render_node_print (Printer       *p,
 
     case GSK_LINEAR_GRADIENT_NODE:
       {
-        const guint n_stops = gsk_linear_gradient_node_get_n_color_stops (node);
-        const GskColorStop *stop;
-        int i;
-
         start_node (p, "linear-gradient");
 
         append_rect_param (p, "bounds", &node->bounds);
         append_point_param (p, "start", gsk_linear_gradient_node_peek_start (node));
         append_point_param (p, "end", gsk_linear_gradient_node_peek_end (node));
 
-        _indent (p);
-        g_string_append (p->str, "stops:");
-        for (i = 0; i < n_stops - 1; i ++)
-          {
-            stop = gsk_linear_gradient_node_peek_color_stops (node) + i;
+        append_stops_param (p, "stops",
+                            gsk_linear_gradient_node_peek_color_stops (node),
+                            gsk_linear_gradient_node_get_n_color_stops (node));
 
-            g_string_append_c (p->str, ' ');
-            string_append_double (p->str, stop->offset);
-            g_string_append_c (p->str, ' ');
-            append_rgba (p->str, &stop->color);
-            g_string_append_c (p->str, ',');
-          }
+        end_node (p);
+      }
+      break;
 
-        /* Last one, no comma */
-        stop = gsk_linear_gradient_node_peek_color_stops (node) + n_stops - 1;
-        string_append_double (p->str, stop->offset);
-        g_string_append_c (p->str, ' ');
-        append_rgba (p->str, &stop->color);
-        g_string_append (p->str, ";\n");
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        if (gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE)
+          start_node (p, "repeating-radial-gradient");
+        else
+          start_node (p, "radial-gradient");
+
+        append_rect_param (p, "bounds", &node->bounds);
+        append_point_param (p, "center", gsk_radial_gradient_node_peek_center (node));
+        append_float_param (p, "hradius", gsk_radial_gradient_node_get_hradius (node));
+        append_float_param (p, "vradius", gsk_radial_gradient_node_get_vradius (node));
+        append_float_param (p, "start", gsk_radial_gradient_node_get_start (node));
+        append_float_param (p, "end", gsk_radial_gradient_node_get_end (node));
+        append_stops_param (p, "stops",
+                            gsk_radial_gradient_node_peek_color_stops (node),
+                            gsk_radial_gradient_node_get_n_color_stops (node));
 
         end_node (p);
       }
@@ -7,6 +7,8 @@
 G_BEGIN_DECLS
 
 typedef struct _GskRenderNodeClass GskRenderNodeClass;
+typedef struct _GskRenderNodeArena GskRenderNodeArena;
+typedef struct _GskRenderNodeChunk GskRenderNodeChunk;
 
 #define GSK_IS_RENDER_NODE_TYPE(node,type) (GSK_IS_RENDER_NODE (node) && (node)->node_class->node_type == (type))
 
@@ -16,6 +18,9 @@ struct _GskRenderNode
 
   volatile int ref_count;
 
+  /* The arena chunk holding this node, or %NULL if it was malloc()ed */
+  GskRenderNodeChunk *chunk;
+
   graphene_rect_t bounds;
 };
 
@@ -38,6 +43,12 @@ struct _GskRenderNodeClass
 GskRenderNode * gsk_render_node_new              (const GskRenderNodeClass  *node_class,
                                                   gsize                      extra_size);
 
+GskRenderNodeArena *
+                gsk_render_node_arena_new        (void);
+void            gsk_render_node_arena_free       (GskRenderNodeArena        *arena);
+void            gsk_render_node_arena_push       (GskRenderNodeArena        *arena);
+void            gsk_render_node_arena_pop        (GskRenderNodeArena        *arena);
+
 gboolean        gsk_render_node_can_diff         (GskRenderNode             *node1,
                                                   GskRenderNode             *node2);
 void            gsk_render_node_diff             (GskRenderNode             *node1,
@@ -50,6 +61,14 @@ void            gsk_render_node_diff_impossible  (GskRenderNode             *nod
 GskRenderNode * gsk_cairo_node_new_for_surface   (const graphene_rect_t    *bounds,
                                                   cairo_surface_t          *surface);
 
+gboolean        gsk_render_node_get_opaque_rect  (GskRenderNode             *node,
+                                                  graphene_rect_t           *rect);
+guint           gsk_container_node_get_hidden_children (GskRenderNode       *node,
+                                                        guint                first,
+                                                        guint8              *hidden);
+
+guint           gsk_render_node_get_n_created    (void);
+
 
 G_END_DECLS
 
@@ -380,6 +380,58 @@ gsk_rounded_rect_contains_point (const GskRoundedRect   *self,
   return TRUE;
 }
 
+/* Checks if the point is in the part of the corner's box that is cut
+ * off by the rounding. The cut-off part only grows towards the outer
+ * corner of the box, so for a rectangle it is enough to check its
+ * point closest to the corner to know if it extends into the cut-off
+ * part, and its point furthest from the corner to know if it is
+ * completely inside of it.
+ */
+static gboolean
+gsk_rounded_rect_corner_cuts_point (const GskRoundedRect *self,
+                                    GskCorner             corner,
+                                    float                 x,
+                                    float                 y)
+{
+  const graphene_size_t *size = &self->corner[corner];
+  float dx, dy;
+
+  if (size->width <= 0 || size->height <= 0)
+    return FALSE;
+
+  switch (corner)
+    {
+    case GSK_CORNER_TOP_LEFT:
+      dx = self->bounds.origin.x + size->width - x;
+      dy = self->bounds.origin.y + size->height - y;
+      break;
+
+    case GSK_CORNER_TOP_RIGHT:
+      dx = x - (self->bounds.origin.x + self->bounds.size.width - size->width);
+      dy = self->bounds.origin.y + size->height - y;
+      break;
+
+    case GSK_CORNER_BOTTOM_RIGHT:
+      dx = x - (self->bounds.origin.x + self->bounds.size.width - size->width);
+      dy = y - (self->bounds.origin.y + self->bounds.size.height - size->height);
+      break;
+
+    case GSK_CORNER_BOTTOM_LEFT:
+      dx = self->bounds.origin.x + size->width - x;
+      dy = y - (self->bounds.origin.y + self->bounds.size.height - size->height);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+
+  if (dx <= 0 || dy <= 0)
+    return FALSE;
+
+  return !ellipsis_contains_point (size, &GRAPHENE_POINT_INIT (dx, dy));
+}
+
 /**
  * gsk_rounded_rect_contains_rect:
  * @self: a #GskRoundedRect
@@ -395,13 +447,21 @@ gboolean
 gsk_rounded_rect_contains_rect (const GskRoundedRect  *self,
                                 const graphene_rect_t *rect)
 {
+  float x1, y1, x2, y2;
+
   if (!graphene_rect_contains_rect (&self->bounds, rect))
     return FALSE;
 
-  if (!gsk_rounded_rect_contains_point (self, &rect->origin) ||
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x + rect->size.width, rect->origin.y)) ||
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x, rect->origin.y + rect->size.height)) ||
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x + rect->size.width, rect->origin.y + rect->size.height)))
+  x1 = rect->origin.x;
+  y1 = rect->origin.y;
+  x2 = x1 + rect->size.width;
+  y2 = y1 + rect->size.height;
+
+  /* Each corner can only cut off the point of @rect closest to it */
+  if (gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_TOP_LEFT, x1, y1) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_TOP_RIGHT, x2, y1) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_BOTTOM_RIGHT, x2, y2) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_BOTTOM_LEFT, x1, y2))
     return FALSE;
 
   return TRUE;
@@ -422,13 +482,24 @@ gboolean
 gsk_rounded_rect_intersects_rect (const GskRoundedRect  *self,
                                   const graphene_rect_t *rect)
 {
-  if (!graphene_rect_intersection (&self->bounds, rect, NULL))
+  graphene_rect_t inter;
+  float x1, y1, x2, y2;
+
+  if (!graphene_rect_intersection (&self->bounds, rect, &inter))
     return FALSE;
 
-  if (!gsk_rounded_rect_contains_point (self, &rect->origin) &&
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x + rect->size.width, rect->origin.y)) &&
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x, rect->origin.y + rect->size.height)) &&
-      !gsk_rounded_rect_contains_point (self, &GRAPHENE_POINT_INIT (rect->origin.x + rect->size.width, rect->origin.y + rect->size.height)))
+  x1 = inter.origin.x;
+  y1 = inter.origin.y;
+  x2 = x1 + inter.size.width;
+  y2 = y1 + inter.size.height;
+
+  /* The part of @rect inside the bounds misses the rounded rectangle
+   * only if all of it is cut off by a single corner, which is the case
+   * if the point furthest from that corner is. */
+  if (gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_TOP_LEFT, x2, y2) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_TOP_RIGHT, x1, y2) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_BOTTOM_RIGHT, x1, y1) ||
+      gsk_rounded_rect_corner_cuts_point (self, GSK_CORNER_BOTTOM_LEFT, x2, y1))
     return FALSE;
 
   return TRUE;
@@ -45,6 +45,10 @@ struct _GskTransform
 
   GskTransformCategory category;
   GskTransform *next;
+
+  /* The matrix of the whole chain, computed on first use. Transforms
+   * are immutable, so it never needs to be invalidated. */
+  graphene_matrix_t *matrix;
 };
 
 struct _GskTransformClass
@@ -1216,6 +1220,9 @@ gsk_transform_finalize (GskTransform *self)
 {
   self->transform_class->finalize (self);
 
+  if (self->matrix)
+    graphene_matrix_free (self->matrix);
+
   gsk_transform_unref (self->next);
 }
 
@@ -1319,7 +1326,7 @@ void
 gsk_transform_to_matrix (GskTransform      *self,
                          graphene_matrix_t *out_matrix)
 {
-  graphene_matrix_t m;
+  graphene_matrix_t m, *matrix;
 
   if (self == NULL)
     {
@@ -1327,9 +1334,22 @@ gsk_transform_to_matrix (GskTransform      *self,
       return;
     }
 
+  matrix = g_atomic_pointer_get (&self->matrix);
+  if (matrix)
+    {
+      graphene_matrix_init_from_matrix (out_matrix, matrix);
+      return;
+    }
+
   gsk_transform_to_matrix (self->next, out_matrix);
   self->transform_class->to_matrix (self, &m);
   graphene_matrix_multiply (&m, out_matrix, out_matrix);
+
+  /* Transforms may be shared between threads, so only one of them
+   * gets to install its result */
+  matrix = graphene_matrix_init_from_matrix (graphene_matrix_alloc (), out_matrix);
+  if (!g_atomic_pointer_compare_and_exchange (&self->matrix, NULL, matrix))
+    graphene_matrix_free (matrix);
 }
 
 /**
@@ -1631,11 +1651,24 @@ gsk_transform_transform_bounds (GskTransform          *self,
       }
     break;
 
+    case GSK_TRANSFORM_CATEGORY_2D_AFFINE:
+      {
+        float scale_x, scale_y, dx, dy;
+
+        gsk_transform_to_affine (self, &scale_x, &scale_y, &dx, &dy);
+        graphene_rect_init (out_rect,
+                            rect->origin.x * scale_x + dx,
+                            rect->origin.y * scale_y + dy,
+                            rect->size.width * scale_x,
+                            rect->size.height * scale_y);
+        graphene_rect_normalize (out_rect);
+      }
+    break;
+
     case GSK_TRANSFORM_CATEGORY_UNKNOWN:
     case GSK_TRANSFORM_CATEGORY_ANY:
     case GSK_TRANSFORM_CATEGORY_3D:
     case GSK_TRANSFORM_CATEGORY_2D:
-    case GSK_TRANSFORM_CATEGORY_2D_AFFINE:
     default:
       {
         graphene_matrix_t mat;
@@ -1,3 +1,4 @@
+uniform vec4 u_color;
 uniform vec4 u_outline;
 uniform vec4 u_corner_widths;//= vec4(0, 0, 0, 0);
 uniform vec4 u_corner_heights;// = vec4(0, 0, 0, 0);
@@ -10,7 +11,8 @@ void main() {
 
   RoundedRect outline = RoundedRect(vec4(u_outline.xy, u_outline.xy + u_outline.zw), u_corner_widths, u_corner_heights);
 
-  vec4 color = Texture(u_source, vUv);
+  // The texture holds the blurred shadow coverage in white
+  vec4 color = vec4(u_color.rgb * u_color.a, u_color.a) * Texture(u_source, vUv).a;
   color = color * (1.0 -  clamp(rounded_rect_coverage (outline, f.xy), 0.0, 1.0));
   setOutputColor(color * u_alpha);
 }
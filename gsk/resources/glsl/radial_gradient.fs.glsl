@@ -0,0 +1,43 @@
+uniform vec4 u_color_stops[8];
+uniform float u_color_offsets[8];
+uniform int u_num_color_stops;
+uniform vec2 u_center;
+uniform vec2 u_radius;
+uniform float u_start;
+uniform float u_end;
+uniform bool u_repeat;
+
+vec4 fragCoord() {
+  vec4 f = gl_FragCoord;
+  f.x += u_viewport.x;
+  f.y = (u_viewport.y + u_viewport.w) - f.y;
+  return f;
+}
+
+void main() {
+  vec2 center = (u_modelview * vec4(u_center, 0, 1)).xy;
+  vec2 radius = vec2(length((u_modelview * vec4(u_radius.x, 0, 0, 0)).xy),
+                     length((u_modelview * vec4(0, u_radius.y, 0, 0)).xy));
+
+  // Distance from the center in units of the radius, so ellipses become circles
+  float dist = length((fragCoord().xy - center) / radius);
+
+  // Offset between the start and the end of the gradient
+  float offset = (dist - u_start) / (u_end - u_start);
+
+  if (u_repeat)
+    offset = fract(offset);
+
+  vec4 color = u_color_stops[0];
+  for (int i = 1; i < u_num_color_stops; i ++) {
+    if (offset >= u_color_offsets[i - 1])  {
+      float o = (offset - u_color_offsets[i - 1]) / (u_color_offsets[i] - u_color_offsets[i - 1]);
+      color = mix(u_color_stops[i - 1], u_color_stops[i], clamp(o, 0.0, 1.0));
+    }
+  }
+
+  /* Pre-multiply */
+  color.rgb *= color.a;
+
+  setOutputColor(color * u_alpha);
+}
@@ -0,0 +1,5 @@
+void main() {
+  vec4 diffuse = Texture(u_source, fract(vUv));
+
+  setOutputColor(diffuse * u_alpha);
+}
@@ -0,0 +1,15 @@
+uniform vec4 u_color;
+
+// u_source holds distance fields, with the outline of the glyph at 0.5,
+// see write_sdf() in gskglglyphcache.c
+void main() {
+  float dist = Texture(u_source, vUv).a;
+  float width = max(fwidth(dist) * 0.5, 0.001);
+  float coverage = smoothstep(0.5 - width, 0.5 + width, dist);
+  vec4 color = u_color;
+
+  // pre-multiply
+  color.rgb *= color.a;
+
+  setOutputColor(color * coverage * u_alpha);
+}
@@ -0,0 +1,15 @@
+// Per-glyph instance data, see ops_draw_glyph()
+in vec4 aGlyphRect;
+in vec4 aGlyphUv;
+
+// The two triangles of a glyph quad, in the same order as ops_draw() uses
+const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0),
+                                vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(1.0, 0.0));
+
+void main() {
+  vec2 corner = corners[gl_VertexID];
+
+  gl_Position = u_projection * u_modelview * vec4(aGlyphRect.xy + corner * aGlyphRect.zw, 0.0, 1.0);
+
+  vUv = aGlyphUv.xy + corner * aGlyphUv.zw;
+}
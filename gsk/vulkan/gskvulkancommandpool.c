@@ -92,6 +92,13 @@ gsk_vulkan_command_pool_get_buffer (GskVulkanCommandPool *self)
   return command_buffer;
 }
 
+void
+gsk_vulkan_command_pool_end_buffer (GskVulkanCommandPool *self,
+                                    VkCommandBuffer       command_buffer)
+{
+  GSK_VK_CHECK (vkEndCommandBuffer, command_buffer);
+}
+
 void
 gsk_vulkan_command_pool_submit_buffer (GskVulkanCommandPool *self,
                                        VkCommandBuffer       command_buffer,
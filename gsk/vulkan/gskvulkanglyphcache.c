@@ -245,41 +245,38 @@ add_to_cache (GskVulkanGlyphCache  *cache,
 }
 
 static void
-render_glyph (Atlas          *atlas,
-              DirtyGlyph     *glyph,
-              GskImageRegion *region)
+prepare_glyph (Atlas          *atlas,
+               DirtyGlyph     *glyph,
+               GskRenderGlyph *render)
 {
   GlyphCacheKey *key = glyph->key;
   GskVulkanCachedGlyph *value = glyph->value;
   cairo_surface_t *surface;
-  cairo_t *cr;
-  PangoGlyphString glyphs;
-  PangoGlyphInfo gi;
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                         value->draw_width * key->scale / 1024,
                                         value->draw_height * key->scale / 1024);
   cairo_surface_set_device_scale (surface, key->scale / 1024.0, key->scale / 1024.0);
 
-  cr = cairo_create (surface);
-  cairo_set_source_rgba (cr, 1, 1, 1, 1);
-
-  gi.glyph = key->glyph;
-  gi.geometry.width = value->draw_width * 1024;
-  if (key->glyph & PANGO_GLYPH_UNKNOWN_FLAG)
-    gi.geometry.x_offset = 0;
-  else
-    gi.geometry.x_offset = - value->draw_x * 1024;
-  gi.geometry.y_offset = - value->draw_y * 1024;
-
-  glyphs.num_glyphs = 1;
-  glyphs.glyphs = &gi;
+  glyph->surface = surface;
 
-  pango_cairo_show_glyph_string (cr, key->font, &glyphs);
+  render->font = key->font;
+  render->glyph = key->glyph;
+  render->draw_x = value->draw_x;
+  render->draw_y = value->draw_y;
+  render->draw_width = value->draw_width;
+  render->surface = surface;
+}
 
-  cairo_destroy (cr);
+static void
+get_glyph_region (Atlas          *atlas,
+                  DirtyGlyph     *glyph,
+                  GskImageRegion *region)
+{
+  GskVulkanCachedGlyph *value = glyph->value;
+  cairo_surface_t *surface = glyph->surface;
 
-  glyph->surface = surface;
+  cairo_surface_flush (surface);
 
   region->data = cairo_image_surface_get_data (surface);
   region->width = cairo_image_surface_get_width (surface);
@@ -297,19 +294,29 @@ upload_dirty_glyphs (GskVulkanGlyphCache *cache,
   GList *l;
   guint num_regions;
   GskImageRegion *regions;
+  GskRenderGlyph *render;
   int i;
 
   num_regions = g_list_length (atlas->dirty_glyphs);
-  regions = alloca (sizeof (GskImageRegion) * num_regions);
+  regions = g_new (GskImageRegion, num_regions);
+  render = g_new (GskRenderGlyph, num_regions);
+
+  /* Every glyph has its own surface, so they can be drawn in parallel */
+  for (l = atlas->dirty_glyphs, i = 0; l; l = l->next, i++)
+    prepare_glyph (atlas, (DirtyGlyph *)l->data, &render[i]);
+
+  gsk_render_glyphs (render, num_regions);
 
   for (l = atlas->dirty_glyphs, i = 0; l; l = l->next, i++)
-    render_glyph (atlas, (DirtyGlyph *)l->data, &regions[i]);
+    get_glyph_region (atlas, (DirtyGlyph *)l->data, &regions[i]);
 
   GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
             g_message ("uploading %d glyphs to cache", num_regions));
 
   gsk_vulkan_image_upload_regions (atlas->image, uploader, num_regions, regions);
 
+  g_free (render);
+  g_free (regions);
   g_list_free_full (atlas->dirty_glyphs, dirty_glyph_free);
   atlas->dirty_glyphs = NULL;
 }
@@ -8,6 +8,18 @@
 
 #include <string.h>
 
+/* Staging data of a frame is suballocated from buffers of this size,
+ * which are reused once the frame is done. Larger uploads get their
+ * own buffer. */
+#define STAGING_BUFFER_SIZE (4 * 1024 * 1024)
+
+/* Number of unused staging buffers kept around between frames */
+#define MAX_FREE_STAGING_BUFFERS 2
+
+/* Offsets in a staging buffer are aligned to this, which is a multiple
+ * of the texel size and optimalBufferCopyOffsetAlignment in practice */
+#define STAGING_ALIGNMENT 256
+
 struct _GskVulkanUploader
 {
   GdkVulkanContext *vulkan;
@@ -21,7 +33,11 @@ struct _GskVulkanUploader
   GArray *after_image_barriers;
 
   GSList *staging_image_free_list;
-  GSList *staging_buffer_free_list;
+
+  GskVulkanBuffer *staging; /* buffer that is currently filled */
+  gsize staging_offset;
+  GSList *staging_used; /* buffers filled this frame */
+  GSList *staging_free; /* buffers ready to be reused */
 };
 
 struct _GskVulkanImage
@@ -67,6 +83,7 @@ void
 gsk_vulkan_uploader_free (GskVulkanUploader *self)
 {
   gsk_vulkan_uploader_reset (self);
+  g_slist_free_full (self->staging_free, (GDestroyNotify) gsk_vulkan_buffer_free);
 
   g_array_unref (self->after_buffer_barriers);
   g_array_unref (self->before_buffer_barriers);
@@ -130,6 +147,55 @@ gsk_vulkan_uploader_add_buffer_barrier (GskVulkanUploader           *self,
   g_array_append_val (array, *barrier);
 }
 
+/* Returns memory for size bytes of staging data, which stays valid
+ * until the uploader is reset. Host writes to it don't need a barrier,
+ * submitting the copy makes them visible to the device. */
+static guchar *
+gsk_vulkan_uploader_alloc_staging (GskVulkanUploader  *self,
+                                   gsize               size,
+                                   GskVulkanBuffer   **buffer,
+                                   gsize              *offset)
+{
+  GskVulkanBuffer *staging;
+
+  if (size > STAGING_BUFFER_SIZE)
+    {
+      staging = gsk_vulkan_buffer_new_staging (self->vulkan, size);
+      self->staging_used = g_slist_prepend (self->staging_used, staging);
+
+      *buffer = staging;
+      *offset = 0;
+
+      return gsk_vulkan_buffer_map (staging);
+    }
+
+  if (self->staging == NULL ||
+      self->staging_offset + size > STAGING_BUFFER_SIZE)
+    {
+      if (self->staging)
+        self->staging_used = g_slist_prepend (self->staging_used, self->staging);
+
+      if (self->staging_free)
+        {
+          self->staging = self->staging_free->data;
+          self->staging_free = g_slist_delete_link (self->staging_free, self->staging_free);
+        }
+      else
+        {
+          self->staging = gsk_vulkan_buffer_new_staging (self->vulkan, STAGING_BUFFER_SIZE);
+        }
+
+      self->staging_offset = 0;
+    }
+
+  *buffer = self->staging;
+  *offset = self->staging_offset;
+
+  self->staging_offset = (self->staging_offset + size + STAGING_ALIGNMENT - 1) & ~(gsize) (STAGING_ALIGNMENT - 1);
+
+  return gsk_vulkan_buffer_map (self->staging) + *offset;
+}
+
 static VkCommandBuffer
 gsk_vulkan_uploader_get_copy_buffer (GskVulkanUploader *self)
 {
@@ -190,8 +256,25 @@ gsk_vulkan_uploader_reset (GskVulkanUploader *self)
 
   g_slist_free_full (self->staging_image_free_list, g_object_unref);
   self->staging_image_free_list = NULL;
-  g_slist_free_full (self->staging_buffer_free_list, (GDestroyNotify) gsk_vulkan_buffer_free);
-  self->staging_buffer_free_list = NULL;
+
+  if (self->staging)
+    {
+      self->staging_used = g_slist_prepend (self->staging_used, self->staging);
+      self->staging = NULL;
+    }
+
+  while (self->staging_used)
+    {
+      GskVulkanBuffer *staging = self->staging_used->data;
+
+      self->staging_used = g_slist_delete_link (self->staging_used, self->staging_used);
+
+      if (gsk_vulkan_buffer_get_size (staging) == STAGING_BUFFER_SIZE &&
+          g_slist_length (self->staging_free) < MAX_FREE_STAGING_BUFFERS)
+        self->staging_free = g_slist_prepend (self->staging_free, staging);
+      else
+        gsk_vulkan_buffer_free (staging);
+    }
 }
 
 static GskVulkanImage *
@@ -202,7 +285,8 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                       VkImageUsageFlags      usage,
                       VkImageLayout          layout,
                       VkAccessFlags          access,
-                      VkMemoryPropertyFlags  memory)
+                      VkMemoryPropertyFlags  memory,
+                      GskVulkanMemoryFlags   memory_flags)
 {
   VkMemoryRequirements requirements;
   GskVulkanImage *self;
@@ -238,15 +322,20 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                 self->vk_image,
                                 &requirements);
 
+  if (tiling == VK_IMAGE_TILING_OPTIMAL)
+    memory_flags |= GSK_VULKAN_MEMORY_OPTIMAL_TILING;
+
   self->memory = gsk_vulkan_memory_new (context,
                                         requirements.memoryTypeBits,
                                         memory,
-                                        requirements.size);
+                                        requirements.size,
+                                        requirements.alignment,
+                                        memory_flags);
 
   GSK_VK_CHECK (vkBindImageMemory, gdk_vulkan_context_get_device (context),
                                    self->vk_image,
                                    gsk_vulkan_memory_get_device_memory (self->memory),
-                                   0);
+                                   gsk_vulkan_memory_get_offset (self->memory));
   return self;
 }
 
@@ -326,10 +415,10 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
   GskVulkanImage *self;
   GskVulkanBuffer *staging;
   gsize buffer_size = width * height * 4;
+  gsize staging_offset;
   guchar *mem;
 
-  staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, buffer_size);
-  mem = gsk_vulkan_buffer_map (staging);
+  mem = gsk_vulkan_uploader_alloc_staging (uploader, buffer_size, &staging, &staging_offset);
 
   if (stride == width * 4)
     {
@@ -343,21 +432,6 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
         }
     }
 
-  gsk_vulkan_buffer_unmap (staging);
-
-  gsk_vulkan_uploader_add_buffer_barrier (uploader,
-                                          FALSE,
-                                          &(VkBufferMemoryBarrier) {
-                                             .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-                                             .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-                                             .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                                             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                                             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                                             .buffer = gsk_vulkan_buffer_get_buffer(staging),
-                                             .offset = 0,
-                                             .size = buffer_size,
-                                         });
-
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
@@ -366,7 +440,8 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
                                VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
                                VK_ACCESS_TRANSFER_WRITE_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               GSK_VULKAN_MEMORY_LONG_LIVED);
 
   gsk_vulkan_uploader_add_image_barrier (uploader,
                                          FALSE,
@@ -381,7 +456,7 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
                           1,
                           (VkBufferImageCopy[1]) {
                                {
-                                   .bufferOffset = 0,
+                                   .bufferOffset = staging_offset,
                                    .imageSubresource = {
                                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                                        .mipLevel = 0,
@@ -403,8 +478,6 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                          VK_ACCESS_SHADER_READ_BIT);
 
-  uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
-
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 
   return self;
@@ -427,7 +500,8 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                                   VK_IMAGE_LAYOUT_PREINITIALIZED,
                                   VK_ACCESS_TRANSFER_WRITE_BIT,
-                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                  0);
 
   gsk_vulkan_image_upload_data (staging, data, width, height, stride);
 
@@ -439,7 +513,8 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
                                VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
                                VK_ACCESS_TRANSFER_WRITE_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               GSK_VULKAN_MEMORY_LONG_LIVED);
 
   gsk_vulkan_uploader_add_image_barrier (uploader,
                                          FALSE,
@@ -510,7 +585,8 @@ gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
                                VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_PREINITIALIZED,
                                VK_ACCESS_HOST_WRITE_BIT,
-                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                               GSK_VULKAN_MEMORY_LONG_LIVED);
 
   gsk_vulkan_image_upload_data (self, data, width, height, stride);
 
@@ -576,7 +652,8 @@ gsk_vulkan_image_new_for_framebuffer (GdkVulkanContext *context,
                                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               0);
 
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 
@@ -597,7 +674,8 @@ gsk_vulkan_image_new_for_atlas (GdkVulkanContext *context,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
                                0,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               GSK_VULKAN_MEMORY_LONG_LIVED);
 
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 
@@ -620,7 +698,8 @@ gsk_vulkan_image_new_for_texture (GdkVulkanContext *context,
                                VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
                                0,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               GSK_VULKAN_MEMORY_LONG_LIVED);
 
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 
@@ -694,14 +773,14 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
   guchar *m;
   gsize size;
   gsize offset;
+  gsize staging_offset;
   VkBufferImageCopy *bufferImageCopy;
 
   size = 0;
   for (int i = 0; i < num_regions; i++)
     size += regions[i].width * regions[i].height * 4;
 
-  staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, size);
-  mem = gsk_vulkan_buffer_map (staging);
+  mem = gsk_vulkan_uploader_alloc_staging (uploader, size, &staging, &staging_offset);
 
   bufferImageCopy = alloca (sizeof (VkBufferImageCopy) * num_regions);
   memset (bufferImageCopy, 0, sizeof (VkBufferImageCopy) * num_regions);
@@ -716,11 +795,11 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
         }
       else
         {
-          for (gsize r = 0; r < regions[i].height; i++)
+          for (gsize r = 0; r < regions[i].height; r++)
             memcpy (m + r * regions[i].width * 4, regions[i].data + r * regions[i].stride, regions[i].width * 4);
         }
 
-      bufferImageCopy[i].bufferOffset = offset;
+      bufferImageCopy[i].bufferOffset = staging_offset + offset;
       bufferImageCopy[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
       bufferImageCopy[i].imageSubresource.mipLevel = 0;
       bufferImageCopy[i].imageSubresource.baseArrayLayer = 0;
@@ -735,8 +814,6 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
       offset += regions[i].width * regions[i].height * 4;
     }
 
-  gsk_vulkan_buffer_unmap (staging);
-
   gsk_vulkan_uploader_add_image_barrier (uploader,
                                          FALSE,
                                          self,
@@ -756,8 +833,6 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                          VK_ACCESS_SHADER_READ_BIT);
 
-  uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
-
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 }
 
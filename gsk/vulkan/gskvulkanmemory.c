@@ -3,29 +3,289 @@
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanmemoryprivate.h"
 
+/* Memory is sub-allocated from big VkDeviceMemory chunks with a buddy
+ * allocator, so we don't run into maxMemoryAllocationCount and don't
+ * pay for a vkAllocateMemory() per buffer or image.
+ *
+ * Chunks are kept in pools, one per memory type and GskVulkanMemoryFlags.
+ * Keeping short-lived and long-lived memory apart avoids per-frame
+ * allocations fragmenting the chunks that hold glyph atlases and
+ * textures, and keeping linear and optimal resources apart means we
+ * don't need to care about bufferImageGranularity.
+ *
+ * Allocations bigger than half a chunk get their own VkDeviceMemory. */
+
+#define MIN_BLOCK_SHIFT 8    /* 256 bytes */
+#define CHUNK_SHIFT     23   /* 8 MB */
+#define N_ORDERS        (CHUNK_SHIFT - MIN_BLOCK_SHIFT + 1)
+#define CHUNK_SIZE      ((gsize) 1 << CHUNK_SHIFT)
+
+#define BLOCK_SIZE(order) ((gsize) 1 << (MIN_BLOCK_SHIFT + (order)))
+
+typedef struct _GskVulkanMemoryChunk GskVulkanMemoryChunk;
+typedef struct _GskVulkanMemoryPool GskVulkanMemoryPool;
+typedef struct _GskVulkanMemoryAllocator GskVulkanMemoryAllocator;
+
+struct _GskVulkanMemoryChunk
+{
+  VkDeviceMemory vk_memory;
+  gsize size;
+  gsize used;
+
+  /* Persistently mapped, memory can't be mapped more than once at a time */
+  guchar *map;
+
+  /* Offsets of the free blocks of every order, NULL for dedicated chunks */
+  GArray *free_blocks[N_ORDERS];
+};
+
+struct _GskVulkanMemoryPool
+{
+  uint32_t memory_type;
+  GskVulkanMemoryFlags flags;
+  GPtrArray *chunks;
+};
+
+struct _GskVulkanMemoryAllocator
+{
+  GdkVulkanContext *vulkan;
+
+  GMutex lock;
+  GPtrArray *pools;
+  guint n_memories;
+
+  GskVulkanMemoryStats stats;
+};
+
 struct _GskVulkanMemory
 {
   GdkVulkanContext *vulkan;
 
   gsize size;
 
-  VkDeviceMemory vk_memory;
+  GskVulkanMemoryAllocator *allocator;
+  GskVulkanMemoryPool *pool; /* NULL for dedicated allocations */
+  GskVulkanMemoryChunk *chunk;
+  gsize offset;
+  guint order;
 };
 
-GskVulkanMemory *
-gsk_vulkan_memory_new (GdkVulkanContext      *context,
-                       uint32_t               allowed_types,
-                       VkMemoryPropertyFlags  flags,
-                       gsize                  size)
+static GskVulkanMemoryChunk *
+gsk_vulkan_memory_chunk_new (GskVulkanMemoryAllocator *allocator,
+                             uint32_t                  memory_type,
+                             gsize                     size,
+                             gboolean                  dedicated)
 {
-  VkPhysicalDeviceMemoryProperties properties;
-  GskVulkanMemory *self;
-  uint32_t i;
+  GskVulkanMemoryChunk *chunk;
+  guint i;
 
-  self = g_slice_new0 (GskVulkanMemory);
+  chunk = g_slice_new0 (GskVulkanMemoryChunk);
+  chunk->size = size;
 
-  self->vulkan = g_object_ref (context);
-  self->size = size;
+  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (allocator->vulkan),
+                                  &(VkMemoryAllocateInfo) {
+                                      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                      .allocationSize = size,
+                                      .memoryTypeIndex = memory_type
+                                  },
+                                  NULL,
+                                  &chunk->vk_memory);
+
+  if (!dedicated)
+    {
+      gsize offset = 0;
+
+      for (i = 0; i < N_ORDERS; i++)
+        chunk->free_blocks[i] = g_array_new (FALSE, FALSE, sizeof (gsize));
+
+      g_array_append_val (chunk->free_blocks[N_ORDERS - 1], offset);
+    }
+
+  allocator->stats.n_device_allocations++;
+  allocator->stats.allocated_bytes += size;
+
+  return chunk;
+}
+
+static void
+gsk_vulkan_memory_chunk_free (GskVulkanMemoryAllocator *allocator,
+                              GskVulkanMemoryChunk     *chunk)
+{
+  VkDevice device = gdk_vulkan_context_get_device (allocator->vulkan);
+  guint i;
+
+  if (chunk->map)
+    vkUnmapMemory (device, chunk->vk_memory);
+
+  vkFreeMemory (device, chunk->vk_memory, NULL);
+
+  for (i = 0; i < N_ORDERS; i++)
+    {
+      if (chunk->free_blocks[i])
+        g_array_unref (chunk->free_blocks[i]);
+    }
+
+  allocator->stats.n_device_allocations--;
+  allocator->stats.allocated_bytes -= chunk->size;
+
+  g_slice_free (GskVulkanMemoryChunk, chunk);
+}
+
+static gboolean
+gsk_vulkan_memory_chunk_alloc (GskVulkanMemoryChunk *chunk,
+                               guint                 order,
+                               gsize                *offset_out)
+{
+  gsize offset;
+  guint i;
+
+  for (i = order; i < N_ORDERS; i++)
+    {
+      if (chunk->free_blocks[i]->len > 0)
+        break;
+    }
+
+  if (i == N_ORDERS)
+    return FALSE;
+
+  offset = g_array_index (chunk->free_blocks[i], gsize, chunk->free_blocks[i]->len - 1);
+  g_array_set_size (chunk->free_blocks[i], chunk->free_blocks[i]->len - 1);
+
+  /* Split the block, keeping the lower half each time */
+  while (i > order)
+    {
+      gsize buddy;
+
+      i--;
+      buddy = offset + BLOCK_SIZE (i);
+      g_array_append_val (chunk->free_blocks[i], buddy);
+    }
+
+  chunk->used += BLOCK_SIZE (order);
+  *offset_out = offset;
+
+  return TRUE;
+}
+
+static void
+gsk_vulkan_memory_chunk_release (GskVulkanMemoryChunk *chunk,
+                                 gsize                 offset,
+                                 guint                 order)
+{
+  chunk->used -= BLOCK_SIZE (order);
+
+  /* Merge with the buddy block for as long as it is free */
+  while (order < N_ORDERS - 1)
+    {
+      GArray *free_blocks = chunk->free_blocks[order];
+      gsize buddy = offset ^ BLOCK_SIZE (order);
+      guint i;
+
+      for (i = 0; i < free_blocks->len; i++)
+        {
+          if (g_array_index (free_blocks, gsize, i) == buddy)
+            break;
+        }
+
+      if (i == free_blocks->len)
+        break;
+
+      g_array_remove_index_fast (free_blocks, i);
+      offset = MIN (offset, buddy);
+      order++;
+    }
+
+  g_array_append_val (chunk->free_blocks[order], offset);
+}
+
+static void
+gsk_vulkan_memory_allocator_free (gpointer data)
+{
+  GskVulkanMemoryAllocator *allocator = data;
+  guint i, j;
+
+  for (i = 0; i < allocator->pools->len; i++)
+    {
+      GskVulkanMemoryPool *pool = g_ptr_array_index (allocator->pools, i);
+
+      for (j = 0; j < pool->chunks->len; j++)
+        gsk_vulkan_memory_chunk_free (allocator, g_ptr_array_index (pool->chunks, j));
+
+      g_ptr_array_unref (pool->chunks);
+      g_slice_free (GskVulkanMemoryPool, pool);
+    }
+  g_ptr_array_unref (allocator->pools);
+
+  g_mutex_clear (&allocator->lock);
+
+  g_slice_free (GskVulkanMemoryAllocator, allocator);
+}
+
+static GQuark
+gsk_vulkan_memory_allocator_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gsk-vulkan-memory-allocator");
+
+  return quark;
+}
+
+static GskVulkanMemoryAllocator *
+gsk_vulkan_memory_allocator_get (GdkVulkanContext *context)
+{
+  GskVulkanMemoryAllocator *allocator;
+
+  allocator = g_object_get_qdata (G_OBJECT (context), gsk_vulkan_memory_allocator_quark ());
+  if (allocator)
+    return allocator;
+
+  allocator = g_slice_new0 (GskVulkanMemoryAllocator);
+  allocator->vulkan = context;
+  allocator->pools = g_ptr_array_new ();
+  g_mutex_init (&allocator->lock);
+
+  g_object_set_qdata_full (G_OBJECT (context),
+                           gsk_vulkan_memory_allocator_quark (),
+                           allocator,
+                           gsk_vulkan_memory_allocator_free);
+
+  return allocator;
+}
+
+static GskVulkanMemoryPool *
+gsk_vulkan_memory_allocator_get_pool (GskVulkanMemoryAllocator *allocator,
+                                      uint32_t                  memory_type,
+                                      GskVulkanMemoryFlags      flags)
+{
+  GskVulkanMemoryPool *pool;
+  guint i;
+
+  for (i = 0; i < allocator->pools->len; i++)
+    {
+      pool = g_ptr_array_index (allocator->pools, i);
+
+      if (pool->memory_type == memory_type && pool->flags == flags)
+        return pool;
+    }
+
+  pool = g_slice_new0 (GskVulkanMemoryPool);
+  pool->memory_type = memory_type;
+  pool->flags = flags;
+  pool->chunks = g_ptr_array_new ();
+  g_ptr_array_add (allocator->pools, pool);
+
+  return pool;
+}
+
+static uint32_t
+find_memory_type (GdkVulkanContext      *context,
+                  uint32_t               allowed_types,
+                  VkMemoryPropertyFlags  flags)
+{
+  VkPhysicalDeviceMemoryProperties properties;
+  uint32_t i;
 
   vkGetPhysicalDeviceMemoryProperties (gdk_vulkan_context_get_physical_device (context),
                                        &properties);
@@ -41,14 +301,74 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 
   g_assert (i < properties.memoryTypeCount);
 
-  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
-                                  &(VkMemoryAllocateInfo) {
-                                      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                                      .allocationSize = size,
-                                      .memoryTypeIndex = i
-                                  },
-                                  NULL,
-                                  &self->vk_memory);
+  return i;
+}
+
+GskVulkanMemory *
+gsk_vulkan_memory_new (GdkVulkanContext      *context,
+                       uint32_t               allowed_types,
+                       VkMemoryPropertyFlags  properties,
+                       gsize                  size,
+                       gsize                  alignment,
+                       GskVulkanMemoryFlags   flags)
+{
+  GskVulkanMemoryAllocator *allocator;
+  GskVulkanMemory *self;
+  uint32_t memory_type;
+  gsize needed;
+  guint i;
+
+  self = g_slice_new0 (GskVulkanMemory);
+
+  self->vulkan = g_object_ref (context);
+  self->size = size;
+
+  memory_type = find_memory_type (context, allowed_types, properties);
+  allocator = gsk_vulkan_memory_allocator_get (context);
+  self->allocator = allocator;
+
+  g_mutex_lock (&allocator->lock);
+
+  /* Blocks are aligned to their size, so that takes care of the alignment */
+  needed = MAX (size, alignment);
+  if (needed > CHUNK_SIZE / 2)
+    {
+      self->chunk = gsk_vulkan_memory_chunk_new (allocator, memory_type, size, TRUE);
+      self->offset = 0;
+    }
+  else
+    {
+      self->pool = gsk_vulkan_memory_allocator_get_pool (allocator, memory_type, flags);
+
+      self->order = 0;
+      while (BLOCK_SIZE (self->order) < needed)
+        self->order++;
+
+      for (i = 0; i < self->pool->chunks->len; i++)
+        {
+          GskVulkanMemoryChunk *chunk = g_ptr_array_index (self->pool->chunks, i);
+
+          if (gsk_vulkan_memory_chunk_alloc (chunk, self->order, &self->offset))
+            {
+              self->chunk = chunk;
+              break;
+            }
+        }
+
+      if (self->chunk == NULL)
+        {
+          self->chunk = gsk_vulkan_memory_chunk_new (allocator, memory_type, CHUNK_SIZE, FALSE);
+          g_ptr_array_add (self->pool->chunks, self->chunk);
+
+          if (!gsk_vulkan_memory_chunk_alloc (self->chunk, self->order, &self->offset))
+            g_assert_not_reached ();
+        }
+    }
+
+  allocator->stats.used_bytes += size;
+  allocator->n_memories++;
+
+  g_mutex_unlock (&allocator->lock);
 
   return self;
 }
@@ -56,9 +376,31 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 void
 gsk_vulkan_memory_free (GskVulkanMemory *self)
 {
-  vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
-                self->vk_memory,
-                NULL);
+  GskVulkanMemoryAllocator *allocator = self->allocator;
+
+  g_mutex_lock (&allocator->lock);
+
+  allocator->stats.used_bytes -= self->size;
+  allocator->n_memories--;
+
+  if (self->pool == NULL)
+    {
+      gsk_vulkan_memory_chunk_free (allocator, self->chunk);
+    }
+  else
+    {
+      gsk_vulkan_memory_chunk_release (self->chunk, self->offset, self->order);
+
+      /* Keep one empty chunk around per pool, so per-frame allocations
+       * don't free and allocate a chunk every frame. */
+      if (self->chunk->used == 0 && self->pool->chunks->len > 1)
+        {
+          g_ptr_array_remove_fast (self->pool->chunks, self->chunk);
+          gsk_vulkan_memory_chunk_free (allocator, self->chunk);
+        }
+    }
+
+  g_mutex_unlock (&allocator->lock);
 
   g_object_unref (self->vulkan);
 
@@ -68,28 +410,78 @@ gsk_vulkan_memory_free (GskVulkanMemory *self)
 VkDeviceMemory
 gsk_vulkan_memory_get_device_memory (GskVulkanMemory *self)
 {
-  return self->vk_memory;
+  return self->chunk->vk_memory;
+}
+
+gsize
+gsk_vulkan_memory_get_offset (GskVulkanMemory *self)
+{
+  return self->offset;
 }
 
 guchar *
 gsk_vulkan_memory_map (GskVulkanMemory *self)
 {
-  void *data;
+  GskVulkanMemoryChunk *chunk = self->chunk;
+  guchar *map;
+
+  g_mutex_lock (&self->allocator->lock);
+
+  if (chunk->map == NULL)
+    {
+      void *data;
 
-  GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
-                             self->vk_memory,
-                             0,
-                             self->size,
-                             0,
-                             &data);
+      GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
+                                 chunk->vk_memory,
+                                 0,
+                                 VK_WHOLE_SIZE,
+                                 0,
+                                 &data);
 
-  return data;
+      chunk->map = data;
+    }
+
+  map = chunk->map + self->offset;
+
+  g_mutex_unlock (&self->allocator->lock);
+
+  return map;
 }
 
 void
 gsk_vulkan_memory_unmap (GskVulkanMemory *self)
 {
-  vkUnmapMemory (gdk_vulkan_context_get_device (self->vulkan),
-                 self->vk_memory);
+  /* Chunks stay mapped until they are freed, see gsk_vulkan_memory_map() */
+}
+
+void
+gsk_vulkan_memory_get_stats (GdkVulkanContext     *context,
+                             GskVulkanMemoryStats *stats)
+{
+  GskVulkanMemoryAllocator *allocator;
+
+  allocator = g_object_get_qdata (G_OBJECT (context), gsk_vulkan_memory_allocator_quark ());
+  if (allocator == NULL)
+    {
+      *stats = (GskVulkanMemoryStats) { 0, };
+      return;
+    }
+
+  g_mutex_lock (&allocator->lock);
+  *stats = allocator->stats;
+  g_mutex_unlock (&allocator->lock);
 }
 
+/* Frees all chunks while the device is still around. If some memory
+ * is still in use, the chunks get freed with the context instead. */
+void
+gsk_vulkan_memory_release_all (GdkVulkanContext *context)
+{
+  GskVulkanMemoryAllocator *allocator;
+
+  allocator = g_object_get_qdata (G_OBJECT (context), gsk_vulkan_memory_allocator_quark ());
+  if (allocator == NULL || allocator->n_memories > 0)
+    return;
+
+  g_object_set_qdata (G_OBJECT (context), gsk_vulkan_memory_allocator_quark (), NULL);
+}
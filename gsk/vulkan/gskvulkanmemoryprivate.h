@@ -7,17 +7,38 @@ G_BEGIN_DECLS
 
 typedef struct _GskVulkanMemory GskVulkanMemory;
 
+/* Memory with different flags is never allocated from the same
+ * VkDeviceMemory. The default is short-lived memory for linear
+ * resources (buffers and linear images). */
+typedef enum {
+  GSK_VULKAN_MEMORY_LONG_LIVED     = 1 << 0,
+  GSK_VULKAN_MEMORY_OPTIMAL_TILING = 1 << 1
+} GskVulkanMemoryFlags;
+
+typedef struct {
+  gsize n_device_allocations;
+  gsize allocated_bytes;
+  gsize used_bytes;
+} GskVulkanMemoryStats;
+
 GskVulkanMemory *       gsk_vulkan_memory_new                           (GdkVulkanContext       *context,
                                                                          uint32_t                allowed_types,
                                                                          VkMemoryPropertyFlags   properties,
-                                                                         gsize                   size);
+                                                                         gsize                   size,
+                                                                         gsize                   alignment,
+                                                                         GskVulkanMemoryFlags    flags);
 void                    gsk_vulkan_memory_free                          (GskVulkanMemory        *memory);
 
 VkDeviceMemory          gsk_vulkan_memory_get_device_memory             (GskVulkanMemory        *self);
+gsize                   gsk_vulkan_memory_get_offset                    (GskVulkanMemory        *self);
 
 guchar *                gsk_vulkan_memory_map                           (GskVulkanMemory        *self);
 void                    gsk_vulkan_memory_unmap                         (GskVulkanMemory        *self);
 
+void                    gsk_vulkan_memory_get_stats                     (GdkVulkanContext       *context,
+                                                                         GskVulkanMemoryStats   *stats);
+void                    gsk_vulkan_memory_release_all                   (GdkVulkanContext       *context);
+
 G_END_DECLS
 
 #endif /* __GSK_VULKAN_MEMORY_PRIVATE_H__ */
@@ -6,6 +6,7 @@
 #include "gskvulkanshaderprivate.h"
 
 #include <graphene.h>
+#include <errno.h>
 
 typedef struct _GskVulkanPipelinePrivate GskVulkanPipelinePrivate;
 
@@ -53,6 +54,152 @@ gsk_vulkan_pipeline_init (GskVulkanPipeline *self)
 {
 }
 
+/* The pipeline cache is shared by all pipelines of a context and saved
+ * to disk in gsk_vulkan_pipeline_cache_flush(), so later runs don't have
+ * to wait for the driver to compile all pipelines again.
+ *
+ * The file name contains the pipeline cache UUID and driver version, so
+ * a driver update or a different GPU doesn't pick up a stale cache. */
+typedef struct {
+  VkPipelineCache vk_cache;
+  char *filename;
+  gsize loaded_size;
+} PipelineCache;
+
+static GQuark
+gsk_vulkan_pipeline_cache_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gsk-vulkan-pipeline-cache");
+
+  return quark;
+}
+
+static char *
+gsk_vulkan_pipeline_cache_get_filename (GdkVulkanContext *context)
+{
+  VkPhysicalDeviceProperties properties;
+  GString *name;
+  char *filename;
+  guint i;
+
+  vkGetPhysicalDeviceProperties (gdk_vulkan_context_get_physical_device (context),
+                                 &properties);
+
+  name = g_string_new (NULL);
+  for (i = 0; i < VK_UUID_SIZE; i++)
+    g_string_append_printf (name, "%02x", properties.pipelineCacheUUID[i]);
+  g_string_append_printf (name, "-%08x-%08x-%08x.cache",
+                          properties.vendorID,
+                          properties.deviceID,
+                          properties.driverVersion);
+
+  filename = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "vulkan-pipeline-cache", name->str, NULL);
+  g_string_free (name, TRUE);
+
+  return filename;
+}
+
+static void
+pipeline_cache_free (gpointer data)
+{
+  PipelineCache *cache = data;
+
+  g_free (cache->filename);
+  g_slice_free (PipelineCache, cache);
+}
+
+static VkPipelineCache
+gsk_vulkan_pipeline_cache_get (GdkVulkanContext *context)
+{
+  PipelineCache *cache;
+  GError *error = NULL;
+  char *data = NULL;
+  gsize size = 0;
+
+  cache = g_object_get_qdata (G_OBJECT (context), gsk_vulkan_pipeline_cache_quark ());
+  if (cache)
+    return cache->vk_cache;
+
+  cache = g_slice_new0 (PipelineCache);
+  cache->filename = gsk_vulkan_pipeline_cache_get_filename (context);
+
+  if (!g_file_get_contents (cache->filename, &data, &size, &error))
+    {
+      GSK_NOTE (VULKAN, g_message ("Not loading pipeline cache: %s", error->message));
+      g_clear_error (&error);
+      size = 0;
+    }
+
+  /* The driver checks the header and ignores data it can't use */
+  if (GSK_VK_CHECK (vkCreatePipelineCache, gdk_vulkan_context_get_device (context),
+                                           &(VkPipelineCacheCreateInfo) {
+                                               .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                                               .initialDataSize = size,
+                                               .pInitialData = data
+                                           },
+                                           NULL,
+                                           &cache->vk_cache) != VK_SUCCESS)
+    cache->vk_cache = VK_NULL_HANDLE;
+  else
+    cache->loaded_size = size;
+
+  g_free (data);
+
+  g_object_set_qdata_full (G_OBJECT (context), gsk_vulkan_pipeline_cache_quark (),
+                           cache, pipeline_cache_free);
+
+  return cache->vk_cache;
+}
+
+/* Saves the pipeline cache if it got new pipelines and destroys it.
+ * This must be called before the device goes away. */
+void
+gsk_vulkan_pipeline_cache_flush (GdkVulkanContext *context)
+{
+  VkDevice device = gdk_vulkan_context_get_device (context);
+  PipelineCache *cache;
+  GError *error = NULL;
+  char *dirname;
+  void *data;
+  size_t size;
+
+  cache = g_object_get_qdata (G_OBJECT (context), gsk_vulkan_pipeline_cache_quark ());
+  if (cache == NULL)
+    return;
+
+  if (cache->vk_cache == VK_NULL_HANDLE)
+    goto out;
+
+  if (GSK_VK_CHECK (vkGetPipelineCacheData, device, cache->vk_cache, &size, NULL) != VK_SUCCESS ||
+      size == cache->loaded_size)
+    goto out;
+
+  data = g_malloc (size);
+  if (GSK_VK_CHECK (vkGetPipelineCacheData, device, cache->vk_cache, &size, data) == VK_SUCCESS)
+    {
+      dirname = g_path_get_dirname (cache->filename);
+      if (g_mkdir_with_parents (dirname, 0700) != 0 ||
+          !g_file_set_contents (cache->filename, data, size, &error))
+        {
+          GSK_NOTE (VULKAN, g_message ("Failed to save pipeline cache to %s: %s",
+                                       cache->filename,
+                                       error ? error->message : g_strerror (errno)));
+          g_clear_error (&error);
+        }
+      g_free (dirname);
+    }
+  g_free (data);
+
+out:
+  if (cache->vk_cache != VK_NULL_HANDLE)
+    vkDestroyPipelineCache (device, cache->vk_cache, NULL);
+
+  g_object_set_qdata (G_OBJECT (context), gsk_vulkan_pipeline_cache_quark (), NULL);
+}
+
 GskVulkanPipeline *
 gsk_vulkan_pipeline_new (GType                    pipeline_type,
                          GdkVulkanContext        *context,
@@ -96,7 +243,7 @@ gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
   priv->fragment_shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_FRAGMENT, shader_name, NULL);
 
   GSK_VK_CHECK (vkCreateGraphicsPipelines, device,
-                                           VK_NULL_HANDLE,
+                                           gsk_vulkan_pipeline_cache_get (context),
                                            1,
                                            &(VkGraphicsPipelineCreateInfo) {
                                                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -26,6 +26,9 @@
 #define DESCRIPTOR_POOL_MAXSETS 128
 #define DESCRIPTOR_POOL_MAXSETS_INCREASE 128
 
+/* Upper limit for the threads recording render passes in parallel */
+#define MAX_RECORD_THREADS 4
+
 struct _GskVulkanRender
 {
   GskRenderer *renderer;
@@ -58,6 +61,13 @@ struct _GskVulkanRender
   GList *render_passes;
   GSList *cleanup_images;
 
+  /* For recording render passes in parallel, see gsk_vulkan_render_draw() */
+  GThreadPool *record_pool;
+  GPtrArray *record_command_pools;
+  GMutex record_lock;
+  GCond record_cond;
+  guint n_pending_records;
+
   GQuark render_pass_counter;
   GQuark gpu_time_timer;
 };
@@ -255,6 +265,10 @@ gsk_vulkan_render_new (GskRenderer      *renderer,
 
   self->uploader = gsk_vulkan_uploader_new (self->vulkan, self->command_pool);
 
+  self->record_command_pools = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_vulkan_command_pool_free);
+  g_mutex_init (&self->record_lock);
+  g_cond_init (&self->record_cond);
+
 #ifdef G_ENABLE_DEBUG
   self->render_pass_counter = g_quark_from_static_string ("render-passes");
   self->gpu_time_timer = g_quark_from_static_string ("gpu-time");
@@ -587,9 +601,64 @@ gsk_vulkan_render_prepare_descriptor_sets (GskVulkanRender *self)
     }
 }
 
+typedef struct {
+  GskVulkanRenderPass *pass;
+  GskVulkanCommandPool *command_pool;
+  VkCommandBuffer command_buffer;
+} RecordJob;
+
+static void
+gsk_vulkan_render_record_pass (GskVulkanRender *self,
+                               RecordJob       *job)
+{
+  job->command_buffer = gsk_vulkan_command_pool_get_buffer (job->command_pool);
+
+  gsk_vulkan_render_pass_draw (job->pass, self, 3, self->pipeline_layout, job->command_buffer);
+
+  gsk_vulkan_command_pool_end_buffer (job->command_pool, job->command_buffer);
+}
+
+static void
+gsk_vulkan_render_record_thread (gpointer data,
+                                 gpointer user_data)
+{
+  GskVulkanRender *self = user_data;
+  RecordJob *job = data;
+
+  gsk_vulkan_render_record_pass (self, job);
+
+  g_mutex_lock (&self->record_lock);
+  self->n_pending_records--;
+  if (self->n_pending_records == 0)
+    g_cond_signal (&self->record_cond);
+  g_mutex_unlock (&self->record_lock);
+}
+
+static int
+gsk_vulkan_render_get_n_record_threads (void)
+{
+  static int n_threads = -1;
+
+  if (n_threads < 0)
+    n_threads = CLAMP ((int) g_get_num_processors () - 1, 0, MAX_RECORD_THREADS);
+
+  return n_threads;
+}
+
+/* Records all render passes into their own command buffer and submits
+ * them with a single vkQueueSubmit().
+ *
+ * Command pools must not be used from more than one thread at a time,
+ * so every render pass records from its own pool. The pools are kept
+ * around and reset together with the main one. */
 void
 gsk_vulkan_render_draw (GskVulkanRender *self)
 {
+  VkPipelineStageFlags *wait_stages;
+  VkSubmitInfo *submits;
+  RecordJob *jobs;
+  guint n_passes, n_wait_stages;
+  guint i;
   GList *l;
 
 #ifdef G_ENABLE_DEBUG
@@ -599,31 +668,85 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
 
   gsk_vulkan_render_prepare_descriptor_sets (self);
 
-  for (l = self->render_passes; l; l = l->next)
+  n_passes = g_list_length (self->render_passes);
+
+  while (self->record_command_pools->len < n_passes)
+    g_ptr_array_add (self->record_command_pools, gsk_vulkan_command_pool_new (self->vulkan));
+
+  jobs = g_newa (RecordJob, MAX (n_passes, 1));
+  n_wait_stages = 0;
+  for (l = self->render_passes, i = 0; l; l = l->next, i++)
     {
-      GskVulkanRenderPass *pass = l->data;
-      VkCommandBuffer command_buffer;
-      gsize wait_semaphore_count;
-      gsize signal_semaphore_count;
-      VkSemaphore *wait_semaphores;
-      VkSemaphore *signal_semaphores;
+      VkSemaphore *semaphores;
 
-      wait_semaphore_count = gsk_vulkan_render_pass_get_wait_semaphores (pass, &wait_semaphores);
-      signal_semaphore_count = gsk_vulkan_render_pass_get_signal_semaphores (pass, &signal_semaphores);
+      jobs[i].pass = l->data;
+      jobs[i].command_pool = g_ptr_array_index (self->record_command_pools, i);
+      jobs[i].command_buffer = VK_NULL_HANDLE;
 
-      command_buffer = gsk_vulkan_command_pool_get_buffer (self->command_pool);
+      /* Everything that isn't plain command recording happens here */
+      gsk_vulkan_render_pass_prepare_draw (jobs[i].pass, self);
 
-      gsk_vulkan_render_pass_draw (pass, self, 3, self->pipeline_layout, command_buffer);
+      n_wait_stages = MAX (n_wait_stages, gsk_vulkan_render_pass_get_wait_semaphores (jobs[i].pass, &semaphores));
+    }
 
-      gsk_vulkan_command_pool_submit_buffer (self->command_pool,
-                                             command_buffer,
-                                             wait_semaphore_count,
-                                             wait_semaphores,
-                                             signal_semaphore_count,
-                                             signal_semaphores,
-                                             l->next != NULL ? VK_NULL_HANDLE : self->fence);
+  if (n_passes > 1 && gsk_vulkan_render_get_n_record_threads () > 0)
+    {
+      if (self->record_pool == NULL)
+        self->record_pool = g_thread_pool_new (gsk_vulkan_render_record_thread,
+                                               self,
+                                               gsk_vulkan_render_get_n_record_threads (),
+                                               FALSE,
+                                               NULL);
+
+      self->n_pending_records = n_passes - 1;
+      for (i = 1; i < n_passes; i++)
+        g_thread_pool_push (self->record_pool, &jobs[i], NULL);
+
+      gsk_vulkan_render_record_pass (self, &jobs[0]);
+
+      g_mutex_lock (&self->record_lock);
+      while (self->n_pending_records > 0)
+        g_cond_wait (&self->record_cond, &self->record_lock);
+      g_mutex_unlock (&self->record_lock);
+    }
+  else
+    {
+      for (i = 0; i < n_passes; i++)
+        gsk_vulkan_render_record_pass (self, &jobs[i]);
     }
 
+  wait_stages = g_newa (VkPipelineStageFlags, MAX (n_wait_stages, 1));
+  for (i = 0; i < n_wait_stages; i++)
+    wait_stages[i] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+  submits = g_newa (VkSubmitInfo, MAX (n_passes, 1));
+  for (i = 0; i < n_passes; i++)
+    {
+      VkSemaphore *wait_semaphores;
+      VkSemaphore *signal_semaphores;
+      gsize wait_semaphore_count;
+      gsize signal_semaphore_count;
+
+      wait_semaphore_count = gsk_vulkan_render_pass_get_wait_semaphores (jobs[i].pass, &wait_semaphores);
+      signal_semaphore_count = gsk_vulkan_render_pass_get_signal_semaphores (jobs[i].pass, &signal_semaphores);
+
+      submits[i] = (VkSubmitInfo) {
+          .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+          .waitSemaphoreCount = wait_semaphore_count,
+          .pWaitSemaphores = wait_semaphores,
+          .pWaitDstStageMask = wait_semaphore_count > 0 ? wait_stages : NULL,
+          .commandBufferCount = 1,
+          .pCommandBuffers = &jobs[i].command_buffer,
+          .signalSemaphoreCount = signal_semaphore_count,
+          .pSignalSemaphores = signal_semaphores,
+      };
+    }
+
+  GSK_VK_CHECK (vkQueueSubmit, gdk_vulkan_context_get_queue (self->vulkan),
+                               n_passes,
+                               submits,
+                               self->fence);
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (self->renderer, SYNC))
     {
@@ -655,6 +778,7 @@ static void
 gsk_vulkan_render_cleanup (GskVulkanRender *self)
 {
   VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  guint i;
 
   /* XXX: Wait for fence here or just in reset()? */
   GSK_VK_CHECK (vkWaitForFences, device,
@@ -670,6 +794,8 @@ gsk_vulkan_render_cleanup (GskVulkanRender *self)
   gsk_vulkan_uploader_reset (self->uploader);
 
   gsk_vulkan_command_pool_reset (self->command_pool);
+  for (i = 0; i < self->record_command_pools->len; i++)
+    gsk_vulkan_command_pool_reset (g_ptr_array_index (self->record_command_pools, i));
 
   g_hash_table_remove_all (self->descriptor_set_indexes);
   GSK_VK_CHECK (vkResetDescriptorPool, device,
@@ -747,6 +873,12 @@ gsk_vulkan_render_free (GskVulkanRender *self)
                     self->repeating_sampler,
                     NULL);
 
+  if (self->record_pool)
+    g_thread_pool_free (self->record_pool, FALSE, TRUE);
+  g_ptr_array_unref (self->record_command_pools);
+  g_mutex_clear (&self->record_lock);
+  g_cond_clear (&self->record_cond);
+
   gsk_vulkan_command_pool_free (self->command_pool);
 
   g_slice_free (GskVulkanRender, self);
@@ -6,8 +6,10 @@
 #include "gskprivate.h"
 #include "gskrendererprivate.h"
 #include "gskrendernodeprivate.h"
+#include "gskroundedrectprivate.h"
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderprivate.h"
 #include "gskvulkanglyphcacheprivate.h"
@@ -25,12 +27,43 @@ struct _GskVulkanTextureData {
   GskVulkanRenderer *renderer;
 };
 
+/* A fallback node as uploaded by a render pass. The entry keeps the
+ * node alive, so its address can't be reused by a different node. */
+typedef struct _GskVulkanFallback GskVulkanFallback;
+
+struct _GskVulkanFallback {
+  GskRenderNode *node;
+  float scale;
+  gboolean has_clip;
+  GskRoundedRect clip;
+  GskVulkanImage *image;
+  gboolean in_use;
+};
+
+/* A node that a render pass drew into an offscreen image. Nodes are
+ * immutable, so the pixels stay valid as long as the node is drawn with
+ * the same transform into the same area. */
+typedef struct _GskVulkanOffscreen GskVulkanOffscreen;
+
+struct _GskVulkanOffscreen {
+  GskRenderNode *node;
+  float scale;
+  graphene_matrix_t mv;
+  graphene_rect_t view;
+  GskVulkanImage *image;
+  gboolean in_use;
+};
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark frames;
   GQuark render_passes;
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  GQuark culled_nodes;
+  GQuark memory_allocations;
+  GQuark memory_allocated;
+  GQuark memory_used;
 } ProfileCounters;
 
 typedef struct {
@@ -39,6 +72,12 @@ typedef struct {
 } ProfileTimers;
 #endif
 
+/* Every frame uses its own GskVulkanRender, so recording the next
+ * frame only waits for the one that was submitted this many frames
+ * ago and the CPU can work on a frame while the GPU draws the last.
+ */
+#define N_FRAMES_IN_FLIGHT 2
+
 static guint texture_pixels_counter;
 static guint fallback_pixels_counter;
 
@@ -51,9 +90,12 @@ struct _GskVulkanRenderer
   guint n_targets;
   GskVulkanImage **targets;
 
-  GskVulkanRender *render;
+  GskVulkanRender *renders[N_FRAMES_IN_FLIGHT];
+  guint current_render;
 
   GSList *textures;
+  GHashTable *fallbacks;
+  GHashTable *offscreens;
 
   GskVulkanGlyphCache *glyph_cache;
 
@@ -84,6 +126,128 @@ gsk_vulkan_renderer_free_targets (GskVulkanRenderer *self)
   self->n_targets = 0;
 }
 
+static guint
+gsk_vulkan_fallback_hash (gconstpointer v)
+{
+  const GskVulkanFallback *fallback = v;
+
+  return GPOINTER_TO_UINT (fallback->node) ^ ((guint) (fallback->scale * 100) << 16);
+}
+
+static gboolean
+gsk_vulkan_fallback_equal (gconstpointer v1,
+                           gconstpointer v2)
+{
+  const GskVulkanFallback *f1 = v1;
+  const GskVulkanFallback *f2 = v2;
+
+  if (f1->node != f2->node ||
+      f1->scale != f2->scale ||
+      f1->has_clip != f2->has_clip)
+    return FALSE;
+
+  return !f1->has_clip || gsk_rounded_rect_equal (&f1->clip, &f2->clip);
+}
+
+static void
+gsk_vulkan_fallback_free (gpointer data)
+{
+  GskVulkanFallback *fallback = data;
+
+  gsk_render_node_unref (fallback->node);
+  g_object_unref (fallback->image);
+  g_slice_free (GskVulkanFallback, fallback);
+}
+
+static void
+gsk_vulkan_fallback_init_key (GskVulkanFallback    *key,
+                              GskRenderNode        *node,
+                              float                 scale,
+                              const GskRoundedRect *clip)
+{
+  key->node = node;
+  key->scale = scale;
+  key->has_clip = clip != NULL;
+  if (clip)
+    key->clip = *clip;
+}
+
+static gboolean
+gsk_vulkan_fallback_is_stale (gpointer key,
+                              gpointer value,
+                              gpointer user_data)
+{
+  GskVulkanFallback *fallback = key;
+
+  if (fallback->in_use)
+    {
+      fallback->in_use = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static guint
+gsk_vulkan_offscreen_hash (gconstpointer v)
+{
+  const GskVulkanOffscreen *offscreen = v;
+
+  return GPOINTER_TO_UINT (offscreen->node) ^ ((guint) (offscreen->scale * 100) << 16);
+}
+
+static gboolean
+gsk_vulkan_offscreen_equal (gconstpointer v1,
+                            gconstpointer v2)
+{
+  const GskVulkanOffscreen *o1 = v1;
+  const GskVulkanOffscreen *o2 = v2;
+
+  return o1->node == o2->node &&
+         o1->scale == o2->scale &&
+         graphene_rect_equal (&o1->view, &o2->view) &&
+         graphene_matrix_equal_fast (&o1->mv, &o2->mv);
+}
+
+static void
+gsk_vulkan_offscreen_free (gpointer data)
+{
+  GskVulkanOffscreen *offscreen = data;
+
+  gsk_render_node_unref (offscreen->node);
+  g_object_unref (offscreen->image);
+  g_slice_free (GskVulkanOffscreen, offscreen);
+}
+
+static void
+gsk_vulkan_offscreen_init_key (GskVulkanOffscreen      *key,
+                               GskRenderNode           *node,
+                               float                    scale,
+                               const graphene_matrix_t *mv,
+                               const graphene_rect_t   *view)
+{
+  key->node = node;
+  key->scale = scale;
+  graphene_matrix_init_from_matrix (&key->mv, mv);
+  key->view = *view;
+}
+
+static gboolean
+gsk_vulkan_offscreen_is_stale (gpointer key,
+                               gpointer value,
+                               gpointer user_data)
+{
+  GskVulkanOffscreen *offscreen = key;
+
+  if (offscreen->in_use)
+    {
+      offscreen->in_use = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gsk_vulkan_renderer_update_images_cb (GdkVulkanContext  *context,
                                       GskVulkanRenderer *self)
@@ -118,6 +282,7 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
                              GError      **error)
 {
   GskVulkanRenderer *self = GSK_VULKAN_RENDERER (renderer);
+  guint i;
 
   self->vulkan = gdk_surface_create_vulkan_context (window, error);
   if (self->vulkan == NULL)
@@ -129,10 +294,20 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
                     self);
   gsk_vulkan_renderer_update_images_cb (self->vulkan, self);
 
-  self->render = gsk_vulkan_render_new (renderer, self->vulkan);
+  for (i = 0; i < N_FRAMES_IN_FLIGHT; i++)
+    self->renders[i] = gsk_vulkan_render_new (renderer, self->vulkan);
 
   self->glyph_cache = gsk_vulkan_glyph_cache_new (renderer, self->vulkan);
 
+  self->fallbacks = g_hash_table_new_full (gsk_vulkan_fallback_hash,
+                                           gsk_vulkan_fallback_equal,
+                                           gsk_vulkan_fallback_free,
+                                           NULL);
+  self->offscreens = g_hash_table_new_full (gsk_vulkan_offscreen_hash,
+                                            gsk_vulkan_offscreen_equal,
+                                            gsk_vulkan_offscreen_free,
+                                            NULL);
+
   return TRUE;
 }
 
@@ -141,8 +316,11 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
 {
   GskVulkanRenderer *self = GSK_VULKAN_RENDERER (renderer);
   GSList *l;
+  guint i;
 
   g_clear_object (&self->glyph_cache);
+  g_clear_pointer (&self->fallbacks, g_hash_table_unref);
+  g_clear_pointer (&self->offscreens, g_hash_table_unref);
 
   for (l = self->textures; l; l = l->next)
     {
@@ -153,16 +331,35 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
     }
   g_clear_pointer (&self->textures, g_slist_free);
 
-  g_clear_pointer (&self->render, gsk_vulkan_render_free);
+  for (i = 0; i < N_FRAMES_IN_FLIGHT; i++)
+    g_clear_pointer (&self->renders[i], gsk_vulkan_render_free);
 
   gsk_vulkan_renderer_free_targets (self);
   g_signal_handlers_disconnect_by_func(self->vulkan,
                                        gsk_vulkan_renderer_update_images_cb,
                                        self);
 
+  gsk_vulkan_pipeline_cache_flush (self->vulkan);
+  gsk_vulkan_memory_release_all (self->vulkan);
+
   g_clear_object (&self->vulkan);
 }
 
+#ifdef G_ENABLE_DEBUG
+static void
+gsk_vulkan_renderer_update_memory_counters (GskVulkanRenderer *self,
+                                            GskProfiler       *profiler)
+{
+  GskVulkanMemoryStats stats;
+
+  gsk_vulkan_memory_get_stats (self->vulkan, &stats);
+
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocations, stats.n_device_allocations);
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocated, stats.allocated_bytes);
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_used, stats.used_bytes);
+}
+#endif
+
 static GdkTexture *
 gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
                                     GskRenderNode         *root,
@@ -201,6 +398,9 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
 
   texture = gsk_vulkan_render_download_target (render);
 
+  g_hash_table_foreach_remove (self->fallbacks, gsk_vulkan_fallback_is_stale, NULL);
+  g_hash_table_foreach_remove (self->offscreens, gsk_vulkan_offscreen_is_stale, NULL);
+
   g_object_unref (image);
   gsk_vulkan_render_free (render);
 
@@ -209,6 +409,8 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
+
   gsk_profiler_push_samples (profiler);
 
   if (gdk_profiler_is_running ())
@@ -244,11 +446,13 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
   gsk_profiler_counter_set (profiler, self->profile_counters.fallback_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.texture_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.render_passes, 0);
+  gsk_profiler_counter_set (profiler, self->profile_counters.culled_nodes, 0);
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->vulkan), region);
-  render = self->render;
+  self->current_render = (self->current_render + 1) % N_FRAMES_IN_FLIGHT;
+  render = self->renders[self->current_render];
 
   clip = gdk_draw_context_get_frame_region (GDK_DRAW_CONTEXT (self->vulkan));
   gsk_vulkan_render_reset (render, self->targets[gdk_vulkan_context_get_draw_index (self->vulkan)], NULL, clip);
@@ -259,12 +463,19 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
 
   gsk_vulkan_render_draw (render);
 
+  /* Like the GL renderer, keep what the last frame used. The renders
+   * still in flight hold their own references on the images. */
+  g_hash_table_foreach_remove (self->fallbacks, gsk_vulkan_fallback_is_stale, NULL);
+  g_hash_table_foreach_remove (self->offscreens, gsk_vulkan_offscreen_is_stale, NULL);
+
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (profiler, self->profile_counters.frames);
 
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
+
   gsk_profiler_push_samples (profiler);
 #endif
 
@@ -296,6 +507,10 @@ gsk_vulkan_renderer_init (GskVulkanRenderer *self)
   self->profile_counters.render_passes = gsk_profiler_add_counter (profiler, "render-passes", "Render passes", FALSE);
   self->profile_counters.fallback_pixels = gsk_profiler_add_counter (profiler, "fallback-pixels", "Fallback pixels", TRUE);
   self->profile_counters.texture_pixels = gsk_profiler_add_counter (profiler, "texture-pixels", "Texture pixels", TRUE);
+  self->profile_counters.culled_nodes = gsk_profiler_add_counter (profiler, "culled-nodes", "Nodes hidden by opaque nodes", TRUE);
+  self->profile_counters.memory_allocations = gsk_profiler_add_counter (profiler, "memory-allocations", "Device memory allocations", FALSE);
+  self->profile_counters.memory_allocated = gsk_profiler_add_counter (profiler, "memory-allocated", "Device memory allocated", FALSE);
+  self->profile_counters.memory_used = gsk_profiler_add_counter (profiler, "memory-used", "Device memory in use", FALSE);
 
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), SYNC))
@@ -362,6 +577,84 @@ gsk_vulkan_renderer_ref_texture_image (GskVulkanRenderer *self,
   return image;
 }
 
+/* Returns a new reference to the image a previous frame uploaded for
+ * node at this scale and clip, or %NULL if there is none */
+GskVulkanImage *
+gsk_vulkan_renderer_ref_fallback_image (GskVulkanRenderer    *self,
+                                        GskRenderNode        *node,
+                                        float                 scale,
+                                        const GskRoundedRect *clip)
+{
+  GskVulkanFallback key, *fallback;
+
+  gsk_vulkan_fallback_init_key (&key, node, scale, clip);
+
+  fallback = g_hash_table_lookup (self->fallbacks, &key);
+  if (fallback == NULL)
+    return NULL;
+
+  fallback->in_use = TRUE;
+
+  return g_object_ref (fallback->image);
+}
+
+void
+gsk_vulkan_renderer_cache_fallback_image (GskVulkanRenderer    *self,
+                                          GskRenderNode        *node,
+                                          float                 scale,
+                                          const GskRoundedRect *clip,
+                                          GskVulkanImage       *image)
+{
+  GskVulkanFallback *fallback;
+
+  fallback = g_slice_new (GskVulkanFallback);
+  gsk_vulkan_fallback_init_key (fallback, gsk_render_node_ref (node), scale, clip);
+  fallback->image = g_object_ref (image);
+  fallback->in_use = TRUE;
+
+  g_hash_table_add (self->fallbacks, fallback);
+}
+
+/* Returns a new reference to the image a previous frame rendered node
+ * into with the given transform and view, or %NULL if there is none */
+GskVulkanImage *
+gsk_vulkan_renderer_ref_offscreen_image (GskVulkanRenderer       *self,
+                                         GskRenderNode           *node,
+                                         float                    scale,
+                                         const graphene_matrix_t *mv,
+                                         const graphene_rect_t   *view)
+{
+  GskVulkanOffscreen key, *offscreen;
+
+  gsk_vulkan_offscreen_init_key (&key, node, scale, mv, view);
+
+  offscreen = g_hash_table_lookup (self->offscreens, &key);
+  if (offscreen == NULL)
+    return NULL;
+
+  offscreen->in_use = TRUE;
+
+  return g_object_ref (offscreen->image);
+}
+
+void
+gsk_vulkan_renderer_cache_offscreen_image (GskVulkanRenderer       *self,
+                                           GskRenderNode           *node,
+                                           float                    scale,
+                                           const graphene_matrix_t *mv,
+                                           const graphene_rect_t   *view,
+                                           GskVulkanImage          *image)
+{
+  GskVulkanOffscreen *offscreen;
+
+  offscreen = g_slice_new (GskVulkanOffscreen);
+  gsk_vulkan_offscreen_init_key (offscreen, gsk_render_node_ref (node), scale, mv, view);
+  offscreen->image = g_object_ref (image);
+  offscreen->in_use = TRUE;
+
+  g_hash_table_add (self->offscreens, offscreen);
+}
+
 guint
 gsk_vulkan_renderer_cache_glyph (GskVulkanRenderer *self,
                                  PangoFont         *font,
@@ -10,6 +10,28 @@ GskVulkanImage *        gsk_vulkan_renderer_ref_texture_image           (GskVulk
                                                                          GdkTexture             *texture,
                                                                          GskVulkanUploader      *uploader);
 
+GskVulkanImage *        gsk_vulkan_renderer_ref_fallback_image          (GskVulkanRenderer      *self,
+                                                                         GskRenderNode          *node,
+                                                                         float                   scale,
+                                                                         const GskRoundedRect   *clip);
+void                    gsk_vulkan_renderer_cache_fallback_image        (GskVulkanRenderer      *self,
+                                                                         GskRenderNode          *node,
+                                                                         float                   scale,
+                                                                         const GskRoundedRect   *clip,
+                                                                         GskVulkanImage         *image);
+
+GskVulkanImage *        gsk_vulkan_renderer_ref_offscreen_image         (GskVulkanRenderer      *self,
+                                                                         GskRenderNode          *node,
+                                                                         float                   scale,
+                                                                         const graphene_matrix_t *mv,
+                                                                         const graphene_rect_t  *view);
+void                    gsk_vulkan_renderer_cache_offscreen_image       (GskVulkanRenderer      *self,
+                                                                         GskRenderNode          *node,
+                                                                         float                   scale,
+                                                                         const graphene_matrix_t *mv,
+                                                                         const graphene_rect_t  *view,
+                                                                         GskVulkanImage         *image);
+
 typedef struct
 {
   guint texture_index;
@@ -128,6 +128,7 @@ struct _GskVulkanRenderPass
 
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  GQuark culled_nodes;
 };
 
 GskVulkanRenderPass *
@@ -209,6 +210,7 @@ gsk_vulkan_render_pass_new (GdkVulkanContext  *context,
 #ifdef G_ENABLE_DEBUG
   self->fallback_pixels = g_quark_from_static_string ("fallback-pixels");
   self->texture_pixels = g_quark_from_static_string ("texture-pixels");
+  self->culled_nodes = g_quark_from_static_string ("culled-nodes");
 #endif
 
   return self;
@@ -276,6 +278,9 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
       g_assert_not_reached ();
       return;
     case GSK_SHADOW_NODE:
+    /* Vulkan pipelines use precompiled SPIR-V shaders, none exists yet */
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     default:
       FALLBACK ("Unsupported node '%s'", node->node_class->type_name);
 
@@ -537,12 +542,36 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
 
     case GSK_CONTAINER_NODE:
       {
+        const guint n_children = gsk_container_node_get_n_children (node);
+        guint8 *hidden;
+        guint n_hidden;
         guint i;
 
-        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        /* Opacity is applied to offscreens here, so opaque children
+         * always hide what is under them */
+        if (n_children <= 512)
+          hidden = g_alloca (n_children);
+        else
+          hidden = g_malloc (n_children);
+
+        n_hidden = gsk_container_node_get_hidden_children (node, 0, hidden);
+
+#ifdef G_ENABLE_DEBUG
+        gsk_profiler_counter_add (gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render)),
+                                  self->culled_nodes,
+                                  n_hidden);
+#endif
+
+        for (i = 0; i < n_children; i++)
           {
+            if (n_hidden > 0 && hidden[i])
+              continue;
+
             gsk_vulkan_render_pass_add_node (self, render, constants, gsk_container_node_get_child (node, i));
           }
+
+        if (n_children > 512)
+          g_free (hidden);
       }
       return;
 
@@ -666,6 +695,7 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
                                             GskVulkanClip         *current_clip,
                                             graphene_rect_t       *tex_rect)
 {
+  GskVulkanRenderer *renderer = GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render));
   GskVulkanImage *result;
   cairo_surface_t *surface;
   cairo_t *cr;
@@ -713,6 +743,23 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
         view.size.width = ceil (view.size.width);
         view.size.height = ceil (view.size.height);
 
+        /* assuming the unclipped bounds should go to texture coordinates 0..1,
+         * calculate the coordinates for the clipped texture size
+         */
+        tex_rect->origin.x = (bounds->origin.x - clipped.origin.x)/clipped.size.width;
+        tex_rect->origin.y = (bounds->origin.y - clipped.origin.y)/clipped.size.height;
+        tex_rect->size.width = bounds->size.width/clipped.size.width;
+        tex_rect->size.height = bounds->size.height/clipped.size.height;
+
+        /* A previous frame may have drawn the same node into the same
+         * area already, then there is no need for another pass */
+        result = gsk_vulkan_renderer_ref_offscreen_image (renderer, node, self->scale_factor, &self->mv, &view);
+        if (result)
+          {
+            gsk_vulkan_render_add_cleanup_image (render, result);
+            return result;
+          }
+
         result = gsk_vulkan_image_new_for_texture (self->vulkan,
                                                    view.size.width,
                                                    view.size.height);
@@ -755,16 +802,9 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
 
         gsk_vulkan_render_add_render_pass (render, pass);
         gsk_vulkan_render_pass_add (pass, render, node);
+        gsk_vulkan_renderer_cache_offscreen_image (renderer, node, self->scale_factor, &self->mv, &view, result);
         gsk_vulkan_render_add_cleanup_image (render, result);
 
-        /* assuming the unclipped bounds should go to texture coordinates 0..1,
-         * calculate the coordinates for the clipped texture size
-         */
-        tex_rect->origin.x = (bounds->origin.x - clipped.origin.x)/clipped.size.width;
-        tex_rect->origin.y = (bounds->origin.y - clipped.origin.y)/clipped.size.height;
-        tex_rect->size.width = bounds->size.width/clipped.size.width;
-        tex_rect->size.height = bounds->size.height/clipped.size.height;
-
         return result;
       }
    }
@@ -816,11 +856,24 @@ gsk_vulkan_render_pass_upload_fallback (GskVulkanRenderPass  *self,
                                         GskVulkanRender      *render,
                                         GskVulkanUploader    *uploader)
 {
+  GskVulkanRenderer *renderer = GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render));
+  const GskRoundedRect *clip;
   GskRenderNode *node;
   cairo_surface_t *surface;
   cairo_t *cr;
 
   node = op->node;
+  clip = op->type == GSK_VULKAN_OP_FALLBACK ? NULL : &op->clip;
+
+  /* Nodes don't change, so the pixels of a node that was drawn in the
+   * last frame, like the one of an unchanged drawing area, are still good */
+  op->source = gsk_vulkan_renderer_ref_fallback_image (renderer, node, self->scale_factor, clip);
+  if (op->source)
+    {
+      op->source_rect = GRAPHENE_RECT_INIT(0, 0, 1, 1);
+      gsk_vulkan_render_add_cleanup_image (render, op->source);
+      return;
+    }
 
   GSK_RENDERER_NOTE (gsk_vulkan_render_get_renderer (render), FALLBACK,
             g_message ("Upload op=%s, node %s[%p], bounds %gx%g",
@@ -877,6 +930,7 @@ gsk_vulkan_render_pass_upload_fallback (GskVulkanRenderPass  *self,
 
   cairo_surface_destroy (surface);
 
+  gsk_vulkan_renderer_cache_fallback_image (renderer, node, self->scale_factor, clip, op->source);
   gsk_vulkan_render_add_cleanup_image (render, op->source);
 }
 
@@ -1482,6 +1536,64 @@ gsk_vulkan_render_pass_reserve_descriptor_sets (GskVulkanRenderPass *self,
     }
 }
 
+/* Binds the descriptor sets of an op, skipping the ones that are bound
+ * already. All pipeline layouts use the same set layouts and push
+ * constants, so bindings stay valid when the pipeline changes. */
+static void
+gsk_vulkan_render_pass_bind_descriptor_sets (GskVulkanRender   *render,
+                                             VkCommandBuffer    command_buffer,
+                                             GskVulkanPipeline *pipeline,
+                                             gsize             *bound_sets,
+                                             guint              n_sets,
+                                             gsize              index,
+                                             gsize              index2)
+{
+  gsize indexes[2] = { index, index2 };
+  VkDescriptorSet sets[2];
+  guint first, j;
+
+  for (first = 0; first < n_sets; first++)
+    {
+      if (bound_sets[first] != indexes[first])
+        break;
+    }
+
+  if (first == n_sets)
+    return;
+
+  for (j = first; j < n_sets; j++)
+    {
+      sets[j - first] = gsk_vulkan_render_get_descriptor_set (render, indexes[j]);
+      bound_sets[j] = indexes[j];
+    }
+
+  vkCmdBindDescriptorSets (command_buffer,
+                           VK_PIPELINE_BIND_POINT_GRAPHICS,
+                           gsk_vulkan_pipeline_get_pipeline_layout (pipeline),
+                           first,
+                           n_sets - first,
+                           sets,
+                           0,
+                           NULL);
+}
+
+static gboolean
+gsk_vulkan_op_is_texture (GskVulkanOp *op)
+{
+  switch (op->type)
+    {
+    case GSK_VULKAN_OP_FALLBACK:
+    case GSK_VULKAN_OP_FALLBACK_CLIP:
+    case GSK_VULKAN_OP_FALLBACK_ROUNDED_CLIP:
+    case GSK_VULKAN_OP_TEXTURE:
+    case GSK_VULKAN_OP_REPEAT:
+      return op->render.source != NULL;
+
+    default:
+      return FALSE;
+    }
+}
+
 static void
 gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
                                   GskVulkanRender         *render,
@@ -1491,8 +1603,10 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
 {
   GskVulkanPipeline *current_pipeline = NULL;
   gsize current_draw_index = 0;
+  gsize bound_sets[2] = { G_MAXSIZE, G_MAXSIZE };
   GskVulkanOp *op;
   guint i, step;
+  guint n_glyphs;
   GskVulkanBuffer *vertex_buffer;
 
   vertex_buffer = gsk_vulkan_render_pass_get_vertex_data (self, render);
@@ -1527,20 +1641,22 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       1, op->render.descriptor_set_index, 0);
+
+          /* Draw the following ops that sample the same image at once */
+          for (step = 1; step + i < self->render_ops->len; step++)
+            {
+              GskVulkanOp *cmp = &g_array_index (self->render_ops, GskVulkanOp, i + step);
+              if (!gsk_vulkan_op_is_texture (cmp) ||
+                  cmp->render.pipeline != current_pipeline ||
+                  cmp->render.descriptor_set_index != op->render.descriptor_set_index)
+                break;
+            }
 
           current_draw_index += gsk_vulkan_texture_pipeline_draw (GSK_VULKAN_TEXTURE_PIPELINE (current_pipeline),
                                                                   command_buffer,
-                                                                  current_draw_index, 1);
+                                                                  current_draw_index, step);
           break;
 
         case GSK_VULKAN_OP_TEXT:
@@ -1560,20 +1676,24 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       1, op->text.descriptor_set_index, 0);
+
+          /* Glyphs of the same cache texture can be drawn at once */
+          n_glyphs = op->text.num_glyphs;
+          for (step = 1; step + i < self->render_ops->len; step++)
+            {
+              GskVulkanOp *cmp = &g_array_index (self->render_ops, GskVulkanOp, i + step);
+              if (cmp->type != GSK_VULKAN_OP_TEXT ||
+                  cmp->text.pipeline != current_pipeline ||
+                  cmp->text.descriptor_set_index != op->text.descriptor_set_index)
+                break;
+              n_glyphs += cmp->text.num_glyphs;
+            }
 
           current_draw_index += gsk_vulkan_text_pipeline_draw (GSK_VULKAN_TEXT_PIPELINE (current_pipeline),
                                                                command_buffer,
-                                                               current_draw_index, op->text.num_glyphs);
+                                                               current_draw_index, n_glyphs);
           break;
 
         case GSK_VULKAN_OP_COLOR_TEXT:
@@ -1593,20 +1713,24 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       1, op->text.descriptor_set_index, 0);
+
+          /* Glyphs of the same cache texture can be drawn at once */
+          n_glyphs = op->text.num_glyphs;
+          for (step = 1; step + i < self->render_ops->len; step++)
+            {
+              GskVulkanOp *cmp = &g_array_index (self->render_ops, GskVulkanOp, i + step);
+              if (cmp->type != GSK_VULKAN_OP_COLOR_TEXT ||
+                  cmp->text.pipeline != current_pipeline ||
+                  cmp->text.descriptor_set_index != op->text.descriptor_set_index)
+                break;
+              n_glyphs += cmp->text.num_glyphs;
+            }
 
           current_draw_index += gsk_vulkan_color_text_pipeline_draw (GSK_VULKAN_COLOR_TEXT_PIPELINE (current_pipeline),
                                                                      command_buffer,
-                                                                     current_draw_index, op->text.num_glyphs);
+                                                                     current_draw_index, n_glyphs);
           break;
 
         case GSK_VULKAN_OP_OPACITY:
@@ -1629,16 +1753,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       1, op->render.descriptor_set_index, 0);
 
           current_draw_index += gsk_vulkan_effect_pipeline_draw (GSK_VULKAN_EFFECT_PIPELINE (current_pipeline),
                                                                  command_buffer,
@@ -1664,16 +1780,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       1, op->render.descriptor_set_index, 0);
 
           current_draw_index += gsk_vulkan_blur_pipeline_draw (GSK_VULKAN_BLUR_PIPELINE (current_pipeline),
                                                                command_buffer,
@@ -1799,17 +1907,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   2,
-                                   (VkDescriptorSet[2]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index2)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       2, op->render.descriptor_set_index, op->render.descriptor_set_index2);
 
           current_draw_index += gsk_vulkan_cross_fade_pipeline_draw (GSK_VULKAN_CROSS_FADE_PIPELINE (current_pipeline),
                                                                      command_buffer,
@@ -1835,17 +1934,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   2,
-                                   (VkDescriptorSet[2]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index2)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_sets (render, command_buffer, current_pipeline, bound_sets,
+                                                       2, op->render.descriptor_set_index, op->render.descriptor_set_index2);
 
           current_draw_index += gsk_vulkan_blend_mode_pipeline_draw (GSK_VULKAN_BLEND_MODE_PIPELINE (current_pipeline),
                                                                      command_buffer,
@@ -1859,6 +1949,17 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
     }
 }
 
+/* Creates everything gsk_vulkan_render_pass_draw() would otherwise create
+ * lazily. After this, drawing only records into the command buffer and
+ * can be done from any thread. */
+void
+gsk_vulkan_render_pass_prepare_draw (GskVulkanRenderPass *self,
+                                     GskVulkanRender     *render)
+{
+  gsk_vulkan_render_pass_get_vertex_data (self, render);
+  gsk_vulkan_render_get_framebuffer (render, self->target);
+}
+
 void
 gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
                              GskVulkanRender         *render,
@@ -26,11 +26,18 @@
 
 struct _GtkContainerAccessiblePrivate
 {
-  GList *children;
+  GList *children;              /* the children ATs know about */
+
+  /* Children that have been added, but not announced yet */
+  GtkContainer *pending_container;
+  GHashTable *pending_children;
+  guint pending_id;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkContainerAccessible, gtk_container_accessible, GTK_TYPE_WIDGET_ACCESSIBLE)
 
+static void flush_pending_children (GtkContainerAccessible *accessible);
+
 static void
 count_widget (GtkWidget *widget,
               gint      *count)
@@ -48,6 +55,8 @@ gtk_container_accessible_get_n_children (AtkObject* obj)
   if (widget == NULL)
     return 0;
 
+  flush_pending_children (GTK_CONTAINER_ACCESSIBLE (obj));
+
   gtk_container_foreach (GTK_CONTAINER (widget), (GtkCallback) count_widget, &count);
   return count;
 }
@@ -64,6 +73,8 @@ gtk_container_accessible_ref_child (AtkObject *obj,
   if (widget == NULL)
     return NULL;
 
+  flush_pending_children (GTK_CONTAINER_ACCESSIBLE (obj));
+
   children = gtk_container_get_children (GTK_CONTAINER (widget));
   tmp_list = g_list_nth (children, i);
   if (!tmp_list)
@@ -117,24 +128,86 @@ _gtk_container_accessible_remove (GtkWidget *parent,
     klass->remove_gtk (GTK_CONTAINER (parent), child, obj);
 }
 
+/* Announces the children that have been added since the last time.
+ * They are announced in the order of their current positions, so the
+ * indexes are right for ATs that apply the events one after another.
+ * Their accessibles are only created here, so children that are
+ * removed again before this runs never get one.
+ */
+static void
+flush_pending_children (GtkContainerAccessible *accessible)
+{
+  GtkContainerAccessiblePrivate *priv = accessible->priv;
+  GtkContainer *container;
+  GHashTable *pending;
+  GList *children, *l;
+  gint index;
+
+  if (priv->pending_children == NULL)
+    return;
+
+  g_clear_handle_id (&priv->pending_id, g_source_remove);
+  container = g_steal_pointer (&priv->pending_container);
+  pending = g_steal_pointer (&priv->pending_children);
+
+  children = gtk_container_get_children (container);
+  g_list_free (priv->children);
+  priv->children = children;
+
+  for (l = children, index = 0; l; l = l->next, index++)
+    {
+      if (g_hash_table_contains (pending, l->data))
+        _gtk_container_accessible_add_child (accessible,
+                                             gtk_widget_get_accessible (l->data),
+                                             index);
+    }
+
+  g_hash_table_unref (pending);
+  g_object_unref (container);
+}
+
+static gboolean
+flush_pending_children_idle (gpointer data)
+{
+  GtkContainerAccessible *accessible = data;
+
+  accessible->priv->pending_id = 0;
+  flush_pending_children (accessible);
+
+  return G_SOURCE_REMOVE;
+}
+
 static gint
 gtk_container_accessible_real_add_gtk (GtkContainer *container,
                                        GtkWidget    *widget,
                                        gpointer      data)
 {
-  AtkObject *atk_parent;
-  AtkObject *atk_child;
   GtkContainerAccessible *accessible;
-  gint index;
+  GtkContainerAccessiblePrivate *priv;
 
-  atk_parent = ATK_OBJECT (data);
-  atk_child = gtk_widget_get_accessible (widget);
-  accessible = GTK_CONTAINER_ACCESSIBLE (atk_parent);
+  accessible = GTK_CONTAINER_ACCESSIBLE (data);
+  priv = accessible->priv;
 
-  g_list_free (accessible->priv->children);
-  accessible->priv->children = gtk_container_get_children (container);
-  index = g_list_index (accessible->priv->children, widget);
-  _gtk_container_accessible_add_child (accessible, atk_child, index);
+  /* Adding many children, e.g. rows of a list, would otherwise create
+   * an accessible for every one of them and look up its index each
+   * time. Collect them until the main loop is idle instead.
+   */
+  if (priv->pending_children == NULL)
+    {
+      priv->pending_container = g_object_ref (container);
+      priv->pending_children = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+      priv->pending_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
+                                          flush_pending_children_idle,
+                                          accessible, NULL);
+      g_source_set_name_by_id (priv->pending_id, "[gtk] flush_pending_children_idle");
+    }
+  else if (priv->pending_container != container)
+    {
+      flush_pending_children (accessible);
+      return gtk_container_accessible_real_add_gtk (container, widget, data);
+    }
+
+  g_hash_table_add (priv->pending_children, g_object_ref (widget));
 
   return 1;
 }
@@ -150,14 +223,23 @@ gtk_container_accessible_real_remove_gtk (GtkContainer *container,
   gint index;
 
   atk_parent = ATK_OBJECT (data);
+  accessible = GTK_CONTAINER_ACCESSIBLE (atk_parent);
+
+  /* Never announced, so there is nothing to take back */
+  if (accessible->priv->pending_children != NULL &&
+      g_hash_table_remove (accessible->priv->pending_children, widget))
+    return 1;
+
+  /* Children that are still pending are not in the list, so this is
+   * the index ATs know
+   */
+  index = g_list_index (accessible->priv->children, widget);
+  accessible->priv->children = g_list_remove (accessible->priv->children, widget);
+
   atk_child = _gtk_widget_peek_accessible (widget);
   if (atk_child == NULL)
     return 1;
-  accessible = GTK_CONTAINER_ACCESSIBLE (atk_parent);
 
-  index = g_list_index (accessible->priv->children, widget);
-  g_list_free (accessible->priv->children);
-  accessible->priv->children = gtk_container_get_children (container);
   if (index >= 0)
     _gtk_container_accessible_remove_child (accessible, atk_child, index);
 
@@ -182,6 +264,9 @@ gtk_container_accessible_finalize (GObject *object)
 {
   GtkContainerAccessible *accessible = GTK_CONTAINER_ACCESSIBLE (object);
 
+  g_clear_handle_id (&accessible->priv->pending_id, g_source_remove);
+  g_clear_pointer (&accessible->priv->pending_children, g_hash_table_unref);
+  g_clear_object (&accessible->priv->pending_container);
   g_list_free (accessible->priv->children);
 
   G_OBJECT_CLASS (gtk_container_accessible_parent_class)->finalize (object);
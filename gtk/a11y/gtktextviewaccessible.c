@@ -37,6 +37,13 @@ struct _GtkTextViewAccessiblePrivate
 {
   gint insert_offset;
   gint selection_bound;
+
+  /* Inserted text and cursor changes are announced once per main
+   * loop iteration, see flush_pending_changes() */
+  GtkTextBuffer *pending_buffer;
+  gint pending_insert_offset;
+  gint pending_insert_length;
+  guint pending_id;
 };
 
 static void       insert_text_cb        (GtkTextBuffer    *buffer,
@@ -58,6 +65,8 @@ static void       mark_set_cb           (GtkTextBuffer    *buffer,
                                                          gpointer         user_data);
 
 
+static void       flush_pending_changes (GtkTextViewAccessible *accessible);
+
 static void atk_editable_text_interface_init      (AtkEditableTextIface      *iface);
 static void atk_text_interface_init               (AtkTextIface              *iface);
 
@@ -124,6 +133,8 @@ gtk_text_view_accessible_change_buffer (GtkTextViewAccessible *accessible,
 {
   if (old_buffer)
     {
+      flush_pending_changes (accessible);
+
       g_signal_handlers_disconnect_matched (old_buffer, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, accessible);
 
       g_signal_emit_by_name (accessible,
@@ -165,10 +176,13 @@ gtk_text_view_accessible_widget_unset (GtkAccessible *accessible)
 static void
 gtk_text_view_accessible_class_init (GtkTextViewAccessibleClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   AtkObjectClass  *class = ATK_OBJECT_CLASS (klass);
   GtkAccessibleClass *accessible_class = GTK_ACCESSIBLE_CLASS (klass);
   GtkWidgetAccessibleClass *widget_class = (GtkWidgetAccessibleClass*)klass;
 
+  gobject_class->finalize = gtk_text_view_accessible_finalize;
+
   accessible_class->widget_set = gtk_text_view_accessible_widget_set;
   accessible_class->widget_unset = gtk_text_view_accessible_widget_unset;
 
@@ -178,6 +192,17 @@ gtk_text_view_accessible_class_init (GtkTextViewAccessibleClass *klass)
   widget_class->notify_gtk = gtk_text_view_accessible_notify_gtk;
 }
 
+static void
+gtk_text_view_accessible_finalize (GObject *object)
+{
+  GtkTextViewAccessible *accessible = GTK_TEXT_VIEW_ACCESSIBLE (object);
+
+  g_clear_handle_id (&accessible->priv->pending_id, g_source_remove);
+  g_clear_object (&accessible->priv->pending_buffer);
+
+  G_OBJECT_CLASS (gtk_text_view_accessible_parent_class)->finalize (object);
+}
+
 static void
 gtk_text_view_accessible_init (GtkTextViewAccessible *accessible)
 {
@@ -1771,6 +1796,61 @@ gtk_text_view_accessible_update_cursor (GtkTextViewAccessible *accessible,
     g_signal_emit_by_name (accessible, "text-selection-changed");
 }
 
+/* Emits the text-changed::insert for the text inserted since the last
+ * time, and the cursor and selection changes. ATs read the inserted
+ * text when they get the signal, so this must run before anything but
+ * more insertions into the same range changes the buffer.
+ */
+static void
+flush_pending_changes (GtkTextViewAccessible *accessible)
+{
+  GtkTextViewAccessiblePrivate *priv = accessible->priv;
+  GtkTextBuffer *buffer;
+
+  if (priv->pending_buffer == NULL)
+    return;
+
+  g_clear_handle_id (&priv->pending_id, g_source_remove);
+  buffer = g_steal_pointer (&priv->pending_buffer);
+
+  if (priv->pending_insert_length > 0)
+    g_signal_emit_by_name (accessible, "text-changed::insert",
+                           priv->pending_insert_offset,
+                           priv->pending_insert_length);
+  priv->pending_insert_length = 0;
+
+  gtk_text_view_accessible_update_cursor (accessible, buffer);
+
+  g_object_unref (buffer);
+}
+
+static gboolean
+flush_pending_changes_idle (gpointer data)
+{
+  GtkTextViewAccessible *accessible = data;
+
+  accessible->priv->pending_id = 0;
+  flush_pending_changes (accessible);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_pending_changes (GtkTextViewAccessible *accessible,
+                       GtkTextBuffer         *buffer)
+{
+  GtkTextViewAccessiblePrivate *priv = accessible->priv;
+
+  if (priv->pending_buffer != NULL)
+    return;
+
+  priv->pending_buffer = g_object_ref (buffer);
+  priv->pending_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
+                                      flush_pending_changes_idle,
+                                      accessible, NULL);
+  g_source_set_name_by_id (priv->pending_id, "[gtk] flush_pending_changes_idle");
+}
+
 static void
 insert_text_cb (GtkTextBuffer *buffer,
                 GtkTextIter   *iter,
@@ -1779,15 +1859,28 @@ insert_text_cb (GtkTextBuffer *buffer,
                 gpointer       data)
 {
   GtkTextViewAccessible *accessible = data;
+  GtkTextViewAccessiblePrivate *priv = accessible->priv;
   gint position;
   gint length;
 
   position = gtk_text_iter_get_offset (iter);
   length = g_utf8_strlen (text, len);
- 
-  g_signal_emit_by_name (accessible, "text-changed::insert", position - length, length);
+  position -= length;
 
-  gtk_text_view_accessible_update_cursor (accessible, buffer);
+  /* Typing and bulk inserts add text in or right next to the pending
+   * range, which keeps it one range. Anything else is announced
+   * separately, so the offsets stay right.
+   */
+  if (priv->pending_insert_length > 0 &&
+      (position < priv->pending_insert_offset ||
+       position > priv->pending_insert_offset + priv->pending_insert_length))
+    flush_pending_changes (accessible);
+
+  if (priv->pending_insert_length == 0)
+    priv->pending_insert_offset = position;
+  priv->pending_insert_length += length;
+
+  queue_pending_changes (accessible, buffer);
 }
 
 static void
@@ -1799,6 +1892,11 @@ delete_range_cb (GtkTextBuffer *buffer,
   GtkTextViewAccessible *accessible = data;
   gint offset, length;
 
+  /* ATs read the deleted text when they get the signal, so deletions
+   * are still announced right away, and after the pending insertions
+   */
+  flush_pending_changes (accessible);
+
   offset = gtk_text_iter_get_offset (start);
   length = gtk_text_iter_get_offset (end) - offset;
 
@@ -1833,11 +1931,11 @@ mark_set_cb (GtkTextBuffer *buffer,
    */
   if (mark == gtk_text_buffer_get_insert (buffer))
     {
-      gtk_text_view_accessible_update_cursor (accessible, buffer);
+      queue_pending_changes (accessible, buffer);
     }
   else if (mark == gtk_text_buffer_get_selection_bound (buffer))
     {
-      gtk_text_view_accessible_update_cursor (accessible, buffer);
+      queue_pending_changes (accessible, buffer);
     }
 }
 
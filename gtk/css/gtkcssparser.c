@@ -166,6 +166,21 @@ gtk_css_parser_get_file (GtkCssParser *self)
   return self->file;
 }
 
+/**
+ * gtk_css_parser_get_user_data:
+ * @self: a #GtkCssParser
+ *
+ * Gets the user data that @self was created with and that is
+ * passed to the error function.
+ *
+ * Returns: (transfer none): The user data
+ **/
+gpointer
+gtk_css_parser_get_user_data (GtkCssParser *self)
+{
+  return self->user_data;
+}
+
 /**
  * gtk_css_parser_resolve_url:
  * @self: a #GtkCssParser
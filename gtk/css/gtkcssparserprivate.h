@@ -64,6 +64,7 @@ GtkCssParser *          gtk_css_parser_ref                      (GtkCssParser
 void                    gtk_css_parser_unref                    (GtkCssParser                   *self);
 
 GFile *                 gtk_css_parser_get_file                 (GtkCssParser                   *self);
+gpointer                gtk_css_parser_get_user_data            (GtkCssParser                   *self);
 GFile *                 gtk_css_parser_resolve_url              (GtkCssParser                   *self,
                                                                  const char                     *url);
 
@@ -795,7 +795,21 @@ gtk_css_tokenizer_read_whitespace (GtkCssTokenizer *tokenizer,
                                    GtkCssToken     *token)
 {
   do {
-    gtk_css_tokenizer_consume_whitespace (tokenizer);
+    if (is_newline (*tokenizer->data))
+      {
+        gtk_css_tokenizer_consume_newline (tokenizer);
+      }
+    else
+      {
+        const char *run;
+
+        /* consume runs of indentation in one go */
+        for (run = tokenizer->data;
+             run < tokenizer->end && (*run == ' ' || *run == '\t');
+             run++);
+
+        gtk_css_tokenizer_consume (tokenizer, run - tokenizer->data, run - tokenizer->data);
+      }
   } while (tokenizer->data != tokenizer->end &&
            is_whitespace (*tokenizer->data));
 
@@ -843,7 +857,27 @@ gtk_css_tokenizer_read_escape (GtkCssTokenizer *tokenizer)
 static char *
 gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer)
 {
-  GString *string = g_string_new (NULL);
+  GString *string;
+  const char *run;
+  gsize len;
+
+  /* Almost all names are plain ASCII, copy those in one go */
+  for (run = tokenizer->data;
+       run < tokenizer->end && is_name (*run) && !is_multibyte (*run);
+       run++);
+
+  len = run - tokenizer->data;
+  if (run == tokenizer->end || (*run != '\\' && !is_multibyte (*run)))
+    {
+      char *name = g_strndup (tokenizer->data, len);
+
+      gtk_css_tokenizer_consume (tokenizer, len, len);
+
+      return name;
+    }
+
+  string = g_string_new_len (tokenizer->data, len);
+  gtk_css_tokenizer_consume (tokenizer, len, len);
 
   do {
       if (*tokenizer->data == '\\')
@@ -1153,11 +1187,31 @@ gtk_css_tokenizer_read_string (GtkCssTokenizer  *tokenizer,
                                GtkCssToken      *token,
                                GError          **error)
 {
-  GString *string = g_string_new (NULL);
+  GString *string;
   char end = *tokenizer->data;
+  const char *run;
+  gsize len;
 
   gtk_css_tokenizer_consume_ascii (tokenizer);
 
+  /* Copy strings without escapes or non-ASCII characters in one go */
+  for (run = tokenizer->data;
+       run < tokenizer->end && *run != end && *run != '\\' &&
+       !is_newline (*run) && !is_multibyte (*run);
+       run++);
+
+  len = run - tokenizer->data;
+  if (run < tokenizer->end && *run == end)
+    {
+      gtk_css_token_init (token, GTK_CSS_TOKEN_STRING, g_strndup (tokenizer->data, len));
+      gtk_css_tokenizer_consume (tokenizer, len + 1, len + 1);
+
+      return TRUE;
+    }
+
+  string = g_string_new_len (tokenizer->data, len);
+  gtk_css_tokenizer_consume (tokenizer, len, len);
+
   while (tokenizer->data < tokenizer->end)
     {
       if (*tokenizer->data == end)
@@ -141,11 +141,54 @@ gtk_action_muxer_list_actions (GActionGroup *action_group)
   return (gchar **)(void *) g_array_free (actions, FALSE);
 }
 
+/* Most action names are short, so the names built for every
+ * signal of every group use a buffer on the stack. Free the
+ * result with gtk_action_muxer_free_name().
+ */
+#define NAME_BUFFER_SIZE 128
+
+static gchar *
+gtk_action_muxer_build_name (gchar       *buffer,
+                             const gchar *prefix,
+                             gsize        prefix_len,
+                             const gchar *name)
+{
+  gsize name_len;
+  gchar *result;
+
+  name_len = name ? strlen (name) : 0;
+
+  if (prefix_len + name_len + 2 <= NAME_BUFFER_SIZE)
+    result = buffer;
+  else
+    result = g_malloc (prefix_len + name_len + 2);
+
+  memcpy (result, prefix, prefix_len);
+  if (name)
+    {
+      result[prefix_len] = '.';
+      memcpy (result + prefix_len + 1, name, name_len + 1);
+    }
+  else
+    result[prefix_len] = '\0';
+
+  return result;
+}
+
+static void
+gtk_action_muxer_free_name (gchar *buffer,
+                            gchar *name)
+{
+  if (name != buffer)
+    g_free (name);
+}
+
 static Group *
 gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
                              const gchar     *full_name,
                              const gchar    **action_name)
 {
+  gchar buffer[NAME_BUFFER_SIZE];
   const gchar *dot;
   gchar *prefix;
   Group *group;
@@ -155,9 +198,9 @@ gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
   if (!dot)
     return NULL;
 
-  prefix = g_strndup (full_name, dot - full_name);
+  prefix = gtk_action_muxer_build_name (buffer, full_name, dot - full_name, NULL);
   group = g_hash_table_lookup (muxer->groups, prefix);
-  g_free (prefix);
+  gtk_action_muxer_free_name (buffer, prefix);
 
   if (action_name)
     *action_name = dot + 1;
@@ -186,12 +229,13 @@ gtk_action_muxer_group_action_enabled_changed (GActionGroup *action_group,
                                                gpointer      user_data)
 {
   Group *group = user_data;
+  gchar buffer[NAME_BUFFER_SIZE];
   gchar *fullname;
 
-  fullname = g_strconcat (group->prefix, ".", action_name, NULL);
+  fullname = gtk_action_muxer_build_name (buffer, group->prefix, strlen (group->prefix), action_name);
   gtk_action_muxer_action_enabled_changed (group->muxer, fullname, enabled);
 
-  g_free (fullname);
+  gtk_action_muxer_free_name (buffer, fullname);
 }
 
 static void
@@ -226,12 +270,13 @@ gtk_action_muxer_group_action_state_changed (GActionGroup *action_group,
                                              gpointer      user_data)
 {
   Group *group = user_data;
+  gchar buffer[NAME_BUFFER_SIZE];
   gchar *fullname;
 
-  fullname = g_strconcat (group->prefix, ".", action_name, NULL);
+  fullname = gtk_action_muxer_build_name (buffer, group->prefix, strlen (group->prefix), action_name);
   gtk_action_muxer_action_state_changed (group->muxer, fullname, state);
 
-  g_free (fullname);
+  gtk_action_muxer_free_name (buffer, fullname);
 }
 
 static void
@@ -282,12 +327,13 @@ gtk_action_muxer_action_added_to_group (GActionGroup *action_group,
                                         gpointer      user_data)
 {
   Group *group = user_data;
+  gchar buffer[NAME_BUFFER_SIZE];
   gchar *fullname;
 
-  fullname = g_strconcat (group->prefix, ".", action_name, NULL);
+  fullname = gtk_action_muxer_build_name (buffer, group->prefix, strlen (group->prefix), action_name);
   gtk_action_muxer_action_added (group->muxer, fullname, action_group, action_name);
 
-  g_free (fullname);
+  gtk_action_muxer_free_name (buffer, fullname);
 }
 
 static void
@@ -319,12 +365,13 @@ gtk_action_muxer_action_removed_from_group (GActionGroup *action_group,
                                             gpointer      user_data)
 {
   Group *group = user_data;
+  gchar buffer[NAME_BUFFER_SIZE];
   gchar *fullname;
 
-  fullname = g_strconcat (group->prefix, ".", action_name, NULL);
+  fullname = gtk_action_muxer_build_name (buffer, group->prefix, strlen (group->prefix), action_name);
   gtk_action_muxer_action_removed (group->muxer, fullname);
 
-  g_free (fullname);
+  gtk_action_muxer_free_name (buffer, fullname);
 }
 
 static void
@@ -496,6 +543,64 @@ gtk_action_muxer_unregister_observer (GtkActionObservable *observable,
   gtk_action_muxer_unregister_internal (action, observer);
 }
 
+/* Returns whether anything but our own observers wants to hear about
+ * actions being added and removed, which is mostly child muxers */
+static gboolean
+gtk_action_muxer_has_listeners (GtkActionMuxer *muxer)
+{
+  static guint added_signal, removed_signal;
+
+  if (added_signal == 0)
+    {
+      added_signal = g_signal_lookup ("action-added", G_TYPE_ACTION_GROUP);
+      removed_signal = g_signal_lookup ("action-removed", G_TYPE_ACTION_GROUP);
+    }
+
+  return g_signal_has_handler_pending (muxer, added_signal, 0, FALSE) ||
+         g_signal_has_handler_pending (muxer, removed_signal, 0, FALSE);
+}
+
+/* Returns the names of the actions of @group that are observed on
+ * @muxer, with @prefix, if not %NULL. Adding, removing or reparenting
+ * a group of a muxer with no listeners only needs to notify those,
+ * instead of every action in the group.
+ */
+static gchar **
+gtk_action_muxer_list_observed_actions (GtkActionMuxer *muxer,
+                                        const gchar    *prefix,
+                                        GActionGroup   *group)
+{
+  GHashTableIter iter;
+  gpointer key;
+  GPtrArray *actions;
+  gsize prefix_len;
+
+  actions = g_ptr_array_new ();
+  prefix_len = prefix ? strlen (prefix) : 0;
+
+  g_hash_table_iter_init (&iter, muxer->observed_actions);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      const gchar *fullname = key;
+      const gchar *action_name = fullname;
+
+      if (prefix)
+        {
+          if (strncmp (fullname, prefix, prefix_len) != 0 || fullname[prefix_len] != '.')
+            continue;
+
+          action_name = fullname + prefix_len + 1;
+        }
+
+      if (g_action_group_has_action (group, action_name))
+        g_ptr_array_add (actions, g_strdup (action_name));
+    }
+
+  g_ptr_array_add (actions, NULL);
+
+  return (gchar **) g_ptr_array_free (actions, FALSE);
+}
+
 static void
 gtk_action_muxer_free_group (gpointer data)
 {
@@ -684,7 +789,10 @@ gtk_action_muxer_insert (GtkActionMuxer *muxer,
 
   g_hash_table_insert (muxer->groups, group->prefix, group);
 
-  actions = g_action_group_list_actions (group->group);
+  if (gtk_action_muxer_has_listeners (muxer))
+    actions = g_action_group_list_actions (group->group);
+  else
+    actions = gtk_action_muxer_list_observed_actions (muxer, prefix, group->group);
   for (i = 0; actions[i]; i++)
     gtk_action_muxer_action_added_to_group (group->group, actions[i], group);
   g_strfreev (actions);
@@ -724,7 +832,10 @@ gtk_action_muxer_remove (GtkActionMuxer *muxer,
 
       g_hash_table_steal (muxer->groups, prefix);
 
-      actions = g_action_group_list_actions (group->group);
+      if (gtk_action_muxer_has_listeners (muxer))
+        actions = g_action_group_list_actions (group->group);
+      else
+        actions = gtk_action_muxer_list_observed_actions (muxer, group->prefix, group->group);
       for (i = 0; actions[i]; i++)
         gtk_action_muxer_action_removed_from_group (group->group, actions[i], group);
       g_strfreev (actions);
@@ -820,7 +931,10 @@ gtk_action_muxer_set_parent (GtkActionMuxer *muxer,
       gchar **actions;
       gchar **it;
 
-      actions = g_action_group_list_actions (G_ACTION_GROUP (muxer->parent));
+      if (gtk_action_muxer_has_listeners (muxer))
+        actions = g_action_group_list_actions (G_ACTION_GROUP (muxer->parent));
+      else
+        actions = gtk_action_muxer_list_observed_actions (muxer, NULL, G_ACTION_GROUP (muxer->parent));
       for (it = actions; *it; it++)
         gtk_action_muxer_action_removed (muxer, *it);
       g_strfreev (actions);
@@ -845,7 +959,10 @@ gtk_action_muxer_set_parent (GtkActionMuxer *muxer,
 
       g_object_ref (muxer->parent);
 
-      actions = g_action_group_list_actions (G_ACTION_GROUP (muxer->parent));
+      if (gtk_action_muxer_has_listeners (muxer))
+        actions = g_action_group_list_actions (G_ACTION_GROUP (muxer->parent));
+      else
+        actions = gtk_action_muxer_list_observed_actions (muxer, NULL, G_ACTION_GROUP (muxer->parent));
       for (it = actions; *it; it++)
         gtk_action_muxer_action_added (muxer, *it, G_ACTION_GROUP (muxer->parent), *it);
       g_strfreev (actions);
@@ -0,0 +1,457 @@
+/*
+ * Copyright © 2019 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkbitsetprivate.h"
+
+#include <string.h>
+
+/* GtkBitset is a growable array of bits for list models that
+ * need to know which of their items are in a set, like the visible
+ * items of a filter model.
+ *
+ * It uses a bit per item, plus a count of set bits for every block of
+ * BLOCK_BITS bits. The counts make finding the number of set bits
+ * before a position (rank) take constant time and finding the nth set
+ * bit (select) logarithmic time. Counts are updated lazily, so runs of
+ * changes only cost one update.
+ *
+ * Bits past the size are always unset.
+ */
+
+#define WORD_BITS 64
+#define BLOCK_WORDS 8
+#define BLOCK_BITS (WORD_BITS * BLOCK_WORDS)
+
+#define N_WORDS(n_bits) (((n_bits) + WORD_BITS - 1) / WORD_BITS)
+#define N_BLOCKS(n_bits) (((n_bits) + BLOCK_BITS - 1) / BLOCK_BITS)
+
+struct _GtkBitset
+{
+  guint64 *words; /* N_BLOCKS (size) * BLOCK_WORDS words */
+  guint size;
+
+  guint *counts; /* counts[i] is the number of set bits before block i */
+  guint n_valid_counts; /* counts[0] to counts[n_valid_counts] are valid */
+};
+
+static inline guint
+popcount64 (guint64 value)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll (value);
+#else
+  /* http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetParallel */
+  value = value - ((value >> 1) & G_GUINT64_CONSTANT (0x5555555555555555));
+  value = (value & G_GUINT64_CONSTANT (0x3333333333333333)) + ((value >> 2) & G_GUINT64_CONSTANT (0x3333333333333333));
+  value = (value + (value >> 4)) & G_GUINT64_CONSTANT (0x0f0f0f0f0f0f0f0f);
+  return (value * G_GUINT64_CONSTANT (0x0101010101010101)) >> 56;
+#endif
+}
+
+static inline guint
+ctz64 (guint64 value)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll (value);
+#else
+  guint i;
+
+  for (i = 0; (value & 1) == 0; i++)
+    value >>= 1;
+
+  return i;
+#endif
+}
+
+static inline guint
+clz64 (guint64 value)
+{
+#ifdef __GNUC__
+  return __builtin_clzll (value);
+#else
+  guint i;
+
+  for (i = 0; (value & (G_GUINT64_CONSTANT (1) << 63)) == 0; i++)
+    value <<= 1;
+
+  return i;
+#endif
+}
+
+static inline guint64
+low_bits (guint n_bits)
+{
+  return n_bits >= WORD_BITS ? ~G_GUINT64_CONSTANT (0) : (G_GUINT64_CONSTANT (1) << n_bits) - 1;
+}
+
+static void
+gtk_bitset_invalidate_counts (GtkBitset *self,
+                              guint      position)
+{
+  self->n_valid_counts = MIN (self->n_valid_counts, position / BLOCK_BITS);
+}
+
+static void
+gtk_bitset_ensure_counts (GtkBitset *self,
+                          guint      block)
+{
+  guint i, j;
+
+  for (i = self->n_valid_counts; i < block; i++)
+    {
+      guint count = self->counts[i];
+
+      for (j = 0; j < BLOCK_WORDS; j++)
+        count += popcount64 (self->words[i * BLOCK_WORDS + j]);
+
+      self->counts[i + 1] = count;
+    }
+
+  self->n_valid_counts = MAX (self->n_valid_counts, block);
+}
+
+/* Reads up to WORD_BITS bits starting at position */
+static inline guint64
+read_bits (const guint64 *words,
+           guint          position,
+           guint          n_bits)
+{
+  guint w = position / WORD_BITS;
+  guint offset = position % WORD_BITS;
+  guint64 value;
+
+  value = words[w] >> offset;
+  if (offset > 0 && offset + n_bits > WORD_BITS)
+    value |= words[w + 1] << (WORD_BITS - offset);
+
+  return value & low_bits (n_bits);
+}
+
+/* Sets up to WORD_BITS bits starting at position. The bits must be unset. */
+static inline void
+write_bits (guint64 *words,
+            guint    position,
+            guint64  value,
+            guint    n_bits)
+{
+  guint w = position / WORD_BITS;
+  guint offset = position % WORD_BITS;
+
+  words[w] |= value << offset;
+  if (offset > 0 && offset + n_bits > WORD_BITS)
+    words[w + 1] |= value >> (WORD_BITS - offset);
+}
+
+static void
+copy_bits (guint64       *dest,
+           guint          dest_position,
+           const guint64 *src,
+           guint          src_position,
+           guint          n_bits)
+{
+  guint i, n;
+
+  for (i = 0; i < n_bits; i += n)
+    {
+      n = MIN (WORD_BITS, n_bits - i);
+      write_bits (dest, dest_position + i, read_bits (src, src_position + i, n), n);
+    }
+}
+
+GtkBitset *
+gtk_bitset_new (void)
+{
+  GtkBitset *self;
+
+  self = g_slice_new0 (GtkBitset);
+  self->counts = g_new0 (guint, 1);
+
+  return self;
+}
+
+void
+gtk_bitset_free (GtkBitset *self)
+{
+  g_free (self->words);
+  g_free (self->counts);
+  g_slice_free (GtkBitset, self);
+}
+
+guint
+gtk_bitset_get_size (const GtkBitset *self)
+{
+  return self->size;
+}
+
+guint
+gtk_bitset_get_n_set (GtkBitset *self)
+{
+  guint n_blocks = N_BLOCKS (self->size);
+
+  gtk_bitset_ensure_counts (self, n_blocks);
+
+  return self->counts[n_blocks];
+}
+
+gboolean
+gtk_bitset_get (const GtkBitset *self,
+                guint            position)
+{
+  if (position >= self->size)
+    return FALSE;
+
+  return (self->words[position / WORD_BITS] >> (position % WORD_BITS)) & 1;
+}
+
+void
+gtk_bitset_set (GtkBitset *self,
+                guint      position,
+                gboolean   value)
+{
+  guint64 bit;
+
+  g_return_if_fail (position < self->size);
+
+  bit = G_GUINT64_CONSTANT (1) << (position % WORD_BITS);
+  if (value)
+    self->words[position / WORD_BITS] |= bit;
+  else
+    self->words[position / WORD_BITS] &= ~bit;
+
+  gtk_bitset_invalidate_counts (self, position);
+}
+
+void
+gtk_bitset_set_range (GtkBitset *self,
+                      guint      position,
+                      guint      n_bits,
+                      gboolean   value)
+{
+  guint i, n, offset;
+  guint64 mask;
+
+  g_return_if_fail (position + n_bits <= self->size);
+
+  for (i = position; i < position + n_bits; i += n)
+    {
+      offset = i % WORD_BITS;
+      n = MIN (WORD_BITS - offset, position + n_bits - i);
+      mask = low_bits (n) << offset;
+
+      if (value)
+        self->words[i / WORD_BITS] |= mask;
+      else
+        self->words[i / WORD_BITS] &= ~mask;
+    }
+
+  gtk_bitset_invalidate_counts (self, position);
+}
+
+/**
+ * gtk_bitset_splice:
+ * @self: a #GtkBitset
+ * @position: position of the first bit to remove
+ * @removed: number of bits to remove
+ * @added: number of unset bits to insert
+ *
+ * Changes the bits like @self was an array of items that had items
+ * removed and added at @position, like in #GListModel::items-changed.
+ **/
+void
+gtk_bitset_splice (GtkBitset *self,
+                   guint      position,
+                   guint      removed,
+                   guint      added)
+{
+  guint64 *words;
+  guint size;
+
+  g_return_if_fail (position + removed <= self->size);
+
+  if (removed == 0 && added == 0)
+    return;
+
+  size = self->size - removed + added;
+  words = g_new0 (guint64, N_BLOCKS (size) * BLOCK_WORDS);
+
+  copy_bits (words, 0, self->words, 0, position);
+  copy_bits (words, position + added, self->words, position + removed, self->size - position - removed);
+
+  g_free (self->words);
+  self->words = words;
+
+  if (N_BLOCKS (size) != N_BLOCKS (self->size))
+    self->counts = g_renew (guint, self->counts, N_BLOCKS (size) + 1);
+  self->size = size;
+
+  gtk_bitset_invalidate_counts (self, position);
+}
+
+/**
+ * gtk_bitset_rank:
+ * @self: a #GtkBitset
+ * @position: a position up to the size of @self
+ *
+ * Counts the bits that are set before @position.
+ *
+ * Returns: the number of set bits before @position
+ **/
+guint
+gtk_bitset_rank (GtkBitset *self,
+                 guint      position)
+{
+  guint i, block, rank;
+
+  g_return_val_if_fail (position <= self->size, 0);
+
+  block = position / BLOCK_BITS;
+  gtk_bitset_ensure_counts (self, block);
+
+  rank = self->counts[block];
+  for (i = block * BLOCK_WORDS; i < position / WORD_BITS; i++)
+    rank += popcount64 (self->words[i]);
+
+  if (position % WORD_BITS)
+    rank += popcount64 (self->words[i] & low_bits (position % WORD_BITS));
+
+  return rank;
+}
+
+/**
+ * gtk_bitset_select:
+ * @self: a #GtkBitset
+ * @nth: number of set bits to skip
+ *
+ * Finds the position of the @nth set bit, counting from 0.
+ *
+ * Returns: the position of the bit or %G_MAXUINT if fewer than
+ *     @nth + 1 bits are set
+ **/
+guint
+gtk_bitset_select (GtkBitset *self,
+                   guint      nth)
+{
+  guint start, end, mid, i, n;
+  guint64 word;
+
+  if (nth >= gtk_bitset_get_n_set (self))
+    return G_MAXUINT;
+
+  /* Find the last block with less than nth bits before it */
+  start = 0;
+  end = N_BLOCKS (self->size);
+  while (end - start > 1)
+    {
+      mid = start + (end - start) / 2;
+      if (self->counts[mid] <= nth)
+        start = mid;
+      else
+        end = mid;
+    }
+
+  nth -= self->counts[start];
+  for (i = start * BLOCK_WORDS; ; i++)
+    {
+      word = self->words[i];
+      n = popcount64 (word);
+      if (nth < n)
+        break;
+      nth -= n;
+    }
+
+  /* Clear the lowest set bits until the one we want is the lowest */
+  for (; nth > 0; nth--)
+    word &= word - 1;
+
+  return i * WORD_BITS + ctz64 (word);
+}
+
+/**
+ * gtk_bitset_find_next:
+ * @self: a #GtkBitset
+ * @position: position to start searching at
+ * @value: the value to look for
+ *
+ * Finds the first bit at or after @position that is @value.
+ *
+ * Returns: the position of the bit or the size of @self if
+ *     there is none
+ **/
+guint
+gtk_bitset_find_next (const GtkBitset *self,
+                      guint            position,
+                      gboolean         value)
+{
+  guint i, n_words;
+  guint64 word;
+
+  if (position >= self->size)
+    return self->size;
+
+  n_words = N_WORDS (self->size);
+  i = position / WORD_BITS;
+  word = value ? self->words[i] : ~self->words[i];
+  word &= ~low_bits (position % WORD_BITS);
+
+  while (word == 0)
+    {
+      if (++i == n_words)
+        return self->size;
+      word = value ? self->words[i] : ~self->words[i];
+    }
+
+  /* The unset bits past the size look like matches for FALSE */
+  return MIN (i * WORD_BITS + ctz64 (word), self->size);
+}
+
+/**
+ * gtk_bitset_find_previous:
+ * @self: a #GtkBitset
+ * @position: position to search before
+ * @value: the value to look for
+ *
+ * Finds the last bit before @position that is @value.
+ *
+ * Returns: the position of the bit or %G_MAXUINT if there is none
+ **/
+guint
+gtk_bitset_find_previous (const GtkBitset *self,
+                          guint            position,
+                          gboolean         value)
+{
+  guint i;
+  guint64 word;
+
+  position = MIN (position, self->size);
+  if (position == 0)
+    return G_MAXUINT;
+
+  i = (position - 1) / WORD_BITS;
+  word = value ? self->words[i] : ~self->words[i];
+  word &= low_bits ((position - 1) % WORD_BITS + 1);
+
+  while (word == 0)
+    {
+      if (i-- == 0)
+        return G_MAXUINT;
+      word = value ? self->words[i] : ~self->words[i];
+    }
+
+  return i * WORD_BITS + WORD_BITS - 1 - clz64 (word);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2019 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_BITSET_PRIVATE_H__
+#define __GTK_BITSET_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkBitset GtkBitset;
+
+GtkBitset *     gtk_bitset_new                  (void);
+void            gtk_bitset_free                 (GtkBitset              *self);
+
+guint           gtk_bitset_get_size             (const GtkBitset        *self);
+guint           gtk_bitset_get_n_set            (GtkBitset              *self);
+
+gboolean        gtk_bitset_get                  (const GtkBitset        *self,
+                                                 guint                   position);
+void            gtk_bitset_set                  (GtkBitset              *self,
+                                                 guint                   position,
+                                                 gboolean                value);
+void            gtk_bitset_set_range            (GtkBitset              *self,
+                                                 guint                   position,
+                                                 guint                   n_bits,
+                                                 gboolean                value);
+void            gtk_bitset_splice               (GtkBitset              *self,
+                                                 guint                   position,
+                                                 guint                   removed,
+                                                 guint                   added);
+
+guint           gtk_bitset_rank                 (GtkBitset              *self,
+                                                 guint                   position);
+guint           gtk_bitset_select               (GtkBitset              *self,
+                                                 guint                   nth);
+
+guint           gtk_bitset_find_next            (const GtkBitset        *self,
+                                                 guint                   position,
+                                                 gboolean                value);
+guint           gtk_bitset_find_previous        (const GtkBitset        *self,
+                                                 guint                   position,
+                                                 gboolean                value);
+
+G_END_DECLS
+
+#endif /* __GTK_BITSET_PRIVATE_H__ */
@@ -22,6 +22,7 @@
 
 #include "gtkcsspositionvalueprivate.h"
 #include "gtkintl.h"
+#include "gtklayoutmanagerprivate.h"
 #include "gtkorientableprivate.h"
 #include "gtkprivate.h"
 #include "gtksizerequest.h"
@@ -29,6 +30,8 @@
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
 
+#include <string.h>
+
 /**
  * SECTION:gtkboxlayout
  * @Title: GtkBoxLayout
@@ -56,6 +59,15 @@ struct _GtkBoxLayout
   guint spacing;
   GtkOrientation orientation;
   GtkBaselinePosition baseline_position;
+
+  /* What the visible children request along the orientation, which
+   * measuring in the opposite orientation needs for every size. Valid
+   * while the request serial of the layout manager is children_serial. */
+  guint children_serial;
+  GArray *children_sizes;
+  int n_visible_children;
+  int n_expand_children;
+  int children_minimum_size;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GtkBoxLayout, gtk_box_layout, GTK_TYPE_LAYOUT_MANAGER,
@@ -199,6 +211,44 @@ get_spacing (GtkBoxLayout *self,
   return css_spacing + self->spacing;
 }
 
+static void
+gtk_box_layout_ensure_children_sizes (GtkBoxLayout *self,
+                                      GtkWidget    *widget)
+{
+  const guint serial = gtk_layout_manager_get_request_serial (GTK_LAYOUT_MANAGER (self));
+  GtkWidget *child;
+
+  if (self->children_serial == serial)
+    return;
+
+  count_expand_children (widget, self->orientation,
+                         &self->n_visible_children, &self->n_expand_children);
+
+  g_array_set_size (self->children_sizes, 0);
+  self->children_minimum_size = 0;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      GtkRequestedSize size = { child, 0, 0 };
+
+      if (!_gtk_widget_get_visible (child))
+        continue;
+
+      gtk_widget_measure (child,
+                          self->orientation,
+                          -1,
+                          &size.minimum_size, &size.natural_size,
+                          NULL, NULL);
+
+      self->children_minimum_size += size.minimum_size;
+      g_array_append_val (self->children_sizes, size);
+    }
+
+  self->children_serial = serial;
+}
+
 static void
 gtk_box_layout_compute_size (GtkBoxLayout *self,
                              GtkWidget    *widget,
@@ -279,7 +329,12 @@ gtk_box_layout_compute_opposite_size (GtkBoxLayout *self,
   int spacing;
   gboolean have_baseline;
 
-  count_expand_children (widget, self->orientation, &nvis_children, &nexpand_children);
+  /* The desired sizes of the visible children only change with their
+   * requests, not with for_size */
+  gtk_box_layout_ensure_children_sizes (self, widget);
+  nvis_children = self->n_visible_children;
+  nexpand_children = self->n_expand_children;
+  children_minimum_size = self->children_minimum_size;
 
   if (nvis_children <= 0)
     return;
@@ -288,23 +343,8 @@ gtk_box_layout_compute_opposite_size (GtkBoxLayout *self,
   sizes = g_newa (GtkRequestedSize, nvis_children);
   extra_space = MAX (0, for_size - (nvis_children - 1) * spacing);
 
-  /* Retrieve desired size for visible children */
-  for (i = 0, child = _gtk_widget_get_first_child (widget);
-       child != NULL;
-       child = _gtk_widget_get_next_sibling (child))
-    {
-      if (_gtk_widget_get_visible (child))
-        {
-          gtk_widget_measure (child,
-                              self->orientation,
-                              -1,
-                              &sizes[i].minimum_size, &sizes[i].natural_size,
-                              NULL, NULL);
-
-          children_minimum_size += sizes[i].minimum_size;
-          i += 1;
-        }
-    }
+  /* gtk_distribute_natural_allocation() changes the sizes */
+  memcpy (sizes, self->children_sizes->data, nvis_children * sizeof (GtkRequestedSize));
 
   if (self->homogeneous)
     {
@@ -693,6 +733,16 @@ gtk_box_layout_allocate (GtkLayoutManager *layout_manager,
     }
 }
 
+static void
+gtk_box_layout_finalize (GObject *gobject)
+{
+  GtkBoxLayout *self = GTK_BOX_LAYOUT (gobject);
+
+  g_clear_pointer (&self->children_sizes, g_array_unref);
+
+  G_OBJECT_CLASS (gtk_box_layout_parent_class)->finalize (gobject);
+}
+
 static void
 gtk_box_layout_class_init (GtkBoxLayoutClass *klass)
 {
@@ -701,6 +751,7 @@ gtk_box_layout_class_init (GtkBoxLayoutClass *klass)
 
   gobject_class->set_property = gtk_box_layout_set_property;
   gobject_class->get_property = gtk_box_layout_get_property;
+  gobject_class->finalize = gtk_box_layout_finalize;
 
   layout_manager_class->measure = gtk_box_layout_measure;
   layout_manager_class->allocate = gtk_box_layout_allocate;
@@ -764,6 +815,7 @@ gtk_box_layout_init (GtkBoxLayout *self)
   self->spacing = 0;
   self->orientation = GTK_ORIENTATION_HORIZONTAL;
   self->baseline_position = GTK_BASELINE_POSITION_CENTER;
+  self->children_sizes = g_array_new (FALSE, FALSE, sizeof (GtkRequestedSize));
 }
 
 /**
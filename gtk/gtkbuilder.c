@@ -2784,10 +2784,30 @@ _gtk_builder_prefix_error (GtkBuilder           *builder,
                            GMarkupParseContext  *context,
                            GError              **error)
 {
-  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
   gint line, col;
 
   g_markup_parse_context_get_position (context, &line, &col);
+  _gtk_builder_prefix_error_at (builder, line, col, error);
+}
+
+/*< private >
+ * _gtk_builder_prefix_error_at:
+ * @builder: a #GtkBuilder
+ * @line: the line
+ * @col: the column
+ * @error: an error
+ *
+ * Like _gtk_builder_prefix_error(), for when there is no
+ * #GMarkupParseContext, like when replaying precompiled data.
+ */
+void
+_gtk_builder_prefix_error_at (GtkBuilder  *builder,
+                              gint         line,
+                              gint         col,
+                              GError     **error)
+{
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+
   g_prefix_error (error, "%s:%d:%d ", priv->filename, line, col);
 }
 
@@ -23,6 +23,7 @@
 
 #include <gio/gio.h>
 #include "gtkbuilderprivate.h"
+#include "gtkbuilderprecompileprivate.h"
 #include "gtkbuilder.h"
 #include "gtkbuildable.h"
 #include "gtkdebug.h"
@@ -65,6 +66,44 @@ state_pop (ParserData *data)
 #define state_peek_info(data, st) ((st*)state_peek(data))
 #define state_pop_info(data, st) ((st*)state_pop(data))
 
+/* When replaying precompiled data, there is no GMarkupParseContext
+ * and the position and element come from the records instead */
+static void
+get_position (ParserData *data,
+              gint       *line,
+              gint       *col)
+{
+  if (data->ctx)
+    {
+      g_markup_parse_context_get_position (data->ctx, line, col);
+      return;
+    }
+
+  if (line)
+    *line = data->line;
+  if (col)
+    *col = data->col;
+}
+
+static const gchar *
+get_element (ParserData *data)
+{
+  if (data->ctx)
+    return g_markup_parse_context_get_element (data->ctx);
+
+  return data->element;
+}
+
+static void
+prefix_error (ParserData  *data,
+              GError     **error)
+{
+  gint line, col;
+
+  get_position (data, &line, &col);
+  _gtk_builder_prefix_error_at (data->builder, line, col, error);
+}
+
 static void
 error_missing_attribute (ParserData   *data,
                          const gchar  *tag,
@@ -73,7 +112,7 @@ error_missing_attribute (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   g_set_error (error,
                GTK_BUILDER_ERROR,
@@ -90,7 +129,7 @@ error_invalid_tag (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   if (expected)
     g_set_error (error,
@@ -113,7 +152,7 @@ error_unhandled_tag (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
   g_set_error (error,
                GTK_BUILDER_ERROR,
                GTK_BUILDER_ERROR_UNHANDLED_TAG,
@@ -193,7 +232,7 @@ parse_requires (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING, "version", &version,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -203,7 +242,7 @@ parse_requires (ParserData   *data,
                    GTK_BUILDER_ERROR,
                    GTK_BUILDER_ERROR_INVALID_VALUE,
                    "'version' attribute has malformed value '%s'", version);
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
   version_major = g_ascii_strtoll (split[0], NULL, 10);
@@ -271,7 +310,7 @@ parse_object (GMarkupParseContext  *context,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "id", &object_id,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -293,7 +332,7 @@ parse_object (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_TYPE_FUNCTION,
                        "Invalid type function '%s'", type_func);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
     }
@@ -308,7 +347,7 @@ parse_object (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_VALUE,
                        "Invalid object type '%s'", object_class);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
        }
     }
@@ -358,11 +397,11 @@ parse_object (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_DUPLICATE_ID,
                    "Duplicate object ID '%s' (previously on line %d)",
                    object_id, line);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   g_hash_table_insert (data->object_ids, g_strdup (object_id), GINT_TO_POINTER (line));
 }
 
@@ -388,7 +427,7 @@ parse_template (GMarkupParseContext  *context,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "parent", &parent_class,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -399,7 +438,7 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_UNHANDLED_TAG,
                    "Not expecting to handle a template (class '%s', parent '%s')",
                    object_class, parent_class ? parent_class : "GtkWidget");
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
   else if (state_peek (data) != NULL)
@@ -416,7 +455,7 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_TEMPLATE_MISMATCH,
                    "Parsed template definition for type '%s', expected type '%s'",
                    object_class, g_type_name (template_type));
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -430,7 +469,7 @@ parse_template (GMarkupParseContext  *context,
           g_set_error (error, GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_VALUE,
                        "Invalid template parent type '%s'", parent_class);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
       if (parent_type != expected_type)
@@ -439,7 +478,7 @@ parse_template (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR_TEMPLATE_MISMATCH,
                        "Template parent type '%s' does not match instance parent type '%s'.",
                        parent_class, g_type_name (expected_type));
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
     }
@@ -462,11 +501,11 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_DUPLICATE_ID,
                    "Duplicate object ID '%s' (previously on line %d)",
                    object_class, line);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   g_hash_table_insert (data->object_ids, g_strdup (object_class), GINT_TO_POINTER (line));
 }
 
@@ -510,7 +549,7 @@ parse_child (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "internal-child", &internal_child,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -570,7 +609,7 @@ parse_property (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "bind-flags", &bind_flags_str,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -583,7 +622,7 @@ parse_property (ParserData   *data,
                    GTK_BUILDER_ERROR_INVALID_PROPERTY,
                    "Invalid property: %s.%s",
                    g_type_name (object_info->type), name);
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -591,12 +630,12 @@ parse_property (ParserData   *data,
     {
       if (!_gtk_builder_flags_from_string (G_TYPE_BINDING_FLAGS, NULL, bind_flags_str, &bind_flags, error))
         {
-          _gtk_builder_prefix_error (data->builder, data->ctx, error);
+          prefix_error (data, error);
           return;
         }
     }
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   if (bind_source && bind_property)
     {
@@ -677,7 +716,7 @@ parse_signal (ParserData   *data,
                                     G_MARKUP_COLLECT_TRISTATE|G_MARKUP_COLLECT_OPTIONAL, "swapped", &swapped,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -688,7 +727,7 @@ parse_signal (ParserData   *data,
                    GTK_BUILDER_ERROR_INVALID_SIGNAL,
                    "Invalid signal '%s' for type '%s'",
                    name, g_type_name (object_info->type));
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -747,7 +786,7 @@ parse_interface (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "domain", &domain,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -984,7 +1023,8 @@ start_element (GMarkupParseContext  *context,
        * if clause to avoid an error below.
        */
     }
-  else if (!parse_custom (context, element_name, names, values, data, error))
+  else if (context == NULL ||
+           !parse_custom (context, element_name, names, values, data, error))
     error_unhandled_tag (data, element_name, error);
 }
 
@@ -1130,7 +1170,7 @@ end_element (GMarkupParseContext  *context,
                            req_info->library,
                            req_info->major, req_info->minor,
                            GTK_MAJOR_VERSION, GTK_MINOR_VERSION);
-              _gtk_builder_prefix_error (data->builder, context, error);
+              prefix_error (data, error);
            }
         }
       free_requires_info (req_info, NULL);
@@ -1151,7 +1191,7 @@ end_element (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR,
                    GTK_BUILDER_ERROR_UNHANDLED_TAG,
                    "Unhandled tag: <%s>", element_name);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
     }
 }
 
@@ -1185,7 +1225,7 @@ text (GMarkupParseContext  *context,
   info = state_peek_info (data, CommonInfo);
   g_assert (info != NULL);
 
-  if (strcmp (g_markup_parse_context_get_element (context), "property") == 0)
+  if (strcmp (get_element (data), "property") == 0)
     {
       PropertyInfo *prop_info = (PropertyInfo*)info;
 
@@ -1226,6 +1266,260 @@ static const GMarkupParser parser = {
   NULL,
 };
 
+/*** Precompiled data ***/
+
+typedef struct {
+  ParserData *data;
+  guint n_wrappers;
+  guint depth;
+} MarkupData;
+
+/* Markup records are wrapped in their ancestors, which have already
+ * been handled, so only what is inside the wrappers is passed on */
+static void
+markup_start_element (GMarkupParseContext  *context,
+                      const gchar          *element_name,
+                      const gchar         **names,
+                      const gchar         **values,
+                      gpointer              user_data,
+                      GError              **error)
+{
+  MarkupData *markup = user_data;
+
+  if (markup->depth++ >= markup->n_wrappers)
+    start_element (context, element_name, names, values, markup->data, error);
+}
+
+static void
+markup_end_element (GMarkupParseContext  *context,
+                    const gchar          *element_name,
+                    gpointer              user_data,
+                    GError              **error)
+{
+  MarkupData *markup = user_data;
+
+  if (--markup->depth >= markup->n_wrappers)
+    end_element (context, element_name, markup->data, error);
+}
+
+static void
+markup_text (GMarkupParseContext  *context,
+             const gchar          *text_,
+             gsize                 text_len,
+             gpointer              user_data,
+             GError              **error)
+{
+  MarkupData *markup = user_data;
+
+  if (markup->depth > markup->n_wrappers)
+    text (context, text_, text_len, markup->data, error);
+}
+
+static const GMarkupParser markup_parser = {
+  markup_start_element,
+  markup_end_element,
+  markup_text,
+  NULL,
+};
+
+static gboolean
+replay_markup (ParserData   *data,
+               const gchar  *markup_text,
+               guint         n_wrappers,
+               GError      **error)
+{
+  MarkupData markup = { data, n_wrappers, 0 };
+  gboolean res;
+
+  data->ctx = g_markup_parse_context_new (&markup_parser,
+                                          G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                          &markup, NULL);
+
+  res = g_markup_parse_context_parse (data->ctx, markup_text, -1, error) &&
+        g_markup_parse_context_end_parse (data->ctx, error);
+
+  g_markup_parse_context_free (data->ctx);
+  data->ctx = NULL;
+
+  return res;
+}
+
+static gboolean
+read_uint (const guchar **p,
+           const guchar  *end,
+           guint         *value)
+{
+  guint result = 0;
+  guint shift;
+
+  for (shift = 0; *p < end && shift < 32; shift += 7)
+    {
+      guchar c = *(*p)++;
+
+      result |= (guint) (c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        {
+          *value = result;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static gboolean
+read_string (const guchar  **p,
+             const guchar   *end,
+             const gchar   **strings,
+             guint           n_strings,
+             const gchar   **string)
+{
+  guint i;
+
+  if (!read_uint (p, end, &i) || i >= n_strings)
+    return FALSE;
+
+  *string = strings[i];
+  return TRUE;
+}
+
+/* Feeds the records of precompiled data to the same callbacks as
+ * GMarkup would, see gtkbuilderprecompileprivate.h for the format */
+static gboolean
+replay_precompiled (ParserData   *data,
+                    const gchar  *buffer,
+                    gsize         length,
+                    GError      **error)
+{
+  const guchar *p = (const guchar *) buffer + GTK_BUILDER_PRECOMPILED_MAGIC_LEN;
+  const guchar *end = (const guchar *) buffer + length;
+  const gchar **strings = NULL;
+  GPtrArray *names, *values, *elements;
+  guint i, n_strings;
+  gboolean res = FALSE;
+
+  names = g_ptr_array_new ();
+  values = g_ptr_array_new ();
+  elements = g_ptr_array_new ();
+
+  /* every string takes at least one byte */
+  if (!read_uint (&p, end, &n_strings) || n_strings > (gsize) (end - p))
+    goto invalid;
+
+  strings = g_new (const gchar *, n_strings);
+  for (i = 0; i < n_strings; i++)
+    {
+      const guchar *nul = memchr (p, '\0', end - p);
+
+      if (nul == NULL)
+        goto invalid;
+
+      strings[i] = (const gchar *) p;
+      p = nul + 1;
+    }
+
+  while (p < end)
+    {
+      GError *tmp_error = NULL;
+      const gchar *element, *str;
+      guint line, col, n_attributes, n_wrappers;
+
+      switch (*p++)
+        {
+        case GTK_BUILDER_RECORD_START:
+          if (!read_string (&p, end, strings, n_strings, &element) ||
+              !read_uint (&p, end, &line) ||
+              !read_uint (&p, end, &col) ||
+              !read_uint (&p, end, &n_attributes))
+            goto invalid;
+
+          g_ptr_array_set_size (names, 0);
+          g_ptr_array_set_size (values, 0);
+          for (i = 0; i < n_attributes; i++)
+            {
+              if (!read_string (&p, end, strings, n_strings, &str))
+                goto invalid;
+              g_ptr_array_add (names, (gpointer) str);
+              if (!read_string (&p, end, strings, n_strings, &str))
+                goto invalid;
+              g_ptr_array_add (values, (gpointer) str);
+            }
+          g_ptr_array_add (names, NULL);
+          g_ptr_array_add (values, NULL);
+
+          g_ptr_array_add (elements, (gpointer) element);
+          data->element = element;
+          data->line = line;
+          data->col = col;
+
+          start_element (NULL, element,
+                         (const gchar **) names->pdata,
+                         (const gchar **) values->pdata,
+                         data, &tmp_error);
+          break;
+
+        case GTK_BUILDER_RECORD_END:
+          if (elements->len == 0)
+            goto invalid;
+
+          element = g_ptr_array_index (elements, elements->len - 1);
+          data->element = element;
+          end_element (NULL, element, data, &tmp_error);
+
+          g_ptr_array_set_size (elements, elements->len - 1);
+          data->element = elements->len ? g_ptr_array_index (elements, elements->len - 1) : NULL;
+          break;
+
+        case GTK_BUILDER_RECORD_TEXT:
+          if (!read_string (&p, end, strings, n_strings, &str) ||
+              elements->len == 0)
+            goto invalid;
+
+          text (NULL, str, strlen (str), data, &tmp_error);
+          break;
+
+        case GTK_BUILDER_RECORD_MARKUP:
+          if (!read_string (&p, end, strings, n_strings, &str) ||
+              !read_uint (&p, end, &n_wrappers) ||
+              n_wrappers != elements->len)
+            goto invalid;
+
+          replay_markup (data, str, n_wrappers, &tmp_error);
+          break;
+
+        default:
+          goto invalid;
+        }
+
+      if (tmp_error)
+        {
+          g_propagate_error (error, tmp_error);
+          goto out;
+        }
+    }
+
+  if (elements->len == 0)
+    {
+      res = TRUE;
+      goto out;
+    }
+
+ invalid:
+  g_set_error (error,
+               GTK_BUILDER_ERROR,
+               GTK_BUILDER_ERROR_INVALID_VALUE,
+               "%s: Invalid precompiled data",
+               data->filename);
+
+ out:
+  g_free (strings);
+  g_ptr_array_unref (names);
+  g_ptr_array_unref (values);
+  g_ptr_array_unref (elements);
+
+  return res;
+}
+
 void
 _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                   const gchar  *filename,
@@ -1263,12 +1557,21 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
       data.inside_requested_object = TRUE;
     }
 
-  data.ctx = g_markup_parse_context_new (&parser,
-                                          G_MARKUP_TREAT_CDATA_AS_TEXT,
-                                          &data, NULL);
+  if (length >= GTK_BUILDER_PRECOMPILED_MAGIC_LEN &&
+      memcmp (buffer, GTK_BUILDER_PRECOMPILED_MAGIC, GTK_BUILDER_PRECOMPILED_MAGIC_LEN) == 0)
+    {
+      if (!replay_precompiled (&data, buffer, length, error))
+        goto out;
+    }
+  else
+    {
+      data.ctx = g_markup_parse_context_new (&parser,
+                                              G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                              &data, NULL);
 
-  if (!g_markup_parse_context_parse (data.ctx, buffer, length, error))
-    goto out;
+      if (!g_markup_parse_context_parse (data.ctx, buffer, length, error))
+        goto out;
+    }
 
   _gtk_builder_finish (builder);
   if (_gtk_builder_lookup_failed (builder, error))
@@ -1307,7 +1610,7 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_free (data.finalizers);
   g_free (data.domain);
   g_hash_table_destroy (data.object_ids);
-  g_markup_parse_context_free (data.ctx);
+  g_clear_pointer (&data.ctx, g_markup_parse_context_free);
 
   /* restore the original domain */
   gtk_builder_set_translation_domain (builder, domain);
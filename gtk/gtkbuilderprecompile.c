@@ -0,0 +1,295 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* This file is also built into gtk4-builder-tool,
+ * so it must only use GLib */
+
+#include "config.h"
+
+#include "gtkbuilderprecompileprivate.h"
+
+#include <string.h>
+
+/* The elements the builder parser handles itself. Everything else
+ * goes to custom parsers and is kept as markup. */
+static const gchar *builder_elements[] = {
+  "interface",
+  "requires",
+  "object",
+  "template",
+  "property",
+  "signal",
+  "child",
+  "placeholder",
+};
+
+typedef struct {
+  GMarkupParseContext *ctx;
+
+  GHashTable *string_ids;  /* string => index + 1 */
+  GPtrArray *strings;
+  GByteArray *records;
+
+  GPtrArray *elements;     /* names of the open elements */
+
+  GString *markup;         /* markup of the custom element being read */
+  guint markup_depth;
+} Precompiler;
+
+static void
+write_uint (GByteArray *bytes,
+            guint       value)
+{
+  guint8 c;
+
+  do
+    {
+      c = value & 0x7f;
+      value >>= 7;
+      if (value)
+        c |= 0x80;
+      g_byte_array_append (bytes, &c, 1);
+    }
+  while (value);
+}
+
+static void
+write_string (Precompiler *pc,
+              const gchar *string)
+{
+  guint id;
+
+  id = GPOINTER_TO_UINT (g_hash_table_lookup (pc->string_ids, string));
+  if (id == 0)
+    {
+      gchar *copy = g_strdup (string);
+
+      g_ptr_array_add (pc->strings, copy);
+      id = pc->strings->len;
+      g_hash_table_insert (pc->string_ids, copy, GUINT_TO_POINTER (id));
+    }
+
+  write_uint (pc->records, id - 1);
+}
+
+static void
+write_type (Precompiler          *pc,
+            GtkBuilderRecordType  type)
+{
+  guint8 c = type;
+
+  g_byte_array_append (pc->records, &c, 1);
+}
+
+static gboolean
+is_builder_element (const gchar *element_name)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (builder_elements); i++)
+    {
+      if (strcmp (element_name, builder_elements[i]) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+append_start_tag (GString      *markup,
+                  const gchar  *element_name,
+                  const gchar **names,
+                  const gchar **values)
+{
+  guint i;
+
+  g_string_append_printf (markup, "<%s", element_name);
+  for (i = 0; names[i]; i++)
+    {
+      gchar *escaped = g_markup_escape_text (values[i], -1);
+
+      g_string_append_printf (markup, " %s=\"%s\"", names[i], escaped);
+      g_free (escaped);
+    }
+  g_string_append_c (markup, '>');
+}
+
+static void
+start_element (GMarkupParseContext  *context,
+               const gchar          *element_name,
+               const gchar         **names,
+               const gchar         **values,
+               gpointer              user_data,
+               GError              **error)
+{
+  Precompiler *pc = user_data;
+  gint line, col;
+  guint i;
+
+  if (pc->markup)
+    {
+      append_start_tag (pc->markup, element_name, names, values);
+      pc->markup_depth++;
+    }
+  else if (is_builder_element (element_name))
+    {
+      g_markup_parse_context_get_position (context, &line, &col);
+
+      write_type (pc, GTK_BUILDER_RECORD_START);
+      write_string (pc, element_name);
+      write_uint (pc->records, line);
+      write_uint (pc->records, col);
+      write_uint (pc->records, g_strv_length ((gchar **) names));
+      for (i = 0; names[i]; i++)
+        {
+          write_string (pc, names[i]);
+          write_string (pc, values[i]);
+        }
+    }
+  else
+    {
+      pc->markup = g_string_new (NULL);
+      for (i = 0; i < pc->elements->len; i++)
+        g_string_append_printf (pc->markup, "<%s>", (const gchar *) g_ptr_array_index (pc->elements, i));
+      append_start_tag (pc->markup, element_name, names, values);
+      pc->markup_depth = 1;
+    }
+
+  g_ptr_array_add (pc->elements, g_strdup (element_name));
+}
+
+static void
+end_element (GMarkupParseContext  *context,
+             const gchar          *element_name,
+             gpointer              user_data,
+             GError              **error)
+{
+  Precompiler *pc = user_data;
+  guint i;
+
+  g_ptr_array_set_size (pc->elements, pc->elements->len - 1);
+
+  if (pc->markup)
+    {
+      g_string_append_printf (pc->markup, "</%s>", element_name);
+      if (--pc->markup_depth > 0)
+        return;
+
+      for (i = pc->elements->len; i > 0; i--)
+        g_string_append_printf (pc->markup, "</%s>", (const gchar *) g_ptr_array_index (pc->elements, i - 1));
+
+      write_type (pc, GTK_BUILDER_RECORD_MARKUP);
+      write_string (pc, pc->markup->str);
+      write_uint (pc->records, pc->elements->len);
+
+      g_string_free (pc->markup, TRUE);
+      pc->markup = NULL;
+    }
+  else
+    write_type (pc, GTK_BUILDER_RECORD_END);
+}
+
+static void
+text (GMarkupParseContext  *context,
+      const gchar          *text,
+      gsize                 text_len,
+      gpointer              user_data,
+      GError              **error)
+{
+  Precompiler *pc = user_data;
+  gchar *string;
+
+  if (pc->markup)
+    {
+      string = g_markup_escape_text (text, text_len);
+      g_string_append (pc->markup, string);
+      g_free (string);
+    }
+  else if (pc->elements->len > 0 &&
+           strcmp (g_ptr_array_index (pc->elements, pc->elements->len - 1), "property") == 0)
+    {
+      /* The builder ignores all other text */
+      string = g_strndup (text, text_len);
+      write_type (pc, GTK_BUILDER_RECORD_TEXT);
+      write_string (pc, string);
+      g_free (string);
+    }
+}
+
+static const GMarkupParser parser = {
+  start_element,
+  end_element,
+  text,
+  NULL,
+  NULL
+};
+
+/*< private >
+ * _gtk_builder_precompile:
+ * @buffer: the .ui data
+ * @length: the length of @buffer
+ * @error: return location for an error
+ *
+ * Converts .ui XML to the precompiled form described in
+ * gtkbuilderprecompileprivate.h, which GtkBuilder loads faster.
+ *
+ * Returns: the precompiled data, or %NULL if @buffer is not valid XML
+ */
+GBytes *
+_gtk_builder_precompile (const gchar  *buffer,
+                         gssize        length,
+                         GError      **error)
+{
+  Precompiler pc = { NULL, };
+  GByteArray *result;
+  guint i;
+
+  pc.string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  pc.strings = g_ptr_array_new_with_free_func (g_free);
+  pc.records = g_byte_array_new ();
+  pc.elements = g_ptr_array_new_with_free_func (g_free);
+
+  pc.ctx = g_markup_parse_context_new (&parser, G_MARKUP_TREAT_CDATA_AS_TEXT, &pc, NULL);
+  if (!g_markup_parse_context_parse (pc.ctx, buffer, length, error) ||
+      !g_markup_parse_context_end_parse (pc.ctx, error))
+    {
+      result = NULL;
+      goto out;
+    }
+
+  result = g_byte_array_new ();
+  g_byte_array_append (result, (const guint8 *) GTK_BUILDER_PRECOMPILED_MAGIC, GTK_BUILDER_PRECOMPILED_MAGIC_LEN);
+  write_uint (result, pc.strings->len);
+  for (i = 0; i < pc.strings->len; i++)
+    {
+      const gchar *string = g_ptr_array_index (pc.strings, i);
+
+      g_byte_array_append (result, (const guint8 *) string, strlen (string) + 1);
+    }
+  g_byte_array_append (result, pc.records->data, pc.records->len);
+
+ out:
+  g_markup_parse_context_free (pc.ctx);
+  if (pc.markup)
+    g_string_free (pc.markup, TRUE);
+  g_hash_table_unref (pc.string_ids);
+  g_ptr_array_unref (pc.strings);
+  g_byte_array_unref (pc.records);
+  g_ptr_array_unref (pc.elements);
+
+  return result ? g_byte_array_free_to_bytes (result) : NULL;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_BUILDER_PRECOMPILE_PRIVATE_H__
+#define __GTK_BUILDER_PRECOMPILE_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Precompiled builder data, as written by gtk4-builder-tool precompile.
+ *
+ * It is the stream of GMarkup callbacks the builder parser would get
+ * for the XML, with whitespace and comments gone and every string
+ * stored once. It is private to one version of GTK, so it should be
+ * generated at build time.
+ *
+ * The data starts with GTK_BUILDER_PRECOMPILED_MAGIC, followed by
+ * the number of strings and that many nul-terminated strings. The
+ * records follow until the end of the data. All numbers are unsigned
+ * varints with 7 bits per byte, least significant first, and strings
+ * are referenced by their index.
+ *
+ *   START   element line column n_attributes (name value)*
+ *   END
+ *   TEXT    text
+ *   MARKUP  xml n_wrappers
+ *
+ * Elements the builder doesn't handle itself are given to custom
+ * parsers, which need a real GMarkupParseContext. Those are kept as
+ * MARKUP records holding their XML, nested in n_wrappers elements
+ * named like their ancestors so parent checks keep working.
+ */
+
+#define GTK_BUILDER_PRECOMPILED_MAGIC "\377GtkBuilder\001"
+#define GTK_BUILDER_PRECOMPILED_MAGIC_LEN 12
+
+typedef enum {
+  GTK_BUILDER_RECORD_START = 1,
+  GTK_BUILDER_RECORD_END,
+  GTK_BUILDER_RECORD_TEXT,
+  GTK_BUILDER_RECORD_MARKUP
+} GtkBuilderRecordType;
+
+GBytes *        _gtk_builder_precompile         (const gchar    *buffer,
+                                                 gssize          length,
+                                                 GError        **error);
+
+G_END_DECLS
+
+#endif /* __GTK_BUILDER_PRECOMPILE_PRIVATE_H__ */
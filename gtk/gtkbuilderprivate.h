@@ -116,6 +116,13 @@ typedef struct {
   SubParser *subparser;
   GMarkupParseContext *ctx;
   const gchar *filename;
+
+  /* position and element of the record being replayed
+   * from precompiled data, where ctx is NULL */
+  gint line;
+  gint col;
+  const gchar *element;
+
   GSList *finalizers;
   GSList *custom_finalizers;
 
@@ -188,6 +195,10 @@ GType     _gtk_builder_get_template_type (GtkBuilder *builder);
 void _gtk_builder_prefix_error            (GtkBuilder           *builder,
                                            GMarkupParseContext  *context,
                                            GError              **error);
+void _gtk_builder_prefix_error_at         (GtkBuilder           *builder,
+                                           gint                  line,
+                                           gint                  col,
+                                           GError              **error);
 void _gtk_builder_error_unhandled_tag     (GtkBuilder           *builder,
                                            GMarkupParseContext  *context,
                                            const gchar          *object,
@@ -516,6 +516,10 @@ typedef struct {
   gpointer               data;
   GDestroyNotify         destroy;
   GtkCellLayout         *proxy;
+
+  /* Hash of the values last applied to the renderer */
+  guint64                data_stamp;
+  guint                  data_stamp_valid : 1;
 } CellInfo;
 
 static CellInfo       *cell_info_new       (GtkCellLayoutDataFunc  func,
@@ -578,6 +582,8 @@ struct _GtkCellAreaPrivate
 
   /* Tracking which cells are focus siblings of focusable cells */
   GHashTable      *focus_siblings;
+
+  guint            applying_attributes : 1;
 };
 
 enum {
@@ -1196,6 +1202,100 @@ gtk_cell_area_real_snapshot (GtkCellArea          *area,
     }
 }
 
+/* FNV-1a, so that stamps of rows with different strings don't collide
+ * as easily as with a 32 bit hash */
+#define STAMP_PRIME G_GUINT64_CONSTANT (0x100000001b3)
+
+static guint64
+stamp_add_bytes (guint64       stamp,
+                 gconstpointer data,
+                 gsize         size)
+{
+  const guchar *p = data;
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    stamp = (stamp ^ p[i]) * STAMP_PRIME;
+
+  return stamp;
+}
+
+/* Adds a value to the stamp of a cell. Values of types that can't be
+ * compared without knowing them, like boxed types, which are copied
+ * out of the model, make the stamp unusable. */
+static gboolean
+stamp_add_value (guint64      *stamp,
+                 const GValue *value)
+{
+  GType type = G_VALUE_TYPE (value);
+  union {
+    gint64 i;
+    gdouble d;
+    gpointer p;
+  } v = { 0, };
+
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_STRING:
+      {
+        const char *str = g_value_get_string (value);
+
+        if (str)
+          *stamp = stamp_add_bytes (*stamp, str, strlen (str) + 1);
+        else
+          *stamp = stamp_add_bytes (*stamp, &v, sizeof (v));
+      }
+      break;
+
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_ENUM:
+      v.i = value->data[0].v_int;
+      break;
+
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_FLAGS:
+      v.i = value->data[0].v_uint;
+      break;
+
+    case G_TYPE_LONG:
+      v.i = value->data[0].v_long;
+      break;
+
+    case G_TYPE_ULONG:
+      v.i = value->data[0].v_ulong;
+      break;
+
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+      v.i = value->data[0].v_int64;
+      break;
+
+    case G_TYPE_FLOAT:
+      v.d = value->data[0].v_float;
+      break;
+
+    case G_TYPE_DOUBLE:
+      v.d = value->data[0].v_double;
+      break;
+
+    case G_TYPE_OBJECT:
+      /* The model holds a reference, so the object stays the same */
+      v.p = g_value_get_object (value);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  *stamp = stamp_add_bytes (*stamp, &type, sizeof (type));
+  *stamp = stamp_add_bytes (*stamp, &v, sizeof (v));
+
+  return TRUE;
+}
+
 static void
 apply_cell_attributes (GtkCellRenderer *renderer,
                        CellInfo        *info,
@@ -1221,6 +1321,11 @@ apply_cell_attributes (GtkCellRenderer *renderer,
   if (is_expanded != data->is_expanded)
     g_object_set (renderer, "is-expanded", data->is_expanded, NULL);
 
+  info->data_stamp = G_GUINT64_CONSTANT (0xcbf29ce484222325);
+  info->data_stamp = stamp_add_bytes (info->data_stamp, &data->is_expander, sizeof (gboolean));
+  info->data_stamp = stamp_add_bytes (info->data_stamp, &data->is_expanded, sizeof (gboolean));
+  info->data_stamp_valid = TRUE;
+
   /* Apply the attributes directly to the renderer */
   for (list = info->attributes; list; list = list->next)
     {
@@ -1228,14 +1333,20 @@ apply_cell_attributes (GtkCellRenderer *renderer,
 
       gtk_tree_model_get_value (data->model, data->iter, attribute->column, &value);
       g_object_set_property (G_OBJECT (renderer), attribute->attribute, &value);
+      if (info->data_stamp_valid)
+        info->data_stamp_valid = stamp_add_value (&info->data_stamp, &value);
       g_value_unset (&value);
     }
 
-  /* Call any GtkCellLayoutDataFunc that may have been set by the user
+  /* Call any GtkCellLayoutDataFunc that may have been set by the user,
+   * there is no telling what it changes
    */
   if (info->func)
-    info->func (info->proxy ? info->proxy : GTK_CELL_LAYOUT (data->area), renderer,
-		data->model, data->iter, info->data);
+    {
+      info->func (info->proxy ? info->proxy : GTK_CELL_LAYOUT (data->area), renderer,
+                  data->model, data->iter, info->data);
+      info->data_stamp_valid = FALSE;
+    }
 
   g_object_thaw_notify (G_OBJECT (renderer));
 }
@@ -1263,7 +1374,9 @@ gtk_cell_area_real_apply_attributes (GtkCellArea           *area,
 
   /* Go over any cells that have attributes or custom GtkCellLayoutDataFuncs and
    * apply the data from the treemodel */
+  priv->applying_attributes = TRUE;
   g_hash_table_foreach (priv->cell_info, (GHFunc)apply_cell_attributes, &data);
+  priv->applying_attributes = FALSE;
 
   /* Update the currently applied path */
   g_free (priv->current_path);
@@ -2204,6 +2317,7 @@ gtk_cell_area_attribute_connect (GtkCellArea        *area,
     }
 
   info->attributes = g_slist_prepend (info->attributes, cell_attribute);
+  info->data_stamp_valid = FALSE;
 }
 
 /**
@@ -2245,6 +2359,7 @@ gtk_cell_area_attribute_disconnect (GtkCellArea        *area,
           cell_attribute_free (cell_attribute);
 
           info->attributes = g_slist_delete_link (info->attributes, node);
+          info->data_stamp_valid = FALSE;
         }
     }
 }
@@ -3575,3 +3690,34 @@ _gtk_cell_area_set_cell_data_func_with_proxy (GtkCellArea           *area,
       g_hash_table_insert (priv->cell_info, cell, info);
     }
 }
+
+/* Returns in @stamp a hash of the data that was applied to @renderer
+ * for the current row, so that sizes measured for one row can be
+ * reused for rows with the same data. Returns %FALSE if there is no
+ * such hash, because a GtkCellLayoutDataFunc is set for @renderer or
+ * one of its attributes has a type that can't be hashed. */
+gboolean
+_gtk_cell_area_get_cell_data_stamp (GtkCellArea     *area,
+                                    GtkCellRenderer *renderer,
+                                    guint64         *stamp)
+{
+  CellInfo *info;
+
+  info = g_hash_table_lookup (area->priv->cell_info, renderer);
+  if (info == NULL)
+    {
+      /* Nothing is ever applied to the renderer */
+      *stamp = 0;
+      return TRUE;
+    }
+
+  *stamp = info->data_stamp;
+
+  return info->data_stamp_valid;
+}
+
+gboolean
+_gtk_cell_area_is_applying_attributes (GtkCellArea *area)
+{
+  return area->priv->applying_attributes;
+}
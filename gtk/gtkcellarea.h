@@ -529,6 +529,11 @@ void                 _gtk_cell_area_set_cell_data_func_with_proxy  (GtkCellArea
 								    GDestroyNotify         destroy,
 								    gpointer               proxy);
 
+gboolean             _gtk_cell_area_get_cell_data_stamp            (GtkCellArea           *area,
+                                                                    GtkCellRenderer       *renderer,
+                                                                    guint64               *stamp);
+gboolean             _gtk_cell_area_is_applying_attributes         (GtkCellArea           *area);
+
 G_END_DECLS
 
 #endif /* __GTK_CELL_AREA_H__ */
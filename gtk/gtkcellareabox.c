@@ -145,6 +145,7 @@ static void      gtk_cell_area_box_focus_changed                  (GtkCellArea
 /* CellInfo/CellGroup metadata handling and convenience functions */
 typedef struct {
   GtkCellRenderer *renderer;
+  gulong           notify_id;
 
   guint            expand : 1; /* Whether the cell expands */
   guint            pack   : 1; /* Whether it is packed from the start or end */
@@ -169,7 +170,8 @@ typedef struct {
   gint             size;
 } AllocatedCell;
 
-static CellInfo      *cell_info_new          (GtkCellRenderer       *renderer,
+static CellInfo      *cell_info_new          (GtkCellAreaBox        *box,
+                                              GtkCellRenderer       *renderer,
                                               GtkPackType            pack,
                                               gboolean               expand,
                                               gboolean               align,
@@ -378,8 +380,26 @@ gtk_cell_area_box_class_init (GtkCellAreaBoxClass *class)
 /*************************************************************
  *    CellInfo/CellGroup basics and convenience functions    *
  *************************************************************/
+static void
+cell_notify (GtkCellRenderer *renderer,
+             GParamSpec      *pspec,
+             GtkCellAreaBox  *box)
+{
+  GtkCellAreaBoxPrivate *priv = box->priv;
+  GSList                *l;
+
+  /* Properties that are set for each row are part of the data stamp,
+   * anything else can change the size of the renderer in every row */
+  if (_gtk_cell_area_is_applying_attributes (GTK_CELL_AREA (box)))
+    return;
+
+  for (l = priv->contexts; l; l = l->next)
+    _gtk_cell_area_box_context_clear_cell_sizes (l->data);
+}
+
 static CellInfo *
-cell_info_new  (GtkCellRenderer *renderer,
+cell_info_new  (GtkCellAreaBox  *box,
+                GtkCellRenderer *renderer,
                 GtkPackType      pack,
                 gboolean         expand,
                 gboolean         align,
@@ -387,11 +407,12 @@ cell_info_new  (GtkCellRenderer *renderer,
 {
   CellInfo *info = g_slice_new (CellInfo);
 
-  info->renderer = g_object_ref_sink (renderer);
-  info->pack     = pack;
-  info->expand   = expand;
-  info->align    = align;
-  info->fixed    = fixed;
+  info->renderer  = g_object_ref_sink (renderer);
+  info->notify_id = g_signal_connect (renderer, "notify", G_CALLBACK (cell_notify), box);
+  info->pack      = pack;
+  info->expand    = expand;
+  info->align     = align;
+  info->fixed     = fixed;
 
   return info;
 }
@@ -399,6 +420,7 @@ cell_info_new  (GtkCellRenderer *renderer,
 static void
 cell_info_free (CellInfo *info)
 {
+  g_signal_handler_disconnect (info->renderer, info->notify_id);
   g_object_unref (info->renderer);
 
   g_slice_free (CellInfo, info);
@@ -1482,6 +1504,41 @@ gtk_cell_area_box_get_request_mode (GtkCellArea *area)
     GTK_SIZE_REQUEST_WIDTH_FOR_HEIGHT;
 }
 
+/* Requests the size of a cell for the current row, reusing what was
+ * measured for a row with the same data before */
+static void
+request_cell (GtkCellAreaBox        *box,
+              GtkCellAreaBoxContext *context,
+              CellInfo              *info,
+              GtkOrientation         orientation,
+              GtkWidget             *widget,
+              gint                   for_size,
+              gint                  *minimum_size,
+              gint                  *natural_size)
+{
+  GtkCellArea *area = GTK_CELL_AREA (box);
+  guint64      stamp;
+
+  if (!_gtk_cell_area_get_cell_data_stamp (area, info->renderer, &stamp))
+    {
+      gtk_cell_area_request_renderer (area, info->renderer, orientation, widget, for_size,
+                                      minimum_size, natural_size);
+      return;
+    }
+
+  if (_gtk_cell_area_box_context_get_cell_size (context, info->renderer, stamp,
+                                                orientation, for_size,
+                                                minimum_size, natural_size))
+    return;
+
+  gtk_cell_area_request_renderer (area, info->renderer, orientation, widget, for_size,
+                                  minimum_size, natural_size);
+
+  _gtk_cell_area_box_context_push_cell_size (context, info->renderer, stamp,
+                                             orientation, for_size,
+                                             *minimum_size, *natural_size);
+}
+
 static void
 compute_size (GtkCellAreaBox        *box,
               GtkOrientation         orientation,
@@ -1492,7 +1549,6 @@ compute_size (GtkCellAreaBox        *box,
               gint                  *natural_size)
 {
   GtkCellAreaBoxPrivate *priv = box->priv;
-  GtkCellArea           *area = GTK_CELL_AREA (box);
   GList                 *list;
   gint                   i;
   gint                   min_size = 0;
@@ -1512,8 +1568,8 @@ compute_size (GtkCellAreaBox        *box,
           if (!gtk_cell_renderer_get_visible (info->renderer))
               continue;
 
-          gtk_cell_area_request_renderer (area, info->renderer, orientation, widget, for_size,
-                                          &renderer_min_size, &renderer_nat_size);
+          request_cell (box, context, info, orientation, widget, for_size,
+                        &renderer_min_size, &renderer_nat_size);
 
           if (orientation == priv->orientation)
             {
@@ -1570,11 +1626,12 @@ compute_size (GtkCellAreaBox        *box,
 }
 
 static GtkRequestedSize *
-get_group_sizes (GtkCellArea    *area,
-                 CellGroup      *group,
-                 GtkOrientation  orientation,
-                 GtkWidget      *widget,
-                 gint           *n_sizes)
+get_group_sizes (GtkCellAreaBox        *box,
+                 GtkCellAreaBoxContext *context,
+                 CellGroup             *group,
+                 GtkOrientation         orientation,
+                 GtkWidget             *widget,
+                 gint                  *n_sizes)
 {
   GtkRequestedSize *sizes;
   GList            *l;
@@ -1592,10 +1649,9 @@ get_group_sizes (GtkCellArea    *area,
 
       sizes[i].data = info;
 
-      gtk_cell_area_request_renderer (area, info->renderer,
-                                      orientation, widget, -1,
-                                      &sizes[i].minimum_size,
-                                      &sizes[i].natural_size);
+      request_cell (box, context, info, orientation, widget, -1,
+                    &sizes[i].minimum_size,
+                    &sizes[i].natural_size);
 
       i++;
     }
@@ -1604,24 +1660,24 @@ get_group_sizes (GtkCellArea    *area,
 }
 
 static void
-compute_group_size_for_opposing_orientation (GtkCellAreaBox     *box,
-                                             CellGroup          *group,
-                                             GtkWidget          *widget,
-                                             gint                for_size,
-                                             gint               *minimum_size,
-                                             gint               *natural_size)
+compute_group_size_for_opposing_orientation (GtkCellAreaBox        *box,
+                                             GtkCellAreaBoxContext *context,
+                                             CellGroup             *group,
+                                             GtkWidget             *widget,
+                                             gint                   for_size,
+                                             gint                  *minimum_size,
+                                             gint                  *natural_size)
 {
   GtkCellAreaBoxPrivate *priv = box->priv;
-  GtkCellArea           *area = GTK_CELL_AREA (box);
 
   /* Exception for single cell groups */
   if (group->n_cells == 1)
     {
       CellInfo *info = group->cells->data;
 
-      gtk_cell_area_request_renderer (area, info->renderer,
-                                      OPPOSITE_ORIENTATION (priv->orientation),
-                                      widget, for_size, minimum_size, natural_size);
+      request_cell (box, context, info,
+                    OPPOSITE_ORIENTATION (priv->orientation),
+                    widget, for_size, minimum_size, natural_size);
     }
   else
     {
@@ -1632,7 +1688,7 @@ compute_group_size_for_opposing_orientation (GtkCellAreaBox     *box,
       gint              extra_size, extra_extra;
       gint              min_size = 0, nat_size = 0;
 
-      orientation_sizes = get_group_sizes (area, group, priv->orientation, widget, &n_sizes);
+      orientation_sizes = get_group_sizes (box, context, group, priv->orientation, widget, &n_sizes);
 
       /* First naturally allocate the cells in the group into the for_size */
       avail_size -= (n_sizes - 1) * priv->spacing;
@@ -1669,11 +1725,11 @@ compute_group_size_for_opposing_orientation (GtkCellAreaBox     *box,
                 }
             }
 
-          gtk_cell_area_request_renderer (area, info->renderer,
-                                          OPPOSITE_ORIENTATION (priv->orientation),
-                                          widget,
-                                          orientation_sizes[i].minimum_size,
-                                          &cell_min, &cell_nat);
+          request_cell (box, context, info,
+                        OPPOSITE_ORIENTATION (priv->orientation),
+                        widget,
+                        orientation_sizes[i].minimum_size,
+                        &cell_min, &cell_nat);
 
           min_size = MAX (min_size, cell_min);
           nat_size = MAX (nat_size, cell_nat);
@@ -1752,7 +1808,7 @@ compute_size_for_opposing_orientation (GtkCellAreaBox        *box,
       /* Now we have the allocation for the group,
        * request its height-for-width
        */
-      compute_group_size_for_opposing_orientation (box, group, widget,
+      compute_group_size_for_opposing_orientation (box, context, group, widget,
                                                    orientation_sizes[i].minimum_size,
                                                    &group_min, &group_nat);
 
@@ -1797,6 +1853,7 @@ gtk_cell_area_box_get_preferred_width (GtkCellArea        *area,
   g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (context));
 
   box_context = GTK_CELL_AREA_BOX_CONTEXT (context);
+  _gtk_cell_area_box_context_check_cell_sizes (box_context, widget);
 
   /* Compute the size of all renderers for current row data,
    * bumping cell alignments in the context along the way
@@ -1825,6 +1882,7 @@ gtk_cell_area_box_get_preferred_height (GtkCellArea        *area,
   g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (context));
 
   box_context = GTK_CELL_AREA_BOX_CONTEXT (context);
+  _gtk_cell_area_box_context_check_cell_sizes (box_context, widget);
 
   /* Compute the size of all renderers for current row data,
    * bumping cell alignments in the context along the way
@@ -1855,6 +1913,7 @@ gtk_cell_area_box_get_preferred_height_for_width (GtkCellArea        *area,
   g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (context));
 
   box_context = GTK_CELL_AREA_BOX_CONTEXT (context);
+  _gtk_cell_area_box_context_check_cell_sizes (box_context, widget);
   priv        = box->priv;
 
   if (priv->orientation == GTK_ORIENTATION_VERTICAL)
@@ -1896,6 +1955,7 @@ gtk_cell_area_box_get_preferred_width_for_height (GtkCellArea        *area,
   g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (context));
 
   box_context = GTK_CELL_AREA_BOX_CONTEXT (context);
+  _gtk_cell_area_box_context_check_cell_sizes (box_context, widget);
   priv        = box->priv;
 
   if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
@@ -2152,7 +2212,7 @@ gtk_cell_area_box_pack_start  (GtkCellAreaBox  *box,
       return;
     }
 
-  info = cell_info_new (renderer, GTK_PACK_START, expand, align, fixed);
+  info = cell_info_new (box, renderer, GTK_PACK_START, expand, align, fixed);
 
   priv->cells = g_list_append (priv->cells, info);
 
@@ -2195,7 +2255,7 @@ gtk_cell_area_box_pack_end (GtkCellAreaBox  *box,
       return;
     }
 
-  info = cell_info_new (renderer, GTK_PACK_END, expand, align, fixed);
+  info = cell_info_new (box, renderer, GTK_PACK_END, expand, align, fixed);
 
   priv->cells = g_list_append (priv->cells, info);
 
@@ -24,6 +24,7 @@
 #include "gtkcellareabox.h"
 #include "gtkcellareaboxcontextprivate.h"
 #include "gtkorientable.h"
+#include "gtkwidget.h"
 
 /* GObjectClass */
 static void      _gtk_cell_area_box_context_finalize              (GObject               *object);
@@ -63,6 +64,21 @@ typedef struct {
   gint     nat_size;
 } CachedSize;
 
+/* Size of a single cell for the data of a row, see
+ * _gtk_cell_area_get_cell_data_stamp() */
+typedef struct {
+  guint64          stamp;
+  GtkCellRenderer *renderer;
+  GtkOrientation   orientation;
+  gint             for_size;
+
+  gint             min_size;
+  gint             nat_size;
+} CellSize;
+
+/* The cell sizes are dropped all at once when there are more */
+#define MAX_CELL_SIZES 16384
+
 struct _GtkCellAreaBoxContextPrivate
 {
   /* Table of per renderer CachedSizes */
@@ -78,6 +94,13 @@ struct _GtkCellAreaBoxContextPrivate
 
   /* Whether each group is aligned */
   gboolean  *align;
+
+  /* Sizes of cells for row data measured before. Unlike the sizes
+   * above, these survive resets, they only depend on the cell data
+   * and on the font of the widget they were measured for. */
+  GHashTable           *cell_sizes;
+  PangoFontDescription *cell_sizes_font;
+  gint                  cell_sizes_scale;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCellAreaBoxContext, _gtk_cell_area_box_context, GTK_TYPE_CELL_AREA_CONTEXT)
@@ -136,6 +159,35 @@ get_array (GtkCellAreaBoxContext *context,
   return array;
 }
 
+static guint
+cell_size_hash (gconstpointer v)
+{
+  const CellSize *size = v;
+
+  return (guint) (size->stamp ^ (size->stamp >> 32)) ^
+         GPOINTER_TO_UINT (size->renderer) ^
+         (size->for_size << 1) ^ size->orientation;
+}
+
+static gboolean
+cell_size_equal (gconstpointer v1,
+                 gconstpointer v2)
+{
+  const CellSize *s1 = v1;
+  const CellSize *s2 = v2;
+
+  return s1->stamp == s2->stamp &&
+         s1->renderer == s2->renderer &&
+         s1->orientation == s2->orientation &&
+         s1->for_size == s2->for_size;
+}
+
+static void
+cell_size_free (gpointer data)
+{
+  g_slice_free (CellSize, data);
+}
+
 static gboolean 
 group_expands (GtkCellAreaBoxContext *context,
                gint                   group_idx)
@@ -177,6 +229,9 @@ _gtk_cell_area_box_context_init (GtkCellAreaBoxContext *box_context)
                                               NULL, (GDestroyNotify)free_cache_array);
   priv->heights      = g_hash_table_new_full (g_direct_hash, g_direct_equal,
                                               NULL, (GDestroyNotify)free_cache_array);
+
+  priv->cell_sizes   = g_hash_table_new_full (cell_size_hash, cell_size_equal,
+                                              cell_size_free, NULL);
 }
 
 static void 
@@ -206,6 +261,8 @@ _gtk_cell_area_box_context_finalize (GObject *object)
   g_array_free (priv->base_heights, TRUE);
   g_hash_table_destroy (priv->widths);
   g_hash_table_destroy (priv->heights);
+  g_hash_table_destroy (priv->cell_sizes);
+  g_clear_pointer (&priv->cell_sizes_font, pango_font_description_free);
 
   g_free (priv->expand);
   g_free (priv->align);
@@ -417,6 +474,10 @@ _gtk_cell_area_box_init_groups (GtkCellAreaBoxContext *box_context,
   gtk_cell_area_context_reset (GTK_CELL_AREA_CONTEXT (box_context));
 
   priv = box_context->priv;
+
+  /* Cells may have been removed, and new ones can have the same address */
+  _gtk_cell_area_box_context_clear_cell_sizes (box_context);
+
   g_array_set_size (priv->base_widths,  n_groups);
   g_array_set_size (priv->base_heights, n_groups);
 
@@ -805,6 +866,88 @@ allocate_for_orientation (GtkCellAreaBoxContext *context,
   return allocs;
 }
 
+/* Drops the cell sizes if they were measured for a different font */
+void
+_gtk_cell_area_box_context_check_cell_sizes (GtkCellAreaBoxContext *box_context,
+                                             GtkWidget             *widget)
+{
+  GtkCellAreaBoxContextPrivate *priv = box_context->priv;
+  const PangoFontDescription   *font;
+  gint                          scale;
+
+  font  = pango_context_get_font_description (gtk_widget_get_pango_context (widget));
+  scale = gtk_widget_get_scale_factor (widget);
+
+  if (priv->cell_sizes_font &&
+      scale == priv->cell_sizes_scale &&
+      pango_font_description_equal (font, priv->cell_sizes_font))
+    return;
+
+  _gtk_cell_area_box_context_clear_cell_sizes (box_context);
+
+  g_clear_pointer (&priv->cell_sizes_font, pango_font_description_free);
+  priv->cell_sizes_font  = pango_font_description_copy (font);
+  priv->cell_sizes_scale = scale;
+}
+
+void
+_gtk_cell_area_box_context_clear_cell_sizes (GtkCellAreaBoxContext *box_context)
+{
+  g_hash_table_remove_all (box_context->priv->cell_sizes);
+}
+
+gboolean
+_gtk_cell_area_box_context_get_cell_size (GtkCellAreaBoxContext *box_context,
+                                          GtkCellRenderer       *renderer,
+                                          guint64                stamp,
+                                          GtkOrientation         orientation,
+                                          gint                   for_size,
+                                          gint                  *minimum_size,
+                                          gint                  *natural_size)
+{
+  CellSize key, *size;
+
+  key.stamp       = stamp;
+  key.renderer    = renderer;
+  key.orientation = orientation;
+  key.for_size    = for_size;
+
+  size = g_hash_table_lookup (box_context->priv->cell_sizes, &key);
+  if (size == NULL)
+    return FALSE;
+
+  *minimum_size = size->min_size;
+  *natural_size = size->nat_size;
+
+  return TRUE;
+}
+
+void
+_gtk_cell_area_box_context_push_cell_size (GtkCellAreaBoxContext *box_context,
+                                           GtkCellRenderer       *renderer,
+                                           guint64                stamp,
+                                           GtkOrientation         orientation,
+                                           gint                   for_size,
+                                           gint                   minimum_size,
+                                           gint                   natural_size)
+{
+  GtkCellAreaBoxContextPrivate *priv = box_context->priv;
+  CellSize                     *size;
+
+  if (g_hash_table_size (priv->cell_sizes) >= MAX_CELL_SIZES)
+    g_hash_table_remove_all (priv->cell_sizes);
+
+  size = g_slice_new (CellSize);
+  size->stamp       = stamp;
+  size->renderer    = renderer;
+  size->orientation = orientation;
+  size->for_size    = for_size;
+  size->min_size    = minimum_size;
+  size->nat_size    = natural_size;
+
+  g_hash_table_add (priv->cell_sizes, size);
+}
+
 GtkRequestedSize *
 _gtk_cell_area_box_context_get_widths (GtkCellAreaBoxContext *box_context,
                                       gint                  *n_widths)
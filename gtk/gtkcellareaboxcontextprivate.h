@@ -116,6 +116,25 @@ void    _gtk_cell_area_box_context_get_group_width_for_height   (GtkCellAreaBoxC
                                                                 gint                  *minimum_width,
                                                                 gint                  *natural_width);
 
+/* Sizes of single cells for the data of a row */
+void    _gtk_cell_area_box_context_check_cell_sizes            (GtkCellAreaBoxContext *box_context,
+                                                                GtkWidget             *widget);
+void    _gtk_cell_area_box_context_clear_cell_sizes            (GtkCellAreaBoxContext *box_context);
+gboolean _gtk_cell_area_box_context_get_cell_size              (GtkCellAreaBoxContext *box_context,
+                                                                GtkCellRenderer       *renderer,
+                                                                guint64                stamp,
+                                                                GtkOrientation         orientation,
+                                                                gint                   for_size,
+                                                                gint                  *minimum_size,
+                                                                gint                  *natural_size);
+void    _gtk_cell_area_box_context_push_cell_size              (GtkCellAreaBoxContext *box_context,
+                                                                GtkCellRenderer       *renderer,
+                                                                guint64                stamp,
+                                                                GtkOrientation         orientation,
+                                                                gint                   for_size,
+                                                                gint                   minimum_size,
+                                                                gint                   natural_size);
+
 GtkRequestedSize *_gtk_cell_area_box_context_get_widths         (GtkCellAreaBoxContext *box_context,
                                                                 gint                  *n_widths);
 GtkRequestedSize *_gtk_cell_area_box_context_get_heights        (GtkCellAreaBoxContext *box_context,
@@ -30,7 +30,7 @@
 
 
 #define GTK_COMPOSE_TABLE_MAGIC "GtkComposeTable"
-#define GTK_COMPOSE_TABLE_VERSION (1)
+#define GTK_COMPOSE_TABLE_VERSION (2)
 
 typedef struct {
   gunichar     *sequence;
@@ -534,63 +534,54 @@ gtk_compose_hash_get_cache_path (guint32 hash)
   return path;
 }
 
+/* The header of a cache file. The sequences follow it, in the byte
+ * order of the machine that wrote the file, so that the file can be
+ * mapped and searched directly. All processes of the user then share
+ * the same pages. The magic includes the trailing nul so that the
+ * sequences are aligned.
+ */
+typedef struct {
+  gchar   magic[sizeof (GTK_COMPOSE_TABLE_MAGIC)];
+  guint16 version;
+  guint16 byte_order;
+  guint16 max_seq_len;
+  guint16 n_seqs;
+} GtkComposeTableHeader;
+
+#define GTK_COMPOSE_TABLE_BYTE_ORDER (0x0102)
+
 static gchar *
 gtk_compose_table_serialize (GtkComposeTable *compose_table,
                              gsize           *count)
 {
-  gchar *p, *contents;
-  gsize length, total_length;
-  guint16 bytes;
-  const gchar *header = GTK_COMPOSE_TABLE_MAGIC;
-  const guint16 version = GTK_COMPOSE_TABLE_VERSION;
+  gchar *contents;
+  gsize total_length;
+  GtkComposeTableHeader header = { GTK_COMPOSE_TABLE_MAGIC, };
   guint16 max_seq_len = compose_table->max_seq_len;
   guint16 index_stride = max_seq_len + 2;
   guint16 n_seqs = compose_table->n_seqs;
-  guint32 i;
 
   g_return_val_if_fail (compose_table != NULL, NULL);
   g_return_val_if_fail (max_seq_len > 0, NULL);
   g_return_val_if_fail (index_stride > 0, NULL);
 
-  length = strlen (header);
-  total_length = length + sizeof (guint16) * (3 +  index_stride * n_seqs);
+  /* The version is big endian, so that caches written before the
+   * byte order was stored get rejected as well */
+  header.version = GUINT16_TO_BE (GTK_COMPOSE_TABLE_VERSION);
+  header.byte_order = GTK_COMPOSE_TABLE_BYTE_ORDER;
+  header.max_seq_len = max_seq_len;
+  header.n_seqs = n_seqs;
+
+  total_length = sizeof (GtkComposeTableHeader) + sizeof (guint16) * index_stride * n_seqs;
   if (count)
     *count = total_length;
 
-  p = contents = g_slice_alloc (total_length);
-
-  memcpy (p, header, length);
-  p += length;
-
-  /* Copy by byte for endian */
-#define BYTE_COPY_FROM_BUF(element)                                           \
-  bytes = GUINT16_TO_BE ((element));                                          \
-  memcpy (p, &bytes, length);                                                 \
-  p += length;                                                                \
-  if (p - contents > total_length)                                            \
-    {                                                                         \
-      g_warning ("data size %lld is bigger than %" G_GSIZE_FORMAT,            \
-                 (long long) (p - contents), total_length);                   \
-      g_free (contents);                                                      \
-      if (count)                                                              \
-        {                                                                     \
-          *count = 0;                                                         \
-        }                                                                     \
-      return NULL;                                                            \
-    }
-
-  length = sizeof (guint16);
-
-  BYTE_COPY_FROM_BUF (version);
-  BYTE_COPY_FROM_BUF (max_seq_len);
-  BYTE_COPY_FROM_BUF (n_seqs);
-
-  for (i = 0; i < (guint32) index_stride * n_seqs; i++)
-    {
-      BYTE_COPY_FROM_BUF (compose_table->data[i]);
-    }
+  contents = g_slice_alloc (total_length);
 
-#undef BYTE_COPY_FROM_BUF
+  memcpy (contents, &header, sizeof (GtkComposeTableHeader));
+  memcpy (contents + sizeof (GtkComposeTableHeader),
+          compose_table->data,
+          sizeof (guint16) * index_stride * n_seqs);
 
   return contents;
 }
@@ -609,20 +600,15 @@ gtk_compose_table_load_cache (const gchar *compose_file)
 {
   guint32 hash;
   gchar *path = NULL;
-  gchar *contents = NULL;
-  gchar *p;
+  GMappedFile *mapped_file = NULL;
+  const gchar *contents;
   GStatBuf original_buf;
   GStatBuf cache_buf;
   gsize total_length;
-  gsize length;
   GError *error = NULL;
-  guint16 bytes;
+  GtkComposeTableHeader header;
   guint16 version;
-  guint16 max_seq_len;
-  guint16 index_stride;
-  guint16 n_seqs;
-  guint32 i;
-  guint16 *gtk_compose_seqs = NULL;
+  gsize index_stride;
   GtkComposeTable *retval;
 
   hash = g_str_hash (compose_file);
@@ -635,81 +621,66 @@ gtk_compose_table_load_cache (const gchar *compose_file)
   g_stat (path, &cache_buf);
   if (original_buf.st_mtime > cache_buf.st_mtime)
     goto out_load_cache;
-  if (!g_file_get_contents (path, &contents, &total_length, &error))
+
+  mapped_file = g_mapped_file_new (path, FALSE, &error);
+  if (mapped_file == NULL)
     {
-      g_warning ("Failed to get cache content %s: %s", path, error->message);
+      g_warning ("Failed to map cache content %s: %s", path, error->message);
       g_error_free (error);
       goto out_load_cache;
     }
 
-  /* Copy by byte for endian */
-#define BYTE_COPY_TO_BUF(element)                                       \
-  memcpy (&bytes, p, length);                                           \
-  element = GUINT16_FROM_BE (bytes);                                    \
-  p += length;                                                          \
-  if (p - contents > total_length)                                      \
-    {                                                                   \
-      g_warning ("Broken cache content %s in %s", path, #element);      \
-      goto out_load_cache;                                              \
-    }
+  contents = g_mapped_file_get_contents (mapped_file);
+  total_length = g_mapped_file_get_length (mapped_file);
 
-  p = contents;
-  if (g_ascii_strncasecmp (p, GTK_COMPOSE_TABLE_MAGIC,
-                           strlen (GTK_COMPOSE_TABLE_MAGIC)) != 0)
-    {
-      g_warning ("The file is not a GtkComposeTable cache file %s", path);
-      goto out_load_cache;
-    }
-  p += strlen (GTK_COMPOSE_TABLE_MAGIC);
-  if (p - contents > total_length)
+  if (total_length < sizeof (GtkComposeTableHeader))
     {
       g_warning ("Broken cache content %s at head", path);
       goto out_load_cache;
     }
 
-  length = sizeof (guint16);
+  memcpy (&header, contents, sizeof (GtkComposeTableHeader));
 
-  BYTE_COPY_TO_BUF (version);
-  if (version != GTK_COMPOSE_TABLE_VERSION)
+  if (g_ascii_strncasecmp (header.magic, GTK_COMPOSE_TABLE_MAGIC,
+                           sizeof (GTK_COMPOSE_TABLE_MAGIC)) != 0)
     {
-      g_warning ("cache version is different %u != %u",
-                 version, GTK_COMPOSE_TABLE_VERSION);
+      g_warning ("The file is not a GtkComposeTable cache file %s", path);
       goto out_load_cache;
     }
 
-  BYTE_COPY_TO_BUF (max_seq_len);
-  BYTE_COPY_TO_BUF (n_seqs);
+  /* Caches in an older format, or written on a machine with a
+   * different byte order, get replaced silently */
+  version = GUINT16_FROM_BE (header.version);
+  if (version != GTK_COMPOSE_TABLE_VERSION ||
+      header.byte_order != GTK_COMPOSE_TABLE_BYTE_ORDER)
+    goto out_load_cache;
 
-  if (max_seq_len == 0 || n_seqs == 0)
+  if (header.max_seq_len == 0 || header.n_seqs == 0)
     {
-      g_warning ("cache size is not correct %d %d", max_seq_len, n_seqs);
+      g_warning ("cache size is not correct %d %d", header.max_seq_len, header.n_seqs);
       goto out_load_cache;
     }
 
-  index_stride = max_seq_len + 2;
-  gtk_compose_seqs = g_new0 (guint16, n_seqs * index_stride);
-
-  for (i = 0; i < (guint32) index_stride * n_seqs; i++)
+  index_stride = header.max_seq_len + 2;
+  if (total_length != sizeof (GtkComposeTableHeader) + sizeof (guint16) * index_stride * header.n_seqs)
     {
-      BYTE_COPY_TO_BUF (gtk_compose_seqs[i]);
+      g_warning ("Broken cache content %s", path);
+      goto out_load_cache;
     }
 
   retval = g_new0 (GtkComposeTable, 1);
-  retval->data = gtk_compose_seqs;
-  retval->max_seq_len = max_seq_len;
-  retval->n_seqs = n_seqs;
+  retval->data = (const guint16 *) (contents + sizeof (GtkComposeTableHeader));
+  retval->max_seq_len = header.max_seq_len;
+  retval->n_seqs = header.n_seqs;
   retval->id = hash;
+  retval->mapped_file = mapped_file;
 
-  g_free (contents);
   g_free (path);
 
   return retval;
 
-#undef BYTE_COPY_TO_BUF
-
 out_load_cache:
-  g_free (gtk_compose_seqs);
-  g_free (contents);
+  g_clear_pointer (&mapped_file, g_mapped_file_unref);
   g_free (path);
   return NULL;
 }
@@ -859,7 +830,7 @@ gtk_compose_table_list_add_array (GSList        *compose_tables,
   for (i = 0; i < length; i++)
     gtk_compose_seqs[i] = data[i];
 
-  compose_table = g_new (GtkComposeTable, 1);
+  compose_table = g_new0 (GtkComposeTable, 1);
   compose_table->data = gtk_compose_seqs;
   compose_table->max_seq_len = max_seq_len;
   compose_table->n_seqs = n_seqs;
@@ -28,10 +28,13 @@ typedef struct _GtkComposeTableCompact GtkComposeTableCompact;
 
 struct _GtkComposeTable
 {
-  guint16 *data;
+  const guint16 *data;
   gint max_seq_len;
   gint n_seqs;
   guint32 id;
+
+  /* The cache file that @data points into, if any */
+  GMappedFile *mapped_file;
 };
 
 struct _GtkComposeTableCompact
@@ -33,6 +33,7 @@
 #include "gtkprivate.h"
 #include "gtkmarshalers.h"
 #include "gtksizerequest.h"
+#include "gtkstartupprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
@@ -349,6 +350,7 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
 			  GtkContainer  *container)
 {
   GtkContainerPrivate *priv = gtk_container_get_instance_private (container);
+  gint64 start = gtk_startup_begin (GTK_STARTUP_LAYOUT);
 
   /* We validate the style contexts in a single loop before even trying
    * to handle resizes instead of doing validations inline.
@@ -380,6 +382,8 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
         g_warning ("gtk_container_idle_sizer() called on a non-window");
     }
 
+  gtk_startup_end (GTK_STARTUP_LAYOUT, start);
+
   if (!gtk_container_needs_idle_sizer (container))
     {
       gtk_container_stop_idle_sizer (container);
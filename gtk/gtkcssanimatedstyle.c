@@ -46,11 +46,14 @@ gtk_css_animated_style_get_value (GtkCssStyle *style,
 {
   /* This is called a lot, so we avoid a dynamic type check here */
   GtkCssAnimatedStyle *animated = (GtkCssAnimatedStyle *) style;
+  guint i;
 
-  if (animated->animated_values &&
-      id < animated->animated_values->len &&
-      g_ptr_array_index (animated->animated_values, id))
-    return g_ptr_array_index (animated->animated_values, id);
+  /* Usually only very few values are animated */
+  for (i = 0; i < animated->n_animated_values; i++)
+    {
+      if (animated->animated_values[i].id == id)
+        return animated->animated_values[i].value;
+    }
 
   return gtk_css_animated_style_get_intrinsic_value (animated, id);
 }
@@ -83,12 +86,12 @@ static void
 gtk_css_animated_style_dispose (GObject *object)
 {
   GtkCssAnimatedStyle *style = GTK_CSS_ANIMATED_STYLE (object);
+  guint i;
 
-  if (style->animated_values)
-    {
-      g_ptr_array_unref (style->animated_values);
-      style->animated_values = NULL;
-    }
+  for (i = 0; i < style->n_animated_values; i++)
+    _gtk_css_value_unref (style->animated_values[i].value);
+  g_clear_pointer (&style->animated_values, g_free);
+  style->n_animated_values = 0;
 
   g_slist_free_full (style->animations, g_object_unref);
   style->animations = NULL;
@@ -130,18 +133,25 @@ gtk_css_animated_style_set_animated_value (GtkCssAnimatedStyle *style,
                                            guint                id,
                                            GtkCssValue         *value)
 {
+  guint i;
+
   gtk_internal_return_if_fail (GTK_IS_CSS_ANIMATED_STYLE (style));
   gtk_internal_return_if_fail (value != NULL);
 
-  if (style->animated_values == NULL)
-    style->animated_values = g_ptr_array_new_with_free_func ((GDestroyNotify)_gtk_css_value_unref);
-  if (id >= style->animated_values->len)
-   g_ptr_array_set_size (style->animated_values, id + 1);
-
-  if (g_ptr_array_index (style->animated_values, id))
-    _gtk_css_value_unref (g_ptr_array_index (style->animated_values, id));
-  g_ptr_array_index (style->animated_values, id) = _gtk_css_value_ref (value);
+  for (i = 0; i < style->n_animated_values; i++)
+    {
+      if (style->animated_values[i].id == id)
+        {
+          _gtk_css_value_unref (style->animated_values[i].value);
+          style->animated_values[i].value = _gtk_css_value_ref (value);
+          return;
+        }
+    }
 
+  style->n_animated_values++;
+  style->animated_values = g_renew (GtkCssAnimatedValue, style->animated_values, style->n_animated_values);
+  style->animated_values[i].id = id;
+  style->animated_values[i].value = _gtk_css_value_ref (value);
 }
 
 GtkCssValue *
@@ -33,6 +33,13 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssAnimatedStyle           GtkCssAnimatedStyle;
 typedef struct _GtkCssAnimatedStyleClass      GtkCssAnimatedStyleClass;
+typedef struct _GtkCssAnimatedValue           GtkCssAnimatedValue;
+
+struct _GtkCssAnimatedValue
+{
+  guint                  id;
+  GtkCssValue           *value;
+};
 
 struct _GtkCssAnimatedStyle
 {
@@ -40,7 +47,8 @@ struct _GtkCssAnimatedStyle
 
   GtkCssStyle           *style;                /* the style if we weren't animating */
 
-  GPtrArray             *animated_values;      /* NULL or array of animated values/NULL if not animated */
+  GtkCssAnimatedValue   *animated_values;      /* the values that differ from style */
+  guint                  n_animated_values;
   gint64                 current_time;         /* the current time in our world */
   GSList                *animations;           /* the running animations, least important one first */
 };
@@ -23,6 +23,8 @@
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
+  GtkCssValue *         last_result;    /* result of the last compute() */
+  GtkCssValue **        last_terms;     /* computed terms last_result was made from */
   gsize                 n_terms;
   GtkCssValue *         terms[1];
 };
@@ -44,6 +46,14 @@ gtk_css_value_calc_free (GtkCssValue *value)
       _gtk_css_value_unref (value->terms[i]);
     }
 
+  if (value->last_result)
+    {
+      for (i = 0; i < value->n_terms; i++)
+        _gtk_css_value_unref (value->last_terms[i]);
+      g_free (value->last_terms);
+      _gtk_css_value_unref (value->last_result);
+    }
+
   g_slice_free1 (gtk_css_value_calc_get_size (value->n_terms), value);
 }
 
@@ -104,30 +114,65 @@ gtk_css_value_calc_compute (GtkCssValue      *value,
                             GtkCssStyle      *style,
                             GtkCssStyle      *parent_style)
 {
+  GtkCssValue **computed;
   GtkCssValue *result;
   GPtrArray *array;
   gboolean changed = FALSE;
   gsize i;
 
-  array = g_ptr_array_new ();
+  computed = g_newa (GtkCssValue *, value->n_terms);
   for (i = 0; i < value->n_terms; i++)
     {
-      GtkCssValue *computed = _gtk_css_value_compute (value->terms[i], property_id, provider, style, parent_style);
-      changed |= computed != value->terms[i];
-      gtk_css_calc_array_add (array, computed);
+      computed[i] = _gtk_css_value_compute (value->terms[i], property_id, provider, style, parent_style);
+      changed |= computed[i] != value->terms[i];
     }
 
-  if (changed)
+  if (!changed)
     {
-      result = gtk_css_value_new_from_array (array);
+      for (i = 0; i < value->n_terms; i++)
+        _gtk_css_value_unref (computed[i]);
+
+      return _gtk_css_value_ref (value);
+    }
+
+  /* Computed dimensions are interned, so if all terms are the same
+   * pointers as last time, so is the sum. This is the common case of
+   * many nodes with the same font size computing the same value. */
+  if (value->last_result)
+    {
+      for (i = 0; i < value->n_terms; i++)
+        {
+          if (computed[i] != value->last_terms[i])
+            break;
+        }
+
+      if (i == value->n_terms)
+        {
+          for (i = 0; i < value->n_terms; i++)
+            _gtk_css_value_unref (computed[i]);
+
+          return _gtk_css_value_ref (value->last_result);
+        }
+
+      for (i = 0; i < value->n_terms; i++)
+        _gtk_css_value_unref (value->last_terms[i]);
+      _gtk_css_value_unref (value->last_result);
     }
   else
     {
-      g_ptr_array_set_free_func (array, (GDestroyNotify) _gtk_css_value_unref);
-      g_ptr_array_free (array, TRUE);
-      result = _gtk_css_value_ref (value);
+      value->last_terms = g_new (GtkCssValue *, value->n_terms);
+    }
+
+  array = g_ptr_array_new ();
+  for (i = 0; i < value->n_terms; i++)
+    {
+      gtk_css_calc_array_add (array, _gtk_css_value_ref (computed[i]));
+      value->last_terms[i] = computed[i];
     }
 
+  result = gtk_css_value_new_from_array (array);
+  value->last_result = _gtk_css_value_ref (result);
+
   return result;
 }
 
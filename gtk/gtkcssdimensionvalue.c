@@ -30,9 +30,38 @@ struct _GtkCssValue {
   double value;
 };
 
+/* Dimensions are immutable, so all equal values share one instance.
+ * This saves allocations when computing styles, and lets comparisons
+ * of computed styles succeed on the pointer check. Values remove
+ * themselves from the table when they are freed. */
+static GHashTable *interned_dimensions;
+
+static guint
+gtk_css_value_dimension_hash (gconstpointer data)
+{
+  const GtkCssValue *number = data;
+
+  return g_double_hash (&number->value) ^ number->unit;
+}
+
+static gboolean
+gtk_css_value_dimension_intern_equal (gconstpointer data1,
+                                      gconstpointer data2)
+{
+  const GtkCssValue *number1 = data1;
+  const GtkCssValue *number2 = data2;
+
+  return number1->unit == number2->unit &&
+         number1->value == number2->value;
+}
+
 static void
 gtk_css_value_dimension_free (GtkCssValue *value)
 {
+  if (interned_dimensions &&
+      g_hash_table_lookup (interned_dimensions, value) == value)
+    g_hash_table_remove (interned_dimensions, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -319,9 +348,31 @@ gtk_css_dimension_value_new (double     value,
       return _gtk_css_value_ref (&px_singletons[(int) value]);
     }
 
+  /* NaN can't be looked up again, and -0 would hash differently than 0 */
+  if (isnan (value))
+    {
+      result = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_DIMENSION.value_class);
+      result->unit = unit;
+      result->value = value;
+
+      return result;
+    }
+  if (value == 0)
+    value = 0;
+
+  if (interned_dimensions == NULL)
+    interned_dimensions = g_hash_table_new (gtk_css_value_dimension_hash,
+                                            gtk_css_value_dimension_intern_equal);
+
+  result = g_hash_table_lookup (interned_dimensions,
+                                &(GtkCssValue) { &GTK_CSS_VALUE_DIMENSION.value_class, 1, unit, value });
+  if (result)
+    return _gtk_css_value_ref (result);
+
   result = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_DIMENSION.value_class);
   result->unit = unit;
   result->value = value;
+  g_hash_table_add (interned_dimensions, result);
 
   return result;
 }
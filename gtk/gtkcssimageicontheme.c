@@ -95,23 +95,11 @@ gtk_css_image_icon_theme_snapshot (GtkCssImage *image,
 
   if (symbolic)
     {
-      graphene_matrix_t matrix;
-      graphene_vec4_t offset;
-      GdkRGBA fg = icon_theme->color;
-      GdkRGBA sc = icon_theme->success;
-      GdkRGBA wc = icon_theme->warning;
-      GdkRGBA ec = icon_theme->error;
-
-      graphene_matrix_init_from_float (&matrix,
-          (float[16]) {
-                       sc.red - fg.red, sc.green - fg.green, sc.blue - fg.blue, 0,
-                       wc.red - fg.red, wc.green - fg.green, wc.blue - fg.blue, 0,
-                       ec.red - fg.red, ec.green - fg.green, ec.blue - fg.blue, 0,
-                       0, 0, 0, fg.alpha
-                      });
-      graphene_vec4_init (&offset, fg.red, fg.green, fg.blue, 0);
-
-      gtk_snapshot_push_color_matrix (snapshot, &matrix, &offset);
+      gtk_icon_theme_push_symbolic_colors (snapshot,
+                                           &icon_theme->color,
+                                           &icon_theme->success,
+                                           &icon_theme->warning,
+                                           &icon_theme->error);
     }
 
   gtk_snapshot_append_texture (snapshot,
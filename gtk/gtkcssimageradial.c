@@ -70,6 +70,19 @@ gtk_css_image_radial_get_start_end (GtkCssImageRadial *radial,
     {
       *start = 0;
       *end = 1;
+
+      /* Stops beyond the ending shape extend the gradient */
+      for (i = 0; i < radial->stops->len; i++)
+        {
+          stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, i);
+
+          if (stop->offset == NULL)
+            continue;
+
+          pos = _gtk_css_number_value_get (stop->offset, radius) / radius;
+
+          *end = MAX (pos, *end);
+        }
     }
 }
 
@@ -80,18 +93,13 @@ gtk_css_image_radial_snapshot (GtkCssImage *image,
                                double       height)
 {
   GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
-  cairo_pattern_t *pattern;
-  cairo_matrix_t matrix;
+  GskColorStop *stops;
   double x, y;
-  double radius, yscale;
+  double radius, hradius, vradius;
   double start, end;
   double r1, r2, r3, r4, r;
   double offset;
   int i, last;
-  cairo_t *cr;
-
-  cr = gtk_snapshot_append_cairo (snapshot,
-                                  &GRAPHENE_RECT_INIT (0, 0, width, height));
 
   x = _gtk_css_position_value_get_x (radial->position, width);
   y = _gtk_css_position_value_get_y (radial->position, height);
@@ -126,12 +134,11 @@ gtk_css_image_radial_snapshot (GtkCssImage *image,
         }
 
       radius = MAX (1.0, radius);
-      yscale = 1.0;
+      hradius = radius;
+      vradius = radius;
     }
   else
     {
-      double hradius, vradius;
-
       switch (radial->size)
         {
         case GTK_CSS_EXPLICIT_SIZE:
@@ -162,25 +169,26 @@ gtk_css_image_radial_snapshot (GtkCssImage *image,
       vradius = MAX (1.0, vradius);
 
       radius = hradius;
-      yscale = vradius / hradius;
     }
 
   gtk_css_image_radial_get_start_end (radial, radius, &start, &end);
 
-  pattern = cairo_pattern_create_radial (0, 0, radius * start, 0, 0, radius * end);
-  if (yscale != 1.0)
+  if (start == end)
     {
-      cairo_matrix_init_scale (&matrix, 1.0, 1.0 / yscale);
-      cairo_pattern_set_matrix (pattern, &matrix);
+      /* repeating gradients with all color stops sharing the same offset
+       * get the color of the last color stop */
+      GtkCssImageRadialColorStop *stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, radial->stops->len - 1);
+
+      gtk_snapshot_append_color (snapshot,
+                                 _gtk_css_rgba_value_get_rgba (stop->color),
+                                 &GRAPHENE_RECT_INIT (0, 0, width, height));
+      return;
     }
 
- if (radial->repeating)
-    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_REPEAT);
-  else
-    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
-
   offset = start;
   last = -1;
+  stops = g_newa (GskColorStop, radial->stops->len);
+
   for (i = 0; i < radial->stops->len; i++)
     {
       GtkCssImageRadialColorStop *stop;
@@ -200,37 +208,55 @@ gtk_css_image_radial_snapshot (GtkCssImage *image,
       else
         pos = _gtk_css_number_value_get (stop->offset, radius) / radius;
 
-      pos = MAX (pos, 0);
+      pos = MAX (pos, offset);
       step = (pos - offset) / (i - last);
       for (last = last + 1; last <= i; last++)
         {
-          const GdkRGBA *rgba;
-
           stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, last);
 
-          rgba = _gtk_css_rgba_value_get_rgba (stop->color);
           offset += step;
 
-          cairo_pattern_add_color_stop_rgba (pattern,
-                                             (offset - start) / (end - start),
-                                             rgba->red,
-                                             rgba->green,
-                                             rgba->blue,
-                                             rgba->alpha);
+          stops[last].offset = CLAMP ((offset - start) / (end - start), 0.0, 1.0);
+          stops[last].color = *_gtk_css_rgba_value_get_rgba (stop->color);
         }
 
       offset = pos;
       last = i;
     }
 
-  cairo_rectangle (cr, 0, 0, width, height);
-  cairo_translate (cr, x, y);
-  cairo_set_source (cr, pattern);
-  cairo_fill (cr);
+  if (radial->repeating)
+    {
+      /* Nodes can't start before the center, but moving
+       * whole repetitions outwards draws the same */
+      if (start < 0)
+        {
+          double period = end - start;
+          double n = ceil (- start / period);
 
-  cairo_pattern_destroy (pattern);
+          start += n * period;
+          end += n * period;
+        }
 
-  cairo_destroy (cr);
+      gtk_snapshot_append_repeating_radial_gradient (snapshot,
+                                                     &GRAPHENE_RECT_INIT (0, 0, width, height),
+                                                     &GRAPHENE_POINT_INIT (x, y),
+                                                     hradius,
+                                                     vradius,
+                                                     start,
+                                                     end,
+                                                     stops,
+                                                     radial->stops->len);
+    }
+  else
+    gtk_snapshot_append_radial_gradient (snapshot,
+                                         &GRAPHENE_RECT_INIT (0, 0, width, height),
+                                         &GRAPHENE_POINT_INIT (x, y),
+                                         hradius,
+                                         vradius,
+                                         start,
+                                         end,
+                                         stops,
+                                         radial->stops->len);
 }
 
 static guint
@@ -174,25 +174,15 @@ gtk_css_image_recolor_snapshot (GtkCssImage *image,
                                 double       height)
 {
   GtkCssImageRecolor *recolor = GTK_CSS_IMAGE_RECOLOR (image);
-  graphene_matrix_t matrix;
-  graphene_vec4_t offset;
-  GdkRGBA fg = recolor->color;
-  GdkRGBA sc = recolor->success;
-  GdkRGBA wc = recolor->warning;
-  GdkRGBA ec = recolor->error;
 
   if (recolor->texture == NULL)
     return;
 
-  graphene_matrix_init_from_float (&matrix,
-          (float[16]) {
-                       sc.red - fg.red, sc.green - fg.green, sc.blue - fg.blue, 0,
-                       wc.red - fg.red, wc.green - fg.green, wc.blue - fg.blue, 0,
-                       ec.red - fg.red, ec.green - fg.green, ec.blue - fg.blue, 0,
-                       0, 0, 0, fg.alpha
-                      });
-  graphene_vec4_init (&offset, fg.red, fg.green, fg.blue, 0);
-  gtk_snapshot_push_color_matrix (snapshot, &matrix, &offset);
+  gtk_icon_theme_push_symbolic_colors (snapshot,
+                                       &recolor->color,
+                                       &recolor->success,
+                                       &recolor->warning,
+                                       &recolor->error);
 
   gtk_snapshot_append_texture (snapshot,
                                recolor->texture,
@@ -31,22 +31,64 @@
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
 
-static GtkCssImage *
-gtk_css_image_url_load_image (GtkCssImageUrl  *url,
-                              GError         **error)
+/* Decoded textures are shared by all url images in the process, so
+ * that an image used by multiple providers or windows, or by a theme
+ * that is reloaded, is only loaded once. The table doesn't own the
+ * textures, they remove themselves when they are finalized.
+ * It must only be used from the main thread. */
+static GHashTable *texture_cache = NULL;
+
+static void
+texture_cache_remove (gpointer  uri,
+                      GObject  *where_the_texture_was)
+{
+  g_hash_table_remove (texture_cache, uri);
+}
+
+static GdkTexture *
+texture_cache_lookup (const char *uri)
 {
   GdkTexture *texture;
-  GError *local_error = NULL;
 
-  if (url->loaded_image)
-    return url->loaded_image;
+  if (texture_cache == NULL)
+    return NULL;
+
+  texture = g_hash_table_lookup (texture_cache, uri);
+  if (texture)
+    g_object_ref (texture);
+
+  return texture;
+}
+
+static void
+texture_cache_insert (const char *uri,
+                      GdkTexture *texture)
+{
+  char *key;
+
+  if (texture_cache == NULL)
+    texture_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (g_hash_table_contains (texture_cache, uri))
+    return;
+
+  key = g_strdup (uri);
+  g_hash_table_insert (texture_cache, key, texture);
+  g_object_weak_ref (G_OBJECT (texture), texture_cache_remove, key);
+}
+
+static GdkTexture *
+load_texture (GFile   *file,
+              GError **error)
+{
+  GdkTexture *texture;
 
   /* We special case resources here so we can use
      gdk_pixbuf_new_from_resource, which in turn has some special casing
      for GdkPixdata files to avoid duplicating the memory for the pixbufs */
-  if (g_file_has_uri_scheme (url->file, "resource"))
+  if (g_file_has_uri_scheme (file, "resource"))
     {
-      char *uri = g_file_get_uri (url->file);
+      char *uri = g_file_get_uri (file);
       char *resource_path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
 
       texture = gdk_texture_new_from_resource (resource_path);
@@ -56,32 +98,159 @@ gtk_css_image_url_load_image (GtkCssImageUrl  *url,
     }
   else
     {
-      texture = gdk_texture_new_from_file (url->file, &local_error);
+      texture = gdk_texture_new_from_file (file, error);
+    }
+
+  return texture;
+}
+
+/* A load that is started in a thread when the image is first
+ * computed, so that reading and decoding the file happens while the
+ * rest of the style is computed and the widgets are laid out, instead
+ * of blocking the style computation. Images of rules that never match
+ * are never loaded. */
+struct _GtkCssImageUrlLoad
+{
+  gatomicrefcount ref_count;
+
+  GMutex mutex;
+  GCond cond;
+  gboolean done;
+
+  GFile *file;
+  GdkTexture *texture;
+  GError *error;
+};
+
+static void
+texture_load_unref (GtkCssImageUrlLoad *load)
+{
+  if (!g_atomic_ref_count_dec (&load->ref_count))
+    return;
+
+  g_mutex_clear (&load->mutex);
+  g_cond_clear (&load->cond);
+  g_object_unref (load->file);
+  g_clear_object (&load->texture);
+  g_clear_error (&load->error);
+  g_slice_free (GtkCssImageUrlLoad, load);
+}
+
+static void
+texture_load_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  GtkCssImageUrlLoad *load = task_data;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = load_texture (load->file, &error);
+
+  g_mutex_lock (&load->mutex);
+  load->texture = texture;
+  load->error = error;
+  load->done = TRUE;
+  g_cond_signal (&load->cond);
+  g_mutex_unlock (&load->mutex);
+}
+
+static GtkCssImageUrlLoad *
+texture_load_start (GFile *file)
+{
+  GtkCssImageUrlLoad *load;
+  GTask *task;
+
+  load = g_slice_new0 (GtkCssImageUrlLoad);
+  g_atomic_ref_count_init (&load->ref_count);
+  g_mutex_init (&load->mutex);
+  g_cond_init (&load->cond);
+  load->file = g_object_ref (file);
+
+  g_atomic_ref_count_inc (&load->ref_count);
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_task_data (task, load, (GDestroyNotify) texture_load_unref);
+  g_task_run_in_thread (task, texture_load_thread);
+  g_object_unref (task);
+
+  return load;
+}
+
+static gboolean
+texture_load_is_done (GtkCssImageUrlLoad *load)
+{
+  gboolean done;
+
+  g_mutex_lock (&load->mutex);
+  done = load->done;
+  g_mutex_unlock (&load->mutex);
+
+  return done;
+}
+
+static GdkTexture *
+texture_load_finish (GtkCssImageUrlLoad  *load,
+                     GError             **error)
+{
+  GdkTexture *texture;
+
+  g_mutex_lock (&load->mutex);
+  while (!load->done)
+    g_cond_wait (&load->cond, &load->mutex);
+
+  texture = g_steal_pointer (&load->texture);
+  if (load->error)
+    g_propagate_error (error, g_steal_pointer (&load->error));
+  g_mutex_unlock (&load->mutex);
+
+  return texture;
+}
+
+static GtkCssImage *
+gtk_css_image_url_load_image (GtkCssImageUrl  *url,
+                              GError         **error)
+{
+  GdkTexture *texture;
+  GError *local_error = NULL;
+  char *uri;
+
+  if (url->loaded_image)
+    return url->loaded_image;
+
+  uri = g_file_get_uri (url->file);
+
+  texture = texture_cache_lookup (uri);
+  if (texture == NULL)
+    {
+      if (url->load)
+        texture = texture_load_finish (url->load, &local_error);
+      else
+        texture = load_texture (url->file, &local_error);
     }
+  g_clear_pointer (&url->load, texture_load_unref);
 
   if (texture == NULL)
     {
       if (error)
         {
-          char *uri;
-
-          uri = g_file_get_uri (url->file);
           g_set_error (error,
                        GTK_CSS_PARSER_ERROR,
                        GTK_CSS_PARSER_ERROR_FAILED,
                        "Error loading image '%s': %s", uri, local_error->message);
-          g_free (uri);
        }
       
       url->loaded_image = gtk_css_image_invalid_new ();
     }
   else
     {
+      texture_cache_insert (uri, texture);
       url->loaded_image = gtk_css_image_paintable_new (GDK_PAINTABLE (texture), GDK_PAINTABLE (texture));
       g_object_unref (texture);
     }
 
   g_clear_error (&local_error);
+  g_free (uri);
 
   return url->loaded_image;
 }
@@ -132,6 +301,24 @@ gtk_css_image_url_compute (GtkCssImage      *image,
   GtkCssImage *copy;
   GError *error = NULL;
 
+  /* Resources are in memory already, only files are worth
+   * loading in the background. Until the load is done, the
+   * image is computed to itself and only waits for the load
+   * once it is measured or drawn. */
+  if (url->loaded_image == NULL && url->load == NULL &&
+      url->file && !g_file_has_uri_scheme (url->file, "resource"))
+    {
+      char *uri = g_file_get_uri (url->file);
+
+      if (texture_cache == NULL || !g_hash_table_contains (texture_cache, uri))
+        url->load = texture_load_start (url->file);
+
+      g_free (uri);
+    }
+
+  if (url->load && !texture_load_is_done (url->load))
+    return g_object_ref (image);
+
   copy = gtk_css_image_url_load_image (url, &error);
   if (error)
     {
@@ -230,6 +417,7 @@ gtk_css_image_url_dispose (GObject *object)
 
   g_clear_object (&url->file);
   g_clear_object (&url->loaded_image);
+  g_clear_pointer (&url->load, texture_load_unref);
 
   G_OBJECT_CLASS (_gtk_css_image_url_parent_class)->dispose (object);
 }
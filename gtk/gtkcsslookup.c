@@ -25,26 +25,20 @@
 #include "gtkprivate.h"
 
 void
-_gtk_css_lookup_init (GtkCssLookup     *lookup,
-                      const GtkBitmask *relevant)
+_gtk_css_lookup_init (GtkCssLookup            *lookup,
+                      const GtkCssPropertySet *relevant)
 {
   memset (lookup, 0, sizeof (*lookup));
 
   if (relevant)
-    {
-      lookup->missing = _gtk_bitmask_copy (relevant);
-    }
+    lookup->missing = *relevant;
   else
-    {
-      lookup->missing = _gtk_bitmask_new ();
-      lookup->missing = _gtk_bitmask_invert_range (lookup->missing, 0, GTK_CSS_PROPERTY_N_PROPERTIES);
-    }
+    gtk_css_property_set_init_all (&lookup->missing);
 }
 
 void
 _gtk_css_lookup_destroy (GtkCssLookup *lookup)
 {
-  _gtk_bitmask_free (lookup->missing);
 }
 
 gboolean
@@ -53,7 +47,7 @@ _gtk_css_lookup_is_missing (const GtkCssLookup *lookup,
 {
   gtk_internal_return_val_if_fail (lookup != NULL, FALSE);
 
-  return _gtk_bitmask_get (lookup->missing, id);
+  return gtk_css_property_set_get (&lookup->missing, id);
 }
 
 /**
@@ -76,49 +70,10 @@ _gtk_css_lookup_set (GtkCssLookup  *lookup,
                      GtkCssValue   *value)
 {
   gtk_internal_return_if_fail (lookup != NULL);
-  gtk_internal_return_if_fail (_gtk_bitmask_get (lookup->missing, id));
+  gtk_internal_return_if_fail (gtk_css_property_set_get (&lookup->missing, id));
   gtk_internal_return_if_fail (value != NULL);
 
-  lookup->missing = _gtk_bitmask_set (lookup->missing, id, FALSE);
+  gtk_css_property_set_remove (&lookup->missing, id);
   lookup->values[id].value = value;
   lookup->values[id].section = section;
 }
-
-/**
- * _gtk_css_lookup_resolve:
- * @lookup: the lookup
- * @context: the context the values are resolved for
- * @values: a new #GtkCssStyle to be filled with the new properties
- *
- * Resolves the current lookup into a styleproperties object. This is done
- * by converting from the “winning declaration” to the “computed value”.
- *
- * XXX: This bypasses the notion of “specified value”. If this ever becomes
- * an issue, go fix it.
- **/
-void
-_gtk_css_lookup_resolve (GtkCssLookup      *lookup,
-                         GtkStyleProvider  *provider,
-                         GtkCssStaticStyle *style,
-                         GtkCssStyle       *parent_style)
-{
-  guint i;
-
-  gtk_internal_return_if_fail (lookup != NULL);
-  gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
-  gtk_internal_return_if_fail (GTK_IS_CSS_STATIC_STYLE (style));
-  gtk_internal_return_if_fail (parent_style == NULL || GTK_IS_CSS_STYLE (parent_style));
-
-  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
-    {
-      if (lookup->values[i].value ||
-          _gtk_bitmask_get (lookup->missing, i))
-        gtk_css_static_style_compute_value (style,
-                                            provider,
-                                            parent_style,
-                                            i,
-                                            lookup->values[i].value,
-                                            lookup->values[i].section);
-      /* else not a relevant property */
-    }
-}
@@ -20,7 +20,7 @@
 
 #include <glib-object.h>
 
-#include "gtk/gtkbitmaskprivate.h"
+#include "gtk/gtkcsspropertysetprivate.h"
 #include "gtk/gtkcssstaticstyleprivate.h"
 
 #include "gtk/css/gtkcsssection.h"
@@ -36,30 +36,26 @@ typedef struct {
 } GtkCssLookupValue;
 
 struct _GtkCssLookup {
-  GtkBitmask        *missing;
+  GtkCssPropertySet  missing;
   GtkCssLookupValue  values[GTK_CSS_PROPERTY_N_PROPERTIES];
 };
 
 void                    _gtk_css_lookup_init                    (GtkCssLookup               *lookup,
-                                                                 const GtkBitmask           *relevant);
+                                                                 const GtkCssPropertySet    *relevant);
 void                    _gtk_css_lookup_destroy                 (GtkCssLookup               *lookup);
 
-static inline const GtkBitmask *_gtk_css_lookup_get_missing     (const GtkCssLookup         *lookup);
+static inline const GtkCssPropertySet *_gtk_css_lookup_get_missing (const GtkCssLookup      *lookup);
 gboolean                _gtk_css_lookup_is_missing              (const GtkCssLookup         *lookup,
                                                                  guint                       id);
 void                    _gtk_css_lookup_set                     (GtkCssLookup               *lookup,
                                                                  guint                       id,
                                                                  GtkCssSection              *section,
                                                                  GtkCssValue                *value);
-void                    _gtk_css_lookup_resolve                 (GtkCssLookup               *lookup,
-                                                                 GtkStyleProvider           *provider,
-                                                                 GtkCssStaticStyle          *style,
-                                                                 GtkCssStyle                *parent_style);
 
-static inline const GtkBitmask *
+static inline const GtkCssPropertySet *
 _gtk_css_lookup_get_missing (const GtkCssLookup *lookup)
 {
-  return lookup->missing;
+  return &lookup->missing;
 }
 
 
@@ -23,6 +23,12 @@
 #include "gtkcssnodeprivate.h"
 #include "gtkwidgetpath.h"
 
+static const GtkCssAncestorFilter *
+gtk_css_matcher_no_ancestor_filter (const GtkCssMatcher *matcher)
+{
+  return NULL;
+}
+
 /* GTK_CSS_MATCHER_WIDGET_PATH */
 
 static gboolean
@@ -166,6 +172,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_WIDGET_PATH = {
   gtk_css_matcher_widget_path_has_class,
   gtk_css_matcher_widget_path_has_id,
   gtk_css_matcher_widget_path_has_position,
+  gtk_css_matcher_no_ancestor_filter,
   FALSE
 };
 
@@ -211,16 +218,6 @@ get_previous_visible_sibling (GtkCssNode *node)
   return node;
 }
 
-static GtkCssNode *
-get_next_visible_sibling (GtkCssNode *node)
-{
-  do {
-    node = gtk_css_node_get_next_sibling (node);
-  } while (node && !gtk_css_node_get_visible (node));
-
-  return node;
-}
-
 static gboolean
 gtk_css_matcher_node_get_previous (GtkCssMatcher       *matcher,
                                    const GtkCssMatcher *next)
@@ -263,32 +260,19 @@ gtk_css_matcher_node_has_id (const GtkCssMatcher *matcher,
 }
 
 static gboolean
-gtk_css_matcher_node_nth_child (GtkCssNode *node,
-                                GtkCssNode *(* prev_node_func) (GtkCssNode *),
-                                int         a,
-                                int         b)
+gtk_css_matcher_node_has_position (const GtkCssMatcher *matcher,
+                                   gboolean             forward,
+                                   int                  a,
+                                   int                  b)
 {
-  int pos, x;
-
-  /* special-case the common "first-child" and "last-child" */
-  if (a == 0)
-    {
-      while (b > 0 && node != NULL)
-        {
-          b--;
-          node = prev_node_func (node);
-        }
-
-      return b == 0 && node == NULL;
-    }
-
-  /* count nodes */
-  for (pos = 0; node != NULL; pos++)
-    node = prev_node_func (node);
+  int x;
 
   /* solve pos = a * X + b
    * and return TRUE if X is integer >= 0 */
-  x = pos - b;
+  x = (int) gtk_css_node_get_position (matcher->node.node, forward) - b;
+
+  if (a == 0)
+    return x == 0;
 
   if (x % a)
     return FALSE;
@@ -296,16 +280,10 @@ gtk_css_matcher_node_nth_child (GtkCssNode *node,
   return x / a >= 0;
 }
 
-static gboolean
-gtk_css_matcher_node_has_position (const GtkCssMatcher *matcher,
-                                   gboolean             forward,
-                                   int                  a,
-                                   int                  b)
+static const GtkCssAncestorFilter *
+gtk_css_matcher_node_get_ancestor_filter (const GtkCssMatcher *matcher)
 {
-  return gtk_css_matcher_node_nth_child (matcher->node.node,
-                                         forward ? get_previous_visible_sibling 
-                                                 : get_next_visible_sibling,
-                                         a, b);
+  return gtk_css_node_get_ancestor_filter (matcher->node.node);
 }
 
 static const GtkCssMatcherClass GTK_CSS_MATCHER_NODE = {
@@ -316,6 +294,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_NODE = {
   gtk_css_matcher_node_has_class,
   gtk_css_matcher_node_has_id,
   gtk_css_matcher_node_has_position,
+  gtk_css_matcher_node_get_ancestor_filter,
   FALSE
 };
 
@@ -327,6 +306,12 @@ _gtk_css_matcher_node_init (GtkCssMatcher *matcher,
   matcher->node.node = node;
 }
 
+gboolean
+_gtk_css_matcher_is_node (const GtkCssMatcher *matcher)
+{
+  return matcher->klass == &GTK_CSS_MATCHER_NODE;
+}
+
 /* GTK_CSS_MATCHER_WIDGET_ANY */
 
 static gboolean
@@ -396,6 +381,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_ANY = {
   gtk_css_matcher_any_has_class,
   gtk_css_matcher_any_has_id,
   gtk_css_matcher_any_has_position,
+  gtk_css_matcher_no_ancestor_filter,
   TRUE
 };
 
@@ -489,6 +475,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_SUPERSET = {
   gtk_css_matcher_superset_has_class,
   gtk_css_matcher_superset_has_id,
   gtk_css_matcher_superset_has_position,
+  gtk_css_matcher_no_ancestor_filter,
   FALSE
 };
 
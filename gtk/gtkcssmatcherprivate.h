@@ -28,6 +28,17 @@ typedef struct _GtkCssMatcherNode GtkCssMatcherNode;
 typedef struct _GtkCssMatcherSuperset GtkCssMatcherSuperset;
 typedef struct _GtkCssMatcherWidgetPath GtkCssMatcherWidgetPath;
 typedef struct _GtkCssMatcherClass GtkCssMatcherClass;
+typedef struct _GtkCssAncestorFilter GtkCssAncestorFilter;
+
+/* A bloom filter of the names, ids and style classes of all ancestors
+ * of a node, see gtk_css_node_get_ancestor_filter(). If it says a name
+ * is not there, no ancestor has it, so descendant selectors requiring
+ * it can be rejected without walking the parent chain. */
+#define GTK_CSS_ANCESTOR_FILTER_BITS 512
+
+struct _GtkCssAncestorFilter {
+  guint32 bits[GTK_CSS_ANCESTOR_FILTER_BITS / 32];
+};
 
 struct _GtkCssMatcherClass {
   gboolean        (* get_parent)                  (GtkCssMatcher          *matcher,
@@ -46,6 +57,9 @@ struct _GtkCssMatcherClass {
                                                    gboolean               forward,
                                                    int                    a,
                                                    int                    b);
+  /* NULL if the ancestors aren't known well enough */
+  const GtkCssAncestorFilter *
+                  (* get_ancestor_filter)         (const GtkCssMatcher   *matcher);
   gboolean is_any;
 };
 
@@ -85,6 +99,50 @@ void              _gtk_css_matcher_superset_init  (GtkCssMatcher          *match
                                                    const GtkCssMatcher    *subset,
                                                    GtkCssChange            relevant);
 
+gboolean          _gtk_css_matcher_is_node        (const GtkCssMatcher    *matcher);
+
+/* The hashes are multiplicative, so their high bits are the good ones.
+ * Each entry sets 2 bits. */
+static inline guint32
+_gtk_css_ancestor_filter_hash_name (/*interned*/ const char *name)
+{
+  return (guint32) GPOINTER_TO_SIZE (name) * 2654435761u;
+}
+
+static inline guint32
+_gtk_css_ancestor_filter_hash_id (/*interned*/ const char *id)
+{
+  return ((guint32) GPOINTER_TO_SIZE (id) ^ 0x27d4eb2fu) * 2654435761u;
+}
+
+static inline guint32
+_gtk_css_ancestor_filter_hash_class (GQuark style_class)
+{
+  return ((guint32) style_class ^ 0x5bd1e995u) * 2654435761u;
+}
+
+static inline void
+_gtk_css_ancestor_filter_add (GtkCssAncestorFilter *filter,
+                              guint32               hash)
+{
+  guint a = hash >> 23;
+  guint b = (hash >> 14) & (GTK_CSS_ANCESTOR_FILTER_BITS - 1);
+
+  filter->bits[a / 32] |= 1u << (a % 32);
+  filter->bits[b / 32] |= 1u << (b % 32);
+}
+
+static inline gboolean
+_gtk_css_ancestor_filter_may_contain (const GtkCssAncestorFilter *filter,
+                                      guint32                     hash)
+{
+  guint a = hash >> 23;
+  guint b = (hash >> 14) & (GTK_CSS_ANCESTOR_FILTER_BITS - 1);
+
+  return (filter->bits[a / 32] & (1u << (a % 32))) &&
+         (filter->bits[b / 32] & (1u << (b % 32)));
+}
+
 
 static inline gboolean
 _gtk_css_matcher_get_parent (GtkCssMatcher       *matcher,
@@ -136,6 +194,12 @@ _gtk_css_matcher_has_position (const GtkCssMatcher *matcher,
   return matcher->klass->has_position (matcher, forward, a, b);
 }
 
+static inline const GtkCssAncestorFilter *
+_gtk_css_matcher_get_ancestor_filter (const GtkCssMatcher *matcher)
+{
+  return matcher->klass->get_ancestor_filter (matcher);
+}
+
 static inline gboolean
 _gtk_css_matcher_matches_any (const GtkCssMatcher *matcher)
 {
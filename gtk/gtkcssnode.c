@@ -24,8 +24,11 @@
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 #include "gtksettingsprivate.h"
+#include "gtkstyleproviderprivate.h"
 #include "gtktypebuiltins.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 /*
  * CSS nodes are the backbone of the GtkStyleContext implementation and
  * replace the role that GtkWidgetPath played in the past. A CSS node has
@@ -114,6 +117,42 @@ struct _GtkCssNodeStyleChange {
 static guint cssnode_signals[LAST_SIGNAL] = { 0 };
 static GParamSpec *cssnode_properties[NUM_PROPERTIES];
 
+static void gtk_css_node_invalidate_ancestor_filter (GtkCssNode *cssnode);
+
+/* Tracing of invalidations for the inspector, see gtk_css_node_set_trace_func() */
+static GtkCssNodeTraceFunc trace_func;
+static gpointer trace_data;
+static GArray *trace_events;
+static GtkCssNode *trace_source;
+
+static void
+gtk_css_node_trace (GtkCssNodeTraceKind  kind,
+                    GtkCssNode          *node,
+                    GtkCssNode          *source,
+                    GtkCssChange         change)
+{
+  GtkCssNodeTraceEvent event;
+
+  if (G_LIKELY (trace_events == NULL))
+    return;
+
+  event.kind = kind;
+  event.node = g_object_ref (node);
+  event.source = source ? g_object_ref (source) : NULL;
+  event.change = change;
+
+  g_array_append_val (trace_events, event);
+}
+
+static void
+trace_event_clear (gpointer data)
+{
+  GtkCssNodeTraceEvent *event = data;
+
+  g_object_unref (event->node);
+  g_clear_object (&event->source);
+}
+
 static GtkStyleProvider *
 gtk_css_node_get_style_provider_or_null (GtkCssNode *cssnode)
 {
@@ -129,7 +168,7 @@ gtk_css_node_set_invalid (GtkCssNode *node,
 
   node->invalid = invalid;
 
-  if (node->visible)
+  if (node->visible && !node->deferred)
     {
       if (node->parent)
         {
@@ -363,7 +402,12 @@ gtk_css_node_create_style (GtkCssNode *cssnode)
 
   style = lookup_in_global_parent_cache (cssnode, decl);
   if (style)
-    return g_object_ref (style);
+    {
+      gtk_css_node_trace (GTK_CSS_NODE_TRACE_LOOKUP, cssnode, NULL, 0);
+      return g_object_ref (style);
+    }
+
+  gtk_css_node_trace (GTK_CSS_NODE_TRACE_COMPUTE, cssnode, NULL, 0);
 
   parent = cssnode->parent ? cssnode->parent->style : NULL;
 
@@ -422,9 +466,14 @@ gtk_css_node_real_update_style (GtkCssNode   *cssnode,
     }
 
   if (gtk_css_style_needs_recreation (static_style, change))
-    new_static_style = gtk_css_node_create_style (cssnode);
+    {
+      new_static_style = gtk_css_node_create_style (cssnode);
+    }
   else
-    new_static_style = g_object_ref (static_style);
+    {
+      gtk_css_node_trace (GTK_CSS_NODE_TRACE_REUSE, cssnode, NULL, change);
+      new_static_style = g_object_ref (static_style);
+    }
 
   if (new_static_style != static_style || (change & GTK_CSS_CHANGE_ANIMATIONS))
     {
@@ -733,6 +782,30 @@ gtk_css_node_invalidate_style (GtkCssNode *cssnode)
     gtk_css_node_invalidate_style (cssnode->next_sibling);
 }
 
+/* Positions are only looked at by :nth-child() and :nth-last-child()
+ * selectors, and most themes have none of those, so don't invalidate
+ * all following siblings for nothing when a node is added or removed. */
+static GtkCssChange
+gtk_css_node_filter_nth_change (GtkCssNode   *cssnode,
+                                GtkCssChange  change)
+{
+  GtkCssChange theme_change;
+
+  if ((change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD)) == 0)
+    return change;
+
+  theme_change = gtk_style_provider_get_change_any (gtk_css_node_get_style_provider (cssnode));
+
+  if ((theme_change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_SIBLING_NTH_CHILD |
+                       GTK_CSS_CHANGE_PARENT_NTH_CHILD | GTK_CSS_CHANGE_PARENT_SIBLING_NTH_CHILD)) == 0)
+    change &= ~GTK_CSS_CHANGE_NTH_CHILD;
+  if ((theme_change & (GTK_CSS_CHANGE_NTH_LAST_CHILD | GTK_CSS_CHANGE_SIBLING_NTH_LAST_CHILD |
+                       GTK_CSS_CHANGE_PARENT_NTH_LAST_CHILD | GTK_CSS_CHANGE_PARENT_SIBLING_NTH_LAST_CHILD)) == 0)
+    change &= ~GTK_CSS_CHANGE_NTH_LAST_CHILD;
+
+  return change;
+}
+
 static void
 gtk_css_node_reposition (GtkCssNode *node,
                          GtkCssNode *new_parent,
@@ -750,9 +823,10 @@ gtk_css_node_reposition (GtkCssNode *node,
     {
       if (node->next_sibling)
         gtk_css_node_invalidate (node->next_sibling,
-                                 GTK_CSS_CHANGE_ANY_SIBLING
-                                 | GTK_CSS_CHANGE_NTH_CHILD
-                                 | (node->previous_sibling ? 0 : GTK_CSS_CHANGE_FIRST_CHILD));
+                                 gtk_css_node_filter_nth_change (node,
+                                                                 GTK_CSS_CHANGE_ANY_SIBLING
+                                                                 | GTK_CSS_CHANGE_NTH_CHILD
+                                                                 | (node->previous_sibling ? 0 : GTK_CSS_CHANGE_FIRST_CHILD)));
       else if (node->previous_sibling)
         gtk_css_node_invalidate (node->previous_sibling, GTK_CSS_CHANGE_LAST_CHILD);
     }
@@ -760,12 +834,16 @@ gtk_css_node_reposition (GtkCssNode *node,
   if (old_parent != NULL)
     {
       g_signal_emit (old_parent, cssnode_signals[NODE_REMOVED], 0, node, node->previous_sibling);
+      old_parent->child_indices_valid = FALSE;
       if (old_parent->first_child && node->visible)
-        gtk_css_node_invalidate (old_parent->first_child, GTK_CSS_CHANGE_NTH_LAST_CHILD);
+        gtk_css_node_invalidate (old_parent->first_child,
+                                 gtk_css_node_filter_nth_change (old_parent, GTK_CSS_CHANGE_NTH_LAST_CHILD));
     }
 
   if (old_parent != new_parent)
     {
+      gtk_css_node_invalidate_ancestor_filter (node);
+
       if (old_parent == NULL)
         {
           gtk_css_node_parent_will_be_set (node);
@@ -785,7 +863,7 @@ gtk_css_node_reposition (GtkCssNode *node,
 
           if (node->pending_changes)
             new_parent->needs_propagation = TRUE;
-          if (node->invalid && node->visible)
+          if (node->invalid && node->visible && !node->deferred)
             gtk_css_node_set_invalid (new_parent, TRUE);
         }
       else
@@ -797,8 +875,10 @@ gtk_css_node_reposition (GtkCssNode *node,
   if (new_parent)
     {
       g_signal_emit (new_parent, cssnode_signals[NODE_ADDED], 0, node, previous);
+      new_parent->child_indices_valid = FALSE;
       if (node->visible)
-        gtk_css_node_invalidate (new_parent->first_child, GTK_CSS_CHANGE_NTH_LAST_CHILD);
+        gtk_css_node_invalidate (new_parent->first_child,
+                                 gtk_css_node_filter_nth_change (new_parent, GTK_CSS_CHANGE_NTH_LAST_CHILD));
     }
 
   if (node->visible)
@@ -821,11 +901,13 @@ gtk_css_node_reposition (GtkCssNode *node,
         gtk_css_node_invalidate_style (node->next_sibling);
     }
 
-  gtk_css_node_invalidate (node, GTK_CSS_CHANGE_ANY_PARENT
-                                 | GTK_CSS_CHANGE_ANY_SIBLING
-                                 | GTK_CSS_CHANGE_NTH_CHILD
-                                 | (node->previous_sibling ? 0 : GTK_CSS_CHANGE_FIRST_CHILD)
-                                 | (node->next_sibling ? 0 : GTK_CSS_CHANGE_LAST_CHILD));
+  gtk_css_node_invalidate (node,
+                           gtk_css_node_filter_nth_change (node,
+                                                           GTK_CSS_CHANGE_ANY_PARENT
+                                                           | GTK_CSS_CHANGE_ANY_SIBLING
+                                                           | GTK_CSS_CHANGE_NTH_CHILD
+                                                           | (node->previous_sibling ? 0 : GTK_CSS_CHANGE_FIRST_CHILD)
+                                                           | (node->next_sibling ? 0 : GTK_CSS_CHANGE_LAST_CHILD)));
 
   g_object_unref (node);
 }
@@ -949,6 +1031,8 @@ gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
   if (!cssnode->needs_propagation && change == 0)
     return;
 
+  trace_source = cssnode;
+
   for (child = gtk_css_node_get_first_child (cssnode);
        child;
        child = gtk_css_node_get_next_sibling (child))
@@ -959,6 +1043,8 @@ gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
         change |= _gtk_css_change_for_sibling (child_change);
     }
 
+  trace_source = NULL;
+
   cssnode->needs_propagation = FALSE;
 }
 
@@ -1021,6 +1107,8 @@ gtk_css_node_get_style (GtkCssNode *cssnode)
   return cssnode->style;
 }
 
+static void gtk_css_node_invalidate_timestamp (GtkCssNode *cssnode);
+
 void
 gtk_css_node_set_visible (GtkCssNode *cssnode,
                           gboolean    visible)
@@ -1033,10 +1121,16 @@ gtk_css_node_set_visible (GtkCssNode *cssnode,
   cssnode->visible = visible;
   g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_VISIBLE]);
 
-  if (cssnode->invalid)
+  if (cssnode->parent)
+    cssnode->parent->child_indices_valid = FALSE;
+
+  if (cssnode->invalid && !cssnode->deferred)
     {
       if (cssnode->visible)
         {
+          /* Catch up with the ticks we skipped while hidden */
+          gtk_css_node_invalidate_timestamp (cssnode);
+
           if (cssnode->parent)
             gtk_css_node_set_invalid (cssnode->parent, TRUE);
           else
@@ -1051,7 +1145,9 @@ gtk_css_node_set_visible (GtkCssNode *cssnode,
 
   if (cssnode->next_sibling)
     {
-      gtk_css_node_invalidate (cssnode->next_sibling, GTK_CSS_CHANGE_ANY_SIBLING | GTK_CSS_CHANGE_NTH_CHILD);
+      gtk_css_node_invalidate (cssnode->next_sibling,
+                               gtk_css_node_filter_nth_change (cssnode,
+                                                               GTK_CSS_CHANGE_ANY_SIBLING | GTK_CSS_CHANGE_NTH_CHILD));
       if (gtk_css_node_is_first_child (cssnode))
         {
           for (iter = cssnode->next_sibling;
@@ -1078,7 +1174,8 @@ gtk_css_node_set_visible (GtkCssNode *cssnode,
                 break;
             }
         }
-      gtk_css_node_invalidate (cssnode->parent->first_child, GTK_CSS_CHANGE_NTH_LAST_CHILD);
+      gtk_css_node_invalidate (cssnode->parent->first_child,
+                               gtk_css_node_filter_nth_change (cssnode, GTK_CSS_CHANGE_NTH_LAST_CHILD));
     }
 }
 
@@ -1088,12 +1185,96 @@ gtk_css_node_get_visible (GtkCssNode *cssnode)
   return cssnode->visible;
 }
 
+/* Deferred nodes still match selectors like visible ones, but they and
+ * their children are left out of validation. Their styles are computed
+ * when somebody asks for them with gtk_css_node_get_style(), and style
+ * changes that happened in the meantime are applied when the node stops
+ * being deferred. Used for widgets that are not child-visible, like the
+ * hidden pages of a stack. */
+void
+gtk_css_node_set_deferred (GtkCssNode *cssnode,
+                           gboolean    deferred)
+{
+  deferred = !!deferred;
+
+  if (cssnode->deferred == deferred)
+    return;
+
+  cssnode->deferred = deferred;
+
+  if (cssnode->invalid && cssnode->visible)
+    {
+      if (!deferred)
+        {
+          gtk_css_node_invalidate_timestamp (cssnode);
+
+          if (cssnode->parent)
+            gtk_css_node_set_invalid (cssnode->parent, TRUE);
+          else
+            GTK_CSS_NODE_GET_CLASS (cssnode)->queue_validate (cssnode);
+        }
+      else
+        {
+          if (cssnode->parent == NULL)
+            GTK_CSS_NODE_GET_CLASS (cssnode)->dequeue_validate (cssnode);
+        }
+    }
+}
+
+gboolean
+gtk_css_node_get_deferred (GtkCssNode *cssnode)
+{
+  return cssnode->deferred;
+}
+
+static void
+gtk_css_node_update_child_indices (GtkCssNode *cssnode)
+{
+  GtkCssNode *child;
+  guint n_visible = 0;
+
+  for (child = cssnode->first_child; child; child = child->next_sibling)
+    {
+      child->sibling_index = n_visible;
+      if (child->visible)
+        n_visible++;
+    }
+
+  cssnode->n_visible_children = n_visible;
+  cssnode->child_indices_valid = TRUE;
+}
+
+/* Returns the 1-based position of @cssnode among its visible siblings,
+ * counted from the start if @forward is %TRUE and from the end otherwise.
+ * The node itself is counted even when it is not visible.
+ *
+ * The indices are renumbered lazily when children were added, removed
+ * or changed visibility, so this is O(1) for all but the first call. */
+guint
+gtk_css_node_get_position (GtkCssNode *cssnode,
+                           gboolean    forward)
+{
+  GtkCssNode *parent = cssnode->parent;
+
+  if (parent == NULL)
+    return 1;
+
+  if (!parent->child_indices_valid)
+    gtk_css_node_update_child_indices (parent);
+
+  if (forward)
+    return cssnode->sibling_index + 1;
+  else
+    return parent->n_visible_children - cssnode->sibling_index - (cssnode->visible ? 1 : 0) + 1;
+}
+
 void
 gtk_css_node_set_name (GtkCssNode              *cssnode,
                        /*interned*/ const char *name)
 {
   if (gtk_css_node_declaration_set_name (&cssnode->decl, name))
     {
+      gtk_css_node_invalidate_ancestor_filters (cssnode);
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_NAME);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_NAME]);
     }
@@ -1128,6 +1309,7 @@ gtk_css_node_set_id (GtkCssNode                *cssnode,
 {
   if (gtk_css_node_declaration_set_id (&cssnode->decl, id))
     {
+      gtk_css_node_invalidate_ancestor_filters (cssnode);
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_ID);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_ID]);
     }
@@ -1161,6 +1343,7 @@ gtk_css_node_clear_classes (GtkCssNode *cssnode)
 {
   if (gtk_css_node_declaration_clear_classes (&cssnode->decl))
     {
+      gtk_css_node_invalidate_ancestor_filters (cssnode);
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1212,6 +1395,7 @@ gtk_css_node_add_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_add_class (&cssnode->decl, style_class))
     {
+      gtk_css_node_invalidate_ancestor_filters (cssnode);
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1223,6 +1407,7 @@ gtk_css_node_remove_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_remove_class (&cssnode->decl, style_class))
     {
+      gtk_css_node_invalidate_ancestor_filters (cssnode);
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1251,9 +1436,16 @@ gtk_css_node_get_declaration (GtkCssNode *cssnode)
 void
 gtk_css_node_invalidate_style_provider (GtkCssNode *cssnode)
 {
+  GtkCssMatcher matcher;
   GtkCssNode *child;
 
-  gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
+  /* The cache may contain styles computed with the old rules, even
+   * if they don't affect this node. */
+  g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
+
+  if (!gtk_css_node_init_matcher (cssnode, &matcher) ||
+      gtk_style_provider_change_affects (&matcher))
+    gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
 
   for (child = cssnode->first_child;
        child;
@@ -1275,9 +1467,13 @@ gtk_css_node_invalidate_timestamp (GtkCssNode *cssnode)
   if (!gtk_css_style_is_static (cssnode->style))
     gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_TIMESTAMP);
 
+  /* Hidden and deferred nodes aren't validated, so there is no point
+   * in advancing their animations. They stay invalid, and the first
+   * tick after they are shown again picks them up. */
   for (child = cssnode->first_child; child; child = child->next_sibling)
     {
-      gtk_css_node_invalidate_timestamp (child);
+      if (child->visible && !child->deferred)
+        gtk_css_node_invalidate_timestamp (child);
     }
 }
 
@@ -1305,6 +1501,10 @@ gtk_css_node_invalidate (GtkCssNode   *cssnode,
   if (change == 0)
     return;
 
+  gtk_css_node_trace (GTK_CSS_NODE_TRACE_INVALIDATE, cssnode,
+                      trace_source && trace_source == cssnode->parent ? trace_source : NULL,
+                      change);
+
   cssnode->pending_changes |= change;
 
   GTK_CSS_NODE_GET_CLASS (cssnode)->invalidate (cssnode);
@@ -1336,19 +1536,48 @@ gtk_css_node_validate_internal (GtkCssNode *cssnode,
        child;
        child = gtk_css_node_get_next_sibling (child))
     {
-      if (child->visible)
+      if (child->visible && !child->deferred)
         gtk_css_node_validate_internal (child, timestamp);
     }
 }
 
+/* Validation has to happen on the main thread, one node after the other:
+ * - GtkCssValue refcounts are not atomic, and all styles share values.
+ * - The node style caches, the interned value groups of
+ *   GtkCssStaticStyle and the lazily computed ancestor filters are
+ *   modified while computing styles.
+ * - Computing a value may query GtkSettings or load images.
+ * - Setting the new style emits signals that widgets react to.
+ */
 void
 gtk_css_node_validate (GtkCssNode *cssnode)
 {
   gint64 timestamp;
+#ifdef G_ENABLE_DEBUG
+  gint64 before = gdk_profiler_is_running () ? g_get_monotonic_time () : 0;
+#endif
 
   timestamp = gtk_css_node_get_timestamp (cssnode);
 
   gtk_css_node_validate_internal (cssnode, timestamp);
+
+  if (trace_events != NULL && trace_events->len > 0)
+    {
+      GArray *events = trace_events;
+
+      /* Start a new trace first, the callback may cause invalidations */
+      trace_events = g_array_new (FALSE, FALSE, sizeof (GtkCssNodeTraceEvent));
+      g_array_set_clear_func (trace_events, trace_event_clear);
+
+      trace_func (cssnode, (const GtkCssNodeTraceEvent *) events->data, events->len, trace_data);
+
+      g_array_unref (events);
+    }
+
+#ifdef G_ENABLE_DEBUG
+  if (before != 0)
+    gdk_profiler_add_mark (before * 1000, (g_get_monotonic_time () - before) * 1000, "css validation", "");
+#endif
 }
 
 gboolean
@@ -1358,6 +1587,99 @@ gtk_css_node_init_matcher (GtkCssNode     *cssnode,
   return GTK_CSS_NODE_GET_CLASS (cssnode)->init_matcher (cssnode, matcher);
 }
 
+static void
+gtk_css_node_add_to_ancestor_filter (GtkCssNode           *cssnode,
+                                     GtkCssAncestorFilter *filter)
+{
+  const GQuark *classes;
+  const char *id;
+  guint i, n_classes;
+
+  _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_name (gtk_css_node_get_name (cssnode)));
+
+  id = gtk_css_node_get_id (cssnode);
+  if (id)
+    _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_id (id));
+
+  classes = gtk_css_node_declaration_get_classes (cssnode->decl, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_class (classes[i]));
+}
+
+/*
+ * gtk_css_node_get_ancestor_filter:
+ * @cssnode: a #GtkCssNode
+ *
+ * Gets a bloom filter of the names, ids and style classes of the
+ * nodes a matcher for @cssnode visits when walking up its parents.
+ * The filter is computed on demand and kept until an ancestor changes.
+ *
+ * Returns: the filter or %NULL if an ancestor doesn't match as a
+ *   node (e.g. because it matches via a widget path)
+ */
+const GtkCssAncestorFilter *
+gtk_css_node_get_ancestor_filter (GtkCssNode *cssnode)
+{
+  GtkCssMatcher matcher;
+  GtkCssNode *parent;
+
+  if (cssnode->ancestor_filter_valid)
+    return cssnode->ancestor_filter_unknown ? NULL : &cssnode->ancestor_filter;
+
+  parent = cssnode->parent;
+  cssnode->ancestor_filter = (GtkCssAncestorFilter) { { 0, } };
+  cssnode->ancestor_filter_unknown = FALSE;
+
+  if (parent != NULL)
+    {
+      /* Always validate the parent to keep the invariant */
+      const GtkCssAncestorFilter *parent_filter = gtk_css_node_get_ancestor_filter (parent);
+
+      if (!gtk_css_node_init_matcher (parent, &matcher))
+        {
+          /* Matching stops here, so the empty filter is right */
+        }
+      else if (!_gtk_css_matcher_is_node (&matcher) || parent_filter == NULL)
+        {
+          cssnode->ancestor_filter_unknown = TRUE;
+        }
+      else
+        {
+          cssnode->ancestor_filter = *parent_filter;
+          gtk_css_node_add_to_ancestor_filter (parent, &cssnode->ancestor_filter);
+        }
+    }
+
+  cssnode->ancestor_filter_valid = TRUE;
+
+  return cssnode->ancestor_filter_unknown ? NULL : &cssnode->ancestor_filter;
+}
+
+static void
+gtk_css_node_invalidate_ancestor_filter (GtkCssNode *cssnode)
+{
+  GtkCssNode *child;
+
+  if (!cssnode->ancestor_filter_valid)
+    return;
+
+  cssnode->ancestor_filter_valid = FALSE;
+
+  for (child = cssnode->first_child; child; child = child->next_sibling)
+    gtk_css_node_invalidate_ancestor_filter (child);
+}
+
+/* Call this when something about @cssnode changes that its descendants'
+ * ancestor filters depend on. */
+void
+gtk_css_node_invalidate_ancestor_filters (GtkCssNode *cssnode)
+{
+  GtkCssNode *child;
+
+  for (child = cssnode->first_child; child; child = child->next_sibling)
+    gtk_css_node_invalidate_ancestor_filter (child);
+}
+
 GtkWidgetPath *
 gtk_css_node_create_widget_path (GtkCssNode *cssnode)
 {
@@ -1419,3 +1741,33 @@ gtk_css_node_print (GtkCssNode                *cssnode,
         gtk_css_node_print (node, flags, string, indent + 2);
     }
 }
+
+/*
+ * gtk_css_node_set_trace_func:
+ * @func: (nullable): function to call after validating a node tree
+ * @user_data: data to pass to @func
+ *
+ * Starts or stops tracing invalidations. While a trace function is set,
+ * nodes record when they get invalidated and how they get their new
+ * style. The events are passed to @func after each validation of a
+ * root node, which normally happens once per frame.
+ *
+ * This is used by the inspector.
+ */
+void
+gtk_css_node_set_trace_func (GtkCssNodeTraceFunc func,
+                             gpointer            user_data)
+{
+  trace_func = func;
+  trace_data = user_data;
+
+  if (func == NULL)
+    {
+      g_clear_pointer (&trace_events, g_array_unref);
+    }
+  else if (trace_events == NULL)
+    {
+      trace_events = g_array_new (FALSE, FALSE, sizeof (GtkCssNodeTraceEvent));
+      g_array_set_clear_func (trace_events, trace_event_clear);
+    }
+}
@@ -18,6 +18,7 @@
 #ifndef __GTK_CSS_NODE_PRIVATE_H__
 #define __GTK_CSS_NODE_PRIVATE_H__
 
+#include "gtkcssmatcherprivate.h"
 #include "gtkcssnodedeclarationprivate.h"
 #include "gtkcssnodestylecacheprivate.h"
 #include "gtkcssstylechangeprivate.h"
@@ -36,6 +37,25 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssNodeClass         GtkCssNodeClass;
 
+typedef enum {
+  GTK_CSS_NODE_TRACE_INVALIDATE,        /* the node got invalidated with the change */
+  GTK_CSS_NODE_TRACE_COMPUTE,           /* a new static style was computed */
+  GTK_CSS_NODE_TRACE_LOOKUP,            /* a static style was found in a style cache */
+  GTK_CSS_NODE_TRACE_REUSE              /* the static style did not depend on the change */
+} GtkCssNodeTraceKind;
+
+typedef struct {
+  GtkCssNodeTraceKind kind;
+  GtkCssNode *node;
+  GtkCssNode *source;                   /* for INVALIDATE, the parent that propagated the change or %NULL */
+  GtkCssChange change;
+} GtkCssNodeTraceEvent;
+
+typedef void (* GtkCssNodeTraceFunc) (GtkCssNode                 *root,
+                                      const GtkCssNodeTraceEvent *events,
+                                      guint                       n_events,
+                                      gpointer                    user_data);
+
 struct _GtkCssNode
 {
   GObject object;
@@ -52,7 +72,13 @@ struct _GtkCssNode
 
   GtkCssChange           pending_changes;       /* changes that accumulated since the style was last computed */
 
+  GtkCssAncestorFilter   ancestor_filter;       /* see gtk_css_node_get_ancestor_filter() */
+
+  guint                  sibling_index;         /* number of visible previous siblings, valid if parent->child_indices_valid */
+  guint                  n_visible_children;    /* valid if child_indices_valid */
+
   guint                  visible :1;            /* node will be skipped when validating or computing styles */
+  guint                  deferred :1;           /* node is only validated when its style is asked for */
   guint                  invalid :1;            /* node or a child needs to be validated (even if just for animation) */
   guint                  needs_propagation :1;  /* children have state changes that need to be propagated to their siblings */
   /* Two invariants hold for this variable:
@@ -61,6 +87,10 @@ struct _GtkCssNode
    * So if a valid style is computed, one has to previously ensure that the parent's and the previous sibling's style
    * are valid. This allows both validation and invalidation to run in O(nodes-in-tree) */
   guint                  style_is_invalid :1;   /* the style needs to be recomputed */
+  /* valid == TRUE  =>  parent->ancestor_filter_valid == TRUE, so invalidation can stop at invalid nodes */
+  guint                  ancestor_filter_valid :1;
+  guint                  ancestor_filter_unknown :1; /* the matcher can't use the filter */
+  guint                  child_indices_valid :1; /* sibling_index of all children is up to date */
 };
 
 struct _GtkCssNodeClass
@@ -116,6 +146,11 @@ GtkCssNode *            gtk_css_node_get_next_sibling   (GtkCssNode            *
 void                    gtk_css_node_set_visible        (GtkCssNode            *cssnode,
                                                          gboolean               visible);
 gboolean                gtk_css_node_get_visible        (GtkCssNode            *cssnode) G_GNUC_PURE;
+void                    gtk_css_node_set_deferred       (GtkCssNode            *cssnode,
+                                                         gboolean               deferred);
+gboolean                gtk_css_node_get_deferred       (GtkCssNode            *cssnode) G_GNUC_PURE;
+guint                   gtk_css_node_get_position       (GtkCssNode            *cssnode,
+                                                         gboolean               forward);
 
 void                    gtk_css_node_set_name           (GtkCssNode            *cssnode,
                                                          /*interned*/const char*name);
@@ -157,6 +192,10 @@ void                    gtk_css_node_validate           (GtkCssNode            *
 
 gboolean                gtk_css_node_init_matcher       (GtkCssNode            *cssnode,
                                                          GtkCssMatcher         *matcher);
+const GtkCssAncestorFilter *
+                        gtk_css_node_get_ancestor_filter (GtkCssNode           *cssnode);
+void                    gtk_css_node_invalidate_ancestor_filters
+                                                        (GtkCssNode            *cssnode);
 GtkWidgetPath *         gtk_css_node_create_widget_path (GtkCssNode            *cssnode);
 const GtkWidgetPath *   gtk_css_node_get_widget_path    (GtkCssNode            *cssnode) G_GNUC_PURE;
 GtkStyleProvider *      gtk_css_node_get_style_provider (GtkCssNode            *cssnode) G_GNUC_PURE;
@@ -166,6 +205,9 @@ void                    gtk_css_node_print              (GtkCssNode
                                                          GString                   *string,
                                                          guint                      indent);
 
+void                    gtk_css_node_set_trace_func     (GtkCssNodeTraceFunc        func,
+                                                         gpointer                   user_data);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_NODE_PRIVATE_H__ */
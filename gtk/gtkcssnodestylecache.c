@@ -24,13 +24,24 @@
 
 struct _GtkCssNodeStyleCache {
   guint        ref_count;
+  guint        any_position : 1; /* this entry or one of its parents is shared between positions */
   GtkCssStyle *style;
   GHashTable  *children;
 };
 
-#define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x3))
-#define UNPACK_FLAGS(packed) (GPOINTER_TO_SIZE (packed) & 0x3)
+/* Styles that do not depend on :first-child or :last-child are stored
+ * with the ANY_POSITION flag instead of the actual position, so that
+ * all children with the same declaration share them, no matter where
+ * in the list of siblings they are. */
+#define ANY_POSITION 0x4
+
+#define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x7))
+#define UNPACK_FLAGS(packed) (GPOINTER_TO_SIZE (packed) & 0x7)
 #define PACK(decl, first_child, last_child) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (decl) | ((first_child) ? 0x2 : 0) | ((last_child) ? 0x1 : 0))
+#define PACK_ANY_POSITION(decl) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (decl) | ANY_POSITION)
+
+static guint n_lookups;
+static guint n_hits;
 
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_new (GtkCssStyle *style)
@@ -75,7 +86,8 @@ gtk_css_node_style_cache_get_style (GtkCssNodeStyleCache *cache)
 }
 
 static gboolean
-may_be_stored_in_cache (GtkCssStyle *style)
+may_be_stored_in_cache (GtkCssNodeStyleCache *parent,
+                        GtkCssStyle          *style)
 {
   GtkCssChange change;
 
@@ -108,9 +120,26 @@ may_be_stored_in_cache (GtkCssStyle *style)
   if (change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD))
     return FALSE;
 
+  /* If one of the parents is shared between different positions, the
+   * position of the parents is not known either.
+   */
+  if (parent->any_position && (change & GTK_CSS_CHANGE_PARENT_POSITION))
+    return FALSE;
+
   return TRUE;
 }
 
+static gboolean
+depends_on_position (GtkCssStyle *style)
+{
+  GtkCssChange change;
+
+  change = gtk_css_static_style_get_change (GTK_CSS_STATIC_STYLE (style));
+
+  /* Children might depend on our position, too */
+  return (change & (GTK_CSS_CHANGE_FIRST_CHILD | GTK_CSS_CHANGE_LAST_CHILD)) != 0;
+}
+
 static guint
 gtk_css_node_style_cache_decl_hash (gconstpointer item)
 {
@@ -135,6 +164,19 @@ gtk_css_node_style_cache_decl_free (gpointer item)
   gtk_css_node_declaration_unref (UNPACK_DECLARATION (item));
 }
 
+static GtkCssNodeStyleCache *
+gtk_css_node_style_cache_new_child (GtkCssNodeStyleCache *parent,
+                                    GtkCssStyle          *style,
+                                    gboolean              any_position)
+{
+  GtkCssNodeStyleCache *result;
+
+  result = gtk_css_node_style_cache_new (style);
+  result->any_position = parent->any_position || any_position;
+
+  return result;
+}
+
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                  GtkCssNodeDeclaration  *decl,
@@ -143,8 +185,10 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                  GtkCssStyle            *style)
 {
   GtkCssNodeStyleCache *result;
+  gboolean any_position;
+  gpointer key;
 
-  if (!may_be_stored_in_cache (style))
+  if (!may_be_stored_in_cache (parent, style))
     return NULL;
 
   if (parent->children == NULL)
@@ -153,10 +197,17 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                               gtk_css_node_style_cache_decl_free,
                                               (GDestroyNotify) gtk_css_node_style_cache_unref);
 
-  result = gtk_css_node_style_cache_new (style);
+  any_position = !depends_on_position (style);
+  gtk_css_node_declaration_ref (decl);
+  if (any_position)
+    key = PACK_ANY_POSITION (decl);
+  else
+    key = PACK (decl, is_first, is_last);
+
+  result = gtk_css_node_style_cache_new_child (parent, style, any_position);
 
   g_hash_table_insert (parent->children,
-                       PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
+                       key,
                        gtk_css_node_style_cache_ref (result));
 
   return result;
@@ -170,13 +221,35 @@ gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
 {
   GtkCssNodeStyleCache *result;
 
+  n_lookups++;
+
   if (parent->children == NULL)
     return NULL;
 
-  result = g_hash_table_lookup (parent->children, PACK (decl, is_first, is_last));
+  result = g_hash_table_lookup (parent->children, PACK_ANY_POSITION (decl));
+  if (result == NULL)
+    result = g_hash_table_lookup (parent->children, PACK (decl, is_first, is_last));
   if (result == NULL)
     return NULL;
 
+  n_hits++;
+
   return gtk_css_node_style_cache_ref (result);
 }
 
+/*
+ * gtk_css_node_style_cache_get_statistics:
+ * @lookups: (out): return location for the number of lookups
+ * @hits: (out): return location for the number of lookups that
+ *   found a shared style
+ *
+ * Queries how well style sharing works. This is used by the inspector.
+ */
+void
+gtk_css_node_style_cache_get_statistics (guint *lookups,
+                                         guint *hits)
+{
+  *lookups = n_lookups;
+  *hits = n_hits;
+}
+
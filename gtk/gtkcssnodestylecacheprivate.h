@@ -41,6 +41,9 @@ GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup         (GtkCssNodeStyle
                                                                  gboolean                     is_first,
                                                                  gboolean                     is_last);
 
+void                    gtk_css_node_style_cache_get_statistics (guint                  *lookups,
+                                                                 guint                  *hits);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_NODE_STYLE_CACHE_PRIVATE_H__ */
@@ -173,6 +173,7 @@ gtk_css_path_node_set_widget_path (GtkCssPathNode *node,
 
   node->path = path;
 
+  gtk_css_node_invalidate_ancestor_filters (GTK_CSS_NODE (node));
   gtk_css_node_invalidate (GTK_CSS_NODE (node), GTK_CSS_CHANGE_ANY);
 }
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2019 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_PROPERTY_SET_PRIVATE_H__
+#define __GTK_CSS_PROPERTY_SET_PRIVATE_H__
+
+#include <glib.h>
+
+#include "gtk/gtkcsstypesprivate.h"
+
+G_BEGIN_DECLS
+
+/* A set of style property ids. Unlike GtkBitmask, which has to grow
+ * to hold all properties, this has a fixed size, so it can live on the
+ * stack or inside other structs and never allocates. The loops have a
+ * constant trip count, which lets the compiler unroll and vectorize
+ * them. */
+
+#define GTK_CSS_PROPERTY_SET_N_WORDS ((GTK_CSS_PROPERTY_N_PROPERTIES + 63) / 64)
+
+typedef struct _GtkCssPropertySet GtkCssPropertySet;
+
+struct _GtkCssPropertySet {
+  guint64 words[GTK_CSS_PROPERTY_SET_N_WORDS];
+};
+
+static inline void
+gtk_css_property_set_init (GtkCssPropertySet *set)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] = 0;
+}
+
+static inline void
+gtk_css_property_set_init_all (GtkCssPropertySet *set)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] = G_MAXUINT64;
+
+  if (GTK_CSS_PROPERTY_N_PROPERTIES % 64)
+    set->words[GTK_CSS_PROPERTY_SET_N_WORDS - 1] = (G_GUINT64_CONSTANT (1) << (GTK_CSS_PROPERTY_N_PROPERTIES % 64)) - 1;
+}
+
+static inline gboolean
+gtk_css_property_set_get (const GtkCssPropertySet *set,
+                          guint                    id)
+{
+  return (set->words[id / 64] >> (id % 64)) & 1;
+}
+
+static inline void
+gtk_css_property_set_add (GtkCssPropertySet *set,
+                          guint              id)
+{
+  set->words[id / 64] |= G_GUINT64_CONSTANT (1) << (id % 64);
+}
+
+static inline void
+gtk_css_property_set_remove (GtkCssPropertySet *set,
+                             guint              id)
+{
+  set->words[id / 64] &= ~(G_GUINT64_CONSTANT (1) << (id % 64));
+}
+
+static inline gboolean
+gtk_css_property_set_is_empty (const GtkCssPropertySet *set)
+{
+  guint64 any = 0;
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    any |= set->words[i];
+
+  return any == 0;
+}
+
+static inline gboolean
+gtk_css_property_set_intersects (const GtkCssPropertySet *set,
+                                 const GtkCssPropertySet *other)
+{
+  guint64 any = 0;
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    any |= set->words[i] & other->words[i];
+
+  return any != 0;
+}
+
+static inline void
+gtk_css_property_set_union (GtkCssPropertySet       *set,
+                            const GtkCssPropertySet *other)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] |= other->words[i];
+}
+
+static inline void
+gtk_css_property_set_intersect (GtkCssPropertySet       *set,
+                                const GtkCssPropertySet *other)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] &= other->words[i];
+}
+
+static inline void
+gtk_css_property_set_subtract (GtkCssPropertySet       *set,
+                               const GtkCssPropertySet *other)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] &= ~other->words[i];
+}
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_PROPERTY_SET_PRIVATE_H__ */
@@ -75,6 +75,7 @@
 
 
 typedef struct GtkCssRuleset GtkCssRuleset;
+typedef struct _GtkCssStylesheet GtkCssStylesheet;
 typedef struct _GtkCssScanner GtkCssScanner;
 typedef struct _PropertyValue PropertyValue;
 typedef enum ParserScope ParserScope;
@@ -91,11 +92,33 @@ struct GtkCssRuleset
   GtkCssSelector *selector;
   GtkCssSelectorTree *selector_match;
   PropertyValue *styles;
-  GtkBitmask *set_styles;
+  GtkCssPropertySet set_styles;
   guint n_styles;
   guint owns_styles : 1;
 };
 
+/* Everything that was parsed from the CSS. Stylesheets loaded from files
+ * are shared between all providers that load the same file, as long as
+ * none of the files it was parsed from changed.
+ */
+struct _GtkCssStylesheet
+{
+  guint ref_count;
+
+  GHashTable *symbolic_colors;
+  GHashTable *keyframes;
+
+  GArray *rulesets;
+  GtkCssSelectorTree *tree;
+  GtkCssChange change;          /* all changes the selectors of tree can depend on */
+
+  GFile *file;                  /* key in shared_stylesheets or %NULL */
+  GPtrArray *source_files;      /* the files that were parsed */
+  GPtrArray *source_bytes;      /* ... and their contents */
+  guint had_errors : 1;
+  guint keep_sections : 1;
+};
+
 struct _GtkCssScanner
 {
   GtkCssProvider *provider;
@@ -108,11 +131,8 @@ struct _GtkCssProviderPrivate
 {
   GScanner *scanner;
 
-  GHashTable *symbolic_colors;
-  GHashTable *keyframes;
-
-  GArray *rulesets;
-  GtkCssSelectorTree *tree;
+  GtkCssStylesheet *stylesheet;
+  GtkCssStylesheet *old_stylesheet; /* while loading, to find what changed */
   GResource *resource;
   gchar *path;
 };
@@ -137,6 +157,7 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 GtkCssScanner  *scanner,
                                 GFile          *file,
                                 GBytes         *bytes);
+static void gtk_css_provider_emit_changed (GtkCssProvider *css_provider);
 
 G_DEFINE_TYPE_EXTENDED (GtkCssProvider, gtk_css_provider, G_TYPE_OBJECT, 0,
                         G_ADD_PRIVATE (GtkCssProvider)
@@ -229,8 +250,6 @@ gtk_css_ruleset_init_copy (GtkCssRuleset       *new,
   /* First copy takes over ownership */
   if (ruleset->owns_styles)
     ruleset->owns_styles = FALSE;
-  if (new->set_styles)
-    new->set_styles = _gtk_bitmask_copy (new->set_styles);
 }
 
 static void
@@ -249,8 +268,6 @@ gtk_css_ruleset_clear (GtkCssRuleset *ruleset)
         }
       g_free (ruleset->styles);
     }
-  if (ruleset->set_styles)
-    _gtk_bitmask_free (ruleset->set_styles);
   if (ruleset->selector)
     _gtk_css_selector_free (ruleset->selector);
 
@@ -267,12 +284,7 @@ gtk_css_ruleset_add (GtkCssRuleset       *ruleset,
 
   g_return_if_fail (ruleset->owns_styles || ruleset->n_styles == 0);
 
-  if (ruleset->set_styles == NULL)
-    ruleset->set_styles = _gtk_bitmask_new ();
-
-  ruleset->set_styles = _gtk_bitmask_set (ruleset->set_styles,
-                                          _gtk_css_style_property_get_id (property),
-                                          TRUE);
+  gtk_css_property_set_add (&ruleset->set_styles, _gtk_css_style_property_get_id (property));
 
   ruleset->owns_styles = TRUE;
 
@@ -316,6 +328,11 @@ gtk_css_style_provider_emit_error (GtkStyleProvider *provider,
                                    GtkCssSection    *section,
                                    const GError     *error)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (GTK_CSS_PROVIDER (provider));
+
+  /* Don't share stylesheets with errors, so every provider gets to see them */
+  priv->stylesheet->had_errors = TRUE;
+
   g_signal_emit (provider, css_provider_signals[PARSING_ERROR], 0, section, error);
 }
 
@@ -378,19 +395,163 @@ gtk_css_scanner_would_recurse (GtkCssScanner *scanner,
   return FALSE;
 }
 
+/* GFile => GtkCssStylesheet, doesn't hold a reference */
+static GHashTable *shared_stylesheets;
+
+static GtkCssStylesheet *
+gtk_css_stylesheet_new (void)
+{
+  GtkCssStylesheet *stylesheet;
+
+  stylesheet = g_slice_new0 (GtkCssStylesheet);
+  stylesheet->ref_count = 1;
+
+  stylesheet->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
+
+  stylesheet->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                       (GDestroyNotify) g_free,
+                                                       (GDestroyNotify) _gtk_css_value_unref);
+  stylesheet->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 (GDestroyNotify) g_free,
+                                                 (GDestroyNotify) _gtk_css_keyframes_unref);
+
+  stylesheet->source_files = g_ptr_array_new_with_free_func (g_object_unref);
+  stylesheet->source_bytes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+  stylesheet->keep_sections = gtk_keep_css_sections;
+
+  return stylesheet;
+}
+
+static GtkCssStylesheet *
+gtk_css_stylesheet_ref (GtkCssStylesheet *stylesheet)
+{
+  stylesheet->ref_count++;
+
+  return stylesheet;
+}
+
+static void
+gtk_css_stylesheet_unshare (GtkCssStylesheet *stylesheet)
+{
+  if (stylesheet->file == NULL)
+    return;
+
+  g_hash_table_remove (shared_stylesheets, stylesheet->file);
+  g_clear_object (&stylesheet->file);
+}
+
+static void
+gtk_css_stylesheet_unref (GtkCssStylesheet *stylesheet)
+{
+  guint i;
+
+  stylesheet->ref_count--;
+  if (stylesheet->ref_count > 0)
+    return;
+
+  gtk_css_stylesheet_unshare (stylesheet);
+
+  for (i = 0; i < stylesheet->rulesets->len; i++)
+    gtk_css_ruleset_clear (&g_array_index (stylesheet->rulesets, GtkCssRuleset, i));
+
+  g_array_free (stylesheet->rulesets, TRUE);
+  _gtk_css_selector_tree_free (stylesheet->tree);
+
+  g_hash_table_destroy (stylesheet->symbolic_colors);
+  g_hash_table_destroy (stylesheet->keyframes);
+
+  g_ptr_array_unref (stylesheet->source_files);
+  g_ptr_array_unref (stylesheet->source_bytes);
+
+  g_slice_free (GtkCssStylesheet, stylesheet);
+}
+
+static void
+gtk_css_stylesheet_add_source (GtkCssStylesheet *stylesheet,
+                               GFile            *file,
+                               GBytes           *bytes)
+{
+  g_ptr_array_add (stylesheet->source_files, g_object_ref (file));
+  g_ptr_array_add (stylesheet->source_bytes, g_bytes_ref (bytes));
+}
+
+static gboolean
+gtk_css_stylesheet_is_up_to_date (GtkCssStylesheet *stylesheet)
+{
+  guint i;
+
+  if (stylesheet->keep_sections != gtk_keep_css_sections)
+    return FALSE;
+
+  for (i = 0; i < stylesheet->source_files->len; i++)
+    {
+      GBytes *bytes;
+      gboolean equal;
+
+      bytes = g_file_load_bytes (g_ptr_array_index (stylesheet->source_files, i), NULL, NULL, NULL);
+      if (bytes == NULL)
+        return FALSE;
+
+      equal = g_bytes_equal (bytes, g_ptr_array_index (stylesheet->source_bytes, i));
+      g_bytes_unref (bytes);
+
+      if (!equal)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Returns a reference to a stylesheet that was parsed from @file
+ * before and is still up to date, or %NULL */
+static GtkCssStylesheet *
+gtk_css_stylesheet_lookup_shared (GFile *file)
+{
+  GtkCssStylesheet *stylesheet;
+
+  if (shared_stylesheets == NULL)
+    return NULL;
+
+  stylesheet = g_hash_table_lookup (shared_stylesheets, file);
+  if (stylesheet == NULL)
+    return NULL;
+
+  if (!gtk_css_stylesheet_is_up_to_date (stylesheet))
+    {
+      gtk_css_stylesheet_unshare (stylesheet);
+      return NULL;
+    }
+
+  return gtk_css_stylesheet_ref (stylesheet);
+}
+
+static void
+gtk_css_stylesheet_share (GtkCssStylesheet *stylesheet,
+                          GFile            *file)
+{
+  GtkCssStylesheet *old;
+
+  if (stylesheet->had_errors ||
+      stylesheet->source_files->len == 0)
+    return;
+
+  if (shared_stylesheets == NULL)
+    shared_stylesheets = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
+  old = g_hash_table_lookup (shared_stylesheets, file);
+  if (old)
+    gtk_css_stylesheet_unshare (old);
+
+  stylesheet->file = g_object_ref (file);
+  g_hash_table_insert (shared_stylesheets, stylesheet->file, stylesheet);
+}
+
 static void
 gtk_css_provider_init (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  priv->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
-
-  priv->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                 (GDestroyNotify) g_free,
-                                                 (GDestroyNotify) _gtk_css_value_unref);
-  priv->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                           (GDestroyNotify) g_free,
-                                           (GDestroyNotify) _gtk_css_keyframes_unref);
+  priv->stylesheet = gtk_css_stylesheet_new ();
 }
 
 static void
@@ -404,11 +565,11 @@ verify_tree_match_results (GtkCssProvider *provider,
   gboolean should_match;
   int i, j;
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       gboolean found = FALSE;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       for (j = 0; j < tree_rules->len; j++)
 	{
@@ -442,7 +603,7 @@ verify_tree_get_change_results (GtkCssProvider *provider,
     GPtrArray *tree_rules;
     int i;
 
-    tree_rules = _gtk_css_selector_tree_match_all (priv->tree, matcher);
+    tree_rules = _gtk_css_selector_tree_match_all (priv->stylesheet->tree, matcher);
     if (tree_rules)
       {
         verify_tree_match_results (provider, matcher, tree_rules);
@@ -493,7 +654,7 @@ gtk_css_style_provider_get_color (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->symbolic_colors, name);
+  return g_hash_table_lookup (priv->stylesheet->symbolic_colors, name);
 }
 
 static GtkCssKeyframes *
@@ -503,7 +664,7 @@ gtk_css_style_provider_get_keyframes (GtkStyleProvider *provider,
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
 
-  return g_hash_table_lookup (priv->keyframes, name);
+  return g_hash_table_lookup (priv->stylesheet->keyframes, name);
 }
 
 static void
@@ -519,7 +680,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
   int i;
   GPtrArray *tree_rules;
 
-  tree_rules = _gtk_css_selector_tree_match_all (priv->tree, matcher);
+  tree_rules = _gtk_css_selector_tree_match_all (priv->stylesheet->tree, matcher);
   if (tree_rules)
     {
       verify_tree_match_results (css_provider, matcher, tree_rules);
@@ -531,8 +692,8 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
           if (ruleset->styles == NULL)
             continue;
 
-          if (!_gtk_bitmask_intersects (_gtk_css_lookup_get_missing (lookup),
-                                        ruleset->set_styles))
+          if (!gtk_css_property_set_intersects (_gtk_css_lookup_get_missing (lookup),
+                                                &ruleset->set_styles))
           continue;
 
           for (j = 0; j < ruleset->n_styles; j++)
@@ -549,7 +710,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
                                   ruleset->styles[j].value);
             }
 
-          if (_gtk_bitmask_is_empty (_gtk_css_lookup_get_missing (lookup)))
+          if (gtk_css_property_set_is_empty (_gtk_css_lookup_get_missing (lookup)))
             break;
         }
 
@@ -562,17 +723,27 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
 
       _gtk_css_matcher_superset_init (&change_matcher, matcher, GTK_CSS_CHANGE_NAME | GTK_CSS_CHANGE_CLASS);
 
-      *change = _gtk_css_selector_tree_get_change_all (priv->tree, &change_matcher);
+      *change = _gtk_css_selector_tree_get_change_all (priv->stylesheet->tree, &change_matcher);
       verify_tree_get_change_results (css_provider, &change_matcher, *change);
     }
 }
 
+static GtkCssChange
+gtk_css_style_provider_get_change_any (GtkStyleProvider *provider)
+{
+  GtkCssProvider *css_provider = GTK_CSS_PROVIDER (provider);
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+
+  return priv->stylesheet->change;
+}
+
 static void
 gtk_css_style_provider_iface_init (GtkStyleProviderInterface *iface)
 {
   iface->get_color = gtk_css_style_provider_get_color;
   iface->get_keyframes = gtk_css_style_provider_get_keyframes;
   iface->lookup = gtk_css_style_provider_lookup;
+  iface->get_change_any = gtk_css_style_provider_get_change_any;
   iface->emit_error = gtk_css_style_provider_emit_error;
 }
 
@@ -581,16 +752,9 @@ gtk_css_provider_finalize (GObject *object)
 {
   GtkCssProvider *css_provider = GTK_CSS_PROVIDER (object);
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
 
-  g_array_free (priv->rulesets, TRUE);
-  _gtk_css_selector_tree_free (priv->tree);
-
-  g_hash_table_destroy (priv->symbolic_colors);
-  g_hash_table_destroy (priv->keyframes);
+  gtk_css_stylesheet_unref (priv->stylesheet);
+  g_clear_pointer (&priv->old_stylesheet, gtk_css_stylesheet_unref);
 
   if (priv->resource)
     {
@@ -631,7 +795,7 @@ css_provider_commit (GtkCssProvider *css_provider,
 
       gtk_css_ruleset_init_copy (&new, ruleset, l->data);
 
-      g_array_append_val (priv->rulesets, new);
+      g_array_append_val (priv->stylesheet->rulesets, new);
     }
 
   g_slist_free (selectors);
@@ -641,7 +805,6 @@ static void
 gtk_css_provider_reset (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
-  guint i;
 
   if (priv->resource)
     {
@@ -656,14 +819,13 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
       priv->path = NULL;
     }
 
-  g_hash_table_remove_all (priv->symbolic_colors);
-  g_hash_table_remove_all (priv->keyframes);
-
-  for (i = 0; i < priv->rulesets->len; i++)
-    gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
-  g_array_set_size (priv->rulesets, 0);
-  _gtk_css_selector_tree_free (priv->tree);
-  priv->tree = NULL;
+  /* Keep the first stylesheet if we are reset multiple
+   * times before the next change notification */
+  if (priv->old_stylesheet == NULL)
+    priv->old_stylesheet = priv->stylesheet;
+  else
+    gtk_css_stylesheet_unref (priv->stylesheet);
+  priv->stylesheet = gtk_css_stylesheet_new ();
 }
 
 static gboolean
@@ -767,7 +929,7 @@ parse_color_definition (GtkCssScanner *scanner)
       return TRUE;
     }
 
-  g_hash_table_insert (priv->symbolic_colors, name, color);
+  g_hash_table_insert (priv->stylesheet->symbolic_colors, name, color);
 
   return TRUE;
 }
@@ -796,7 +958,7 @@ parse_keyframes (GtkCssScanner *scanner)
 
   keyframes = _gtk_css_keyframes_parse (scanner->parser);
   if (keyframes != NULL)
-    g_hash_table_insert (priv->keyframes, name, keyframes);
+    g_hash_table_insert (priv->stylesheet->keyframes, name, keyframes);
 
   if (!gtk_css_parser_has_token (scanner->parser, GTK_CSS_TOKEN_EOF))
     gtk_css_parser_error_syntax (scanner->parser, "Expected '}' after declarations");
@@ -1030,14 +1192,14 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
   GtkCssSelectorTreeBuilder *builder;
   guint i;
 
-  g_array_sort (priv->rulesets, gtk_css_provider_compare_rule);
+  g_array_sort (priv->stylesheet->rulesets, gtk_css_provider_compare_rule);
 
   builder = _gtk_css_selector_tree_builder_new ();
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       GtkCssRuleset *ruleset;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       _gtk_css_selector_tree_builder_add (builder,
 					  ruleset->selector,
@@ -1045,15 +1207,16 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 					  ruleset);
     }
 
-  priv->tree = _gtk_css_selector_tree_builder_build (builder);
+  priv->stylesheet->tree = _gtk_css_selector_tree_builder_build (builder);
+  priv->stylesheet->change = _gtk_css_selector_tree_get_change_any (priv->stylesheet->tree);
   _gtk_css_selector_tree_builder_free (builder);
 
 #ifndef VERIFY_TREE
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       GtkCssRuleset *ruleset;
 
-      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      ruleset = &g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i);
 
       _gtk_css_selector_free (ruleset->selector);
       ruleset->selector = NULL;
@@ -1067,13 +1230,17 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
                                 GFile          *file,
                                 GBytes         *bytes)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
+
   if (bytes == NULL)
     {
       GError *load_error = NULL;
 
       bytes = g_file_load_bytes (file, NULL, NULL, &load_error);
 
-      if (bytes == NULL)
+      if (bytes)
+        gtk_css_stylesheet_add_source (priv->stylesheet, file, bytes);
+      else
         {
           if (parent == NULL)
             {
@@ -1145,7 +1312,7 @@ gtk_css_provider_load_from_data (GtkCssProvider  *css_provider,
 
   g_bytes_unref (bytes);
 
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_emit_changed (css_provider);
 }
 
 /**
@@ -1160,14 +1327,27 @@ void
 gtk_css_provider_load_from_file (GtkCssProvider  *css_provider,
                                  GFile           *file)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GtkCssStylesheet *shared;
+
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (G_IS_FILE (file));
 
   gtk_css_provider_reset (css_provider);
 
-  gtk_css_provider_load_internal (css_provider, NULL, file, NULL);
+  shared = gtk_css_stylesheet_lookup_shared (file);
+  if (shared)
+    {
+      gtk_css_stylesheet_unref (priv->stylesheet);
+      priv->stylesheet = shared;
+    }
+  else
+    {
+      gtk_css_provider_load_internal (css_provider, NULL, file, NULL);
+      gtk_css_stylesheet_share (priv->stylesheet, file);
+    }
 
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_emit_changed (css_provider);
 }
 
 /**
@@ -1525,6 +1705,195 @@ gtk_css_provider_print_keyframes (GHashTable *keyframes,
   g_list_free (keys);
 }
 
+typedef struct {
+  GtkCssStylesheet *old_stylesheet;
+  GtkCssStylesheet *new_stylesheet;
+  GHashTable *changed_rulesets;
+} ChangedRulesets;
+
+static gboolean
+gtk_css_stylesheet_matches_changed (GtkCssStylesheet    *stylesheet,
+                                    const GtkCssMatcher *matcher,
+                                    GHashTable          *changed_rulesets)
+{
+  GPtrArray *tree_rules;
+  gboolean result = FALSE;
+  guint i;
+
+  /* Use the same rules the node takes its change flags from, so
+   * nodes that only match up to a combinator get new flags, too. */
+  tree_rules = _gtk_css_selector_tree_match_rightmost (stylesheet->tree, matcher);
+  if (tree_rules == NULL)
+    return FALSE;
+
+  for (i = 0; i < tree_rules->len; i++)
+    {
+      if (g_hash_table_contains (changed_rulesets, g_ptr_array_index (tree_rules, i)))
+        {
+          result = TRUE;
+          break;
+        }
+    }
+
+  g_ptr_array_free (tree_rules, TRUE);
+
+  return result;
+}
+
+static gboolean
+changed_rulesets_affect (const GtkCssMatcher *matcher,
+                         gpointer             user_data)
+{
+  ChangedRulesets *changed = user_data;
+  GtkCssMatcher superset;
+
+  /* Match independent of the state, so the node also gets a new style
+   * if a changed rule would match it after a state change. */
+  _gtk_css_matcher_superset_init (&superset, matcher, GTK_CSS_CHANGE_NAME | GTK_CSS_CHANGE_CLASS);
+
+  return gtk_css_stylesheet_matches_changed (changed->old_stylesheet, &superset, changed->changed_rulesets) ||
+         gtk_css_stylesheet_matches_changed (changed->new_stylesheet, &superset, changed->changed_rulesets);
+}
+
+static char *
+gtk_css_stylesheet_print_definitions (GtkCssStylesheet *stylesheet)
+{
+  GString *str = g_string_new ("");
+
+  gtk_css_provider_print_colors (stylesheet->symbolic_colors, str);
+  gtk_css_provider_print_keyframes (stylesheet->keyframes, str);
+
+  return g_string_free (str, FALSE);
+}
+
+/* Returns the printed form of every ruleset, in order */
+static GPtrArray *
+gtk_css_stylesheet_print_rulesets (GtkCssStylesheet *stylesheet)
+{
+  GPtrArray *result;
+  guint i;
+
+  result = g_ptr_array_new_full (stylesheet->rulesets->len, g_free);
+
+  for (i = 0; i < stylesheet->rulesets->len; i++)
+    {
+      GString *str = g_string_new ("");
+
+      gtk_css_ruleset_print (&g_array_index (stylesheet->rulesets, GtkCssRuleset, i), str);
+      g_ptr_array_add (result, g_string_free (str, FALSE));
+    }
+
+  return result;
+}
+
+/* Collects the rulesets that are only in one of the stylesheets into
+ * @changed_rulesets. Returns %FALSE if the changes can't be described
+ * that way, and all styles need to be recomputed. */
+static gboolean
+gtk_css_stylesheet_diff (GtkCssStylesheet *old_stylesheet,
+                         GtkCssStylesheet *new_stylesheet,
+                         GHashTable       *changed_rulesets)
+{
+  GPtrArray *old_rules, *new_rules;
+  GHashTable *old_set, *new_set;
+  char *old_defs, *new_defs;
+  gboolean result;
+  guint i, j;
+
+  /* Styles need to know where their values are defined */
+  if (old_stylesheet->keep_sections != new_stylesheet->keep_sections)
+    return FALSE;
+
+  /* Colors and keyframes may be referenced from anywhere */
+  old_defs = gtk_css_stylesheet_print_definitions (old_stylesheet);
+  new_defs = gtk_css_stylesheet_print_definitions (new_stylesheet);
+  result = g_str_equal (old_defs, new_defs);
+  g_free (old_defs);
+  g_free (new_defs);
+  if (!result)
+    return FALSE;
+
+  old_rules = gtk_css_stylesheet_print_rulesets (old_stylesheet);
+  new_rules = gtk_css_stylesheet_print_rulesets (new_stylesheet);
+  old_set = g_hash_table_new (g_str_hash, g_str_equal);
+  new_set = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < old_rules->len; i++)
+    g_hash_table_add (old_set, g_ptr_array_index (old_rules, i));
+  for (i = 0; i < new_rules->len; i++)
+    g_hash_table_add (new_set, g_ptr_array_index (new_rules, i));
+
+  for (i = 0; i < old_rules->len; i++)
+    {
+      if (!g_hash_table_contains (new_set, g_ptr_array_index (old_rules, i)))
+        g_hash_table_add (changed_rulesets, &g_array_index (old_stylesheet->rulesets, GtkCssRuleset, i));
+    }
+  for (i = 0; i < new_rules->len; i++)
+    {
+      if (!g_hash_table_contains (old_set, g_ptr_array_index (new_rules, i)))
+        g_hash_table_add (changed_rulesets, &g_array_index (new_stylesheet->rulesets, GtkCssRuleset, i));
+    }
+
+  /* Rulesets that exist in both must keep their order, because
+   * it decides which of them wins. */
+  i = j = 0;
+  while (result)
+    {
+      while (i < old_rules->len && !g_hash_table_contains (new_set, g_ptr_array_index (old_rules, i)))
+        i++;
+      while (j < new_rules->len && !g_hash_table_contains (old_set, g_ptr_array_index (new_rules, j)))
+        j++;
+
+      if (i == old_rules->len || j == new_rules->len)
+        {
+          result = i == old_rules->len && j == new_rules->len;
+          break;
+        }
+
+      result = g_str_equal (g_ptr_array_index (old_rules, i), g_ptr_array_index (new_rules, j));
+      i++;
+      j++;
+    }
+
+  g_hash_table_unref (old_set);
+  g_hash_table_unref (new_set);
+  g_ptr_array_unref (old_rules);
+  g_ptr_array_unref (new_rules);
+
+  return result;
+}
+
+/* Notifies about the change from priv->old_stylesheet to the current
+ * stylesheet. If only some of the rulesets changed, only the styles
+ * of nodes that match those rulesets are recomputed.
+ */
+static void
+gtk_css_provider_emit_changed (GtkCssProvider *css_provider)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  ChangedRulesets changed;
+
+  if (priv->old_stylesheet == NULL)
+    {
+      gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+      return;
+    }
+
+  changed.old_stylesheet = priv->old_stylesheet;
+  changed.new_stylesheet = priv->stylesheet;
+  changed.changed_rulesets = g_hash_table_new (NULL, NULL);
+
+  if (gtk_css_stylesheet_diff (changed.old_stylesheet, changed.new_stylesheet, changed.changed_rulesets))
+    gtk_style_provider_changed_partially (GTK_STYLE_PROVIDER (css_provider),
+                                          changed_rulesets_affect,
+                                          &changed);
+  else
+    gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+
+  g_hash_table_unref (changed.changed_rulesets);
+  g_clear_pointer (&priv->old_stylesheet, gtk_css_stylesheet_unref);
+}
+
 /**
  * gtk_css_provider_to_string:
  * @provider: the provider to write to a string
@@ -1550,14 +1919,14 @@ gtk_css_provider_to_string (GtkCssProvider *provider)
 
   str = g_string_new ("");
 
-  gtk_css_provider_print_colors (priv->symbolic_colors, str);
-  gtk_css_provider_print_keyframes (priv->keyframes, str);
+  gtk_css_provider_print_colors (priv->stylesheet->symbolic_colors, str);
+  gtk_css_provider_print_keyframes (priv->stylesheet->keyframes, str);
 
-  for (i = 0; i < priv->rulesets->len; i++)
+  for (i = 0; i < priv->stylesheet->rulesets->len; i++)
     {
       if (str->len != 0)
         g_string_append (str, "\n");
-      gtk_css_ruleset_print (&g_array_index (priv->rulesets, GtkCssRuleset, i), str);
+      gtk_css_ruleset_print (&g_array_index (priv->stylesheet->rulesets, GtkCssRuleset, i), str);
     }
 
   return g_string_free (str, FALSE);
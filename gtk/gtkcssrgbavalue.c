@@ -27,9 +27,34 @@ struct _GtkCssValue {
   GdkRGBA rgba;
 };
 
+/* Like dimensions, equal colors share one instance */
+static GHashTable *interned_rgbas;
+
+static guint
+gtk_css_value_rgba_hash (gconstpointer data)
+{
+  const GtkCssValue *rgba = data;
+
+  return gdk_rgba_hash (&rgba->rgba);
+}
+
+static gboolean
+gtk_css_value_rgba_intern_equal (gconstpointer data1,
+                                 gconstpointer data2)
+{
+  const GtkCssValue *rgba1 = data1;
+  const GtkCssValue *rgba2 = data2;
+
+  return gdk_rgba_equal (&rgba1->rgba, &rgba2->rgba);
+}
+
 static void
 gtk_css_value_rgba_free (GtkCssValue *value)
 {
+  if (interned_rgbas &&
+      g_hash_table_lookup (interned_rgbas, value) == value)
+    g_hash_table_remove (interned_rgbas, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -114,8 +139,27 @@ _gtk_css_rgba_value_new_from_rgba (const GdkRGBA *rgba)
 
   g_return_val_if_fail (rgba != NULL, NULL);
 
+  /* Colors with NaN components are not equal to themselves */
+  if (!gdk_rgba_equal (rgba, rgba))
+    {
+      value = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_RGBA);
+      value->rgba = *rgba;
+
+      return value;
+    }
+
+  if (interned_rgbas == NULL)
+    interned_rgbas = g_hash_table_new (gtk_css_value_rgba_hash,
+                                       gtk_css_value_rgba_intern_equal);
+
+  value = g_hash_table_lookup (interned_rgbas,
+                               &(GtkCssValue) { &GTK_CSS_VALUE_RGBA, 1, *rgba });
+  if (value)
+    return _gtk_css_value_ref (value);
+
   value = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_RGBA);
   value->rgba = *rgba;
+  g_hash_table_add (interned_rgbas, value);
 
   return value;
 }
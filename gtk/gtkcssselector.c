@@ -1800,6 +1800,45 @@ gtk_css_selectors_skip_initial_selector (GtkCssSelector *selector, const GtkCssS
   return (GtkCssSelector *)gtk_css_selector_previous (selector);
 }
 
+static gboolean
+gtk_css_selector_may_match_ancestor (const GtkCssSelector       *selector,
+                                     const GtkCssAncestorFilter *filter)
+{
+  if (selector->class == &GTK_CSS_SELECTOR_NAME)
+    return _gtk_css_ancestor_filter_may_contain (filter, _gtk_css_ancestor_filter_hash_name (selector->name.name));
+  else if (selector->class == &GTK_CSS_SELECTOR_CLASS)
+    return _gtk_css_ancestor_filter_may_contain (filter, _gtk_css_ancestor_filter_hash_class (selector->style_class.style_class));
+  else if (selector->class == &GTK_CSS_SELECTOR_ID)
+    return _gtk_css_ancestor_filter_may_contain (filter, _gtk_css_ancestor_filter_hash_id (selector->id.name));
+
+  return TRUE;
+}
+
+/* Checks if it's worth walking the ancestors of @matcher for the
+ * descendant combinator @tree. Every selector directly preceding it
+ * has to match one of the ancestors, so if none of them can, we're done. */
+static gboolean
+gtk_css_selector_tree_descendant_may_match (const GtkCssSelectorTree *tree,
+                                            const GtkCssMatcher      *matcher)
+{
+  const GtkCssAncestorFilter *filter;
+  const GtkCssSelectorTree *prev;
+
+  filter = _gtk_css_matcher_get_ancestor_filter (matcher);
+  if (filter == NULL)
+    return TRUE;
+
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
+    {
+      if (gtk_css_selector_may_match_ancestor (&prev->selector, filter))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 static gboolean
 gtk_css_selector_tree_match_foreach (const GtkCssSelector *selector,
                                      const GtkCssMatcher  *matcher,
@@ -1816,7 +1855,13 @@ gtk_css_selector_tree_match_foreach (const GtkCssSelector *selector,
   for (prev = gtk_css_selector_tree_get_previous (tree);
        prev != NULL;
        prev = gtk_css_selector_tree_get_sibling (prev))
-    gtk_css_selector_foreach (&prev->selector, matcher, gtk_css_selector_tree_match_foreach, res);
+    {
+      if (prev->selector.class == &GTK_CSS_SELECTOR_DESCENDANT &&
+          !gtk_css_selector_tree_descendant_may_match (prev, matcher))
+        continue;
+
+      gtk_css_selector_foreach (&prev->selector, matcher, gtk_css_selector_tree_match_foreach, res);
+    }
 
   return FALSE;
 }
@@ -1902,6 +1947,76 @@ _gtk_css_selector_tree_get_change_all (const GtkCssSelectorTree *tree,
   return change & ~GTK_CSS_CHANGE_RESERVED_BIT;
 }
 
+static void
+gtk_css_selector_tree_collect_matches (const GtkCssSelectorTree  *tree,
+                                       GPtrArray                **array)
+{
+  const GtkCssSelectorTree *prev;
+
+  gtk_css_selector_tree_found_match (tree, array);
+
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
+    gtk_css_selector_tree_collect_matches (prev, array);
+}
+
+static void
+gtk_css_selector_tree_match_rightmost (const GtkCssSelectorTree  *tree,
+                                       const GtkCssMatcher       *matcher,
+                                       GPtrArray                **array)
+{
+  const GtkCssSelectorTree *prev;
+
+  if (!gtk_css_selector_match (&tree->selector, matcher))
+    return;
+
+  if (!tree->selector.class->is_simple)
+    {
+      gtk_css_selector_tree_collect_matches (tree, array);
+      return;
+    }
+
+  gtk_css_selector_tree_found_match (tree, array);
+
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
+    gtk_css_selector_tree_match_rightmost (prev, matcher, array);
+}
+
+/* Returns the rules whose rightmost compound selector matches, without
+ * looking at the ancestors or siblings. These are the rules that
+ * _gtk_css_selector_tree_get_change_all() takes the change from. */
+GPtrArray *
+_gtk_css_selector_tree_match_rightmost (const GtkCssSelectorTree *tree,
+                                        const GtkCssMatcher      *matcher)
+{
+  GPtrArray *array = NULL;
+
+  for (; tree != NULL;
+       tree = gtk_css_selector_tree_get_sibling (tree))
+    gtk_css_selector_tree_match_rightmost (tree, matcher, &array);
+
+  return array;
+}
+
+/* Returns the changes that can affect any node, without matching.
+ * This is used to find out if a kind of change can be ignored. */
+GtkCssChange
+_gtk_css_selector_tree_get_change_any (const GtkCssSelectorTree *tree)
+{
+  GtkCssChange change;
+
+  change = 0;
+
+  for (; tree != NULL;
+       tree = gtk_css_selector_tree_get_sibling (tree))
+    change |= gtk_css_selector_tree_collect_change (tree);
+
+  return change & ~GTK_CSS_CHANGE_RESERVED_BIT;
+}
+
 #ifdef PRINT_TREE
 static void
 _gtk_css_selector_tree_print (const GtkCssSelectorTree *tree, GString *str, char *prefix)
@@ -45,6 +45,9 @@ GPtrArray *  _gtk_css_selector_tree_match_all        (const GtkCssSelectorTree *
 						      const GtkCssMatcher      *matcher);
 GtkCssChange _gtk_css_selector_tree_get_change_all   (const GtkCssSelectorTree *tree,
 						      const GtkCssMatcher *matcher);
+GPtrArray *  _gtk_css_selector_tree_match_rightmost  (const GtkCssSelectorTree *tree,
+						      const GtkCssMatcher      *matcher);
+GtkCssChange _gtk_css_selector_tree_get_change_any   (const GtkCssSelectorTree *tree);
 void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *tree,
 						      GString                  *str);
 
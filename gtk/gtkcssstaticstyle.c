@@ -26,6 +26,7 @@
 #include "gtkcssenumvalueprivate.h"
 #include "gtkcssinheritvalueprivate.h"
 #include "gtkcssinitialvalueprivate.h"
+#include "gtkcsslookupprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
 #include "gtkcssstringvalueprivate.h"
@@ -38,6 +39,273 @@
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include <string.h>
+
+struct _GtkCssValues {
+  guint         ref_count;
+  guint         group : 8;
+  guint         interned : 1;
+  guint         hash;
+  GtkCssValue  *values[];
+};
+
+static const guint core_props[] = {
+  GTK_CSS_PROPERTY_COLOR,
+  GTK_CSS_PROPERTY_DPI,
+  GTK_CSS_PROPERTY_FONT_SIZE,
+  GTK_CSS_PROPERTY_ICON_THEME,
+  GTK_CSS_PROPERTY_ICON_PALETTE
+};
+
+static const guint font_props[] = {
+  GTK_CSS_PROPERTY_FONT_FAMILY,
+  GTK_CSS_PROPERTY_FONT_STYLE,
+  GTK_CSS_PROPERTY_FONT_WEIGHT,
+  GTK_CSS_PROPERTY_FONT_STRETCH,
+  GTK_CSS_PROPERTY_LETTER_SPACING,
+  GTK_CSS_PROPERTY_TEXT_SHADOW,
+  GTK_CSS_PROPERTY_CARET_COLOR,
+  GTK_CSS_PROPERTY_SECONDARY_CARET_COLOR,
+  GTK_CSS_PROPERTY_FONT_FEATURE_SETTINGS,
+  GTK_CSS_PROPERTY_FONT_VARIATION_SETTINGS
+};
+
+static const guint icon_props[] = {
+  GTK_CSS_PROPERTY_ICON_SIZE,
+  GTK_CSS_PROPERTY_ICON_SHADOW,
+  GTK_CSS_PROPERTY_ICON_STYLE
+};
+
+static const guint text_props[] = {
+  GTK_CSS_PROPERTY_TEXT_DECORATION_LINE,
+  GTK_CSS_PROPERTY_TEXT_DECORATION_COLOR,
+  GTK_CSS_PROPERTY_TEXT_DECORATION_STYLE,
+  GTK_CSS_PROPERTY_FONT_KERNING,
+  GTK_CSS_PROPERTY_FONT_VARIANT_LIGATURES,
+  GTK_CSS_PROPERTY_FONT_VARIANT_POSITION,
+  GTK_CSS_PROPERTY_FONT_VARIANT_CAPS,
+  GTK_CSS_PROPERTY_FONT_VARIANT_NUMERIC,
+  GTK_CSS_PROPERTY_FONT_VARIANT_ALTERNATES,
+  GTK_CSS_PROPERTY_FONT_VARIANT_EAST_ASIAN
+};
+
+static const guint background_props[] = {
+  GTK_CSS_PROPERTY_BACKGROUND_COLOR,
+  GTK_CSS_PROPERTY_BOX_SHADOW,
+  GTK_CSS_PROPERTY_BACKGROUND_CLIP,
+  GTK_CSS_PROPERTY_BACKGROUND_ORIGIN,
+  GTK_CSS_PROPERTY_BACKGROUND_SIZE,
+  GTK_CSS_PROPERTY_BACKGROUND_POSITION,
+  GTK_CSS_PROPERTY_BACKGROUND_REPEAT,
+  GTK_CSS_PROPERTY_BACKGROUND_IMAGE,
+  GTK_CSS_PROPERTY_BACKGROUND_BLEND_MODE
+};
+
+static const guint size_props[] = {
+  GTK_CSS_PROPERTY_MARGIN_TOP,
+  GTK_CSS_PROPERTY_MARGIN_LEFT,
+  GTK_CSS_PROPERTY_MARGIN_BOTTOM,
+  GTK_CSS_PROPERTY_MARGIN_RIGHT,
+  GTK_CSS_PROPERTY_PADDING_TOP,
+  GTK_CSS_PROPERTY_PADDING_LEFT,
+  GTK_CSS_PROPERTY_PADDING_BOTTOM,
+  GTK_CSS_PROPERTY_PADDING_RIGHT,
+  GTK_CSS_PROPERTY_BORDER_SPACING,
+  GTK_CSS_PROPERTY_MIN_WIDTH,
+  GTK_CSS_PROPERTY_MIN_HEIGHT
+};
+
+static const guint border_props[] = {
+  GTK_CSS_PROPERTY_BORDER_TOP_STYLE,
+  GTK_CSS_PROPERTY_BORDER_TOP_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_LEFT_STYLE,
+  GTK_CSS_PROPERTY_BORDER_LEFT_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_STYLE,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_STYLE,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_TOP_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_TOP_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_TOP_COLOR,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_COLOR,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_COLOR,
+  GTK_CSS_PROPERTY_BORDER_LEFT_COLOR,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_SOURCE,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_REPEAT,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_SLICE,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_WIDTH
+};
+
+static const guint outline_props[] = {
+  GTK_CSS_PROPERTY_OUTLINE_STYLE,
+  GTK_CSS_PROPERTY_OUTLINE_WIDTH,
+  GTK_CSS_PROPERTY_OUTLINE_OFFSET,
+  GTK_CSS_PROPERTY_OUTLINE_TOP_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_TOP_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_BOTTOM_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_BOTTOM_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_COLOR
+};
+
+static const guint other_props[] = {
+  GTK_CSS_PROPERTY_ICON_SOURCE,
+  GTK_CSS_PROPERTY_ICON_TRANSFORM,
+  GTK_CSS_PROPERTY_ICON_FILTER,
+  GTK_CSS_PROPERTY_TRANSFORM,
+  GTK_CSS_PROPERTY_OPACITY,
+  GTK_CSS_PROPERTY_FILTER
+};
+
+static const guint transition_props[] = {
+  GTK_CSS_PROPERTY_TRANSITION_PROPERTY,
+  GTK_CSS_PROPERTY_TRANSITION_DURATION,
+  GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION,
+  GTK_CSS_PROPERTY_TRANSITION_DELAY
+};
+
+static const guint animation_props[] = {
+  GTK_CSS_PROPERTY_ANIMATION_NAME,
+  GTK_CSS_PROPERTY_ANIMATION_DURATION,
+  GTK_CSS_PROPERTY_ANIMATION_TIMING_FUNCTION,
+  GTK_CSS_PROPERTY_ANIMATION_ITERATION_COUNT,
+  GTK_CSS_PROPERTY_ANIMATION_DIRECTION,
+  GTK_CSS_PROPERTY_ANIMATION_PLAY_STATE,
+  GTK_CSS_PROPERTY_ANIMATION_DELAY,
+  GTK_CSS_PROPERTY_ANIMATION_FILL_MODE
+};
+
+/* Core values must come first, all other values may depend on
+ * the color and the font size. */
+static const struct {
+  const guint *props;
+  guint        n_props;
+} groups[GTK_CSS_N_VALUES_GROUPS] = {
+  [GTK_CSS_CORE_VALUES] = { core_props, G_N_ELEMENTS (core_props) },
+  [GTK_CSS_FONT_VALUES] = { font_props, G_N_ELEMENTS (font_props) },
+  [GTK_CSS_ICON_VALUES] = { icon_props, G_N_ELEMENTS (icon_props) },
+  [GTK_CSS_TEXT_VALUES] = { text_props, G_N_ELEMENTS (text_props) },
+  [GTK_CSS_BACKGROUND_VALUES] = { background_props, G_N_ELEMENTS (background_props) },
+  [GTK_CSS_SIZE_VALUES] = { size_props, G_N_ELEMENTS (size_props) },
+  [GTK_CSS_BORDER_VALUES] = { border_props, G_N_ELEMENTS (border_props) },
+  [GTK_CSS_OUTLINE_VALUES] = { outline_props, G_N_ELEMENTS (outline_props) },
+  [GTK_CSS_OTHER_VALUES] = { other_props, G_N_ELEMENTS (other_props) },
+  [GTK_CSS_TRANSITION_VALUES] = { transition_props, G_N_ELEMENTS (transition_props) },
+  [GTK_CSS_ANIMATION_VALUES] = { animation_props, G_N_ELEMENTS (animation_props) },
+};
+
+/* Filled in class_init */
+static guint8 property_group[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 property_index[GTK_CSS_PROPERTY_N_PROPERTIES];
+static gboolean group_is_inherited[GTK_CSS_N_VALUES_GROUPS];
+static gboolean property_is_inherited[GTK_CSS_PROPERTY_N_PROPERTIES];
+
+/* The computed initial values of properties that don't depend on the
+ * style they are computed for. These are the initial values that compute
+ * to themselves. They are found when first computing them, properties
+ * where that didn't happen are in initial_value_checked, too.
+ */
+static GtkCssValue *static_initial_values[GTK_CSS_PROPERTY_N_PROPERTIES];
+static gboolean initial_value_checked[GTK_CSS_PROPERTY_N_PROPERTIES];
+
+/* Groups are hash-consed on the identity of their values, so styles
+ * with the same values in a group share the memory for it. */
+static GHashTable *interned_values;
+
+static GtkCssValues *
+gtk_css_values_new (GtkCssValuesGroup group)
+{
+  GtkCssValues *values;
+
+  values = g_malloc0 (sizeof (GtkCssValues) + groups[group].n_props * sizeof (GtkCssValue *));
+  values->ref_count = 1;
+  values->group = group;
+
+  return values;
+}
+
+static GtkCssValues *
+gtk_css_values_ref (GtkCssValues *values)
+{
+  values->ref_count++;
+
+  return values;
+}
+
+static void
+gtk_css_values_unref (GtkCssValues *values)
+{
+  guint i;
+
+  values->ref_count--;
+  if (values->ref_count > 0)
+    return;
+
+  if (values->interned)
+    g_hash_table_remove (interned_values, values);
+
+  for (i = 0; i < groups[values->group].n_props; i++)
+    {
+      if (values->values[i])
+        _gtk_css_value_unref (values->values[i]);
+    }
+
+  g_free (values);
+}
+
+static guint
+gtk_css_values_hash (gconstpointer data)
+{
+  const GtkCssValues *values = data;
+
+  return values->hash;
+}
+
+static gboolean
+gtk_css_values_equal (gconstpointer data1,
+                      gconstpointer data2)
+{
+  const GtkCssValues *values1 = data1;
+  const GtkCssValues *values2 = data2;
+
+  if (values1->group != values2->group ||
+      values1->hash != values2->hash)
+    return FALSE;
+
+  return memcmp (values1->values,
+                 values2->values,
+                 groups[values1->group].n_props * sizeof (GtkCssValue *)) == 0;
+}
+
+/* Takes ownership of @values */
+static GtkCssValues *
+gtk_css_values_intern (GtkCssValues *values)
+{
+  GtkCssValues *interned;
+  guint i, hash;
+
+  if (interned_values == NULL)
+    interned_values = g_hash_table_new (gtk_css_values_hash, gtk_css_values_equal);
+
+  hash = values->group;
+  for (i = 0; i < groups[values->group].n_props; i++)
+    hash = (hash << 5) - hash + GPOINTER_TO_UINT (values->values[i]);
+  values->hash = hash;
+
+  interned = g_hash_table_lookup (interned_values, values);
+  if (interned)
+    {
+      gtk_css_values_unref (values);
+      return gtk_css_values_ref (interned);
+    }
+
+  values->interned = TRUE;
+  g_hash_table_add (interned_values, values);
+
+  return values;
+}
+
 G_DEFINE_TYPE (GtkCssStaticStyle, gtk_css_static_style, GTK_TYPE_CSS_STYLE)
 
 static GtkCssValue *
@@ -46,8 +314,13 @@ gtk_css_static_style_get_value (GtkCssStyle *style,
 {
   /* This is called a lot, so we avoid a dynamic type check here */
   GtkCssStaticStyle *sstyle = (GtkCssStaticStyle *) style;
+  GtkCssValues *values = sstyle->groups[property_group[id]];
+
+  /* Groups are computed in order, so later ones may still be missing */
+  if (G_UNLIKELY (values == NULL))
+    return NULL;
 
-  return sstyle->values[id];
+  return values->values[property_index[id]];
 }
 
 static GtkCssSection *
@@ -69,11 +342,8 @@ gtk_css_static_style_dispose (GObject *object)
   GtkCssStaticStyle *style = GTK_CSS_STATIC_STYLE (object);
   guint i;
 
-  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
-    {
-      if (style->values[i])
-        _gtk_css_value_unref (style->values[i]);
-    }
+  for (i = 0; i < GTK_CSS_N_VALUES_GROUPS; i++)
+    g_clear_pointer (&style->groups[i], gtk_css_values_unref);
   if (style->sections)
     {
       g_ptr_array_unref (style->sections);
@@ -83,6 +353,36 @@ gtk_css_static_style_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_css_static_style_parent_class)->dispose (object);
 }
 
+static void
+gtk_css_static_style_init_groups (void)
+{
+  guint group, i;
+
+  memset (property_group, 0xff, sizeof (property_group));
+
+  for (group = 0; group < GTK_CSS_N_VALUES_GROUPS; group++)
+    {
+      group_is_inherited[group] = TRUE;
+
+      for (i = 0; i < groups[group].n_props; i++)
+        {
+          guint id = groups[group].props[i];
+          GtkCssStyleProperty *prop = _gtk_css_style_property_lookup_by_id (id);
+
+          g_assert (property_group[id] == 0xff);
+          property_group[id] = group;
+          property_index[id] = i;
+
+          property_is_inherited[id] = _gtk_css_style_property_is_inherit (prop);
+          if (!property_is_inherited[id])
+            group_is_inherited[group] = FALSE;
+        }
+    }
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    g_assert (property_group[i] != 0xff);
+}
+
 static void
 gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 {
@@ -93,6 +393,8 @@ gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 
   style_class->get_value = gtk_css_static_style_get_value;
   style_class->get_section = gtk_css_static_style_get_section;
+
+  gtk_css_static_style_init_groups ();
 }
 
 static void
@@ -113,9 +415,15 @@ gtk_css_static_style_set_value (GtkCssStaticStyle *style,
                                 GtkCssValue       *value,
                                 GtkCssSection     *section)
 {
-  if (style->values[id])
-    _gtk_css_value_unref (style->values[id]);
-  style->values[id] = _gtk_css_value_ref (value);
+  GtkCssValues *values = style->groups[property_group[id]];
+  guint i = property_index[id];
+
+  /* Only groups that are still being computed may be modified */
+  g_assert (!values->interned);
+
+  if (values->values[i])
+    _gtk_css_value_unref (values->values[i]);
+  values->values[i] = _gtk_css_value_ref (value);
 
   if (style->sections && style->sections->len > id && g_ptr_array_index (style->sections, id))
     {
@@ -165,6 +473,11 @@ gtk_css_static_style_get_default (void)
   return default_style;
 }
 
+static void gtk_css_static_style_resolve (GtkCssStaticStyle *style,
+                                          GtkStyleProvider  *provider,
+                                          GtkCssStyle       *parent_style,
+                                          GtkCssLookup      *lookup);
+
 GtkCssStyle *
 gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
                                   const GtkCssMatcher *matcher,
@@ -186,17 +499,17 @@ gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
 
   result->change = change;
 
-  _gtk_css_lookup_resolve (&lookup,
-                           provider,
-                           result,
-                           parent);
+  gtk_css_static_style_resolve (result,
+                                provider,
+                                parent,
+                                &lookup);
 
   _gtk_css_lookup_destroy (&lookup);
 
   return GTK_CSS_STYLE (result);
 }
 
-void
+static void
 gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
                                     GtkStyleProvider  *provider,
                                     GtkCssStyle       *parent_style,
@@ -205,6 +518,7 @@ gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
                                     GtkCssSection     *section)
 {
   GtkCssValue *value;
+  gboolean check_initial = FALSE;
 
   gtk_internal_return_if_fail (id < GTK_CSS_PROPERTY_N_PROPERTIES);
 
@@ -220,19 +534,137 @@ gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
       if (_gtk_css_style_property_is_inherit (prop))
         specified = _gtk_css_inherit_value_new ();
       else
-        specified = _gtk_css_initial_value_new ();
+        {
+          specified = _gtk_css_initial_value_new ();
+          check_initial = !initial_value_checked[id];
+        }
     }
   else
     _gtk_css_value_ref (specified);
 
   value = _gtk_css_value_compute (specified, id, provider, GTK_CSS_STYLE (style), parent_style);
 
+  if (check_initial)
+    {
+      GtkCssStyleProperty *prop = _gtk_css_style_property_lookup_by_id (id);
+
+      if (value == _gtk_css_style_property_get_initial_value (prop))
+        static_initial_values[id] = value;
+      initial_value_checked[id] = TRUE;
+    }
+
   gtk_css_static_style_set_value (style, id, value, section);
 
   _gtk_css_value_unref (value);
   _gtk_css_value_unref (specified);
 }
 
+static gboolean
+gtk_css_static_style_can_inherit_group (GtkCssStyle       *parent_style,
+                                        GtkCssValuesGroup  group,
+                                        GtkCssLookup      *lookup)
+{
+  guint i;
+
+  if (!group_is_inherited[group])
+    return FALSE;
+
+  /* Animated parents may have different values */
+  if (parent_style == NULL || !GTK_IS_CSS_STATIC_STYLE (parent_style))
+    return FALSE;
+
+  for (i = 0; i < groups[group].n_props; i++)
+    {
+      guint id = groups[group].props[i];
+
+      if (lookup->values[id].value != NULL ||
+          !_gtk_css_lookup_is_missing (lookup, id))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Returns the computed value for a property without a declaration if
+ * it can be found without computing it, or %NULL otherwise. */
+static GtkCssValue *
+gtk_css_static_style_get_unset_value (GtkCssStyle *parent_style,
+                                      guint        id)
+{
+  if (property_is_inherited[id])
+    return parent_style ? gtk_css_style_get_value (parent_style, id) : NULL;
+  else
+    return static_initial_values[id];
+}
+
+/*
+ * gtk_css_static_style_resolve:
+ * @style: a new #GtkCssStaticStyle to be filled with the new properties
+ * @provider: the provider the values are resolved for
+ * @parent_style: (allow-none): the parent style
+ * @lookup: the lookup
+ *
+ * Resolves the lookup into @style. This is done by converting from the
+ * “winning declaration” to the “computed value”.
+ *
+ * Groups of inherited properties that have no declaration are shared
+ * with the parent instead of being computed. All other groups are
+ * looked up in the table of interned groups after computing them.
+ * Inside of these, properties without a declaration use the parent's
+ * value or the initial value directly where possible.
+ *
+ * XXX: This bypasses the notion of “specified value”. If this ever becomes
+ * an issue, go fix it.
+ */
+static void
+gtk_css_static_style_resolve (GtkCssStaticStyle *style,
+                              GtkStyleProvider  *provider,
+                              GtkCssStyle       *parent_style,
+                              GtkCssLookup      *lookup)
+{
+  guint group, i;
+
+  for (group = 0; group < GTK_CSS_N_VALUES_GROUPS; group++)
+    {
+      if (gtk_css_static_style_can_inherit_group (parent_style, group, lookup))
+        {
+          style->groups[group] = gtk_css_values_ref (GTK_CSS_STATIC_STYLE (parent_style)->groups[group]);
+          continue;
+        }
+
+      style->groups[group] = gtk_css_values_new (group);
+
+      for (i = 0; i < groups[group].n_props; i++)
+        {
+          guint id = groups[group].props[i];
+
+          if (lookup->values[id].value == NULL &&
+              _gtk_css_lookup_is_missing (lookup, id))
+            {
+              GtkCssValue *value = gtk_css_static_style_get_unset_value (parent_style, id);
+
+              if (value)
+                {
+                  gtk_css_static_style_set_value (style, id, value, NULL);
+                  continue;
+                }
+            }
+
+          if (lookup->values[id].value ||
+              _gtk_css_lookup_is_missing (lookup, id))
+            gtk_css_static_style_compute_value (style,
+                                                provider,
+                                                parent_style,
+                                                id,
+                                                lookup->values[id].value,
+                                                lookup->values[id].section);
+          /* else not a relevant property */
+        }
+
+      style->groups[group] = gtk_css_values_intern (style->groups[group]);
+    }
+}
+
 GtkCssChange
 gtk_css_static_style_get_change (GtkCssStaticStyle *style)
 {
@@ -34,12 +34,31 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssStaticStyle           GtkCssStaticStyle;
 typedef struct _GtkCssStaticStyleClass      GtkCssStaticStyleClass;
+typedef struct _GtkCssValues                GtkCssValues;
+
+/* The values of a style are split into groups of related properties.
+ * Groups are shared between styles. */
+typedef enum {
+  GTK_CSS_CORE_VALUES,
+  GTK_CSS_FONT_VALUES,
+  GTK_CSS_ICON_VALUES,
+  GTK_CSS_TEXT_VALUES,
+  GTK_CSS_BACKGROUND_VALUES,
+  GTK_CSS_SIZE_VALUES,
+  GTK_CSS_BORDER_VALUES,
+  GTK_CSS_OUTLINE_VALUES,
+  GTK_CSS_OTHER_VALUES,
+  GTK_CSS_TRANSITION_VALUES,
+  GTK_CSS_ANIMATION_VALUES,
+  /* add more */
+  GTK_CSS_N_VALUES_GROUPS
+} GtkCssValuesGroup;
 
 struct _GtkCssStaticStyle
 {
   GtkCssStyle parent;
 
-  GtkCssValue           *values[GTK_CSS_PROPERTY_N_PROPERTIES]; /* the values */
+  GtkCssValues          *groups[GTK_CSS_N_VALUES_GROUPS]; /* the values */
   GPtrArray             *sections;             /* sections the values are defined in */
 
   GtkCssChange           change;               /* change as returned by value lookup */
@@ -57,13 +76,6 @@ GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvide
                                                                  const GtkCssMatcher    *matcher,
                                                                  GtkCssStyle            *parent);
 
-void                    gtk_css_static_style_compute_value      (GtkCssStaticStyle      *style,
-                                                                 GtkStyleProvider       *provider,
-                                                                 GtkCssStyle            *parent_style,
-                                                                 guint                   id,
-                                                                 GtkCssValue            *specified,
-                                                                 GtkCssSection          *section);
-
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle      *style);
 
 G_END_DECLS
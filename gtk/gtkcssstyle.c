@@ -53,9 +53,23 @@ gtk_css_style_real_is_static (GtkCssStyle *style)
   return TRUE;
 }
 
+static void
+gtk_css_style_finalize (GObject *object)
+{
+  GtkCssStyle *style = GTK_CSS_STYLE (object);
+
+  g_clear_pointer (&style->box_node, gsk_render_node_unref);
+
+  G_OBJECT_CLASS (gtk_css_style_parent_class)->finalize (object);
+}
+
 static void
 gtk_css_style_class_init (GtkCssStyleClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gtk_css_style_finalize;
+
   klass->get_section = gtk_css_style_real_get_section;
   klass->is_static = gtk_css_style_real_is_static;
 }
@@ -19,8 +19,48 @@
 
 #include "gtkcssstylechangeprivate.h"
 
+#include "gtkcssanimatedstyleprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 
+static void
+gtk_css_style_compare_value (GtkCssStyleChange *change,
+                             guint              id)
+{
+  if (gtk_css_property_set_get (&change->changes, id))
+    return;
+
+  if (!_gtk_css_value_equal (gtk_css_style_get_value (change->old_style, id),
+                             gtk_css_style_get_value (change->new_style, id)))
+    {
+      change->affects |= _gtk_css_style_property_get_affects (_gtk_css_style_property_lookup_by_id (id));
+      gtk_css_property_set_add (&change->changes, id);
+    }
+}
+
+static GtkCssStyle *
+get_static_style (GtkCssStyle *style)
+{
+  if (GTK_IS_CSS_ANIMATED_STYLE (style))
+    return GTK_CSS_ANIMATED_STYLE (style)->style;
+
+  return style;
+}
+
+static void
+gtk_css_style_compare_animated_values (GtkCssStyleChange *change,
+                                       GtkCssStyle       *style)
+{
+  GtkCssAnimatedStyle *animated;
+  guint i;
+
+  if (!GTK_IS_CSS_ANIMATED_STYLE (style))
+    return;
+
+  animated = GTK_CSS_ANIMATED_STYLE (style);
+  for (i = 0; i < animated->n_animated_values; i++)
+    gtk_css_style_compare_value (change, animated->animated_values[i].id);
+}
+
 void
 gtk_css_style_change_init (GtkCssStyleChange *change,
                            GtkCssStyle       *old_style,
@@ -32,11 +72,19 @@ gtk_css_style_change_init (GtkCssStyleChange *change,
   change->n_compared = 0;
 
   change->affects = 0;
-  change->changes = _gtk_bitmask_new ();
+  gtk_css_property_set_init (&change->changes);
   
   /* Make sure we don't do extra work if old and new are equal. */
   if (old_style == new_style)
     change->n_compared = GTK_CSS_PROPERTY_N_PROPERTIES;
+  /* If only animations advanced, only the animated values
+   * can differ, so compare those right away. */
+  else if (get_static_style (old_style) == get_static_style (new_style))
+    {
+      gtk_css_style_compare_animated_values (change, old_style);
+      gtk_css_style_compare_animated_values (change, new_style);
+      change->n_compared = GTK_CSS_PROPERTY_N_PROPERTIES;
+    }
 }
 
 void
@@ -44,7 +92,6 @@ gtk_css_style_change_finish (GtkCssStyleChange *change)
 {
   g_object_unref (change->old_style);
   g_object_unref (change->new_style);
-  _gtk_bitmask_free (change->changes);
 }
 
 GtkCssStyle *
@@ -65,12 +112,7 @@ gtk_css_style_compare_next_value (GtkCssStyleChange *change)
   if (change->n_compared == GTK_CSS_PROPERTY_N_PROPERTIES)
     return FALSE;
 
-  if (!_gtk_css_value_equal (gtk_css_style_get_value (change->old_style, change->n_compared),
-                             gtk_css_style_get_value (change->new_style, change->n_compared)))
-    {
-      change->affects |= _gtk_css_style_property_get_affects (_gtk_css_style_property_lookup_by_id (change->n_compared));
-      change->changes = _gtk_bitmask_set (change->changes, change->n_compared, TRUE);
-    }
+  gtk_css_style_compare_value (change, change->n_compared);
 
   change->n_compared++;
 
@@ -81,7 +123,7 @@ gboolean
 gtk_css_style_change_has_change (GtkCssStyleChange *change)
 {
   do {
-    if (!_gtk_bitmask_is_empty (change->changes))
+    if (!gtk_css_property_set_is_empty (&change->changes))
       return TRUE;
   } while (gtk_css_style_compare_next_value (change));
 
@@ -107,7 +149,7 @@ gtk_css_style_change_changes_property (GtkCssStyleChange *change,
   while (change->n_compared <= id)
     gtk_css_style_compare_next_value (change);
 
-  return _gtk_bitmask_get (change->changes, id);
+  return gtk_css_property_set_get (&change->changes, id);
 }
 
 void
@@ -18,6 +18,7 @@
 #ifndef __GTK_CSS_STYLE_CHANGE_PRIVATE_H__
 #define __GTK_CSS_STYLE_CHANGE_PRIVATE_H__
 
+#include "gtkcsspropertysetprivate.h"
 #include "gtkcssstyleprivate.h"
 
 G_BEGIN_DECLS
@@ -31,7 +32,7 @@ struct _GtkCssStyleChange {
   guint          n_compared;
 
   GtkCssAffects  affects;
-  GtkBitmask    *changes;
+  GtkCssPropertySet changes;
 };
 
 void            gtk_css_style_change_init               (GtkCssStyleChange      *change,
@@ -22,6 +22,7 @@
 
 #include <glib-object.h>
 #include <gtk/css/gtkcss.h>
+#include <gsk/gsk.h>
 
 #include "gtk/gtkbitmaskprivate.h"
 #include "gtk/gtkcssvalueprivate.h"
@@ -41,6 +42,11 @@ typedef struct _GtkCssStyleClass      GtkCssStyleClass;
 struct _GtkCssStyle
 {
   GObject parent;
+
+  /* see gtk_css_style_snapshot_box() */
+  GskRenderNode        *box_node;
+  graphene_rect_t       box_node_bounds;
+  guint                 box_node_valid :1;
 };
 
 struct _GtkCssStyleClass
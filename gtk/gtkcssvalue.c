@@ -29,6 +29,8 @@ struct _GtkCssValue {
 
 G_DEFINE_BOXED_TYPE (GtkCssValue, _gtk_css_value, _gtk_css_value_ref, _gtk_css_value_unref)
 
+static guint n_values_created;
+
 GtkCssValue *
 _gtk_css_value_alloc (const GtkCssValueClass *klass,
                       gsize                   size)
@@ -40,9 +42,23 @@ _gtk_css_value_alloc (const GtkCssValueClass *klass,
   value->class = klass;
   value->ref_count = 1;
 
+  n_values_created++;
+
   return value;
 }
 
+/*
+ * gtk_css_value_get_n_created:
+ *
+ * Returns the number of values that have been allocated so far.
+ * This is used by the inspector.
+ */
+guint
+gtk_css_value_get_n_created (void)
+{
+  return n_values_created;
+}
+
 GtkCssValue *
 gtk_css_value_ref (GtkCssValue *value)
 {
@@ -244,6 +244,7 @@ gtk_css_widget_node_widget_destroyed (GtkCssWidgetNode *node)
   gtk_internal_return_if_fail (node->widget != NULL);
 
   node->widget = NULL;
+  gtk_css_node_invalidate_ancestor_filters (GTK_CSS_NODE (node));
   /* Contents of this node are now undefined.
    * So we don't clear the style or anything.
    */
@@ -73,6 +73,7 @@ struct _GtkEmojiChooser
   GtkWidget *box;
   GVariantIter *iter;
   guint populate_idle;
+  guint populated : 1;
 
   GSettings *settings;
 };
@@ -98,7 +99,8 @@ gtk_emoji_chooser_finalize (GObject *object)
   if (chooser->populate_idle)
     g_source_remove (chooser->populate_idle);
 
-  g_variant_unref (chooser->data);
+  g_clear_pointer (&chooser->iter, g_variant_iter_free);
+  g_clear_pointer (&chooser->data, g_variant_unref);
   g_object_unref (chooser->settings);
 
   G_OBJECT_CLASS (gtk_emoji_chooser_parent_class)->finalize (object);
@@ -403,6 +405,23 @@ add_emoji (GtkWidget    *box,
   gtk_flow_box_insert (GTK_FLOW_BOX (box), child, prepend ? 0 : -1);
 }
 
+/* The emoji data is the same for all choosers, so it is only
+ * loaded once */
+static GVariant *
+get_emoji_data (void)
+{
+  static GVariant *emoji_data = NULL;
+
+  if (emoji_data == NULL)
+    {
+      GBytes *bytes = g_resources_lookup_data ("/org/gtk/libgtk/emoji/emoji.data", 0, NULL);
+      emoji_data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(auss)"), bytes, TRUE));
+      g_bytes_unref (bytes);
+    }
+
+  return emoji_data;
+}
+
 static gboolean
 populate_emoji_chooser (gpointer data)
 {
@@ -413,11 +432,7 @@ populate_emoji_chooser (gpointer data)
   start = g_get_monotonic_time ();
 
   if (!chooser->data)
-    {
-      GBytes *bytes = g_resources_lookup_data ("/org/gtk/libgtk/emoji/emoji.data", 0, NULL);
-      chooser->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(auss)"), bytes, TRUE));
-      g_bytes_unref (bytes);
-    }
+    chooser->data = g_variant_ref (get_emoji_data ());
 
   if (!chooser->iter)
     {
@@ -460,6 +475,7 @@ populate_emoji_chooser (gpointer data)
   chooser->iter = NULL;
   chooser->box = NULL;
   chooser->populate_idle = 0;
+  chooser->populated = TRUE;
 
   return G_SOURCE_REMOVE;
 }
@@ -684,9 +700,38 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
   setup_section (chooser, &chooser->flags, "chequered flag", "emoji-flags-symbolic");
 
   populate_recent_section (chooser);
+}
+
+/* The sections are only populated while the chooser is on screen, a
+ * chooser that is created but never shown doesn't create thousands
+ * of widgets.
+ */
+static void
+gtk_emoji_chooser_map (GtkWidget *widget)
+{
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
+
+  GTK_WIDGET_CLASS (gtk_emoji_chooser_parent_class)->map (widget);
+
+  if (!chooser->populated && chooser->populate_idle == 0)
+    {
+      chooser->populate_idle = g_idle_add (populate_emoji_chooser, chooser);
+      g_source_set_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
+    }
+}
+
+static void
+gtk_emoji_chooser_unmap (GtkWidget *widget)
+{
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
+
+  if (chooser->populate_idle)
+    {
+      g_source_remove (chooser->populate_idle);
+      chooser->populate_idle = 0;
+    }
 
-  chooser->populate_idle = g_idle_add (populate_emoji_chooser, chooser);
-  g_source_set_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
+  GTK_WIDGET_CLASS (gtk_emoji_chooser_parent_class)->unmap (widget);
 }
 
 static void
@@ -712,6 +757,8 @@ gtk_emoji_chooser_class_init (GtkEmojiChooserClass *klass)
 
   object_class->finalize = gtk_emoji_chooser_finalize;
   widget_class->show = gtk_emoji_chooser_show;
+  widget_class->map = gtk_emoji_chooser_map;
+  widget_class->unmap = gtk_emoji_chooser_unmap;
 
   signals[EMOJI_PICKED] = g_signal_new ("emoji-picked",
                                         G_OBJECT_CLASS_TYPE (object_class),
@@ -75,6 +75,11 @@ struct _GtkEntryBufferPrivate
   gsize  normal_text_bytes;
   guint  normal_text_chars;
 
+  /* A known character/byte offset pair in normal_text, usually
+   * where the last edit happened */
+  guint  checkpoint_chars;
+  gsize  checkpoint_bytes;
+
   gint   max_length;
 };
 
@@ -98,6 +103,37 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+/* Converts a character offset into a byte offset. Edits mostly happen
+ * next to the previous one, so instead of always counting from the
+ * start of the text, count from the closest of the start, the end and
+ * the checkpoint. This keeps editing long texts from being linear in
+ * their length.
+ */
+static gsize
+gtk_entry_buffer_normal_get_byte_offset (GtkEntryBufferPrivate *pv,
+                                         guint                  position)
+{
+  glong from_checkpoint, from_end;
+  gsize bytes;
+
+  g_assert (position <= pv->normal_text_chars);
+
+  from_checkpoint = (glong) position - (glong) pv->checkpoint_chars;
+  from_end = (glong) pv->normal_text_chars - (glong) position;
+
+  if (position <= ABS (from_checkpoint) && position <= from_end)
+    bytes = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+  else if (ABS (from_checkpoint) <= from_end)
+    bytes = g_utf8_offset_to_pointer (pv->normal_text + pv->checkpoint_bytes, from_checkpoint) - pv->normal_text;
+  else
+    bytes = g_utf8_offset_to_pointer (pv->normal_text + pv->normal_text_bytes, - from_end) - pv->normal_text;
+
+  pv->checkpoint_chars = position;
+  pv->checkpoint_bytes = bytes;
+
+  return bytes;
+}
+
 static const gchar*
 gtk_entry_buffer_normal_get_text (GtkEntryBuffer *buffer,
                                   gsize          *n_bytes)
@@ -173,7 +209,7 @@ gtk_entry_buffer_normal_insert_text (GtkEntryBuffer *buffer,
     }
 
   /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+  at = gtk_entry_buffer_normal_get_byte_offset (pv, position);
   memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
   memcpy (pv->normal_text + at, chars, n_bytes);
 
@@ -181,6 +217,8 @@ gtk_entry_buffer_normal_insert_text (GtkEntryBuffer *buffer,
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
   pv->normal_text[pv->normal_text_bytes] = '\0';
+  pv->checkpoint_chars = position + n_chars;
+  pv->checkpoint_bytes = at + n_bytes;
 
   gtk_entry_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -201,8 +239,8 @@ gtk_entry_buffer_normal_delete_text (GtkEntryBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      start = gtk_entry_buffer_normal_get_byte_offset (pv, position);
+      end = g_utf8_offset_to_pointer (pv->normal_text + start, n_chars) - pv->normal_text;
 
       memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
       pv->normal_text_chars -= n_chars;
@@ -272,6 +310,8 @@ gtk_entry_buffer_finalize (GObject *obj)
       pv->normal_text = NULL;
       pv->normal_text_bytes = pv->normal_text_size = 0;
       pv->normal_text_chars = 0;
+      pv->checkpoint_chars = 0;
+      pv->checkpoint_bytes = 0;
     }
 
   G_OBJECT_CLASS (gtk_entry_buffer_parent_class)->finalize (obj);
@@ -298,6 +298,7 @@ struct _GtkFileChooserWidgetPrivate {
   GCancellable *update_current_folder_cancellable;
   GCancellable *should_respond_get_info_cancellable;
   GCancellable *file_exists_get_info_cancellable;
+  GHashTable *thumbnail_loads;
 
   LoadState load_state;
   ReloadState reload_state;
@@ -566,6 +567,7 @@ static void location_switch_to_path_bar (GtkFileChooserWidget *impl);
 
 static void stop_loading_and_clear_list_model (GtkFileChooserWidget *impl,
                                                gboolean remove_from_treeview);
+static void cancel_thumbnail_loads (GtkFileChooserWidget *impl);
 
 static GSList  *get_selected_files           (GtkFileChooserWidget *impl);
 static GSList  *get_selected_infos           (GtkFileChooserWidget *impl);
@@ -666,6 +668,7 @@ gtk_file_chooser_widget_finalize (GObject *object)
   GtkFileChooserWidgetPrivate *priv = impl->priv;
 
   g_clear_pointer (&priv->choices, g_hash_table_unref);
+  g_clear_pointer (&priv->thumbnail_loads, g_hash_table_unref);
 
   if (priv->location_changed_id > 0)
     g_source_remove (priv->location_changed_id);
@@ -3427,6 +3430,7 @@ cancel_all_operations (GtkFileChooserWidget *impl)
   g_clear_pointer (&priv->update_current_folder_cancellable, g_cancellable_cancel);
   g_clear_pointer (&priv->should_respond_get_info_cancellable, g_cancellable_cancel);
   g_clear_pointer (&priv->file_exists_get_info_cancellable, g_cancellable_cancel);
+  cancel_thumbnail_loads (impl);
 
   search_stop_searching (impl, TRUE);
   recent_stop_loading (impl);
@@ -4506,6 +4510,7 @@ stop_loading_and_clear_list_model (GtkFileChooserWidget *impl,
   GtkFileChooserWidgetPrivate *priv = impl->priv;
 
   load_remove_timer (impl, LOAD_EMPTY);
+  cancel_thumbnail_loads (impl);
 
   g_set_object (&priv->browse_files_model, NULL);
 
@@ -4639,39 +4644,246 @@ copy_attribute (GFileInfo   *to,
     g_file_info_set_attribute (to, attribute, type, value);
 }
 
+/* Icons and thumbnails of the rows in the file list are loaded
+ * when the rows are first shown. The thumbnail is looked up with an
+ * async query and decoded at the icon size in a thread, and loads of
+ * rows that get scrolled out of view are cancelled. */
+typedef struct {
+  GtkFileChooserWidget *impl;
+  GtkFileSystemModel *model;
+  GFile *file;
+  GFileInfo *queried;
+  GCancellable *cancellable;
+  int size;
+} ThumbnailLoad;
+
+static void
+thumbnail_load_free (ThumbnailLoad *load)
+{
+  g_object_unref (load->model);
+  g_object_unref (load->file);
+  g_clear_object (&load->queried);
+  g_object_unref (load->cancellable);
+  g_slice_free (ThumbnailLoad, load);
+}
+
+/* Only called for loads that were not cancelled, the table and impl
+ * are not touched for cancelled ones */
+static void
+thumbnail_load_finish (ThumbnailLoad *load,
+                       GdkPixbuf     *thumbnail)
+{
+  GtkFileChooserWidgetPrivate *priv = load->impl->priv;
+  GFileInfo *info;
+  GtkTreeIter iter;
+
+  if (g_hash_table_lookup (priv->thumbnail_loads, load->file) == load)
+    g_hash_table_remove (priv->thumbnail_loads, load->file);
+
+  /* file was deleted */
+  if (load->queried == NULL ||
+      !_gtk_file_system_model_get_iter_for_file (load->model, &iter, load->file))
+    {
+      thumbnail_load_free (load);
+      return;
+    }
+
+  info = g_file_info_dup (_gtk_file_system_model_get_info (load->model, &iter));
+
+  /* The thumbnail path is left out, so that the thumbnail is not
+   * decoded again in the main thread when it could not be loaded */
+  copy_attribute (info, load->queried, G_FILE_ATTRIBUTE_THUMBNAILING_FAILED);
+  copy_attribute (info, load->queried, G_FILE_ATTRIBUTE_STANDARD_ICON);
+  if (thumbnail)
+    g_file_info_set_attribute_object (info, "filechooser::thumbnail", G_OBJECT (thumbnail));
+
+  _gtk_file_system_model_update_file (load->model, load->file, info);
+
+  g_object_unref (info);
+  thumbnail_load_free (load);
+}
+
+static void
+load_thumbnail_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  ThumbnailLoad *load = task_data;
+  const char *thumbnail_path;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  thumbnail_path = g_file_info_get_attribute_byte_string (load->queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
+  pixbuf = gdk_pixbuf_new_from_file_at_size (thumbnail_path, load->size, load->size, &error);
+
+  if (pixbuf)
+    g_task_return_pointer (task, pixbuf, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+file_system_model_got_thumbnail_pixbuf (GObject      *source,
+                                        GAsyncResult *res,
+                                        gpointer      data)
+{
+  ThumbnailLoad *load = data;
+  GdkPixbuf *pixbuf;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (res), NULL);
+
+  if (g_cancellable_is_cancelled (load->cancellable))
+    thumbnail_load_free (load);
+  else
+    thumbnail_load_finish (load, pixbuf);
+
+  g_clear_object (&pixbuf);
+}
+
 static void
 file_system_model_got_thumbnail (GObject      *object,
                                  GAsyncResult *res,
                                  gpointer      data)
 {
-  GtkFileSystemModel *model = data; /* might be unreffed if operation was cancelled */
-  GFile *file = G_FILE (object);
-  GFileInfo *queried, *info;
-  GtkTreeIter iter;
+  ThumbnailLoad *load = data; /* impl might be gone if the load was cancelled */
+  GTask *task;
 
-  queried = g_file_query_info_finish (file, res, NULL);
-  if (queried == NULL)
-    return;
+  load->queried = g_file_query_info_finish (G_FILE (object), res, NULL);
 
-  /* now we know model is valid */
+  if (g_cancellable_is_cancelled (load->cancellable))
+    {
+      thumbnail_load_free (load);
+      return;
+    }
 
-  /* file was deleted */
-  if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
+  if (load->queried == NULL ||
+      !g_file_info_has_attribute (load->queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH))
     {
-      g_object_unref (queried);
+      thumbnail_load_finish (load, NULL);
       return;
     }
 
-  info = g_file_info_dup (_gtk_file_system_model_get_info (model, &iter));
+  task = g_task_new (NULL, load->cancellable, file_system_model_got_thumbnail_pixbuf, load);
+  g_task_set_source_tag (task, file_system_model_got_thumbnail);
+  g_task_set_task_data (task, load, NULL);
+  g_task_run_in_thread (task, load_thumbnail_thread);
+  g_object_unref (task);
+}
 
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAILING_FAILED);
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_STANDARD_ICON);
+static void
+load_thumbnail (GtkFileChooserWidget *impl,
+                GtkFileSystemModel   *model,
+                GFile                *file)
+{
+  ThumbnailLoad *load;
+
+  /* The same file can be shown by the search and the browse models */
+  load = g_hash_table_lookup (impl->priv->thumbnail_loads, file);
+  if (load)
+    {
+      g_cancellable_cancel (load->cancellable);
+      g_hash_table_remove (impl->priv->thumbnail_loads, file);
+    }
 
-  _gtk_file_system_model_update_file (model, file, info);
+  load = g_slice_new0 (ThumbnailLoad);
+  load->impl = impl;
+  load->model = g_object_ref (model);
+  load->file = g_object_ref (file);
+  load->cancellable = g_cancellable_new ();
+  load->size = ICON_SIZE * gtk_widget_get_scale_factor (GTK_WIDGET (impl));
 
-  g_object_unref (info);
-  g_object_unref (queried);
+  g_hash_table_insert (impl->priv->thumbnail_loads, load->file, load);
+
+  g_file_query_info_async (file,
+                           G_FILE_ATTRIBUTE_THUMBNAIL_PATH ","
+                           G_FILE_ATTRIBUTE_THUMBNAILING_FAILED ","
+                           G_FILE_ATTRIBUTE_STANDARD_ICON,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_DEFAULT,
+                           load->cancellable,
+                           file_system_model_got_thumbnail,
+                           load);
+}
+
+static void
+cancel_thumbnail_loads (GtkFileChooserWidget *impl)
+{
+  GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, priv->thumbnail_loads);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ThumbnailLoad *load = value;
+
+      g_cancellable_cancel (load->cancellable);
+      g_hash_table_iter_remove (&iter);
+    }
+}
+
+/* Returns whether the row for @file in @model is shown in the file
+ * list, counting one row above and below the visible ones */
+static gboolean
+file_list_row_is_visible (GtkFileChooserWidget *impl,
+                          GtkFileSystemModel   *model,
+                          GFile                *file)
+{
+  GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GtkTreeModel *tree_model;
+  GtkTreePath *start, *end, *path;
+  GtkTreeIter iter;
+  gboolean visible;
+
+  tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (priv->browse_files_tree_view));
+  if (tree_model != GTK_TREE_MODEL (model))
+    return FALSE;
+
+  if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
+    return FALSE;
+
+  if (!gtk_tree_view_get_visible_range (GTK_TREE_VIEW (priv->browse_files_tree_view), &start, &end))
+    return TRUE;
+
+  gtk_tree_path_prev (start);
+  gtk_tree_path_next (end);
+  path = gtk_tree_model_get_path (tree_model, &iter);
+  visible = gtk_tree_path_compare (start, path) != 1 &&
+            gtk_tree_path_compare (path, end) != 1;
+  gtk_tree_path_free (path);
+  gtk_tree_path_free (start);
+  gtk_tree_path_free (end);
+
+  return visible;
+}
+
+/* Cancels the thumbnail loads of rows that were scrolled out of view.
+ * They are started again when the rows come back. */
+static void
+browse_files_scrolled (GtkAdjustment        *adjustment,
+                       GtkFileChooserWidget *impl)
+{
+  GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, priv->thumbnail_loads);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ThumbnailLoad *load = value;
+      GtkTreeIter tree_iter;
+
+      if (file_list_row_is_visible (impl, load->model, load->file))
+        continue;
+
+      if (_gtk_file_system_model_get_iter_for_file (load->model, &tree_iter, load->file))
+        g_file_info_remove_attribute (_gtk_file_system_model_get_info (load->model, &tree_iter),
+                                      "filechooser::queried");
+
+      g_cancellable_cancel (load->cancellable);
+      g_hash_table_iter_remove (&iter);
+    }
 }
 
 static gboolean
@@ -4736,55 +4948,24 @@ file_system_model_set (GtkFileSystemModel *model,
     case MODEL_COL_ICON:
       if (info)
         {
-          if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
+          if (g_file_info_has_attribute (info, "filechooser::thumbnail"))
+            {
+              g_value_set_object (value, g_file_info_get_attribute_object (info, "filechooser::thumbnail"));
+            }
+          else if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
             {
               g_value_take_object (value, _gtk_file_info_get_icon (info, ICON_SIZE, gtk_widget_get_scale_factor (GTK_WIDGET (impl))));
             }
           else
             {
-              GtkTreeModel *tree_model;
-              GtkTreePath *start, *end;
-              GtkTreeIter iter;
-              gboolean visible;
-
               if (priv->browse_files_tree_view == NULL ||
                   g_file_info_has_attribute (info, "filechooser::queried"))
                 return FALSE;
 
-              tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (priv->browse_files_tree_view));
-              if (tree_model != GTK_TREE_MODEL (model))
-                return FALSE;
-
-              if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
-                g_assert_not_reached ();
-
-              if (gtk_tree_view_get_visible_range (GTK_TREE_VIEW (priv->browse_files_tree_view), &start, &end))
-                {
-                  GtkTreePath *path;
-
-                  gtk_tree_path_prev (start);
-                  gtk_tree_path_next (end);
-                  path = gtk_tree_model_get_path (tree_model, &iter);
-                  visible = gtk_tree_path_compare (start, path) != 1 &&
-                            gtk_tree_path_compare (path, end) != 1;
-                  gtk_tree_path_free (path);
-                  gtk_tree_path_free (start);
-                  gtk_tree_path_free (end);
-                }
-              else
-                visible = TRUE;
-              if (visible)
+              if (file_list_row_is_visible (impl, model, file))
                 {
                   g_file_info_set_attribute_boolean (info, "filechooser::queried", TRUE);
-                  g_file_query_info_async (file,
-                                           G_FILE_ATTRIBUTE_THUMBNAIL_PATH ","
-                                           G_FILE_ATTRIBUTE_THUMBNAILING_FAILED ","
-                                           G_FILE_ATTRIBUTE_STANDARD_ICON,
-                                           G_FILE_QUERY_INFO_NONE,
-                                           G_PRIORITY_DEFAULT,
-                                           _gtk_file_system_model_get_cancellable (model),
-                                           file_system_model_got_thumbnail,
-                                           model);
+                  load_thumbnail (impl, model, file);
                 }
               return FALSE;
             }
@@ -8381,6 +8562,9 @@ post_process_ui (GtkFileChooserWidget *impl)
    */
   set_icon_cell_renderer_fixed_size (impl);
 
+  g_signal_connect (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (impl->priv->browse_files_swin)),
+                    "value-changed", G_CALLBACK (browse_files_scrolled), impl);
+
   gtk_popover_set_default_widget (GTK_POPOVER (impl->priv->new_folder_popover), impl->priv->new_folder_create_button);
   gtk_popover_set_default_widget (GTK_POPOVER (impl->priv->rename_file_popover), impl->priv->rename_file_rename_button);
   gtk_popover_set_relative_to (GTK_POPOVER (impl->priv->rename_file_popover), impl->priv->browse_files_tree_view);
@@ -8439,6 +8623,7 @@ gtk_file_chooser_widget_init (GtkFileChooserWidget *impl)
   priv->recent_manager = gtk_recent_manager_get_default ();
   priv->create_folders = TRUE;
   priv->auto_selecting_first_row = FALSE;
+  priv->thumbnail_loads = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
 
   /* Ensure GTK+ private types used by the template
    * definition before calling gtk_widget_init_template()
@@ -115,6 +115,9 @@
  * freeze_updates()) during the intial population process.  When the model is
  * frozen, sorting will not happen.  The model will sort itself when the freeze
  * count goes back to zero, via corresponding calls to thaw_updates().
+ * Files added while frozen are sorted on their own at that point and
+ * merged into the already sorted files, so loading a folder in batches
+ * neither re-sorts all of it nor reorders the visible rows per batch.
  */
 
 /*** DEFINES ***/
@@ -826,6 +829,65 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
   model->sort_on_thaw = FALSE;
 }
 
+/* Sorts the nodes starting at @first_new, which must not be visible yet,
+ * and merges them into the already sorted nodes before them. This keeps
+ * the order of the visible rows, so unlike gtk_file_system_model_sort()
+ * no rows-reordered needs to be emitted, and adding a batch of files
+ * costs O(n + k log k) instead of a full sort.
+ *
+ * Returns the smallest index any of the new nodes ended up at. */
+static guint
+gtk_file_system_model_merge_nodes (GtkFileSystemModel *model, guint first_new)
+{
+  SortData data;
+  GArray *files;
+  guint i, j, len, first_changed;
+
+  len = model->files->len;
+  if (first_new >= len || !sort_data_init (&data, model))
+    return first_new;
+
+  if (len - first_new > 1)
+    g_qsort_with_data (get_node (model, first_new),
+                       len - first_new,
+                       model->node_size,
+                       compare_array_element,
+                       &data);
+
+  /* skip the old nodes that sort before all of the new ones */
+  for (i = 1; i < first_new; i++)
+    {
+      if (compare_array_element (get_node (model, first_new), get_node (model, i), &data) < 0)
+        break;
+    }
+  if (i == first_new)
+    return first_new;
+
+  first_changed = i;
+  files = g_array_sized_new (FALSE, FALSE, model->node_size, len);
+  g_array_append_vals (files, get_node (model, 0), first_changed);
+
+  j = first_new;
+  while (i < first_new && j < len)
+    {
+      if (compare_array_element (get_node (model, j), get_node (model, i), &data) < 0)
+        g_array_append_vals (files, get_node (model, j++), 1);
+      else
+        g_array_append_vals (files, get_node (model, i++), 1);
+    }
+  g_array_append_vals (files, get_node (model, i), first_new - i);
+  g_array_append_vals (files, get_node (model, j), len - j);
+
+  /* the nodes were moved, so don't free their contents */
+  g_array_free (model->files, TRUE);
+  model->files = files;
+
+  model->n_nodes_valid = MIN (model->n_nodes_valid, first_changed);
+  g_hash_table_remove_all (model->file_lookup);
+
+  return first_changed;
+}
+
 static void
 gtk_file_system_model_sort_node (GtkFileSystemModel *model, guint node)
 {
@@ -1852,10 +1914,10 @@ add_file (GtkFileSystemModel *model,
   g_array_append_vals (model->files, node, 1);
   g_slice_free1 (model->node_size, node);
 
+  /* When frozen, thaw_updates() merges all the new files at once */
   if (!model->frozen)
-    node_compute_visibility_and_filters (model, model->files->len -1);
-
-  gtk_file_system_model_sort_node (model, model->files->len -1);
+    node_compute_visibility_and_filters (model,
+                                         gtk_file_system_model_merge_nodes (model, model->files->len - 1));
 }
 
 /**
@@ -2025,6 +2087,7 @@ static void
 thaw_updates (GtkFileSystemModel *model)
 {
   gboolean stuff_added;
+  guint first_new;
 
   g_return_if_fail (GTK_IS_FILE_SYSTEM_MODEL (model));
   g_return_if_fail (model->frozen > 0);
@@ -2038,12 +2101,28 @@ thaw_updates (GtkFileSystemModel *model)
   if (model->filter_on_thaw)
     gtk_file_system_model_refilter_all (model);
   if (model->sort_on_thaw)
-    gtk_file_system_model_sort (model);
+    {
+      gtk_file_system_model_sort (model);
+      first_new = 1;
+    }
+  else if (stuff_added)
+    {
+      /* Files added while frozen were appended, so they are at the end */
+      first_new = model->files->len;
+      while (get_node (model, first_new - 1)->frozen_add)
+        first_new--;
+      first_new = gtk_file_system_model_merge_nodes (model, first_new);
+    }
+  else
+    first_new = 1;
+
   if (stuff_added)
     {
       guint i;
 
-      for (i = 0; i < model->files->len; i++)
+      /* Going in index order makes each row-inserted only need to
+       * revalidate the rows since the previous one. */
+      for (i = first_new; i < model->files->len; i++)
         {
           FileModelNode *node = get_node (model, i);
 
@@ -21,7 +21,7 @@
 
 #include "gtkfilterlistmodel.h"
 
-#include "gtkrbtreeprivate.h"
+#include "gtkbitsetprivate.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
 
@@ -35,30 +35,27 @@
  * listmodel.
  * It hides some elements from the other model according to
  * criteria given by a #GtkFilterListModelFilterFunc.
+ *
+ * When the filter changes, #GtkFilterListModel can refilter the items
+ * incrementally, see gtk_filter_list_model_set_incremental(). If the
+ * filter only got more or less strict, use
+ * gtk_filter_list_model_filter_changed() so only the items that can
+ * change are filtered again.
  */
 
+/* Time to spend refiltering in one go when refiltering incrementally */
+#define REFILTER_STEP_TIME (G_USEC_PER_SEC / 1000)
+
 enum {
   PROP_0,
   PROP_HAS_FILTER,
+  PROP_INCREMENTAL,
   PROP_ITEM_TYPE,
   PROP_MODEL,
+  PROP_PENDING,
   NUM_PROPERTIES
 };
 
-typedef struct _FilterNode FilterNode;
-typedef struct _FilterAugment FilterAugment;
-
-struct _FilterNode
-{
-  guint visible : 1;
-};
-
-struct _FilterAugment
-{
-  guint n_items;
-  guint n_visible;
-};
-
 struct _GtkFilterListModel
 {
   GObject parent_instance;
@@ -69,7 +66,12 @@ struct _GtkFilterListModel
   gpointer user_data;
   GDestroyNotify user_destroy;
 
-  GtkRbTree *items; /* NULL if filter_func == NULL */
+  GtkBitset *items; /* NULL if filter_func == NULL, the visible items */
+
+  gboolean incremental;
+  guint refilter_cb; /* 0 if not incrementally refiltering */
+  guint refilter_position; /* first item that still needs to be refiltered */
+  GtkFilterListModelChange refilter_change;
 };
 
 struct _GtkFilterListModelClass
@@ -79,92 +81,6 @@ struct _GtkFilterListModelClass
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
-static FilterNode *
-gtk_filter_list_model_get_nth_filtered (GtkRbTree *tree,
-                                        guint      position,
-                                        guint     *out_unfiltered)
-{
-  FilterNode *node, *tmp;
-  guint unfiltered;
-
-  node = gtk_rb_tree_get_root (tree);
-  unfiltered = 0;
-
-  while (node)
-    {
-      tmp = gtk_rb_tree_node_get_left (node);
-      if (tmp)
-        {
-          FilterAugment *aug = gtk_rb_tree_get_augment (tree, tmp);
-          if (position < aug->n_visible)
-            {
-              node = tmp;
-              continue;
-            }
-          position -= aug->n_visible;
-          unfiltered += aug->n_items;
-        }
-
-      if (node->visible)
-        {
-          if (position == 0)
-            break;
-          position--;
-        }
-
-      unfiltered++;
-
-      node = gtk_rb_tree_node_get_right (node);
-    }
-
-  if (out_unfiltered)
-    *out_unfiltered = unfiltered;
-
-  return node;
-}
-
-static FilterNode *
-gtk_filter_list_model_get_nth (GtkRbTree *tree,
-                               guint      position,
-                               guint     *out_filtered)
-{
-  FilterNode *node, *tmp;
-  guint filtered;
-
-  node = gtk_rb_tree_get_root (tree);
-  filtered = 0;
-
-  while (node)
-    {
-      tmp = gtk_rb_tree_node_get_left (node);
-      if (tmp)
-        {
-          FilterAugment *aug = gtk_rb_tree_get_augment (tree, tmp);
-          if (position < aug->n_items)
-            {
-              node = tmp;
-              continue;
-            }
-          position -= aug->n_items;
-          filtered += aug->n_visible;
-        }
-
-      if (position == 0)
-        break;
-
-      position--;
-      if (node->visible)
-        filtered++;
-
-      node = gtk_rb_tree_node_get_right (node);
-    }
-
-  if (out_filtered)
-    *out_filtered = filtered;
-
-  return node;
-}
-
 static GType
 gtk_filter_list_model_get_item_type (GListModel *list)
 {
@@ -177,8 +93,6 @@ static guint
 gtk_filter_list_model_get_n_items (GListModel *list)
 {
   GtkFilterListModel *self = GTK_FILTER_LIST_MODEL (list);
-  FilterAugment *aug;
-  FilterNode *node;
 
   if (self->model == NULL)
     return 0;
@@ -186,12 +100,7 @@ gtk_filter_list_model_get_n_items (GListModel *list)
   if (!self->items)
     return g_list_model_get_n_items (self->model);
 
-  node = gtk_rb_tree_get_root (self->items);
-  if (node == NULL)
-    return 0;
-
-  aug = gtk_rb_tree_get_augment (self->items, node);
-  return aug->n_visible;
+  return gtk_bitset_get_n_set (self->items);
 }
 
 static gpointer
@@ -205,7 +114,11 @@ gtk_filter_list_model_get_item (GListModel *list,
     return NULL;
 
   if (self->items)
-    gtk_filter_list_model_get_nth_filtered (self->items, position, &unfiltered);
+    {
+      unfiltered = gtk_bitset_select (self->items, position);
+      if (unfiltered == G_MAXUINT)
+        return NULL;
+    }
   else
     unfiltered = position;
 
@@ -237,28 +150,122 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   return visible;
 }
 
+/* Filters the items that were inserted into the bitset
+ * at position, returns the number of visible ones */
 static guint
 gtk_filter_list_model_add_items (GtkFilterListModel *self,
-                                 FilterNode         *after,
                                  guint               position,
                                  guint               n_items)
 {
-  FilterNode *node;
   guint i, n_visible;
 
   n_visible = 0;
-  
+
   for (i = 0; i < n_items; i++)
     {
-      node = gtk_rb_tree_insert_before (self->items, after);
-      node->visible = gtk_filter_list_model_run_filter (self, position + i);
-      if (node->visible)
-        n_visible++;
+      if (gtk_filter_list_model_run_filter (self, position + i))
+        {
+          gtk_bitset_set (self->items, position + i, TRUE);
+          n_visible++;
+        }
     }
 
   return n_visible;
 }
 
+/* Refilters the items starting at refilter_position that can have changed
+ * until end_time has passed. Returns TRUE when all items are done. */
+static gboolean
+gtk_filter_list_model_refilter_step (GtkFilterListModel *self,
+                                     gint64              end_time)
+{
+  guint i, n, n_items, filter_start, first_change, last_change;
+  guint n_is_visible, n_was_visible;
+  gboolean visible, was_visible;
+
+  n_items = gtk_bitset_get_size (self->items);
+  filter_start = gtk_bitset_rank (self->items, self->refilter_position);
+
+  first_change = G_MAXUINT;
+  last_change = 0;
+  n_is_visible = 0;
+  n_was_visible = 0;
+  for (i = self->refilter_position, n = 0; i < n_items; i++)
+    {
+      if ((++n % 64) == 0 && g_get_monotonic_time () >= end_time)
+        break;
+
+      was_visible = gtk_bitset_get (self->items, i);
+
+      /* A stricter filter can't make hidden items visible and
+       * a less strict one can't hide visible items. */
+      if ((self->refilter_change == GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT && !was_visible) ||
+          (self->refilter_change == GTK_FILTER_LIST_MODEL_CHANGE_LESS_STRICT && was_visible))
+        visible = was_visible;
+      else
+        visible = gtk_filter_list_model_run_filter (self, i);
+
+      if (visible == was_visible)
+        {
+          if (visible)
+            {
+              n_is_visible++;
+              n_was_visible++;
+            }
+          continue;
+        }
+
+      gtk_bitset_set (self->items, i, visible);
+      first_change = MIN (n_is_visible, first_change);
+      if (visible)
+        n_is_visible++;
+      else
+        n_was_visible++;
+      last_change = MAX (n_is_visible, last_change);
+    }
+
+  self->refilter_position = i;
+
+  if (first_change <= last_change)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self),
+                                  filter_start + first_change,
+                                  last_change - first_change + n_was_visible - n_is_visible,
+                                  last_change - first_change);
+    }
+
+  return i == n_items;
+}
+
+static void
+gtk_filter_list_model_stop_refiltering (GtkFilterListModel *self)
+{
+  if (self->refilter_cb == 0)
+    return;
+
+  g_clear_handle_id (&self->refilter_cb, g_source_remove);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
+static gboolean
+gtk_filter_list_model_refilter_cb (gpointer data)
+{
+  GtkFilterListModel *self = data;
+
+  if (gtk_filter_list_model_refilter_step (self, g_get_monotonic_time () + REFILTER_STEP_TIME))
+    {
+      /* Don't remove the source twice */
+      self->refilter_cb = 0;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return G_SOURCE_REMOVE;
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+  return G_SOURCE_CONTINUE;
+}
+
 static void
 gtk_filter_list_model_items_changed_cb (GListModel         *model,
                                         guint               position,
@@ -266,8 +273,7 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
                                         guint               added,
                                         GtkFilterListModel *self)
 {
-  FilterNode *node;
-  guint i, filter_position, filter_removed, filter_added;
+  guint filter_position, filter_removed, filter_added;
 
   if (self->items == NULL)
     {
@@ -275,20 +281,21 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
       return;
     }
 
-  node = gtk_filter_list_model_get_nth (self->items, position, &filter_position);
+  filter_position = gtk_bitset_rank (self->items, position);
+  filter_removed = gtk_bitset_rank (self->items, position + removed) - filter_position;
 
-  filter_removed = 0;
-  for (i = 0; i < removed; i++)
+  gtk_bitset_splice (self->items, position, removed, added);
+  filter_added = gtk_filter_list_model_add_items (self, position, added);
+
+  /* The added items have been filtered already */
+  if (self->refilter_cb && position < self->refilter_position)
     {
-      FilterNode *next = gtk_rb_tree_node_get_next (node);
-      if (node->visible)
-        filter_removed++;
-      gtk_rb_tree_remove (self->items, node);
-      node = next;
+      if (position + removed <= self->refilter_position)
+        self->refilter_position = self->refilter_position - removed + added;
+      else
+        self->refilter_position = position + added;
     }
 
-  filter_added = gtk_filter_list_model_add_items (self, node, position, added);
-
   if (filter_removed > 0 || filter_added > 0)
     g_list_model_items_changed (G_LIST_MODEL (self), filter_position, filter_removed, filter_added);
 }
@@ -303,6 +310,10 @@ gtk_filter_list_model_set_property (GObject      *object,
 
   switch (prop_id)
     {
+    case PROP_INCREMENTAL:
+      gtk_filter_list_model_set_incremental (self, g_value_get_boolean (value));
+      break;
+
     case PROP_ITEM_TYPE:
       self->item_type = g_value_get_gtype (value);
       break;
@@ -331,6 +342,10 @@ gtk_filter_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->items != NULL);
       break;
 
+    case PROP_INCREMENTAL:
+      g_value_set_boolean (value, self->incremental);
+      break;
+
     case PROP_ITEM_TYPE:
       g_value_set_gtype (value, self->item_type);
       break;
@@ -339,6 +354,10 @@ gtk_filter_list_model_get_property (GObject     *object,
       g_value_set_object (value, self->model);
       break;
 
+    case PROP_PENDING:
+      g_value_set_uint (value, gtk_filter_list_model_get_pending (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -351,10 +370,11 @@ gtk_filter_list_model_clear_model (GtkFilterListModel *self)
   if (self->model == NULL)
     return;
 
+  gtk_filter_list_model_stop_refiltering (self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_items_changed_cb, self);
   g_clear_object (&self->model);
   if (self->items)
-    gtk_rb_tree_remove_all (self->items);
+    gtk_bitset_splice (self->items, 0, gtk_bitset_get_size (self->items), 0);
 }
 
 static void
@@ -368,7 +388,7 @@ gtk_filter_list_model_dispose (GObject *object)
   self->filter_func = NULL;
   self->user_data = NULL;
   self->user_destroy = NULL;
-  g_clear_pointer (&self->items, gtk_rb_tree_unref);
+  g_clear_pointer (&self->items, gtk_bitset_free);
 
   G_OBJECT_CLASS (gtk_filter_list_model_parent_class)->dispose (object);
 }
@@ -394,6 +414,18 @@ gtk_filter_list_model_class_init (GtkFilterListModelClass *class)
                             FALSE,
                             GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkFilterListModel:incremental:
+   *
+   * If the model should refilter items incrementally
+   */
+  properties[PROP_INCREMENTAL] =
+      g_param_spec_boolean ("incremental",
+                            P_("Incremental"),
+                            P_("Filter items incrementally"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkFilterListModel:item-type:
    *
@@ -418,6 +450,18 @@ gtk_filter_list_model_class_init (GtkFilterListModelClass *class)
                            G_TYPE_LIST_MODEL,
                            GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkFilterListModel:pending:
+   *
+   * Number of items not yet filtered
+   */
+  properties[PROP_PENDING] =
+      g_param_spec_uint ("pending",
+                         P_("Pending"),
+                         P_("Number of items not yet filtered"),
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -427,33 +471,6 @@ gtk_filter_list_model_init (GtkFilterListModel *self)
 }
 
 
-static void
-gtk_filter_list_model_augment (GtkRbTree *filter,
-                               gpointer   _aug,
-                               gpointer   _node,
-                               gpointer   left,
-                               gpointer   right)
-{
-  FilterNode *node = _node;
-  FilterAugment *aug = _aug;
-
-  aug->n_items = 1;
-  aug->n_visible = node->visible ? 1 : 0;
-
-  if (left)
-    {
-      FilterAugment *left_aug = gtk_rb_tree_get_augment (filter, left);
-      aug->n_items += left_aug->n_items;
-      aug->n_visible += left_aug->n_visible;
-    }
-  if (right)
-    {
-      FilterAugment *right_aug = gtk_rb_tree_get_augment (filter, right);
-      aug->n_items += right_aug->n_items;
-      aug->n_visible += right_aug->n_visible;
-    }
-}
-
 /**
  * gtk_filter_list_model_new:
  * @model: the model to sort
@@ -543,24 +560,19 @@ gtk_filter_list_model_set_filter_func (GtkFilterListModel           *self,
   
   if (!will_be_filtered)
     {
-      g_clear_pointer (&self->items, gtk_rb_tree_unref);
+      gtk_filter_list_model_stop_refiltering (self);
+      g_clear_pointer (&self->items, gtk_bitset_free);
     }
   else if (!was_filtered)
     {
-      guint i, n_items;
+      guint n_items;
 
-      self->items = gtk_rb_tree_new (FilterNode,
-                                     FilterAugment,
-                                     gtk_filter_list_model_augment,
-                                     NULL, NULL);
+      self->items = gtk_bitset_new ();
       if (self->model)
         {
           n_items = g_list_model_get_n_items (self->model);
-          for (i = 0; i < n_items; i++)
-            {
-              FilterNode *node = gtk_rb_tree_insert_before (self->items, NULL);
-              node->visible = TRUE;
-            }
+          gtk_bitset_splice (self->items, 0, 0, n_items);
+          gtk_bitset_set_range (self->items, 0, n_items, TRUE);
         }
     }
 
@@ -604,7 +616,11 @@ gtk_filter_list_model_set_model (GtkFilterListModel *self,
       self->model = g_object_ref (model);
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_filter_list_model_items_changed_cb), self);
       if (self->items)
-        added = gtk_filter_list_model_add_items (self, NULL, 0, g_list_model_get_n_items (model));
+        {
+          added = g_list_model_get_n_items (model);
+          gtk_bitset_splice (self->items, 0, 0, added);
+          added = gtk_filter_list_model_add_items (self, 0, added);
+        }
       else
         added = g_list_model_get_n_items (model);
     }
@@ -661,51 +677,149 @@ gtk_filter_list_model_has_filter (GtkFilterListModel *self)
 void
 gtk_filter_list_model_refilter (GtkFilterListModel *self)
 {
-  FilterNode *node;
-  guint i, first_change, last_change;
-  guint n_is_visible, n_was_visible;
-  gboolean visible;
+  g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
 
+  gtk_filter_list_model_filter_changed (self, GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT);
+}
+
+/**
+ * gtk_filter_list_model_filter_changed:
+ * @self: a #GtkFilterListModel
+ * @change: How the filter changed
+ *
+ * Causes @self to refilter the items in the model that may be
+ * affected by a change of the filter function.
+ *
+ * If the filter got stricter, only the items that are visible need to
+ * be filtered again; if it got less strict, only the hidden ones. Use
+ * %GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT if you don't know, which is
+ * the same as calling gtk_filter_list_model_refilter().
+ **/
+void
+gtk_filter_list_model_filter_changed (GtkFilterListModel       *self,
+                                      GtkFilterListModelChange  change)
+{
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
-  
+
   if (self->items == NULL || self->model == NULL)
     return;
 
-  first_change = G_MAXUINT;
-  last_change = 0;
-  n_is_visible = 0;
-  n_was_visible = 0;
-  for (i = 0, node = gtk_rb_tree_get_first (self->items);
-       node != NULL;
-       i++, node = gtk_rb_tree_node_get_next (node))
+  if (self->refilter_cb)
     {
-      visible = gtk_filter_list_model_run_filter (self, i);
-      if (visible == node->visible)
-        {
-          if (visible)
-            {
-              n_is_visible++;
-              n_was_visible++;
-            }
-          continue;
-        }
+      /* Items that have already been refiltered can have changed
+       * again, so start over. */
+      if (self->refilter_change != change)
+        change = GTK_FILTER_LIST_MODEL_CHANGE_DIFFERENT;
+    }
 
-      node->visible = visible;
-      gtk_rb_tree_node_mark_dirty (node);
-      first_change = MIN (n_is_visible, first_change);
-      if (visible)
-        n_is_visible++;
-      else
-        n_was_visible++;
-      last_change = MAX (n_is_visible, last_change);
+  self->refilter_position = 0;
+  self->refilter_change = change;
+
+  if (!self->incremental)
+    {
+      gtk_filter_list_model_refilter_step (self, G_MAXINT64);
+      gtk_filter_list_model_stop_refiltering (self);
+      return;
     }
 
-  if (first_change <= last_change)
+  if (self->refilter_cb == 0)
     {
-      g_list_model_items_changed (G_LIST_MODEL (self),
-                                  first_change,
-                                  last_change - first_change + n_was_visible - n_is_visible,
-                                  last_change - first_change);
+      self->refilter_cb = g_idle_add (gtk_filter_list_model_refilter_cb, self);
+      g_source_set_name_by_id (self->refilter_cb, "[gtk] gtk_filter_list_model_refilter_cb");
     }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
 }
 
+/**
+ * gtk_filter_list_model_set_incremental:
+ * @self: a #GtkFilterListModel
+ * @incremental: %TRUE to enable incremental filtering
+ *
+ * When incremental filtering is enabled, the filterlistmodel will not
+ * run filters immediately when the filter changes, but will instead
+ * queue an idle handler that incrementally filters the items and adds
+ * them to the list. This of course means that items are not instantly
+ * added to the list, but only appear incrementally.
+ *
+ * When your filter blocks the UI while filtering, you might consider
+ * turning this on. Depending on your model and filters, this may become
+ * interesting around 10,000 to 100,000 items.
+ *
+ * By default, incremental filtering is disabled.
+ *
+ * See gtk_filter_list_model_get_pending() for progress information
+ * about an ongoing incremental filtering operation.
+ **/
+void
+gtk_filter_list_model_set_incremental (GtkFilterListModel *self,
+                                       gboolean            incremental)
+{
+  g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
+
+  incremental = !!incremental;
+
+  if (self->incremental == incremental)
+    return;
+
+  self->incremental = incremental;
+
+  /* Finish an ongoing refilter right away */
+  if (!incremental && self->refilter_cb)
+    {
+      gtk_filter_list_model_refilter_step (self, G_MAXINT64);
+      gtk_filter_list_model_stop_refiltering (self);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INCREMENTAL]);
+}
+
+/**
+ * gtk_filter_list_model_get_incremental:
+ * @self: a #GtkFilterListModel
+ *
+ * Returns whether incremental filtering was enabled via
+ * gtk_filter_list_model_set_incremental().
+ *
+ * Returns: %TRUE if incremental filtering is enabled
+ **/
+gboolean
+gtk_filter_list_model_get_incremental (GtkFilterListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_FILTER_LIST_MODEL (self), FALSE);
+
+  return self->incremental;
+}
+
+/**
+ * gtk_filter_list_model_get_pending:
+ * @self: a #GtkFilterListModel
+ *
+ * Returns the number of items that have not been filtered yet.
+ *
+ * You can use this value to check if @self is busy filtering by
+ * comparing the return value to 0 or you can compute the percentage
+ * of the filter remaining by dividing the return value by the total
+ * number of items in the underlying model:
+ *
+ * |[<!-- language="C" -->
+ *   pending = gtk_filter_list_model_get_pending (self);
+ *   model = gtk_filter_list_model_get_model (self);
+ *   percentage = pending / (double) g_list_model_get_n_items (model);
+ * ]|
+ *
+ * If no filter operation is ongoing - in particular when
+ * #GtkFilterListModel:incremental is %FALSE - this function returns 0.
+ *
+ * Returns: The number of items not yet filtered
+ **/
+guint
+gtk_filter_list_model_get_pending (GtkFilterListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_FILTER_LIST_MODEL (self), 0);
+
+  if (self->refilter_cb == 0)
+    return 0;
+
+  return g_list_model_get_n_items (self->model) - self->refilter_position;
+}
@@ -277,6 +277,22 @@ gtk_flatten_list_model_augment (GtkRbTree *flatten,
     }
 }
 
+static guint
+gtk_flatten_list_model_init_node (GtkFlattenListModel *self,
+                                  FlattenNode         *node,
+                                  guint                position)
+{
+  node->model = g_list_model_get_item (self->model, position);
+  g_warn_if_fail (g_type_is_a (g_list_model_get_item_type (node->model), self->item_type));
+  g_signal_connect (node->model,
+                    "items-changed",
+                    G_CALLBACK (gtk_flatten_list_model_items_changed_cb),
+                    node);
+  node->list = self;
+
+  return g_list_model_get_n_items (node->model);
+}
+
 static guint
 gtk_flatten_list_model_add_items (GtkFlattenListModel *self,
                                   FlattenNode         *after,
@@ -287,17 +303,20 @@ gtk_flatten_list_model_add_items (GtkFlattenListModel *self,
   guint added, i;
 
   added = 0;
+
+  if (gtk_rb_tree_get_root (self->items) == NULL)
+    {
+      node = gtk_rb_tree_build (self->items, n);
+      for (i = 0; i < n; i++, node = gtk_rb_tree_node_get_next (node))
+        added += gtk_flatten_list_model_init_node (self, node, position + i);
+
+      return added;
+    }
+
   for (i = 0; i < n; i++)
     {
       node = gtk_rb_tree_insert_before (self->items, after);
-      node->model = g_list_model_get_item (self->model, position + i);
-      g_warn_if_fail (g_type_is_a (g_list_model_get_item_type (node->model), self->item_type));
-      g_signal_connect (node->model,
-                        "items-changed",
-                        G_CALLBACK (gtk_flatten_list_model_items_changed_cb),
-                        node);
-      node->list = self;
-      added +=g_list_model_get_n_items (node->model);
+      added += gtk_flatten_list_model_init_node (self, node, position + i);
     }
 
   return added;
@@ -128,6 +128,16 @@ static void gtk_flow_box_set_accept_unpaired_release (GtkFlowBox *box,
                                                       gboolean    accept);
 
 static void gtk_flow_box_check_model_compat  (GtkFlowBox *box);
+static void gtk_flow_box_ensure_bound_children (GtkFlowBox *box,
+                                                guint       n_children);
+static void gtk_flow_box_check_bound_children  (GtkFlowBox *box);
+static void gtk_flow_box_measure_children (GtkWidget      *widget,
+                                           GtkOrientation  orientation,
+                                           int             for_size,
+                                           int            *minimum,
+                                           int            *natural,
+                                           int            *minimum_baseline,
+                                           int            *natural_baseline);
 
 static void
 get_current_selection_modifiers (GtkWidget *widget,
@@ -645,8 +655,14 @@ struct _GtkFlowBoxPrivate {
   GtkFlowBoxCreateWidgetFunc  create_widget_func;
   gpointer                    create_widget_func_data;
   GDestroyNotify              create_widget_func_data_destroy;
+  guint                       n_bound_children; /* children exist for the first n_bound_children items */
+  guint                       bound_children_id;
+  gint                        bound_children_end;
 };
 
+/* Time budget for creating children of a bound model in one idle step */
+#define BOUND_CHILDREN_STEP_TIME (G_USEC_PER_SEC / 200)
+
 #define BOX_PRIV(box) ((GtkFlowBoxPrivate*)gtk_flow_box_get_instance_private ((GtkFlowBox*)(box)))
 
 G_DEFINE_TYPE_WITH_CODE (GtkFlowBox, gtk_flow_box, GTK_TYPE_CONTAINER,
@@ -1390,6 +1406,23 @@ gtk_flow_box_size_allocate (GtkWidget *widget,
       line_spacing = priv->column_spacing;
     }
 
+  /* Our size includes an estimate for the items of a bound model that
+   * don't have children yet, don't spread the existing lines over it.
+   */
+  if (priv->bound_model &&
+      priv->n_bound_children < g_list_model_get_n_items (priv->bound_model))
+    {
+      gint min_other_size, nat_other_size;
+
+      gtk_flow_box_measure_children (widget, OPPOSITE_ORIENTATION (priv->orientation), avail_size,
+                                     &min_other_size, &nat_other_size,
+                                     NULL, NULL);
+      avail_other_size = MIN (avail_other_size, min_other_size);
+    }
+
+  priv->bound_children_end = avail_other_size;
+  gtk_flow_box_check_bound_children (box);
+
   item_align = ORIENTATION_ALIGN (box);
   line_align = OPPOSING_ORIENTATION_ALIGN (box);
 
@@ -1777,13 +1810,13 @@ get_largest_aligned_line_length (GtkFlowBox     *box,
 }
 
 static void
-gtk_flow_box_measure (GtkWidget      *widget,
-                      GtkOrientation  orientation,
-                      int             for_size,
-                      int            *minimum,
-                      int            *natural,
-                      int            *minimum_baseline,
-                      int            *natural_baseline)
+gtk_flow_box_measure_children (GtkWidget      *widget,
+                               GtkOrientation  orientation,
+                               int             for_size,
+                               int            *minimum,
+                               int            *natural,
+                               int            *minimum_baseline,
+                               int            *natural_baseline)
 {
   GtkFlowBox *box = GTK_FLOW_BOX (widget);
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
@@ -1858,16 +1891,16 @@ gtk_flow_box_measure (GtkWidget      *widget,
               gint min_height;
               int dummy;
 
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_VERTICAL,
-                                    -1,
-                                    &min_height, &dummy,
-                                    NULL, NULL);
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_HORIZONTAL,
-                                    min_height,
-                                    &min_width, &nat_width,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_VERTICAL,
+                                             -1,
+                                             &min_height, &dummy,
+                                             NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_HORIZONTAL,
+                                             min_height,
+                                             &min_width, &nat_width,
+                                             NULL, NULL);
             }
 
           *minimum = min_width;
@@ -1888,11 +1921,11 @@ gtk_flow_box_measure (GtkWidget      *widget,
           if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
             {
               /* Return the minimum width */
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_HORIZONTAL,
-                                    -1,
-                                    &min_width, &nat_width,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_HORIZONTAL,
+                                             -1,
+                                             &min_width, &nat_width,
+                                             NULL, NULL);
             }
           else /* GTK_ORIENTATION_VERTICAL */
             {
@@ -1906,11 +1939,11 @@ gtk_flow_box_measure (GtkWidget      *widget,
                 goto out_width;
 
               /* Make sure its no smaller than the minimum */
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_VERTICAL,
-                                    -1,
-                                    &min_height, &dummy,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_VERTICAL,
+                                             -1,
+                                             &min_height, &dummy,
+                                             NULL, NULL);
 
               avail_size = MAX (for_size, min_height);
               if (avail_size <= 0)
@@ -2049,16 +2082,16 @@ gtk_flow_box_measure (GtkWidget      *widget,
               gint min_width;
               int dummy;
 
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_HORIZONTAL,
-                                    -1,
-                                    &min_width, &dummy,
-                                   NULL, NULL);
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_VERTICAL,
-                                    min_width,
-                                    &min_height, &nat_height,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_HORIZONTAL,
+                                             -1,
+                                             &min_width, &dummy,
+                                            NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_VERTICAL,
+                                             min_width,
+                                             &min_height, &nat_height,
+                                             NULL, NULL);
             }
           else /* GTK_ORIENTATION_VERTICAL */
             {
@@ -2144,11 +2177,11 @@ gtk_flow_box_measure (GtkWidget      *widget,
                 goto out_height;
 
               /* Make sure its no smaller than the minimum */
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_HORIZONTAL,
-                                    -1,
-                                    &min_width, &dummy,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_HORIZONTAL,
+                                             -1,
+                                             &min_width, &dummy,
+                                             NULL, NULL);
 
               avail_size = MAX (for_size, min_width);
               if (avail_size <= 0)
@@ -2268,11 +2301,11 @@ gtk_flow_box_measure (GtkWidget      *widget,
           else /* GTK_ORIENTATION_VERTICAL */
             {
               /* Return the minimum height */
-              gtk_flow_box_measure (widget,
-                                    GTK_ORIENTATION_VERTICAL,
-                                    -1,
-                                    &min_height, &nat_height,
-                                    NULL, NULL);
+              gtk_flow_box_measure_children (widget,
+                                             GTK_ORIENTATION_VERTICAL,
+                                             -1,
+                                             &min_height, &nat_height,
+                                             NULL, NULL);
             }
 
          out_height:
@@ -2282,6 +2315,39 @@ gtk_flow_box_measure (GtkWidget      *widget,
     }
 }
 
+/* The lines of a bound model that don't have children yet are assumed
+ * to be as big as the existing ones, so the size stays roughly the same
+ * while the children get created.
+ */
+static void
+gtk_flow_box_measure (GtkWidget      *widget,
+                      GtkOrientation  orientation,
+                      int             for_size,
+                      int            *minimum,
+                      int            *natural,
+                      int            *minimum_baseline,
+                      int            *natural_baseline)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+  guint n_items;
+
+  gtk_flow_box_measure_children (widget, orientation, for_size,
+                                 minimum, natural,
+                                 minimum_baseline, natural_baseline);
+
+  if (priv->bound_model == NULL ||
+      priv->n_bound_children == 0 ||
+      orientation == priv->orientation)
+    return;
+
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  if (n_items > priv->n_bound_children)
+    {
+      *minimum = (gint64) *minimum * n_items / priv->n_bound_children;
+      *natural = (gint64) *natural * n_items / priv->n_bound_children;
+    }
+}
+
 /* Drawing {{{3 */
 
 static void
@@ -3096,7 +3162,10 @@ gtk_flow_box_move_cursor (GtkFlowBox      *box,
       if (count < 0)
         iter = gtk_flow_box_get_first_focusable (box);
       else
-        iter = gtk_flow_box_get_last_focusable (box);
+        {
+          gtk_flow_box_ensure_bound_children (box, G_MAXUINT);
+          iter = gtk_flow_box_get_last_focusable (box);
+        }
       if (iter != NULL)
         child = g_sequence_get (iter);
       break;
@@ -3343,6 +3412,11 @@ gtk_flow_box_finalize (GObject *obj)
     priv->sort_destroy (priv->sort_data);
 
   g_sequence_free (priv->children);
+  g_clear_handle_id (&priv->bound_children_id, g_source_remove);
+  if (priv->hadjustment)
+    g_signal_handlers_disconnect_by_func (priv->hadjustment, gtk_flow_box_check_bound_children, obj);
+  if (priv->vadjustment)
+    g_signal_handlers_disconnect_by_func (priv->vadjustment, gtk_flow_box_check_bound_children, obj);
   g_clear_object (&priv->hadjustment);
   g_clear_object (&priv->vadjustment);
 
@@ -3745,6 +3819,146 @@ gtk_flow_box_init (GtkFlowBox *box)
   gtk_widget_add_controller (GTK_WIDGET (box), controller);
 }
 
+static void
+gtk_flow_box_create_bound_child (GtkFlowBox *box,
+                                 guint       position)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GObject *item;
+  GtkWidget *widget;
+
+  item = g_list_model_get_item (priv->bound_model, position);
+  widget = priv->create_widget_func (item, priv->create_widget_func_data);
+
+  /* We need to sink the floating reference here, so that we can accept
+   * both instances created with a floating reference (e.g. C functions
+   * that just return the result of g_object_new()) and without (e.g.
+   * from language bindings which will automatically sink the floating
+   * reference).
+   *
+   * See the similar code in gtklistbox.c:gtk_list_box_create_bound_row.
+   */
+  if (g_object_is_floating (widget))
+    g_object_ref_sink (widget);
+
+  gtk_widget_show (widget);
+  gtk_flow_box_insert (box, widget, position);
+  priv->n_bound_children++;
+
+  g_object_unref (widget);
+  g_object_unref (item);
+}
+
+static void
+gtk_flow_box_ensure_bound_children (GtkFlowBox *box,
+                                    guint       n_children)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model == NULL)
+    return;
+
+  n_children = MIN (n_children, g_list_model_get_n_items (priv->bound_model));
+
+  while (priv->n_bound_children < n_children)
+    gtk_flow_box_create_bound_child (box, priv->n_bound_children);
+}
+
+/* Lines stack in the opposite direction of the box orientation,
+ * so that's the adjustment that scrolls them into view.
+ */
+static GtkAdjustment *
+gtk_flow_box_get_line_adjustment (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    return priv->vadjustment;
+  else
+    return priv->hadjustment;
+}
+
+/* Returns the position that the children of a bound model need
+ * to reach, that is the end of the visible area plus a page, or
+ * G_MAXINT if all children are needed.
+ */
+static gint
+gtk_flow_box_get_bound_children_target (GtkFlowBox *box)
+{
+  GtkAdjustment *adjustment = gtk_flow_box_get_line_adjustment (box);
+
+  if (adjustment == NULL)
+    return G_MAXINT;
+
+  return gtk_adjustment_get_value (adjustment) + 2 * gtk_adjustment_get_page_size (adjustment);
+}
+
+static gboolean
+gtk_flow_box_create_bound_children_cb (gpointer data)
+{
+  GtkFlowBox *box = data;
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint64 end_time;
+  guint n_items;
+  gint target, child_size;
+
+  end_time = g_get_monotonic_time () + BOUND_CHILDREN_STEP_TIME;
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  target = gtk_flow_box_get_bound_children_target (box);
+
+  /* Until the next allocation, guess where the lines end from the
+   * space the existing children take up.
+   */
+  if (priv->n_bound_children > 0)
+    child_size = priv->bound_children_end / priv->n_bound_children;
+  else
+    child_size = 0;
+
+  while (priv->n_bound_children < n_items && priv->bound_children_end < target)
+    {
+      gtk_flow_box_create_bound_child (box, priv->n_bound_children);
+      priv->bound_children_end += child_size;
+
+      /* Without any size to go by, wait for the next size_allocate()
+       * to check again. */
+      if (g_get_monotonic_time () >= end_time)
+        {
+          if (child_size > 0)
+            return G_SOURCE_CONTINUE;
+          break;
+        }
+    }
+
+  priv->bound_children_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Children for the items of a bound model are only created once they
+ * come close to the visible area of the adjustment for the lines, so
+ * binding big models doesn't create widgets for all items up front.
+ * Children are created in an idle in steps of BOUND_CHILDREN_STEP_TIME.
+ */
+static void
+gtk_flow_box_check_bound_children (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model == NULL || priv->bound_children_id != 0)
+    return;
+
+  if (priv->n_bound_children >= g_list_model_get_n_items (priv->bound_model))
+    return;
+
+  /* Before the first allocation, we don't know where the lines end */
+  if (priv->n_bound_children > 0 &&
+      priv->bound_children_end >= gtk_flow_box_get_bound_children_target (box))
+    return;
+
+  priv->bound_children_id = g_idle_add (gtk_flow_box_create_bound_children_cb, box);
+  g_source_set_name_by_id (priv->bound_children_id, "[gtk] gtk_flow_box_create_bound_children_cb");
+}
+
 static void
 gtk_flow_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3756,39 +3970,34 @@ gtk_flow_box_bound_model_changed (GListModel *list,
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
   gint i;
 
+  /* Only items that have children need to be removed */
+  if (position < priv->n_bound_children)
+    removed = MIN (removed, priv->n_bound_children - position);
+  else
+    removed = 0;
+
   while (removed--)
     {
       GtkFlowBoxChild *child;
 
       child = gtk_flow_box_get_child_at_index (box, position);
       gtk_widget_destroy (GTK_WIDGET (child));
+      priv->n_bound_children--;
     }
 
-  for (i = 0; i < added; i++)
+  /* Children always exist for a contiguous range of items at the
+   * start, so added items get children if they are inside that range.
+   * Without an adjustment, all items get children right away.
+   */
+  if (position < priv->n_bound_children ||
+      (position == priv->n_bound_children && gtk_flow_box_get_line_adjustment (box) == NULL))
     {
-      GObject *item;
-      GtkWidget *widget;
-
-      item = g_list_model_get_item (list, position + i);
-      widget = priv->create_widget_func (item, priv->create_widget_func_data);
-
-      /* We need to sink the floating reference here, so that we can accept
-       * both instances created with a floating reference (e.g. C functions
-       * that just return the result of g_object_new()) and without (e.g.
-       * from language bindings which will automatically sink the floating
-       * reference).
-       *
-       * See the similar code in gtklistbox.c:gtk_list_box_bound_model_changed.
-       */
-      if (g_object_is_floating (widget))
-        g_object_ref_sink (widget);
-
-      gtk_widget_show (widget);
-      gtk_flow_box_insert (box, widget, position + i);
-
-      g_object_unref (widget);
-      g_object_unref (item);
+      for (i = 0; i < added; i++)
+        gtk_flow_box_create_bound_child (box, position + i);
     }
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+  gtk_flow_box_check_bound_children (box);
 }
 
  /* Public API {{{2 */
@@ -3903,6 +4112,9 @@ gtk_flow_box_get_child_at_index (GtkFlowBox *box,
 
   g_return_val_if_fail (GTK_IS_FLOW_BOX (box), NULL);
 
+  if (idx >= 0)
+    gtk_flow_box_ensure_bound_children (box, (guint) idx + 1);
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, idx);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -3966,8 +4178,15 @@ gtk_flow_box_set_hadjustment (GtkFlowBox    *box,
 
   g_object_ref (adjustment);
   if (priv->hadjustment)
-    g_object_unref (priv->hadjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->hadjustment, gtk_flow_box_check_bound_children, box);
+      g_object_unref (priv->hadjustment);
+    }
   priv->hadjustment = adjustment;
+  g_signal_connect_swapped (adjustment, "value-changed",
+                            G_CALLBACK (gtk_flow_box_check_bound_children), box);
+  g_signal_connect_swapped (adjustment, "changed",
+                            G_CALLBACK (gtk_flow_box_check_bound_children), box);
   gtk_container_set_focus_hadjustment (GTK_CONTAINER (box), adjustment);
 }
 
@@ -4001,8 +4220,15 @@ gtk_flow_box_set_vadjustment (GtkFlowBox    *box,
 
   g_object_ref (adjustment);
   if (priv->vadjustment)
-    g_object_unref (priv->vadjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->vadjustment, gtk_flow_box_check_bound_children, box);
+      g_object_unref (priv->vadjustment);
+    }
   priv->vadjustment = adjustment;
+  g_signal_connect_swapped (adjustment, "value-changed",
+                            G_CALLBACK (gtk_flow_box_check_bound_children), box);
+  g_signal_connect_swapped (adjustment, "changed",
+                            G_CALLBACK (gtk_flow_box_check_bound_children), box);
   gtk_container_set_focus_vadjustment (GTK_CONTAINER (box), adjustment);
 }
 
@@ -4040,6 +4266,12 @@ gtk_flow_box_check_model_compat (GtkFlowBox *box)
  * Note that using a model is incompatible with the filtering and sorting
  * functionality in GtkFlowBox. When using a model, filtering and sorting
  * should be implemented by the model.
+ *
+ * If @box has an adjustment for the direction its lines are stacked in
+ * (see gtk_flow_box_set_vadjustment() and gtk_flow_box_set_hadjustment()),
+ * widgets are only created for items once they get close to being
+ * scrolled into view. gtk_flow_box_get_child_at_index() creates the
+ * widgets it needs.
  */
 void
 gtk_flow_box_bind_model (GtkFlowBox                 *box,
@@ -4061,9 +4293,12 @@ gtk_flow_box_bind_model (GtkFlowBox                 *box,
 
       g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
       g_clear_object (&priv->bound_model);
+      g_clear_handle_id (&priv->bound_children_id, g_source_remove);
     }
 
   gtk_flow_box_forall (GTK_CONTAINER (box), (GtkCallback) gtk_widget_destroy, NULL);
+  priv->n_bound_children = 0;
+  priv->bound_children_end = 0;
 
   if (model == NULL)
     return;
@@ -4421,6 +4656,8 @@ gtk_flow_box_select_all (GtkFlowBox *box)
   if (BOX_PRIV (box)->selection_mode != GTK_SELECTION_MULTIPLE)
     return;
 
+  gtk_flow_box_ensure_bound_children (box, G_MAXUINT);
+
   if (g_sequence_get_length (BOX_PRIV (box)->children) > 0)
     {
       gtk_flow_box_select_all_between (box, NULL, NULL, FALSE);
@@ -136,6 +136,13 @@ struct _GtkFontChooserWidgetPrivate
 
   guint last_fontconfig_timestamp;
 
+  /* in pango units, updated when the style changes */
+  int preview_text_height;
+
+  /* The search text, and its casefolded terms */
+  char   *search_text;
+  char  **search_terms;
+
   GtkFontChooserLevel level;
 
   GHashTable *axes;
@@ -195,6 +202,7 @@ static void     gtk_font_chooser_widget_set_show_preview_entry (GtkFontChooserWi
                                                                 gboolean              show_preview_entry);
 
 static void     gtk_font_chooser_widget_set_cell_size          (GtkFontChooserWidget *fontchooser);
+static int      gtk_font_chooser_widget_get_preview_text_height (GtkFontChooserWidget *fontchooser);
 static void     gtk_font_chooser_widget_load_fonts             (GtkFontChooserWidget *fontchooser,
                                                                 gboolean              force);
 static void     gtk_font_chooser_widget_populate_features      (GtkFontChooserWidget *fontchooser);
@@ -227,6 +235,11 @@ struct _GtkDelayedFontDescription {
   PangoFontFace        *face;
   PangoFontDescription *desc;
   guint                 ref_count;
+
+  /* The attributes of the preview of the face in the list,
+   * for a text height of attrs_height */
+  PangoAttrList        *attrs;
+  int                   attrs_height;
 };
 
 static GtkDelayedFontDescription *
@@ -262,6 +275,8 @@ gtk_delayed_font_description_unref (GtkDelayedFontDescription *desc)
   g_object_unref (desc->face);
   if (desc->desc)
     pango_font_description_free (desc->desc);
+  if (desc->attrs)
+    pango_attr_list_unref (desc->attrs);
 
   g_slice_free (GtkDelayedFontDescription, desc);
 }
@@ -944,6 +959,7 @@ gtk_font_chooser_widget_init (GtkFontChooserWidget *fontchooser)
   g_signal_connect (priv->tweak_action, "change-state", G_CALLBACK (change_tweak), fontchooser);
 
   /* Load data and set initial style-dependent parameters */
+  priv->preview_text_height = gtk_font_chooser_widget_get_preview_text_height (fontchooser);
   gtk_font_chooser_widget_load_fonts (fontchooser, TRUE);
 
 #if defined(HAVE_HARFBUZZ) && defined(HAVE_PANGOFT)
@@ -1083,7 +1099,6 @@ visible_func (GtkTreeModel *model,
   GtkFontChooserWidgetPrivate *priv = user_data;
   gboolean result = TRUE;
   const gchar *search_text;
-  gchar **split_terms;
   gchar *font_name, *font_name_casefold;
   guint i;
 
@@ -1111,6 +1126,24 @@ visible_func (GtkTreeModel *model,
   if (strlen (search_text) == 0)
     return TRUE;
 
+  /* Refiltering calls this for every font, so only split and
+   * casefold the search text when it changed */
+  if (g_strcmp0 (search_text, priv->search_text) != 0)
+    {
+      g_free (priv->search_text);
+      g_strfreev (priv->search_terms);
+
+      priv->search_text = g_strdup (search_text);
+      priv->search_terms = g_strsplit (search_text, " ", 0);
+      for (i = 0; priv->search_terms[i]; i++)
+        {
+          gchar *term_casefold = g_utf8_casefold (priv->search_terms[i], -1);
+
+          g_free (priv->search_terms[i]);
+          priv->search_terms[i] = term_casefold;
+        }
+    }
+
   gtk_tree_model_get (model, iter,
                       PREVIEW_TITLE_COLUMN, &font_name,
                       -1);
@@ -1118,22 +1151,16 @@ visible_func (GtkTreeModel *model,
   if (font_name == NULL)
     return FALSE;
 
-  split_terms = g_strsplit (search_text, " ", 0);
   font_name_casefold = g_utf8_casefold (font_name, -1);
 
-  for (i = 0; split_terms[i] && result; i++)
+  for (i = 0; priv->search_terms[i] && result; i++)
     {
-      gchar* term_casefold = g_utf8_casefold (split_terms[i], -1);
-
-      if (!strstr (font_name_casefold, term_casefold))
+      if (!strstr (font_name_casefold, priv->search_terms[i]))
         result = FALSE;
-
-      g_free (term_casefold);
     }
 
   g_free (font_name_casefold);
   g_free (font_name);
-  g_strfreev (split_terms);
 
   return result;
 }
@@ -1172,12 +1199,32 @@ gtk_font_chooser_widget_get_preview_attributes (GtkFontChooserWidget       *font
       pango_attr_list_insert (attrs, attribute);
     }
 
-  attribute = pango_attr_size_new_absolute (gtk_font_chooser_widget_get_preview_text_height (fontchooser));
+  attribute = pango_attr_size_new_absolute (fontchooser->priv->preview_text_height);
   pango_attr_list_insert (attrs, attribute);
 
   return attrs;
 }
 
+/* The cell data func runs for every visible row whenever the list is
+ * drawn, so the attributes are kept with the face */
+static PangoAttrList *
+gtk_delayed_font_description_get_attrs (GtkDelayedFontDescription *desc,
+                                        GtkFontChooserWidget      *fontchooser)
+{
+  if (desc->attrs == NULL ||
+      desc->attrs_height != fontchooser->priv->preview_text_height)
+    {
+      if (desc->attrs)
+        pango_attr_list_unref (desc->attrs);
+
+      desc->attrs = gtk_font_chooser_widget_get_preview_attributes (fontchooser,
+                                                                    gtk_delayed_font_description_get (desc));
+      desc->attrs_height = fontchooser->priv->preview_text_height;
+    }
+
+  return desc->attrs;
+}
+
 static void
 gtk_font_chooser_widget_cell_data_func (GtkTreeViewColumn *column,
                                         GtkCellRenderer   *cell,
@@ -1195,8 +1242,7 @@ gtk_font_chooser_widget_cell_data_func (GtkTreeViewColumn *column,
                       FONT_DESC_COLUMN, &desc,
                       -1);
 
-  attrs = gtk_font_chooser_widget_get_preview_attributes (fontchooser,
-                                                          gtk_delayed_font_description_get (desc));
+  attrs = gtk_delayed_font_description_get_attrs (desc, fontchooser);
 
   g_object_set (cell,
                 "xpad", 20,
@@ -1206,7 +1252,6 @@ gtk_font_chooser_widget_cell_data_func (GtkTreeViewColumn *column,
                 NULL);
 
   gtk_delayed_font_description_unref (desc);
-  pango_attr_list_unref (attrs);
   g_free (preview_title);
 }
 
@@ -1219,6 +1264,7 @@ gtk_font_chooser_widget_set_cell_size (GtkFontChooserWidget *fontchooser)
 
   gtk_cell_renderer_set_fixed_size (priv->family_face_cell, -1, -1);
 
+  priv->preview_text_height = gtk_font_chooser_widget_get_preview_text_height (fontchooser);
   attrs = gtk_font_chooser_widget_get_preview_attributes (fontchooser, NULL);
   
   g_object_set (priv->family_face_cell,
@@ -1250,6 +1296,8 @@ gtk_font_chooser_widget_finalize (GObject *object)
     priv->filter_data_destroy (priv->filter_data);
 
   g_free (priv->preview_text);
+  g_free (priv->search_text);
+  g_strfreev (priv->search_terms);
 
   g_clear_object (&priv->font_map);
 
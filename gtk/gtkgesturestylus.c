@@ -263,8 +263,10 @@ gtk_gesture_stylus_get_backlog (GtkGestureStylus  *gesture,
 				guint             *n_elems)
 {
   const GdkEvent *event;
-  GArray *backlog_array;
+  GdkTimeCoord *coords;
+  graphene_matrix_t transform;
   GList *history = NULL, *l;
+  guint i;
 
   g_return_val_if_fail (GTK_IS_GESTURE_STYLUS (gesture), FALSE);
   g_return_val_if_fail (backlog != NULL && n_elems != NULL, FALSE);
@@ -276,31 +278,32 @@ gtk_gesture_stylus_get_backlog (GtkGestureStylus  *gesture,
   if (!history)
     return FALSE;
 
-  backlog_array = g_array_new (FALSE, FALSE, sizeof (GdkTimeCoord));
-  for (l = history; l; l = l->next)
+  /* All of the history happened over the same widget, so one transform
+   * is enough for all of it. */
+  if (!gtk_widget_compute_transform (gtk_get_event_widget (event),
+                                     gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture)),
+                                     &transform))
+    {
+      g_list_free (history);
+      return FALSE;
+    }
+
+  coords = g_new (GdkTimeCoord, g_list_length (history));
+  for (l = history, i = 0; l; l = l->next, i++)
     {
-      GdkTimeCoord *time_coord = l->data;
       graphene_point_t p;
 
-      g_array_append_val (backlog_array, *time_coord);
-      time_coord = &g_array_index (backlog_array, GdkTimeCoord, backlog_array->len - 1);
-      if (gtk_widget_compute_point (gtk_get_event_widget (event),
-                                    gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture)),
-                                    &GRAPHENE_POINT_INIT (time_coord->axes[GDK_AXIS_X],
-                                                          time_coord->axes[GDK_AXIS_Y]),
-                                    &p))
-        {
-          time_coord->axes[GDK_AXIS_X] = p.x;
-          time_coord->axes[GDK_AXIS_Y] = p.y;
-        }
-      else
-        {
-          g_array_set_size (backlog_array, backlog_array->len - 1);
-        }
+      coords[i] = *(GdkTimeCoord *) l->data;
+      graphene_matrix_transform_point (&transform,
+                                       &GRAPHENE_POINT_INIT (coords[i].axes[GDK_AXIS_X],
+                                                             coords[i].axes[GDK_AXIS_Y]),
+                                       &p);
+      coords[i].axes[GDK_AXIS_X] = p.x;
+      coords[i].axes[GDK_AXIS_Y] = p.y;
     }
 
-  *n_elems = backlog_array->len;
-  *backlog = (GdkTimeCoord *) g_array_free (backlog_array, FALSE);
+  *n_elems = i;
+  *backlog = coords;
   g_list_free (history);
 
   return TRUE;
@@ -162,6 +162,10 @@ typedef struct {
   Texture *texture;
   GList *textures;
 
+  /* What was drawn last, kept so that snapshots without rendering
+   * can show it again without touching GL */
+  GdkTexture *last_texture;
+
   gboolean has_depth_buffer;
   gboolean has_stencil_buffer;
 
@@ -592,6 +596,8 @@ gtk_gl_area_delete_textures (GtkGLArea *area)
 {
   GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
 
+  g_clear_object (&priv->last_texture);
+
   if (priv->texture)
     {
       delete_one_texture (priv->texture);
@@ -704,6 +710,22 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
   if (priv->context == NULL)
     return;
 
+  /* Nothing new to render, so the texture from last time is still
+   * good. Showing it again saves binding buffers and switching to a
+   * new texture, which the renderer would have to look up again. */
+  if (!priv->needs_render && !priv->auto_render && !priv->needs_resize &&
+      priv->last_texture != NULL &&
+      gdk_texture_get_width (priv->last_texture) == w &&
+      gdk_texture_get_height (priv->last_texture) == h)
+    {
+      gtk_snapshot_append_texture (snapshot,
+                                   priv->last_texture,
+                                   &GRAPHENE_RECT_INIT (0, 0,
+                                                        gtk_widget_get_width (widget),
+                                                        gtk_widget_get_height (widget)));
+      return;
+    }
+
   gtk_gl_area_make_current (area);
 
   gtk_gl_area_attach_buffers (area);
@@ -747,6 +769,7 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
                                                         gtk_widget_get_width (widget),
                                                         gtk_widget_get_height (widget)));
 
+      g_set_object (&priv->last_texture, texture->holder);
       g_object_unref (texture->holder);
     }
   else
@@ -49,6 +49,7 @@
 #include "gtkdebug.h"
 #include "gtkintl.h"
 #include "gtklayoutchild.h"
+#include "gtklayoutmanagerprivate.h"
 #include "gtkorientableprivate.h"
 #include "gtkprivate.h"
 #include "gtksizerequest.h"
@@ -427,6 +428,16 @@ typedef struct {
   GridLines lines[2];
 } GridRequest;
 
+/* The lines of one orientation after grid_request_run(). The
+ * contextual request is kept for the last size of the lines in
+ * the other orientation, the other one has a for_size of -1. */
+typedef struct {
+  guint serial;
+  int for_size;
+  int n_lines;
+  GridLine *lines;
+} GridLinesCache;
+
 struct _GtkGridLayout
 {
   GtkLayoutManager parent_instance;
@@ -438,6 +449,16 @@ struct _GtkGridLayout
   int baseline_row;
 
   GridLineData linedata[2];
+
+  /* The results of grid_request_count_lines() and grid_request_run(),
+   * which stay the same while the request serial of the layout manager
+   * does. Measuring in one orientation for several sizes of the other
+   * one, and allocating after measuring, don't need to ask all children
+   * again. */
+  guint count_serial;
+  int count_min[2];
+  int count_max[2];
+  GridLinesCache lines_cache[2][2];
 };
 
 enum {
@@ -485,10 +506,21 @@ get_spacing (GtkGridLayout  *self,
 static void
 grid_request_count_lines (GridRequest *request)
 {
+  GtkGridLayout *self = request->layout;
+  const guint serial = gtk_layout_manager_get_request_serial (GTK_LAYOUT_MANAGER (self));
   GtkWidget *child;
   int min[2];
   int max[2];
 
+  if (self->count_serial == serial)
+    {
+      request->lines[0].min = self->count_min[0];
+      request->lines[0].max = self->count_max[0];
+      request->lines[1].min = self->count_min[1];
+      request->lines[1].max = self->count_max[1];
+      return;
+    }
+
   min[0] = min[1] = G_MAXINT;
   max[0] = max[1] = G_MININT;
 
@@ -509,6 +541,12 @@ grid_request_count_lines (GridRequest *request)
   request->lines[0].max = max[0];
   request->lines[1].min = min[1];
   request->lines[1].max = max[1];
+
+  self->count_serial = serial;
+  self->count_min[0] = min[0];
+  self->count_max[0] = max[0];
+  self->count_min[1] = min[1];
+  self->count_max[1] = max[1];
 }
 
 /* Sets line sizes to 0 and marks lines as expand
@@ -1068,6 +1106,46 @@ grid_request_run (GridRequest    *request,
   grid_request_homogeneous (request, orientation);
 }
 
+/* Like grid_request_run(), but reuses the lines of the last run when
+ * the children didn't change. @for_size is the size the lines in the
+ * opposite orientation were allocated, for contextual requests. All
+ * callers start from zeroed lines, so copying them is enough. */
+static void
+grid_request_run_cached (GridRequest    *request,
+                         GtkOrientation  orientation,
+                         gboolean        contextual,
+                         int             for_size)
+{
+  GtkGridLayout *self = request->layout;
+  GridLinesCache *cache = &self->lines_cache[orientation][contextual ? 1 : 0];
+  GridLines *lines = &request->lines[orientation];
+  const int n_lines = lines->max - lines->min;
+  const guint serial = gtk_layout_manager_get_request_serial (GTK_LAYOUT_MANAGER (self));
+
+  if (!contextual)
+    for_size = -1;
+
+  if (cache->serial == serial &&
+      cache->for_size == for_size &&
+      cache->n_lines == n_lines)
+    {
+      memcpy (lines->lines, cache->lines, n_lines * sizeof (GridLine));
+      return;
+    }
+
+  grid_request_run (request, orientation, contextual);
+
+  if (cache->n_lines != n_lines)
+    {
+      cache->lines = g_renew (GridLine, cache->lines, n_lines);
+      cache->n_lines = n_lines;
+    }
+
+  memcpy (cache->lines, lines->lines, n_lines * sizeof (GridLine));
+  cache->serial = serial;
+  cache->for_size = for_size;
+}
+
 static void
 grid_distribute_non_homogeneous (GridLines *lines,
                                  int        nonempty,
@@ -1372,7 +1450,7 @@ gtk_grid_layout_get_size (GtkGridLayout  *self,
   lines->lines = g_newa (GridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (GridLine));
 
-  grid_request_run (&request, orientation, FALSE);
+  grid_request_run_cached (&request, orientation, FALSE, -1);
   grid_request_sum (&request, orientation,
                     minimum, natural,
                     minimum_baseline, natural_baseline);
@@ -1415,11 +1493,11 @@ gtk_grid_layout_get_size_for_size (GtkGridLayout  *self,
   lines->lines = g_newa (GridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (GridLine));
 
-  grid_request_run (&request, 1 - orientation, FALSE);
+  grid_request_run_cached (&request, 1 - orientation, FALSE, -1);
   grid_request_sum (&request, 1 - orientation, &min_size, &nat_size, NULL, NULL);
   grid_request_allocate (&request, 1 - orientation, MAX (size, min_size));
 
-  grid_request_run (&request, orientation, TRUE);
+  grid_request_run_cached (&request, orientation, TRUE, MAX (size, min_size));
   grid_request_sum (&request, orientation,
                     minimum, natural,
                     minimum_baseline, natural_baseline);
@@ -1548,11 +1626,12 @@ gtk_grid_layout_allocate (GtkLayoutManager *manager,
   else
     orientation = GTK_ORIENTATION_VERTICAL;
 
-  grid_request_run (&request, OPPOSITE_ORIENTATION (orientation), FALSE);
+  grid_request_run_cached (&request, OPPOSITE_ORIENTATION (orientation), FALSE, -1);
   grid_request_allocate (&request, OPPOSITE_ORIENTATION (orientation),
                          GET_SIZE (width, height, OPPOSITE_ORIENTATION (orientation)));
 
-  grid_request_run (&request, orientation, TRUE);
+  grid_request_run_cached (&request, orientation, TRUE,
+                           GET_SIZE (width, height, OPPOSITE_ORIENTATION (orientation)));
   grid_request_allocate (&request, orientation, GET_SIZE (width, height, orientation));
 
   grid_request_position (&request, 0);
@@ -1639,6 +1718,11 @@ gtk_grid_layout_finalize (GObject *gobject)
 
   g_clear_pointer (&self->row_properties, g_array_unref);
 
+  g_free (self->lines_cache[0][0].lines);
+  g_free (self->lines_cache[0][1].lines);
+  g_free (self->lines_cache[1][0].lines);
+  g_free (self->lines_cache[1][1].lines);
+
   G_OBJECT_CLASS (gtk_grid_layout_parent_class)->finalize (gobject);
 }
 
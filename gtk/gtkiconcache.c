@@ -50,7 +50,15 @@ struct _GtkIconCache {
   GMappedFile *map;
   gchar *buffer;
 
-  guint32 last_chain_offset;
+  /* The hash chains of the last two icon names that were looked up,
+   * so that looking up a name and its ".symbolic" variant in every
+   * directory doesn't search the hash each time */
+  guint32 last_chain_offsets[2];
+  guint last_chain_slot;
+
+  /* For each directory, whether it has icons. Filled in with a single
+   * pass over the hash on first use. */
+  guint8 *directories_with_icons;
 };
 
 GtkIconCache *
@@ -71,6 +79,7 @@ gtk_icon_cache_unref (GtkIconCache *cache)
 
       if (cache->map)
 	g_mapped_file_unref (cache->map);
+      g_free (cache->directories_with_icons);
       g_free (cache);
     }
 }
@@ -232,14 +241,17 @@ find_image_offset (GtkIconCache *cache,
   if (!icon_name)
     return 0;
 
-  chain_offset = cache->last_chain_offset;
-  if (chain_offset)
+  for (i = 0; i < G_N_ELEMENTS (cache->last_chain_offsets); i++)
     {
-      guint32 name_offset = GET_UINT32 (cache->buffer, chain_offset + 4);
-      gchar *name = cache->buffer + name_offset;
+      chain_offset = cache->last_chain_offsets[i];
+      if (chain_offset)
+        {
+          guint32 name_offset = GET_UINT32 (cache->buffer, chain_offset + 4);
+          gchar *name = cache->buffer + name_offset;
 
-      if (strcmp (name, icon_name) == 0)
-        goto find_dir;
+          if (strcmp (name, icon_name) == 0)
+            goto find_dir;
+        }
     }
 
   hash_offset = GET_UINT32 (cache->buffer, 4);
@@ -254,14 +266,14 @@ find_image_offset (GtkIconCache *cache,
 
       if (strcmp (name, icon_name) == 0)
         {
-          cache->last_chain_offset = chain_offset;
+          cache->last_chain_slot = 1 - cache->last_chain_slot;
+          cache->last_chain_offsets[cache->last_chain_slot] = chain_offset;
           goto find_dir;
 	}
   
       chain_offset = GET_UINT32 (cache->buffer, chain_offset);
     }
 
-  cache->last_chain_offset = 0;
   return 0;
 
 find_dir:
@@ -294,20 +306,23 @@ gtk_icon_cache_get_icon_flags (GtkIconCache *cache,
   return GET_UINT16 (cache->buffer, image_offset + 2);
 }
 
-gboolean
-gtk_icon_cache_has_icons (GtkIconCache *cache,
-			   const gchar  *directory)
+static void
+ensure_directories_with_icons (GtkIconCache *cache)
 {
-  int directory_index;
+  guint32 dir_list_offset, n_dirs;
   guint32 hash_offset, n_buckets;
   guint32 chain_offset;
   guint32 image_list_offset, n_images;
+  guint16 directory_index;
   int i, j;
 
-  directory_index = get_directory_index (cache, directory);
+  if (cache->directories_with_icons)
+    return;
 
-  if (directory_index == -1)
-    return FALSE;
+  dir_list_offset = GET_UINT32 (cache->buffer, 8);
+  n_dirs = GET_UINT32 (cache->buffer, dir_list_offset);
+
+  cache->directories_with_icons = g_new0 (guint8, MAX (n_dirs, 1));
 
   hash_offset = GET_UINT32 (cache->buffer, 4);
   n_buckets = GET_UINT32 (cache->buffer, hash_offset);
@@ -322,16 +337,32 @@ gtk_icon_cache_has_icons (GtkIconCache *cache,
 
 	  for (j = 0; j < n_images; j++)
 	    {
-	      if (GET_UINT16 (cache->buffer, image_list_offset + 4 + 8 * j) ==
-		  directory_index)
-		return TRUE;
+	      directory_index = GET_UINT16 (cache->buffer, image_list_offset + 4 + 8 * j);
+	      if (directory_index < n_dirs)
+		cache->directories_with_icons[directory_index] = TRUE;
 	    }
 
 	  chain_offset = GET_UINT32 (cache->buffer, chain_offset);
 	}
     }
+}
 
-  return FALSE;
+gboolean
+gtk_icon_cache_has_icons (GtkIconCache *cache,
+			   const gchar  *directory)
+{
+  int directory_index;
+
+  directory_index = get_directory_index (cache, directory);
+
+  if (directory_index == -1)
+    return FALSE;
+
+  /* Themes have many directories, and scanning the whole hash for
+   * each of them made loading a theme quadratic */
+  ensure_directories_with_icons (cache);
+
+  return cache->directories_with_icons[directory_index];
 }
 
 void
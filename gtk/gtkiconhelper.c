@@ -51,6 +51,8 @@ struct _GtkIconHelper
   GtkWidget *owner;
   GtkCssNode *node;
   GdkPaintable *paintable;
+  GtkIconInfo *loading_info;
+  GCancellable *cancellable;
 };
 
 static GtkIconLookupFlags
@@ -91,6 +93,71 @@ get_icon_lookup_flags (GtkIconHelper    *self,
   return flags;
 }
 
+static GdkPaintable *
+paintable_for_icon_info (GtkIconInfo *info,
+                         gint         scale)
+{
+  GdkPaintable *paintable;
+
+  paintable = GDK_PAINTABLE (gtk_icon_info_load_texture (info));
+
+  if (paintable && scale != 1)
+    {
+      GdkPaintable *orig = paintable;
+
+      paintable = gtk_scaler_new (orig, scale);
+      g_object_unref (orig);
+    }
+
+  return paintable;
+}
+
+static void
+gtk_icon_helper_cancel_load (GtkIconHelper *self)
+{
+  g_clear_object (&self->loading_info);
+
+  if (self->cancellable)
+    {
+      g_cancellable_cancel (self->cancellable);
+      g_clear_object (&self->cancellable);
+    }
+}
+
+static void
+gtk_icon_helper_load_done (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      data)
+{
+  GtkIconHelper *self;
+  GtkIconInfo *info = GTK_ICON_INFO (source);
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  pixbuf = gtk_icon_info_load_icon_finish (info, result, &error);
+  g_clear_object (&pixbuf);
+
+  /* We were invalidated or finalized while loading */
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+
+  g_clear_error (&error);
+
+  self = data;
+
+  g_clear_object (&self->loading_info);
+  g_clear_object (&self->cancellable);
+
+  self->paintable = paintable_for_icon_info (info, gtk_widget_get_scale_factor (self->owner));
+  self->texture_is_symbolic = gtk_icon_info_is_symbolic (info);
+
+  gtk_widget_queue_draw (self->owner);
+  gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
+}
+
 static GdkPaintable *
 ensure_paintable_for_gicon (GtkIconHelper    *self,
                             GtkCssStyle      *style,
@@ -122,17 +189,21 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
                                        flags | GTK_ICON_LOOKUP_USE_BUILTIN | GTK_ICON_LOOKUP_GENERIC_FALLBACK);
 
   *symbolic = gtk_icon_info_is_symbolic (info);
-  paintable = GDK_PAINTABLE (gtk_icon_info_load_texture (info));
-  g_object_unref (info);
 
-  if (paintable && scale != 1)
+  /* Don't block on reading and decoding the icon. Draw nothing
+   * until it has been loaded in a thread, it will usually only
+   * take a frame or two. */
+  if (!gtk_icon_info_is_loaded (info))
     {
-      GdkPaintable *orig = paintable;
-
-      paintable = gtk_scaler_new (orig, scale);
-      g_object_unref (orig);
+      self->loading_info = info;
+      self->cancellable = g_cancellable_new ();
+      gtk_icon_info_load_icon_async (info, self->cancellable, gtk_icon_helper_load_done, self);
+      return NULL;
     }
 
+  paintable = paintable_for_icon_info (info, scale);
+  g_object_unref (info);
+
   return paintable;
 }
 
@@ -191,7 +262,7 @@ gtk_icon_helper_ensure_paintable (GtkIconHelper *self)
 {
   gboolean symbolic;
 
-  if (self->paintable)
+  if (self->paintable || self->loading_info)
     return;
 
   self->paintable = gtk_icon_helper_load_paintable (self, &symbolic);
@@ -333,6 +404,7 @@ void
 gtk_icon_helper_invalidate (GtkIconHelper *self)
 {
   g_clear_object (&self->paintable);
+  gtk_icon_helper_cancel_load (self);
   self->texture_is_symbolic = FALSE;
 
   if (!GTK_IS_CSS_TRANSIENT_NODE (self->node))
@@ -351,6 +423,7 @@ gtk_icon_helper_invalidate_for_change (GtkIconHelper     *self,
     {
       /* Avoid the queue_resize in gtk_icon_helper_invalidate */
       g_clear_object (&self->paintable);
+      gtk_icon_helper_cancel_load (self);
       self->texture_is_symbolic = FALSE;
 
       if (change == NULL ||
@@ -379,6 +452,7 @@ void
 _gtk_icon_helper_clear (GtkIconHelper *self)
 {
   g_clear_object (&self->paintable);
+  gtk_icon_helper_cancel_load (self);
   self->texture_is_symbolic = FALSE;
 
   if (gtk_image_definition_get_storage_type (self->def) != GTK_IMAGE_EMPTY)
@@ -46,8 +46,10 @@
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "gtksettingsprivate.h"
+#include "gtksnapshot.h"
 #include "gtkstylecontextprivate.h"
 #include "gtkprivate.h"
+#include "gtkstartupprivate.h"
 #include "gdkpixbufutilsprivate.h"
 
 /* this is in case round() is not provided by the compiler, 
@@ -226,6 +228,7 @@ struct _GtkIconInfo
   GdkPixbuf *proxy_pixbuf;
   GdkTexture *texture;
   GError *load_error;
+  guint pixbuf_is_mask  : 1;  /* pixbuf holds the colors as success/warning/error fractions */
   gdouble unscaled_scale;
   gdouble scale;
 
@@ -1404,7 +1407,10 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
   
   if (!priv->themes_valid)
     {
+      gint64 start = gtk_startup_begin (GTK_STARTUP_ICON_THEME);
+
       load_themes (icon_theme);
+      gtk_startup_end (GTK_STARTUP_ICON_THEME, start);
 
       if (was_valid)
         queue_theme_changed (icon_theme);
@@ -3285,6 +3291,7 @@ icon_info_dup (GtkIconInfo *icon_info)
     dup->loadable = g_object_ref (icon_info->loadable);
   if (icon_info->pixbuf)
     dup->pixbuf = g_object_ref (icon_info->pixbuf);
+  dup->pixbuf_is_mask = icon_info->pixbuf_is_mask;
 
   if (icon_info->cache_pixbuf)
     dup->cache_pixbuf = g_object_ref (icon_info->cache_pixbuf);
@@ -3518,10 +3525,13 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
             size = icon_info->dir_size * dir_scale * icon_info->scale;
 
           if (gtk_icon_info_is_symbolic (icon_info))
-            source_pixbuf = gtk_make_symbolic_pixbuf_from_resource (icon_info->filename,
-                                                                    size, size,
-                                                                    icon_info->desired_scale,
-                                                                    &icon_info->load_error);
+            {
+              source_pixbuf = gtk_make_symbolic_pixbuf_from_resource (icon_info->filename,
+                                                                      size, size,
+                                                                      icon_info->desired_scale,
+                                                                      &icon_info->load_error);
+              icon_info->pixbuf_is_mask = source_pixbuf != NULL;
+            }
           else if (size == 0)
             source_pixbuf = _gdk_pixbuf_new_from_resource_scaled (icon_info->filename,
                                                                   icon_info->desired_scale,
@@ -3559,10 +3569,13 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
                 size = icon_info->dir_size * dir_scale * icon_info->scale;
 
               if (gtk_icon_info_is_symbolic (icon_info) && icon_info->icon_file)
-                source_pixbuf = gtk_make_symbolic_pixbuf_from_file (icon_info->icon_file,
-                                                                    size, size,
-                                                                    icon_info->desired_scale,
-                                                                    &icon_info->load_error);
+                {
+                  source_pixbuf = gtk_make_symbolic_pixbuf_from_file (icon_info->icon_file,
+                                                                      size, size,
+                                                                      icon_info->desired_scale,
+                                                                      &icon_info->load_error);
+                  icon_info->pixbuf_is_mask = source_pixbuf != NULL;
+                }
               else if (size == 0)
                 source_pixbuf = _gdk_pixbuf_new_from_stream_scaled (stream,
                                                                     icon_info->desired_scale,
@@ -3762,6 +3775,13 @@ gtk_icon_info_load_texture (GtkIconInfo *icon_info)
   return g_object_ref (icon_info->texture);
 }
 
+/* Returns TRUE if gtk_icon_info_load_texture() will not block */
+gboolean
+gtk_icon_info_is_loaded (GtkIconInfo *icon_info)
+{
+  return icon_info->texture != NULL || icon_info_get_pixbuf_ready (icon_info);
+}
+
 static void
 load_icon_thread  (GTask        *task,
                    gpointer      source_object,
@@ -4028,7 +4048,7 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
 }
 
 static GdkPixbuf *
-gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
+gtk_icon_info_load_symbolic_mask (GtkIconInfo    *icon_info,
                                  const GdkRGBA  *fg,
                                  const GdkRGBA  *success_color,
                                  const GdkRGBA  *warning_color,
@@ -4218,9 +4238,14 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
    */
   g_return_val_if_fail (fg != NULL, NULL);
 
+  /* If the icon was loaded as a mask, coloring it is a cheap pass
+   * over the pixels, so there is no need to render the SVG again
+   * for every combination of colors.
+   */
   icon_uri = g_file_get_uri (icon_info->icon_file);
-  if (g_str_has_suffix (icon_uri, ".symbolic.png"))
-    pixbuf = gtk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
+  if (g_str_has_suffix (icon_uri, ".symbolic.png") ||
+      (icon_info_ensure_scale_and_pixbuf (icon_info) && icon_info->pixbuf_is_mask))
+    pixbuf = gtk_icon_info_load_symbolic_mask (icon_info, fg, success_color, warning_color, error_color, error);
   else
     pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
 
@@ -4340,6 +4365,34 @@ gtk_icon_theme_lookup_symbolic_colors (GtkCssStyle *style,
     *error_out = *color_out;
 }
 
+/* Pushes a color matrix that colors a symbolic icon mask, as created
+ * by gtk_make_symbolic_pixbuf_from_data(), with the given colors. This
+ * way the mask only needs to be loaded once and the renderer applies
+ * the colors, instead of creating a new pixbuf for every combination.
+ * Pop it with gtk_snapshot_pop().
+ */
+void
+gtk_icon_theme_push_symbolic_colors (GtkSnapshot   *snapshot,
+                                     const GdkRGBA *fg,
+                                     const GdkRGBA *success,
+                                     const GdkRGBA *warning,
+                                     const GdkRGBA *error)
+{
+  graphene_matrix_t matrix;
+  graphene_vec4_t offset;
+
+  graphene_matrix_init_from_float (&matrix,
+          (float[16]) {
+                       success->red - fg->red, success->green - fg->green, success->blue - fg->blue, 0,
+                       warning->red - fg->red, warning->green - fg->green, warning->blue - fg->blue, 0,
+                       error->red - fg->red, error->green - fg->green, error->blue - fg->blue, 0,
+                       0, 0, 0, fg->alpha
+                      });
+  graphene_vec4_init (&offset, fg->red, fg->green, fg->blue, 0);
+
+  gtk_snapshot_push_color_matrix (snapshot, &matrix, &offset);
+}
+
 /**
  * gtk_icon_info_load_symbolic_for_context:
  * @icon_info: a #GtkIconInfo
@@ -27,4 +27,12 @@ void        gtk_icon_theme_lookup_symbolic_colors       (GtkCssStyle    *style,
                                                          GdkRGBA        *warning_out,
                                                          GdkRGBA        *error_out);
 
+void        gtk_icon_theme_push_symbolic_colors         (GtkSnapshot    *snapshot,
+                                                         const GdkRGBA  *fg,
+                                                         const GdkRGBA  *success,
+                                                         const GdkRGBA  *warning,
+                                                         const GdkRGBA  *error);
+
+gboolean    gtk_icon_info_is_loaded                     (GtkIconInfo    *icon_info);
+
 #endif /* __GTK_ICON_THEME_PRIVATE_H__ */
@@ -82,6 +82,7 @@
  */
 
 #define SCROLL_EDGE_SIZE 15
+#define MAX_CACHED_ITEM_SIZES 16
 
 typedef struct _GtkIconViewChild GtkIconViewChild;
 struct _GtkIconViewChild
@@ -159,6 +160,9 @@ static void             gtk_icon_view_size_allocate             (GtkWidget
                                                                  int                 baseline);
 static void             gtk_icon_view_snapshot                  (GtkWidget          *widget,
                                                                  GtkSnapshot        *snapshot);
+static void             gtk_icon_view_style_updated             (GtkWidget          *widget);
+static void             gtk_icon_view_direction_changed         (GtkWidget          *widget,
+                                                                 GtkTextDirection    previous_direction);
 static void             gtk_icon_view_motion                    (GtkEventController *controller,
                                                                  double              x,
                                                                  double              y,
@@ -235,6 +239,7 @@ static gboolean             gtk_icon_view_unselect_all_internal          (GtkIco
 static void                 gtk_icon_view_update_rubberband              (GtkIconView            *icon_view);
 static void                 gtk_icon_view_item_invalidate_size           (GtkIconViewItem        *item);
 static void                 gtk_icon_view_invalidate_sizes               (GtkIconView            *icon_view);
+static void                 gtk_icon_view_queue_layout                   (GtkIconView            *icon_view);
 static void                 gtk_icon_view_add_move_binding               (GtkBindingSet          *binding_set,
 									  guint                   keyval,
 									  guint                   modmask,
@@ -359,6 +364,8 @@ gtk_icon_view_class_init (GtkIconViewClass *klass)
   widget_class->measure = gtk_icon_view_measure;
   widget_class->size_allocate = gtk_icon_view_size_allocate;
   widget_class->snapshot = gtk_icon_view_snapshot;
+  widget_class->style_updated = gtk_icon_view_style_updated;
+  widget_class->direction_changed = gtk_icon_view_direction_changed;
   widget_class->drag_begin = gtk_icon_view_drag_begin;
   widget_class->drag_end = gtk_icon_view_drag_end;
   widget_class->drag_data_get = gtk_icon_view_drag_data_get;
@@ -955,6 +962,7 @@ gtk_icon_view_init (GtkIconView *icon_view)
 
   icon_view->priv->row_contexts = 
     g_ptr_array_new_with_free_func ((GDestroyNotify)g_object_unref);
+  icon_view->priv->item_sizes = g_array_new (FALSE, FALSE, sizeof (GtkIconViewItemSize));
 
   gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (icon_view)),
                                GTK_STYLE_CLASS_VIEW);
@@ -1012,6 +1020,8 @@ gtk_icon_view_dispose (GObject *object)
       priv->row_contexts = NULL;
     }
 
+  g_clear_pointer (&priv->item_sizes, g_array_unref);
+
   if (priv->cell_area)
     {
       gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
@@ -1396,10 +1406,31 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
 {
   GtkIconViewPrivate *priv = icon_view->priv;
   GtkCellAreaContext *context;
+  GtkIconViewItemSize size;
   GList *items;
+  guint i;
 
   g_assert (!gtk_icon_view_is_empty (icon_view));
 
+  /* Measuring and laying out ask for the same few sizes over and
+   * over, and each of them walks all items */
+  for (i = 0; i < priv->item_sizes->len; i++)
+    {
+      GtkIconViewItemSize *cached = &g_array_index (priv->item_sizes, GtkIconViewItemSize, i);
+
+      if (cached->orientation == orientation && cached->for_size == for_size)
+        {
+          if (minimum)
+            *minimum = cached->minimum;
+          if (natural)
+            *natural = cached->natural;
+          return;
+        }
+    }
+
+  size.orientation = orientation;
+  size.for_size = for_size;
+
   context = gtk_cell_area_create_context (priv->cell_area);
 
   for_size -= 2 * priv->item_padding;
@@ -1431,36 +1462,42 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
       if (for_size > 0)
         gtk_cell_area_context_get_preferred_width_for_height (context,
                                                               for_size,
-                                                              minimum, natural);
+                                                              &size.minimum, &size.natural);
       else
         gtk_cell_area_context_get_preferred_width (context,
-                                                   minimum, natural);
+                                                   &size.minimum, &size.natural);
     }
   else
     {
       if (for_size > 0)
         gtk_cell_area_context_get_preferred_height_for_width (context,
                                                               for_size,
-                                                              minimum, natural);
+                                                              &size.minimum, &size.natural);
       else
         gtk_cell_area_context_get_preferred_height (context,
-                                                    minimum, natural);
+                                                    &size.minimum, &size.natural);
     }
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL && priv->item_width >= 0)
     {
-      if (minimum)
-        *minimum = MAX (*minimum, priv->item_width);
-      if (natural)
-        *natural = *minimum;
+      size.minimum = MAX (size.minimum, priv->item_width);
+      size.natural = size.minimum;
     }
 
-  if (minimum)
-    *minimum = MAX (1, *minimum + 2 * priv->item_padding);
-  if (natural)
-    *natural = MAX (1, *natural + 2 * priv->item_padding);
+  size.minimum = MAX (1, size.minimum + 2 * priv->item_padding);
+  size.natural = MAX (1, size.natural + 2 * priv->item_padding);
 
   g_object_unref (context);
+
+  /* Resizing the window asks for a new size every frame */
+  if (priv->item_sizes->len >= MAX_CACHED_ITEM_SIZES)
+    g_array_set_size (priv->item_sizes, 0);
+  g_array_append_val (priv->item_sizes, size);
+
+  if (minimum)
+    *minimum = size.minimum;
+  if (natural)
+    *natural = size.natural;
 }
 
 static void
@@ -1619,6 +1656,32 @@ gtk_icon_view_allocate_children (GtkIconView *icon_view)
     }
 }
 
+static void
+gtk_icon_view_style_updated (GtkWidget *widget)
+{
+  GtkIconView *icon_view = GTK_ICON_VIEW (widget);
+  GtkCssStyleChange *change;
+
+  GTK_WIDGET_CLASS (gtk_icon_view_parent_class)->style_updated (widget);
+
+  change = gtk_style_context_get_change (gtk_widget_get_style_context (widget));
+
+  if (change == NULL || gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_SIZE))
+    gtk_icon_view_invalidate_sizes (icon_view);
+}
+
+static void
+gtk_icon_view_direction_changed (GtkWidget        *widget,
+                                 GtkTextDirection  previous_direction)
+{
+  GtkIconView *icon_view = GTK_ICON_VIEW (widget);
+
+  GTK_WIDGET_CLASS (gtk_icon_view_parent_class)->direction_changed (widget, previous_direction);
+
+  /* The columns are laid out from the other side */
+  gtk_icon_view_queue_layout (icon_view);
+}
+
 static void
 gtk_icon_view_size_allocate (GtkWidget *widget,
                              int        width,
@@ -2751,12 +2814,19 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   if (gtk_icon_view_is_empty (icon_view))
     return;
 
-  rtl = gtk_widget_get_direction (GTK_WIDGET (icon_view)) == GTK_TEXT_DIR_RTL;
-  n_items = gtk_icon_view_get_n_items (icon_view);
-
   width = gtk_widget_get_width (widget);
   height = gtk_widget_get_height (widget);
 
+  /* Allocating again at the same size, like when a child widget
+   * resizes, doesn't move any items */
+  if (priv->layout_valid &&
+      priv->layout_width == width &&
+      priv->layout_height == height)
+    return;
+
+  rtl = gtk_widget_get_direction (GTK_WIDGET (icon_view)) == GTK_TEXT_DIR_RTL;
+  n_items = gtk_icon_view_get_n_items (icon_view);
+
   gtk_icon_view_compute_n_items_for_size (icon_view, 
                                           GTK_ORIENTATION_HORIZONTAL,
                                           width,
@@ -2858,6 +2928,10 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   priv->height -= priv->row_spacing;
   priv->height += priv->margin;
   priv->height = MAX (priv->height, height);
+
+  priv->layout_width = width;
+  priv->layout_height = height;
+  priv->layout_valid = TRUE;
 }
 
 static void
@@ -2868,6 +2942,20 @@ gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
 		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
 
   /* Re-layout the items */
+  gtk_icon_view_queue_layout (icon_view);
+}
+
+/* Forgets the cached item sizes and the layout, for when items
+ * are added, removed or moved or their sizes change */
+static void
+gtk_icon_view_queue_layout (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  if (priv->item_sizes)
+    g_array_set_size (priv->item_sizes, 0);
+  priv->layout_valid = FALSE;
+
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -3268,7 +3356,7 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
     
   verify_items (icon_view);
 
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view);
 }
 
 static void
@@ -3323,7 +3411,7 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
 
   verify_items (icon_view);  
   
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view);
 
   if (emit)
     g_signal_emit (icon_view, icon_view_signals[SELECTION_CHANGED], 0);
@@ -3371,7 +3459,7 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   g_list_free (icon_view->priv->items);
   icon_view->priv->items = items;
 
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view);
 
   verify_items (icon_view);  
 }
@@ -4772,7 +4860,7 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
   if (dirty)
     g_signal_emit (icon_view, icon_view_signals[SELECTION_CHANGED], 0);
 
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view);
 }
 
 /**
@@ -5390,7 +5478,7 @@ gtk_icon_view_set_columns (GtkIconView *icon_view,
       if (icon_view->priv->cell_area)
 	gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
-      gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+      gtk_icon_view_queue_layout (icon_view);
       
       g_object_notify (G_OBJECT (icon_view), "columns");
     }  
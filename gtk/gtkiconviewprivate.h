@@ -37,6 +37,17 @@ struct _GtkIconViewItem
 
 };
 
+/* What gtk_icon_view_get_preferred_item_size() returned, which needs
+ * to measure every item */
+typedef struct _GtkIconViewItemSize GtkIconViewItemSize;
+struct _GtkIconViewItemSize
+{
+  GtkOrientation orientation;
+  gint for_size;
+  gint minimum;
+  gint natural;
+};
+
 struct _GtkIconViewPrivate
 {
   GtkCellArea        *cell_area;
@@ -48,6 +59,10 @@ struct _GtkIconViewPrivate
 
   GPtrArray          *row_contexts;
 
+  /* Cleared whenever the items or their sizes change */
+  GArray             *item_sizes;
+  gint layout_width, layout_height;
+
   gint width, height;
   double mouse_x;
   double mouse_y;
@@ -134,6 +149,7 @@ struct _GtkIconViewPrivate
 
   guint doing_rubberband : 1;
 
+  guint layout_valid : 1;
 };
 
 void                 _gtk_icon_view_set_cell_data                  (GtkIconView            *icon_view,
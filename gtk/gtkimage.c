@@ -544,7 +544,7 @@ gtk_image_new_from_gicon (GIcon *icon)
 
 typedef struct {
   GtkImage *image;
-  gint scale_factor;
+  double scale_factor;
 } LoaderData;
 
 static void
@@ -554,18 +554,31 @@ on_loader_size_prepared (GdkPixbufLoader *loader,
 			 gpointer         user_data)
 {
   LoaderData *loader_data = user_data;
-  gint scale_factor;
+  GtkImagePrivate *priv = gtk_image_get_instance_private (loader_data->image);
+  gint scale_factor, pixel_size;
   GdkPixbufFormat *format;
 
-  /* Let the regular icon helper code path handle non-scalable images */
+  scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (loader_data->image));
+
+  /* Let the regular icon helper code path handle non-scalable images,
+   * but don't decode them larger than the pixel size they are shown at
+   */
   format = gdk_pixbuf_loader_get_format (loader);
   if (!gdk_pixbuf_format_is_scalable (format))
     {
       loader_data->scale_factor = 1;
+
+      pixel_size = _gtk_icon_helper_get_pixel_size (priv->icon_helper) * scale_factor;
+      if (pixel_size > 0 && (width > pixel_size || height > pixel_size))
+        {
+          loader_data->scale_factor = (double) pixel_size / MAX (width, height);
+          gdk_pixbuf_loader_set_size (loader,
+                                      MAX (1, width * loader_data->scale_factor + 0.5),
+                                      MAX (1, height * loader_data->scale_factor + 0.5));
+        }
       return;
     }
 
-  scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (loader_data->image));
   gdk_pixbuf_loader_set_size (loader, width * scale_factor, height * scale_factor);
   loader_data->scale_factor = scale_factor;
 }
@@ -574,7 +587,7 @@ static GdkPixbufAnimation *
 load_scalable_with_loader (GtkImage    *image,
 			   const gchar *file_path,
 			   const gchar *resource_path,
-			   gint        *scale_factor_out)
+			   double      *scale_factor_out)
 {
   GdkPixbufLoader *loader;
   GBytes *bytes;
@@ -645,7 +658,7 @@ gtk_image_set_from_file   (GtkImage    *image,
 {
   GtkImagePrivate *priv = gtk_image_get_instance_private (image);
   GdkPixbufAnimation *anim;
-  gint scale_factor;
+  double scale_factor;
   GdkTexture *texture;
   GdkPaintable *scaler;
 
@@ -728,7 +741,7 @@ gtk_image_set_from_resource (GtkImage    *image,
 {
   GtkImagePrivate *priv = gtk_image_get_instance_private (image);
   GdkPixbufAnimation *animation;
-  gint scale_factor = 1;
+  double scale_factor = 1;
   GdkTexture *texture;
   GdkPaintable *scaler;
 
@@ -357,7 +357,7 @@ check_table (GtkIMContextSimple    *context_simple,
 {
   GtkIMContextSimplePrivate *priv = context_simple->priv;
   gint row_stride = table->max_seq_len + 2; 
-  guint16 *seq; 
+  const guint16 *seq;
   
   /* Will never match, if the sequence in the compose buffer is longer
    * than the sequences in the table.  Further, compare_seq (key, val)
@@ -372,7 +372,7 @@ check_table (GtkIMContextSimple    *context_simple,
 
   if (seq)
     {
-      guint16 *prev_seq;
+      const guint16 *prev_seq;
 
       /* Back up to the first sequence that matches to make sure
        * we find the exact match if there is one.
@@ -388,7 +388,7 @@ check_table (GtkIMContextSimple    *context_simple,
       if (n_compose == table->max_seq_len ||
 	  seq[n_compose] == 0) /* complete sequence */
 	{
-	  guint16 *next_seq;
+	  const guint16 *next_seq;
 	  gunichar value = 
 	    0x10000 * seq[table->max_seq_len] + seq[table->max_seq_len + 1];
 
@@ -23,7 +23,12 @@
 #include "gtkkeyhash.h"
 #include "gtkprivate.h"
 
+/* The number of lookups to remember, beyond which the
+ * cache gets cleared */
+#define MAX_CACHED_LOOKUPS 256
+
 typedef struct _GtkKeyHashEntry GtkKeyHashEntry;
+typedef struct _GtkKeyHashLookup GtkKeyHashLookup;
 
 struct _GtkKeyHashEntry
 {
@@ -35,6 +40,17 @@ struct _GtkKeyHashEntry
    */
   GdkKeymapKey *keys;		
   gint n_keys;
+  GdkModifierType mapped_modifiers; /* modifiers with virtual ones mapped */
+  gboolean mapped;                  /* FALSE if the mapping failed */
+};
+
+/* A key event, as far as _gtk_key_hash_lookup() is concerned */
+struct _GtkKeyHashLookup
+{
+  guint16 hardware_keycode;
+  gint group;
+  GdkModifierType state;
+  GdkModifierType mask;
 };
 
 struct _GtkKeyHash
@@ -44,8 +60,44 @@ struct _GtkKeyHash
   GHashTable *reverse_hash;
   GList *entries_list;
   GDestroyNotify destroy_notify;
+
+  /* GtkKeyHashLookup => GSList of values, for repeated lookups */
+  GHashTable *lookup_cache;
 };
 
+static guint
+lookup_hash (gconstpointer data)
+{
+  const GtkKeyHashLookup *lookup = data;
+
+  return lookup->hardware_keycode ^ (lookup->group << 8) ^ (lookup->state << 10) ^ lookup->mask;
+}
+
+static gboolean
+lookup_equal (gconstpointer a,
+              gconstpointer b)
+{
+  const GtkKeyHashLookup *lookup_a = a;
+  const GtkKeyHashLookup *lookup_b = b;
+
+  return lookup_a->hardware_keycode == lookup_b->hardware_keycode &&
+         lookup_a->group == lookup_b->group &&
+         lookup_a->state == lookup_b->state &&
+         lookup_a->mask == lookup_b->mask;
+}
+
+static void
+lookup_free (gpointer data)
+{
+  g_slice_free (GtkKeyHashLookup, data);
+}
+
+static void
+key_hash_clear_lookup_cache (GtkKeyHash *key_hash)
+{
+  g_hash_table_remove_all (key_hash->lookup_cache);
+}
+
 static void
 key_hash_clear_keycode (gpointer key,
 			gpointer value,
@@ -65,6 +117,10 @@ key_hash_insert_entry (GtkKeyHash      *key_hash,
   gdk_keymap_get_entries_for_keyval (key_hash->keymap,
 				     entry->keyval,
 				     &entry->keys, &entry->n_keys);
+
+  entry->mapped_modifiers = entry->modifiers;
+  entry->mapped = gdk_keymap_map_virtual_modifiers (key_hash->keymap,
+                                                    &entry->mapped_modifiers);
   
   for (i = 0; i < entry->n_keys; i++)
     {
@@ -103,6 +159,8 @@ key_hash_keys_changed (GdkKeymap  *keymap,
 {
   /* The keymap changed, so we have to regenerate the keycode hash
    */
+  key_hash_clear_lookup_cache (key_hash);
+
   if (key_hash->keycode_hash)
     {
       g_hash_table_foreach (key_hash->keycode_hash, key_hash_clear_keycode, NULL);
@@ -135,6 +193,9 @@ _gtk_key_hash_new (GdkKeymap      *keymap,
   key_hash->keycode_hash = NULL;
   key_hash->reverse_hash = g_hash_table_new (g_direct_hash, NULL);
   key_hash->destroy_notify = item_destroy_notify;
+  key_hash->lookup_cache = g_hash_table_new_full (lookup_hash, lookup_equal,
+                                                  lookup_free,
+                                                  (GDestroyNotify) g_slist_free);
 
   return key_hash;
 }
@@ -180,6 +241,7 @@ _gtk_key_hash_free (GtkKeyHash *key_hash)
     }
   
   g_hash_table_destroy (key_hash->reverse_hash);
+  g_hash_table_destroy (key_hash->lookup_cache);
 
   g_list_foreach (key_hash->entries_list, key_hash_free_entry_foreach, key_hash);
   g_list_free (key_hash->entries_list);
@@ -209,6 +271,8 @@ _gtk_key_hash_add_entry (GtkKeyHash      *key_hash,
   entry->modifiers = modifiers;
   entry->keys = NULL;
 
+  key_hash_clear_lookup_cache (key_hash);
+
   key_hash->entries_list = g_list_prepend (key_hash->entries_list, entry);
   g_hash_table_insert (key_hash->reverse_hash, value, key_hash->entries_list);
 
@@ -234,6 +298,8 @@ _gtk_key_hash_remove_entry (GtkKeyHash *key_hash,
     {
       GtkKeyHashEntry *entry = entry_node->data;
 
+      key_hash_clear_lookup_cache (key_hash);
+
       if (key_hash->keycode_hash)
 	{
 	  gint i;
@@ -352,36 +418,12 @@ keyval_in_group (GdkKeymap  *keymap,
   return FALSE;
 }
 
-/**
- * _gtk_key_hash_lookup:
- * @key_hash: a #GtkKeyHash
- * @hardware_keycode: hardware keycode field from a #GdkEventKey
- * @state: state field from a #GdkEventKey
- * @mask: mask of modifiers to consider when matching against the
- *        modifiers in entries.
- * @group: group field from a #GdkEventKey
- * 
- * Looks up the best matching entry or entries in the hash table for
- * a given event. The results are sorted so that entries with less
- * modifiers come before entries with more modifiers.
- * 
- * The matches returned by this function can be exact (i.e. keycode, level
- * and group all match) or fuzzy (i.e. keycode and level match, but group
- * does not). As long there are any exact matches, only exact matches
- * are returned. If there are no exact matches, fuzzy matches will be
- * returned, as long as they are not shadowing a possible exact match.
- * This means that fuzzy matches won’t be considered if their keyval is 
- * present in the current group.
- * 
- * Returns: A newly-allocated #GSList of matching entries.
- *     Free with g_slist_free() when no longer needed.
- */
-GSList *
-_gtk_key_hash_lookup (GtkKeyHash      *key_hash,
-		      guint16          hardware_keycode,
-		      GdkModifierType  state,
-		      GdkModifierType  mask,
-		      gint             group)
+static GSList *
+key_hash_lookup (GtkKeyHash      *key_hash,
+		 guint16          hardware_keycode,
+		 GdkModifierType  state,
+		 GdkModifierType  mask,
+		 gint             group)
 {
   GHashTable *keycode_hash = key_hash_get_keycode_hash (key_hash);
   GSList *keys = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER ((guint)hardware_keycode));
@@ -438,8 +480,8 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 	   * both mapped to Mod4, then pressing a key that is mapped to Mod4
 	   * will not match a Super+Hyper entry.
 	   */
-          modifiers = entry->modifiers;
-          if (gdk_keymap_map_virtual_modifiers (key_hash->keymap, &modifiers) &&
+          modifiers = entry->mapped_modifiers;
+          if (entry->mapped &&
 	      ((modifiers & ~consumed_modifiers & mask & ~vmods) == (state & ~consumed_modifiers & mask & ~vmods) ||
 	       (modifiers & ~consumed_modifiers & mask & ~xmods) == (state & ~consumed_modifiers & mask & ~xmods)))
 	    {
@@ -523,6 +565,59 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
   return results;
 }
 
+/**
+ * _gtk_key_hash_lookup:
+ * @key_hash: a #GtkKeyHash
+ * @hardware_keycode: hardware keycode field from a #GdkEventKey
+ * @state: state field from a #GdkEventKey
+ * @mask: mask of modifiers to consider when matching against the
+ *        modifiers in entries.
+ * @group: group field from a #GdkEventKey
+ * 
+ * Looks up the best matching entry or entries in the hash table for
+ * a given event. The results are sorted so that entries with less
+ * modifiers come before entries with more modifiers.
+ * 
+ * The matches returned by this function can be exact (i.e. keycode, level
+ * and group all match) or fuzzy (i.e. keycode and level match, but group
+ * does not). As long there are any exact matches, only exact matches
+ * are returned. If there are no exact matches, fuzzy matches will be
+ * returned, as long as they are not shadowing a possible exact match.
+ * This means that fuzzy matches won’t be considered if their keyval is 
+ * present in the current group.
+ * 
+ * Returns: A newly-allocated #GSList of matching entries.
+ *     Free with g_slist_free() when no longer needed.
+ */
+GSList *
+_gtk_key_hash_lookup (GtkKeyHash      *key_hash,
+		      guint16          hardware_keycode,
+		      GdkModifierType  state,
+		      GdkModifierType  mask,
+		      gint             group)
+{
+  GtkKeyHashLookup lookup = { hardware_keycode, group, state & ~GDK_LOCK_MASK, mask };
+  gpointer cached_key;
+  gpointer cached;
+  GSList *results;
+
+  /* The same keys get pressed over and over, and the result only
+   * changes with the entries or the keymap, so remember it */
+  if (g_hash_table_lookup_extended (key_hash->lookup_cache, &lookup, &cached_key, &cached))
+    return g_slist_copy (cached);
+
+  results = key_hash_lookup (key_hash, hardware_keycode, state, mask, group);
+
+  if (g_hash_table_size (key_hash->lookup_cache) >= MAX_CACHED_LOOKUPS)
+    key_hash_clear_lookup_cache (key_hash);
+
+  g_hash_table_insert (key_hash->lookup_cache,
+                       g_slice_dup (GtkKeyHashLookup, &lookup),
+                       g_slist_copy (results));
+
+  return results;
+}
+
 /**
  * _gtk_key_hash_lookup_keyval:
  * @key_hash: a #GtkKeyHash
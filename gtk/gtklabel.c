@@ -250,6 +250,17 @@
  * the #GtkLabel::activate-link signal and the gtk_label_get_current_uri() function.
  */
 
+#define N_HEIGHT_CACHE 4
+
+/* A height-for-width result of the current layout. Widths that
+ * are not cached have a width of -1. */
+typedef struct
+{
+  int width;
+  int height;
+  int baseline;
+} GtkLabelHeight;
+
 struct _GtkLabelPrivate
 {
   GtkLabelSelectionInfo *select_info;
@@ -283,6 +294,12 @@ struct _GtkLabelPrivate
   gint     width_chars;
   gint     max_width_chars;
   gint     lines;
+
+  /* Heights measured for the current layout. They are reset with the
+   * layout and when the serial of its PangoContext changes. */
+  GtkLabelHeight height_cache[N_HEIGHT_CACHE];
+  guint    height_cache_next;
+  guint    height_cache_serial;
 };
 
 /* Notes about the handling of links:
@@ -462,6 +479,7 @@ static void gtk_label_set_selectable_hint (GtkLabel *label);
 static void gtk_label_ensure_select_info  (GtkLabel *label);
 static void gtk_label_clear_select_info   (GtkLabel *label);
 static void gtk_label_update_cursor       (GtkLabel *label);
+static void gtk_label_clear_height_cache  (GtkLabel *label);
 static void gtk_label_clear_layout        (GtkLabel *label);
 static void gtk_label_ensure_layout       (GtkLabel *label);
 static void gtk_label_select_region_index (GtkLabel *label,
@@ -1302,6 +1320,8 @@ gtk_label_init (GtkLabel *label)
   priv->mnemonic_window = NULL;
 
   priv->mnemonics_visible = TRUE;
+
+  gtk_label_clear_height_cache (label);
 }
 
 
@@ -3135,6 +3155,7 @@ gtk_label_set_line_wrap_mode (GtkLabel *label,
       priv->wrap_mode = wrap_mode;
       g_object_notify_by_pspec (G_OBJECT (label), label_props[PROP_WRAP_MODE]);
 
+      gtk_label_clear_layout (label);
       gtk_widget_queue_resize (GTK_WIDGET (label));
     }
 }
@@ -3191,12 +3212,23 @@ gtk_label_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_label_parent_class)->finalize (object);
 }
 
+static void
+gtk_label_clear_height_cache (GtkLabel *label)
+{
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+  guint i;
+
+  for (i = 0; i < N_HEIGHT_CACHE; i++)
+    priv->height_cache[i].width = -1;
+}
+
 static void
 gtk_label_clear_layout (GtkLabel *label)
 {
   GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
 
   g_clear_object (&priv->layout);
+  gtk_label_clear_height_cache (label);
 }
 
 /**
@@ -3282,6 +3314,8 @@ gtk_label_update_layout_attributes (GtkLabel *label)
   if (priv->layout == NULL)
     return;
 
+  gtk_label_clear_height_cache (label);
+
   context = gtk_widget_get_style_context (widget);
 
   if (priv->select_info && priv->select_info->links)
@@ -3391,6 +3425,37 @@ gtk_label_get_request_mode (GtkWidget *widget)
 }
 
 
+/* Containers like grids and boxes ask for the height of a wrapping
+ * label at the same few widths many times per layout pass, and each
+ * answer requires shaping and wrapping the whole text. So keep the
+ * last few answers around until the layout changes.
+ */
+static GtkLabelHeight *
+gtk_label_lookup_height (GtkLabel *label,
+                         int       width)
+{
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+  guint serial, i;
+
+  gtk_label_ensure_layout (label);
+
+  /* Font or resolution changes don't clear the layout */
+  serial = pango_context_get_serial (pango_layout_get_context (priv->layout));
+  if (serial != priv->height_cache_serial)
+    {
+      gtk_label_clear_height_cache (label);
+      priv->height_cache_serial = serial;
+    }
+
+  for (i = 0; i < N_HEIGHT_CACHE; i++)
+    {
+      if (priv->height_cache[i].width == width)
+        return &priv->height_cache[i];
+    }
+
+  return NULL;
+}
+
 static void
 get_height_for_width (GtkLabel *label,
                       gint      width,
@@ -3399,21 +3464,30 @@ get_height_for_width (GtkLabel *label,
                       gint     *minimum_baseline,
                       gint     *natural_baseline)
 {
-  PangoLayout *layout;
-  gint text_height, baseline;
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+  GtkLabelHeight *cached;
 
-  layout = gtk_label_get_measuring_layout (label, NULL, width * PANGO_SCALE);
+  cached = gtk_label_lookup_height (label, width);
+  if (cached == NULL)
+    {
+      PangoLayout *layout;
 
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+      cached = &priv->height_cache[priv->height_cache_next];
+      priv->height_cache_next = (priv->height_cache_next + 1) % N_HEIGHT_CACHE;
 
-  *minimum_height = text_height;
-  *natural_height = text_height;
+      layout = gtk_label_get_measuring_layout (label, NULL, width * PANGO_SCALE);
 
-  baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
-  *minimum_baseline = baseline;
-  *natural_baseline = baseline;
+      cached->width = width;
+      pango_layout_get_pixel_size (layout, NULL, &cached->height);
+      cached->baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
 
-  g_object_unref (layout);
+      g_object_unref (layout);
+    }
+
+  *minimum_height = cached->height;
+  *natural_height = cached->height;
+  *minimum_baseline = cached->baseline;
+  *natural_baseline = cached->baseline;
 }
 
 static gint
@@ -3578,11 +3652,7 @@ gtk_label_measure (GtkWidget      *widget,
   GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
 
   if (orientation == GTK_ORIENTATION_VERTICAL && for_size != -1 && priv->wrap)
-    {
-      gtk_label_clear_layout (label);
-
-      get_height_for_width (label, for_size, minimum, natural, minimum_baseline, natural_baseline);
-    }
+    get_height_for_width (label, for_size, minimum, natural, minimum_baseline, natural_baseline);
   else
     gtk_label_get_preferred_size (widget, orientation, minimum, natural, minimum_baseline, natural_baseline);
 }
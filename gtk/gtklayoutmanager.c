@@ -77,6 +77,8 @@
 #include "gtklayoutchild.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 #ifdef G_ENABLE_DEBUG
 #define LAYOUT_MANAGER_WARN_NOT_IMPLEMENTED(m,method)   G_STMT_START {  \
         GObject *_obj = G_OBJECT (m);                                   \
@@ -88,15 +90,44 @@
 #define LAYOUT_MANAGER_WARN_NOT_IMPLEMENTED(m,method)
 #endif
 
+/* What the last allocation of a child was based on */
+typedef struct {
+  GtkWidget *child;
+  int minimum[2];
+  int natural[2];
+  int minimum_baseline;
+  int natural_baseline;
+  guint visible : 1;
+  guint hexpand : 1;
+  guint vexpand : 1;
+} ChildRequest;
+
 typedef struct {
   GtkWidget *widget;
 
   /* HashTable<Widget, LayoutChild> */
   GHashTable *layout_children;
+
+  /* The last allocation, which stays valid while the size of the widget
+   * and the requests of its children don't change, see
+   * gtk_layout_manager_allocate() */
+  int allocated_width;
+  int allocated_height;
+  int allocated_baseline;
+  GArray *child_requests;
+  guint allocation_valid : 1;
+
+  /* Changes whenever the requests of the children may have changed */
+  guint request_serial;
 } GtkLayoutManagerPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GtkLayoutManager, gtk_layout_manager, G_TYPE_OBJECT)
 
+#ifdef G_ENABLE_DEBUG
+static guint allocations_skipped_counter;
+static gint64 n_allocations_skipped;
+#endif
+
 static GtkSizeRequestMode
 gtk_layout_manager_real_get_request_mode (GtkLayoutManager *manager,
                                           GtkWidget        *widget)
@@ -187,18 +218,40 @@ gtk_layout_manager_real_create_layout_child (GtkLayoutManager *manager,
                        NULL);
 }
 
+static void
+gtk_layout_manager_finalize (GObject *gobject)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (GTK_LAYOUT_MANAGER (gobject));
+
+  g_clear_pointer (&priv->child_requests, g_array_unref);
+
+  G_OBJECT_CLASS (gtk_layout_manager_parent_class)->finalize (gobject);
+}
+
 static void
 gtk_layout_manager_class_init (GtkLayoutManagerClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gtk_layout_manager_finalize;
+
   klass->get_request_mode = gtk_layout_manager_real_get_request_mode;
   klass->measure = gtk_layout_manager_real_measure;
   klass->allocate = gtk_layout_manager_real_allocate;
   klass->create_layout_child = gtk_layout_manager_real_create_layout_child;
+
+#ifdef G_ENABLE_DEBUG
+  allocations_skipped_counter = gdk_profiler_define_int_counter ("allocations-skipped",
+                                                                 "Layouts skipped because nothing changed");
+#endif
 }
 
 static void
 gtk_layout_manager_init (GtkLayoutManager *self)
 {
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (self);
+
+  priv->request_serial = 1;
 }
 
 /*< private >
@@ -225,6 +278,156 @@ gtk_layout_manager_set_widget (GtkLayoutManager *layout_manager,
     }
 
   priv->widget = widget;
+  priv->allocation_valid = FALSE;
+  priv->request_serial++;
+}
+
+/*< private >
+ * gtk_layout_manager_invalidate_allocation:
+ * @manager: a #GtkLayoutManager
+ *
+ * Makes the next gtk_layout_manager_allocate() run the layout again,
+ * even if the size of the widget and the requests of its children
+ * stay the same. This is needed whenever a resize or an allocation
+ * gets queued on the widget itself.
+ */
+void
+gtk_layout_manager_invalidate_allocation (GtkLayoutManager *manager)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
+
+  priv->allocation_valid = FALSE;
+  priv->request_serial++;
+}
+
+/*< private >
+ * gtk_layout_manager_requests_changed:
+ * @manager: a #GtkLayoutManager
+ *
+ * Called when the size request cache of the widget gets cleared,
+ * since the children may request different sizes now.
+ */
+void
+gtk_layout_manager_requests_changed (GtkLayoutManager *manager)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
+
+  priv->request_serial++;
+}
+
+/*< private >
+ * gtk_layout_manager_get_request_serial:
+ * @manager: a #GtkLayoutManager
+ *
+ * Returns a number that changes whenever the children of the widget
+ * using @manager may request different sizes, or the layout changed.
+ * Layout managers can use it to keep what they computed from the
+ * requests of the children across measure() and allocate() calls.
+ *
+ * Returns: the request serial
+ */
+guint
+gtk_layout_manager_get_request_serial (GtkLayoutManager *manager)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
+
+  return priv->request_serial;
+}
+
+static void
+child_request_init (ChildRequest *request,
+                    GtkWidget    *child)
+{
+  request->child = child;
+  request->visible = gtk_widget_get_visible (child) && gtk_widget_get_child_visible (child);
+  request->hexpand = gtk_widget_compute_expand (child, GTK_ORIENTATION_HORIZONTAL);
+  request->vexpand = gtk_widget_compute_expand (child, GTK_ORIENTATION_VERTICAL);
+
+  /* These come from the size request cache */
+  gtk_widget_measure (child, GTK_ORIENTATION_HORIZONTAL, -1,
+                      &request->minimum[GTK_ORIENTATION_HORIZONTAL],
+                      &request->natural[GTK_ORIENTATION_HORIZONTAL],
+                      NULL, NULL);
+  gtk_widget_measure (child, GTK_ORIENTATION_VERTICAL, -1,
+                      &request->minimum[GTK_ORIENTATION_VERTICAL],
+                      &request->natural[GTK_ORIENTATION_VERTICAL],
+                      &request->minimum_baseline,
+                      &request->natural_baseline);
+}
+
+static gboolean
+child_request_equal (const ChildRequest *a,
+                     const ChildRequest *b)
+{
+  return a->child == b->child &&
+         a->visible == b->visible &&
+         a->hexpand == b->hexpand &&
+         a->vexpand == b->vexpand &&
+         a->minimum[0] == b->minimum[0] &&
+         a->minimum[1] == b->minimum[1] &&
+         a->natural[0] == b->natural[0] &&
+         a->natural[1] == b->natural[1] &&
+         a->minimum_baseline == b->minimum_baseline &&
+         a->natural_baseline == b->natural_baseline;
+}
+
+/* Remembers what the children requested for the allocation that was
+ * just done. Children whose size depends on the size they get can not
+ * be compared this way, so their parent always does the layout again. */
+static void
+gtk_layout_manager_save_child_requests (GtkLayoutManager *manager,
+                                        GtkWidget        *widget)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
+  GtkWidget *child;
+
+  if (priv->child_requests == NULL)
+    priv->child_requests = g_array_new (FALSE, FALSE, sizeof (ChildRequest));
+
+  g_array_set_size (priv->child_requests, 0);
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      ChildRequest request;
+
+      if (gtk_widget_get_request_mode (child) != GTK_SIZE_REQUEST_CONSTANT_SIZE)
+        return;
+
+      child_request_init (&request, child);
+      g_array_append_val (priv->child_requests, request);
+    }
+
+  priv->allocation_valid = TRUE;
+}
+
+static gboolean
+gtk_layout_manager_child_requests_changed (GtkLayoutManager *manager,
+                                           GtkWidget        *widget)
+{
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
+  GtkWidget *child;
+  guint i = 0;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      ChildRequest request;
+
+      if (i >= priv->child_requests->len ||
+          gtk_widget_get_request_mode (child) != GTK_SIZE_REQUEST_CONSTANT_SIZE)
+        return TRUE;
+
+      child_request_init (&request, child);
+      if (!child_request_equal (&request, &g_array_index (priv->child_requests, ChildRequest, i)))
+        return TRUE;
+
+      i++;
+    }
+
+  return i != priv->child_requests->len;
 }
 
 /**
@@ -295,15 +498,50 @@ gtk_layout_manager_allocate (GtkLayoutManager *manager,
                              int               height,
                              int               baseline)
 {
+  GtkLayoutManagerPrivate *priv = gtk_layout_manager_get_instance_private (manager);
   GtkLayoutManagerClass *klass;
 
   g_return_if_fail (GTK_IS_LAYOUT_MANAGER (manager));
   g_return_if_fail (GTK_IS_WIDGET (widget));
   g_return_if_fail (baseline >= -1);
 
+  /* A resize queued on a child propagates to all of its ancestors, even
+   * when the child ends up requesting the same size. The layout is the
+   * same then, so only the children that need it get allocated again,
+   * with the allocation they already have. */
+  if (priv->allocation_valid &&
+      priv->allocated_width == width &&
+      priv->allocated_height == height &&
+      priv->allocated_baseline == baseline &&
+      !gtk_layout_manager_child_requests_changed (manager, widget))
+    {
+      GtkWidget *child;
+
+      for (child = _gtk_widget_get_first_child (widget);
+           child != NULL;
+           child = _gtk_widget_get_next_sibling (child))
+        gtk_widget_ensure_allocate (child);
+
+#ifdef G_ENABLE_DEBUG
+      n_allocations_skipped++;
+      if (gdk_profiler_is_running ())
+        gdk_profiler_set_int_counter (allocations_skipped_counter,
+                                      g_get_monotonic_time () * 1000,
+                                      n_allocations_skipped);
+#endif
+      return;
+    }
+
+  priv->allocation_valid = FALSE;
+
   klass = GTK_LAYOUT_MANAGER_GET_CLASS (manager);
 
   klass->allocate (manager, widget, width, height, baseline);
+
+  priv->allocated_width = width;
+  priv->allocated_height = height;
+  priv->allocated_baseline = baseline;
+  gtk_layout_manager_save_child_requests (manager, widget);
 }
 
 /**
@@ -361,6 +599,9 @@ gtk_layout_manager_layout_changed (GtkLayoutManager *manager)
 
   g_return_if_fail (GTK_IS_LAYOUT_MANAGER (manager));
 
+  priv->allocation_valid = FALSE;
+  priv->request_serial++;
+
   if (priv->widget != NULL)
     gtk_widget_queue_resize (priv->widget);
 }
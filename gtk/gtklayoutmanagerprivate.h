@@ -10,4 +10,9 @@ void gtk_layout_manager_set_widget (GtkLayoutManager *manager,
 void gtk_layout_manager_remove_layout_child (GtkLayoutManager *manager,
                                              GtkWidget        *widget);
 
+void gtk_layout_manager_invalidate_allocation (GtkLayoutManager *manager);
+
+void  gtk_layout_manager_requests_changed     (GtkLayoutManager *manager);
+guint gtk_layout_manager_get_request_serial   (GtkLayoutManager *manager);
+
 G_END_DECLS
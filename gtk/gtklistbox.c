@@ -125,6 +125,9 @@ typedef struct
   GtkListBoxCreateWidgetFunc create_widget_func;
   gpointer create_widget_func_data;
   GDestroyNotify create_widget_func_data_destroy;
+  guint n_bound_rows; /* rows exist for the first n_bound_rows items */
+  guint bound_rows_id;
+  int bound_rows_end;
 } GtkListBoxPrivate;
 
 typedef struct
@@ -178,6 +181,9 @@ enum {
   LAST_ROW_PROPERTY = ROW_PROP_ACTION_NAME
 };
 
+/* Time budget for creating rows of a bound model in one idle step */
+#define BOUND_ROWS_STEP_TIME (G_USEC_PER_SEC / 200)
+
 #define BOX_PRIV(box) ((GtkListBoxPrivate*)gtk_list_box_get_instance_private ((GtkListBox*)(box)))
 #define ROW_PRIV(row) ((GtkListBoxRowPrivate*)gtk_list_box_row_get_instance_private ((GtkListBoxRow*)(row)))
 
@@ -287,6 +293,9 @@ static void                 gtk_list_box_bound_model_changed            (GListMo
                                                                          gpointer             user_data);
 
 static void                 gtk_list_box_check_model_compat             (GtkListBox          *box);
+static void                 gtk_list_box_ensure_bound_rows              (GtkListBox          *box,
+                                                                         guint                n_rows);
+static void                 gtk_list_box_check_bound_rows               (GtkListBox          *box);
 
 static void gtk_list_box_measure (GtkWidget     *widget,
                                   GtkOrientation  orientation,
@@ -384,6 +393,9 @@ gtk_list_box_finalize (GObject *obj)
   if (priv->update_header_func_target_destroy_notify != NULL)
     priv->update_header_func_target_destroy_notify (priv->update_header_func_target);
 
+  g_clear_handle_id (&priv->bound_rows_id, g_source_remove);
+  if (priv->adjustment)
+    g_signal_handlers_disconnect_by_func (priv->adjustment, gtk_list_box_check_bound_rows, obj);
   g_clear_object (&priv->adjustment);
   g_clear_object (&priv->drag_highlighted_row);
 
@@ -693,6 +705,9 @@ gtk_list_box_get_row_at_index (GtkListBox *box,
 
   g_return_val_if_fail (GTK_IS_LIST_BOX (box), NULL);
 
+  if (index_ >= 0)
+    gtk_list_box_ensure_bound_rows (box, (guint) index_ + 1);
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, index_);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -805,6 +820,8 @@ gtk_list_box_select_all (GtkListBox *box)
   if (BOX_PRIV (box)->selection_mode != GTK_SELECTION_MULTIPLE)
     return;
 
+  gtk_list_box_ensure_bound_rows (box, G_MAXUINT);
+
   if (g_sequence_get_length (BOX_PRIV (box)->children) > 0)
     {
       gtk_list_box_select_all_between (box, NULL, NULL, FALSE);
@@ -973,8 +990,20 @@ gtk_list_box_set_adjustment (GtkListBox    *box,
   if (adjustment)
     g_object_ref_sink (adjustment);
   if (priv->adjustment)
-    g_object_unref (priv->adjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->adjustment, gtk_list_box_check_bound_rows, box);
+      g_object_unref (priv->adjustment);
+    }
   priv->adjustment = adjustment;
+  if (adjustment)
+    {
+      g_signal_connect_swapped (adjustment, "value-changed",
+                                G_CALLBACK (gtk_list_box_check_bound_rows), box);
+      g_signal_connect_swapped (adjustment, "changed",
+                                G_CALLBACK (gtk_list_box_check_bound_rows), box);
+    }
+
+  gtk_list_box_check_bound_rows (box);
 }
 
 /**
@@ -2424,6 +2453,8 @@ gtk_list_box_measure (GtkWidget     *widget,
 {
   GtkListBoxPrivate *priv = BOX_PRIV (widget);
   GSequenceIter *iter;
+  int placeholder_height;
+  guint n_rows;
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
@@ -2478,11 +2509,13 @@ gtk_list_box_measure (GtkWidget     *widget,
         }
 
       *minimum = 0;
+      n_rows = 0;
 
       if (priv->placeholder && gtk_widget_get_child_visible (priv->placeholder))
         gtk_widget_measure (priv->placeholder, orientation, for_size,
                             minimum, NULL,
                             NULL, NULL);
+      placeholder_height = *minimum;
 
       for (iter = g_sequence_get_begin_iter (priv->children);
            !g_sequence_iter_is_end (iter);
@@ -2506,6 +2539,19 @@ gtk_list_box_measure (GtkWidget     *widget,
                               &row_min, NULL,
                               NULL, NULL);
           *minimum += row_min;
+          n_rows++;
+        }
+
+      /* Items of a bound model that don't have rows yet are assumed to
+       * be as high as the average row, so the height stays roughly the
+       * same while the rows get created.
+       */
+      if (priv->bound_model && n_rows > 0)
+        {
+          guint n_items = g_list_model_get_n_items (priv->bound_model);
+
+          if (n_items > priv->n_bound_rows)
+            *minimum += (gint64) (*minimum - placeholder_height) * (n_items - priv->n_bound_rows) / n_rows;
         }
 
       /* We always allocate the minimum height, since handling expanding rows
@@ -2587,6 +2633,9 @@ gtk_list_box_size_allocate (GtkWidget *widget,
       gtk_widget_size_allocate (GTK_WIDGET (row), &child_allocation, -1);
       child_allocation.y += child_min;
     }
+
+  priv->bound_rows_end = child_allocation.y;
+  gtk_list_box_check_bound_rows (GTK_LIST_BOX (widget));
 }
 
 /**
@@ -2774,7 +2823,10 @@ gtk_list_box_move_cursor (GtkListBox      *box,
       if (count < 0)
         row = gtk_list_box_get_first_focusable (box);
       else
-        row = gtk_list_box_get_last_focusable (box);
+        {
+          gtk_list_box_ensure_bound_rows (box, G_MAXUINT);
+          row = gtk_list_box_get_last_focusable (box);
+        }
       break;
     case GTK_MOVEMENT_DISPLAY_LINES:
       if (priv->cursor_row != NULL)
@@ -3489,6 +3541,137 @@ gtk_list_box_buildable_interface_init (GtkBuildableIface *iface)
   iface->add_child = gtk_list_box_buildable_add_child;
 }
 
+static void
+gtk_list_box_create_bound_row (GtkListBox *box,
+                               guint       position)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GObject *item;
+  GtkWidget *widget;
+
+  item = g_list_model_get_item (priv->bound_model, position);
+  widget = priv->create_widget_func (item, priv->create_widget_func_data);
+
+  /* We allow the create_widget_func to either return a full
+   * reference or a floating reference.  If we got the floating
+   * reference, then turn it into a full reference now.  That means
+   * that gtk_list_box_insert() will take another full reference.
+   * Finally, we'll release this full reference below, leaving only
+   * the one held by the box.
+   */
+  if (g_object_is_floating (widget))
+    g_object_ref_sink (widget);
+
+  gtk_widget_show (widget);
+  gtk_list_box_insert (box, widget, position);
+  priv->n_bound_rows++;
+
+  g_object_unref (widget);
+  g_object_unref (item);
+}
+
+static void
+gtk_list_box_ensure_bound_rows (GtkListBox *box,
+                                guint       n_rows)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model == NULL)
+    return;
+
+  n_rows = MIN (n_rows, g_list_model_get_n_items (priv->bound_model));
+
+  while (priv->n_bound_rows < n_rows)
+    gtk_list_box_create_bound_row (box, priv->n_bound_rows);
+}
+
+/* Returns the y coordinate that the rows of a bound model need
+ * to reach, that is the end of the visible area plus a page, or
+ * G_MAXINT if all rows are needed.
+ */
+static int
+gtk_list_box_get_bound_rows_target (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  double page_size;
+
+  if (priv->adjustment == NULL)
+    return G_MAXINT;
+
+  page_size = gtk_adjustment_get_page_size (priv->adjustment);
+
+  return gtk_adjustment_get_value (priv->adjustment) + 2 * page_size;
+}
+
+static gboolean
+gtk_list_box_create_bound_rows_cb (gpointer data)
+{
+  GtkListBox *box = data;
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  gint64 end_time;
+  guint n_items;
+  int target, width, row_min;
+
+  end_time = g_get_monotonic_time () + BOUND_ROWS_STEP_TIME;
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  target = gtk_list_box_get_bound_rows_target (box);
+  width = gtk_widget_get_width (GTK_WIDGET (box));
+
+  while (priv->n_bound_rows < n_items && priv->bound_rows_end < target)
+    {
+      gtk_list_box_create_bound_row (box, priv->n_bound_rows);
+
+      /* Until the next allocation, guess where the rows end */
+      if (width > 0)
+        {
+          GSequenceIter *iter = g_sequence_iter_prev (g_sequence_get_end_iter (priv->children));
+
+          gtk_widget_measure (g_sequence_get (iter),
+                              GTK_ORIENTATION_VERTICAL, width,
+                              &row_min, NULL, NULL, NULL);
+          priv->bound_rows_end += row_min;
+        }
+
+      /* Without an allocation, we can't tell how much is needed, so
+       * wait for the next size_allocate() to check again. */
+      if (g_get_monotonic_time () >= end_time)
+        {
+          if (width > 0)
+            return G_SOURCE_CONTINUE;
+          break;
+        }
+    }
+
+  priv->bound_rows_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Rows for the items of a bound model are only created once they come
+ * close to the visible area of the adjustment, so binding big models
+ * doesn't create widgets for all items up front. Rows are created in
+ * an idle in steps of BOUND_ROWS_STEP_TIME.
+ */
+static void
+gtk_list_box_check_bound_rows (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model == NULL || priv->bound_rows_id != 0)
+    return;
+
+  if (priv->n_bound_rows >= g_list_model_get_n_items (priv->bound_model))
+    return;
+
+  /* Before the first allocation, we don't know where the rows end */
+  if (gtk_widget_get_width (GTK_WIDGET (box)) > 0 &&
+      priv->bound_rows_end >= gtk_list_box_get_bound_rows_target (box))
+    return;
+
+  priv->bound_rows_id = g_idle_add (gtk_list_box_create_bound_rows_cb, box);
+  g_source_set_name_by_id (priv->bound_rows_id, "[gtk] gtk_list_box_create_bound_rows_cb");
+}
+
 static void
 gtk_list_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3500,38 +3683,34 @@ gtk_list_box_bound_model_changed (GListModel *list,
   GtkListBoxPrivate *priv = BOX_PRIV (user_data);
   guint i;
 
+  /* Only items that have rows need to be removed */
+  if (position < priv->n_bound_rows)
+    removed = MIN (removed, priv->n_bound_rows - position);
+  else
+    removed = 0;
+
   while (removed--)
     {
       GtkListBoxRow *row;
 
       row = gtk_list_box_get_row_at_index (box, position);
       gtk_container_remove (GTK_CONTAINER (box), GTK_WIDGET (row));
+      priv->n_bound_rows--;
     }
 
-  for (i = 0; i < added; i++)
+  /* Rows always exist for a contiguous range of items at the start,
+   * so added items get rows if they are inside that range. Without an
+   * adjustment, all items are visible and get rows right away.
+   */
+  if (position < priv->n_bound_rows ||
+      (position == priv->n_bound_rows && priv->adjustment == NULL))
     {
-      GObject *item;
-      GtkWidget *widget;
-
-      item = g_list_model_get_item (list, position + i);
-      widget = priv->create_widget_func (item, priv->create_widget_func_data);
-
-      /* We allow the create_widget_func to either return a full
-       * reference or a floating reference.  If we got the floating
-       * reference, then turn it into a full reference now.  That means
-       * that gtk_list_box_insert() will take another full reference.
-       * Finally, we'll release this full reference below, leaving only
-       * the one held by the box.
-       */
-      if (g_object_is_floating (widget))
-        g_object_ref_sink (widget);
-
-      gtk_widget_show (widget);
-      gtk_list_box_insert (box, widget, position + i);
-
-      g_object_unref (widget);
-      g_object_unref (item);
+      for (i = 0; i < added; i++)
+        gtk_list_box_create_bound_row (box, position + i);
     }
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+  gtk_list_box_check_bound_rows (box);
 }
 
 static void
@@ -3562,6 +3741,11 @@ gtk_list_box_check_model_compat (GtkListBox *box)
  * represent items from @model. @box is updated whenever @model changes.
  * If @model is %NULL, @box is left empty.
  *
+ * If @box is inside a scrollable parent like a #GtkViewport, widgets are
+ * only created for items once they get close to being scrolled into view,
+ * and the height of the remaining items is estimated from the existing
+ * rows. gtk_list_box_get_row_at_index() creates the widgets it needs.
+ *
  * It is undefined to add or remove widgets directly (for example, with
  * gtk_list_box_insert() or gtk_container_add()) while @box is bound to a
  * model.
@@ -3591,6 +3775,7 @@ gtk_list_box_bind_model (GtkListBox                 *box,
 
       g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_list_box_bound_model_changed, box);
       g_clear_object (&priv->bound_model);
+      g_clear_handle_id (&priv->bound_rows_id, g_source_remove);
     }
 
   iter = g_sequence_get_begin_iter (priv->children);
@@ -3600,6 +3785,8 @@ gtk_list_box_bind_model (GtkListBox                 *box,
       iter = g_sequence_iter_next (iter);
       gtk_list_box_remove (GTK_CONTAINER (box), row);
     }
+  priv->n_bound_rows = 0;
+  priv->bound_rows_end = 0;
 
 
   if (model == NULL)
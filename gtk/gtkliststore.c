@@ -556,14 +556,22 @@ gtk_list_store_set_column_type (GtkListStore *list_store,
   priv->column_headers[column] = type;
 }
 
+static void
+gtk_list_store_free_row (gpointer data,
+                         gpointer user_data)
+{
+  GtkListStorePrivate *priv = user_data;
+
+  _gtk_tree_data_list_row_free (data, priv->n_columns, priv->column_headers);
+}
+
 static void
 gtk_list_store_finalize (GObject *object)
 {
   GtkListStore *list_store = GTK_LIST_STORE (object);
   GtkListStorePrivate *priv = list_store->priv;
 
-  g_sequence_foreach (priv->seq,
-		      (GFunc) _gtk_tree_data_list_free, priv->column_headers);
+  g_sequence_foreach (priv->seq, gtk_list_store_free_row, priv);
 
   g_sequence_free (priv->seq);
 
@@ -669,21 +677,17 @@ gtk_list_store_get_value (GtkTreeModel *tree_model,
 {
   GtkListStore *list_store = GTK_LIST_STORE (tree_model);
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  gint tmp_column = column;
+  GtkTreeDataList *row;
 
   g_return_if_fail (column < priv->n_columns);
   g_return_if_fail (iter_is_valid (iter, list_store));
 		    
-  list = g_sequence_get (iter->user_data);
-
-  while (tmp_column-- > 0 && list)
-    list = list->next;
+  row = g_sequence_get (iter->user_data);
 
-  if (list == NULL)
+  if (row == NULL)
     g_value_init (value, priv->column_headers[column]);
   else
-    _gtk_tree_data_list_node_to_value (list,
+    _gtk_tree_data_list_node_to_value (&row[column],
 				       priv->column_headers[column],
 				       value);
 }
@@ -819,9 +823,7 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
 			       gboolean      sort)
 {
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  gint old_column = column;
+  GtkTreeDataList *row;
   GValue real_value = G_VALUE_INIT;
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -850,60 +852,26 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
       converted = TRUE;
     }
 
-  prev = list = g_sequence_get (iter->user_data);
-
-  while (list != NULL)
-    {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-         if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-            gtk_list_store_sort_iter_changed (list_store, iter, old_column);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
-    }
-
-  if (g_sequence_get (iter->user_data) == NULL)
-    {
-      list = _gtk_tree_data_list_alloc();
-      g_sequence_set (iter->user_data, list);
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
+  row = g_sequence_get (iter->user_data);
 
-  while (column != 0)
+  /* Rows get all their cells the first time one is set */
+  if (row == NULL)
     {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
+      row = _gtk_tree_data_list_row_new (priv->n_columns);
+      g_sequence_set (iter->user_data, row);
     }
 
   if (converted)
-    _gtk_tree_data_list_value_to_node (list, &real_value);
+    _gtk_tree_data_list_value_to_node (&row[column], &real_value);
   else
-    _gtk_tree_data_list_value_to_node (list, value);
+    _gtk_tree_data_list_value_to_node (&row[column], value);
 
   retval = TRUE;
   if (converted)
     g_value_unset (&real_value);
 
   if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    gtk_list_store_sort_iter_changed (list_store, iter, old_column);
+    gtk_list_store_sort_iter_changed (list_store, iter, column);
 
   return retval;
 }
@@ -1207,7 +1175,7 @@ gtk_list_store_remove (GtkListStore *list_store,
   ptr = iter->user_data;
   next = g_sequence_iter_next (ptr);
   
-  _gtk_tree_data_list_free (g_sequence_get (ptr), priv->column_headers);
+  _gtk_tree_data_list_row_free (g_sequence_get (ptr), priv->n_columns, priv->column_headers);
   g_sequence_remove (iter->user_data);
 
   priv->length--;
@@ -1560,33 +1528,12 @@ gtk_list_store_drag_data_received (GtkTreeDragDest   *drag_dest,
        */
       if (retval)
         {
-          GtkTreeDataList *dl = g_sequence_get (src_iter.user_data);
-          GtkTreeDataList *copy_head = NULL;
-          GtkTreeDataList *copy_prev = NULL;
-          GtkTreeDataList *copy_iter = NULL;
+          GtkTreeDataList *row = g_sequence_get (src_iter.user_data);
 	  GtkTreePath *path;
-          gint col;
-
-          col = 0;
-          while (dl)
-            {
-              copy_iter = _gtk_tree_data_list_node_copy (dl,
-                                                         priv->column_headers[col]);
-
-              if (copy_head == NULL)
-                copy_head = copy_iter;
-
-              if (copy_prev)
-                copy_prev->next = copy_iter;
-
-              copy_prev = copy_iter;
-
-              dl = dl->next;
-              ++col;
-            }
 
 	  dest_iter.stamp = priv->stamp;
-          g_sequence_set (dest_iter.user_data, copy_head);
+          g_sequence_set (dest_iter.user_data,
+                          _gtk_tree_data_list_row_copy (row, priv->n_columns, priv->column_headers));
 
 	  path = gtk_list_store_get_path (tree_model, &dest_iter);
 	  gtk_tree_model_row_changed (tree_model, path, &dest_iter);
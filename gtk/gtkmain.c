@@ -129,9 +129,9 @@
 #include "gtkwidgetprivate.h"
 #include "gtkwindowprivate.h"
 #include "gtkwindowgroup.h"
-#include "gtkprintbackend.h"
 #include "gtkimmodule.h"
 #include "gtkroot.h"
+#include "gtkstartupprivate.h"
 
 #include "a11y/gtkaccessibility.h"
 #include "inspector/window.h"
@@ -178,7 +178,8 @@ static const GDebugKey gtk_debug_keys[] = {
   { "actions", GTK_DEBUG_ACTIONS },
   { "resize", GTK_DEBUG_RESIZE },
   { "layout", GTK_DEBUG_LAYOUT },
-  { "snapshot", GTK_DEBUG_SNAPSHOT }
+  { "snapshot", GTK_DEBUG_SNAPSHOT },
+  { "startup", GTK_DEBUG_STARTUP }
 };
 #endif /* G_ENABLE_DEBUG */
 
@@ -640,13 +641,15 @@ gettext_initialization (void)
 static void
 default_display_notify_cb (GdkDisplayManager *dm)
 {
+  gint64 start = gtk_startup_begin (GTK_STARTUP_MODULES);
+
   debug_flags[0].display = gdk_display_get_default ();
-#ifdef G_OS_UNIX
-  gtk_print_backends_init ();
-#endif
+  /* Print backends get loaded by gtk_print_backend_load_modules() */
   gtk_im_modules_init ();
   gtk_media_file_extension_init ();
   _gtk_accessibility_init ();
+
+  gtk_startup_end (GTK_STARTUP_MODULES, start);
 }
 
 static void
@@ -782,11 +785,14 @@ gtk_simulate_touchscreen (void)
 gboolean
 gtk_init_check (void)
 {
+  gint64 start, display_start;
   gboolean ret;
 
   if (gtk_initialized)
     return TRUE;
 
+  start = gtk_startup_begin (GTK_STARTUP_INIT);
+
   gettext_initialization ();
 
   if (!check_setugid ())
@@ -797,11 +803,15 @@ gtk_init_check (void)
 
   initialized_thread = g_thread_self ();
 
+  display_start = gtk_startup_begin (GTK_STARTUP_DISPLAY);
   ret = gdk_display_open_default () != NULL;
+  gtk_startup_end (GTK_STARTUP_DISPLAY, display_start);
 
   if (ret && (gtk_get_debug_flags () & GTK_DEBUG_INTERACTIVE))
     gtk_window_set_interactive_debugging (TRUE);
 
+  gtk_startup_end (GTK_STARTUP_INIT, start);
+
   return ret;
 }
 
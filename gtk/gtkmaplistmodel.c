@@ -37,9 +37,14 @@
  * FIXME: Add useful examples here, like turning #GFile into #GFileInfo or #GdkPixmap.
  *
  * #GtkMapListModel will attempt to discard the mapped objects as soon as they are no
- * longer needed and recreate them if necessary.
+ * longer needed and recreate them if necessary. The most recently used mapped
+ * objects are kept alive, so that querying the same items repeatedly does not
+ * map them again every time.
  */
 
+/* Number of recently used mapped items we keep a reference to */
+#define MAP_CACHE_SIZE 64
+
 enum {
   PROP_0,
   PROP_HAS_MAP,
@@ -73,6 +78,11 @@ struct _GtkMapListModel
   GDestroyNotify user_destroy;
 
   GtkRbTree *items; /* NULL if map_func == NULL */
+
+  /* Ring buffer of the most recently used mapped items. Items can
+   * be in it multiple times, every entry holds a reference. */
+  gpointer cache[MAP_CACHE_SIZE];
+  guint cache_next;
 };
 
 struct _GtkMapListModelClass
@@ -122,6 +132,45 @@ gtk_map_list_model_get_nth (GtkRbTree *tree,
   return node;
 }
 
+static void
+gtk_map_list_model_cache_item (GtkMapListModel *self,
+                               gpointer         item)
+{
+  gpointer old = self->cache[self->cache_next];
+
+  self->cache[self->cache_next] = g_object_ref (item);
+  self->cache_next = (self->cache_next + 1) % MAP_CACHE_SIZE;
+
+  if (old)
+    g_object_unref (old);
+}
+
+static void
+gtk_map_list_model_uncache_item (GtkMapListModel *self,
+                                 gpointer         item)
+{
+  guint i;
+
+  for (i = 0; i < MAP_CACHE_SIZE; i++)
+    {
+      if (self->cache[i] == item)
+        {
+          self->cache[i] = NULL;
+          g_object_unref (item);
+        }
+    }
+}
+
+static void
+gtk_map_list_model_clear_cache (GtkMapListModel *self)
+{
+  guint i;
+
+  for (i = 0; i < MAP_CACHE_SIZE; i++)
+    g_clear_object (&self->cache[i]);
+  self->cache_next = 0;
+}
+
 static GType
 gtk_map_list_model_get_item_type (GListModel *list)
 {
@@ -160,7 +209,12 @@ gtk_map_list_model_get_item (GListModel *list,
     return NULL;
 
   if (node->item)
-    return g_object_ref (node->item);
+    {
+      /* Only cache the item if it isn't the last one we used */
+      if (self->cache[(self->cache_next + MAP_CACHE_SIZE - 1) % MAP_CACHE_SIZE] != node->item)
+        gtk_map_list_model_cache_item (self, node->item);
+      return g_object_ref (node->item);
+    }
 
   if (offset != position)
     {
@@ -185,6 +239,7 @@ gtk_map_list_model_get_item (GListModel *list,
                   G_OBJECT_TYPE_NAME (node->item), g_type_name (self->item_type));
     }
   g_object_add_weak_pointer (node->item, &node->item);
+  gtk_map_list_model_cache_item (self, node->item);
 
   return node->item;
 }
@@ -208,7 +263,7 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
                                      GtkMapListModel *self)
 {
   MapNode *node;
-  guint start, end;
+  guint start, end, to_remove;
 
   if (self->items == NULL)
     {
@@ -216,25 +271,28 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
       return;
     }
 
+  to_remove = removed;
   node = gtk_map_list_model_get_nth (self->items, position, &start);
   g_assert (start <= position);
 
-  while (removed > 0)
+  while (to_remove > 0)
     {
       end = start + node->n_items;
-      if (start == position && end <= position + removed)
+      if (start == position && end <= position + to_remove)
         {
           MapNode *next = gtk_rb_tree_node_get_next (node);
-          removed -= node->n_items;
+          to_remove -= node->n_items;
+          if (node->item)
+            gtk_map_list_model_uncache_item (self, node->item);
           gtk_rb_tree_remove (self->items, node);
           node = next;
         }
       else
         {
-          if (end >= position + removed)
+          if (end >= position + to_remove)
             {
-              node->n_items -= removed;
-              removed = 0;
+              node->n_items -= to_remove;
+              to_remove = 0;
               gtk_rb_tree_node_mark_dirty (node);
             }
           else if (start < position)
@@ -242,7 +300,7 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
               guint overlap = node->n_items - (position - start);
               node->n_items -= overlap;
               gtk_rb_tree_node_mark_dirty (node);
-              removed -= overlap;
+              to_remove -= overlap;
               start = position;
               node = gtk_rb_tree_node_get_next (node);
             }
@@ -337,6 +395,7 @@ gtk_map_list_model_dispose (GObject *object)
   self->user_data = NULL;
   self->user_destroy = NULL;
   g_clear_pointer (&self->items, gtk_rb_tree_unref);
+  gtk_map_list_model_clear_cache (self);
 
   G_OBJECT_CLASS (gtk_map_list_model_parent_class)->dispose (object);
 }
@@ -466,6 +525,8 @@ gtk_map_list_model_clear_node (gpointer _node)
 static void
 gtk_map_list_model_init_items (GtkMapListModel *self)
 {
+  gtk_map_list_model_clear_cache (self);
+
   if (self->map_func && self->model)
     {
       guint n_items;
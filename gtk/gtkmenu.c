@@ -891,6 +891,39 @@ gtk_menu_get_property (GObject     *object,
     }
 }
 
+/* Context menus, like the ones of text widgets, are often created for
+ * every popup and destroyed before the next one. The realized toplevel
+ * of the last destroyed menu is kept around per display, so the next
+ * menu can reuse its surface and renderer instead of creating new ones,
+ * which makes the first frame of a menu slow.
+ */
+#define SPARE_TOPLEVEL_KEY "gtk-menu-spare-toplevel"
+
+static void
+spare_toplevel_destroyed (GtkWidget  *toplevel,
+                          GdkDisplay *display)
+{
+  if (g_object_get_data (G_OBJECT (display), SPARE_TOPLEVEL_KEY) == toplevel)
+    g_object_steal_data (G_OBJECT (display), SPARE_TOPLEVEL_KEY);
+}
+
+static GtkWidget *
+gtk_menu_take_spare_toplevel (void)
+{
+  GdkDisplay *display;
+  GtkWidget *toplevel;
+
+  display = gdk_display_get_default ();
+  if (display == NULL)
+    return NULL;
+
+  toplevel = g_object_steal_data (G_OBJECT (display), SPARE_TOPLEVEL_KEY);
+  if (toplevel)
+    g_signal_handlers_disconnect_by_func (toplevel, spare_toplevel_destroyed, display);
+
+  return toplevel;
+}
+
 static void
 gtk_menu_init (GtkMenu *menu)
 {
@@ -902,15 +935,19 @@ gtk_menu_init (GtkMenu *menu)
 
   menu->priv = priv;
 
-  priv->toplevel = gtk_window_new (GTK_WINDOW_POPUP);
+  priv->toplevel = gtk_menu_take_spare_toplevel ();
+  if (priv->toplevel == NULL)
+    {
+      priv->toplevel = gtk_window_new (GTK_WINDOW_POPUP);
+      gtk_window_set_resizable (GTK_WINDOW (priv->toplevel), FALSE);
+      gtk_window_set_mnemonic_modifier (GTK_WINDOW (priv->toplevel), 0);
+
+      _gtk_window_request_csd (GTK_WINDOW (priv->toplevel));
+      gtk_style_context_add_class (gtk_widget_get_style_context (priv->toplevel),
+                                   GTK_STYLE_CLASS_POPUP);
+    }
   gtk_container_add (GTK_CONTAINER (priv->toplevel), GTK_WIDGET (menu));
   g_signal_connect (priv->toplevel, "destroy", G_CALLBACK (gtk_widget_destroyed), &priv->toplevel);
-  gtk_window_set_resizable (GTK_WINDOW (priv->toplevel), FALSE);
-  gtk_window_set_mnemonic_modifier (GTK_WINDOW (priv->toplevel), 0);
-
-  _gtk_window_request_csd (GTK_WINDOW (priv->toplevel));
-  gtk_style_context_add_class (gtk_widget_get_style_context (priv->toplevel),
-                               GTK_STYLE_CLASS_POPUP);
 
   /* Refloat the menu, so that reference counting for the menu isn't
    * affected by it being a child of the toplevel
@@ -983,6 +1020,44 @@ moved_to_rect_cb (GdkSurface          *surface,
                  flipped_y);
 }
 
+/* Detaches the toplevel from @menu and keeps it as the spare toplevel
+ * of its display, if there is none yet. Only hidden toplevels that have
+ * a surface are worth keeping. */
+static gboolean
+gtk_menu_keep_spare_toplevel (GtkMenu *menu)
+{
+  GtkMenuPrivate *priv = menu->priv;
+  GtkWidget *toplevel = priv->toplevel;
+  GdkDisplay *display;
+  GdkSurface *surface;
+
+  display = gtk_widget_get_display (toplevel);
+
+  if (!gtk_widget_get_realized (toplevel) ||
+      gtk_widget_get_visible (toplevel) ||
+      gdk_display_is_closed (display) ||
+      g_object_get_data (G_OBJECT (display), SPARE_TOPLEVEL_KEY) != NULL)
+    return FALSE;
+
+  surface = gtk_widget_get_surface (toplevel);
+  g_signal_handlers_disconnect_by_func (surface, moved_to_rect_cb, menu);
+  g_object_set_data (G_OBJECT (surface), I_("gdk-attached-grab-surface"), NULL);
+  gdk_surface_set_transient_for (surface, NULL);
+
+  gtk_window_set_transient_for (GTK_WINDOW (toplevel), NULL);
+  gtk_window_set_attached_to (GTK_WINDOW (toplevel), NULL);
+  g_signal_handlers_disconnect_by_func (toplevel, gtk_widget_destroyed, &priv->toplevel);
+  gtk_container_remove (GTK_CONTAINER (toplevel), GTK_WIDGET (menu));
+
+  g_object_set_data_full (G_OBJECT (display), I_(SPARE_TOPLEVEL_KEY),
+                          toplevel, (GDestroyNotify) gtk_widget_destroy);
+  g_signal_connect (toplevel, "destroy", G_CALLBACK (spare_toplevel_destroyed), display);
+
+  priv->toplevel = NULL;
+
+  return TRUE;
+}
+
 static void
 gtk_menu_destroy (GtkWidget *widget)
 {
@@ -1009,7 +1084,7 @@ gtk_menu_destroy (GtkWidget *widget)
 
   g_clear_object (&priv->accel_group);
 
-  if (priv->toplevel)
+  if (priv->toplevel && !gtk_menu_keep_spare_toplevel (menu))
     {
       g_signal_handlers_disconnect_by_func (priv->toplevel, moved_to_rect_cb, menu);
       gtk_widget_destroy (priv->toplevel);
@@ -274,6 +274,22 @@ gtk_menu_tracker_section_measure (GtkMenuTrackerSection *section)
   return n_items;
 }
 
+/* A section is flat if it only contains items that are always shown,
+ * and no subsections or items that may disappear */
+static gboolean
+gtk_menu_tracker_section_is_flat (GtkMenuTrackerSection *section)
+{
+  GSList *item;
+
+  for (item = section->items; item; item = item->next)
+    {
+      if (item->data != NULL)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_menu_tracker_remove_items (GtkMenuTracker  *tracker,
                                GSList         **change_point,
@@ -417,6 +433,7 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
   GtkMenuTracker *tracker = user_data;
   GtkMenuTrackerSection *section;
   GSList **change_point;
+  gboolean was_flat;
   gint offset = 0;
   gint i;
 
@@ -424,6 +441,7 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
    * position of that section within the overall menu.
    */
   section = gtk_menu_tracker_section_find_model (tracker->toplevel, model, &offset);
+  was_flat = section->items != NULL && gtk_menu_tracker_section_is_flat (section);
 
   /* Next, seek through that section to the change point.  This gives us
    * the correct GSList** to make the change to and also finds the final
@@ -451,6 +469,15 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
   gtk_menu_tracker_remove_items (tracker, change_point, offset, removed);
   gtk_menu_tracker_add_items (tracker, section, change_point, offset, model, position, added);
 
+  /* Separators only depend on which sections have items.  A section
+   * that only contains plain items before and after the change, and
+   * has some in both cases, can't have changed any of them.  This is
+   * the common case for big dynamic sections like lists of recent
+   * files, which would otherwise walk the whole menu on every change.
+   */
+  if (was_flat && section->items != NULL && gtk_menu_tracker_section_is_flat (section))
+    return;
+
   /* The offsets for insertion/removal of separators will be all over
    * the place, however...
    */
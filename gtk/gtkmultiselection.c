@@ -0,0 +1,407 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkmultiselection.h"
+
+#include "gtkbitsetprivate.h"
+#include "gtkintl.h"
+#include "gtkselectionmodel.h"
+
+/**
+ * SECTION:gtkmultiselection
+ * @Short_description: A selection model that allows selecting multiple items
+ * @Title: GtkMultiSelection
+ * @see_also: #GtkSelectionModel
+ *
+ * GtkMultiSelection is an implementation of the #GtkSelectionModel interface
+ * that allows selecting multiple elements.
+ *
+ * The selection is kept as one bit per item, so selecting or unselecting
+ * large ranges is cheap and each change emits a single
+ * #GtkSelectionModel::selection-changed signal covering all the items
+ * that changed.
+ */
+struct _GtkMultiSelection
+{
+  GObject parent_instance;
+
+  GListModel *model;
+  GtkBitset *selected;
+};
+
+struct _GtkMultiSelectionClass
+{
+  GObjectClass parent_class;
+};
+
+enum {
+  PROP_0,
+  PROP_MODEL,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS] = { NULL, };
+
+static GType
+gtk_multi_selection_get_item_type (GListModel *list)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (list);
+
+  return g_list_model_get_item_type (self->model);
+}
+
+static guint
+gtk_multi_selection_get_n_items (GListModel *list)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (list);
+
+  if (self->model == NULL)
+    return 0;
+
+  return g_list_model_get_n_items (self->model);
+}
+
+static gpointer
+gtk_multi_selection_get_item (GListModel *list,
+                              guint       position)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (list);
+
+  if (self->model == NULL)
+    return NULL;
+
+  return g_list_model_get_item (self->model, position);
+}
+
+static void
+gtk_multi_selection_list_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = gtk_multi_selection_get_item_type;
+  iface->get_n_items = gtk_multi_selection_get_n_items;
+  iface->get_item = gtk_multi_selection_get_item;
+}
+
+/* Sets the items in the range to @selected. If @exclusive is set, the
+ * items outside of the range are unselected. Emits one selection-changed
+ * signal for the smallest range containing all the changed items.
+ */
+static gboolean
+gtk_multi_selection_set_range (GtkMultiSelection *self,
+                               guint              position,
+                               guint              n_items,
+                               gboolean           selected,
+                               gboolean           exclusive)
+{
+  guint size, start, end, first, last;
+
+  size = gtk_bitset_get_size (self->selected);
+  if (position >= size)
+    return FALSE;
+  n_items = MIN (n_items, size - position);
+
+  start = G_MAXUINT;
+  end = 0;
+
+  if (exclusive)
+    {
+      first = gtk_bitset_find_next (self->selected, 0, TRUE);
+      if (first >= position)
+        first = gtk_bitset_find_next (self->selected, position + n_items, TRUE);
+      if (first < size)
+        start = first;
+
+      last = gtk_bitset_find_previous (self->selected, size, TRUE);
+      if (last != G_MAXUINT && last < position + n_items)
+        last = gtk_bitset_find_previous (self->selected, position, TRUE);
+      if (last != G_MAXUINT)
+        end = last + 1;
+    }
+
+  first = gtk_bitset_find_next (self->selected, position, !selected);
+  if (first < position + n_items)
+    {
+      last = gtk_bitset_find_previous (self->selected, position + n_items, !selected);
+      start = MIN (start, first);
+      end = MAX (end, last + 1);
+    }
+
+  if (exclusive)
+    gtk_bitset_set_range (self->selected, 0, size, FALSE);
+  gtk_bitset_set_range (self->selected, position, n_items, selected);
+
+  if (start < end)
+    gtk_selection_model_selection_changed (GTK_SELECTION_MODEL (self), start, end - start);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_multi_selection_is_selected (GtkSelectionModel *model,
+                                 guint              position)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+
+  return gtk_bitset_get (self->selected, position);
+}
+
+static gboolean
+gtk_multi_selection_select_range (GtkSelectionModel *model,
+                                  guint              position,
+                                  guint              n_items,
+                                  gboolean           exclusive)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+
+  return gtk_multi_selection_set_range (self, position, n_items, TRUE, exclusive);
+}
+
+static gboolean
+gtk_multi_selection_unselect_range (GtkSelectionModel *model,
+                                    guint              position,
+                                    guint              n_items)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+
+  return gtk_multi_selection_set_range (self, position, n_items, FALSE, FALSE);
+}
+
+static gboolean
+gtk_multi_selection_select_item (GtkSelectionModel *model,
+                                 guint              position,
+                                 gboolean           exclusive)
+{
+  return gtk_multi_selection_select_range (model, position, 1, exclusive);
+}
+
+static gboolean
+gtk_multi_selection_unselect_item (GtkSelectionModel *model,
+                                   guint              position)
+{
+  return gtk_multi_selection_unselect_range (model, position, 1);
+}
+
+static gboolean
+gtk_multi_selection_select_all (GtkSelectionModel *model)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+
+  gtk_multi_selection_set_range (self, 0, gtk_bitset_get_size (self->selected), TRUE, FALSE);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_multi_selection_unselect_all (GtkSelectionModel *model)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+
+  gtk_multi_selection_set_range (self, 0, gtk_bitset_get_size (self->selected), FALSE, FALSE);
+
+  return TRUE;
+}
+
+static void
+gtk_multi_selection_query_range (GtkSelectionModel *model,
+                                 guint              position,
+                                 guint             *start_range,
+                                 guint             *n_range,
+                                 gboolean          *selected)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
+  guint start, end;
+
+  if (position >= gtk_bitset_get_size (self->selected))
+    {
+      *start_range = position;
+      *n_range = 0;
+      *selected = FALSE;
+      return;
+    }
+
+  *selected = gtk_bitset_get (self->selected, position);
+
+  start = gtk_bitset_find_previous (self->selected, position, !*selected);
+  start = start == G_MAXUINT ? 0 : start + 1;
+  end = gtk_bitset_find_next (self->selected, position, !*selected);
+
+  *start_range = start;
+  *n_range = end - start;
+}
+
+static void
+gtk_multi_selection_selection_model_init (GtkSelectionModelInterface *iface)
+{
+  iface->is_selected = gtk_multi_selection_is_selected;
+  iface->select_item = gtk_multi_selection_select_item;
+  iface->unselect_item = gtk_multi_selection_unselect_item;
+  iface->select_range = gtk_multi_selection_select_range;
+  iface->unselect_range = gtk_multi_selection_unselect_range;
+  iface->select_all = gtk_multi_selection_select_all;
+  iface->unselect_all = gtk_multi_selection_unselect_all;
+  iface->query_range = gtk_multi_selection_query_range;
+}
+
+G_DEFINE_TYPE_EXTENDED (GtkMultiSelection, gtk_multi_selection, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
+                                               gtk_multi_selection_list_model_init)
+                        G_IMPLEMENT_INTERFACE (GTK_TYPE_SELECTION_MODEL,
+                                               gtk_multi_selection_selection_model_init))
+
+static void
+gtk_multi_selection_items_changed_cb (GListModel        *model,
+                                      guint              position,
+                                      guint              removed,
+                                      guint              added,
+                                      GtkMultiSelection *self)
+{
+  /* Added items start out unselected */
+  gtk_bitset_splice (self->selected, position, removed, added);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+static void
+gtk_multi_selection_clear_model (GtkMultiSelection *self)
+{
+  if (self->model == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (self->model,
+                                        gtk_multi_selection_items_changed_cb,
+                                        self);
+  g_clear_object (&self->model);
+}
+
+static void
+gtk_multi_selection_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      gtk_multi_selection_clear_model (self);
+      self->model = g_value_dup_object (value);
+      gtk_bitset_splice (self->selected, 0, gtk_bitset_get_size (self->selected), 0);
+      if (self->model)
+        {
+          g_signal_connect (self->model, "items-changed",
+                            G_CALLBACK (gtk_multi_selection_items_changed_cb), self);
+          gtk_bitset_splice (self->selected, 0, 0, g_list_model_get_n_items (self->model));
+        }
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_multi_selection_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      g_value_set_object (value, self->model);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_multi_selection_dispose (GObject *object)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (object);
+
+  gtk_multi_selection_clear_model (self);
+
+  G_OBJECT_CLASS (gtk_multi_selection_parent_class)->dispose (object);
+}
+
+static void
+gtk_multi_selection_finalize (GObject *object)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (object);
+
+  gtk_bitset_free (self->selected);
+
+  G_OBJECT_CLASS (gtk_multi_selection_parent_class)->finalize (object);
+}
+
+static void
+gtk_multi_selection_class_init (GtkMultiSelectionClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->get_property = gtk_multi_selection_get_property;
+  gobject_class->set_property = gtk_multi_selection_set_property;
+  gobject_class->dispose = gtk_multi_selection_dispose;
+  gobject_class->finalize = gtk_multi_selection_finalize;
+
+  /**
+   * GtkMultiSelection:model:
+   *
+   * The model being managed
+   */
+  properties[PROP_MODEL] =
+    g_param_spec_object ("model",
+                       P_("The model"),
+                       P_("The model being managed"),
+                       G_TYPE_LIST_MODEL,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, properties);
+}
+
+static void
+gtk_multi_selection_init (GtkMultiSelection *self)
+{
+  self->selected = gtk_bitset_new ();
+}
+
+/**
+ * gtk_multi_selection_new:
+ * @model: (transfer none): the #GListModel to manage
+ *
+ * Creates a new selection to handle @model.
+ *
+ * Returns: (transfer full) (type GtkMultiSelection): a new #GtkMultiSelection
+ **/
+GtkMultiSelection *
+gtk_multi_selection_new (GListModel *model)
+{
+  g_return_val_if_fail (G_IS_LIST_MODEL (model), NULL);
+
+  return g_object_new (GTK_TYPE_MULTI_SELECTION,
+                       "model", model,
+                       NULL);
+}
@@ -80,6 +80,7 @@ struct _GtkPicture
 
   GdkPaintable *paintable;
   GFile *file;
+  GCancellable *load_cancellable;   /* set while a large image loads in a thread */
 
   char *alternative_text;
   guint keep_aspect_ratio : 1;
@@ -610,6 +611,120 @@ out1:
   return result;
 }
 
+/* Finds the largest size the picture could be shown at, which is
+ * the size of the largest monitor. Returns FALSE if that isn't known.
+ */
+static gboolean
+gtk_picture_get_max_size (GtkPicture *self,
+                          int        *max_width,
+                          int        *max_height)
+{
+  GdkDisplay *display;
+  int i, n_monitors;
+
+  display = gtk_widget_get_display (GTK_WIDGET (self));
+  n_monitors = gdk_display_get_n_monitors (display);
+  if (n_monitors == 0)
+    return FALSE;
+
+  *max_width = 0;
+  *max_height = 0;
+  for (i = 0; i < n_monitors; i++)
+    {
+      GdkMonitor *monitor = gdk_display_get_monitor (display, i);
+      GdkRectangle geometry;
+      int scale;
+
+      gdk_monitor_get_geometry (monitor, &geometry);
+      scale = gdk_monitor_get_scale_factor (monitor);
+      *max_width = MAX (*max_width, geometry.width * scale);
+      *max_height = MAX (*max_height, geometry.height * scale);
+    }
+
+  return *max_width > 0 && *max_height > 0;
+}
+
+static void
+gtk_picture_file_loaded (GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      data)
+{
+  GtkPicture *self;
+  GdkTexture *texture;
+  GdkPaintable *scaler;
+  GError *error = NULL;
+  int width;
+
+  texture = gdk_texture_new_from_file_finish (result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+
+  /* Any other change of the paintable cancels the load, so
+   * the placeholder is still shown.
+   */
+  self = data;
+  g_clear_object (&self->load_cancellable);
+
+  if (texture == NULL)
+    {
+      g_error_free (error);
+      gtk_picture_set_paintable (self, NULL);
+      return;
+    }
+
+  width = gdk_paintable_get_intrinsic_width (self->paintable);
+  scaler = gtk_scaler_new (GDK_PAINTABLE (texture), (double) gdk_texture_get_width (texture) / width);
+  gtk_picture_set_paintable (self, scaler);
+
+  g_object_unref (scaler);
+  g_object_unref (texture);
+}
+
+/* Images larger than any monitor are decoded at a smaller size in a
+ * thread. Until they are loaded, an empty paintable of the same size
+ * takes their place, so the size of the picture doesn't change.
+ */
+static gboolean
+gtk_picture_load_file_at_size (GtkPicture *self,
+                               GFile      *file)
+{
+  GdkPixbufFormat *format;
+  GdkPaintable *placeholder;
+  const char *path;
+  int width, height, max_width, max_height;
+
+  if (!self->can_shrink)
+    return FALSE;
+
+  path = g_file_peek_path (file);
+  if (path == NULL)
+    return FALSE;
+
+  format = gdk_pixbuf_get_file_info (path, &width, &height);
+  if (format == NULL || gdk_pixbuf_format_is_scalable (format))
+    return FALSE;
+
+  if (!gtk_picture_get_max_size (self, &max_width, &max_height) ||
+      (width <= max_width && height <= max_height))
+    return FALSE;
+
+  placeholder = gdk_paintable_new_empty (width, height);
+  gtk_picture_set_paintable (self, placeholder);
+  g_object_unref (placeholder);
+
+  self->load_cancellable = g_cancellable_new ();
+  gdk_texture_new_from_file_async (file,
+                                   max_width, max_height,
+                                   self->load_cancellable,
+                                   gtk_picture_file_loaded,
+                                   self);
+
+  return TRUE;
+}
+
 /**
  * gtk_picture_set_file:
  * @self: a #GtkPicture
@@ -636,9 +751,12 @@ gtk_picture_set_file (GtkPicture *self,
   g_set_object (&self->file, file);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FILE]);
 
-  paintable = load_scalable_with_loader (file, gtk_widget_get_scale_factor (GTK_WIDGET (self)));
-  gtk_picture_set_paintable (self, paintable);
-  g_clear_object (&paintable);
+  if (file == NULL || !gtk_picture_load_file_at_size (self, file))
+    {
+      paintable = load_scalable_with_loader (file, gtk_widget_get_scale_factor (GTK_WIDGET (self)));
+      gtk_picture_set_paintable (self, paintable);
+      g_clear_object (&paintable);
+    }
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -793,6 +911,12 @@ gtk_picture_set_paintable (GtkPicture   *self,
   if (self->paintable == paintable)
     return;
 
+  if (self->load_cancellable)
+    {
+      g_cancellable_cancel (self->load_cancellable);
+      g_clear_object (&self->load_cancellable);
+    }
+
   g_object_freeze_notify (G_OBJECT (self));
 
   if (paintable)
@@ -82,11 +82,17 @@ gtk_print_backend_error_quark (void)
 void
 gtk_print_backends_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOExtensionPoint *ep;
   GIOModuleScope *scope;
   char **paths;
   int i;
 
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+
   GTK_NOTE (MODULES,
             g_print ("Registering extension point %s\n", GTK_PRINT_BACKEND_EXTENSION_POINT_NAME));
 
@@ -139,6 +145,7 @@ gtk_print_backend_load_modules (void)
 
   result = NULL;
 
+  gtk_print_backends_init ();
   ep = g_io_extension_point_lookup (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 
   settings = gtk_settings_get_default ();
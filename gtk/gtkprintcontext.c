@@ -175,6 +175,32 @@ _gtk_print_context_new (GtkPrintOperation *op)
   return context;
 }
 
+/* Creates a context that draws one page to @cr, with the same
+ * resolution and hard margins as @context. Used to draw pages in
+ * worker threads.
+ */
+GtkPrintContext *
+_gtk_print_context_new_for_page (GtkPrintContext *context,
+                                 GtkPageSetup    *page_setup,
+                                 cairo_t         *cr)
+{
+  GtkPrintContext *page_context;
+
+  page_context = _gtk_print_context_new (context->op);
+  _gtk_print_context_set_page_setup (page_context, page_setup);
+  gtk_print_context_set_cairo_context (page_context, cr,
+                                       context->surface_dpi_x,
+                                       context->surface_dpi_y);
+
+  page_context->has_hard_margins = context->has_hard_margins;
+  page_context->hard_margin_top = context->hard_margin_top;
+  page_context->hard_margin_bottom = context->hard_margin_bottom;
+  page_context->hard_margin_left = context->hard_margin_left;
+  page_context->hard_margin_right = context->hard_margin_right;
+
+  return page_context;
+}
+
 static PangoFontMap *
 _gtk_print_context_get_fontmap (GtkPrintContext *context)
 {
@@ -55,6 +55,7 @@ struct _GtkPrintOperationPrivate
   guint support_selection  : 1;
   guint has_selection      : 1;
   guint embed_page_setup   : 1;
+  guint threaded_drawing   : 1;
 
   GtkPageDrawingState      page_drawing_state;
 
@@ -84,6 +85,15 @@ struct _GtkPrintOperationPrivate
 
   GMainLoop *rloop; /* recursive mainloop */
 
+  /* Pages recorded for custom previews, see preview_iface_render_page() */
+  GHashTable *preview_pages;
+  GQueue preview_lru;
+  gint preview_last_page;
+  guint preview_prerender_id;
+  gpointer preview_deferred_job;
+  guint preview_deferred_render : 1;
+  guint preview_defers          : 1;
+
   void (*start_page) (GtkPrintOperation *operation,
 		      GtkPrintContext   *print_context,
 		      GtkPageSetup      *page_setup);
@@ -144,6 +154,9 @@ void             _gtk_print_context_set_hard_margins                (GtkPrintCon
 								     gdouble            bottom,
 								     gdouble            left,
 								     gdouble            right);
+GtkPrintContext *_gtk_print_context_new_for_page                    (GtkPrintContext   *context,
+								     GtkPageSetup      *page_setup,
+								     cairo_t           *cr);
 
 G_END_DECLS
 
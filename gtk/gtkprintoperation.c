@@ -141,17 +141,26 @@ enum
   PROP_EMBED_PAGE_SETUP,
   PROP_HAS_SELECTION,
   PROP_SUPPORT_SELECTION,
-  PROP_N_PAGES_TO_PRINT
+  PROP_N_PAGES_TO_PRINT,
+  PROP_THREADED_DRAWING
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
 static int job_nr = 0;
 typedef struct _PrintPagesData PrintPagesData;
+typedef struct _PageJob PageJob;
 
 static void          preview_iface_init      (GtkPrintOperationPreviewIface *iface);
 static GtkPageSetup *create_page_setup       (GtkPrintOperation             *op);
 static void          common_render_page      (GtkPrintOperation             *op,
 					      gint                           page_nr);
+static void          render_page             (GtkPrintOperation             *op,
+					      gint                           page_nr,
+					      PageJob                       *job);
+static void          preview_render_page     (GtkPrintOperation             *op,
+					      gint                           page_nr);
+static void          preview_clear_pages     (GtkPrintOperation             *op);
+static void          preview_finish_deferred_page (GtkPrintOperation        *op);
 static void          increment_page_sequence (PrintPagesData *data);
 static void          prepare_data            (PrintPagesData *data);
 static void          clamp_page_ranges       (PrintPagesData *data);
@@ -211,6 +220,8 @@ gtk_print_operation_finalize (GObject *object)
   if (priv->show_progress_timeout_id > 0)
     g_source_remove (priv->show_progress_timeout_id);
 
+  preview_clear_pages (print_operation);
+
   if (priv->error)
     g_error_free (priv->error);
   
@@ -247,6 +258,9 @@ gtk_print_operation_init (GtkPrintOperation *operation)
   priv->rloop = NULL;
   priv->unit = GTK_UNIT_NONE;
 
+  g_queue_init (&priv->preview_lru);
+  priv->preview_last_page = -1;
+
   appname = g_get_application_name ();
   if (appname == NULL)
     appname = "";
@@ -265,7 +279,7 @@ preview_iface_render_page (GtkPrintOperationPreview *preview,
   GtkPrintOperation *op;
 
   op = GTK_PRINT_OPERATION (preview);
-  common_render_page (op, page_nr);
+  preview_render_page (op, page_nr);
 }
 
 static void
@@ -276,6 +290,8 @@ preview_iface_end_preview (GtkPrintOperationPreview *preview)
   
   op = GTK_PRINT_OPERATION (preview);
 
+  preview_clear_pages (op);
+
   g_signal_emit (op, signals[END_PRINT], 0, op->priv->print_context);
 
   if (op->priv->rloop)
@@ -418,6 +434,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_EMBED_PAGE_SETUP:
       gtk_print_operation_set_embed_page_setup (op, g_value_get_boolean (value));
       break;
+    case PROP_THREADED_DRAWING:
+      gtk_print_operation_set_threaded_drawing (op, g_value_get_boolean (value));
+      break;
     case PROP_HAS_SELECTION:
       gtk_print_operation_set_has_selection (op, g_value_get_boolean (value));
       break;
@@ -495,6 +514,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_N_PAGES_TO_PRINT:
       g_value_set_int (value, priv->nr_of_pages_to_print);
       break;
+    case PROP_THREADED_DRAWING:
+      g_value_set_boolean (value, priv->threaded_drawing);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -524,6 +546,27 @@ struct _PrintPagesData
   gboolean initialized;
   gboolean is_preview;
   gboolean done;
+
+  /* Used with GtkPrintOperation:threaded-drawing */
+  GThreadPool *pool;
+  GHashTable *jobs;             /* page position => PageJob */
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  gint max_jobs;
+  gboolean waiting_for_page;
+};
+
+/* A page drawn into a recording surface by a worker thread */
+struct _PageJob
+{
+  GtkPrintOperation *op;
+  gint page_nr;
+  GtkPageSetup *page_setup;
+  GtkPrintContext *context;
+  cairo_surface_t *recording;
+  cairo_matrix_t matrix;        /* of the context before drawing */
+  gboolean done;                /* protected by jobs_lock */
+  gint abandoned;               /* atomic */
 };
 
 typedef struct
@@ -600,8 +643,10 @@ preview_print_idle (gpointer data)
         {
           increment_page_sequence (pop->pages_data);
 
+          /* Every page is rendered once, so this bypasses the page
+           * cache of custom previews */
           if (!pop->pages_data->done)
-            gtk_print_operation_preview_render_page (pop->preview, pop->pages_data->page);
+            common_render_page (op, pop->pages_data->page);
           else
             done = priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_READY;
         }
@@ -1054,6 +1099,11 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
    * finished by calling gtk_print_operation_preview_end_preview()
    * (typically in response to the user clicking a close button).
    *
+   * Pages are recorded when they are first rendered, and a few of them
+   * are kept until the preview ends, so rendering a page again does
+   * not emit #GtkPrintOperation::draw-page. The pages next to the last
+   * rendered one may be drawn ahead of time when idle.
+   *
    * Returns: %TRUE if the listener wants to take over control of the preview
    */
   signals[PREVIEW] =
@@ -1390,6 +1440,29 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 						     G_MAXINT,
 						     -1,
 						     GTK_PARAM_READABLE|G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GtkPrintOperation:threaded-drawing:
+   *
+   * If %TRUE, the #GtkPrintOperation::draw-page signal may be emitted
+   * from worker threads, for several pages at the same time.
+   *
+   * Each page is drawn into its own recording surface and copied to
+   * the output in order, so only a few pages are kept in memory at any
+   * time. The handlers of #GtkPrintOperation::draw-page must be
+   * thread-safe, and must not use gtk_print_operation_set_defer_drawing().
+   * #GtkPrintOperation::request-page-setup is still emitted in the
+   * main thread, but may be emitted before earlier pages are drawn.
+   *
+   * This is not used for print previews.
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_THREADED_DRAWING,
+				   g_param_spec_boolean ("threaded-drawing",
+							 P_("Threaded drawing"),
+							 P_("TRUE if pages may be drawn in worker threads."),
+							 FALSE,
+							 GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 }
 
 /**
@@ -2258,6 +2331,15 @@ print_pages_idle_done (gpointer user_data)
       g_signal_emit (data->op, signals[DONE], 0, result);
     }
   
+  if (data->pool)
+    {
+      /* Abandoned jobs that are still queued finish without drawing */
+      g_hash_table_unref (data->jobs);
+      g_thread_pool_free (data->pool, FALSE, TRUE);
+      g_mutex_clear (&data->jobs_lock);
+      g_cond_clear (&data->jobs_cond);
+    }
+
   g_object_unref (data->op);
   g_free (data->pages);
   g_free (data);
@@ -2353,6 +2435,49 @@ gtk_print_operation_get_embed_page_setup (GtkPrintOperation *op)
   return op->priv->embed_page_setup;
 }
 
+/**
+ * gtk_print_operation_set_threaded_drawing:
+ * @op: a #GtkPrintOperation
+ * @threaded_drawing: %TRUE if #GtkPrintOperation::draw-page handlers
+ *     are thread-safe
+ *
+ * Sets whether pages may be drawn in worker threads, see
+ * #GtkPrintOperation:threaded-drawing.
+ */
+void
+gtk_print_operation_set_threaded_drawing (GtkPrintOperation *op,
+                                          gboolean           threaded_drawing)
+{
+  GtkPrintOperationPrivate *priv;
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  priv = op->priv;
+
+  threaded_drawing = threaded_drawing != FALSE;
+  if (priv->threaded_drawing != threaded_drawing)
+    {
+      priv->threaded_drawing = threaded_drawing;
+      g_object_notify (G_OBJECT (op), "threaded-drawing");
+    }
+}
+
+/**
+ * gtk_print_operation_get_threaded_drawing:
+ * @op: a #GtkPrintOperation
+ *
+ * Gets the value of #GtkPrintOperation:threaded-drawing property.
+ *
+ * Returns: whether pages may be drawn in worker threads
+ */
+gboolean
+gtk_print_operation_get_threaded_drawing (GtkPrintOperation *op)
+{
+  g_return_val_if_fail (GTK_IS_PRINT_OPERATION (op), FALSE);
+
+  return op->priv->threaded_drawing;
+}
+
 /**
  * gtk_print_operation_draw_page_finish:
  * @op: a #GtkPrintOperation
@@ -2372,6 +2497,12 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   GtkPageSetup *page_setup;
   GtkPrintContext *print_context;
   cairo_t *cr;
+
+  if (priv->preview_deferred_job)
+    {
+      preview_finish_deferred_page (op);
+      return;
+    }
   
   print_context = priv->print_context;
   page_setup = gtk_print_context_get_page_setup (print_context);
@@ -2390,6 +2521,16 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
 static void
 common_render_page (GtkPrintOperation *op,
 		    gint               page_nr)
+{
+  render_page (op, page_nr, NULL);
+}
+
+/* If @job is given, its recording is copied to the page instead
+ * of emitting ::draw-page */
+static void
+render_page (GtkPrintOperation *op,
+             gint               page_nr,
+             PageJob           *job)
 {
   GtkPrintOperationPrivate *priv = op->priv;
   GtkPageSetup *page_setup;
@@ -2398,10 +2539,15 @@ common_render_page (GtkPrintOperation *op,
 
   print_context = priv->print_context;
   
-  page_setup = create_page_setup (op);
-  
-  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
-		 print_context, page_nr, page_setup);
+  if (job)
+    page_setup = g_object_ref (job->page_setup);
+  else
+    {
+      page_setup = create_page_setup (op);
+
+      g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
+                     print_context, page_nr, page_setup);
+    }
   
   _gtk_print_context_set_page_setup (print_context, page_setup);
   
@@ -2607,13 +2753,377 @@ common_render_page (GtkPrintOperation *op,
   
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
 
-  g_signal_emit (op, signals[DRAW_PAGE], 0, 
-		 print_context, page_nr);
+  if (job)
+    {
+      cairo_matrix_t matrix = job->matrix;
+
+      /* The recording is in device units of the page context */
+      cairo_save (cr);
+      cairo_matrix_invert (&matrix);
+      cairo_transform (cr, &matrix);
+      cairo_set_source_surface (cr, job->recording, 0, 0);
+      cairo_paint (cr);
+      cairo_restore (cr);
+    }
+  else
+    g_signal_emit (op, signals[DRAW_PAGE], 0, 
+                   print_context, page_nr);
 
   if (priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_DRAWING)
     gtk_print_operation_draw_page_finish (op);
 }
 
+static void
+page_job_free (gpointer data)
+{
+  PageJob *job = data;
+
+  g_object_unref (job->page_setup);
+  g_object_unref (job->context);
+  cairo_surface_destroy (job->recording);
+}
+
+static void
+page_job_unref (PageJob *job)
+{
+  g_atomic_rc_box_release_full (job, page_job_free);
+}
+
+static void
+page_job_abandon (gpointer data)
+{
+  PageJob *job = data;
+
+  g_atomic_int_set (&job->abandoned, TRUE);
+  page_job_unref (job);
+}
+
+static void
+draw_page_thread (gpointer job_data,
+                  gpointer user_data)
+{
+  PageJob *job = job_data;
+  PrintPagesData *data = user_data;
+
+  if (!g_atomic_int_get (&job->abandoned))
+    g_signal_emit (job->op, signals[DRAW_PAGE], 0,
+                   job->context, job->page_nr);
+
+  g_mutex_lock (&data->jobs_lock);
+  job->done = TRUE;
+  g_cond_broadcast (&data->jobs_cond);
+  g_mutex_unlock (&data->jobs_lock);
+
+  page_job_unref (job);
+}
+
+static gboolean
+is_position_printed (PrintPagesData *data,
+                     gint            position)
+{
+  GtkPrintOperationPrivate *priv = data->op->priv;
+  gint sheet;
+
+  if (position < 0 || position >= priv->nr_of_pages_to_print)
+    return FALSE;
+
+  sheet = position / MAX (priv->manual_number_up, 1);
+
+  if (priv->manual_page_set == GTK_PAGE_SET_ODD)
+    return sheet % 2 == 0;
+  else if (priv->manual_page_set == GTK_PAGE_SET_EVEN)
+    return sheet % 2 == 1;
+  else
+    return TRUE;
+}
+
+/* Sets up a job for drawing page_nr, without drawing it yet */
+static PageJob *
+page_job_new (GtkPrintOperation *op,
+              gint               page_nr)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageJob *job;
+  cairo_t *cr;
+
+  job = g_atomic_rc_box_new0 (PageJob);
+  job->op = op;
+  job->page_nr = page_nr;
+
+  job->page_setup = create_page_setup (op);
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0,
+                 priv->print_context, job->page_nr, job->page_setup);
+
+  job->recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  cr = cairo_create (job->recording);
+  job->context = _gtk_print_context_new_for_page (priv->print_context, job->page_setup, cr);
+  cairo_get_matrix (cr, &job->matrix);
+  cairo_destroy (cr);
+
+  return job;
+}
+
+static PageJob *
+queue_page_job (PrintPagesData *data,
+                gint            position)
+{
+  PageJob *job;
+
+  job = page_job_new (data->op, data->pages[position]);
+
+  g_hash_table_insert (data->jobs, GINT_TO_POINTER (position), job);
+  g_thread_pool_push (data->pool, g_atomic_rc_box_acquire (job), NULL);
+
+  return job;
+}
+
+/* Keeps the pages at the next few printed positions drawing in worker
+ * threads and drops the ones that are not needed anymore, so memory use
+ * stays bounded. Then waits a moment for the page at the current
+ * position. Returns it if it has been drawn, or %NULL if it is not
+ * done yet.
+ */
+static PageJob *
+get_page_job (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = data->op->priv;
+  GHashTableIter iter;
+  gpointer key;
+  PageJob *job;
+  gint *wanted;
+  gint i, n_wanted, position, inc;
+  gint64 end_time;
+  gboolean done;
+
+  if (data->pool == NULL)
+    {
+      data->max_jobs = 2 * g_get_num_processors ();
+      data->pool = g_thread_pool_new (draw_page_thread, data,
+                                      g_get_num_processors (), FALSE, NULL);
+      data->jobs = g_hash_table_new_full (NULL, NULL, NULL, page_job_abandon);
+      g_mutex_init (&data->jobs_lock);
+      g_cond_init (&data->jobs_cond);
+    }
+
+  inc = priv->manual_reverse ? -1 : 1;
+  wanted = g_newa (gint, data->max_jobs);
+  wanted[0] = priv->page_position;
+  n_wanted = 1;
+  for (position = priv->page_position + inc;
+       n_wanted < data->max_jobs && position >= 0 && position < priv->nr_of_pages_to_print;
+       position += inc)
+    {
+      if (is_position_printed (data, position))
+        wanted[n_wanted++] = position;
+    }
+
+  g_hash_table_iter_init (&iter, data->jobs);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      for (i = 0; i < n_wanted; i++)
+        {
+          if (wanted[i] == GPOINTER_TO_INT (key))
+            break;
+        }
+      if (i == n_wanted)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  for (i = 0; i < n_wanted; i++)
+    {
+      if (!g_hash_table_contains (data->jobs, GINT_TO_POINTER (wanted[i])))
+        queue_page_job (data, wanted[i]);
+    }
+
+  job = g_hash_table_lookup (data->jobs, GINT_TO_POINTER (priv->page_position));
+
+  /* Don't block the main loop for long, it is called again when idle */
+  end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_MILLISECOND;
+  g_mutex_lock (&data->jobs_lock);
+  while (!job->done)
+    {
+      if (!g_cond_wait_until (&data->jobs_cond, &data->jobs_lock, end_time))
+        break;
+    }
+  done = job->done;
+  g_mutex_unlock (&data->jobs_lock);
+
+  return done ? job : NULL;
+}
+
+/* Custom previews usually render the same few pages over and over
+ * while the user flips back and forth. The pages are recorded once and
+ * the most recently shown ones are kept, so going back to a page only
+ * replays its recording. The pages next to the shown one are recorded
+ * when idle, so flipping forward doesn't wait for ::draw-page either.
+ *
+ * If the application defers drawing, the page that is being drawn is
+ * completed in gtk_print_operation_draw_page_finish(), and nothing is
+ * recorded ahead of time from then on.
+ */
+#define PREVIEW_CACHE_SIZE 8
+
+/* Emits ::draw-page for page_nr into a new recording. Returns the job,
+ * which is not done yet if the application deferred drawing. */
+static PageJob *
+preview_record_page (GtkPrintOperation *op,
+                     gint               page_nr)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageJob *job;
+
+  job = page_job_new (op, page_nr);
+
+  priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
+  g_signal_emit (op, signals[DRAW_PAGE], 0, job->context, page_nr);
+
+  if (priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_DEFERRED_DRAWING)
+    priv->preview_defers = TRUE;
+  else
+    {
+      priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
+      job->done = TRUE;
+    }
+
+  return job;
+}
+
+static void
+preview_cache_page (GtkPrintOperation *op,
+                    PageJob           *job)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+
+  if (priv->preview_pages == NULL)
+    priv->preview_pages = g_hash_table_new_full (NULL, NULL, NULL,
+                                                 (GDestroyNotify) page_job_unref);
+
+  g_hash_table_insert (priv->preview_pages, GINT_TO_POINTER (job->page_nr), job);
+  g_queue_push_tail (&priv->preview_lru, GINT_TO_POINTER (job->page_nr));
+
+  while (g_queue_get_length (&priv->preview_lru) > PREVIEW_CACHE_SIZE)
+    g_hash_table_remove (priv->preview_pages, g_queue_pop_head (&priv->preview_lru));
+}
+
+static gboolean
+preview_prerender_idle (gpointer user_data)
+{
+  GtkPrintOperation *op = user_data;
+  GtkPrintOperationPrivate *priv = op->priv;
+  const gint offsets[] = { 1, -1 };
+  PageJob *job;
+  gint page_nr;
+  guint i;
+
+  if (priv->page_drawing_state != GTK_PAGE_DRAWING_STATE_READY)
+    return G_SOURCE_CONTINUE;
+
+  for (i = 0; i < G_N_ELEMENTS (offsets) && !priv->preview_defers; i++)
+    {
+      page_nr = priv->preview_last_page + offsets[i];
+
+      if (!preview_iface_is_selected (GTK_PRINT_OPERATION_PREVIEW (op), page_nr) ||
+          g_hash_table_contains (priv->preview_pages, GINT_TO_POINTER (page_nr)))
+        continue;
+
+      /* One page per iteration, so input is handled in between */
+      job = preview_record_page (op, page_nr);
+      if (job->done)
+        preview_cache_page (op, job);
+      else
+        {
+          priv->preview_deferred_job = job;
+          priv->preview_deferred_render = FALSE;
+        }
+
+      return G_SOURCE_CONTINUE;
+    }
+
+  priv->preview_prerender_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+preview_render_page (GtkPrintOperation *op,
+                     gint               page_nr)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageJob *job;
+
+  if (priv->preview_defers)
+    {
+      common_render_page (op, page_nr);
+      return;
+    }
+
+  job = priv->preview_pages ? g_hash_table_lookup (priv->preview_pages, GINT_TO_POINTER (page_nr)) : NULL;
+  if (job)
+    {
+      g_queue_remove (&priv->preview_lru, GINT_TO_POINTER (page_nr));
+      g_queue_push_tail (&priv->preview_lru, GINT_TO_POINTER (page_nr));
+    }
+  else
+    {
+      job = preview_record_page (op, page_nr);
+      if (!job->done)
+        {
+          priv->preview_deferred_job = job;
+          priv->preview_deferred_render = TRUE;
+          return;
+        }
+
+      preview_cache_page (op, job);
+    }
+
+  render_page (op, page_nr, job);
+
+  priv->preview_last_page = page_nr;
+  if (priv->preview_prerender_id == 0)
+    {
+      priv->preview_prerender_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 10,
+                                                    preview_prerender_idle,
+                                                    op, NULL);
+      g_source_set_name_by_id (priv->preview_prerender_id, "[gtk] preview_prerender_idle");
+    }
+}
+
+/* Called by gtk_print_operation_draw_page_finish() for a page that
+ * was recorded with deferred drawing */
+static void
+preview_finish_deferred_page (GtkPrintOperation *op)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageJob *job = priv->preview_deferred_job;
+
+  priv->preview_deferred_job = NULL;
+  priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
+  job->done = TRUE;
+
+  if (priv->preview_deferred_render)
+    render_page (op, job->page_nr, job);
+
+  page_job_unref (job);
+}
+
+static void
+preview_clear_pages (GtkPrintOperation *op)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+
+  if (priv->preview_prerender_id)
+    {
+      g_source_remove (priv->preview_prerender_id);
+      priv->preview_prerender_id = 0;
+    }
+
+  g_clear_pointer (&priv->preview_pages, g_hash_table_unref);
+  g_queue_clear (&priv->preview_lru);
+  g_clear_pointer (&priv->preview_deferred_job, page_job_unref);
+  priv->preview_last_page = -1;
+  priv->preview_defers = FALSE;
+}
+
 static void
 prepare_data (PrintPagesData *data)
 {
@@ -2809,12 +3319,23 @@ print_pages_idle (gpointer user_data)
           goto out;
         }
 
-      increment_page_sequence (data);
+      if (!data->waiting_for_page)
+        increment_page_sequence (data);
 
-      if (!data->done)
-        common_render_page (data->op, data->page);
-      else
+      if (data->done)
         done = priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_READY;
+      else if (priv->threaded_drawing)
+        {
+          PageJob *job = get_page_job (data);
+
+          data->waiting_for_page = job == NULL;
+          if (job != NULL)
+            render_page (data->op, data->page, job);
+          else if (!priv->cancelled)
+            return TRUE;
+        }
+      else
+        common_render_page (data->op, data->page);
 
  out:
 
@@ -306,6 +306,11 @@ void                    gtk_print_operation_set_embed_page_setup   (GtkPrintOper
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_print_operation_get_embed_page_setup   (GtkPrintOperation  *op);
 GDK_AVAILABLE_IN_ALL
+void                    gtk_print_operation_set_threaded_drawing   (GtkPrintOperation  *op,
+                                                                    gboolean            threaded_drawing);
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_print_operation_get_threaded_drawing   (GtkPrintOperation  *op);
+GDK_AVAILABLE_IN_ALL
 gint                    gtk_print_operation_get_n_pages_to_print   (GtkPrintOperation  *op);
 
 GDK_AVAILABLE_IN_ALL
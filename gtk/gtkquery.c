@@ -79,6 +79,22 @@ gtk_query_get_text (GtkQuery *query)
   return priv->text;
 }
 
+static gchar *
+prepare_string_for_compare (const gchar *string)
+{
+  gchar *normalized, *res;
+
+  /* ASCII is unchanged by normalization, and most file names are ASCII */
+  if (g_str_is_ascii (string))
+    return g_ascii_strdown (string, -1);
+
+  normalized = g_utf8_normalize (string, -1, G_NORMALIZE_NFD);
+  res = g_utf8_strdown (normalized, -1);
+  g_free (normalized);
+
+  return res;
+}
+
 void
 gtk_query_set_text (GtkQuery    *query,
                     const gchar *text)
@@ -90,6 +106,17 @@ gtk_query_set_text (GtkQuery    *query,
 
   g_strfreev (priv->words);
   priv->words = NULL;
+
+  /* Split the words right away, so matching doesn't modify the query
+   * and search threads can share it */
+  if (text)
+    {
+      gchar *prepared;
+
+      prepared = prepare_string_for_compare (text);
+      priv->words = g_strsplit (prepared, " ", -1);
+      g_free (prepared);
+    }
 }
 
 GFile *
@@ -109,18 +136,6 @@ gtk_query_set_location (GtkQuery *query,
   g_set_object (&priv->location, file);
 }
 
-static gchar *
-prepare_string_for_compare (const gchar *string)
-{
-  gchar *normalized, *res;
-
-  normalized = g_utf8_normalize (string, -1, G_NORMALIZE_NFD);
-  res = g_utf8_strdown (normalized, -1);
-  g_free (normalized);
-
-  return res;
-}
-
 gboolean
 gtk_query_matches_string (GtkQuery    *query,
                           const gchar *string)
@@ -130,15 +145,8 @@ gtk_query_matches_string (GtkQuery    *query,
   gboolean found;
   gint i;
 
-  if (!priv->text)
-    return FALSE;
-
   if (!priv->words)
-    {
-      prepared = prepare_string_for_compare (priv->text);
-      priv->words = g_strsplit (prepared, " ", -1);
-      g_free (prepared);
-    }
+    return FALSE;
 
   prepared = prepare_string_for_compare (string);
 
@@ -785,6 +785,67 @@ gtk_rb_tree_remove (GtkRbTree *tree,
   gtk_rb_node_free (tree, real_node);
 }
 
+static GtkRbNode *
+gtk_rb_node_build (GtkRbTree *tree,
+                   GtkRbNode *parent_node,
+                   guint      n_nodes,
+                   guint      depth,
+                   guint      red_depth)
+{
+  GtkRbNode *node;
+  guint n_left;
+
+  if (n_nodes == 0)
+    return NULL;
+
+  node = gtk_rb_node_new (tree);
+  node->red = depth == red_depth;
+  set_parent (tree, node, parent_node);
+
+  n_left = (n_nodes - 1) / 2;
+  node->left = gtk_rb_node_build (tree, node, n_left, depth + 1, red_depth);
+  node->right = gtk_rb_node_build (tree, node, n_nodes - 1 - n_left, depth + 1, red_depth);
+
+  return node;
+}
+
+/**
+ * gtk_rb_tree_build:
+ * @tree: an empty tree
+ * @n_nodes: number of nodes to create
+ *
+ * Fills @tree with @n_nodes new nodes. This is the same as calling
+ * gtk_rb_tree_insert_after() @n_nodes times, but it creates a balanced
+ * tree directly in linear time instead of rebalancing after every node.
+ *
+ * Returns: the first node or %NULL if @n_nodes is 0
+ **/
+gpointer
+gtk_rb_tree_build (GtkRbTree *tree,
+                   guint      n_nodes)
+{
+  guint red_depth;
+
+  g_return_val_if_fail (tree->root == NULL, NULL);
+
+#ifdef DUMP_MODIFICATION
+  g_print ("build (tree, %u); /* 0x%p */\n", n_nodes, tree);
+#endif /* DUMP_MODIFICATION */
+
+  if (n_nodes == 0)
+    return NULL;
+
+  /* Splitting in the middle fills all levels but the last one, so
+   * making the nodes on that last level red gives every path the same
+   * number of black nodes.
+   */
+  red_depth = g_bit_storage (n_nodes + 1) - 1;
+
+  gtk_rb_node_build (tree, NULL, n_nodes, 0, red_depth);
+
+  return NODE_TO_POINTER (gtk_rb_node_get_first (tree->root));
+}
+
 void
 gtk_rb_tree_remove_all (GtkRbTree *tree)
 {
@@ -67,6 +67,8 @@ gpointer             gtk_rb_tree_insert_after           (GtkRbTree
 void                 gtk_rb_tree_remove                 (GtkRbTree               *tree,
                                                          gpointer                 node);
 void                 gtk_rb_tree_remove_all             (GtkRbTree               *tree);
+gpointer             gtk_rb_tree_build                  (GtkRbTree               *tree,
+                                                         guint                    n_nodes);
 
 
 G_END_DECLS
@@ -118,6 +118,9 @@
 /* keep in sync with xdgmime */
 #define GTK_RECENT_DEFAULT_MIME "application/octet-stream"
 
+/* coalesce file monitor events into one reload */
+#define RELOAD_TIMEOUT  250
+
 typedef struct
 {
   gchar *name;
@@ -160,11 +163,31 @@ struct _GtkRecentInfo
   gint ref_count;
 };
 
+/* Writes are done in a thread, see write_recent_items(). The state
+ * is shared with the queued writes, so the manager can wait for them
+ * when it goes away.
+ */
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} RecentWriteState;
+
+typedef struct
+{
+  RecentWriteState *state;
+  gchar *filename;
+  gchar *contents;
+  gsize length;
+} RecentWrite;
+
 struct _GtkRecentManagerPrivate
 {
   gchar *filename;
 
   guint is_dirty : 1;
+  guint reloaded : 1;
 
   gint size;
 
@@ -174,6 +197,11 @@ struct _GtkRecentManagerPrivate
 
   guint changed_timeout;
   guint changed_age;
+
+  guint reload_timeout;
+  GCancellable *reload_cancellable;
+
+  RecentWriteState *write_state;
 };
 
 enum
@@ -216,6 +244,13 @@ static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manag
 
 
 static void     build_recent_items_list                (GtkRecentManager  *manager);
+static void     set_recent_items_list                  (GtkRecentManager  *manager,
+                                                        GBookmarkFile     *items,
+                                                        GError            *read_error);
+static void     gtk_recent_manager_schedule_reload     (GtkRecentManager  *manager);
+static void     write_recent_items                     (GtkRecentManager  *manager);
+static void     wait_for_recent_items_writes           (GtkRecentManager  *manager);
+static void     recent_write_state_clear               (RecentWriteState  *state);
 static void     purge_recent_items_list                (GtkRecentManager  *manager,
                                                         GError           **error);
 
@@ -229,6 +264,9 @@ static guint signal_changed = 0;
 
 static GtkRecentManager *recent_manager_singleton = NULL;
 
+/* a single thread, so writes happen in the order they are queued */
+static GThreadPool *write_pool = NULL;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GtkRecentManager, gtk_recent_manager, G_TYPE_OBJECT)
 
 /* Test of haystack has the needle prefix, comparing case
@@ -329,6 +367,10 @@ gtk_recent_manager_init (GtkRecentManager *manager)
   priv->size = 0;
   priv->filename = NULL;
 
+  priv->write_state = g_atomic_rc_box_new0 (RecentWriteState);
+  g_mutex_init (&priv->write_state->lock);
+  g_cond_init (&priv->write_state->cond);
+
   settings = gtk_settings_get_default ();
   if (settings)
     g_signal_connect_swapped (settings, "notify::gtk-recent-files-enabled",
@@ -387,6 +429,8 @@ gtk_recent_manager_finalize (GObject *object)
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
 
+  g_atomic_rc_box_release_full (priv->write_state, (GDestroyNotify) recent_write_state_clear);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->finalize (object);
 }
 
@@ -412,6 +456,18 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->changed_age = 0;
     }
 
+  if (priv->reload_timeout != 0)
+    {
+      g_source_remove (priv->reload_timeout);
+      priv->reload_timeout = 0;
+    }
+
+  if (priv->reload_cancellable != NULL)
+    {
+      g_cancellable_cancel (priv->reload_cancellable);
+      g_clear_object (&priv->reload_cancellable);
+    }
+
   if (priv->is_dirty)
     {
       g_object_ref (manager);
@@ -419,6 +475,9 @@ gtk_recent_manager_dispose (GObject *gobject)
       g_object_unref (manager);
     }
 
+  /* make sure the changes are on disk before we go away */
+  wait_for_recent_items_writes (manager);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
@@ -438,8 +497,6 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
   if (priv->is_dirty)
     {
-      GError *write_error;
-
       /* we are marked as dirty, so we dump the content of our
        * recently used items list
        */
@@ -486,38 +543,20 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
         }
 
       if (priv->filename != NULL)
-        {
-          write_error = NULL;
-          g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-          if (write_error)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to store changes into '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         write_error->message);
-              g_free (utf8);
-              g_error_free (write_error);
-            }
-
-          if (g_chmod (priv->filename, 0600) < 0)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to set the permissions of '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         g_strerror (errno));
-              g_free (utf8);
-            }
-        }
+        write_recent_items (manager);
 
       /* mark us as clean */
       priv->is_dirty = FALSE;
     }
-  else
+  else if (priv->reloaded)
     {
-      /* we are not marked as dirty, so we have been called
-       * because the recently used resources file has been
-       * changed (and not from us).
+      /* the recently used resources file has been changed (and not
+       * from us), and reloaded in reload_recent_items_done()
        */
+      priv->reloaded = FALSE;
+    }
+  else
+    {
       build_recent_items_list (manager);
     }
 
@@ -538,7 +577,7 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
-      gtk_recent_manager_changed (manager);
+      gtk_recent_manager_schedule_reload (manager);
       break;
 
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
@@ -657,8 +696,8 @@ static void
 build_recent_items_list (GtkRecentManager *manager)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
+  GBookmarkFile *items;
   GError *read_error;
-  gint size;
 
   if (!priv->recent_items)
     {
@@ -668,48 +707,279 @@ build_recent_items_list (GtkRecentManager *manager)
 
   if (priv->filename != NULL)
     {
-      /* the file exists, and it's valid (we hope); if not, destroy the container
-       * object and hope for a better result when the next "changed" signal is
-       * fired.
-       */
+      items = g_bookmark_file_new ();
       read_error = NULL;
-      g_bookmark_file_load_from_file (priv->recent_items, priv->filename, &read_error);
+      g_bookmark_file_load_from_file (items, priv->filename, &read_error);
       if (read_error)
         {
-          /* if the file does not exist we just wait for the first write
-           * operation on this recent manager instance, to avoid creating
-           * empty files and leading to spurious file system events (Sabayon
-           * will not be happy about those)
-           */
-          if (read_error->domain == G_FILE_ERROR &&
-            read_error->code != G_FILE_ERROR_NOENT)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to read the recently used resources "
-                         "file at '%s', but the parser failed: %s.",
-                         utf8 ? utf8 : "(invalid filename)",
-                         read_error->message);
-              g_free (utf8);
-            }
+          g_bookmark_file_free (items);
+          items = NULL;
+        }
 
-          g_bookmark_file_free (priv->recent_items);
-          priv->recent_items = NULL;
+      set_recent_items_list (manager, items, read_error);
+    }
+
+  priv->is_dirty = FALSE;
+}
+
+/* replaces the items list with the loaded items, or drops it if
+ * loading failed. takes ownership of items and read_error.
+ */
+static void
+set_recent_items_list (GtkRecentManager *manager,
+                       GBookmarkFile    *items,
+                       GError           *read_error)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gint size;
 
-          g_error_free (read_error);
+  if (priv->recent_items)
+    g_bookmark_file_free (priv->recent_items);
+  priv->recent_items = items;
+
+  /* the file exists, and it's valid (we hope); if not, destroy the container
+   * object and hope for a better result when the next "changed" signal is
+   * fired.
+   */
+  if (read_error)
+    {
+      /* if the file does not exist we just wait for the first write
+       * operation on this recent manager instance, to avoid creating
+       * empty files and leading to spurious file system events (Sabayon
+       * will not be happy about those)
+       */
+      if (read_error->domain == G_FILE_ERROR &&
+        read_error->code != G_FILE_ERROR_NOENT)
+        {
+          gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+          g_warning ("Attempting to read the recently used resources "
+                     "file at '%s', but the parser failed: %s.",
+                     utf8 ? utf8 : "(invalid filename)",
+                     read_error->message);
+          g_free (utf8);
         }
-      else
+
+      g_error_free (read_error);
+    }
+  else
+    {
+      size = g_bookmark_file_get_size (priv->recent_items);
+      if (priv->size != size)
         {
-          size = g_bookmark_file_get_size (priv->recent_items);
-          if (priv->size != size)
-            {
-              priv->size = size;
+          priv->size = size;
 
-              g_object_notify (G_OBJECT (manager), "size");
-            }
+          g_object_notify (G_OBJECT (manager), "size");
         }
     }
+}
 
-  priv->is_dirty = FALSE;
+/* parsing a large file takes a while, so changes from other
+ * applications are loaded in a thread
+ */
+static void
+reload_recent_items_thread (GTask        *task,
+                            gpointer      source_object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
+{
+  const gchar *filename = task_data;
+  GBookmarkFile *items;
+  GError *read_error = NULL;
+
+  items = g_bookmark_file_new ();
+  if (!g_bookmark_file_load_from_file (items, filename, &read_error))
+    {
+      g_bookmark_file_free (items);
+      g_task_return_error (task, read_error);
+      return;
+    }
+
+  g_task_return_pointer (task, items, (GDestroyNotify) g_bookmark_file_free);
+}
+
+static gboolean
+has_pending_writes (GtkRecentManager *manager)
+{
+  RecentWriteState *state = manager->priv->write_state;
+  gboolean pending;
+
+  g_mutex_lock (&state->lock);
+  pending = state->n_pending > 0;
+  g_mutex_unlock (&state->lock);
+
+  return pending;
+}
+
+static void
+reload_recent_items_done (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GtkRecentManager *manager;
+  GtkRecentManagerPrivate *priv;
+  GBookmarkFile *items;
+  GError *read_error = NULL;
+
+  items = g_task_propagate_pointer (G_TASK (result), &read_error);
+
+  /* the manager is gone, or a newer reload has been started */
+  if (g_error_matches (read_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (read_error);
+      return;
+    }
+
+  manager = user_data;
+  priv = manager->priv;
+
+  g_clear_object (&priv->reload_cancellable);
+
+  /* we have changes the loaded file doesn't know about; once they
+   * have been written, the monitor brings us here again
+   */
+  if (priv->is_dirty || has_pending_writes (manager))
+    {
+      if (items)
+        g_bookmark_file_free (items);
+      g_clear_error (&read_error);
+      return;
+    }
+
+  g_object_freeze_notify (G_OBJECT (manager));
+  set_recent_items_list (manager, items, read_error);
+  g_object_thaw_notify (G_OBJECT (manager));
+
+  priv->reloaded = TRUE;
+  g_signal_emit (manager, signal_changed, 0);
+}
+
+static gboolean
+reload_recent_items (gpointer data)
+{
+  GtkRecentManager *manager = data;
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GTask *task;
+
+  priv->reload_timeout = 0;
+
+  if (priv->filename == NULL)
+    return G_SOURCE_REMOVE;
+
+  if (priv->reload_cancellable)
+    g_cancellable_cancel (priv->reload_cancellable);
+  g_clear_object (&priv->reload_cancellable);
+  priv->reload_cancellable = g_cancellable_new ();
+
+  /* the manager is not referenced by the task, dispose cancels it */
+  task = g_task_new (NULL, priv->reload_cancellable, reload_recent_items_done, manager);
+  g_task_set_source_tag (task, reload_recent_items);
+  g_task_set_task_data (task, g_strdup (priv->filename), g_free);
+  g_task_run_in_thread (task, reload_recent_items_thread);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_recent_manager_schedule_reload (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+
+  /* other applications write the file often, and a single write
+   * usually comes as more than one event
+   */
+  if (priv->reload_timeout == 0)
+    {
+      priv->reload_timeout = g_timeout_add (RELOAD_TIMEOUT, reload_recent_items, manager);
+      g_source_set_name_by_id (priv->reload_timeout, "[gtk] reload_recent_items");
+    }
+}
+
+static void
+recent_write_state_clear (RecentWriteState *state)
+{
+  g_mutex_clear (&state->lock);
+  g_cond_clear (&state->cond);
+}
+
+static void
+write_recent_items_thread (gpointer data,
+                           gpointer user_data)
+{
+  RecentWrite *write = data;
+  RecentWriteState *state = write->state;
+  GError *write_error = NULL;
+
+  /* g_file_set_contents() writes to a temporary file and renames it,
+   * so readers never see a partially written list
+   */
+  if (!g_file_set_contents (write->filename, write->contents, write->length, &write_error))
+    {
+      gchar *utf8 = g_filename_to_utf8 (write->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to store changes into '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 write_error->message);
+      g_free (utf8);
+      g_error_free (write_error);
+    }
+  else if (g_chmod (write->filename, 0600) < 0)
+    {
+      gchar *utf8 = g_filename_to_utf8 (write->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to set the permissions of '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 g_strerror (errno));
+      g_free (utf8);
+    }
+
+  g_mutex_lock (&state->lock);
+  state->n_pending--;
+  g_cond_broadcast (&state->cond);
+  g_mutex_unlock (&state->lock);
+
+  g_atomic_rc_box_release_full (state, (GDestroyNotify) recent_write_state_clear);
+  g_free (write->filename);
+  g_free (write->contents);
+  g_slice_free (RecentWrite, write);
+}
+
+/* serializes the items list and queues writing it to the file */
+static void
+write_recent_items (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  RecentWrite *write;
+  gchar *contents;
+  gsize length;
+
+  contents = g_bookmark_file_to_data (priv->recent_items, &length, NULL);
+  if (contents == NULL)
+    return;
+
+  if (G_UNLIKELY (write_pool == NULL))
+    write_pool = g_thread_pool_new (write_recent_items_thread, NULL, 1, FALSE, NULL);
+
+  write = g_slice_new (RecentWrite);
+  write->state = g_atomic_rc_box_acquire (priv->write_state);
+  write->filename = g_strdup (priv->filename);
+  write->contents = contents;
+  write->length = length;
+
+  g_mutex_lock (&priv->write_state->lock);
+  priv->write_state->n_pending++;
+  g_mutex_unlock (&priv->write_state->lock);
+
+  g_thread_pool_push (write_pool, write, NULL);
+}
+
+static void
+wait_for_recent_items_writes (GtkRecentManager *manager)
+{
+  RecentWriteState *state = manager->priv->write_state;
+
+  g_mutex_lock (&state->lock);
+  while (state->n_pending > 0)
+    g_cond_wait (&state->cond, &state->lock);
+  g_mutex_unlock (&state->lock);
 }
 
 
@@ -36,6 +36,7 @@
 #include "gtkcssrgbavalueprivate.h"
 #include "gtkcssstyleprivate.h"
 #include "gtkcsstypesprivate.h"
+#include "gtkrenderborderprivate.h"
 
 #include <math.h>
 
@@ -333,3 +334,50 @@ gtk_css_style_snapshot_background (GtkCssBoxes *boxes,
   gtk_snapshot_pop (snapshot);
 }
 
+/**
+ * gtk_css_style_snapshot_box:
+ * @boxes: the boxes to draw
+ * @snapshot: the snapshot to draw to
+ *
+ * Draws the background and the border of @boxes, like calling
+ * gtk_css_style_snapshot_background() and gtk_css_style_snapshot_border().
+ *
+ * Widgets sharing a style usually also share their size, so the nodes
+ * are kept on the style and reused as long as the border box doesn't
+ * change. Since all of them are positioned relative to the border box,
+ * they are rebuilt completely when it does.
+ */
+void
+gtk_css_style_snapshot_box (GtkCssBoxes *boxes,
+                            GtkSnapshot *snapshot)
+{
+  GtkCssStyle *style = boxes->style;
+  const graphene_rect_t *bounds;
+  GtkSnapshot *box_snapshot;
+
+  /* Animated styles are replaced every frame, caching them is pointless */
+  if (!gtk_css_style_is_static (style))
+    {
+      gtk_css_style_snapshot_background (boxes, snapshot);
+      gtk_css_style_snapshot_border (boxes, snapshot);
+      return;
+    }
+
+  bounds = &gtk_css_boxes_get_border_box (boxes)->bounds;
+
+  if (!style->box_node_valid ||
+      !graphene_rect_equal (&style->box_node_bounds, bounds))
+    {
+      g_clear_pointer (&style->box_node, gsk_render_node_unref);
+
+      box_snapshot = gtk_snapshot_new ();
+      gtk_css_style_snapshot_background (boxes, box_snapshot);
+      gtk_css_style_snapshot_border (boxes, box_snapshot);
+      style->box_node = gtk_snapshot_free_to_node (box_snapshot);
+      style->box_node_bounds = *bounds;
+      style->box_node_valid = TRUE;
+    }
+
+  if (style->box_node)
+    gtk_snapshot_append_node (snapshot, style->box_node);
+}
@@ -31,6 +31,8 @@ G_BEGIN_DECLS
 
 void            gtk_css_style_snapshot_background               (GtkCssBoxes          *boxes,
                                                                  GtkSnapshot          *snapshot);
+void            gtk_css_style_snapshot_box                      (GtkCssBoxes          *boxes,
+                                                                 GtkSnapshot          *snapshot);
 
 
 
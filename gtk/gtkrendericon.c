@@ -125,8 +125,6 @@ gtk_css_style_snapshot_icon_paintable (GtkCssStyle  *style,
 
   if (recolor)
     {
-      graphene_matrix_t color_matrix;
-      graphene_vec4_t color_offset;
       GdkRGBA fg, sc, wc, ec;
 
       gtk_icon_theme_lookup_symbolic_colors (style, &fg, &sc, &wc, &ec);
@@ -134,15 +132,7 @@ gtk_css_style_snapshot_icon_paintable (GtkCssStyle  *style,
       if (fg.alpha == 0.0f)
         goto transparent;
 
-      graphene_matrix_init_from_float (&color_matrix, (float[16]) {
-                                         sc.red - fg.red, sc.green - fg.green, sc.blue - fg.blue, 0,
-                                         wc.red - fg.red, wc.green - fg.green, wc.blue - fg.blue, 0,
-                                         ec.red - fg.red, ec.green - fg.green, ec.blue - fg.blue, 0,
-                                         0, 0, 0, fg.alpha
-                                       });
-      graphene_vec4_init (&color_offset, fg.red, fg.green, fg.blue, 0);
-
-      gtk_snapshot_push_color_matrix (snapshot, &color_matrix, &color_offset);
+      gtk_icon_theme_push_symbolic_colors (snapshot, &fg, &sc, &wc, &ec);
     }
 
   if (transform == NULL)
@@ -391,14 +391,32 @@ gtk_revealer_real_size_allocate (GtkWidget *widget,
       return;
     }
 
+  /* Scaling the size back up is off by up to 1 / scale pixels due to
+   * rounding. When we got what we asked for, give the child its
+   * natural size, so it keeps its size and render node on every frame
+   * of the transition and only its transform changes. */
   if (hscale < 1.0)
     {
+      int nat;
+
       g_assert (vscale == 1.0);
-      child_width = MIN (G_MAXINT, ceil (width / hscale));
+      gtk_widget_measure (child, GTK_ORIENTATION_HORIZONTAL, height,
+                          NULL, &nat, NULL, NULL);
+      if (width == ceil (nat * hscale))
+        child_width = nat;
+      else
+        child_width = MIN (G_MAXINT, ceil (width / hscale));
     }
   else if (vscale < 1.0)
     {
-      child_height = MIN (G_MAXINT, ceil (height / vscale));
+      int nat;
+
+      gtk_widget_measure (child, GTK_ORIENTATION_VERTICAL, width,
+                          NULL, &nat, NULL, NULL);
+      if (height == ceil (nat * vscale))
+        child_height = nat;
+      else
+        child_height = MIN (G_MAXINT, ceil (height / vscale));
     }
 
   transform = NULL;
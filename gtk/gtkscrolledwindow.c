@@ -3200,6 +3200,25 @@ _gtk_scrolled_window_set_adjustment_value (GtkScrolledWindow *scrolled_window,
   g_signal_emit (scrolled_window, signals[EDGE_OVERSHOT], 0, edge_pos);
 }
 
+/* The time at which the frame that is being drawn will be shown.
+ * Positions computed for it stay evenly spaced on screen even when
+ * the frames start at uneven times because the main loop is busy.
+ */
+static gint64
+get_presentation_time (GdkFrameClock *frame_clock)
+{
+  gint64 frame_time, presentation_time;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time,
+                                    NULL, &presentation_time);
+
+  if (presentation_time == 0)
+    return frame_time;
+
+  return presentation_time;
+}
+
 static gboolean
 scrolled_window_deceleration_cb (GtkWidget         *widget,
                                  GdkFrameClock     *frame_clock,
@@ -3212,8 +3231,8 @@ scrolled_window_deceleration_cb (GtkWidget         *widget,
   gint64 current_time;
   gdouble position, elapsed;
 
-  current_time = gdk_frame_clock_get_frame_time (frame_clock);
-  elapsed = (current_time - data->last_deceleration_time) / 1000000.0;
+  current_time = get_presentation_time (frame_clock);
+  elapsed = MAX (current_time - data->last_deceleration_time, 0) / 1000000.0;
   data->last_deceleration_time = current_time;
 
   hadjustment = gtk_scrollbar_get_adjustment (GTK_SCROLLBAR (priv->hscrollbar));
@@ -3287,7 +3306,7 @@ gtk_scrolled_window_start_deceleration (GtkScrolledWindow *scrolled_window)
 
   data = g_new0 (KineticScrollData, 1);
   data->scrolled_window = scrolled_window;
-  data->last_deceleration_time = gdk_frame_clock_get_frame_time (frame_clock);
+  data->last_deceleration_time = get_presentation_time (frame_clock);
 
   if (may_hscroll (scrolled_window))
     {
@@ -32,21 +32,56 @@
 #include <string.h>
 
 #define BATCH_SIZE 500
-
+#define MAX_SEARCH_THREADS 4
+
+/* Only what is needed to match files and find subdirectories */
+#define WALK_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+                        G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+                        G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+                        G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN
+
+/* What the file chooser shows for a hit */
+#define HIT_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+                       G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+                       G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+                       G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+                       G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
+                       G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+                       G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
+                       G_FILE_ATTRIBUTE_STANDARD_TARGET_URI "," \
+                       G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+                       G_FILE_ATTRIBUTE_TIME_ACCESS "," \
+                       G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME "," \
+                       G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH "," \
+                       G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE
+
+/* The directories to visit are shared by up to MAX_SEARCH_THREADS
+ * threads, which all add the subdirectories they find. The search is
+ * over when the queue is empty and no thread is visiting a directory.
+ */
 typedef struct
 {
   GtkSearchEngineSimple *engine;
   GCancellable *cancellable;
 
+  GMutex lock;
+  GCond cond;
   GQueue *directories;
-
-  gint n_processed_files;
-  GList *hits;
+  guint n_busy;     /* threads visiting a directory */
+  guint n_threads;  /* threads still running */
 
   GtkQuery *query;
   gboolean recursive;
 } SearchThreadData;
 
+typedef struct
+{
+  SearchThreadData *data;
+
+  gint n_processed_files;
+  GList *hits;
+} SearchWorker;
+
 
 struct _GtkSearchEngineSimple
 {
@@ -95,7 +130,12 @@ queue_if_local (SearchThreadData *data,
   if (file &&
       !_gtk_file_consider_as_remote (file) &&
       !g_file_has_uri_scheme (file, "recent"))
-    g_queue_push_tail (data->directories, g_object_ref (file));
+    {
+      g_mutex_lock (&data->lock);
+      g_queue_push_tail (data->directories, g_object_ref (file));
+      g_cond_signal (&data->cond);
+      g_mutex_unlock (&data->lock);
+    }
 }
 
 static SearchThreadData *
@@ -107,6 +147,8 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
   data = g_new0 (SearchThreadData, 1);
 
   data->engine = g_object_ref (engine);
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
   data->directories = g_queue_new ();
   data->query = g_object_ref (query);
   data->recursive = _gtk_search_engine_get_recursive (GTK_SEARCH_ENGINE (engine));
@@ -122,6 +164,8 @@ search_thread_data_free (SearchThreadData *data)
 {
   g_queue_foreach (data->directories, (GFunc)g_object_unref, NULL);
   g_queue_free (data->directories);
+  g_cond_clear (&data->cond);
+  g_mutex_clear (&data->lock);
   g_object_unref (data->cancellable);
   g_object_unref (data->query);
   g_object_unref (data->engine);
@@ -166,25 +210,25 @@ search_thread_add_hits_idle (gpointer user_data)
 }
 
 static void
-send_batch (SearchThreadData *data)
+send_batch (SearchWorker *worker)
 {
   Batch *batch;
 
-  data->n_processed_files = 0;
+  worker->n_processed_files = 0;
 
-  if (data->hits)
+  if (worker->hits)
     {
       guint id;
 
       batch = g_new (Batch, 1);
-      batch->hits = data->hits;
-      batch->thread_data = data;
+      batch->hits = worker->hits;
+      batch->thread_data = worker->data;
 
       id = g_idle_add (search_thread_add_hits_idle, batch);
       g_source_set_name_by_id (id, "[gtk] search_thread_add_hits_idle");
     }
 
-  data->hits = NULL;
+  worker->hits = NULL;
 }
 
 static gboolean
@@ -207,27 +251,16 @@ is_indexed (GtkSearchEngineSimple *engine,
 }
 
 static void
-visit_directory (GFile *dir, SearchThreadData *data)
+visit_directory (GFile *dir, SearchWorker *worker)
 {
+  SearchThreadData *data = worker->data;
   GFileEnumerator *enumerator;
   GFileInfo *info;
   GFile *child;
   const gchar *display_name;
 
   enumerator = g_file_enumerate_children (dir,
-                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP ","
-                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TARGET_URI ","
-                                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
-                                          G_FILE_ATTRIBUTE_TIME_ACCESS ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE,
+                                          WALK_ATTRIBUTES,
                                           G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
                                           data->cancellable, NULL);
   if (enumerator == NULL)
@@ -251,13 +284,18 @@ visit_directory (GFile *dir, SearchThreadData *data)
 
           hit = g_new (GtkSearchHit, 1);
           hit->file = g_object_ref (child);
-          hit->info = g_object_ref (info);
-          data->hits = g_list_prepend (data->hits, hit);
+          /* Hits are rare, so only they get the full info. Without
+           * one, the file chooser queries it itself. */
+          hit->info = g_file_query_info (child,
+                                         HIT_ATTRIBUTES,
+                                         G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                         data->cancellable, NULL);
+          worker->hits = g_list_prepend (worker->hits, hit);
         }
 
-      data->n_processed_files++;
-      if (data->n_processed_files > BATCH_SIZE)
-        send_batch (data);
+      worker->n_processed_files++;
+      if (worker->n_processed_files > BATCH_SIZE)
+        send_batch (worker);
 
       if (data->recursive &&
           g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
@@ -268,27 +306,73 @@ visit_directory (GFile *dir, SearchThreadData *data)
   g_object_unref (enumerator);
 }
 
+/* Returns the next directory to visit, waiting for other threads to
+ * find more if needed, or %NULL when the search is over */
+static GFile *
+next_directory (SearchThreadData *data)
+{
+  GFile *dir;
+
+  g_mutex_lock (&data->lock);
+
+  while ((dir = g_queue_pop_head (data->directories)) == NULL &&
+         data->n_busy > 0 &&
+         !g_cancellable_is_cancelled (data->cancellable))
+    g_cond_wait (&data->cond, &data->lock);
+
+  if (dir != NULL)
+    data->n_busy++;
+
+  g_mutex_unlock (&data->lock);
+
+  return dir;
+}
+
+static void
+directory_done (SearchThreadData *data)
+{
+  g_mutex_lock (&data->lock);
+
+  data->n_busy--;
+  /* wake up the waiting threads so they can quit */
+  if (data->n_busy == 0 || g_cancellable_is_cancelled (data->cancellable))
+    g_cond_broadcast (&data->cond);
+
+  g_mutex_unlock (&data->lock);
+}
+
 static gpointer
 search_thread_func (gpointer user_data)
 {
-  SearchThreadData *data;
+  SearchWorker worker = { user_data, 0, NULL };
+  SearchThreadData *data = worker.data;
   GFile *dir;
+  gboolean last;
   guint id;
 
-  data = user_data;
-
   while (!g_cancellable_is_cancelled (data->cancellable) &&
-         (dir = g_queue_pop_head (data->directories)) != NULL)
+         (dir = next_directory (data)) != NULL)
     {
-      visit_directory (dir, data);
+      visit_directory (dir, &worker);
       g_object_unref (dir);
+      directory_done (data);
     }
 
   if (!g_cancellable_is_cancelled (data->cancellable))
-    send_batch (data);
+    send_batch (&worker);
+  else
+    g_list_free_full (worker.hits, (GDestroyNotify)_gtk_search_hit_free);
 
-  id = g_idle_add (search_thread_done_idle, data);
-  g_source_set_name_by_id (id, "[gtk] search_thread_done_idle");
+  g_mutex_lock (&data->lock);
+  last = --data->n_threads == 0;
+  g_mutex_unlock (&data->lock);
+
+  /* Idles run in order, so this comes after all batches */
+  if (last)
+    {
+      id = g_idle_add (search_thread_done_idle, data);
+      g_source_set_name_by_id (id, "[gtk] search_thread_done_idle");
+    }
 
   return NULL;
 }
@@ -298,6 +382,7 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
 {
   GtkSearchEngineSimple *simple;
   SearchThreadData *data;
+  guint i, n_threads;
 
   simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
 
@@ -309,7 +394,15 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
 
   data = search_thread_data_new (simple, simple->query);
 
-  g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
+  /* Without recursion there is only one directory to visit */
+  if (data->recursive)
+    n_threads = CLAMP (g_get_num_processors (), 1, MAX_SEARCH_THREADS);
+  else
+    n_threads = 1;
+
+  data->n_threads = n_threads;
+  for (i = 0; i < n_threads; i++)
+    g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
 
   simple->active_search = data;
 }
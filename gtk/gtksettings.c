@@ -23,8 +23,10 @@
 #include "gtkcssproviderprivate.h"
 #include "gtkhslaprivate.h"
 #include "gtkintl.h"
+#include "gtkmain.h"
 #include "gtkprivate.h"
 #include "gtkscrolledwindow.h"
+#include "gtkstartupprivate.h"
 #include "gtkstylecontext.h"
 #include "gtkstyleproviderprivate.h"
 #include "gtktypebuiltins.h"
@@ -114,6 +116,7 @@ struct _GtkSettingsPrivate
   gboolean font_size_absolute;
   gchar *font_family;
   cairo_font_options_t *font_options;
+  guint reset_widgets_idle;
 };
 
 struct _GtkSettingsValuePrivate
@@ -1017,6 +1020,9 @@ gtk_settings_finalize (GObject *object)
 
   g_datalist_clear (&priv->queued_settings);
 
+  if (priv->reset_widgets_idle)
+    g_source_remove (priv->reset_widgets_idle);
+
   settings_update_provider (priv->display, &priv->theme_provider, NULL);
   g_slist_free_full (priv->style_cascades, g_object_unref);
 
@@ -1118,6 +1124,7 @@ setting_changed (GdkDisplay       *display,
 static GtkSettings *
 gtk_settings_create_for_display (GdkDisplay *display)
 {
+  gint64 start = gtk_startup_begin (GTK_STARTUP_SETTINGS);
   GtkSettings *settings;
 
 #ifdef GDK_WINDOWING_QUARTZ
@@ -1144,6 +1151,8 @@ gtk_settings_create_for_display (GdkDisplay *display)
   settings_update_font_options (settings);
   settings_update_font_values (settings);
 
+  gtk_startup_end (GTK_STARTUP_SETTINGS, start);
+
   return settings;
 }
 
@@ -1216,6 +1225,38 @@ settings_invalidate_style (GtkSettings *settings)
   gtk_style_provider_changed (GTK_STYLE_PROVIDER (settings));
 }
 
+static gboolean
+reset_widgets_idle (gpointer user_data)
+{
+  GtkSettings *settings = user_data;
+  GtkSettingsPrivate *priv = settings->priv;
+
+  priv->reset_widgets_idle = 0;
+
+  gtk_style_context_reset_widgets (priv->display);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* A single XSETTINGS or portal change usually notifies several
+ * properties at once, so restyle all widgets only once, before
+ * the next layout.
+ */
+static void
+settings_queue_reset_widgets (GtkSettings *settings)
+{
+  GtkSettingsPrivate *priv = settings->priv;
+
+  if (priv->reset_widgets_idle)
+    return;
+
+  priv->reset_widgets_idle = g_idle_add_full (GTK_PRIORITY_RESIZE - 2,
+                                              reset_widgets_idle,
+                                              settings,
+                                              NULL);
+  g_source_set_name_by_id (priv->reset_widgets_idle, "[gtk] reset_widgets_idle");
+}
+
 static void
 settings_update_font_values (GtkSettings *settings)
 {
@@ -1274,7 +1315,7 @@ gtk_settings_notify (GObject    *object,
     case PROP_FONT_NAME:
       settings_update_font_values (settings);
       settings_invalidate_style (settings);
-      gtk_style_context_reset_widgets (priv->display);
+      settings_queue_reset_widgets (settings);
       break;
     case PROP_THEME_NAME:
     case PROP_APPLICATION_PREFER_DARK_THEME:
@@ -1285,21 +1326,21 @@ gtk_settings_notify (GObject    *object,
        * widgets with gtk_widget_style_set(), and also causes more
        * recomputation than necessary.
        */
-      gtk_style_context_reset_widgets (priv->display);
+      settings_queue_reset_widgets (settings);
       break;
     case PROP_XFT_ANTIALIAS:
     case PROP_XFT_HINTING:
     case PROP_XFT_HINTSTYLE:
     case PROP_XFT_RGBA:
       settings_update_font_options (settings);
-      gtk_style_context_reset_widgets (priv->display);
+      settings_queue_reset_widgets (settings);
       break;
     case PROP_FONTCONFIG_TIMESTAMP:
       if (settings_update_fontconfig (settings))
-        gtk_style_context_reset_widgets (priv->display);
+        settings_queue_reset_widgets (settings);
       break;
     case PROP_ENABLE_ANIMATIONS:
-      gtk_style_context_reset_widgets (priv->display);
+      settings_queue_reset_widgets (settings);
       break;
     case PROP_CURSOR_THEME_NAME:
     case PROP_CURSOR_THEME_SIZE:
@@ -2197,6 +2238,7 @@ static void
 settings_update_theme (GtkSettings *settings)
 {
   GtkSettingsPrivate *priv = settings->priv;
+  gint64 start = gtk_startup_begin (GTK_STARTUP_THEME);
   gchar *theme_name;
   gchar *theme_variant;
   const gchar *theme_dir;
@@ -2220,6 +2262,8 @@ settings_update_theme (GtkSettings *settings)
 
   g_free (theme_name);
   g_free (theme_variant);
+
+  gtk_startup_end (GTK_STARTUP_THEME, start);
 }
 
 const cairo_font_options_t *
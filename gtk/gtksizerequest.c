@@ -33,6 +33,8 @@
 #include "gtkcssnumbervalueprivate.h"
 #include "gtklayoutmanagerprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 
 #ifdef G_ENABLE_CONSISTENCY_CHECKS
 static GQuark recursion_check_quark = 0;
@@ -173,6 +175,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
       int css_min_for_size;
       int css_extra_for_size;
       int css_extra_size;
+#ifdef G_ENABLE_DEBUG
+      gint64 before = gdk_profiler_is_running () ? g_get_monotonic_time () : 0;
+#endif
 
       style = gtk_css_node_get_style (gtk_widget_get_css_node (widget));
       get_box_margin (style, &margin);
@@ -402,6 +407,12 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
                                       nat_size,
 				      min_baseline,
 				      nat_baseline);
+
+#ifdef G_ENABLE_DEBUG
+      if (before != 0)
+        gdk_profiler_add_mark (before * 1000, (g_get_monotonic_time () - before) * 1000,
+                               "measure", G_OBJECT_TYPE_NAME (widget));
+#endif
     }
 
   if (minimum)
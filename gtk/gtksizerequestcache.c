@@ -65,8 +65,26 @@ _gtk_size_request_cache_free (SizeRequestCache *cache)
 void
 _gtk_size_request_cache_clear (SizeRequestCache *cache)
 {
+  guint n_lookups = cache->n_lookups;
+  guint n_hits = cache->n_hits;
+
   _gtk_size_request_cache_free (cache);
   _gtk_size_request_cache_init (cache);
+
+  cache->n_lookups = n_lookups;
+  cache->n_hits = n_hits;
+}
+
+/* Moves the request at @index to the front, shifting the more
+ * recently used ones back by one */
+static void
+move_to_front (gpointer *requests,
+               guint     index)
+{
+  gpointer request = requests[index];
+
+  memmove (requests + 1, requests, sizeof (gpointer) * index);
+  requests[0] = request;
 }
 
 void
@@ -125,31 +143,29 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      move_to_front ((gpointer *) cached_sizes, i);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
+      /* If not found, pull a new size from the cache or, if it is full,
+       * reuse the least recently used one, which is the last one.
+       * Either way it becomes the most recently used one. */
+      if (cache->requests_x == NULL)
+	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+
       if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
 	{
+	  if (cache->requests_x[n_sizes] == NULL)
+	    cache->requests_x[n_sizes] = g_slice_new (SizeRequestX);
+
 	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
+	  n_sizes++;
 	}
 
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
+      move_to_front ((gpointer *) cache->requests_x, n_sizes - 1);
 
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = cache->requests_x[0];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -169,31 +185,29 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      move_to_front ((gpointer *) cached_sizes, i);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
+      /* If not found, pull a new size from the cache or, if it is full,
+       * reuse the least recently used one, which is the last one.
+       * Either way it becomes the most recently used one. */
+      if (cache->requests_y == NULL)
+	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+
       if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
 	{
+	  if (cache->requests_y[n_sizes] == NULL)
+	    cache->requests_y[n_sizes] = g_slice_new (SizeRequestY);
+
 	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
+	  n_sizes++;
 	}
 
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+      move_to_front ((gpointer *) cache->requests_y, n_sizes - 1);
 
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
-
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = cache->requests_y[0];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -209,16 +223,18 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
  * the Clutter toolkit but has evolved for other GTK+ requirements.
  */
 gboolean
-_gtk_size_request_cache_lookup (const SizeRequestCache *cache,
-                                GtkOrientation          orientation,
-                                int                     for_size,
-                                int                    *minimum,
-                                int                    *natural,
-                                int                    *minimum_baseline,
-                                int                    *natural_baseline)
+_gtk_size_request_cache_lookup (SizeRequestCache *cache,
+                                GtkOrientation    orientation,
+                                int               for_size,
+                                int              *minimum,
+                                int              *natural,
+                                int              *minimum_baseline,
+                                int              *natural_baseline)
 {
   guint i, p;
 
+  cache->n_lookups++;
+
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       if (for_size < 0)
@@ -227,6 +243,8 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
             {
               const CachedSizeX *result = &cache->cached_size_x;
 
+              cache->n_hits++;
+
               *minimum = result->minimum_size;
               *natural = result->natural_size;
               return TRUE;
@@ -246,6 +264,9 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 		{
                   const CachedSizeX *result = &cur->cached_size;
 
+                  cache->n_hits++;
+                  move_to_front ((gpointer *) cache->requests_x, i);
+
                   *minimum = result->minimum_size;
                   *natural = result->natural_size;
 
@@ -264,6 +285,8 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
             {
               const CachedSizeY *result = &cache->cached_size_y;
 
+              cache->n_hits++;
+
               *minimum = result->minimum_size;
               *natural = result->natural_size;
               *minimum_baseline = result->minimum_baseline;
@@ -285,6 +308,9 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 		{
                   const CachedSizeY *result = &cur->cached_size;
 
+                  cache->n_hits++;
+                  move_to_front ((gpointer *) cache->requests_y, i);
+
                   *minimum = result->minimum_size;
                   *natural = result->natural_size;
                   *minimum_baseline = result->minimum_baseline;
@@ -35,8 +35,13 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * The ranges are kept in most recently used
+ * order, so when they run out the one that
+ * was not used for the longest time is
+ * replaced.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
+#define GTK_SIZE_REQUEST_CACHED_SIZES   (8)
 
 typedef struct {
   gint minimum_size;
@@ -74,10 +79,13 @@ typedef struct {
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
+    guint       n_cached_requests   : 4;
     guint       cached_size_valid   : 1;
   }           flags[2];
+
+  /* Statistics for the inspector, they survive clearing the cache */
+  guint       n_lookups;
+  guint       n_hits;
 } SizeRequestCache;
 
 void            _gtk_size_request_cache_init                    (SizeRequestCache       *cache);
@@ -91,7 +99,7 @@ void            _gtk_size_request_cache_commit                  (SizeRequestCach
                                                                  int                     natural_size,
                                                                  int                     minimum_baseline,
                                                                  int                     natural_baseline);
-gboolean        _gtk_size_request_cache_lookup                  (const SizeRequestCache *cache,
+gboolean        _gtk_size_request_cache_lookup                  (SizeRequestCache       *cache,
                                                                  GtkOrientation          orientation,
                                                                  int                     for_size,
                                                                  int                    *minimum,
@@ -107,6 +107,88 @@ gtk_snapshot_collect_default (GtkSnapshot       *snapshot,
   return node;
 }
 
+/* Rows of lists and similar repeated content create the same
+ * backgrounds, borders and shadows over and over. With interning,
+ * all of them share one node, which saves allocations and lets
+ * renderers and gsk_render_node_diff() compare them by pointer.
+ *
+ * Keys are compared bytewise, so they are cleared before filling
+ * in the parameters that the node type uses.
+ */
+typedef struct
+{
+  GskRenderNodeType type;
+  GskRoundedRect outline; /* bounds.bounds for color nodes */
+  GdkRGBA color[4];
+  float params[4];        /* widths or dx, dy, spread, blur radius */
+} InternedNodeKey;
+
+static guint
+interned_node_key_hash (gconstpointer data)
+{
+  const guint32 *words = data;
+  guint hash = 5381;
+  gsize i;
+
+  G_STATIC_ASSERT (sizeof (InternedNodeKey) % sizeof (guint32) == 0);
+
+  for (i = 0; i < sizeof (InternedNodeKey) / sizeof (guint32); i++)
+    hash = (hash << 5) + hash + words[i];
+
+  return hash;
+}
+
+static gboolean
+interned_node_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  return memcmp (a, b, sizeof (InternedNodeKey)) == 0;
+}
+
+static void
+interned_node_key_free (gpointer key)
+{
+  g_slice_free (InternedNodeKey, key);
+}
+
+static void
+interned_node_key_init (InternedNodeKey   *key,
+                        GskRenderNodeType  type)
+{
+  memset (key, 0, sizeof (InternedNodeKey));
+  key->type = type;
+}
+
+/* Returns a new reference to the node for @key, or %NULL */
+static GskRenderNode *
+gtk_snapshot_lookup_interned (GtkSnapshot           *snapshot,
+                              const InternedNodeKey *key)
+{
+  GskRenderNode *node;
+
+  if (snapshot->interned_nodes == NULL)
+    return NULL;
+
+  node = g_hash_table_lookup (snapshot->interned_nodes, key);
+  if (node == NULL)
+    return NULL;
+
+  return gsk_render_node_ref (node);
+}
+
+static void
+gtk_snapshot_intern (GtkSnapshot           *snapshot,
+                     const InternedNodeKey *key,
+                     GskRenderNode         *node)
+{
+  if (snapshot->interned_nodes == NULL)
+    return;
+
+  g_hash_table_insert (snapshot->interned_nodes,
+                       g_slice_dup (InternedNodeKey, key),
+                       gsk_render_node_ref (node));
+}
+
 static GtkSnapshotState *
 gtk_snapshot_push_state (GtkSnapshot            *snapshot,
                          GskTransform           *transform,
@@ -123,6 +205,20 @@ gtk_snapshot_push_state (GtkSnapshot            *snapshot,
   state->start_node_index = snapshot->nodes->len;
   state->n_nodes = 0;
 
+  /* Child states draw into the same coordinates as their parent,
+   * except for autopushed transforms, see below */
+  if (n_states > 0)
+    {
+      const GtkSnapshotState *parent = &g_array_index (snapshot->state_stack, GtkSnapshotState, n_states - 1);
+
+      state->clip = parent->clip;
+      state->has_clip = parent->has_clip;
+    }
+  else
+    {
+      state->has_clip = FALSE;
+    }
+
   return state;
 }
 
@@ -167,6 +263,17 @@ gtk_snapshot_new (void)
   g_array_set_clear_func (snapshot->state_stack, (GDestroyNotify)gtk_snapshot_state_clear);
   snapshot->nodes = g_ptr_array_new_with_free_func ((GDestroyNotify)gsk_render_node_unref);
 
+  /* Most nodes only live for a frame, so allocate them in bulk */
+  snapshot->arena = gsk_render_node_arena_new ();
+  gsk_render_node_arena_push (snapshot->arena);
+
+  /* Opt-in, as it costs a lookup for every leaf node */
+  if (g_getenv ("GTK_INTERN_NODES") != NULL)
+    snapshot->interned_nodes = g_hash_table_new_full (interned_node_key_hash,
+                                                      interned_node_key_equal,
+                                                      interned_node_key_free,
+                                                      (GDestroyNotify) gsk_render_node_unref);
+
   gtk_snapshot_push_state (snapshot,
                            NULL,
                            gtk_snapshot_collect_default);
@@ -183,6 +290,7 @@ gtk_snapshot_new_with_parent (GtkSnapshot *parent_snapshot)
 
   snapshot->state_stack = parent_snapshot->state_stack;
   snapshot->nodes = parent_snapshot->nodes;
+  snapshot->interned_nodes = parent_snapshot->interned_nodes;
   snapshot->from_parent = TRUE;
 
   gtk_snapshot_push_state (snapshot,
@@ -260,9 +368,32 @@ gtk_snapshot_collect_autopush_transform (GtkSnapshot      *snapshot,
 static void
 gtk_snapshot_autopush_transform (GtkSnapshot *snapshot)
 {
-  gtk_snapshot_push_state (snapshot,
-                           NULL,
-                           gtk_snapshot_collect_autopush_transform);
+  GtkSnapshotState *state, *previous_state;
+  GskTransform *inverse;
+
+  state = gtk_snapshot_push_state (snapshot,
+                                   NULL,
+                                   gtk_snapshot_collect_autopush_transform);
+
+  if (!state->has_clip)
+    return;
+
+  /* The nodes get the previous transform applied, so the clip
+   * needs the opposite */
+  previous_state = gtk_snapshot_get_previous_state (snapshot);
+  state->has_clip = FALSE;
+
+  if (gsk_transform_get_category (previous_state->transform) < GSK_TRANSFORM_CATEGORY_2D)
+    return;
+
+  inverse = gsk_transform_invert (gsk_transform_ref (previous_state->transform));
+  if (inverse == NULL)
+    return;
+
+  gsk_transform_transform_bounds (inverse, &previous_state->clip, &state->clip);
+  state->has_clip = TRUE;
+
+  gsk_transform_unref (inverse);
 }
 
 static gboolean
@@ -426,6 +557,8 @@ gtk_snapshot_push_blur (GtkSnapshot *snapshot,
                                    current_state->transform,
                                    gtk_snapshot_collect_blur);
   state->data.blur.radius = radius;
+  /* Blurring moves pixels into view */
+  state->has_clip = FALSE;
 }
 
 static GskRenderNode *
@@ -586,6 +719,34 @@ gtk_snapshot_ensure_affine (GtkSnapshot *snapshot,
   gsk_transform_to_affine (state->transform, scale_x, scale_y, dx, dy);
 }
 
+/* Private. Gets the area that can end up visible in the
+ * current coordinate system, from the clips pushed so far.
+ * Anything drawn outside of it will be clipped away.
+ *
+ * Returns: %FALSE if nothing is known about the visible area */
+gboolean
+gtk_snapshot_get_clip (GtkSnapshot     *snapshot,
+                       graphene_rect_t *clip)
+{
+  const GtkSnapshotState *state = gtk_snapshot_get_current_state (snapshot);
+  float scale_x, scale_y, dx, dy;
+
+  if (!state->has_clip ||
+      gsk_transform_get_category (state->transform) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    return FALSE;
+
+  gsk_transform_to_affine (state->transform, &scale_x, &scale_y, &dx, &dy);
+  if (scale_x == 0 || scale_y == 0)
+    return FALSE;
+
+  gtk_graphene_rect_scale_affine (&state->clip,
+                                  1 / scale_x, 1 / scale_y,
+                                  - dx / scale_x, - dy / scale_y,
+                                  clip);
+
+  return TRUE;
+}
+
 static void
 gtk_snapshot_ensure_translate (GtkSnapshot *snapshot,
                                float       *dx,
@@ -641,6 +802,8 @@ gtk_snapshot_push_repeat (GtkSnapshot           *snapshot,
 
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &state->data.repeat.bounds);
   state->data.repeat.child_bounds = real_child_bounds;
+  /* Any part of the child can be repeated into view */
+  state->has_clip = FALSE;
 }
 
 static GskRenderNode *
@@ -693,6 +856,12 @@ gtk_snapshot_push_clip (GtkSnapshot           *snapshot,
                                    gtk_snapshot_collect_clip);
 
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &state->data.clip.bounds);
+
+  if (state->has_clip)
+    graphene_rect_intersection (&state->clip, &state->data.clip.bounds, &state->clip);
+  else
+    state->clip = state->data.clip.bounds;
+  state->has_clip = TRUE;
 }
 
 static GskRenderNode *
@@ -760,6 +929,12 @@ gtk_snapshot_push_rounded_clip (GtkSnapshot          *snapshot,
                                    gtk_snapshot_collect_rounded_clip);
 
   gtk_rounded_rect_scale_affine (&state->data.rounded_clip.bounds, bounds, scale_x, scale_y, dx, dy);
+
+  if (state->has_clip)
+    graphene_rect_intersection (&state->clip, &state->data.rounded_clip.bounds.bounds, &state->clip);
+  else
+    state->clip = state->data.rounded_clip.bounds.bounds;
+  state->has_clip = TRUE;
 }
 
 static GskRenderNode *
@@ -807,6 +982,8 @@ gtk_snapshot_push_shadow (GtkSnapshot     *snapshot,
   state = gtk_snapshot_push_state (snapshot,
                                    current_state->transform,
                                    gtk_snapshot_collect_shadow);
+  /* Shadows are offset and blurred into view */
+  state->has_clip = FALSE;
 
   state->data.shadow.n_shadows = n_shadows;
   if (n_shadows == 1)
@@ -1104,10 +1281,15 @@ gtk_snapshot_to_node (GtkSnapshot *snapshot)
     {
       g_array_free (snapshot->state_stack, TRUE);
       g_ptr_array_free (snapshot->nodes, TRUE);
+
+      gsk_render_node_arena_pop (snapshot->arena);
+      g_clear_pointer (&snapshot->arena, gsk_render_node_arena_free);
+      g_clear_pointer (&snapshot->interned_nodes, g_hash_table_unref);
     }
 
   snapshot->state_stack = NULL;
   snapshot->nodes = NULL;
+  snapshot->interned_nodes = NULL;
 
   return result;
 }
@@ -1555,6 +1737,7 @@ gtk_snapshot_append_color (GtkSnapshot           *snapshot,
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
+  InternedNodeKey key;
 
   g_return_if_fail (snapshot != NULL);
   g_return_if_fail (color != NULL);
@@ -1563,7 +1746,16 @@ gtk_snapshot_append_color (GtkSnapshot           *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
 
-  node = gsk_color_node_new (color, &real_bounds);
+  interned_node_key_init (&key, GSK_COLOR_NODE);
+  key.outline.bounds = real_bounds;
+  key.color[0] = *color;
+
+  node = gtk_snapshot_lookup_interned (snapshot, &key);
+  if (node == NULL)
+    {
+      node = gsk_color_node_new (color, &real_bounds);
+      gtk_snapshot_intern (snapshot, &key, node);
+    }
 
   gtk_snapshot_append_node_internal (snapshot, node);
   gsk_render_node_unref (node);
@@ -1829,6 +2021,112 @@ gtk_snapshot_append_repeating_linear_gradient (GtkSnapshot            *snapshot,
   gsk_render_node_unref (node);
 }
 
+/**
+ * gtk_snapshot_append_radial_gradient:
+ * @snapshot: a #GtkSnapshot
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center point for the radial gradient
+ * @hradius: the horizontal radius
+ * @vradius: the vertical radius
+ * @start: the start position (on the horizontal axis)
+ * @end: the end position (on the horizontal axis)
+ * @stops: (array length=n_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_stops: the number of elements in @stops
+ *
+ * Appends a radial gradient node with the given stops to @snapshot.
+ */
+void
+gtk_snapshot_append_radial_gradient (GtkSnapshot            *snapshot,
+                                     const graphene_rect_t  *bounds,
+                                     const graphene_point_t *center,
+                                     float                   hradius,
+                                     float                   vradius,
+                                     float                   start,
+                                     float                   end,
+                                     const GskColorStop     *stops,
+                                     gsize                   n_stops)
+{
+  GskRenderNode *node;
+  graphene_rect_t real_bounds;
+  graphene_point_t real_center;
+  float scale_x, scale_y, dx, dy;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (center != NULL);
+  g_return_if_fail (stops != NULL);
+  g_return_if_fail (n_stops > 1);
+
+  gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
+  gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
+  real_center.x = scale_x * center->x + dx;
+  real_center.y = scale_y * center->y + dy;
+
+  node = gsk_radial_gradient_node_new (&real_bounds,
+                                       &real_center,
+                                       hradius * fabsf (scale_x),
+                                       vradius * fabsf (scale_y),
+                                       start,
+                                       end,
+                                       stops,
+                                       n_stops);
+
+  gtk_snapshot_append_node_internal (snapshot, node);
+  gsk_render_node_unref (node);
+}
+
+/**
+ * gtk_snapshot_append_repeating_radial_gradient:
+ * @snapshot: a #GtkSnapshot
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center point for the radial gradient
+ * @hradius: the horizontal radius
+ * @vradius: the vertical radius
+ * @start: the start position (on the horizontal axis)
+ * @end: the end position (on the horizontal axis)
+ * @stops: (array length=n_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_stops: the number of elements in @stops
+ *
+ * Appends a repeating radial gradient node with the given stops to @snapshot.
+ */
+void
+gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
+                                               const graphene_rect_t  *bounds,
+                                               const graphene_point_t *center,
+                                               float                   hradius,
+                                               float                   vradius,
+                                               float                   start,
+                                               float                   end,
+                                               const GskColorStop     *stops,
+                                               gsize                   n_stops)
+{
+  GskRenderNode *node;
+  graphene_rect_t real_bounds;
+  graphene_point_t real_center;
+  float scale_x, scale_y, dx, dy;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (center != NULL);
+  g_return_if_fail (stops != NULL);
+  g_return_if_fail (n_stops > 1);
+
+  gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
+  gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
+  real_center.x = scale_x * center->x + dx;
+  real_center.y = scale_y * center->y + dy;
+
+  node = gsk_repeating_radial_gradient_node_new (&real_bounds,
+                                                 &real_center,
+                                                 hradius * fabsf (scale_x),
+                                                 vradius * fabsf (scale_y),
+                                                 start,
+                                                 end,
+                                                 stops,
+                                                 n_stops);
+
+  gtk_snapshot_append_node_internal (snapshot, node);
+  gsk_render_node_unref (node);
+}
+
 /**
  * gtk_snapshot_append_border:
  * @snapshot: a #GtkSnapshot
@@ -1850,6 +2148,7 @@ gtk_snapshot_append_border (GtkSnapshot          *snapshot,
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, dx, dy;
+  InternedNodeKey key;
 
   g_return_if_fail (snapshot != NULL);
   g_return_if_fail (outline != NULL);
@@ -1859,7 +2158,17 @@ gtk_snapshot_append_border (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gtk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, dx, dy);
 
-  node = gsk_border_node_new (&real_outline, border_width, border_color);
+  interned_node_key_init (&key, GSK_BORDER_NODE);
+  key.outline = real_outline;
+  memcpy (key.color, border_color, sizeof (key.color));
+  memcpy (key.params, border_width, sizeof (key.params));
+
+  node = gtk_snapshot_lookup_interned (snapshot, &key);
+  if (node == NULL)
+    {
+      node = gsk_border_node_new (&real_outline, border_width, border_color);
+      gtk_snapshot_intern (snapshot, &key, node);
+    }
 
   gtk_snapshot_append_node_internal (snapshot, node);
   gsk_render_node_unref (node);
@@ -1889,6 +2198,7 @@ gtk_snapshot_append_inset_shadow (GtkSnapshot          *snapshot,
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, x, y;
+  InternedNodeKey key;
 
   g_return_if_fail (snapshot != NULL);
   g_return_if_fail (outline != NULL);
@@ -1897,12 +2207,25 @@ gtk_snapshot_append_inset_shadow (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &x, &y);
   gtk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, x, y);
 
-  node = gsk_inset_shadow_node_new (&real_outline,
-                                    color,
-                                    scale_x * dx + x,
-                                    scale_y * dy + y,
-                                    spread,
-                                    blur_radius);
+  interned_node_key_init (&key, GSK_INSET_SHADOW_NODE);
+  key.outline = real_outline;
+  key.color[0] = *color;
+  key.params[0] = scale_x * dx + x;
+  key.params[1] = scale_y * dy + y;
+  key.params[2] = spread;
+  key.params[3] = blur_radius;
+
+  node = gtk_snapshot_lookup_interned (snapshot, &key);
+  if (node == NULL)
+    {
+      node = gsk_inset_shadow_node_new (&real_outline,
+                                        color,
+                                        key.params[0],
+                                        key.params[1],
+                                        spread,
+                                        blur_radius);
+      gtk_snapshot_intern (snapshot, &key, node);
+    }
 
   gtk_snapshot_append_node_internal (snapshot, node);
   gsk_render_node_unref (node);
@@ -1932,6 +2255,7 @@ gtk_snapshot_append_outset_shadow (GtkSnapshot          *snapshot,
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, x, y;
+  InternedNodeKey key;
 
   g_return_if_fail (snapshot != NULL);
   g_return_if_fail (outline != NULL);
@@ -1940,12 +2264,25 @@ gtk_snapshot_append_outset_shadow (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &x, &y);
   gtk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, x, y);
 
-  node = gsk_outset_shadow_node_new (&real_outline,
-                                     color,
-                                     scale_x * dx + x,
-                                     scale_y * dy + y,
-                                     spread,
-                                     blur_radius);
+  interned_node_key_init (&key, GSK_OUTSET_SHADOW_NODE);
+  key.outline = real_outline;
+  key.color[0] = *color;
+  key.params[0] = scale_x * dx + x;
+  key.params[1] = scale_y * dy + y;
+  key.params[2] = spread;
+  key.params[3] = blur_radius;
+
+  node = gtk_snapshot_lookup_interned (snapshot, &key);
+  if (node == NULL)
+    {
+      node = gsk_outset_shadow_node_new (&real_outline,
+                                         color,
+                                         key.params[0],
+                                         key.params[1],
+                                         spread,
+                                         blur_radius);
+      gtk_snapshot_intern (snapshot, &key, node);
+    }
 
 
   gtk_snapshot_append_node_internal (snapshot, node);
@@ -37,6 +37,11 @@ struct _GtkSnapshotState {
 
   GskTransform *         transform;
 
+  /* The part of this state's nodes that can be visible, in the
+   * coordinates of the nodes, not of the transform */
+  graphene_rect_t        clip;
+  guint                  has_clip : 1;
+
   GtkSnapshotCollectFunc collect_func;
   union {
     struct {
@@ -89,6 +94,12 @@ struct _GdkSnapshot {
   GArray                *state_stack;
   GPtrArray             *nodes;
 
+  /* Owned by the snapshot that isn't from_parent */
+  GskRenderNodeArena    *arena;
+  /* Leaf nodes by their parameters, shared with child snapshots.
+   * %NULL unless GTK_INTERN_NODES is set, see gtk_snapshot_new() */
+  GHashTable            *interned_nodes;
+
   guint from_parent : 1;
 };
 
@@ -101,6 +112,9 @@ void                    gtk_snapshot_append_node_internal       (GtkSnapshot
 
 GtkSnapshot *           gtk_snapshot_new_with_parent            (GtkSnapshot            *parent_snapshot);
 
+gboolean                gtk_snapshot_get_clip                   (GtkSnapshot            *snapshot,
+                                                                 graphene_rect_t        *clip);
+
 void                    gtk_snapshot_append_text                (GtkSnapshot            *snapshot,
                                                                  PangoFont              *font,
                                                                  PangoGlyphString       *glyphs,
@@ -24,6 +24,8 @@
 #include "gtkintl.h"
 #include "gtkprivate.h"
 
+#include <string.h>
+
 /**
  * SECTION:gtksortlistmodel
  * @title: GtkSortListModel
@@ -38,16 +40,34 @@
  * If you run into performance issues with #GtkSortListModel, it
  * is strongly recommended that you write your own sorting list
  * model.
+ *
+ * #GtkSortListModel can sort incrementally, see
+ * gtk_sort_list_model_set_incremental(). In that case, sorting happens
+ * in small steps in an idle handler and the items are reordered
+ * progressively, so that sorting large models does not block the UI.
  */
 
+/* Time to spend sorting in one go when sorting incrementally */
+#define SORT_STEP_TIME (G_USEC_PER_SEC / 1000)
+
 enum {
   PROP_0,
   PROP_HAS_SORT,
+  PROP_INCREMENTAL,
   PROP_ITEM_TYPE,
   PROP_MODEL,
+  PROP_PENDING,
   NUM_PROPERTIES
 };
 
+typedef struct _GtkSortListEntry GtkSortListEntry;
+
+struct _GtkSortListEntry
+{
+  GObject *item;
+  guint position; /* position of item in the model */
+};
+
 struct _GtkSortListModel
 {
   GObject parent_instance;
@@ -58,8 +78,15 @@ struct _GtkSortListModel
   gpointer user_data;
   GDestroyNotify user_destroy;
 
-  GSequence *sorted; /* NULL if sort_func == NULL */
-  GSequence *unsorted; /* NULL if sort_func == NULL */
+  GArray *entries; /* NULL if sort_func == NULL, sorted array of GtkSortListEntry */
+
+  gboolean incremental;
+  guint sort_cb; /* 0 if not incrementally sorting */
+  guint run_length; /* length of the sorted runs being merged */
+  guint merge_start; /* start of the two runs being merged */
+  guint merge_i; /* next entry of the first run to merge */
+  guint merge_j; /* next entry of the second run to merge */
+  GtkSortListEntry *merge_buffer; /* entries that have been merged */
 };
 
 struct _GtkSortListModelClass
@@ -85,8 +112,8 @@ gtk_sort_list_model_get_n_items (GListModel *list)
   if (self->model == NULL)
     return 0;
 
-  if (self->sorted)
-    return g_sequence_get_length (self->sorted);
+  if (self->entries)
+    return self->entries->len;
 
   return g_list_model_get_n_items (self->model);
 }
@@ -96,19 +123,17 @@ gtk_sort_list_model_get_item (GListModel *list,
                               guint       position)
 {
   GtkSortListModel *self = GTK_SORT_LIST_MODEL (list);
-  GSequenceIter *iter;
 
   if (self->model == NULL)
     return NULL;
 
-  if (self->unsorted == NULL)
+  if (self->entries == NULL)
     return g_list_model_get_item (self->model, position);
 
-  iter = g_sequence_get_iter_at_pos (self->sorted, position);
-  if (g_sequence_iter_is_end (iter))
-      return NULL;
+  if (position >= self->entries->len)
+    return NULL;
 
-  return g_object_ref (g_sequence_get (iter));
+  return g_object_ref (g_array_index (self->entries, GtkSortListEntry, position).item);
 }
 
 static void
@@ -122,41 +147,89 @@ gtk_sort_list_model_model_init (GListModelInterface *iface)
 G_DEFINE_TYPE_WITH_CODE (GtkSortListModel, gtk_sort_list_model, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_sort_list_model_model_init))
 
+/* Items that compare equal are kept in the order of the model,
+ * so no two entries ever compare equal. */
+static int
+gtk_sort_list_model_compare (gconstpointer first,
+                             gconstpointer second,
+                             gpointer      data)
+{
+  GtkSortListModel *self = data;
+  const GtkSortListEntry *a = first;
+  const GtkSortListEntry *b = second;
+  int result;
+
+  result = self->sort_func (a->item, b->item, self->user_data);
+  if (result == 0)
+    result = a->position < b->position ? -1 : (a->position > b->position ? 1 : 0);
+
+  return result;
+}
+
+/* Returns the number of the first n_entries that sort before entry */
+static guint
+gtk_sort_list_model_find_position (GtkSortListModel       *self,
+                                   const GtkSortListEntry *entries,
+                                   guint                   n_entries,
+                                   const GtkSortListEntry *entry)
+{
+  guint start, end, mid;
+
+  start = 0;
+  end = n_entries;
+  while (start < end)
+    {
+      mid = start + (end - start) / 2;
+      if (gtk_sort_list_model_compare (&entries[mid], entry, self) < 0)
+        start = mid + 1;
+      else
+        end = mid;
+    }
+
+  return start;
+}
+
+/* Removes the entries for the removed items and updates the
+ * positions of the entries after them in a single pass. */
 static void
 gtk_sort_list_model_remove_items (GtkSortListModel *self,
                                   guint             position,
-                                  guint             n_items,
+                                  guint             removed,
+                                  guint             added,
                                   guint            *unmodified_start,
                                   guint            *unmodified_end)
 {
-  GSequenceIter *unsorted_iter;
-  guint i, pos, start, end, length_before;
+  GtkSortListEntry *entries;
+  guint i, j, start, end, length_before;
 
-  start = end = length_before = g_sequence_get_length (self->sorted);
-  unsorted_iter = g_sequence_get_iter_at_pos (self->unsorted, position);
+  entries = (GtkSortListEntry *) self->entries->data;
+  start = end = length_before = self->entries->len;
 
-  for (i = 0; i < n_items ; i++)
+  for (i = 0, j = 0; i < length_before; i++)
     {
-      GSequenceIter *sorted_iter;
-      GSequenceIter *next;
-
-      next = g_sequence_iter_next (unsorted_iter);
-
-      sorted_iter = g_sequence_get (unsorted_iter);
-      pos = g_sequence_iter_get_position (sorted_iter);
-      start = MIN (start, pos);
-      end = MIN (end, length_before - i - 1 - pos);
-
-      g_sequence_remove (sorted_iter);
-      g_sequence_remove (unsorted_iter);
+      if (entries[i].position >= position + removed)
+        {
+          entries[i].position = entries[i].position - removed + added;
+        }
+      else if (entries[i].position >= position)
+        {
+          start = MIN (start, i);
+          end = MIN (end, length_before - 1 - i);
+          g_object_unref (entries[i].item);
+          continue;
+        }
 
-      unsorted_iter = next;
+      entries[j++] = entries[i];
     }
 
+  g_array_set_size (self->entries, j);
+
   *unmodified_start = start;
   *unmodified_end = end;
 }
 
+/* Sorts the new items and then merges them into the sorted entries,
+ * so adding k items to n items only takes O(k log n) comparisons. */
 static void
 gtk_sort_list_model_add_items (GtkSortListModel *self,
                                guint             position,
@@ -164,31 +237,218 @@ gtk_sort_list_model_add_items (GtkSortListModel *self,
                                guint            *unmodified_start,
                                guint            *unmodified_end)
 {
-  GSequenceIter *unsorted_iter, *sorted_iter;
-  guint i, pos, start, end, length_before;
+  GtkSortListEntry *entries, *added;
+  guint i, k, insert, start, end, length_before, length;
 
-  unsorted_iter = g_sequence_get_iter_at_pos (self->unsorted, position);
-  start = end = length_before = g_sequence_get_length (self->sorted);
+  length_before = self->entries->len;
+  length = length_before + n_items;
+  start = end = length;
 
+  added = g_new (GtkSortListEntry, n_items);
   for (i = 0; i < n_items; i++)
     {
-      gpointer item = g_list_model_get_item (self->model, position + i);
-      sorted_iter = g_sequence_insert_sorted (self->sorted, item, self->sort_func, self->user_data);
-      g_sequence_insert_before (unsorted_iter, sorted_iter);
-      if (unmodified_start != NULL || unmodified_end != NULL)
-        {
-          pos = g_sequence_iter_get_position (sorted_iter);
-          start = MIN (start, pos);
-          end = MIN (end, length_before + i - pos);
-        }
+      added[i].item = g_list_model_get_item (self->model, position + i);
+      added[i].position = position + i;
+    }
+  g_qsort_with_data (added, n_items, sizeof (GtkSortListEntry), gtk_sort_list_model_compare, self);
+
+  g_array_set_size (self->entries, length);
+  entries = (GtkSortListEntry *) self->entries->data;
+
+  /* Merge from the back, so every entry is moved at most once.
+   * The first i entries are the ones that haven't been moved yet. */
+  i = length_before;
+  for (k = n_items; k > 0; k--)
+    {
+      insert = gtk_sort_list_model_find_position (self, entries, i, &added[k - 1]);
+      memmove (&entries[insert + k], &entries[insert], (i - insert) * sizeof (GtkSortListEntry));
+      entries[insert + k - 1] = added[k - 1];
+
+      start = MIN (start, insert + k - 1);
+      end = MIN (end, length - insert - k);
+      i = insert;
     }
 
+  g_free (added);
+
   if (unmodified_start)
     *unmodified_start = start;
   if (unmodified_end)
     *unmodified_end = end;
 }
 
+static void
+gtk_sort_list_model_stop_sorting (GtkSortListModel *self)
+{
+  if (self->sort_cb == 0)
+    return;
+
+  g_clear_handle_id (&self->sort_cb, g_source_remove);
+  g_clear_pointer (&self->merge_buffer, g_free);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
+static void
+gtk_sort_list_model_clear_entries (GtkSortListModel *self)
+{
+  guint i;
+
+  if (self->entries == NULL)
+    return;
+
+  gtk_sort_list_model_stop_sorting (self);
+
+  for (i = 0; i < self->entries->len; i++)
+    g_object_unref (g_array_index (self->entries, GtkSortListEntry, i).item);
+
+  g_clear_pointer (&self->entries, g_array_unref);
+}
+
+/*
+ * Incremental sorting is a bottom-up merge sort. Every pass merges
+ * pairs of sorted runs of run_length entries into runs twice as long.
+ * Entries are merged into merge_buffer and only copied back once two
+ * runs are completely merged, so the entries always stay in a
+ * consistent order and a merge can be interrupted at any time.
+ */
+static void
+gtk_sort_list_model_begin_merge (GtkSortListModel *self)
+{
+  self->merge_i = self->merge_start;
+  self->merge_j = MIN (self->merge_start + self->run_length, self->entries->len);
+}
+
+static void
+gtk_sort_list_model_next_merge (GtkSortListModel *self)
+{
+  self->merge_start += 2 * self->run_length;
+  if (self->merge_start >= self->entries->len)
+    {
+      self->merge_start = 0;
+      self->run_length *= 2;
+    }
+
+  gtk_sort_list_model_begin_merge (self);
+}
+
+/* Returns TRUE when sorting is done */
+static gboolean
+gtk_sort_list_model_sort_step (GtkSortListModel *self,
+                               gint64            end_time)
+{
+  GtkSortListEntry *entries;
+  guint n_items, mid, end, k, n;
+
+  n_items = self->entries->len;
+  entries = (GtkSortListEntry *) self->entries->data;
+
+  for (n = 0; self->run_length < n_items; n++)
+    {
+      mid = MIN (self->merge_start + self->run_length, n_items);
+      end = MIN (self->merge_start + 2 * self->run_length, n_items);
+
+      /* Nothing to do if the runs are already in order */
+      if (mid == end ||
+          (self->merge_i == self->merge_start &&
+           gtk_sort_list_model_compare (&entries[mid - 1], &entries[mid], self) < 0))
+        {
+          gtk_sort_list_model_next_merge (self);
+          continue;
+        }
+
+      k = self->merge_i - self->merge_start + self->merge_j - mid;
+      while (self->merge_i < mid && self->merge_j < end)
+        {
+          if ((++n % 256) == 0 && g_get_monotonic_time () >= end_time)
+            return FALSE;
+
+          if (gtk_sort_list_model_compare (&entries[self->merge_i], &entries[self->merge_j], self) <= 0)
+            self->merge_buffer[k++] = entries[self->merge_i++];
+          else
+            self->merge_buffer[k++] = entries[self->merge_j++];
+        }
+
+      memcpy (&self->merge_buffer[k], &entries[self->merge_i], (mid - self->merge_i) * sizeof (GtkSortListEntry));
+      k += mid - self->merge_i;
+      memcpy (&self->merge_buffer[k], &entries[self->merge_j], (end - self->merge_j) * sizeof (GtkSortListEntry));
+      memcpy (&entries[self->merge_start], self->merge_buffer, (end - self->merge_start) * sizeof (GtkSortListEntry));
+
+      g_list_model_items_changed (G_LIST_MODEL (self),
+                                  self->merge_start,
+                                  end - self->merge_start,
+                                  end - self->merge_start);
+
+      gtk_sort_list_model_next_merge (self);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_sort_list_model_sort_cb (gpointer data)
+{
+  GtkSortListModel *self = data;
+
+  if (gtk_sort_list_model_sort_step (self, g_get_monotonic_time () + SORT_STEP_TIME))
+    {
+      /* Don't remove the source twice */
+      self->sort_cb = 0;
+      g_clear_pointer (&self->merge_buffer, g_free);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return G_SOURCE_REMOVE;
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* (Re)starts sorting all entries incrementally, starting from
+ * the order they are in now. */
+static void
+gtk_sort_list_model_start_sorting (GtkSortListModel *self)
+{
+  if (self->entries->len <= 1)
+    {
+      gtk_sort_list_model_stop_sorting (self);
+      return;
+    }
+
+  self->run_length = 1;
+  self->merge_start = 0;
+  gtk_sort_list_model_begin_merge (self);
+
+  g_free (self->merge_buffer);
+  self->merge_buffer = g_new (GtkSortListEntry, self->entries->len);
+
+  if (self->sort_cb == 0)
+    {
+      self->sort_cb = g_idle_add (gtk_sort_list_model_sort_cb, self);
+      g_source_set_name_by_id (self->sort_cb, "[gtk] gtk_sort_list_model_sort_cb");
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
+/* Adds the items in the order of the model and leaves sorting them
+ * to gtk_sort_list_model_start_sorting(). */
+static void
+gtk_sort_list_model_append_items (GtkSortListModel *self,
+                                  guint             position,
+                                  guint             n_items)
+{
+  GtkSortListEntry entry;
+  guint i;
+
+  for (i = 0; i < n_items; i++)
+    {
+      entry.item = g_list_model_get_item (self->model, position + i);
+      entry.position = position + i;
+      g_array_append_val (self->entries, entry);
+    }
+}
+
 static void
 gtk_sort_list_model_items_changed_cb (GListModel       *model,
                                       guint             position,
@@ -201,19 +461,31 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
   if (removed == 0 && added == 0)
     return;
 
-  if (self->sorted == NULL)
+  if (self->entries == NULL)
     {
       g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
       return;
     }
 
-  gtk_sort_list_model_remove_items (self, position, removed, &start, &end);
-  gtk_sort_list_model_add_items (self, position, added, &start2, &end2);
+  gtk_sort_list_model_remove_items (self, position, removed, added, &start, &end);
+  if (self->sort_cb)
+    {
+      /* The entries aren't sorted, so we can't merge the new ones.
+       * Add them at the end and sort again. */
+      start2 = self->entries->len;
+      end2 = 0;
+      gtk_sort_list_model_append_items (self, position, added);
+    }
+  else
+    gtk_sort_list_model_add_items (self, position, added, &start2, &end2);
   start = MIN (start, start2);
   end = MIN (end, end2);
 
-  n_items = g_sequence_get_length (self->sorted) - start - end;
+  n_items = self->entries->len - start - end;
   g_list_model_items_changed (G_LIST_MODEL (self), start, n_items - added + removed, n_items);
+
+  if (self->sort_cb)
+    gtk_sort_list_model_start_sorting (self);
 }
 
 static void
@@ -226,6 +498,10 @@ gtk_sort_list_model_set_property (GObject      *object,
 
   switch (prop_id)
     {
+    case PROP_INCREMENTAL:
+      gtk_sort_list_model_set_incremental (self, g_value_get_boolean (value));
+      break;
+
     case PROP_ITEM_TYPE:
       self->item_type = g_value_get_gtype (value);
       break;
@@ -254,6 +530,10 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->sort_func != NULL);
       break;
 
+    case PROP_INCREMENTAL:
+      g_value_set_boolean (value, self->incremental);
+      break;
+
     case PROP_ITEM_TYPE:
       g_value_set_gtype (value, self->item_type);
       break;
@@ -262,6 +542,10 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_object (value, self->model);
       break;
 
+    case PROP_PENDING:
+      g_value_set_uint (value, gtk_sort_list_model_get_pending (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -276,8 +560,7 @@ gtk_sort_list_model_clear_model (GtkSortListModel *self)
 
   g_signal_handlers_disconnect_by_func (self->model, gtk_sort_list_model_items_changed_cb, self);
   g_clear_object (&self->model);
-  g_clear_pointer (&self->sorted, g_sequence_free);
-  g_clear_pointer (&self->unsorted, g_sequence_free);
+  gtk_sort_list_model_clear_entries (self);
 }
 
 static void
@@ -316,6 +599,18 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                             FALSE,
                             GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkSortListModel:incremental:
+   *
+   * If the model should sort items incrementally
+   */
+  properties[PROP_INCREMENTAL] =
+      g_param_spec_boolean ("incremental",
+                            P_("Incremental"),
+                            P_("Sort items incrementally"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkSortListModel:item-type:
    *
@@ -340,6 +635,18 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                            G_TYPE_LIST_MODEL,
                            GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkSortListModel:pending:
+   *
+   * Estimate of unsorted items remaining
+   */
+  properties[PROP_PENDING] =
+      g_param_spec_uint ("pending",
+                         P_("Pending"),
+                         P_("Estimate of unsorted items remaining"),
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -402,15 +709,20 @@ gtk_sort_list_model_new_for_type (GType item_type)
 }
 
 static void
-gtk_sort_list_model_create_sequences (GtkSortListModel *self)
+gtk_sort_list_model_create_entries (GtkSortListModel *self)
 {
   if (!self->sort_func || self->model == NULL)
     return;
 
-  self->sorted = g_sequence_new (g_object_unref);
-  self->unsorted = g_sequence_new (NULL);
+  self->entries = g_array_new (FALSE, FALSE, sizeof (GtkSortListEntry));
 
-  gtk_sort_list_model_add_items (self, 0, g_list_model_get_n_items (self->model), NULL, NULL);
+  if (self->incremental)
+    {
+      gtk_sort_list_model_append_items (self, 0, g_list_model_get_n_items (self->model));
+      gtk_sort_list_model_start_sorting (self);
+    }
+  else
+    gtk_sort_list_model_add_items (self, 0, g_list_model_get_n_items (self->model), NULL, NULL);
 }
 
 /**
@@ -442,14 +754,13 @@ gtk_sort_list_model_set_sort_func (GtkSortListModel *self,
   if (self->user_destroy)
     self->user_destroy (self->user_data);
 
-  g_clear_pointer (&self->unsorted, g_sequence_free);
-  g_clear_pointer (&self->sorted, g_sequence_free);
+  gtk_sort_list_model_clear_entries (self);
   self->sort_func = sort_func;
   self->user_data = user_data;
   self->user_destroy = user_destroy;
-  
-    gtk_sort_list_model_create_sequences (self);
-    
+
+  gtk_sort_list_model_create_entries (self);
+
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self));
   if (n_items > 1)
     g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items, n_items);
@@ -490,7 +801,7 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_sort_list_model_items_changed_cb), self);
       added = g_list_model_get_n_items (model);
 
-      gtk_sort_list_model_create_sequences (self);
+      gtk_sort_list_model_create_entries (self);
     }
   else
     added = 0;
@@ -549,15 +860,135 @@ gtk_sort_list_model_resort (GtkSortListModel *self)
 
   g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
   
-  if (self->sorted == NULL)
+  if (self->entries == NULL)
     return;
 
-  n_items = g_list_model_get_n_items (self->model);
+  n_items = self->entries->len;
   if (n_items <= 1)
     return;
 
-  g_sequence_sort (self->sorted, self->sort_func, self->user_data);
+  if (self->incremental)
+    {
+      gtk_sort_list_model_start_sorting (self);
+      return;
+    }
+
+  g_qsort_with_data (self->entries->data, n_items, sizeof (GtkSortListEntry), gtk_sort_list_model_compare, self);
 
   g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items, n_items);
 }
 
+
+/**
+ * gtk_sort_list_model_set_incremental:
+ * @self: a #GtkSortListModel
+ * @incremental: %TRUE to sort incrementally
+ *
+ * Sets the sort model to do an incremental sort.
+ *
+ * When incremental sorting is enabled, the sortlistmodel will not do
+ * a complete sort immediately, but will instead queue an idle handler that
+ * incrementally sorts the items towards their correct position. This of
+ * course means that items do not instantly appear in the right place. It
+ * also means that the total sorting time is a lot slower.
+ *
+ * When your filter blocks the UI while sorting, you might consider
+ * turning this on. Depending on your model and sort function, this may
+ * become interesting around 10,000 to 100,000 items.
+ *
+ * By default, incremental sorting is disabled.
+ *
+ * See gtk_sort_list_model_get_pending() for progress information
+ * about an ongoing incremental sort.
+ **/
+void
+gtk_sort_list_model_set_incremental (GtkSortListModel *self,
+                                     gboolean          incremental)
+{
+  g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
+
+  incremental = !!incremental;
+
+  if (self->incremental == incremental)
+    return;
+
+  self->incremental = incremental;
+
+  /* Finish an ongoing sort right away */
+  if (!incremental && self->sort_cb)
+    {
+      gtk_sort_list_model_sort_step (self, G_MAXINT64);
+      gtk_sort_list_model_stop_sorting (self);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INCREMENTAL]);
+}
+
+/**
+ * gtk_sort_list_model_get_incremental:
+ * @self: a #GtkSortListModel
+ *
+ * Returns whether incremental sorting was enabled via
+ * gtk_sort_list_model_set_incremental().
+ *
+ * Returns: %TRUE if incremental sorting is enabled
+ **/
+gboolean
+gtk_sort_list_model_get_incremental (GtkSortListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
+
+  return self->incremental;
+}
+
+/**
+ * gtk_sort_list_model_get_pending:
+ * @self: a #GtkSortListModel
+ *
+ * Estimates progress of an ongoing sorting operation.
+ *
+ * The estimate is the number of items that would still need to be
+ * sorted to finish the sorting operation if this was a linear
+ * algorithm. So this number is not related to how many items are
+ * already correctly sorted.
+ *
+ * If you want to estimate the progress, you can use code like this:
+ * |[<!-- language="C" -->
+ *   pending = gtk_sort_list_model_get_pending (self);
+ *   model = gtk_sort_list_model_get_model (self);
+ *   progress = 1.0 - pending / (double) MAX (1, g_list_model_get_n_items (model));
+ * ]|
+ *
+ * If no sort operation is ongoing - in particular when
+ * #GtkSortListModel:incremental is %FALSE - this function returns 0.
+ *
+ * Returns: a progress estimate of remaining items to sort
+ **/
+guint
+gtk_sort_list_model_get_pending (GtkSortListModel *self)
+{
+  guint n_items, n_passes, passes_left, run_length, done;
+
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), 0);
+
+  if (self->sort_cb == 0)
+    return 0;
+
+  n_items = self->entries->len;
+
+  /* Every pass touches every item once */
+  n_passes = 0;
+  passes_left = 0;
+  for (run_length = 1; run_length < n_items; run_length *= 2)
+    {
+      n_passes++;
+      if (run_length >= self->run_length)
+        passes_left++;
+    }
+
+  done = self->merge_i - self->merge_start
+         + self->merge_j - MIN (self->merge_start + self->run_length, n_items)
+         + self->merge_start;
+
+  return ((guint64) passes_left * n_items - done) / MAX (n_passes, 1);
+}
@@ -2436,8 +2436,11 @@ gtk_stack_size_allocate (GtkWidget *widget,
 
       gtk_widget_size_allocate (priv->last_visible_child->widget, &child_allocation, -1);
 
-      if (!gdk_rectangle_equal (&priv->last_visible_surface_allocation,
-                                &child_allocation))
+      /* Window moving transitions move the old child on every frame,
+       * but its node is drawn at a computed offset anyway. Only a new
+       * size makes the node outdated, everything else reuses it. */
+      if (priv->last_visible_surface_allocation.width != child_allocation.width ||
+          priv->last_visible_surface_allocation.height != child_allocation.height)
         {
           g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
         }
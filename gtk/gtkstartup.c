@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkstartupprivate.h"
+
+#include "gtkdebug.h"
+#include "gdk/gdkprofilerprivate.h"
+
+/*
+ * Startup phases measure where the time between gtk_init() and the
+ * first frame that is presented goes. Every phase adds up the time of
+ * all its runs until the first frame is done, after that
+ * gtk_startup_begin() returns 0 and nothing is measured anymore.
+ *
+ * Phases can nest, theme loading for example happens while creating
+ * the settings, so the times don't add up to the total.
+ *
+ * With GTK_DEBUG=startup, a summary is printed after the first frame.
+ * While a sysprof capture is running, every run is recorded as a mark.
+ */
+
+static const char *phase_names[GTK_N_STARTUP_PHASES] = {
+  [GTK_STARTUP_INIT] = "gtk_init",
+  [GTK_STARTUP_DISPLAY] = "display",
+  [GTK_STARTUP_MODULES] = "modules",
+  [GTK_STARTUP_SETTINGS] = "settings",
+  [GTK_STARTUP_THEME] = "theme",
+  [GTK_STARTUP_ICON_THEME] = "icon theme",
+  [GTK_STARTUP_RENDERER] = "renderer",
+  [GTK_STARTUP_LAYOUT] = "layout",
+  [GTK_STARTUP_FIRST_FRAME] = "first frame",
+};
+
+static gint64 startup_time;
+static gint64 phase_times[GTK_N_STARTUP_PHASES];
+static guint phase_runs[GTK_N_STARTUP_PHASES];
+static gboolean finished;
+
+/* Returns the start time to pass to gtk_startup_end(), or 0 once
+ * startup is over */
+gint64
+gtk_startup_begin (GtkStartupPhase phase)
+{
+  gint64 now;
+
+  if (finished)
+    return 0;
+
+  now = g_get_monotonic_time ();
+  if (startup_time == 0)
+    startup_time = now;
+
+  return now;
+}
+
+void
+gtk_startup_end (GtkStartupPhase phase,
+                 gint64          start)
+{
+  gint64 duration;
+
+  if (start == 0 || finished)
+    return;
+
+  duration = g_get_monotonic_time () - start;
+  phase_times[phase] += duration;
+  phase_runs[phase]++;
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_mark (start * 1000, duration * 1000, "startup", phase_names[phase]);
+}
+
+/* Called after rendering a frame, only the first call does something */
+void
+gtk_startup_finish (void)
+{
+  gint64 total;
+
+  if (finished)
+    return;
+
+  finished = TRUE;
+
+  if (startup_time == 0)
+    return;
+
+  total = g_get_monotonic_time () - startup_time;
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_mark (startup_time * 1000, total * 1000, "startup", "time to first frame");
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (STARTUP))
+    {
+      GString *report;
+      guint i;
+
+      report = g_string_new (NULL);
+      g_string_append_printf (report, "Startup: %.1f ms to the first frame", total / 1000.);
+
+      for (i = 0; i < GTK_N_STARTUP_PHASES; i++)
+        {
+          if (phase_runs[i] == 0)
+            continue;
+
+          g_string_append_printf (report, "\n  %-12s %8.1f ms", phase_names[i], phase_times[i] / 1000.);
+          if (phase_runs[i] > 1)
+            g_string_append_printf (report, " (%u times)", phase_runs[i]);
+        }
+
+      g_message ("%s", report->str);
+      g_string_free (report, TRUE);
+    }
+#endif
+}
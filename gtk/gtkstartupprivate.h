@@ -0,0 +1,45 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_STARTUP_PRIVATE_H__
+#define __GTK_STARTUP_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GTK_STARTUP_INIT,
+  GTK_STARTUP_DISPLAY,
+  GTK_STARTUP_MODULES,
+  GTK_STARTUP_SETTINGS,
+  GTK_STARTUP_THEME,
+  GTK_STARTUP_ICON_THEME,
+  GTK_STARTUP_RENDERER,
+  GTK_STARTUP_LAYOUT,
+  GTK_STARTUP_FIRST_FRAME,
+  GTK_N_STARTUP_PHASES
+} GtkStartupPhase;
+
+gint64          gtk_startup_begin               (GtkStartupPhase  phase);
+void            gtk_startup_end                 (GtkStartupPhase  phase,
+                                                 gint64           start);
+void            gtk_startup_finish              (void);
+
+G_END_DECLS
+
+#endif /* __GTK_STARTUP_PRIVATE_H__ */
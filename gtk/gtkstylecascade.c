@@ -223,6 +223,25 @@ gtk_style_cascade_lookup (GtkStyleProvider    *provider,
   gtk_style_cascade_iter_clear (&iter);
 }
 
+static GtkCssChange
+gtk_style_cascade_get_change_any (GtkStyleProvider *provider)
+{
+  GtkStyleCascade *cascade = GTK_STYLE_CASCADE (provider);
+  GtkStyleCascadeIter iter;
+  GtkStyleProvider *item;
+  GtkCssChange change = 0;
+
+  for (item = gtk_style_cascade_iter_init (cascade, &iter);
+       item;
+       item = gtk_style_cascade_iter_next (cascade, &iter))
+    {
+      change |= gtk_style_provider_get_change_any (item);
+    }
+  gtk_style_cascade_iter_clear (&iter);
+
+  return change;
+}
+
 static void
 gtk_style_cascade_provider_iface_init (GtkStyleProviderInterface *iface)
 {
@@ -231,6 +250,7 @@ gtk_style_cascade_provider_iface_init (GtkStyleProviderInterface *iface)
   iface->get_scale = gtk_style_cascade_get_scale;
   iface->get_keyframes = gtk_style_cascade_get_keyframes;
   iface->lookup = gtk_style_cascade_lookup;
+  iface->get_change_any = gtk_style_cascade_get_change_any;
 }
 
 G_DEFINE_TYPE_EXTENDED (GtkStyleCascade, _gtk_style_cascade, G_TYPE_OBJECT, 0,
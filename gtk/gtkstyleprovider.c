@@ -115,12 +115,100 @@ gtk_style_provider_lookup (GtkStyleProvider    *provider,
   iface->lookup (provider, matcher, lookup, out_change);
 }
 
+/* Returns all changes that styles looked up from @provider can
+ * depend on, so callers can skip invalidations that can't matter. */
+GtkCssChange
+gtk_style_provider_get_change_any (GtkStyleProvider *provider)
+{
+  GtkStyleProviderInterface *iface;
+
+  gtk_internal_return_val_if_fail (GTK_IS_STYLE_PROVIDER (provider), 0);
+
+  iface = GTK_STYLE_PROVIDER_GET_INTERFACE (provider);
+
+  if (!iface->lookup)
+    return 0;
+
+  if (!iface->get_change_any)
+    return ~(GtkCssChange) 0;
+
+  return iface->get_change_any (provider);
+}
+
+static GtkStyleProviderAffectsFunc current_affects;
+static gpointer current_affects_data;
+
 void
 gtk_style_provider_changed (GtkStyleProvider *provider)
 {
+  GtkStyleProviderAffectsFunc old_affects;
+  gpointer old_affects_data;
+
+  gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
+
+  /* A full change affects all nodes, even if it is emitted
+   * while a partial change is being handled */
+  old_affects = current_affects;
+  old_affects_data = current_affects_data;
+  current_affects = NULL;
+  current_affects_data = NULL;
+
+  g_signal_emit (provider, signals[CHANGED], 0);
+
+  current_affects = old_affects;
+  current_affects_data = old_affects_data;
+}
+
+/*
+ * gtk_style_provider_changed_partially:
+ * @provider: the provider that changed
+ * @affects: function to check if the change affects a node
+ * @user_data: data for @affects
+ *
+ * Like gtk_style_provider_changed(), but only the style of nodes
+ * that @affects returns %TRUE for needs to be recomputed.
+ * Handlers of the changed signal can query this with
+ * gtk_style_provider_change_affects().
+ */
+void
+gtk_style_provider_changed_partially (GtkStyleProvider            *provider,
+                                      GtkStyleProviderAffectsFunc  affects,
+                                      gpointer                     user_data)
+{
+  GtkStyleProviderAffectsFunc old_affects;
+  gpointer old_affects_data;
+
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
+  gtk_internal_return_if_fail (affects != NULL);
+
+  old_affects = current_affects;
+  old_affects_data = current_affects_data;
+  current_affects = affects;
+  current_affects_data = user_data;
 
   g_signal_emit (provider, signals[CHANGED], 0);
+
+  current_affects = old_affects;
+  current_affects_data = old_affects_data;
+}
+
+/*
+ * gtk_style_provider_change_affects:
+ * @matcher: matcher for the node to check
+ *
+ * Checks if the style of the node described by @matcher needs
+ * to be recomputed because of the provider change that is
+ * currently being emitted.
+ *
+ * Returns: %TRUE if the node needs a new style
+ */
+gboolean
+gtk_style_provider_change_affects (const GtkCssMatcher *matcher)
+{
+  if (current_affects == NULL)
+    return TRUE;
+
+  return current_affects (matcher, current_affects_data);
 }
 
 GtkSettings *
@@ -45,6 +45,7 @@ struct _GtkStyleProviderInterface
                                                  const GtkCssMatcher     *matcher,
                                                  GtkCssLookup            *lookup,
                                                  GtkCssChange            *out_change);
+  GtkCssChange          (* get_change_any)      (GtkStyleProvider *provider);
   void                  (* emit_error)          (GtkStyleProvider *provider,
                                                  GtkCssSection           *section,
                                                  const GError            *error);
@@ -62,8 +63,16 @@ void                    gtk_style_provider_lookup                (GtkStyleProvid
                                                                   const GtkCssMatcher     *matcher,
                                                                   GtkCssLookup            *lookup,
                                                                   GtkCssChange            *out_change);
+GtkCssChange            gtk_style_provider_get_change_any        (GtkStyleProvider *provider);
+
+typedef gboolean (* GtkStyleProviderAffectsFunc) (const GtkCssMatcher *matcher,
+                                                   gpointer             user_data);
 
 void                    gtk_style_provider_changed               (GtkStyleProvider *provider);
+void                    gtk_style_provider_changed_partially     (GtkStyleProvider *provider,
+                                                                  GtkStyleProviderAffectsFunc affects,
+                                                                  gpointer                 user_data);
+gboolean                gtk_style_provider_change_affects        (const GtkCssMatcher     *matcher);
 
 void                    gtk_style_provider_emit_error            (GtkStyleProvider *provider,
                                                                   GtkCssSection           *section,
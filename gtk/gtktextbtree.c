@@ -185,7 +185,7 @@ struct _GtkTextBTree {
   GtkTextMark *selection_bound_mark;
   GtkTextBuffer *buffer;
   BTreeView *views;
-  GSList *tag_infos;
+  GHashTable *tag_infos;                /* GtkTextTag => GtkTextTagInfo */
   gulong tag_changed_handler;
 
   /* Incremented when a segment with a byte size > 0
@@ -340,6 +340,7 @@ static GtkTextTagInfo *gtk_text_btree_get_existing_tag_info (GtkTextBTree   *tre
                                                              GtkTextTag     *tag);
 static void            gtk_text_btree_remove_tag_info       (GtkTextBTree   *tree,
                                                              GtkTextTag     *tag);
+static void            tag_info_free                        (gpointer        data);
 
 static void redisplay_region (GtkTextBTree      *tree,
                               const GtkTextIter *start,
@@ -438,6 +439,7 @@ _gtk_text_btree_new (GtkTextTagTable *table,
 						tree);
 
   tree->mark_table = g_hash_table_new (g_str_hash, g_str_equal);
+  tree->tag_infos = g_hash_table_new_full (NULL, NULL, NULL, tag_info_free);
   tree->child_anchor_table = NULL;
   
   /* We don't ref the buffer, since the buffer owns us;
@@ -512,6 +514,8 @@ _gtk_text_btree_unref (GtkTextBTree *tree)
       
       gtk_text_btree_node_destroy (tree, tree->root_node);
       tree->root_node = NULL;
+
+      g_clear_pointer (&tree->tag_infos, g_hash_table_unref);
       
       g_assert (g_hash_table_size (tree->mark_table) == 0);
       g_hash_table_destroy (tree->mark_table);
@@ -1119,6 +1123,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   int char_count_delta;                /* change to number of chars */
   GtkTextBTree *tree;
   gint start_byte_index;
+  gint end_byte_index;
   GtkTextLine *start_line;
 
   g_return_if_fail (text != NULL);
@@ -1133,6 +1138,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   
   start_line = line;
   start_byte_index = gtk_text_iter_get_line_index (iter);
+  end_byte_index = start_byte_index;
 
   /* Get our insertion segment split. Note this assumes line allows
    * char insertions, which isn't true of the "last" line. But iter
@@ -1177,7 +1183,8 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       
       chunk_len = eol - sol;
 
-      g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+      /* The text was validated by gtk_text_buffer_emit_insert(), so
+       * don't validate it again for every line. */
       seg = _gtk_char_segment_new (&text[sol], chunk_len);
 
       char_count_delta += seg->char_count;
@@ -1197,6 +1204,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
         {
           /* chunk didn't end with a paragraph separator */
           g_assert (eol == len);
+          end_byte_index += chunk_len;
           break;
         }
 
@@ -1214,6 +1222,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       line = newline;
       cur_seg = NULL;
       line_count_delta++;
+      end_byte_index = 0;
     }
 
   /*
@@ -1240,12 +1249,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
                                       &start,
                                       start_line,
                                       start_byte_index);
-    end = start;
-
-    /* We could almost certainly be more efficient here
-       by saving the information from the insertion loop
-       above. FIXME */
-    gtk_text_iter_forward_chars (&end, char_count_delta);
+    _gtk_text_btree_get_iter_at_line (tree,
+                                      &end,
+                                      line,
+                                      end_byte_index);
 
     DV (g_print ("invalidating due to inserting some text (%s)\n", G_STRLOC));
     _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
@@ -6008,21 +6015,7 @@ static GtkTextTagInfo*
 gtk_text_btree_get_existing_tag_info (GtkTextBTree *tree,
                                       GtkTextTag   *tag)
 {
-  GtkTextTagInfo *info;
-  GSList *list;
-
-
-  list = tree->tag_infos;
-  while (list != NULL)
-    {
-      info = list->data;
-      if (info->tag == tag)
-        return info;
-
-      list = list->next;
-    }
-
-  return NULL;
+  return g_hash_table_lookup (tree->tag_infos, tag);
 }
 
 static GtkTextTagInfo*
@@ -6044,47 +6037,27 @@ gtk_text_btree_get_tag_info (GtkTextBTree *tree,
       info->tag_root = NULL;
       info->toggle_count = 0;
 
-      tree->tag_infos = g_slist_prepend (tree->tag_infos, info);
+      g_hash_table_insert (tree->tag_infos, tag, info);
     }
 
   return info;
 }
 
 static void
-gtk_text_btree_remove_tag_info (GtkTextBTree *tree,
-                                GtkTextTag   *tag)
+tag_info_free (gpointer data)
 {
-  GtkTextTagInfo *info;
-  GSList *list;
-  GSList *prev;
+  GtkTextTagInfo *info = data;
 
-  prev = NULL;
-  list = tree->tag_infos;
-  while (list != NULL)
-    {
-      info = list->data;
-      if (info->tag == tag)
-        {
-          if (prev != NULL)
-            {
-              prev->next = list->next;
-            }
-          else
-            {
-              tree->tag_infos = list->next;
-            }
-          list->next = NULL;
-          g_slist_free (list);
-
-          g_object_unref (info->tag);
+  g_object_unref (info->tag);
 
-          g_slice_free (GtkTextTagInfo, info);
-          return;
-        }
+  g_slice_free (GtkTextTagInfo, info);
+}
 
-      prev = list;
-      list = list->next;
-    }
+static void
+gtk_text_btree_remove_tag_info (GtkTextBTree *tree,
+                                GtkTextTag   *tag)
+{
+  g_hash_table_remove (tree->tag_infos, tag);
 }
 
 static void
@@ -7125,23 +7098,17 @@ _gtk_text_btree_spew (GtkTextBTree *tree)
   printf ("=================== Tag information\n");
 
   {
-    GSList * list;
+    GHashTableIter iter;
+    GtkTextTagInfo *info;
 
-    list = tree->tag_infos;
-
-    while (list != NULL)
+    g_hash_table_iter_init (&iter, tree->tag_infos);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info))
       {
-        GtkTextTagInfo *info;
-
-        info = list->data;
-
         printf ("  tag '%s': root at %p, toggle count %d\n",
                 info->tag->priv->name, info->tag_root, info->toggle_count);
-
-        list = list->next;
       }
 
-    if (tree->tag_infos == NULL)
+    if (g_hash_table_size (tree->tag_infos) == 0)
       {
         printf ("  (no tags in the tree)\n");
       }
@@ -103,6 +103,7 @@ struct _GtkTextRenderer
 
   GtkWidget *widget;
   cairo_t *cr;
+  GdkRGBA color;        /* text color of the widget */
 
   GdkRGBA *error_color;	/* Error underline color for this widget */
   GList *widgets;      	/* widgets encountered when drawing */
@@ -481,26 +482,19 @@ text_renderer_set_state (GtkTextRenderer *text_renderer,
 
 static void
 text_renderer_begin (GtkTextRenderer *text_renderer,
-                     GtkWidget       *widget,
-                     cairo_t         *cr)
+                     GtkWidget       *widget)
 {
   GtkStyleContext *context;
-  GdkRGBA color;
   GtkCssNode *text_node;
 
   text_renderer->widget = widget;
-  text_renderer->cr = cr;
 
   context = gtk_widget_get_style_context (widget);
 
   text_node = gtk_text_view_get_text_node ((GtkTextView *)widget);
   gtk_style_context_save_to_node (context, text_node);
 
-  gtk_style_context_get_color (context, &color);
-
-  cairo_save (cr);
-
-  gdk_cairo_set_source_rgba (cr, &color);
+  gtk_style_context_get_color (context, &text_renderer->color);
 }
 
 /* Returns a GSList of (referenced) widgets encountered while drawing.
@@ -510,14 +504,11 @@ text_renderer_end (GtkTextRenderer *text_renderer)
 {
   GtkStyleContext *context;
 
-  cairo_restore (text_renderer->cr);
-
   context = gtk_widget_get_style_context (text_renderer->widget);
 
   gtk_style_context_restore (context);
 
   text_renderer->widget = NULL;
-  text_renderer->cr = NULL;
 
   if (text_renderer->error_color)
     {
@@ -798,6 +789,53 @@ render_para (GtkTextRenderer    *text_renderer,
   pango_layout_iter_free (iter);
 }
 
+/* Renders the paragraph into a new cairo node with the given bounds,
+ * in the coordinates of the line */
+static GskRenderNode *
+render_para_node (GtkTextRenderer       *text_renderer,
+                  GtkTextLineDisplay    *line_display,
+                  const graphene_rect_t *bounds,
+                  int                    selection_start_index,
+                  int                    selection_end_index)
+{
+  GskRenderNode *node;
+  cairo_t *cr;
+
+  node = gsk_cairo_node_new (bounds);
+  cr = gsk_cairo_node_get_draw_context (node);
+
+  text_renderer->cr = cr;
+  gdk_cairo_set_source_rgba (cr, &text_renderer->color);
+
+  render_para (text_renderer, line_display,
+               selection_start_index, selection_end_index);
+
+  text_renderer->cr = NULL;
+  cairo_destroy (cr);
+
+  return node;
+}
+
+/* The area a paragraph draws to, in the coordinates of the line */
+static void
+get_para_bounds (GtkTextLineDisplay *line_display,
+                 graphene_rect_t    *bounds)
+{
+  PangoRectangle ink, logical;
+  int x1, y1, x2, y2;
+
+  pango_layout_get_pixel_extents (line_display->layout, &ink, &logical);
+  gdk_rectangle_union ((GdkRectangle *) &ink, (GdkRectangle *) &logical, (GdkRectangle *) &ink);
+
+  x1 = MIN (line_display->left_margin, line_display->x_offset + ink.x);
+  y1 = MIN (0, line_display->top_margin + ink.y);
+  x2 = MAX (line_display->left_margin + MAX (line_display->total_width, 0),
+            line_display->x_offset + ink.x + ink.width);
+  y2 = MAX (line_display->height, line_display->top_margin + ink.y + ink.height);
+
+  graphene_rect_init (bounds, x1, y1, x2 - x1, y2 - y1);
+}
+
 static GtkTextRenderer *
 get_text_renderer (void)
 {
@@ -809,6 +847,16 @@ get_text_renderer (void)
   return text_renderer;
 }
 
+/* Lines without selection or block cursor are rendered into a node
+ * that is kept in the cached line display, and appended again by
+ * reference until the line changes. Insertion cursors are drawn on
+ * top in a separate node, so they can blink without rendering the
+ * line again. Lines that are much wider than the visible area are not
+ * kept, the node would be too big; they are only rendered where
+ * visible.
+ */
+#define MAX_CACHED_WIDTH_FACTOR 2
+
 void
 gtk_text_layout_snapshot (GtkTextLayout      *layout,
                           GtkWidget          *widget,
@@ -822,7 +870,6 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
   gboolean have_selection;
   GSList *line_list;
   GSList *tmp_list;
-  cairo_t *cr;
 
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
   g_return_if_fail (layout->default_style != NULL);
@@ -836,13 +883,8 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
   if (line_list == NULL)
     return; /* nothing on the screen */
 
-  cr = gtk_snapshot_append_cairo (snapshot,
-                                  &GRAPHENE_RECT_INIT(clip->x, clip->y, clip->width, clip->height));
   text_renderer = get_text_renderer ();
-  text_renderer_begin (text_renderer, widget, cr);
-
-  /* text_renderer_begin/end does cairo_save/restore */
-  cairo_translate (cr, 0, offset_y);
+  text_renderer_begin (text_renderer, widget);
 
   gtk_text_layout_wrap_loop_start (layout);
 
@@ -863,6 +905,9 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
 
       if (line_display->height > 0)
         {
+          graphene_rect_t bounds;
+          gboolean cacheable;
+
           g_assert (line_display->layout != NULL);
           
           if (have_selection)
@@ -893,16 +938,56 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
                 }
             }
 
-          render_para (text_renderer, line_display,
-                       selection_start_index, selection_end_index);
+          get_para_bounds (line_display, &bounds);
+
+          cacheable = selection_start_index == -1 &&
+                      selection_end_index == -1 &&
+                      !line_display->has_block_cursor &&
+                      bounds.size.width <= MAX_CACHED_WIDTH_FACTOR * clip->width;
+
+          if (line_display->node != NULL &&
+              (!cacheable || !gdk_rgba_equal (&line_display->node_color, &text_renderer->color)))
+            g_clear_pointer (&line_display->node, gsk_render_node_unref);
+
+          gtk_snapshot_save (snapshot);
+          gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (0, offset_y));
+
+          if (cacheable)
+            {
+              if (line_display->node == NULL)
+                {
+                  line_display->node = render_para_node (text_renderer, line_display, &bounds, -1, -1);
+                  line_display->node_color = text_renderer->color;
+                }
+
+              gtk_snapshot_append_node (snapshot, line_display->node);
+            }
+          else
+            {
+              GskRenderNode *node;
+
+              graphene_rect_intersection (&bounds,
+                                          &GRAPHENE_RECT_INIT (clip->x, bounds.origin.y,
+                                                               clip->width, bounds.size.height),
+                                          &bounds);
+              node = render_para_node (text_renderer, line_display, &bounds,
+                                       selection_start_index, selection_end_index);
+              gtk_snapshot_append_node (snapshot, node);
+              gsk_render_node_unref (node);
+            }
 
           /* We paint the cursors last, because they overlap another chunk
            * and need to appear on top.
            */
           if (line_display->cursors != NULL)
             {
+              cairo_t *cr;
               int i;
 
+              cr = gtk_snapshot_append_cairo (snapshot,
+                                              &GRAPHENE_RECT_INIT (clip->x, 0,
+                                                                   clip->width, line_display->height));
+
               for (i = 0; i < line_display->cursors->len; i++)
                 {
                   int index;
@@ -914,10 +999,14 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
                                                line_display->x_offset, line_display->top_margin,
                                                line_display->layout, index, dir);
                 }
+
+              cairo_destroy (cr);
             }
+
+          gtk_snapshot_restore (snapshot);
         } /* line_display->height > 0 */
 
-      cairo_translate (cr, 0, line_display->height);
+      offset_y += line_display->height;
       gtk_text_layout_free_line_display (layout, line_display);
       
       tmp_list = tmp_list->next;
@@ -927,6 +1016,4 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
   text_renderer_end (text_renderer);
 
   g_slist_free (line_list);
-
-  cairo_destroy (cr);
 }
@@ -4839,6 +4839,92 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* Number of lines to get the text of at once when searching for
+ * a string that can't span multiple lines.
+ */
+#define SEARCH_CHUNK_LINES 256
+
+/* Searches for a needle that can't span lines in the text of many
+ * lines at once. This avoids getting the text of every line
+ * separately, which is what makes searching large buffers slow.
+ */
+static gboolean
+forward_search_in_chunks (const GtkTextIter *iter,
+                          const gchar       *needle,
+                          gboolean           visible_only,
+                          gboolean           slice,
+                          gboolean           case_insensitive,
+                          GtkTextIter       *match_start,
+                          GtkTextIter       *match_end,
+                          const GtkTextIter *limit)
+{
+  GtkTextIter search, chunk_end, start, end;
+  gchar *text;
+  const gchar *found;
+
+  search = *iter;
+
+  while (!gtk_text_iter_is_end (&search))
+    {
+      if (limit &&
+          gtk_text_iter_compare (&search, limit) >= 0)
+        return FALSE;
+
+      chunk_end = search;
+      gtk_text_iter_forward_lines (&chunk_end, SEARCH_CHUNK_LINES);
+      if (limit &&
+          gtk_text_iter_compare (&chunk_end, limit) > 0)
+        chunk_end = *limit;
+
+      if (slice)
+        {
+          if (visible_only)
+            text = gtk_text_iter_get_visible_slice (&search, &chunk_end);
+          else
+            text = gtk_text_iter_get_slice (&search, &chunk_end);
+        }
+      else
+        {
+          if (visible_only)
+            text = gtk_text_iter_get_visible_text (&search, &chunk_end);
+          else
+            text = gtk_text_iter_get_text (&search, &chunk_end);
+        }
+
+      if (!case_insensitive)
+        found = strstr (text, needle);
+      else
+        found = utf8_strcasestr (text, needle);
+
+      if (found)
+        {
+          start = search;
+          forward_chars_with_skipping (&start, g_utf8_strlen (text, found - text),
+                                       visible_only, !slice, FALSE);
+          end = start;
+          forward_chars_with_skipping (&end, g_utf8_strlen (needle, -1),
+                                       visible_only, !slice, case_insensitive);
+          g_free (text);
+
+          if (limit &&
+              gtk_text_iter_compare (&end, limit) > 0)
+            return FALSE;
+
+          if (match_start)
+            *match_start = start;
+          if (match_end)
+            *match_end = end;
+
+          return TRUE;
+        }
+
+      g_free (text);
+      search = chunk_end;
+    }
+
+  return FALSE;
+}
+
 /**
  * gtk_text_iter_forward_search:
  * @iter: start of search
@@ -4912,6 +4998,21 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
 
   lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
 
+  /* Lines can also end in \r or a paragraph separator, so only use
+   * the fast path if the string can't span lines in any way.
+   */
+  if (lines[1] == NULL &&
+      strchr (lines[0], '\r') == NULL &&
+      g_utf8_strchr (lines[0], -1, PARAGRAPH_SEPARATOR) == NULL)
+    {
+      retval = forward_search_in_chunks (iter, lines[0],
+                                         visible_only, slice, case_insensitive,
+                                         match_start, match_end, limit);
+      g_strfreev ((gchar**)lines);
+
+      return retval;
+    }
+
   search = *iter;
 
   do
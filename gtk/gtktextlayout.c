@@ -97,8 +97,18 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* The line displays of recently used lines, most recently used
+   * first, and a table from their line to their link in the queue.
+   * Drawing gets the displays of all visible lines every frame, so
+   * this keeps enough of them to not recreate them when scrolling.
+   */
+  GQueue display_lru;
+  GHashTable *display_cache;
 };
 
+#define DISPLAY_CACHE_SIZE 250
+
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
                                                    GtkTextLine *line,
                                                    /* may be NULL */
@@ -155,6 +165,8 @@ static gint line_display_iter_to_index (GtkTextLayout      *layout,
                                         GtkTextLineDisplay *display,
                                         const GtkTextIter  *iter);
 
+static void gtk_text_line_display_free (GtkTextLineDisplay *display);
+
 enum {
   INVALIDATED,
   CHANGED,
@@ -175,6 +187,28 @@ PangoAttrType gtk_text_attr_appearance_type = 0;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkTextLayout, gtk_text_layout, G_TYPE_OBJECT)
 
+static void
+display_cache_remove (GtkTextLayout *layout,
+                      GList         *link)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display = link->data;
+
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_queue_delete_link (&priv->display_lru, link);
+
+  gtk_text_line_display_free (display);
+}
+
+static void
+display_cache_clear (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_lru.head)
+    display_cache_remove (layout, priv->display_lru.head);
+}
+
 static void
 gtk_text_layout_dispose (GObject *object)
 {
@@ -193,12 +227,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  display_cache_clear (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -213,10 +242,13 @@ static void
 gtk_text_layout_finalize (GObject *object)
 {
   GtkTextLayout *layout;
+  GtkTextLayoutPrivate *priv;
 
   layout = GTK_TEXT_LAYOUT (object);
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
 
   g_free (layout->preedit_string);
+  g_hash_table_unref (priv->display_cache);
 
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
 }
@@ -276,7 +308,12 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  g_queue_init (&priv->display_lru);
+  priv->display_cache = g_hash_table_new (NULL, NULL);
 }
 
 GtkTextLayout*
@@ -310,6 +347,7 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  display_cache_clear (layout);
 
   if (layout->buffer)
     {
@@ -635,18 +673,22 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_lru.head; l; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLineDisplay *display = l->data;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
-						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+						    display->line, layout);
 
-      if (cache_y + cache_height > y && cache_y < y + old_height)
-	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+      next = l->next;
+
+      if (cache_y + display->height > y && cache_y < y + old_height)
+	gtk_text_layout_invalidate_cache (layout, display->line, cursors_only);
     }
 
   gtk_text_layout_emit_changed (layout, y, old_height, new_height);
@@ -820,9 +862,13 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      GtkTextLineDisplay *display = link->data;
 
       if (cursors_only)
 	{
@@ -834,8 +880,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	}
       else
 	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
+	  display_cache_remove (layout, link);
 	}
     }
 }
@@ -928,32 +973,30 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLine *line;
+  GtkTextLine *last_line;
+
+  /* Invalidate the cursors of the cached line displays
+   * of the lines in the range.
    */
-  if (layout->one_display_cache)
+  if (gtk_text_iter_compare (start, end) > 0)
     {
-      GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
+      const GtkTextIter *tmp = start;
+      start = end;
+      end = tmp;
+    }
 
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+  last_line = _gtk_text_iter_get_text_line (end);
+  line = _gtk_text_iter_get_text_line (start);
 
-      line_end = line_start;
-      if (!gtk_text_iter_ends_line (&line_end))
-	gtk_text_iter_forward_to_line_end (&line_end);
+  while (TRUE)
+    {
+      gtk_text_layout_invalidate_cache (layout, line, TRUE);
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
+      if (line == last_line)
+        break;
 
-      if (gtk_text_iter_compare (&line_start, end) <= 0 &&
-	  gtk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
+      line = _gtk_text_line_next_excluding_last (line);
     }
 
   gtk_text_layout_invalidated (layout);
@@ -1167,8 +1210,10 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            /* may be NULL */
                            GtkTextLineData *line_data)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
   PangoRectangle ink_rect, logical_rect;
+  gboolean was_cached;
 
   g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), NULL);
   g_return_val_if_fail (line != NULL, NULL);
@@ -1179,6 +1224,7 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
       _gtk_text_line_add_data (line, line_data);
     }
 
+  was_cached = g_hash_table_contains (priv->display_cache, line);
   display = gtk_text_layout_get_line_display (layout, line, TRUE);
   line_data->width = display->width;
   line_data->height = display->height;
@@ -1186,8 +1232,14 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
   pango_layout_get_pixel_extents (display->layout, &ink_rect, &logical_rect);
   line_data->top_ink = MAX (0, logical_rect.x - ink_rect.x);
   line_data->bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
+
   gtk_text_layout_free_line_display (layout, display);
 
+  /* Validating lots of lines would otherwise push the displays of
+   * the visible lines out of the cache. */
+  if (!was_cached)
+    gtk_text_layout_invalidate_cache (layout, line, FALSE);
+
   return line_data;
 }
 
@@ -2250,6 +2302,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
+  GList *link;
   GtkTextLineSegment *seg;
   GtkTextIter iter;
   GtkTextAttributes *style;
@@ -2271,24 +2324,27 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      display = link->data;
+
+      if (size_only || !display->size_only)
 	{
+          g_queue_unlink (&priv->display_lru, link);
+          g_queue_push_head_link (&priv->display_lru, link);
+
 	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
+            update_text_display_cursors (layout, line, display);
+	  return display;
 	}
       else
         {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
+          display_cache_remove (layout, link);
         }
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2610,7 +2666,10 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  g_queue_push_head (&priv->display_lru, display);
+  g_hash_table_insert (priv->display_cache, line, priv->display_lru.head);
+  if (priv->display_lru.length > DISPLAY_CACHE_SIZE)
+    display_cache_remove (layout, priv->display_lru.tail);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2618,23 +2677,34 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   return display;
 }
 
+static void
+gtk_text_line_display_free (GtkTextLineDisplay *display)
+{
+  if (display->layout)
+    g_object_unref (display->layout);
+
+  if (display->cursors)
+    g_array_free (display->cursors, TRUE);
+
+  if (display->pg_bg_rgba)
+    gdk_rgba_free (display->pg_bg_rgba);
+
+  g_clear_pointer (&display->node, gsk_render_node_unref);
+
+  g_slice_free (GtkTextLineDisplay, display);
+}
+
 void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
-    {
-      if (display->layout)
-        g_object_unref (display->layout);
-
-      if (display->cursors)
-        g_array_free (display->cursors, TRUE);
-
-      if (display->pg_bg_rgba)
-        gdk_rgba_free (display->pg_bg_rgba);
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
 
-      g_slice_free (GtkTextLineDisplay, display);
-    }
+  /* Displays in the cache are freed when they leave it */
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  if (link == NULL || link->data != display)
+    gtk_text_line_display_free (display);
 }
 
 /* Functions to convert iter <=> index for the line of a GtkTextLineDisplay
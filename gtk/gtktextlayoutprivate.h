@@ -138,11 +138,6 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
-   */
-  GtkTextLineDisplay *one_display_cache;
-
   /* Whether we are allowed to wrap right now */
   gint wrap_loop_count;
   
@@ -247,6 +242,11 @@ struct _GtkTextLineDisplay
   guint size_only : 1;
 
   GdkRGBA *pg_bg_rgba;
+
+  /* Rendered paragraph without selection and cursors, drawn with
+   * node_color as the text color, or NULL. See gtktextdisplay.c */
+  GskRenderNode *node;
+  GdkRGBA node_color;
 };
 
 #ifdef GTK_COMPILATION
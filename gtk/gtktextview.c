@@ -145,6 +145,8 @@
 #define SCREEN_HEIGHT(widget) text_window_get_height (GTK_TEXT_VIEW (widget)->priv->text_window)
 
 #define SPACE_FOR_CURSOR 1
+/* How long an idle may validate lines before giving back control */
+#define VALIDATE_STEP_TIME (G_USEC_PER_SEC / 200)
 #define CURSOR_ASPECT_RATIO (0.04)
 
 typedef struct _GtkTextWindow GtkTextWindow;
@@ -4290,10 +4292,18 @@ incremental_validate_callback (gpointer data)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
+  gint64 end_time;
 
   DV(g_print(G_STRLOC"\n"));
-  
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+
+  /* Validate in chunks until the time is used up, so large buffers
+   * get their final size quickly without blocking the main loop.
+   */
+  end_time = g_get_monotonic_time () + VALIDATE_STEP_TIME;
+  do
+    gtk_text_layout_validate (text_view->priv->layout, 2000);
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < end_time);
 
   gtk_text_view_update_adjustments (text_view);
   
@@ -34,6 +34,20 @@ _gtk_tree_data_list_alloc (void)
   return list;
 }
 
+static void
+gtk_tree_data_list_clear (GtkTreeDataList *list,
+                          GType            type)
+{
+  if (g_type_is_a (type, G_TYPE_STRING))
+    g_free ((gchar *) list->data.v_pointer);
+  else if (g_type_is_a (type, G_TYPE_OBJECT) && list->data.v_pointer != NULL)
+    g_object_unref (list->data.v_pointer);
+  else if (g_type_is_a (type, G_TYPE_BOXED) && list->data.v_pointer != NULL)
+    g_boxed_free (type, (gpointer) list->data.v_pointer);
+  else if (g_type_is_a (type, G_TYPE_VARIANT) && list->data.v_pointer != NULL)
+    g_variant_unref ((gpointer) list->data.v_pointer);
+}
+
 void
 _gtk_tree_data_list_free (GtkTreeDataList *list,
 			  GType           *column_headers)
@@ -46,14 +60,7 @@ _gtk_tree_data_list_free (GtkTreeDataList *list,
   while (tmp)
     {
       next = tmp->next;
-      if (g_type_is_a (column_headers [i], G_TYPE_STRING))
-	g_free ((gchar *) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_OBJECT) && tmp->data.v_pointer != NULL)
-	g_object_unref (tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_BOXED) && tmp->data.v_pointer != NULL)
-	g_boxed_free (column_headers [i], (gpointer) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_VARIANT) && tmp->data.v_pointer != NULL)
-	g_variant_unref ((gpointer) tmp->data.v_pointer);
+      gtk_tree_data_list_clear (tmp, column_headers[i]);
 
       g_slice_free (GtkTreeDataList, tmp);
       i++;
@@ -61,6 +68,43 @@ _gtk_tree_data_list_free (GtkTreeDataList *list,
     }
 }
 
+/* Rows are allocated as one block with a node for every column.
+ * The nodes are still linked through next, so code walking the
+ * list works unchanged, but columns can also be indexed directly
+ * and a row costs one allocation instead of one per cell. Rows
+ * must be freed with _gtk_tree_data_list_row_free().
+ */
+GtkTreeDataList *
+_gtk_tree_data_list_row_new (gint n_columns)
+{
+  GtkTreeDataList *row;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  row = g_new0 (GtkTreeDataList, n_columns);
+  for (i = 0; i < n_columns - 1; i++)
+    row[i].next = &row[i + 1];
+
+  return row;
+}
+
+void
+_gtk_tree_data_list_row_free (GtkTreeDataList *row,
+                              gint             n_columns,
+                              GType           *column_headers)
+{
+  gint i;
+
+  if (row == NULL)
+    return;
+
+  for (i = 0; i < n_columns; i++)
+    gtk_tree_data_list_clear (&row[i], column_headers[i]);
+
+  g_free (row);
+}
+
 gboolean
 _gtk_tree_data_list_check_type (GType type)
 {
@@ -258,17 +302,11 @@ _gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
     }
 }
 
-GtkTreeDataList *
-_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
-                               GType            type)
+static void
+gtk_tree_data_list_copy_data (GtkTreeDataList *list,
+                              GType            type,
+                              GtkTreeDataList *new_list)
 {
-  GtkTreeDataList *new_list;
-
-  g_return_val_if_fail (list != NULL, NULL);
-  
-  new_list = _gtk_tree_data_list_alloc ();
-  new_list->next = NULL;
-
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
@@ -312,10 +350,42 @@ _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
       g_warning ("Unsupported node type (%s) copied.", g_type_name (type));
       break;
     }
+}
+
+GtkTreeDataList *
+_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
+                               GType            type)
+{
+  GtkTreeDataList *new_list;
+
+  g_return_val_if_fail (list != NULL, NULL);
+  
+  new_list = _gtk_tree_data_list_alloc ();
+  new_list->next = NULL;
+
+  gtk_tree_data_list_copy_data (list, type, new_list);
 
   return new_list;
 }
 
+GtkTreeDataList *
+_gtk_tree_data_list_row_copy (GtkTreeDataList *row,
+                              gint             n_columns,
+                              GType           *column_headers)
+{
+  GtkTreeDataList *new_row;
+  gint i;
+
+  if (row == NULL)
+    return NULL;
+
+  new_row = _gtk_tree_data_list_row_new (n_columns);
+  for (i = 0; i < n_columns; i++)
+    gtk_tree_data_list_copy_data (&row[i], column_headers[i], &new_row[i]);
+
+  return new_row;
+}
+
 gint
 _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 				  GtkTreeIter  *a,
@@ -62,6 +62,14 @@ void             _gtk_tree_data_list_value_to_node  (GtkTreeDataList *list,
 GtkTreeDataList *_gtk_tree_data_list_node_copy      (GtkTreeDataList *list,
                                                      GType            type);
 
+GtkTreeDataList *_gtk_tree_data_list_row_new        (gint             n_columns);
+void             _gtk_tree_data_list_row_free       (GtkTreeDataList *row,
+                                                     gint             n_columns,
+                                                     GType           *column_headers);
+GtkTreeDataList *_gtk_tree_data_list_row_copy       (GtkTreeDataList *row,
+                                                     gint             n_columns,
+                                                     GType           *column_headers);
+
 /* Header code */
 gint                   _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 							 GtkTreeIter  *a,
@@ -49,6 +49,7 @@ typedef struct _TreeAugment TreeAugment;
 struct _TreeNode
 {
   GListModel *model;
+  GListModel *collapsed_model; /* created when checking expandability, used when expanding */
   GtkTreeListRow *row;
   GtkRbTree *children;
   union {
@@ -439,6 +440,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
 }
 
 static void gtk_tree_list_row_destroy (GtkTreeListRow *row);
+static void gtk_tree_list_row_notify_expanded (GtkTreeListRow *row);
 
 static void
 gtk_tree_list_model_clear_node (gpointer data)
@@ -457,6 +459,8 @@ gtk_tree_list_model_clear_node (gpointer data)
     }
   if (node->children)
     gtk_rb_tree_unref (node->children);
+
+  g_clear_object (&node->collapsed_model);
 }
 
 static void
@@ -506,10 +510,9 @@ gtk_tree_list_model_init_node (GtkTreeListModel *list,
                                     NULL);
 
   n = g_list_model_get_n_items (model);
-  node = NULL;
-  for (i = 0; i < n; i++)
+  node = gtk_rb_tree_build (self->children, n);
+  for (i = 0; i < n; i++, node = gtk_rb_tree_node_get_next (node))
     {
-      node = gtk_rb_tree_insert_after (self->children, node);
       node->parent = self;
       if (list->autoexpand)
         gtk_tree_list_model_expand_node (list, node);
@@ -528,7 +531,13 @@ gtk_tree_list_model_expand_node (GtkTreeListModel *self,
   if (node->model != NULL)
     return 0;
 
-  model = tree_node_create_model (self, node);
+  if (node->collapsed_model)
+    {
+      model = node->collapsed_model;
+      node->collapsed_model = NULL;
+    }
+  else
+    model = tree_node_create_model (self, node);
 
   if (model == NULL)
     return 0;
@@ -569,6 +578,33 @@ gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
   return n_items;
 }
 
+/* Expands all rows below node without emitting any signals. Rows that
+ * were expanded are added to expanded_rows, so they can be notified
+ * once the model is consistent again. */
+static void
+gtk_tree_list_model_expand_all_below (GtkTreeListModel *self,
+                                      TreeNode         *node,
+                                      GPtrArray        *expanded_rows)
+{
+  TreeNode *child;
+
+  for (child = gtk_rb_tree_get_first (node->children);
+       child != NULL;
+       child = gtk_rb_tree_node_get_next (child))
+    {
+      if (child->children == NULL)
+        {
+          gtk_tree_list_model_expand_node (self, child);
+          if (child->children == NULL)
+            continue;
+
+          if (child->row)
+            g_ptr_array_add (expanded_rows, g_object_ref (child->row));
+        }
+
+      gtk_tree_list_model_expand_all_below (self, child, expanded_rows);
+    }
+}
 
 static GType
 gtk_tree_list_model_get_item_type (GListModel *list)
@@ -930,6 +966,79 @@ gtk_tree_list_model_get_child_row (GtkTreeListModel *self,
   return tree_node_get_row (child);
 }
 
+/**
+ * gtk_tree_list_model_expand_all:
+ * @self: a #GtkTreeListModel
+ *
+ * Recursively expands all rows of @self.
+ *
+ * Unlike calling gtk_tree_list_row_set_expanded() on every row, this
+ * emits a single #GListModel::items-changed signal for the whole
+ * change, so it is the preferred way to expand large trees.
+ **/
+void
+gtk_tree_list_model_expand_all (GtkTreeListModel *self)
+{
+  GPtrArray *expanded_rows;
+  guint n_before, n_after;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  expanded_rows = g_ptr_array_new_with_free_func (g_object_unref);
+  n_before = tree_node_get_n_children (&self->root_node);
+
+  gtk_tree_list_model_expand_all_below (self, &self->root_node, expanded_rows);
+
+  n_after = tree_node_get_n_children (&self->root_node);
+  if (n_before != n_after)
+    g_list_model_items_changed (G_LIST_MODEL (self), 0, n_before, n_after);
+
+  g_ptr_array_foreach (expanded_rows, (GFunc) gtk_tree_list_row_notify_expanded, NULL);
+  g_ptr_array_unref (expanded_rows);
+}
+
+/**
+ * gtk_tree_list_model_collapse_all:
+ * @self: a #GtkTreeListModel
+ *
+ * Collapses all rows of @self, so that only the items of the root
+ * model remain.
+ *
+ * Like gtk_tree_list_model_expand_all(), this emits a single
+ * #GListModel::items-changed signal for the whole change.
+ **/
+void
+gtk_tree_list_model_collapse_all (GtkTreeListModel *self)
+{
+  GPtrArray *collapsed_rows;
+  TreeNode *child;
+  guint n_before, n_after;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  collapsed_rows = g_ptr_array_new_with_free_func (g_object_unref);
+  n_before = tree_node_get_n_children (&self->root_node);
+
+  for (child = gtk_rb_tree_get_first (self->root_node.children);
+       child != NULL;
+       child = gtk_rb_tree_node_get_next (child))
+    {
+      if (child->children == NULL)
+        continue;
+
+      gtk_tree_list_model_collapse_node (self, child);
+      if (child->row)
+        g_ptr_array_add (collapsed_rows, g_object_ref (child->row));
+    }
+
+  n_after = tree_node_get_n_children (&self->root_node);
+  if (n_before != n_after)
+    g_list_model_items_changed (G_LIST_MODEL (self), 0, n_before, n_after);
+
+  g_ptr_array_foreach (collapsed_rows, (GFunc) gtk_tree_list_row_notify_expanded, NULL);
+  g_ptr_array_unref (collapsed_rows);
+}
+
 /***   ROW   ***/
 
 enum {
@@ -961,6 +1070,13 @@ gtk_tree_list_row_destroy (GtkTreeListRow *self)
   g_object_thaw_notify (G_OBJECT (self));
 }
 
+static void
+gtk_tree_list_row_notify_expanded (GtkTreeListRow *self)
+{
+  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
+  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
+}
+
 static void
 gtk_tree_list_row_set_property (GObject      *object,
                                 guint         prop_id,
@@ -1204,8 +1320,7 @@ gtk_tree_list_row_set_expanded (GtkTreeListRow *self,
         g_list_model_items_changed (G_LIST_MODEL (list), tree_node_get_position (self->node) + 1, n_items, 0);
     }
 
-  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
-  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
+  gtk_tree_list_row_notify_expanded (self);
 }
 
 /**
@@ -1256,11 +1371,16 @@ gtk_tree_list_row_is_expandable (GtkTreeListRow *self)
   if (self->node->model)
     return TRUE;
 
+  if (self->node->collapsed_model)
+    return TRUE;
+
+  /* Keep the model around, so expanding the row doesn't need to
+   * create it a second time */
   list = tree_node_get_tree_list_model (self->node);
   model = tree_node_create_model (list, self->node);
   if (model)
     {
-      g_object_unref (model);
+      self->node->collapsed_model = model;
       return TRUE;
     }
 
@@ -731,6 +731,34 @@ lookup_elt_with_offset (GtkTreeModelSort *tree_model_sort,
 }
 
 
+/* Most changes don't touch the sort column, so check whether the row
+ * still sorts strictly between its neighbours before searching for
+ * its new position. With equal neighbours that search decides where
+ * the row goes, so those are left to it.
+ */
+static gboolean
+gtk_tree_model_sort_elt_is_in_place (SortElt  *elt,
+                                     SortData *sort_data)
+{
+  GSequenceIter *siter;
+
+  if (!g_sequence_iter_is_begin (elt->siter))
+    {
+      siter = g_sequence_iter_prev (elt->siter);
+      if (gtk_tree_model_sort_compare_func (g_sequence_get (siter), elt, sort_data) >= 0)
+        return FALSE;
+    }
+
+  siter = g_sequence_iter_next (elt->siter);
+  if (!g_sequence_iter_is_end (siter))
+    {
+      if (gtk_tree_model_sort_compare_func (elt, g_sequence_get (siter), sort_data) >= 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
 				 GtkTreePath  *start_s_path,
@@ -799,9 +827,10 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
   old_index = g_sequence_iter_get_position (elt->siter);
 
   fill_sort_data (&sort_data, tree_model_sort, level);
-  g_sequence_sort_changed (elt->siter,
-                           gtk_tree_model_sort_compare_func,
-                           &sort_data);
+  if (!gtk_tree_model_sort_elt_is_in_place (elt, &sort_data))
+    g_sequence_sort_changed (elt->siter,
+                             gtk_tree_model_sort_compare_func,
+                             &sort_data);
   free_sort_data (&sort_data);
 
   index = g_sequence_iter_get_position (elt->siter);
@@ -816,13 +845,14 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
   if (old_index != index)
     {
       gint *new_order;
-      gint j;
+      gint j, length;
 
       GtkTreePath *tmppath;
 
-      new_order = g_new (gint, g_sequence_get_length (level->seq));
+      length = g_sequence_get_length (level->seq);
+      new_order = g_new (gint, length);
 
-      for (j = 0; j < g_sequence_get_length (level->seq); j++)
+      for (j = 0; j < length; j++)
         {
 	  if (index > old_index)
 	    {
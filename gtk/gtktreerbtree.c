@@ -757,31 +757,128 @@ gtk_tree_rbtree_mark_invalid (GtkTreeRBTree *tree)
   while ((node = gtk_tree_rbtree_next (tree, node)) != NULL);
 }
 
+/* Updates the subtree below @node bottom-up, so every node is only
+ * visited once instead of walking up to the root for every row. */
+static void
+gtk_tree_rbtree_set_fixed_height_helper (GtkTreeRBTree *tree,
+                                         GtkTreeRBNode *node,
+                                         gint           height,
+                                         gboolean       mark_valid)
+{
+  gint node_height;
+
+  if (gtk_tree_rbtree_is_nil (node))
+    return;
+
+  if (GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID))
+    {
+      node_height = height;
+      if (mark_valid)
+        {
+          GTK_TREE_RBNODE_UNSET_FLAG (node, GTK_TREE_RBNODE_INVALID);
+          GTK_TREE_RBNODE_UNSET_FLAG (node, GTK_TREE_RBNODE_COLUMN_INVALID);
+        }
+    }
+  else
+    node_height = GTK_TREE_RBNODE_GET_HEIGHT (node);
+
+  gtk_tree_rbtree_set_fixed_height_helper (tree, node->left, height, mark_valid);
+  gtk_tree_rbtree_set_fixed_height_helper (tree, node->right, height, mark_valid);
+  if (node->children)
+    gtk_tree_rbtree_set_fixed_height_helper (node->children, node->children->root, height, mark_valid);
+
+  node->offset = node_height + node->left->offset + node->right->offset +
+                 (node->children ? node->children->root->offset : 0);
+  fixup_validation (tree, node);
+}
+
 void
 gtk_tree_rbtree_set_fixed_height (GtkTreeRBTree *tree,
                                   gint           height,
                                   gboolean       mark_valid)
+{
+  gint old_offset;
+
+  if (tree == NULL || gtk_tree_rbtree_is_nil (tree->root))
+    return;
+
+  old_offset = tree->root->offset;
+
+  gtk_tree_rbtree_set_fixed_height_helper (tree, tree->root, height, mark_valid);
+
+  gtk_rbnode_adjust (tree->parent_tree, tree->parent_node,
+                     0, 0, tree->root->offset - old_offset);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TREE))
+    gtk_tree_rbtree_test (G_STRLOC, tree);
+#endif
+}
+
+static GtkTreeRBNode *
+gtk_tree_rbtree_fill_helper (GtkTreeRBTree *tree,
+                             GtkTreeRBNode *parent,
+                             guint          n_nodes,
+                             guint          depth,
+                             guint          red_depth,
+                             gint           height,
+                             gboolean       valid)
 {
   GtkTreeRBNode *node;
+  guint n_left;
 
-  if (tree == NULL)
+  if (n_nodes == 0)
+    return (GtkTreeRBNode *) &nil;
+
+  node = gtk_tree_rbnode_new (tree, height);
+  node->parent = parent;
+
+  n_left = (n_nodes - 1) / 2;
+  node->left = gtk_tree_rbtree_fill_helper (tree, node, n_left,
+                                            depth + 1, red_depth, height, valid);
+  node->right = gtk_tree_rbtree_fill_helper (tree, node, n_nodes - 1 - n_left,
+                                             depth + 1, red_depth, height, valid);
+
+  if (depth == 0 || depth != red_depth)
+    GTK_TREE_RBNODE_SET_COLOR (node, GTK_TREE_RBNODE_BLACK);
+  if (!valid)
+    GTK_TREE_RBNODE_SET_FLAG (node, GTK_TREE_RBNODE_INVALID | GTK_TREE_RBNODE_DESCENDANTS_INVALID);
+
+  node->count = n_nodes;
+  node->total_count = n_nodes;
+  node->offset = height + node->left->offset + node->right->offset;
+
+  return node;
+}
+
+/* Fills the empty @tree with @n_nodes nodes of @height. The nodes
+ * are split evenly between the subtrees, so all levels but the last
+ * are full and coloring only the last one red keeps the black
+ * heights equal. That takes linear time, unlike inserting the nodes
+ * one by one.
+ */
+void
+gtk_tree_rbtree_fill (GtkTreeRBTree *tree,
+                      guint          n_nodes,
+                      gint           height,
+                      gboolean       valid)
+{
+  g_return_if_fail (gtk_tree_rbtree_is_nil (tree->root));
+
+  if (n_nodes == 0)
     return;
 
-  node = gtk_tree_rbtree_first (tree);
+  tree->root = gtk_tree_rbtree_fill_helper (tree, (GtkTreeRBNode *) &nil, n_nodes,
+                                            0, g_bit_storage (n_nodes) - 1,
+                                            height, valid);
 
-  do
-    {
-      if (GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID))
-        {
-          gtk_tree_rbtree_node_set_height (tree, node, height);
-          if (mark_valid)
-            gtk_tree_rbtree_node_mark_valid (tree, node);
-        }
+  gtk_rbnode_adjust (tree->parent_tree, tree->parent_node,
+                     0, n_nodes, tree->root->offset);
 
-      if (node->children)
-        gtk_tree_rbtree_set_fixed_height (node->children, height, mark_valid);
-    }
-  while ((node = gtk_tree_rbtree_next (tree, node)) != NULL);
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TREE))
+    gtk_tree_rbtree_test (G_STRLOC, tree);
+#endif
 }
 
 static void
@@ -132,6 +132,10 @@ void            gtk_tree_rbtree_mark_invalid            (GtkTreeRBTree
 void            gtk_tree_rbtree_set_fixed_height        (GtkTreeRBTree                 *tree,
                                                          gint                           height,
                                                          gboolean                       mark_valid);
+void            gtk_tree_rbtree_fill                    (GtkTreeRBTree                 *tree,
+                                                         guint                          n_nodes,
+                                                         gint                           height,
+                                                         gboolean                       valid);
 gint            gtk_tree_rbtree_node_find_offset        (GtkTreeRBTree                 *tree,
                                                          GtkTreeRBNode                 *node);
 guint           gtk_tree_rbtree_node_get_index          (GtkTreeRBTree                 *tree,
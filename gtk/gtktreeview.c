@@ -8219,12 +8219,12 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   if (indices[depth - 1] == 0)
     {
       tmpnode = gtk_tree_rbtree_find_count (tree, 1);
-      tmpnode = gtk_tree_rbtree_insert_before (tree, tmpnode, height, FALSE);
+      tmpnode = gtk_tree_rbtree_insert_before (tree, tmpnode, height, height > 0);
     }
   else
     {
       tmpnode = gtk_tree_rbtree_find_count (tree, indices[depth - 1]);
-      tmpnode = gtk_tree_rbtree_insert_after (tree, tmpnode, height, FALSE);
+      tmpnode = gtk_tree_rbtree_insert_after (tree, tmpnode, height, height > 0);
     }
 
   _gtk_tree_view_accessible_add (tree_view, tree, tmpnode);
@@ -8638,19 +8638,34 @@ gtk_tree_view_build_tree (GtkTreeView   *tree_view,
   GtkTreeRBNode *temp = NULL;
   GtkTreePath *path = NULL;
 
-  do
+  /* Rows of lists have no children or other state, so the tree
+   * can be built in one go once we know how many there are */
+  if (tree_view->priv->is_list && gtk_tree_rbtree_is_nil (tree->root))
     {
-      gtk_tree_model_ref_node (tree_view->priv->model, iter);
-      temp = gtk_tree_rbtree_insert_after (tree, temp, 0, FALSE);
+      guint n_rows = 0;
 
-      if (tree_view->priv->fixed_height > 0)
+      do
         {
-          if (GTK_TREE_RBNODE_FLAG_SET (temp, GTK_TREE_RBNODE_INVALID))
-	    {
-              gtk_tree_rbtree_node_set_height (tree, temp, tree_view->priv->fixed_height);
-	      gtk_tree_rbtree_node_mark_valid (tree, temp);
-	    }
+          gtk_tree_model_ref_node (tree_view->priv->model, iter);
+          n_rows++;
         }
+      while (gtk_tree_model_iter_next (tree_view->priv->model, iter));
+
+      if (tree_view->priv->fixed_height > 0)
+        gtk_tree_rbtree_fill (tree, n_rows, tree_view->priv->fixed_height, TRUE);
+      else
+        gtk_tree_rbtree_fill (tree, n_rows, 0, FALSE);
+
+      return;
+    }
+
+  do
+    {
+      gtk_tree_model_ref_node (tree_view->priv->model, iter);
+      if (tree_view->priv->fixed_height > 0)
+        temp = gtk_tree_rbtree_insert_after (tree, temp, tree_view->priv->fixed_height, TRUE);
+      else
+        temp = gtk_tree_rbtree_insert_after (tree, temp, 0, FALSE);
 
       if (tree_view->priv->is_list)
         continue;
@@ -33,6 +33,7 @@
 #include "gtkbindings.h"
 #include "gtkbuildable.h"
 #include "gtkbuilderprivate.h"
+#include "gtkbuilderprecompileprivate.h"
 #include "gtkcontainerprivate.h"
 #include "gtkcssboxesprivate.h"
 #include "gtkcssfiltervalueprivate.h"
@@ -61,6 +62,7 @@
 #include "gtksettingsprivate.h"
 #include "gtksizegroup-private.h"
 #include "gtksnapshotprivate.h"
+#include "gtkstartupprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktooltipprivate.h"
 #include "gsktransformprivate.h"
@@ -75,6 +77,7 @@
 #include "inspector/window.h"
 
 #include "gdk/gdkeventsprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gsk/gskdebugprivate.h"
 #include "gsk/gskrendererprivate.h"
 
@@ -489,6 +492,7 @@ typedef struct {
   GtkBuilderConnectFunc connect_func;
   gpointer              connect_data;
   GDestroyNotify        destroy_notify;
+  gboolean              precompiled;
 } GtkWidgetTemplate;
 
 struct _GtkWidgetClassPrivate
@@ -731,6 +735,11 @@ static GQuark           quark_action_muxer = 0;
 static GQuark           quark_font_options = 0;
 static GQuark           quark_font_map = 0;
 
+/* Statistics for the inspector, see gtk_widget_get_statistics() */
+static guint            n_frames_rendered = 0;
+static guint            n_layouts_created = 0;
+static GHashTable      *creations = NULL;
+
 /* --- functions --- */
 GType
 gtk_widget_get_type (void)
@@ -2745,6 +2754,14 @@ gtk_widget_init (GTypeInstance *instance, gpointer g_class)
 
   widget->priv = priv;
 
+  if (G_UNLIKELY (creations != NULL))
+    {
+      gpointer type = GSIZE_TO_POINTER (G_TYPE_FROM_CLASS (g_class));
+
+      g_hash_table_insert (creations, type,
+                           GUINT_TO_POINTER (GPOINTER_TO_UINT (g_hash_table_lookup (creations, type)) + 1));
+    }
+
   priv->visible = gtk_widget_class_get_visible_by_default (g_class);
   priv->child_visible = TRUE;
   priv->name = NULL;
@@ -2968,6 +2985,7 @@ gtk_widget_unparent (GtkWidget *widget)
    * in the next parent.
    */
   priv->child_visible = TRUE;
+  gtk_css_node_set_deferred (priv->cssnode, FALSE);
 
   old_parent = priv->parent;
   if (old_parent)
@@ -4017,6 +4035,18 @@ gtk_widget_queue_draw (GtkWidget *widget)
 
 static void
 gtk_widget_set_alloc_needed (GtkWidget *widget);
+
+/* The layout of the children of @widget can change without them
+ * requesting a different size, so the last layout can't be kept */
+static inline void
+gtk_widget_invalidate_layout (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (priv->layout_manager != NULL)
+    gtk_layout_manager_invalidate_allocation (priv->layout_manager);
+}
+
 /**
  * gtk_widget_queue_allocate:
  * @widget: a #GtkWidget
@@ -4038,6 +4068,7 @@ gtk_widget_queue_allocate (GtkWidget *widget)
   if (_gtk_widget_get_realized (widget))
     gtk_widget_queue_draw (widget);
 
+  gtk_widget_invalidate_layout (widget);
   gtk_widget_set_alloc_needed (widget);
 }
 
@@ -4108,6 +4139,7 @@ gtk_widget_queue_resize (GtkWidget *widget)
   if (_gtk_widget_get_realized (widget))
     gtk_widget_queue_draw (widget);
 
+  gtk_widget_invalidate_layout (widget);
   gtk_widget_queue_resize_internal (widget);
 }
 
@@ -4123,6 +4155,7 @@ gtk_widget_queue_resize_no_redraw (GtkWidget *widget)
 {
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  gtk_widget_invalidate_layout (widget);
   gtk_widget_queue_resize_internal (widget);
 }
 
@@ -4291,6 +4324,7 @@ gtk_widget_allocate (GtkWidget    *widget,
   GskTransform *css_transform;
 #ifdef G_ENABLE_DEBUG
   GdkDisplay *display;
+  gint64 before = gdk_profiler_is_running () ? g_get_monotonic_time () : 0;
 #endif
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
@@ -4507,6 +4541,12 @@ out:
     gtk_widget_ensure_allocate (widget);
 
   gtk_widget_pop_verify_invariants (widget);
+
+#ifdef G_ENABLE_DEBUG
+  if (before != 0)
+    gdk_profiler_add_mark (before * 1000, (g_get_monotonic_time () - before) * 1000,
+                           "allocate", G_OBJECT_TYPE_NAME (widget));
+#endif
 }
 
 /**
@@ -7174,6 +7214,7 @@ gtk_widget_create_pango_layout (GtkWidget   *widget,
 
   context = gtk_widget_get_pango_context (widget);
   layout = pango_layout_new (context);
+  n_layouts_created++;
 
   if (text)
     pango_layout_set_text (layout, text, -1);
@@ -7221,6 +7262,10 @@ gtk_widget_set_child_visible (GtkWidget *widget,
   g_object_ref (widget);
   gtk_widget_verify_invariants (widget);
 
+  /* Widgets that are not child-visible are not drawn, so their styles
+   * are only updated when needed, e.g. to measure them */
+  gtk_css_node_set_deferred (priv->cssnode, !child_visible);
+
   if (child_visible)
     priv->child_visible = TRUE;
   else
@@ -11762,6 +11807,9 @@ gtk_widget_ensure_resize (GtkWidget *widget)
 
   priv->resize_needed = FALSE;
   _gtk_size_request_cache_clear (&priv->requests);
+
+  if (priv->layout_manager != NULL)
+    gtk_layout_manager_requests_changed (priv->layout_manager);
 }
 
 void
@@ -12375,6 +12423,30 @@ gtk_widget_init_template (GtkWidget *widget)
       return;
     }
 
+  /* Precompile the template once the first instance was built, so
+   * later ones don't parse the XML again, while errors still point
+   * into the XML.
+   */
+  if (!template->precompiled)
+    {
+      gsize size;
+      const gchar *data = g_bytes_get_data (template->data, &size);
+      GBytes *precompiled;
+
+      if (size < GTK_BUILDER_PRECOMPILED_MAGIC_LEN ||
+          memcmp (data, GTK_BUILDER_PRECOMPILED_MAGIC, GTK_BUILDER_PRECOMPILED_MAGIC_LEN) != 0)
+        {
+          precompiled = _gtk_builder_precompile (data, size, NULL);
+          if (precompiled)
+            {
+              g_bytes_unref (template->data);
+              template->data = precompiled;
+            }
+        }
+
+      template->precompiled = TRUE;
+    }
+
   /* Build the automatic child data
    */
   for (l = template->children; l; l = l->next)
@@ -12944,10 +13016,7 @@ gtk_widget_create_render_node (GtkWidget   *widget,
     gtk_snapshot_push_opacity (snapshot, opacity);
 
   if (!GTK_IS_WINDOW (widget))
-    {
-      gtk_css_style_snapshot_background (&boxes, snapshot);
-      gtk_css_style_snapshot_border (&boxes, snapshot);
-    }
+    gtk_css_style_snapshot_box (&boxes, snapshot);
 
   if (priv->overflow == GTK_OVERFLOW_HIDDEN)
     gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
@@ -12991,6 +13060,9 @@ gtk_widget_snapshot (GtkWidget   *widget,
   if (priv->draw_needed)
     {
       GskRenderNode *render_node;
+#ifdef G_ENABLE_DEBUG
+      gint64 before = gdk_profiler_is_running () ? g_get_monotonic_time () : 0;
+#endif
 
       gtk_widget_push_paintables (widget);
 
@@ -13004,6 +13076,12 @@ gtk_widget_snapshot (GtkWidget   *widget,
 
       gtk_widget_pop_paintables (widget);
       gtk_widget_update_paintables (widget);
+
+#ifdef G_ENABLE_DEBUG
+      if (before != 0)
+        gdk_profiler_add_mark (before * 1000, (g_get_monotonic_time () - before) * 1000,
+                               "snapshot", G_OBJECT_TYPE_NAME (widget));
+#endif
     }
 
   if (priv->render_node)
@@ -13018,6 +13096,7 @@ gtk_widget_render (GtkWidget            *widget,
   GtkSnapshot *snapshot;
   GskRenderer *renderer;
   GskRenderNode *root;
+  gint64 start;
   int x, y;
 
   if (!GTK_IS_ROOT (widget))
@@ -13031,6 +13110,8 @@ gtk_widget_render (GtkWidget            *widget,
   if (renderer == NULL)
     return;
 
+  start = gtk_startup_begin (GTK_STARTUP_FIRST_FRAME);
+
   snapshot = gtk_snapshot_new ();
   gtk_root_get_surface_transform (GTK_ROOT (widget), &x, &y);
   gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
@@ -13048,9 +13129,76 @@ gtk_widget_render (GtkWidget            *widget,
       gsk_renderer_render (renderer, root, region);
 
       gsk_render_node_unref (root);
+      n_frames_rendered++;
+
+      gtk_startup_end (GTK_STARTUP_FIRST_FRAME, start);
+      gtk_startup_finish ();
     }
 }
 
+/*
+ * gtk_widget_get_statistics:
+ * @n_frames: (out): return location for the number of frames that
+ *   have been rendered
+ * @n_layouts: (out): return location for the number of layouts that
+ *   have been created with gtk_widget_create_pango_layout()
+ *
+ * Queries counters that are used by the inspector to show how much
+ * work frames cause. The inspector divides the differences between two
+ * queries by the number of frames in between.
+ */
+void
+gtk_widget_get_statistics (guint *n_frames,
+                           guint *n_layouts)
+{
+  *n_frames = n_frames_rendered;
+  *n_layouts = n_layouts_created;
+}
+
+/*
+ * gtk_widget_set_count_creations:
+ * @count: whether to count widget creations
+ *
+ * Makes widgets count how many instances of each type are created,
+ * see gtk_widget_steal_creations(). Off by default, and costs a hash
+ * table lookup per created widget when on.
+ */
+void
+gtk_widget_set_count_creations (gboolean count)
+{
+  if (count == (creations != NULL))
+    return;
+
+  if (count)
+    creations = g_hash_table_new (NULL, NULL);
+  else
+    g_clear_pointer (&creations, g_hash_table_unref);
+}
+
+/*
+ * gtk_widget_steal_creations:
+ *
+ * Returns the number of widgets of each type created since counting
+ * was turned on or since the last call, and starts counting again.
+ *
+ * Returns: (transfer full) (nullable): a hash table mapping #GType to
+ *   the number of created widgets, or %NULL if widget creations are
+ *   not being counted
+ */
+GHashTable *
+gtk_widget_steal_creations (void)
+{
+  GHashTable *result;
+
+  if (creations == NULL)
+    return NULL;
+
+  result = creations;
+  creations = g_hash_table_new (NULL, NULL);
+
+  return result;
+}
+
 static void
 gtk_widget_child_observer_destroyed (gpointer widget)
 {
@@ -13347,13 +13495,33 @@ gtk_widget_snapshot_child (GtkWidget   *widget,
                            GtkSnapshot *snapshot)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (child);
+  graphene_rect_t clip;
 
   g_return_if_fail (_gtk_widget_get_parent (child) == widget);
   g_return_if_fail (snapshot != NULL);
 
+  /* Containers snapshot all their children, often most of them hidden */
+  if (!_gtk_widget_is_drawable (child))
+    return;
+
+  /* A child that only moved still has its render node, and reusing it
+   * at the new position only needs a new transform. Its own children
+   * are not looked at again. */
   gtk_snapshot_save (snapshot);
   gtk_snapshot_transform (snapshot, priv->transform);
 
+  /* Children scrolled out of view have nothing to add. Widgets can
+   * draw outside their allocation, so only the bounds of a render
+   * node that is still current are known. Children that need to be
+   * drawn again keep draw_needed until they are snapshot. */
+  if (priv->render_node != NULL && !priv->draw_needed &&
+      gtk_snapshot_get_clip (snapshot, &clip) &&
+      !graphene_rect_intersection (&clip, &priv->render_node->bounds, NULL))
+    {
+      gtk_snapshot_restore (snapshot);
+      return;
+    }
+
   gtk_widget_snapshot (child, snapshot);
 
   gtk_snapshot_restore (snapshot);
@@ -53,6 +53,57 @@ get_axis_info (const graphene_rect_t *bounds,
     g_assert(FALSE);
 }
 
+/* A widget in the focus order with its bounds. Sorting used to compute
+ * the bounds of both widgets in every comparison, which made moving the
+ * focus in containers with many children expensive. */
+typedef struct
+{
+  GtkWidget *widget;
+  graphene_rect_t bounds;
+  gboolean has_bounds;
+} FocusChild;
+
+/* Computes the bounds of the widgets in @focus_order relative to
+ * @target, or to their parent if @target is %NULL */
+static FocusChild *
+focus_children_new (GPtrArray *focus_order,
+                    GtkWidget *target)
+{
+  FocusChild *children;
+  guint i;
+
+  children = g_new (FocusChild, focus_order->len);
+
+  for (i = 0; i < focus_order->len; i++)
+    {
+      GtkWidget *child = g_ptr_array_index (focus_order, i);
+
+      children[i].widget = child;
+      children[i].has_bounds = gtk_widget_compute_bounds (child,
+                                                          target ? target : gtk_widget_get_parent (child),
+                                                          &children[i].bounds);
+      if (!children[i].has_bounds)
+        graphene_rect_init (&children[i].bounds, 0, 0, 0, 0);
+    }
+
+  return children;
+}
+
+/* Sorts @children and stores the new order in @focus_order */
+static void
+focus_children_sort (FocusChild       *children,
+                     GPtrArray        *focus_order,
+                     GCompareDataFunc  compare_func,
+                     gpointer          user_data)
+{
+  guint i;
+
+  g_qsort_with_data (children, focus_order->len, sizeof (FocusChild), compare_func, user_data);
+
+  for (i = 0; i < focus_order->len; i++)
+    focus_order->pdata[i] = children[i].widget;
+}
+
 /* Utility function, equivalent to g_list_reverse */
 static void
 reverse_ptr_array (GPtrArray *arr)
@@ -74,23 +125,21 @@ tab_sort_func (gconstpointer a,
                gconstpointer b,
                gpointer      user_data)
 {
-  graphene_rect_t child_bounds1, child_bounds2;
-  GtkWidget *child1 = *((GtkWidget **)a);
-  GtkWidget *child2 = *((GtkWidget **)b);
+  const FocusChild *child1 = a;
+  const FocusChild *child2 = b;
   GtkTextDirection text_direction = GPOINTER_TO_INT (user_data);
   float y1, y2;
 
-  if (!gtk_widget_compute_bounds (child1, gtk_widget_get_parent (child1), &child_bounds1) ||
-      !gtk_widget_compute_bounds (child2, gtk_widget_get_parent (child2), &child_bounds2))
+  if (!child1->has_bounds || !child2->has_bounds)
     return 0;
 
-  y1 = child_bounds1.origin.y + (child_bounds1.size.height / 2.0f);
-  y2 = child_bounds2.origin.y + (child_bounds2.size.height / 2.0f);
+  y1 = child1->bounds.origin.y + (child1->bounds.size.height / 2.0f);
+  y2 = child2->bounds.origin.y + (child2->bounds.size.height / 2.0f);
 
   if (y1 == y2)
     {
-      const float x1 = child_bounds1.origin.x + (child_bounds1.size.width / 2.0f);
-      const float x2 = child_bounds2.origin.x + (child_bounds2.size.width / 2.0f);
+      const float x1 = child1->bounds.origin.x + (child1->bounds.size.width / 2.0f);
+      const float x2 = child2->bounds.origin.x + (child2->bounds.size.width / 2.0f);
 
       if (text_direction == GTK_TEXT_DIR_RTL)
         return (x1 < x2) ? 1 : ((x1 == x2) ? 0 : -1);
@@ -107,8 +156,11 @@ focus_sort_tab (GtkWidget        *widget,
                 GPtrArray        *focus_order)
 {
   GtkTextDirection text_direction = _gtk_widget_get_direction (widget);
+  FocusChild *children;
 
-  g_ptr_array_sort_with_data (focus_order, tab_sort_func, GINT_TO_POINTER (text_direction));
+  children = focus_children_new (focus_order, NULL);
+  focus_children_sort (children, focus_order, tab_sort_func, GINT_TO_POINTER (text_direction));
+  g_free (children);
 
   if (direction == GTK_DIR_TAB_BACKWARD)
     reverse_ptr_array (focus_order);
@@ -169,18 +221,17 @@ axis_compare (gconstpointer a,
               gconstpointer b,
               gpointer      user_data)
 {
-  graphene_rect_t bounds1;
-  graphene_rect_t bounds2;
+  const FocusChild *child1 = a;
+  const FocusChild *child2 = b;
   CompareInfo *compare = user_data;
   int start1, end1;
   int start2, end2;
 
-  if (!gtk_widget_compute_bounds (*((GtkWidget **)a), compare->widget, &bounds1) ||
-      !gtk_widget_compute_bounds (*((GtkWidget **)b), compare->widget, &bounds2))
+  if (!child1->has_bounds || !child2->has_bounds)
     return 0;
 
-  get_axis_info (&bounds1, compare->axis, &start1, &end1);
-  get_axis_info (&bounds2, compare->axis, &start2, &end2);
+  get_axis_info (&child1->bounds, compare->axis, &start1, &end1);
+  get_axis_info (&child2->bounds, compare->axis, &start2, &end2);
 
   start1 = start1 + (end1 / 2);
   start2 = start2 + (end2 / 2);
@@ -188,8 +239,8 @@ axis_compare (gconstpointer a,
   if (start1 == start2)
     {
       /* Now use origin/bounds to compare the 2 widgets on the other axis */
-      get_axis_info (&bounds1, 1 - compare->axis, &start1, &end1);
-      get_axis_info (&bounds2, 1 - compare->axis, &start2, &end2);
+      get_axis_info (&child1->bounds, 1 - compare->axis, &start1, &end1);
+      get_axis_info (&child2->bounds, 1 - compare->axis, &start2, &end2);
 
       int x1 = abs (start1 + (end1 / 2) - compare->x);
       int x2 = abs (start2 + (end2 / 2) - compare->x);
@@ -211,6 +262,7 @@ focus_sort_left_right (GtkWidget        *widget,
   CompareInfo compare_info;
   GtkWidget *old_focus = gtk_widget_get_focus_child (widget);
   graphene_rect_t old_bounds;
+  FocusChild *children;
 
   compare_info.widget = widget;
   compare_info.reverse = (direction == GTK_DIR_LEFT);
@@ -218,12 +270,14 @@ focus_sort_left_right (GtkWidget        *widget,
   if (!old_focus)
     old_focus = find_old_focus (widget, focus_order);
 
+  children = focus_children_new (focus_order, widget);
+
   if (old_focus && gtk_widget_compute_bounds (old_focus, widget, &old_bounds))
     {
       float compare_y1;
       float compare_y2;
       float compare_x;
-      int i;
+      guint i, n;
 
       /* Delete widgets from list that don't match minimum criteria */
 
@@ -235,35 +289,27 @@ focus_sort_left_right (GtkWidget        *widget,
       else
         compare_x = old_bounds.origin.x + old_bounds.size.width;
 
-      for (i = 0; i < focus_order->len; i ++)
+      for (i = 0, n = 0; i < focus_order->len; i++)
         {
-          GtkWidget *child = g_ptr_array_index (focus_order, i);
+          FocusChild *child = &children[i];
 
-          if (child != old_focus)
+          if (child->widget != old_focus)
             {
-              graphene_rect_t child_bounds;
-
-              if (gtk_widget_compute_bounds (child, widget, &child_bounds))
-                {
-                  const float child_y1 = child_bounds.origin.y;
-                  const float child_y2 = child_bounds.origin.y + child_bounds.size.height;
-
-                  if ((child_y2 <= compare_y1 || child_y1 >= compare_y2) /* No vertical overlap */ ||
-                      (direction == GTK_DIR_RIGHT && child_bounds.origin.x + child_bounds.size.width < compare_x) || /* Not to left */
-                      (direction == GTK_DIR_LEFT && child_bounds.origin.x > compare_x)) /* Not to right */
-                    {
-                      g_ptr_array_remove_index (focus_order, i);
-                      i --;
-                    }
-                }
-              else
-                {
-                  g_ptr_array_remove_index (focus_order, i);
-                  i --;
-                }
+              const float child_y1 = child->bounds.origin.y;
+              const float child_y2 = child->bounds.origin.y + child->bounds.size.height;
+
+              if (!child->has_bounds ||
+                  (child_y2 <= compare_y1 || child_y1 >= compare_y2) /* No vertical overlap */ ||
+                  (direction == GTK_DIR_RIGHT && child->bounds.origin.x + child->bounds.size.width < compare_x) || /* Not to left */
+                  (direction == GTK_DIR_LEFT && child->bounds.origin.x > compare_x)) /* Not to right */
+                continue;
             }
+
+          children[n++] = *child;
         }
 
+      g_ptr_array_set_size (focus_order, n);
+
       compare_info.y = (compare_y1 + compare_y2) / 2;
       compare_info.x = old_bounds.origin.x + (old_bounds.size.width / 2.0f);
     }
@@ -299,7 +345,8 @@ focus_sort_left_right (GtkWidget        *widget,
 
 
   compare_info.axis = HORIZONTAL;
-  g_ptr_array_sort_with_data (focus_order, axis_compare, &compare_info);
+  focus_children_sort (children, focus_order, axis_compare, &compare_info);
+  g_free (children);
 
   if (compare_info.reverse)
     reverse_ptr_array (focus_order);
@@ -313,6 +360,7 @@ focus_sort_up_down (GtkWidget        *widget,
   CompareInfo compare_info;
   GtkWidget *old_focus = gtk_widget_get_focus_child (widget);
   graphene_rect_t old_bounds;
+  FocusChild *children;
 
   compare_info.widget = widget;
   compare_info.reverse = (direction == GTK_DIR_UP);
@@ -320,12 +368,14 @@ focus_sort_up_down (GtkWidget        *widget,
   if (!old_focus)
     old_focus = find_old_focus (widget, focus_order);
 
+  children = focus_children_new (focus_order, widget);
+
   if (old_focus && gtk_widget_compute_bounds (old_focus, widget, &old_bounds))
     {
       float compare_x1;
       float compare_x2;
       float compare_y;
-      int i;
+      guint i, n;
 
       /* Delete widgets from list that don't match minimum criteria */
 
@@ -337,35 +387,27 @@ focus_sort_up_down (GtkWidget        *widget,
       else
         compare_y = old_bounds.origin.y + old_bounds.size.height;
 
-      for (i = 0; i < focus_order->len; i ++)
+      for (i = 0, n = 0; i < focus_order->len; i++)
         {
-          GtkWidget *child = g_ptr_array_index (focus_order, i);
+          FocusChild *child = &children[i];
 
-          if (child != old_focus)
+          if (child->widget != old_focus)
             {
-              graphene_rect_t child_bounds;
-
-              if (gtk_widget_compute_bounds (child, widget, &child_bounds))
-                {
-                  const float child_x1 = child_bounds.origin.x;
-                  const float child_x2 = child_bounds.origin.x + child_bounds.size.width;
-
-                  if ((child_x2 <= compare_x1 || child_x1 >= compare_x2) /* No horizontal overlap */ ||
-                      (direction == GTK_DIR_DOWN && child_bounds.origin.y + child_bounds.size.height < compare_y) || /* Not below */
-                      (direction == GTK_DIR_UP && child_bounds.origin.y > compare_y)) /* Not above */
-                    {
-                      g_ptr_array_remove_index (focus_order, i);
-                      i --;
-                    }
-                }
-              else
-                {
-                  g_ptr_array_remove_index (focus_order, i);
-                  i --;
-                }
+              const float child_x1 = child->bounds.origin.x;
+              const float child_x2 = child->bounds.origin.x + child->bounds.size.width;
+
+              if (!child->has_bounds ||
+                  (child_x2 <= compare_x1 || child_x1 >= compare_x2) /* No horizontal overlap */ ||
+                  (direction == GTK_DIR_DOWN && child->bounds.origin.y + child->bounds.size.height < compare_y) || /* Not below */
+                  (direction == GTK_DIR_UP && child->bounds.origin.y > compare_y)) /* Not above */
+                continue;
             }
+
+          children[n++] = *child;
         }
 
+      g_ptr_array_set_size (focus_order, n);
+
       compare_info.x = (compare_x1 + compare_x2) / 2;
       compare_info.y = old_bounds.origin.y + (old_bounds.size.height / 2.0f);
     }
@@ -400,7 +442,8 @@ focus_sort_up_down (GtkWidget        *widget,
     }
 
   compare_info.axis = VERTICAL;
-  g_ptr_array_sort_with_data (focus_order, axis_compare, &compare_info);
+  focus_children_sort (children, focus_order, axis_compare, &compare_info);
+  g_free (children);
 
   if (compare_info.reverse)
     reverse_ptr_array (focus_order);
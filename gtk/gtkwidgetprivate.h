@@ -318,6 +318,11 @@ void              gtk_widget_render                        (GtkWidget
                                                             GdkSurface            *surface,
                                                             const cairo_region_t *region);
 
+void              gtk_widget_get_statistics                (guint                *n_frames,
+                                                            guint                *n_layouts);
+void              gtk_widget_set_count_creations           (gboolean              count);
+GHashTable *      gtk_widget_steal_creations               (void);
+
 
 void              gtk_widget_snapshot                      (GtkWidget            *widget,
                                                             GtkSnapshot          *snapshot);
@@ -65,6 +65,7 @@
 #include "gtkseparatormenuitem.h"
 #include "gtksettings.h"
 #include "gtksnapshot.h"
+#include "gtkstartupprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
@@ -77,6 +78,7 @@
 
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdk-private.h"
+#include "gsk/gskrendererprivate.h"
 
 #include <cairo-gobject.h>
 #include <errno.h>
@@ -5106,6 +5108,11 @@ gtk_window_unmap (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_window_parent_class)->unmap (widget);
   gdk_surface_hide (surface);
 
+  /* Hidden windows may stay around for a long time, don't keep
+   * glyph atlases and texture caches for them */
+  if (priv->renderer)
+    gsk_renderer_trim_caches (priv->renderer);
+
   while (priv->configure_request_count > 0)
     {
       priv->configure_request_count--;
@@ -5668,7 +5675,12 @@ gtk_window_realize (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_window_parent_class)->realize (widget);
 
   if (priv->renderer == NULL)
-    priv->renderer = gsk_renderer_new_for_surface (surface);
+    {
+      gint64 start = gtk_startup_begin (GTK_STARTUP_RENDERER);
+
+      priv->renderer = gsk_renderer_new_for_surface (surface);
+      gtk_startup_end (GTK_STARTUP_RENDERER, start);
+    }
 
   if (priv->transient_parent &&
       _gtk_widget_get_realized (GTK_WIDGET (priv->transient_parent)))
@@ -8836,7 +8848,7 @@ gtk_window_activate_key (GtkWindow   *window,
   GtkWindowPrivate *priv = gtk_window_get_instance_private (window);
   GtkKeyHash *key_hash;
   GtkWindowKeyEntry *found_entry = NULL;
-  gboolean enable_accels;
+  gboolean enable_accels = FALSE;
 
   g_return_val_if_fail (GTK_IS_WINDOW (window), FALSE);
   g_return_val_if_fail (event != NULL, FALSE);
@@ -8852,9 +8864,11 @@ gtk_window_activate_key (GtkWindow   *window,
 					      gtk_accelerator_get_default_mod_mask (),
 					      event->group);
 
-      g_object_get (gtk_widget_get_settings (GTK_WIDGET (window)),
-                    "gtk-enable-accels", &enable_accels,
-                    NULL);
+      /* Most keys have no accelerator, don't query settings for them */
+      if (entries)
+        g_object_get (gtk_widget_get_settings (GTK_WIDGET (window)),
+                      "gtk-enable-accels", &enable_accels,
+                      NULL);
 
       for (tmp_list = entries; tmp_list; tmp_list = tmp_list->next)
 	{
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "css-invalidation.h"
+
+#include "gtklabel.h"
+#include "gtktextview.h"
+#include "gtktogglebutton.h"
+#include "gtkcssnodeprivate.h"
+#include "gtkcsstypesprivate.h"
+#include "gtkcsswidgetnodeprivate.h"
+
+/* Number of frames kept in the view */
+#define MAX_FRAMES 100
+
+/* Number of invalidation origins listed per frame */
+#define MAX_ORIGINS 10
+
+enum
+{
+  PROP_0,
+  PROP_BUTTON
+};
+
+struct _GtkInspectorCssInvalidationPrivate
+{
+  GtkWidget *button;
+  GtkWidget *summary;
+  GtkWidget *view;
+  gboolean recording;
+
+  GQueue frame_lines;           /* number of lines of each frame in the view */
+  guint n_frames;
+  guint64 n_computed;
+  guint64 n_lookups;
+  guint64 n_reused;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (GtkInspectorCssInvalidation, gtk_inspector_css_invalidation, GTK_TYPE_BOX)
+
+static void
+append_node (GString    *string,
+             GtkCssNode *node)
+{
+  const GQuark *classes;
+  guint i, n_classes;
+
+  if (gtk_css_node_get_name (node))
+    g_string_append (string, gtk_css_node_get_name (node));
+  else
+    g_string_append (string, G_OBJECT_TYPE_NAME (node));
+
+  if (gtk_css_node_get_id (node))
+    g_string_append_printf (string, "#%s", gtk_css_node_get_id (node));
+
+  classes = gtk_css_node_list_classes (node, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    g_string_append_printf (string, ".%s", g_quark_to_string (classes[i]));
+}
+
+static gboolean
+is_inspector_node (GtkInspectorCssInvalidation *ci,
+                   GtkCssNode                  *root)
+{
+  if (!GTK_IS_CSS_WIDGET_NODE (root))
+    return FALSE;
+
+  return gtk_css_widget_node_get_widget (GTK_CSS_WIDGET_NODE (root)) ==
+         GTK_WIDGET (gtk_widget_get_root (GTK_WIDGET (ci)));
+}
+
+static void
+append_frame (GtkInspectorCssInvalidation *ci,
+              const char                  *text,
+              guint                        n_lines)
+{
+  GtkInspectorCssInvalidationPrivate *priv = ci->priv;
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (priv->view));
+
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_insert (buffer, &end, text, -1);
+  g_queue_push_tail (&priv->frame_lines, GUINT_TO_POINTER (n_lines));
+
+  if (g_queue_get_length (&priv->frame_lines) > MAX_FRAMES)
+    {
+      n_lines = GPOINTER_TO_UINT (g_queue_pop_head (&priv->frame_lines));
+      gtk_text_buffer_get_start_iter (buffer, &start);
+      gtk_text_buffer_get_iter_at_line (buffer, &end, n_lines);
+      gtk_text_buffer_delete (buffer, &start, &end);
+    }
+}
+
+static void
+update_summary (GtkInspectorCssInvalidation *ci)
+{
+  GtkInspectorCssInvalidationPrivate *priv = ci->priv;
+  char *text;
+
+  text = g_strdup_printf (_("%u frames: %" G_GUINT64_FORMAT " styles computed, "
+                            "%" G_GUINT64_FORMAT " found in a cache, "
+                            "%" G_GUINT64_FORMAT " reused"),
+                          priv->n_frames, priv->n_computed, priv->n_lookups, priv->n_reused);
+  gtk_label_set_text (GTK_LABEL (priv->summary), text);
+  g_free (text);
+}
+
+/* Summarizes the events of one validation. Invalidations without a
+ * source are where the change originated, the depth of the others is
+ * how many levels the change was propagated down the tree from there. */
+static void
+trace_func (GtkCssNode                 *root,
+            const GtkCssNodeTraceEvent *events,
+            guint                       n_events,
+            gpointer                    user_data)
+{
+  GtkInspectorCssInvalidation *ci = user_data;
+  GtkInspectorCssInvalidationPrivate *priv = ci->priv;
+  guint n_origins = 0, n_computed = 0, n_lookups = 0, n_reused = 0;
+  guint max_depth = 0, n_lines;
+  GHashTable *depths;
+  GString *origins, *text;
+  guint i;
+
+  if (is_inspector_node (ci, root))
+    return;
+
+  depths = g_hash_table_new (NULL, NULL);
+  origins = g_string_new (NULL);
+
+  for (i = 0; i < n_events; i++)
+    {
+      const GtkCssNodeTraceEvent *event = &events[i];
+
+      switch (event->kind)
+        {
+        case GTK_CSS_NODE_TRACE_INVALIDATE:
+          if (event->source == NULL)
+            {
+              if (n_origins < MAX_ORIGINS)
+                {
+                  char *change = gtk_css_change_to_string (event->change);
+
+                  g_string_append (origins, "    ");
+                  append_node (origins, event->node);
+                  g_string_append_printf (origins, ": %s\n", change);
+                  g_free (change);
+                }
+              n_origins++;
+
+              if (!g_hash_table_contains (depths, event->node))
+                g_hash_table_insert (depths, event->node, GUINT_TO_POINTER (0));
+            }
+          else
+            {
+              guint depth = GPOINTER_TO_UINT (g_hash_table_lookup (depths, event->source)) + 1;
+
+              if (depth > GPOINTER_TO_UINT (g_hash_table_lookup (depths, event->node)))
+                g_hash_table_insert (depths, event->node, GUINT_TO_POINTER (depth));
+              max_depth = MAX (max_depth, depth);
+            }
+          break;
+
+        case GTK_CSS_NODE_TRACE_COMPUTE:
+          n_computed++;
+          break;
+
+        case GTK_CSS_NODE_TRACE_LOOKUP:
+          n_lookups++;
+          break;
+
+        case GTK_CSS_NODE_TRACE_REUSE:
+          n_reused++;
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  priv->n_frames++;
+  priv->n_computed += n_computed;
+  priv->n_lookups += n_lookups;
+  priv->n_reused += n_reused;
+
+  text = g_string_new (NULL);
+  g_string_append_printf (text,
+                          _("Frame %u: %u nodes invalidated from %u origins, %u levels deep; "
+                            "%u styles computed, %u found in a cache, %u reused\n"),
+                          priv->n_frames, g_hash_table_size (depths), n_origins, max_depth,
+                          n_computed, n_lookups, n_reused);
+  g_string_append (text, origins->str);
+  n_lines = 1 + MIN (n_origins, MAX_ORIGINS);
+  if (n_origins > MAX_ORIGINS)
+    {
+      g_string_append_printf (text, _("    and %u more\n"), n_origins - MAX_ORIGINS);
+      n_lines++;
+    }
+
+  append_frame (ci, text->str, n_lines);
+  update_summary (ci);
+
+  g_string_free (text, TRUE);
+  g_string_free (origins, TRUE);
+  g_hash_table_unref (depths);
+}
+
+static void
+toggle_record (GtkToggleButton             *button,
+               GtkInspectorCssInvalidation *ci)
+{
+  ci->priv->recording = gtk_toggle_button_get_active (button);
+
+  if (ci->priv->recording)
+    gtk_css_node_set_trace_func (trace_func, ci);
+  else
+    gtk_css_node_set_trace_func (NULL, NULL);
+}
+
+static void
+gtk_inspector_css_invalidation_init (GtkInspectorCssInvalidation *ci)
+{
+  ci->priv = gtk_inspector_css_invalidation_get_instance_private (ci);
+  gtk_widget_init_template (GTK_WIDGET (ci));
+  g_queue_init (&ci->priv->frame_lines);
+}
+
+static void
+constructed (GObject *object)
+{
+  GtkInspectorCssInvalidation *ci = GTK_INSPECTOR_CSS_INVALIDATION (object);
+
+  G_OBJECT_CLASS (gtk_inspector_css_invalidation_parent_class)->constructed (object);
+
+  g_signal_connect (ci->priv->button, "toggled",
+                    G_CALLBACK (toggle_record), ci);
+}
+
+static void
+finalize (GObject *object)
+{
+  GtkInspectorCssInvalidation *ci = GTK_INSPECTOR_CSS_INVALIDATION (object);
+
+  if (ci->priv->recording)
+    gtk_css_node_set_trace_func (NULL, NULL);
+
+  g_queue_clear (&ci->priv->frame_lines);
+
+  G_OBJECT_CLASS (gtk_inspector_css_invalidation_parent_class)->finalize (object);
+}
+
+static void
+get_property (GObject    *object,
+              guint       param_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+  GtkInspectorCssInvalidation *ci = GTK_INSPECTOR_CSS_INVALIDATION (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      g_value_set_object (value, ci->priv->button);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+set_property (GObject      *object,
+              guint         param_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+  GtkInspectorCssInvalidation *ci = GTK_INSPECTOR_CSS_INVALIDATION (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      ci->priv->button = g_value_get_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_css_invalidation_class_init (GtkInspectorCssInvalidationClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->get_property = get_property;
+  object_class->set_property = set_property;
+  object_class->constructed = constructed;
+  object_class->finalize = finalize;
+
+  g_object_class_install_property (object_class, PROP_BUTTON,
+      g_param_spec_object ("button", NULL, NULL,
+                           GTK_TYPE_WIDGET, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/css-invalidation.ui");
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssInvalidation, summary);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorCssInvalidation, view);
+}
+
+// vim: set et sw=2 ts=2:
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GTK_INSPECTOR_CSS_INVALIDATION_H_
+#define _GTK_INSPECTOR_CSS_INVALIDATION_H_
+
+#include <gtk/gtkbox.h>
+
+#define GTK_TYPE_INSPECTOR_CSS_INVALIDATION            (gtk_inspector_css_invalidation_get_type())
+#define GTK_INSPECTOR_CSS_INVALIDATION(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_INSPECTOR_CSS_INVALIDATION, GtkInspectorCssInvalidation))
+#define GTK_INSPECTOR_CSS_INVALIDATION_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), GTK_TYPE_INSPECTOR_CSS_INVALIDATION, GtkInspectorCssInvalidationClass))
+#define GTK_INSPECTOR_IS_CSS_INVALIDATION(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), GTK_TYPE_INSPECTOR_CSS_INVALIDATION))
+#define GTK_INSPECTOR_IS_CSS_INVALIDATION_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), GTK_TYPE_INSPECTOR_CSS_INVALIDATION))
+#define GTK_INSPECTOR_CSS_INVALIDATION_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), GTK_TYPE_INSPECTOR_CSS_INVALIDATION, GtkInspectorCssInvalidationClass))
+
+
+typedef struct _GtkInspectorCssInvalidationPrivate GtkInspectorCssInvalidationPrivate;
+
+typedef struct _GtkInspectorCssInvalidation
+{
+  GtkBox parent;
+  GtkInspectorCssInvalidationPrivate *priv;
+} GtkInspectorCssInvalidation;
+
+typedef struct _GtkInspectorCssInvalidationClass
+{
+  GtkBoxClass parent;
+} GtkInspectorCssInvalidationClass;
+
+G_BEGIN_DECLS
+
+GType      gtk_inspector_css_invalidation_get_type   (void);
+
+G_END_DECLS
+
+#endif // _GTK_INSPECTOR_CSS_INVALIDATION_H_
+
+// vim: set et sw=2 ts=2:
@@ -25,14 +25,27 @@
 #include "gtkwidget.h"
 #include "gtkwindow.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 /* duration before we start fading in us */
 #define GDK_FPS_OVERLAY_LINGER_DURATION (1000 * 1000)
 /* duration when fade is finished in us */
 #define GDK_FPS_OVERLAY_FADE_DURATION (500 * 1000)
+/* number of frame intervals the percentiles are computed from */
+#define GDK_FPS_OVERLAY_N_INTERVALS 120
 
 typedef struct _GtkFpsInfo {
   gint64 last_frame;
   GskRenderNode *last_node;
+
+  /* The frame clock only keeps a short history, so the intervals
+   * between completed frames are collected here, in a ring */
+  gint64 last_counter;
+  gint64 last_timestamp;
+  gint64 intervals[GDK_FPS_OVERLAY_N_INTERVALS];
+  guint n_intervals;
+  guint next_interval;
 } GtkFpsInfo;
 
 struct _GtkFpsOverlay
@@ -135,6 +148,78 @@ gtk_fps_overlay_get_fps (GtkWidget *widget)
   return ((double) end_counter - start_counter) * G_USEC_PER_SEC / (end_timestamp - start_timestamp);
 }
 
+static void
+gtk_fps_info_collect_intervals (GtkFpsInfo    *info,
+                                GdkFrameClock *frame_clock)
+{
+  gint64 counter, end_counter;
+
+  counter = MAX (info->last_counter + 1, gdk_frame_clock_get_history_start (frame_clock));
+  end_counter = gdk_frame_clock_get_frame_counter (frame_clock);
+
+  for (; counter <= end_counter; counter++)
+    {
+      GdkFrameTimings *timings;
+      gint64 timestamp;
+
+      timings = gdk_frame_clock_get_timings (frame_clock, counter);
+      if (timings == NULL)
+        continue;
+      if (!gdk_frame_timings_get_complete (timings))
+        break;
+
+      timestamp = gdk_frame_timings_get_presentation_time (timings);
+      if (timestamp == 0)
+        timestamp = gdk_frame_timings_get_frame_time (timings);
+
+      /* Frames right after an idle period would skew the
+       * percentiles, so only consecutive frames count */
+      if (info->last_timestamp != 0 && counter == info->last_counter + 1)
+        {
+          info->intervals[info->next_interval] = timestamp - info->last_timestamp;
+          info->next_interval = (info->next_interval + 1) % GDK_FPS_OVERLAY_N_INTERVALS;
+          info->n_intervals = MIN (info->n_intervals + 1, GDK_FPS_OVERLAY_N_INTERVALS);
+        }
+
+      info->last_counter = counter;
+      info->last_timestamp = timestamp;
+    }
+}
+
+static int
+compare_intervals (gconstpointer a,
+                   gconstpointer b)
+{
+  gint64 ia = *(const gint64 *) a;
+  gint64 ib = *(const gint64 *) b;
+
+  return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+/* Returns the 50th, 95th and 99th percentile of the frame
+ * intervals in milliseconds, or %FALSE if there are too few */
+static gboolean
+gtk_fps_info_get_percentiles (GtkFpsInfo *info,
+                              double     *p50,
+                              double     *p95,
+                              double     *p99)
+{
+  gint64 sorted[GDK_FPS_OVERLAY_N_INTERVALS];
+  guint n = info->n_intervals;
+
+  if (n < 10)
+    return FALSE;
+
+  memcpy (sorted, info->intervals, n * sizeof (gint64));
+  qsort (sorted, n, sizeof (gint64), compare_intervals);
+
+  *p50 = sorted[n * 50 / 100] / 1000.;
+  *p95 = sorted[MIN (n * 95 / 100, n - 1)] / 1000.;
+  *p99 = sorted[MIN (n * 99 / 100, n - 1)] / 1000.;
+
+  return TRUE;
+}
+
 static gboolean
 gtk_fps_overlay_force_redraw (GtkWidget     *widget,
                               GdkFrameClock *clock,
@@ -155,7 +240,7 @@ gtk_fps_overlay_snapshot (GtkInspectorOverlay *overlay,
   GtkFpsInfo *info;
   PangoLayout *layout;
   gint64 now;
-  double fps;
+  double fps, p50, p95, p99;
   char *fps_string;
   graphene_rect_t bounds;
   gboolean has_bounds = FALSE;
@@ -194,9 +279,13 @@ gtk_fps_overlay_snapshot (GtkInspectorOverlay *overlay,
         }
     }
 
+  gtk_fps_info_collect_intervals (info, gtk_widget_get_frame_clock (widget));
+
   fps = gtk_fps_overlay_get_fps (widget);
   if (fps == 0.0)
     fps_string = g_strdup ("--- fps");
+  else if (gtk_fps_info_get_percentiles (info, &p50, &p95, &p99))
+    fps_string = g_strdup_printf ("%.2f fps\n%.1f / %.1f / %.1f ms", fps, p50, p95, p99);
   else
     fps_string = g_strdup_printf ("%.2f fps", fps);
 
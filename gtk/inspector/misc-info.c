@@ -31,6 +31,7 @@
 #include "gtkbutton.h"
 #include "gtkmenubutton.h"
 #include "gtkwidgetprivate.h"
+#include "gtksizerequestcacheprivate.h"
 
 
 struct _GtkInspectorMiscInfoPrivate {
@@ -55,6 +56,8 @@ struct _GtkInspectorMiscInfoPrivate {
   GtkWidget *allocated_size;
   GtkWidget *baseline_row;
   GtkWidget *baseline;
+  GtkWidget *request_cache_row;
+  GtkWidget *request_cache;
   GtkWidget *frame_clock_row;
   GtkWidget *frame_clock;
   GtkWidget *frame_clock_button;
@@ -138,6 +141,7 @@ allocation_changed (GtkWidget    *w,
                     GtkInspectorMiscInfo *sl)
 {
   GtkAllocation alloc;
+  SizeRequestCache *cache;
   gchar *size_label;
   GEnumClass *class;
   GEnumValue *value;
@@ -154,6 +158,11 @@ allocation_changed (GtkWidget    *w,
   gtk_label_set_label (GTK_LABEL (sl->priv->baseline), size_label);
   g_free (size_label);
 
+  cache = _gtk_widget_peek_request_cache (w);
+  size_label = g_strdup_printf ("%u of %u", cache->n_hits, cache->n_lookups);
+  gtk_label_set_label (GTK_LABEL (sl->priv->request_cache), size_label);
+  g_free (size_label);
+
   class = G_ENUM_CLASS (g_type_class_ref (GTK_TYPE_SIZE_REQUEST_MODE));
   value = g_enum_get_value (class, gtk_widget_get_request_mode (w));
   gtk_label_set_label (GTK_LABEL (sl->priv->request_mode), value->value_nick);
@@ -357,6 +366,7 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
       gtk_widget_show (sl->priv->request_mode_row);
       gtk_widget_show (sl->priv->allocated_size_row);
       gtk_widget_show (sl->priv->baseline_row);
+      gtk_widget_show (sl->priv->request_cache_row);
       gtk_widget_show (sl->priv->mnemonic_label_row);
       gtk_widget_show (sl->priv->tick_callback_row);
       gtk_widget_show (sl->priv->accessible_role_row);
@@ -381,6 +391,7 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
       gtk_widget_hide (sl->priv->mnemonic_label_row);
       gtk_widget_hide (sl->priv->allocated_size_row);
       gtk_widget_hide (sl->priv->baseline_row);
+      gtk_widget_hide (sl->priv->request_cache_row);
       gtk_widget_hide (sl->priv->tick_callback_row);
       gtk_widget_hide (sl->priv->accessible_role_row);
       gtk_widget_hide (sl->priv->accessible_name_row);
@@ -522,6 +533,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, allocated_size);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, baseline_row);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, baseline);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, request_cache_row);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, request_cache);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, frame_clock_row);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, frame_clock);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, frame_clock_button);
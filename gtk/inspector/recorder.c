@@ -31,6 +31,7 @@
 #include <gtk/gtktreemodel.h>
 #include <gtk/gtktreeview.h>
 #include <gsk/gskrendererprivate.h>
+#include <gsk/gskrendernodebinaryprivate.h>
 #include <gsk/gskrendernodeprivate.h>
 #include <gsk/gskroundedrectprivate.h>
 #include <gsk/gsktransformprivate.h>
@@ -113,6 +114,8 @@ create_list_model_for_render_node (GskRenderNode *node)
     case GSK_COLOR_NODE:
     case GSK_LINEAR_GRADIENT_NODE:
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     case GSK_BORDER_NODE:
     case GSK_INSET_SHADOW_NODE:
     case GSK_OUTSET_SHADOW_NODE:
@@ -197,6 +200,102 @@ recordings_clear_all (GtkButton            *button,
   g_list_store_remove_all (G_LIST_STORE (priv->recordings));
 }
 
+static gboolean
+recordings_write (GtkInspectorRecorder  *recorder,
+                  GFile                 *file,
+                  GError               **error)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+  GskRenderNodeWriter *writer;
+  GFileOutputStream *stream;
+  gboolean result = TRUE;
+  guint i;
+
+  stream = g_file_replace (file, NULL, FALSE, 0, NULL, error);
+  if (stream == NULL)
+    return FALSE;
+
+  /* Frames are written one by one, shared nodes only once */
+  writer = gsk_render_node_writer_new (G_OUTPUT_STREAM (stream));
+
+  for (i = 0; result && i < g_list_model_get_n_items (priv->recordings); i++)
+    {
+      GtkInspectorRecording *recording = g_list_model_get_item (priv->recordings, i);
+
+      if (GTK_INSPECTOR_IS_RENDER_RECORDING (recording))
+        result = gsk_render_node_writer_add_frame (writer,
+                                                   gtk_inspector_render_recording_get_node (GTK_INSPECTOR_RENDER_RECORDING (recording)),
+                                                   gtk_inspector_recording_get_timestamp (recording),
+                                                   NULL,
+                                                   error);
+
+      g_object_unref (recording);
+    }
+
+  gsk_render_node_writer_free (writer);
+
+  if (result)
+    result = g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+
+  g_object_unref (stream);
+
+  return result;
+}
+
+static void
+recordings_save_response (GtkWidget            *dialog,
+                          gint                  response,
+                          GtkInspectorRecorder *recorder)
+{
+  gtk_widget_hide (dialog);
+
+  if (response == GTK_RESPONSE_ACCEPT)
+    {
+      GFile *file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog));
+      GError *error = NULL;
+
+      if (!recordings_write (recorder, file, &error))
+        {
+          GtkWidget *message_dialog;
+
+          message_dialog = gtk_message_dialog_new (GTK_WINDOW (gtk_window_get_transient_for (GTK_WINDOW (dialog))),
+                                                   GTK_DIALOG_MODAL|GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                   GTK_MESSAGE_INFO,
+                                                   GTK_BUTTONS_OK,
+                                                   _("Saving recording failed"));
+          gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message_dialog),
+                                                    "%s", error->message);
+          g_signal_connect (message_dialog, "response", G_CALLBACK (gtk_widget_destroy), NULL);
+          gtk_widget_show (message_dialog);
+          g_error_free (error);
+        }
+
+      g_object_unref (file);
+    }
+
+  gtk_widget_destroy (dialog);
+}
+
+static void
+recordings_save (GtkButton            *button,
+                 GtkInspectorRecorder *recorder)
+{
+  GtkWidget *dialog;
+
+  dialog = gtk_file_chooser_dialog_new ("",
+                                        GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (recorder))),
+                                        GTK_FILE_CHOOSER_ACTION_SAVE,
+                                        _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                        _("_Save"), GTK_RESPONSE_ACCEPT,
+                                        NULL);
+  gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (dialog), "recording.node");
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
+  gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+  gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (dialog), TRUE);
+  g_signal_connect (dialog, "response", G_CALLBACK (recordings_save_response), recorder);
+  gtk_widget_show (dialog);
+}
+
 static const char *
 node_type_name (GskRenderNodeType type)
 {
@@ -218,6 +317,10 @@ node_type_name (GskRenderNodeType type)
       return "Linear Gradient";
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
       return "Repeating Linear Gradient";
+    case GSK_RADIAL_GRADIENT_NODE:
+      return "Radial Gradient";
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      return "Repeating Radial Gradient";
     case GSK_BORDER_NODE:
       return "Border";
     case GSK_TEXTURE_NODE:
@@ -263,6 +366,8 @@ node_name (GskRenderNode *node)
     case GSK_CAIRO_NODE:
     case GSK_LINEAR_GRADIENT_NODE:
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     case GSK_BORDER_NODE:
     case GSK_INSET_SHADOW_NODE:
     case GSK_OUTSET_SHADOW_NODE:
@@ -630,6 +735,52 @@ populate_render_node_properties (GtkListStore  *store,
       }
       break;
 
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        const graphene_point_t *center = gsk_radial_gradient_node_peek_center (node);
+        const gsize n_stops = gsk_radial_gradient_node_get_n_color_stops (node);
+        const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+        int i;
+        GString *s;
+        GdkTexture *texture;
+
+        tmp = g_strdup_printf ("%.2f, %.2f", center->x, center->y);
+        add_text_row (store, "Center", tmp);
+        g_free (tmp);
+
+        tmp = g_strdup_printf ("%.2f, %.2f",
+                               gsk_radial_gradient_node_get_hradius (node),
+                               gsk_radial_gradient_node_get_vradius (node));
+        add_text_row (store, "Radius", tmp);
+        g_free (tmp);
+
+        tmp = g_strdup_printf ("%.2f ⟶ %.2f",
+                               gsk_radial_gradient_node_get_start (node),
+                               gsk_radial_gradient_node_get_end (node));
+        add_text_row (store, "Extent", tmp);
+        g_free (tmp);
+
+        s = g_string_new ("");
+        for (i = 0; i < n_stops; i++)
+          {
+            tmp = gdk_rgba_to_string (&stops[i].color);
+            g_string_append_printf (s, "%.2f, %s\n", stops[i].offset, tmp);
+            g_free (tmp);
+          }
+
+        texture = get_linear_gradient_texture (n_stops, stops);
+        gtk_list_store_insert_with_values (store, NULL, -1,
+                                           0, "Color Stops",
+                                           1, s->str,
+                                           2, TRUE,
+                                           3, texture,
+                                           -1);
+        g_string_free (s, TRUE);
+        g_object_unref (texture);
+      }
+      break;
+
     case GSK_TEXT_NODE:
       {
         const PangoFont *font = gsk_text_node_peek_font (node);
@@ -1276,6 +1427,7 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, recordings_list_row_selected);
   gtk_widget_class_bind_template_callback (widget_class, render_node_list_selection_changed);
   gtk_widget_class_bind_template_callback (widget_class, render_node_save);
+  gtk_widget_class_bind_template_callback (widget_class, recordings_save);
   gtk_widget_class_bind_template_callback (widget_class, node_property_activated);
 }
 
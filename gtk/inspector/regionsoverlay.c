@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "regionsoverlay.h"
+
+#include "gtkrootprivate.h"
+#include "gtkwidget.h"
+
+/* Overdraw uses a faint color, so that areas that get drawn many
+ * times stand out by adding up */
+static const GdkRGBA region_colors[GSK_N_DEBUG_REGIONS] = {
+  [GSK_DEBUG_REGION_FALLBACK]  = { 1, 0, 0, 0.4 },
+  [GSK_DEBUG_REGION_OFFSCREEN] = { 0, 0, 1, 0.4 },
+  [GSK_DEBUG_REGION_DRAW]      = { 0, 1, 0, 0.1 },
+};
+
+/* Shows where the renderer of a toplevel did something in its last
+ * frame, like drawing a fallback. The regions get recorded by the
+ * renderer while drawing, see gsk_renderer_record_debug_regions(). */
+struct _GtkRegionsOverlay
+{
+  GtkInspectorOverlay parent_instance;
+
+  GskDebugRegion kind;
+  GHashTable *renderers; /* renderers we record with */
+};
+
+struct _GtkRegionsOverlayClass
+{
+  GtkInspectorOverlayClass parent_class;
+};
+
+G_DEFINE_TYPE (GtkRegionsOverlay, gtk_regions_overlay, GTK_TYPE_INSPECTOR_OVERLAY)
+
+static void
+stop_recording (gpointer data)
+{
+  GskRenderer *renderer = data;
+
+  gsk_renderer_record_debug_regions (renderer, FALSE);
+  g_object_unref (renderer);
+}
+
+static void
+gtk_regions_overlay_snapshot (GtkInspectorOverlay *overlay,
+                              GtkSnapshot         *snapshot,
+                              GskRenderNode       *node,
+                              GtkWidget           *widget)
+{
+  GtkRegionsOverlay *self = GTK_REGIONS_OVERLAY (overlay);
+  GskRenderer *renderer;
+  GArray *regions;
+  guint i;
+
+  renderer = gtk_root_get_renderer (GTK_ROOT (widget));
+  if (renderer == NULL)
+    return;
+
+  if (!g_hash_table_contains (self->renderers, renderer))
+    {
+      g_hash_table_add (self->renderers, g_object_ref (renderer));
+      gsk_renderer_record_debug_regions (renderer, TRUE);
+      /* Regions are from the previous frame, so we need one more */
+      gdk_surface_queue_expose (gtk_widget_get_surface (widget));
+      return;
+    }
+
+  regions = gsk_renderer_get_debug_regions (renderer, self->kind);
+  if (regions == NULL)
+    return;
+
+  gtk_snapshot_push_debug (snapshot, "%s", GSK_DEBUG_REGIONS_IGNORE);
+
+  for (i = 0; i < regions->len; i++)
+    {
+      gtk_snapshot_append_color (snapshot,
+                                 &region_colors[self->kind],
+                                 &g_array_index (regions, graphene_rect_t, i));
+    }
+
+  gtk_snapshot_pop (snapshot);
+}
+
+static void
+gtk_regions_overlay_queue_draw (GtkInspectorOverlay *overlay)
+{
+  GtkRegionsOverlay *self = GTK_REGIONS_OVERLAY (overlay);
+  GHashTableIter iter;
+  gpointer renderer;
+
+  g_hash_table_iter_init (&iter, self->renderers);
+  while (g_hash_table_iter_next (&iter, &renderer, NULL))
+    {
+      GdkSurface *surface = gsk_renderer_get_surface (renderer);
+
+      if (surface)
+        gdk_surface_queue_expose (surface);
+    }
+}
+
+static void
+gtk_regions_overlay_dispose (GObject *object)
+{
+  GtkRegionsOverlay *self = GTK_REGIONS_OVERLAY (object);
+
+  g_clear_pointer (&self->renderers, g_hash_table_unref);
+
+  G_OBJECT_CLASS (gtk_regions_overlay_parent_class)->dispose (object);
+}
+
+static void
+gtk_regions_overlay_class_init (GtkRegionsOverlayClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GtkInspectorOverlayClass *overlay_class = GTK_INSPECTOR_OVERLAY_CLASS (klass);
+
+  overlay_class->snapshot = gtk_regions_overlay_snapshot;
+  overlay_class->queue_draw = gtk_regions_overlay_queue_draw;
+
+  gobject_class->dispose = gtk_regions_overlay_dispose;
+}
+
+static void
+gtk_regions_overlay_init (GtkRegionsOverlay *self)
+{
+  self->renderers = g_hash_table_new_full (g_direct_hash, g_direct_equal, stop_recording, NULL);
+}
+
+GtkInspectorOverlay *
+gtk_regions_overlay_new (GskDebugRegion kind)
+{
+  GtkRegionsOverlay *self;
+
+  g_return_val_if_fail (kind < GSK_N_DEBUG_REGIONS, NULL);
+
+  self = g_object_new (GTK_TYPE_REGIONS_OVERLAY, NULL);
+  self->kind = kind;
+
+  return GTK_INSPECTOR_OVERLAY (self);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright © 2019 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_REGIONS_OVERLAY_H__
+#define __GTK_REGIONS_OVERLAY_H__
+
+#include "inspectoroverlay.h"
+
+#include "gsk/gskrendererprivate.h"
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_REGIONS_OVERLAY             (gtk_regions_overlay_get_type ())
+G_DECLARE_FINAL_TYPE (GtkRegionsOverlay, gtk_regions_overlay, GTK, REGIONS_OVERLAY, GtkInspectorOverlay)
+
+GtkInspectorOverlay *   gtk_regions_overlay_new                 (GskDebugRegion  kind);
+
+G_END_DECLS
+
+#endif /* __GTK_REGIONS_OVERLAY_H__ */
@@ -31,6 +31,11 @@
 #include "gtktreeview.h"
 #include "gtkeventcontrollerkey.h"
 #include "gtkmain.h"
+#include "gtkcssnodestylecacheprivate.h"
+#include "gtkcssvalueprivate.h"
+#include "gtkwidgetprivate.h"
+
+#include <gsk/gskrendernodeprivate.h>
 
 #include <glib/gi18n-lib.h>
 
@@ -60,6 +65,12 @@ struct _GtkInspectorStatisticsPrivate
   guint update_source_id;
   GtkWidget *search_entry;
   GtkWidget *search_bar;
+  GtkWidget *style_cache;
+  GtkWidget *churn;
+  guint last_frames;
+  guint last_nodes;
+  guint last_values;
+  guint last_layouts;
 };
 
 typedef struct {
@@ -131,12 +142,125 @@ add_type_count (GtkInspectorStatistics *sl, GType type)
   return cumulative;
 }
 
+static void
+update_style_cache (GtkInspectorStatistics *sl)
+{
+  guint lookups, hits;
+  gchar *text;
+
+  gtk_css_node_style_cache_get_statistics (&lookups, &hits);
+
+  text = g_strdup_printf (_("Style cache: %u lookups, %u hits (%.1f%%)"),
+                          lookups, hits, lookups > 0 ? 100.0 * hits / lookups : 0.0);
+  gtk_label_set_text (GTK_LABEL (sl->priv->style_cache), text);
+  g_free (text);
+}
+
+#define N_TOP_CREATIONS 5
+
+typedef struct {
+  GType type;
+  guint count;
+} Creations;
+
+static int
+compare_creations (gconstpointer a,
+                   gconstpointer b)
+{
+  const Creations *ca = a;
+  const Creations *cb = b;
+
+  return ca->count < cb->count ? 1 : (ca->count > cb->count ? -1 : 0);
+}
+
+static void
+append_top_creations (GString    *text,
+                      GHashTable *creations)
+{
+  GHashTableIter iter;
+  gpointer type, count;
+  GArray *array;
+  guint i;
+
+  if (creations == NULL || g_hash_table_size (creations) == 0)
+    return;
+
+  array = g_array_sized_new (FALSE, FALSE, sizeof (Creations), g_hash_table_size (creations));
+  g_hash_table_iter_init (&iter, creations);
+  while (g_hash_table_iter_next (&iter, &type, &count))
+    {
+      Creations c = { GPOINTER_TO_SIZE (type), GPOINTER_TO_UINT (count) };
+      g_array_append_val (array, c);
+    }
+
+  g_array_sort (array, compare_creations);
+
+  g_string_append (text, "\n");
+  g_string_append (text, _("Most created widgets:"));
+  for (i = 0; i < MIN (array->len, N_TOP_CREATIONS); i++)
+    {
+      Creations *c = &g_array_index (array, Creations, i);
+
+      g_string_append_printf (text, "%s %s (%u)", i > 0 ? "," : "", g_type_name (c->type), c->count);
+    }
+
+  g_array_unref (array);
+}
+
+/* Shows how many objects each frame created since the last update.
+ * The counters are cheap enough to always be maintained, only counting
+ * widgets per type needs to be turned on while recording. */
+static void
+update_churn (GtkInspectorStatistics *sl)
+{
+  GtkInspectorStatisticsPrivate *priv = sl->priv;
+  guint frames, nodes, values, layouts;
+  GHashTable *creations;
+  GString *text;
+
+  gtk_widget_get_statistics (&frames, &layouts);
+  nodes = gsk_render_node_get_n_created ();
+  values = gtk_css_value_get_n_created ();
+  creations = gtk_widget_steal_creations ();
+
+  text = g_string_new (NULL);
+
+  if (frames == priv->last_frames)
+    {
+      g_string_append (text, _("No frames rendered"));
+    }
+  else
+    {
+      double n_frames = frames - priv->last_frames;
+
+      g_string_append_printf (text, _("Per frame: %.1f render nodes, %.1f CSS values, %.1f layouts"),
+                              (nodes - priv->last_nodes) / n_frames,
+                              (values - priv->last_values) / n_frames,
+                              (layouts - priv->last_layouts) / n_frames);
+    }
+
+  append_top_creations (text, creations);
+
+  gtk_label_set_text (GTK_LABEL (priv->churn), text->str);
+
+  priv->last_frames = frames;
+  priv->last_nodes = nodes;
+  priv->last_values = values;
+  priv->last_layouts = layouts;
+
+  g_string_free (text, TRUE);
+  g_clear_pointer (&creations, g_hash_table_unref);
+}
+
 static gboolean
 update_type_counts (gpointer data)
 {
   GtkInspectorStatistics *sl = data;
   GType type;
 
+  update_style_cache (sl);
+  update_churn (sl);
+
   for (type = G_TYPE_INTERFACE; type <= G_TYPE_FUNDAMENTAL_MAX; type += (1 << G_TYPE_FUNDAMENTAL_SHIFT))
     {
       if (!G_TYPE_IS_INSTANTIATABLE (type))
@@ -155,6 +279,8 @@ toggle_record (GtkToggleButton        *button,
   if (gtk_toggle_button_get_active (button) == (sl->priv->update_source_id != 0))
     return;
 
+  gtk_widget_set_count_creations (gtk_toggle_button_get_active (button));
+
   if (gtk_toggle_button_get_active (button))
     {
       sl->priv->update_source_id = g_timeout_add_seconds (1, update_type_counts, sl);
@@ -408,7 +534,10 @@ finalize (GObject *object)
   GtkInspectorStatistics *sl = GTK_INSPECTOR_STATISTICS (object);
 
   if (sl->priv->update_source_id)
-    g_source_remove (sl->priv->update_source_id);
+    {
+      g_source_remove (sl->priv->update_source_id);
+      gtk_widget_set_count_creations (FALSE);
+    }
 
   g_hash_table_unref (sl->priv->counts);
 
@@ -488,6 +617,8 @@ gtk_inspector_statistics_class_init (GtkInspectorStatisticsClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, search_entry);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, search_bar);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, excuse);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, style_cache);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorStatistics, churn);
 
 }
 
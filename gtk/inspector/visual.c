@@ -22,6 +22,7 @@
 
 #include "fpsoverlay.h"
 #include "updatesoverlay.h"
+#include "regionsoverlay.h"
 #include "layoutoverlay.h"
 #include "window.h"
 
@@ -72,6 +73,7 @@ struct _GtkInspectorVisualPrivate
   GtkWidget *debug_box;
   GtkWidget *fps_switch;
   GtkWidget *updates_switch;
+  GtkWidget *regions_combo;
   GtkWidget *baselines_switch;
   GtkWidget *layout_switch;
   GtkWidget *resize_switch;
@@ -84,6 +86,7 @@ struct _GtkInspectorVisualPrivate
 
   GtkInspectorOverlay *fps_overlay;
   GtkInspectorOverlay *updates_overlay;
+  GtkInspectorOverlay *regions_overlay;
   GtkInspectorOverlay *layout_overlay;
 };
 
@@ -300,6 +303,41 @@ updates_activate (GtkSwitch          *sw,
   redraw_everything ();
 }
 
+static void
+regions_changed (GtkComboBox        *combo,
+                 GtkInspectorVisual *vis)
+{
+  GtkInspectorVisualPrivate *priv = vis->priv;
+  GtkInspectorWindow *iw;
+  const char *id;
+
+  id = gtk_combo_box_get_active_id (combo);
+  iw = GTK_INSPECTOR_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (vis)));
+  if (iw == NULL)
+    return;
+
+  if (priv->regions_overlay != NULL)
+    {
+      gtk_inspector_window_remove_overlay (iw, priv->regions_overlay);
+      priv->regions_overlay = NULL;
+    }
+
+  if (g_strcmp0 (id, "fallback") == 0)
+    priv->regions_overlay = gtk_regions_overlay_new (GSK_DEBUG_REGION_FALLBACK);
+  else if (g_strcmp0 (id, "offscreen") == 0)
+    priv->regions_overlay = gtk_regions_overlay_new (GSK_DEBUG_REGION_OFFSCREEN);
+  else if (g_strcmp0 (id, "draw") == 0)
+    priv->regions_overlay = gtk_regions_overlay_new (GSK_DEBUG_REGION_DRAW);
+
+  if (priv->regions_overlay != NULL)
+    {
+      gtk_inspector_window_add_overlay (iw, priv->regions_overlay);
+      g_object_unref (priv->regions_overlay);
+    }
+
+  redraw_everything ();
+}
+
 static void
 baselines_activate (GtkSwitch *sw)
 {
@@ -982,6 +1020,8 @@ gtk_inspector_visual_finalize (GObject *object)
     gtk_inspector_window_remove_overlay (iw, vis->priv->layout_overlay);
   if (vis->priv->updates_overlay)
     gtk_inspector_window_remove_overlay (iw, vis->priv->updates_overlay);
+  if (vis->priv->regions_overlay)
+    gtk_inspector_window_remove_overlay (iw, vis->priv->regions_overlay);
   if (vis->priv->fps_overlay)
     gtk_inspector_window_remove_overlay (iw, vis->priv->fps_overlay);
 
@@ -1020,12 +1060,14 @@ gtk_inspector_visual_class_init (GtkInspectorVisualClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, font_scale_adjustment);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, fps_switch);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, updates_switch);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, regions_combo);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, baselines_switch);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, layout_switch);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorVisual, resize_switch);
 
   gtk_widget_class_bind_template_callback (widget_class, fps_activate);
   gtk_widget_class_bind_template_callback (widget_class, updates_activate);
+  gtk_widget_class_bind_template_callback (widget_class, regions_changed);
   gtk_widget_class_bind_template_callback (widget_class, direction_changed);
   gtk_widget_class_bind_template_callback (widget_class, baselines_activate);
   gtk_widget_class_bind_template_callback (widget_class, layout_activate);
@@ -0,0 +1,63 @@
+/*  Copyright 2019 Red Hat, Inc.
+ *
+ * GTK+ is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * GLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GTK+; see the file COPYING.  If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <glib/gi18n.h>
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include "gtkbuilderprecompileprivate.h"
+
+void
+do_precompile (int *argc, const char ***argv)
+{
+  GError *error = NULL;
+  gchar *contents;
+  gsize length;
+  GBytes *bytes;
+  const gchar *filename;
+
+  if (*argc < 2)
+    {
+      g_printerr (_("No .ui file specified\n"));
+      exit (1);
+    }
+
+  filename = (*argv)[1];
+
+  if (!g_file_get_contents (filename, &contents, &length, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      exit (1);
+    }
+
+  bytes = _gtk_builder_precompile (contents, length, &error);
+  g_free (contents);
+
+  if (bytes == NULL)
+    {
+      g_printerr ("%s: %s\n", filename, error->message);
+      exit (1);
+    }
+
+  fwrite (g_bytes_get_data (bytes, NULL), 1, g_bytes_get_size (bytes), stdout);
+
+  g_bytes_unref (bytes);
+}
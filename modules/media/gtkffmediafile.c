@@ -31,6 +31,38 @@
 #include <libswscale/swscale.h>
 
 typedef struct _GtkVideoFrameFFMpeg GtkVideoFrameFFMpeg;
+typedef struct _GtkFfFramePool GtkFfFramePool;
+typedef struct _GtkFfFrameBuffer GtkFfFrameBuffer;
+
+/* Decoded frames are converted into buffers from a pool. A buffer
+ * goes back to the pool when the texture that wraps it is released,
+ * which is after the renderer is done with it, so playing a video
+ * doesn't allocate a new frame-sized buffer for every frame. The pool
+ * is shared with the buffers, as textures can outlive the file.
+ */
+struct _GtkFfFramePool
+{
+  gint ref_count;
+  GMutex lock;
+  gsize size;
+  GSList *free_buffers;
+  guint n_free_buffers;
+};
+
+struct _GtkFfFrameBuffer
+{
+  GtkFfFramePool *pool;
+  gsize size;
+  guchar data[];
+};
+
+/* Number of frames the decoding thread keeps ready ahead of the
+ * current one */
+#define MAX_QUEUED_FRAMES 4
+
+/* Enough for the queued and current frames, and the frames still
+ * used by the renderer */
+#define MAX_FREE_BUFFERS (MAX_QUEUED_FRAMES + 3)
 
 struct _GtkVideoFrameFFMpeg
 {
@@ -53,9 +85,27 @@ struct _GtkFfMediaFile
   GdkMemoryFormat memory_format;
 
   GtkVideoFrameFFMpeg current_frame;
-  GtkVideoFrameFFMpeg next_frame;
-
-  gint64 start_time; /* monotonic time when we displayed the last frame */
+  GtkFfFramePool *frame_pool;
+  GError *read_error; /* error of the input stream, until it is reported */
+
+  /* While playing, frames are decoded in decode_thread, which owns the
+   * format and codec contexts until it is stopped. The fields below
+   * it are shared with the thread and protected by lock.
+   */
+  GThread *decode_thread;
+  GMutex lock;
+  GCond cond;
+  GQueue frames; /* decoded GtkVideoFrameFFMpeg, oldest first */
+  GError *decode_error;
+  guint stop_decoding : 1;
+  guint decoded_eof : 1;
+  guint waiting_for_frame : 1;
+  guint frame_ready_cb; /* Source ID of the idle queued by the thread */
+
+  GdkFrameClock *frame_clock; /* of the surface we were realized with */
+  gulong update_handler;
+
+  gint64 start_time; /* monotonic time when we displayed the first frame */
   guint next_frame_cb; /* Source ID of next frame callback */
 };
 
@@ -64,6 +114,99 @@ struct _GtkFfMediaFileClass
   GtkMediaFileClass parent_class;
 };
 
+static GtkFfFramePool *
+gtk_ff_frame_pool_new (void)
+{
+  GtkFfFramePool *pool;
+
+  pool = g_slice_new0 (GtkFfFramePool);
+  pool->ref_count = 1;
+  g_mutex_init (&pool->lock);
+
+  return pool;
+}
+
+static GtkFfFramePool *
+gtk_ff_frame_pool_ref (GtkFfFramePool *pool)
+{
+  g_atomic_int_inc (&pool->ref_count);
+
+  return pool;
+}
+
+static void
+gtk_ff_frame_pool_unref (GtkFfFramePool *pool)
+{
+  if (!g_atomic_int_dec_and_test (&pool->ref_count))
+    return;
+
+  g_slist_free_full (pool->free_buffers, g_free);
+  g_mutex_clear (&pool->lock);
+  g_slice_free (GtkFfFramePool, pool);
+}
+
+static GtkFfFrameBuffer *
+gtk_ff_frame_pool_acquire (GtkFfFramePool *pool,
+                           gsize           size)
+{
+  GtkFfFrameBuffer *buffer = NULL;
+
+  g_mutex_lock (&pool->lock);
+
+  /* The size of the video changed, the old buffers are of no use */
+  if (pool->size != size)
+    {
+      g_slist_free_full (pool->free_buffers, g_free);
+      pool->free_buffers = NULL;
+      pool->n_free_buffers = 0;
+      pool->size = size;
+    }
+
+  if (pool->free_buffers)
+    {
+      buffer = pool->free_buffers->data;
+      pool->free_buffers = g_slist_delete_link (pool->free_buffers, pool->free_buffers);
+      pool->n_free_buffers--;
+    }
+
+  g_mutex_unlock (&pool->lock);
+
+  if (buffer == NULL)
+    {
+      buffer = g_try_malloc (sizeof (GtkFfFrameBuffer) + size);
+      if (buffer == NULL)
+        return NULL;
+
+      buffer->size = size;
+    }
+
+  buffer->pool = gtk_ff_frame_pool_ref (pool);
+
+  return buffer;
+}
+
+static void
+gtk_ff_frame_buffer_release (gpointer data)
+{
+  GtkFfFrameBuffer *buffer = data;
+  GtkFfFramePool *pool = buffer->pool;
+
+  g_mutex_lock (&pool->lock);
+
+  if (buffer->size == pool->size &&
+      pool->n_free_buffers < MAX_FREE_BUFFERS)
+    {
+      pool->free_buffers = g_slist_prepend (pool->free_buffers, buffer);
+      pool->n_free_buffers++;
+      buffer = NULL;
+    }
+
+  g_mutex_unlock (&pool->lock);
+
+  g_free (buffer);
+  gtk_ff_frame_pool_unref (pool);
+}
+
 static void
 gtk_video_frame_ffmpeg_init (GtkVideoFrameFFMpeg *frame,
                              GdkTexture          *texture,
@@ -80,6 +223,13 @@ gtk_video_frame_ffmpeg_clear (GtkVideoFrameFFMpeg *frame)
   frame->timestamp = 0;
 }
 
+static void
+gtk_video_frame_ffmpeg_free (GtkVideoFrameFFMpeg *frame)
+{
+  gtk_video_frame_ffmpeg_clear (frame);
+  g_slice_free (GtkVideoFrameFFMpeg, frame);
+}
+
 static gboolean
 gtk_video_frame_ffmpeg_is_empty (GtkVideoFrameFFMpeg *frame)
 {
@@ -203,23 +353,26 @@ g_io_module_query (void)
   return g_strdupv (eps);
 }
 
+static GError *
+gtk_ff_media_file_error_from_ffmpeg (int av_errnum)
+{
+  char s[AV_ERROR_MAX_STRING_SIZE];
+
+  if (av_strerror (av_errnum, s, sizeof (s)) != 0)
+    snprintf (s, sizeof (s), _("Unspecified error decoding video"));
+
+  return g_error_new_literal (G_IO_ERROR, G_IO_ERROR_FAILED, s);
+}
+
 static void
 gtk_ff_media_file_set_ffmpeg_error (GtkFfMediaFile *video,
                                     int           av_errnum)
 {
-  char s[AV_ERROR_MAX_STRING_SIZE];
-
   if (gtk_media_stream_get_error (GTK_MEDIA_STREAM (video)))
     return;
 
-  if (av_strerror (av_errnum, s, sizeof (s) != 0))
-    snprintf (s, sizeof (s), _("Unspecified error decoding video"));
-
-  gtk_media_stream_error (GTK_MEDIA_STREAM (video),
-                          G_IO_ERROR,
-                          G_IO_ERROR_FAILED,
-                          "%s",
-                          s);
+  gtk_media_stream_gerror (GTK_MEDIA_STREAM (video),
+                           gtk_ff_media_file_error_from_ffmpeg (av_errnum));
 }
 
 static int
@@ -238,7 +391,13 @@ gtk_ff_media_file_read_packet_cb (void    *data,
                                 &error);
   if (n_read < 0)
     {
-      gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+      /* This may run in the decoding thread, so keep the error
+       * for whoever called into ffmpeg to report */
+      if (video->read_error == NULL)
+        video->read_error = error;
+      else
+        g_error_free (error);
+      n_read = AVERROR (EIO);
     }
   else if (n_read == 0)
     {
@@ -263,16 +422,22 @@ memory_format_from_pix_fmt (enum AVPixelFormat pix_fmt)
     }
 }
 
+/* Decodes the next frame into result. Returns FALSE at the end of
+ * the stream, with error set if decoding failed. This is called in
+ * the decoding thread while playing, so it must not touch the
+ * stream or paintable state. */
 static gboolean
-gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
-                                GtkVideoFrameFFMpeg *result)
+gtk_ff_media_file_decode_frame (GtkFfMediaFile       *video,
+                                GtkVideoFrameFFMpeg  *result,
+                                GError              **error)
 {
   GdkTexture *texture;
   AVPacket packet;
   AVFrame *frame;
   int errnum;
   GBytes *bytes;
-  guchar *data;
+  GtkFfFrameBuffer *buffer;
+  gsize size;
 
   frame = av_frame_alloc ();
 
@@ -283,18 +448,13 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
       if (packet.stream_index == video->stream_id)
         {
           errnum = avcodec_send_packet (video->codec_ctx, &packet);
-              if (errnum < 0)
-                G_BREAKPOINT();
           if (errnum >= 0)
+            errnum = avcodec_receive_frame (video->codec_ctx, frame);
+          /* EAGAIN means the decoder needs more packets for a frame */
+          if (errnum != AVERROR (EAGAIN))
             {
-              errnum = avcodec_receive_frame (video->codec_ctx, frame);
-              if (errnum < 0)
-                G_BREAKPOINT();
-              if (errnum >= 0)
-                {
-                  av_packet_unref (&packet);
-                  break;
-                }
+              av_packet_unref (&packet);
+              break;
             }
         }
 
@@ -303,19 +463,25 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
 
   if (errnum < 0)
     {
-      if (errnum != AVERROR_EOF)
-        gtk_ff_media_file_set_ffmpeg_error (video, errnum);
+      if (video->read_error)
+        g_propagate_error (error, g_steal_pointer (&video->read_error));
+      else if (errnum != AVERROR_EOF)
+        g_propagate_error (error, gtk_ff_media_file_error_from_ffmpeg (errnum));
       av_frame_free (&frame);
       return FALSE;
     }
 
-  data = g_try_malloc0 (video->codec_ctx->width * video->codec_ctx->height * 4);
-  if (data == NULL)
+  if (video->frame_pool == NULL)
+    video->frame_pool = gtk_ff_frame_pool_new ();
+
+  size = video->codec_ctx->width * video->codec_ctx->height * 4;
+  buffer = gtk_ff_frame_pool_acquire (video->frame_pool, size);
+  if (buffer == NULL)
     {
-      gtk_media_stream_error (GTK_MEDIA_STREAM (video),
-                              G_IO_ERROR,
-                              G_IO_ERROR_FAILED,
-                              _("Not enough memory"));
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_FAILED,
+                           _("Not enough memory"));
       av_frame_free (&frame);
       return FALSE;
     }
@@ -352,9 +518,10 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
   sws_scale(video->sws_ctx,
             (const uint8_t * const *) frame->data, frame->linesize,
             0, video->codec_ctx->height,
-            (uint8_t *[1]) { data }, (int[1]) { video->codec_ctx->width * 4 });
+            (uint8_t *[1]) { buffer->data }, (int[1]) { video->codec_ctx->width * 4 });
 
-  bytes = g_bytes_new_take (data, video->codec_ctx->width * video->codec_ctx->height * 4);
+  bytes = g_bytes_new_with_free_func (buffer->data, size,
+                                      gtk_ff_frame_buffer_release, buffer);
   texture = gdk_memory_texture_new (video->codec_ctx->width,
                                     video->codec_ctx->height,
                                     video->memory_format,
@@ -474,6 +641,23 @@ gtk_ff_media_file_create_io_context (GtkFfMediaFile *video)
 
 static gboolean gtk_ff_media_file_play (GtkMediaStream *stream);
 
+/* Decodes a frame on the main thread, used whenever no decoding thread
+ * runs, like after opening or seeking. */
+static void
+gtk_ff_media_file_decode_current_frame (GtkFfMediaFile *video)
+{
+  GError *error = NULL;
+
+  gtk_video_frame_ffmpeg_clear (&video->current_frame);
+
+  if (gtk_ff_media_file_decode_frame (video, &video->current_frame, &error))
+    gtk_media_stream_update (GTK_MEDIA_STREAM (video), video->current_frame.timestamp);
+  else if (error)
+    gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+
+  gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+}
+
 static void
 gtk_ff_media_file_open (GtkMediaFile *file)
 {
@@ -559,26 +743,125 @@ gtk_ff_media_file_open (GtkMediaFile *file)
 
   gdk_paintable_invalidate_size (GDK_PAINTABLE (video));
 
-  if (gtk_ff_media_file_decode_frame (video, &video->current_frame))
-    gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+  gtk_ff_media_file_decode_current_frame (video);
 
   if (gtk_media_stream_get_playing (GTK_MEDIA_STREAM (video)))
     gtk_ff_media_file_play (GTK_MEDIA_STREAM (video));
 }
 
+static gboolean
+gtk_ff_media_file_frame_ready_cb (gpointer data);
+
+static gpointer
+gtk_ff_media_file_decode_thread (gpointer data)
+{
+  GtkFfMediaFile *video = data;
+  GtkVideoFrameFFMpeg frame;
+  GError *error = NULL;
+  gboolean decoded = FALSE;
+
+  do
+    {
+      g_mutex_lock (&video->lock);
+      while (!video->stop_decoding &&
+             g_queue_get_length (&video->frames) >= MAX_QUEUED_FRAMES)
+        g_cond_wait (&video->cond, &video->lock);
+      if (video->stop_decoding)
+        {
+          g_mutex_unlock (&video->lock);
+          break;
+        }
+      g_mutex_unlock (&video->lock);
+
+      decoded = gtk_ff_media_file_decode_frame (video, &frame, &error);
+
+      g_mutex_lock (&video->lock);
+      if (decoded)
+        {
+          g_queue_push_tail (&video->frames, g_slice_dup (GtkVideoFrameFFMpeg, &frame));
+        }
+      else
+        {
+          video->decoded_eof = TRUE;
+          video->decode_error = error;
+        }
+      if (video->waiting_for_frame && video->frame_ready_cb == 0)
+        video->frame_ready_cb = g_idle_add (gtk_ff_media_file_frame_ready_cb, video);
+      g_mutex_unlock (&video->lock);
+    }
+  while (decoded);
+
+  return NULL;
+}
+
+static void
+gtk_ff_media_file_start_decoding (GtkFfMediaFile *video)
+{
+  if (video->decode_thread)
+    return;
+
+  video->stop_decoding = FALSE;
+  video->decoded_eof = FALSE;
+  video->decode_thread = g_thread_new ("gtk-ffmpeg-decoder",
+                                       gtk_ff_media_file_decode_thread,
+                                       video);
+}
+
+/* Waits for the decoding thread to finish the frame it is working
+ * on. The frames it queued are kept. */
+static void
+gtk_ff_media_file_stop_decoding (GtkFfMediaFile *video)
+{
+  if (video->decode_thread == NULL)
+    return;
+
+  g_mutex_lock (&video->lock);
+  video->stop_decoding = TRUE;
+  g_cond_signal (&video->cond);
+  g_mutex_unlock (&video->lock);
+
+  g_thread_join (video->decode_thread);
+  video->decode_thread = NULL;
+
+  video->waiting_for_frame = FALSE;
+  if (video->frame_ready_cb)
+    {
+      g_source_remove (video->frame_ready_cb);
+      video->frame_ready_cb = 0;
+    }
+}
+
+static void
+gtk_ff_media_file_clear_frames (GtkFfMediaFile *video)
+{
+  GtkVideoFrameFFMpeg *frame;
+
+  g_assert (video->decode_thread == NULL);
+
+  while ((frame = g_queue_pop_head (&video->frames)))
+    gtk_video_frame_ffmpeg_free (frame);
+
+  video->decoded_eof = FALSE;
+  g_clear_error (&video->decode_error);
+}
+
 static void
 gtk_ff_media_file_close (GtkMediaFile *file)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (file);
 
+  gtk_ff_media_file_stop_decoding (video);
+  gtk_ff_media_file_clear_frames (video);
+
   g_clear_object (&video->input_stream);
+  g_clear_error (&video->read_error);
 
   g_clear_pointer (&video->sws_ctx, sws_freeContext);
   g_clear_pointer (&video->codec_ctx, avcodec_close);
   avformat_close_input (&video->format_ctx);
   video->stream_id = -1;
-  gtk_video_frame_ffmpeg_clear (&video->next_frame);
   gtk_video_frame_ffmpeg_clear (&video->current_frame);
+  g_clear_pointer (&video->frame_pool, gtk_ff_frame_pool_unref);
 
   gdk_paintable_invalidate_size (GDK_PAINTABLE (video));
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
@@ -586,36 +869,146 @@ gtk_ff_media_file_close (GtkMediaFile *file)
 
 static gboolean
 gtk_ff_media_file_next_frame_cb (gpointer data);
+
+/* Without a frame clock, a timeout is used to show the next frame
+ * when it is due. If none is decoded yet, the decoding thread queues
+ * an idle for it once it is. */
 static void
 gtk_ff_media_file_queue_frame (GtkFfMediaFile *video)
 {
-  gint64 time, frame_time;
+  GtkVideoFrameFFMpeg *next;
+  gint64 time, frame_time = 0;
   guint delay;
 
+  if (video->frame_clock)
+    return;
+
+  g_mutex_lock (&video->lock);
+  next = g_queue_peek_head (&video->frames);
+  if (next)
+    frame_time = video->start_time + next->timestamp;
+  else
+    video->waiting_for_frame = TRUE;
+  g_mutex_unlock (&video->lock);
+
+  if (next == NULL)
+    return;
+
   time = g_get_monotonic_time ();
-  frame_time = video->start_time + video->next_frame.timestamp;
   delay = time > frame_time ? 0 : (frame_time - time) / 1000;
 
   video->next_frame_cb = g_timeout_add (delay, gtk_ff_media_file_next_frame_cb, video);
 }
 
 static gboolean
-gtk_ff_media_file_restart (GtkFfMediaFile *video)
+gtk_ff_media_file_rewind (GtkFfMediaFile *video,
+                          gint64          timestamp)
 {
   if (av_seek_frame (video->format_ctx,
                      video->stream_id,
-                     av_rescale_q (0,
+                     av_rescale_q (timestamp,
                                    (AVRational) { 1, G_USEC_PER_SEC },
                                    video->format_ctx->streams[video->stream_id]->time_base),
                      AVSEEK_FLAG_BACKWARD) < 0)
     return FALSE;
 
-  if (!gtk_ff_media_file_decode_frame (video, &video->next_frame))
+  avcodec_flush_buffers (video->codec_ctx);
+
+  return TRUE;
+}
+
+/* Starts over at the beginning, with the first frame queued */
+static gboolean
+gtk_ff_media_file_restart (GtkFfMediaFile *video)
+{
+  GtkVideoFrameFFMpeg frame;
+
+  gtk_ff_media_file_stop_decoding (video);
+  gtk_ff_media_file_clear_frames (video);
+
+  if (!gtk_ff_media_file_rewind (video, 0))
+    return FALSE;
+
+  if (!gtk_ff_media_file_decode_frame (video, &frame, NULL))
     return FALSE;
 
+  g_queue_push_tail (&video->frames, g_slice_dup (GtkVideoFrameFFMpeg, &frame));
+
   return TRUE;
 }
 
+/* Shows the latest decoded frame that is due at time, dropping the
+ * ones before it that could not be shown in time. Returns FALSE when
+ * there are no more frames. */
+static gboolean
+gtk_ff_media_file_advance (GtkFfMediaFile *video,
+                           gint64          time)
+{
+  GtkVideoFrameFFMpeg *frame = NULL;
+  GtkVideoFrameFFMpeg *next;
+  GError *error = NULL;
+  gboolean more;
+
+  g_mutex_lock (&video->lock);
+
+  while ((next = g_queue_peek_head (&video->frames)) &&
+         video->start_time + next->timestamp <= time)
+    {
+      g_clear_pointer (&frame, gtk_video_frame_ffmpeg_free);
+      frame = g_queue_pop_head (&video->frames);
+    }
+
+  more = frame != NULL || !video->decoded_eof || !g_queue_is_empty (&video->frames);
+  if (!more)
+    error = g_steal_pointer (&video->decode_error);
+
+  g_cond_signal (&video->cond);
+  g_mutex_unlock (&video->lock);
+
+  if (error)
+    gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+
+  if (frame)
+    {
+      gtk_video_frame_ffmpeg_clear (&video->current_frame);
+      gtk_video_frame_ffmpeg_move (&video->current_frame, frame);
+      g_slice_free (GtkVideoFrameFFMpeg, frame);
+
+      gtk_media_stream_update (GTK_MEDIA_STREAM (video),
+                               video->current_frame.timestamp);
+      gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+    }
+
+  return more;
+}
+
+static void
+gtk_ff_media_file_tick (GtkFfMediaFile *video,
+                        gint64          time)
+{
+  GtkVideoFrameFFMpeg *first;
+
+  if (gtk_ff_media_file_advance (video, time))
+    return;
+
+  if (gtk_media_stream_get_error (GTK_MEDIA_STREAM (video)))
+    return;
+
+  if (!gtk_media_stream_get_loop (GTK_MEDIA_STREAM (video)) ||
+      !gtk_ff_media_file_restart (video))
+    {
+      gtk_media_stream_ended (GTK_MEDIA_STREAM (video));
+      return;
+    }
+
+  /* Show the first frame right after the last one */
+  first = g_queue_peek_head (&video->frames);
+  video->start_time += video->current_frame.timestamp - first->timestamp;
+
+  gtk_ff_media_file_start_decoding (video);
+  gtk_ff_media_file_advance (video, time);
+}
+
 static gboolean
 gtk_ff_media_file_next_frame_cb (gpointer data)
 {
@@ -623,34 +1016,80 @@ gtk_ff_media_file_next_frame_cb (gpointer data)
 
   video->next_frame_cb = 0;
 
-  if (gtk_video_frame_ffmpeg_is_empty (&video->next_frame))
-    {
-      if (!gtk_media_stream_get_loop (GTK_MEDIA_STREAM (video)) ||
-          !gtk_ff_media_file_restart (video))
-        {
-          gtk_media_stream_ended (GTK_MEDIA_STREAM (video));
-          return G_SOURCE_REMOVE;
-        }
+  gtk_ff_media_file_tick (video, g_get_monotonic_time ());
 
-      video->start_time += video->current_frame.timestamp - video->next_frame.timestamp;
-    }
+  if (gtk_media_stream_get_playing (GTK_MEDIA_STREAM (video)))
+    gtk_ff_media_file_queue_frame (video);
 
-  gtk_video_frame_ffmpeg_clear (&video->current_frame);
-  gtk_video_frame_ffmpeg_move (&video->current_frame,
-                               &video->next_frame);
+  return G_SOURCE_REMOVE;
+}
 
-  gtk_media_stream_update (GTK_MEDIA_STREAM (video),
-                           video->current_frame.timestamp);
-  gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+static gboolean
+gtk_ff_media_file_frame_ready_cb (gpointer data)
+{
+  GtkFfMediaFile *video = data;
+
+  g_mutex_lock (&video->lock);
+  video->frame_ready_cb = 0;
+  video->waiting_for_frame = FALSE;
+  g_mutex_unlock (&video->lock);
 
-  /* ignore failure here, we'll handle the empty frame case above
-   * the next time we're called. */
-  gtk_ff_media_file_decode_frame (video, &video->next_frame);
-  gtk_ff_media_file_queue_frame (video);
+  if (video->next_frame_cb == 0)
+    gtk_ff_media_file_next_frame_cb (video);
 
   return G_SOURCE_REMOVE;
 }
 
+/* With a frame clock, frames are picked for the time they will
+ * actually be on screen, not for the time they are drawn. */
+static void
+gtk_ff_media_file_frame_clock_update (GdkFrameClock  *frame_clock,
+                                      GtkFfMediaFile *video)
+{
+  gint64 frame_time, presentation_time;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time, NULL, &presentation_time);
+  if (presentation_time == 0)
+    presentation_time = frame_time;
+
+  gtk_ff_media_file_tick (video, presentation_time);
+}
+
+static void
+gtk_ff_media_file_start_updates (GtkFfMediaFile *video)
+{
+  if (video->frame_clock == NULL)
+    {
+      gtk_ff_media_file_queue_frame (video);
+      return;
+    }
+
+  if (video->update_handler)
+    return;
+
+  video->update_handler = g_signal_connect (video->frame_clock, "update",
+                                            G_CALLBACK (gtk_ff_media_file_frame_clock_update), video);
+  gdk_frame_clock_begin_updating (video->frame_clock);
+}
+
+static void
+gtk_ff_media_file_stop_updates (GtkFfMediaFile *video)
+{
+  if (video->next_frame_cb)
+    {
+      g_source_remove (video->next_frame_cb);
+      video->next_frame_cb = 0;
+    }
+
+  if (video->update_handler)
+    {
+      g_signal_handler_disconnect (video->frame_clock, video->update_handler);
+      video->update_handler = 0;
+      gdk_frame_clock_end_updating (video->frame_clock);
+    }
+}
+
 static gboolean
 gtk_ff_media_file_play (GtkMediaStream *stream)
 {
@@ -662,24 +1101,23 @@ gtk_ff_media_file_play (GtkMediaStream *stream)
   if (!gtk_media_stream_is_prepared (stream))
     return TRUE;
 
-  if (gtk_video_frame_ffmpeg_is_empty (&video->next_frame) &&
-      !gtk_ff_media_file_decode_frame (video, &video->next_frame))
+  if (video->decoded_eof && g_queue_is_empty (&video->frames))
     {
-      if (gtk_ff_media_file_restart (video))
-        {
-          video->start_time = g_get_monotonic_time () - video->next_frame.timestamp;
-        }
-      else
-        {
-          return FALSE;
-        }
+      GtkVideoFrameFFMpeg *first;
+
+      if (!gtk_ff_media_file_restart (video))
+        return FALSE;
+
+      first = g_queue_peek_head (&video->frames);
+      video->start_time = g_get_monotonic_time () - first->timestamp;
     }
   else
     {
       video->start_time = g_get_monotonic_time () - video->current_frame.timestamp;
     }
 
-  gtk_ff_media_file_queue_frame (video);
+  gtk_ff_media_file_start_decoding (video);
+  gtk_ff_media_file_start_updates (video);
 
   return TRUE;
 }
@@ -689,11 +1127,8 @@ gtk_ff_media_file_pause (GtkMediaStream *stream)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
 
-  if (video->next_frame_cb)
-    {
-      g_source_remove (video->next_frame_cb);
-      video->next_frame_cb = 0;
-    }
+  gtk_ff_media_file_stop_updates (video);
+  gtk_ff_media_file_stop_decoding (video);
 
   video->start_time = 0;
 }
@@ -703,36 +1138,68 @@ gtk_ff_media_file_seek (GtkMediaStream *stream,
                         gint64          timestamp)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
-  int errnum;
 
-  errnum = av_seek_frame (video->format_ctx,
-                          video->stream_id,
-                          av_rescale_q (timestamp,
-                                        (AVRational) { 1, G_USEC_PER_SEC },
-                                        video->format_ctx->streams[video->stream_id]->time_base),
-                                        AVSEEK_FLAG_BACKWARD);
-  if (errnum < 0)
+  gtk_ff_media_file_stop_updates (video);
+  gtk_ff_media_file_stop_decoding (video);
+  gtk_ff_media_file_clear_frames (video);
+
+  if (!gtk_ff_media_file_rewind (video, timestamp))
     {
       gtk_media_stream_seek_failed (stream);
+      if (gtk_media_stream_get_playing (stream))
+        gtk_ff_media_file_play (stream);
       return;
     }
 
   gtk_media_stream_seek_success (stream);
 
-  gtk_video_frame_ffmpeg_clear (&video->next_frame);
-  gtk_video_frame_ffmpeg_clear (&video->current_frame);
-  if (gtk_ff_media_file_decode_frame (video, &video->current_frame))
-    gtk_media_stream_update (stream, video->current_frame.timestamp);
-  gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+  gtk_ff_media_file_decode_current_frame (video);
 
   if (gtk_media_stream_get_playing (stream))
     {
-      gtk_ff_media_file_pause (stream);
       if (!gtk_ff_media_file_play (stream))
         gtk_media_stream_ended (stream);
     }
 }
 
+static void
+gtk_ff_media_file_realize (GtkMediaStream *stream,
+                           GdkSurface     *surface)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
+
+  /* Only the first surface is used for timing */
+  if (video->frame_clock)
+    return;
+
+  video->frame_clock = g_object_ref (gdk_surface_get_frame_clock (surface));
+
+  if (gtk_media_stream_get_playing (stream) && video->start_time != 0)
+    {
+      gtk_ff_media_file_stop_updates (video);
+      gtk_ff_media_file_start_updates (video);
+    }
+}
+
+static void
+gtk_ff_media_file_unrealize (GtkMediaStream *stream,
+                             GdkSurface     *surface)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
+  gboolean updating;
+
+  if (video->frame_clock == NULL ||
+      video->frame_clock != gdk_surface_get_frame_clock (surface))
+    return;
+
+  updating = video->update_handler != 0;
+  gtk_ff_media_file_stop_updates (video);
+  g_clear_object (&video->frame_clock);
+
+  if (updating)
+    gtk_ff_media_file_start_updates (video);
+}
+
 static void
 gtk_ff_media_file_dispose (GObject *object)
 {
@@ -740,10 +1207,22 @@ gtk_ff_media_file_dispose (GObject *object)
 
   gtk_ff_media_file_pause (GTK_MEDIA_STREAM (video));
   gtk_ff_media_file_close (GTK_MEDIA_FILE (video));
+  g_clear_object (&video->frame_clock);
 
   G_OBJECT_CLASS (gtk_ff_media_file_parent_class)->dispose (object);
 }
 
+static void
+gtk_ff_media_file_finalize (GObject *object)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (object);
+
+  g_mutex_clear (&video->lock);
+  g_cond_clear (&video->cond);
+
+  G_OBJECT_CLASS (gtk_ff_media_file_parent_class)->finalize (object);
+}
+
 static void
 gtk_ff_media_file_class_init (GtkFfMediaFileClass *klass)
 {
@@ -756,14 +1235,18 @@ gtk_ff_media_file_class_init (GtkFfMediaFileClass *klass)
   stream_class->play = gtk_ff_media_file_play;
   stream_class->pause = gtk_ff_media_file_pause;
   stream_class->seek = gtk_ff_media_file_seek;
+  stream_class->realize = gtk_ff_media_file_realize;
+  stream_class->unrealize = gtk_ff_media_file_unrealize;
 
   gobject_class->dispose = gtk_ff_media_file_dispose;
+  gobject_class->finalize = gtk_ff_media_file_finalize;
 }
 
 static void
 gtk_ff_media_file_init (GtkFfMediaFile *video)
 {
   video->stream_id = -1;
+  g_mutex_init (&video->lock);
+  g_cond_init (&video->cond);
+  g_queue_init (&video->frames);
 }
-
-
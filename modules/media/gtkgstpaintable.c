@@ -30,6 +30,8 @@ struct _GtkGstPaintable
   GObject parent_instance;
 
   GdkPaintable *image;
+
+  GdkGLContext *context;
 };
 
 struct _GtkGstPaintableClass
@@ -108,10 +110,27 @@ gtk_gst_paintable_video_renderer_create_video_sink (GstPlayerVideoRenderer *rend
                                                     GstPlayer              *player)
 {
   GtkGstPaintable *self = GTK_GST_PAINTABLE (renderer);
+  GstElement *sink, *glsinkbin;
 
-  return g_object_new (GTK_TYPE_GST_SINK,
+  sink = g_object_new (GTK_TYPE_GST_SINK,
                        "paintable", self,
+                       "gl-context", self->context,
                        NULL);
+
+  if (self->context == NULL)
+    return sink;
+
+  /* glsinkbin uploads and converts whatever the decoder produces,
+   * importing dmabufs directly, so frames reach the sink as GL
+   * textures.
+   */
+  glsinkbin = gst_element_factory_make ("glsinkbin", NULL);
+  if (glsinkbin == NULL)
+    return sink;
+
+  g_object_set (glsinkbin, "sink", sink, NULL);
+
+  return glsinkbin;
 }
 
 static void
@@ -132,6 +151,7 @@ gtk_gst_paintable_dispose (GObject *object)
   GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
   
   g_clear_object (&self->image);
+  g_clear_object (&self->context);
 
   G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->dispose (object);
 }
@@ -155,6 +175,47 @@ gtk_gst_paintable_new (void)
   return g_object_new (GTK_TYPE_GST_PAINTABLE, NULL);
 }
 
+void
+gtk_gst_paintable_realize (GtkGstPaintable *self,
+                           GdkSurface      *surface)
+{
+  GError *error = NULL;
+
+  if (self->context)
+    return;
+
+  self->context = gdk_surface_create_gl_context (surface, &error);
+  if (self->context == NULL)
+    {
+      GST_INFO ("failed to create GDK GL context: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  if (!gdk_gl_context_realize (self->context, &error))
+    {
+      GST_INFO ("failed to realize GDK GL context: %s", error->message);
+      g_clear_object (&self->context);
+      g_error_free (error);
+      return;
+    }
+}
+
+void
+gtk_gst_paintable_unrealize (GtkGstPaintable *self,
+                             GdkSurface      *surface)
+{
+  /* XXX: We could be smarter here and:
+   * - track how often we were realized with that surface
+   * - track alternate surfaces
+   */
+  if (self->context == NULL)
+    return;
+
+  if (gdk_gl_context_get_surface (self->context) == surface)
+    g_clear_object (&self->context);
+}
+
 static void
 gtk_gst_paintable_set_paintable (GtkGstPaintable *self,
                                  GdkPaintable    *paintable)
@@ -30,6 +30,11 @@ G_DECLARE_FINAL_TYPE (GtkGstPaintable, gtk_gst_paintable, GTK, GST_PAINTABLE, GO
 
 GdkPaintable *  gtk_gst_paintable_new                   (void);
 
+void            gtk_gst_paintable_realize               (GtkGstPaintable        *self,
+                                                         GdkSurface             *surface);
+void            gtk_gst_paintable_unrealize             (GtkGstPaintable        *self,
+                                                         GdkSurface             *surface);
+
 void            gtk_gst_paintable_queue_set_texture     (GtkGstPaintable        *self,
                                                          GdkTexture             *texture);
 
@@ -25,9 +25,20 @@
 #include "gtkgstpaintableprivate.h"
 #include "gtkintl.h"
 
+#if GST_GL_HAVE_WINDOW_X11 && GST_GL_HAVE_PLATFORM_GLX && defined (GDK_WINDOWING_X11)
+#include <gdk/x11/gdkx.h>
+#include <gst/gl/x11/gstgldisplay_x11.h>
+#endif
+
+#if GST_GL_HAVE_WINDOW_WAYLAND && GST_GL_HAVE_PLATFORM_EGL && defined (GDK_WINDOWING_WAYLAND)
+#include <gdk/wayland/gdkwayland.h>
+#include <gst/gl/wayland/gstgldisplay_wayland.h>
+#endif
+
 enum {
   PROP_0,
   PROP_PAINTABLE,
+  PROP_GL_CONTEXT,
 
   N_PROPS,
 };
@@ -41,7 +52,8 @@ static GstStaticPadTemplate gtk_gst_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (FORMATS))
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE_WITH_FEATURES (GST_CAPS_FEATURE_MEMORY_GL_MEMORY, "RGBA") "; "
+                     GST_VIDEO_CAPS_MAKE (FORMATS))
     );
 
 G_DEFINE_TYPE_WITH_CODE (GtkGstSink, gtk_gst_sink,
@@ -75,6 +87,40 @@ gtk_gst_sink_get_times (GstBaseSink * bsink, GstBuffer * buf,
   }
 }
 
+static GstCaps *
+gtk_gst_sink_get_caps (GstBaseSink *bsink,
+                       GstCaps     *filter)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+  GstCaps *tmp;
+  GstCaps *result;
+
+  tmp = gst_pad_get_pad_template_caps (GST_BASE_SINK_PAD (bsink));
+
+  if (self->gst_context == NULL)
+    {
+      /* Without a GL context only the system memory caps remain */
+      tmp = gst_caps_make_writable (tmp);
+      gst_caps_remove_structure (tmp, 0);
+    }
+
+  if (filter)
+    {
+      GST_DEBUG_OBJECT (bsink, "intersecting with filter caps %" GST_PTR_FORMAT, filter);
+
+      result = gst_caps_intersect_full (filter, tmp, GST_CAPS_INTERSECT_FIRST);
+      gst_caps_unref (tmp);
+    }
+  else
+    {
+      result = tmp;
+    }
+
+  GST_DEBUG_OBJECT (bsink, "returning caps: %" GST_PTR_FORMAT, result);
+
+  return result;
+}
+
 static gboolean
 gtk_gst_sink_set_caps (GstBaseSink * bsink, GstCaps * caps)
 {
@@ -88,6 +134,90 @@ gtk_gst_sink_set_caps (GstBaseSink * bsink, GstCaps * caps)
   return TRUE;
 }
 
+static gboolean
+gtk_gst_sink_query (GstBaseSink *bsink,
+                    GstQuery    *query)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CONTEXT &&
+      self->gst_display != NULL &&
+      gst_gl_handle_context_query (GST_ELEMENT (self), query, self->gst_display, self->gst_context, self->gst_app_context))
+    return TRUE;
+
+  return GST_BASE_SINK_CLASS (gtk_gst_sink_parent_class)->query (bsink, query);
+}
+
+/* For GL memory, offers upstream a pool sized for the frames the sink
+ * holds on to: one that is on screen, one that is queued to replace
+ * it, and one that is being decoded. Buffers go back to the pool when
+ * the texture wrapping them is released, so steady playback does not
+ * allocate.
+ */
+static gboolean
+gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
+                                 GstQuery    *query)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstCaps *caps;
+  GstVideoInfo info;
+  guint size;
+  gboolean need_pool;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+
+  if (caps == NULL)
+    {
+      GST_DEBUG_OBJECT (bsink, "no caps specified");
+      return FALSE;
+    }
+
+  if (!gst_video_info_from_caps (&info, caps))
+    {
+      GST_DEBUG_OBJECT (bsink, "invalid caps specified");
+      return FALSE;
+    }
+
+  /* the normal size of a frame */
+  size = info.size;
+
+  if (gst_caps_features_contains (gst_caps_get_features (caps, 0), GST_CAPS_FEATURE_MEMORY_GL_MEMORY))
+    {
+      if (self->gst_context == NULL)
+        return FALSE;
+
+      if (need_pool)
+        {
+          GST_DEBUG_OBJECT (self, "create new GL pool");
+          pool = gst_gl_buffer_pool_new (self->gst_context);
+
+          config = gst_buffer_pool_get_config (pool);
+          gst_buffer_pool_config_set_params (config, caps, size, 0, 0);
+          gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_GL_SYNC_META);
+
+          if (!gst_buffer_pool_set_config (pool, config))
+            {
+              GST_DEBUG_OBJECT (bsink, "failed setting config");
+              gst_object_unref (pool);
+              return FALSE;
+            }
+        }
+
+      gst_query_add_allocation_pool (query, pool, size, 3, 0);
+      if (pool)
+        gst_object_unref (pool);
+
+      if (self->gst_context->gl_vtable->FenceSync)
+        gst_query_add_allocation_meta (query, GST_GL_SYNC_META_API_TYPE, NULL);
+    }
+
+  gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+  return TRUE;
+}
+
 static GdkMemoryFormat
 gtk_gst_memory_format_from_video (GstVideoFormat format)
 {
@@ -111,28 +241,63 @@ gtk_gst_memory_format_from_video (GstVideoFormat format)
   }
 }
 
+static void
+video_frame_free (GstVideoFrame *frame)
+{
+  gst_video_frame_unmap (frame);
+  g_free (frame);
+}
+
+/* The frame stays mapped, and so its buffer stays out of the pool,
+ * until the texture that wraps it is released. */
 static GdkTexture *
 gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
                                   GstBuffer  *buffer)
 {
-  GstVideoFrame frame;
+  GstVideoFrame *frame = g_new (GstVideoFrame, 1);
   GdkTexture *texture;
-  GBytes *bytes;
-
-  if (!gst_video_frame_map (&frame, &self->v_info, buffer, GST_MAP_READ))
-    return NULL;
-
-  bytes = g_bytes_new_with_free_func (frame.data[0],
-                                      frame.info.width * frame.info.stride[0],
-                                      (GDestroyNotify) gst_buffer_unref,
-                                      gst_buffer_ref (buffer));
-  texture = gdk_memory_texture_new (frame.info.width,
-                                    frame.info.height,
-                                    gtk_gst_memory_format_from_video (GST_VIDEO_FRAME_FORMAT (&frame)),
-                                    bytes,
-                                    frame.info.stride[0]);
-  g_bytes_unref (bytes);
-  gst_video_frame_unmap (&frame);
+
+  if (self->gdk_context &&
+      gst_is_gl_memory (gst_buffer_peek_memory (buffer, 0)) &&
+      gst_video_frame_map (frame, &self->v_info, buffer, GST_MAP_READ | GST_MAP_GL))
+    {
+      GstGLSyncMeta *sync_meta;
+
+      sync_meta = gst_buffer_get_gl_sync_meta (buffer);
+      if (sync_meta)
+        {
+          gst_gl_sync_meta_set_sync_point (sync_meta, self->gst_context);
+          gst_gl_sync_meta_wait (sync_meta, self->gst_context);
+        }
+
+      texture = gdk_gl_texture_new (self->gdk_context,
+                                    *(guint *) frame->data[0],
+                                    frame->info.width,
+                                    frame->info.height,
+                                    (GDestroyNotify) video_frame_free,
+                                    frame);
+    }
+  else if (gst_video_frame_map (frame, &self->v_info, buffer, GST_MAP_READ))
+    {
+      GBytes *bytes;
+
+      bytes = g_bytes_new_with_free_func (frame->data[0],
+                                          frame->info.height * frame->info.stride[0],
+                                          (GDestroyNotify) video_frame_free,
+                                          frame);
+      texture = gdk_memory_texture_new (frame->info.width,
+                                        frame->info.height,
+                                        gtk_gst_memory_format_from_video (GST_VIDEO_FRAME_FORMAT (frame)),
+                                        bytes,
+                                        frame->info.stride[0]);
+      g_bytes_unref (bytes);
+    }
+  else
+    {
+      GST_ERROR_OBJECT (self, "Could not convert buffer to texture.");
+      texture = NULL;
+      g_free (frame);
+    }
 
   return texture;
 }
@@ -161,6 +326,114 @@ gtk_gst_sink_show_frame (GstVideoSink * vsink, GstBuffer * buf)
   return GST_FLOW_OK;
 }
 
+static gboolean
+gtk_gst_sink_initialize_gl (GtkGstSink *self)
+{
+  GdkDisplay *display;
+  GError *error = NULL;
+
+  display = gdk_gl_context_get_display (self->gdk_context);
+
+  gdk_gl_context_make_current (self->gdk_context);
+
+#if GST_GL_HAVE_WINDOW_X11 && GST_GL_HAVE_PLATFORM_GLX && defined (GDK_WINDOWING_X11)
+  if (GDK_IS_X11_DISPLAY (display))
+    {
+      GstGLPlatform platform = GST_GL_PLATFORM_GLX;
+      GstGLAPI gl_api;
+      guintptr gl_handle;
+
+      GST_DEBUG_OBJECT (self, "got GLX context");
+      self->gst_display = GST_GL_DISPLAY (gst_gl_display_x11_new_with_display (gdk_x11_display_get_xdisplay (display)));
+
+      gl_api = gst_gl_context_get_current_gl_api (platform, NULL, NULL);
+      gl_handle = gst_gl_context_get_current_gl_context (platform);
+      if (gl_handle)
+        self->gst_app_context = gst_gl_context_new_wrapped (self->gst_display, gl_handle, platform, gl_api);
+    }
+  else
+#endif
+#if GST_GL_HAVE_WINDOW_WAYLAND && GST_GL_HAVE_PLATFORM_EGL && defined (GDK_WINDOWING_WAYLAND)
+  if (GDK_IS_WAYLAND_DISPLAY (display))
+    {
+      GstGLPlatform platform = GST_GL_PLATFORM_EGL;
+      GstGLAPI gl_api;
+      guintptr gl_handle;
+
+      GST_DEBUG_OBJECT (self, "got EGL on Wayland");
+      self->gst_display = GST_GL_DISPLAY (gst_gl_display_wayland_new_with_display (gdk_wayland_display_get_wl_display (display)));
+
+      gl_api = gst_gl_context_get_current_gl_api (platform, NULL, NULL);
+      gl_handle = gst_gl_context_get_current_gl_context (platform);
+      if (gl_handle)
+        self->gst_app_context = gst_gl_context_new_wrapped (self->gst_display, gl_handle, platform, gl_api);
+    }
+  else
+#endif
+    {
+      GST_INFO_OBJECT (self, "Unsupported GDK display %s for GL", G_OBJECT_TYPE_NAME (display));
+    }
+
+  if (self->gst_app_context == NULL)
+    {
+      GST_INFO_OBJECT (self, "Could not wrap GdkGLContext, using system memory");
+      gdk_gl_context_clear_current ();
+      g_clear_object (&self->gst_display);
+      return FALSE;
+    }
+
+  gst_gl_context_activate (self->gst_app_context, TRUE);
+
+  if (!gst_gl_context_fill_info (self->gst_app_context, &error))
+    {
+      GST_ERROR_OBJECT (self, "failed to retrieve GDK context info: %s", error->message);
+      g_clear_error (&error);
+      gst_gl_context_activate (self->gst_app_context, FALSE);
+      gdk_gl_context_clear_current ();
+      g_clear_object (&self->gst_app_context);
+      g_clear_object (&self->gst_display);
+      return FALSE;
+    }
+
+  gdk_gl_context_clear_current ();
+  gst_gl_context_activate (self->gst_app_context, FALSE);
+
+  if (!gst_gl_display_create_context (self->gst_display, self->gst_app_context, &self->gst_context, &error))
+    {
+      GST_ERROR_OBJECT (self, "Couldn't create GL context: %s", error->message);
+      g_error_free (error);
+      g_clear_object (&self->gst_app_context);
+      g_clear_object (&self->gst_display);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_gst_sink_start (GstBaseSink *bsink)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+
+  /* Fall back to system memory if the GDK context can't be shared */
+  if (self->gdk_context && !gtk_gst_sink_initialize_gl (self))
+    g_clear_object (&self->gdk_context);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_gst_sink_stop (GstBaseSink *bsink)
+{
+  GtkGstSink *self = GTK_GST_SINK (bsink);
+
+  g_clear_object (&self->gst_context);
+  g_clear_object (&self->gst_app_context);
+  g_clear_object (&self->gst_display);
+
+  return TRUE;
+}
+
 static void
 gtk_gst_sink_set_property (GObject      *object,
                            guint         prop_id,
@@ -178,6 +451,10 @@ gtk_gst_sink_set_property (GObject      *object,
         self->paintable = GTK_GST_PAINTABLE (gtk_gst_paintable_new ());
       break;
 
+    case PROP_GL_CONTEXT:
+      self->gdk_context = g_value_dup_object (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -198,6 +475,10 @@ gtk_gst_sink_get_property (GObject    *object,
       g_value_set_object (value, self->paintable);
       break;
 
+    case PROP_GL_CONTEXT:
+      g_value_set_object (value, self->gdk_context);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -210,6 +491,10 @@ gtk_gst_sink_dispose (GObject *object)
   GtkGstSink *self = GTK_GST_SINK (object);
 
   g_clear_object (&self->paintable);
+  g_clear_object (&self->gst_context);
+  g_clear_object (&self->gst_app_context);
+  g_clear_object (&self->gst_display);
+  g_clear_object (&self->gdk_context);
 
   G_OBJECT_CLASS (gtk_gst_sink_parent_class)->dispose (object);
 }
@@ -228,6 +513,11 @@ gtk_gst_sink_class_init (GtkGstSinkClass * klass)
 
   gstbasesink_class->set_caps = gtk_gst_sink_set_caps;
   gstbasesink_class->get_times = gtk_gst_sink_get_times;
+  gstbasesink_class->get_caps = gtk_gst_sink_get_caps;
+  gstbasesink_class->query = gtk_gst_sink_query;
+  gstbasesink_class->propose_allocation = gtk_gst_sink_propose_allocation;
+  gstbasesink_class->start = gtk_gst_sink_start;
+  gstbasesink_class->stop = gtk_gst_sink_stop;
 
   gstvideosink_class->show_frame = gtk_gst_sink_show_frame;
 
@@ -243,6 +533,19 @@ gtk_gst_sink_class_init (GtkGstSinkClass * klass)
                          GTK_TYPE_GST_PAINTABLE,
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkGstSink:gl-context:
+   *
+   * The GL context to use for creating textures, or %NULL to only
+   * accept frames in system memory.
+   */
+  properties[PROP_GL_CONTEXT] =
+    g_param_spec_object ("gl-context",
+                         P_("GL context"),
+                         P_("GL context to use for rendering"),
+                         GDK_TYPE_GL_CONTEXT,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 
   gst_element_class_set_metadata (gstelement_class,
@@ -0,0 +1,45 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <stdlib.h>
+#include "benchmark.h"
+
+static int
+compare_doubles (gconstpointer a,
+                 gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+void
+benchmark_sort (double *samples,
+                guint   n_samples)
+{
+  qsort (samples, n_samples, sizeof (double), compare_doubles);
+}
+
+/* Returns the median of BENCHMARK_N_RUNS calls to @func, after one
+ * call for warmup. If @warmup is not %NULL, the value of the warmup
+ * call is stored there. */
+double
+benchmark_median (BenchmarkFunc  func,
+                  gpointer       data,
+                  double        *warmup)
+{
+  double samples[BENCHMARK_N_RUNS];
+  double first;
+  int run;
+
+  first = func (data);
+  if (warmup)
+    *warmup = first;
+
+  for (run = 0; run < BENCHMARK_N_RUNS; run++)
+    samples[run] = func (data);
+
+  benchmark_sort (samples, BENCHMARK_N_RUNS);
+
+  return samples[BENCHMARK_N_RUNS / 2];
+}
@@ -0,0 +1,18 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <glib.h>
+
+/* Number of measured runs, not counting the one for warmup */
+#define BENCHMARK_N_RUNS 5
+
+/* Runs the benchmark once and returns the measured value */
+typedef double (* BenchmarkFunc) (gpointer data);
+
+double benchmark_median (BenchmarkFunc  func,
+                         gpointer       data,
+                         double        *warmup);
+void   benchmark_sort   (double        *samples,
+                         guint          n_samples);
+
+#endif /* __BENCHMARK_H__ */
@@ -2,6 +2,12 @@
 
 #include <gsk/gskcairoblurprivate.h>
 
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#define MAX_RADIUS 100
+
 static void
 init_surface (cairo_t *cr)
 {
@@ -9,45 +15,88 @@ init_surface (cairo_t *cr)
   int h = cairo_image_surface_get_height (cairo_get_target (cr));
 
   cairo_set_source_rgb (cr, 0, 0, 0);
-  cairo_fill (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
 
   cairo_set_source_rgb (cr, 1, 1, 1);
   cairo_arc (cr, w/2, h/2, w/2, 0, 2*G_PI);
   cairo_fill (cr);
 }
 
+typedef struct
+{
+  cairo_t      *cr;
+  GTimer       *timer;
+  int           radius;
+  GskBlurFlags  flags;
+} BlurRun;
+
+/* Returns the time of one blur in msec. The surface is reset first,
+ * so every run blurs the same data. */
+static double
+run_blur (gpointer data)
+{
+  BlurRun *run = data;
+  cairo_surface_t *surface = cairo_get_target (run->cr);
+
+  init_surface (run->cr);
+  cairo_surface_flush (surface);
+
+  g_timer_start (run->timer);
+  gsk_cairo_blur_surface (surface, run->radius, run->flags);
+
+  return g_timer_elapsed (run->timer, NULL) * 1000;
+}
+
+/* Returns the median time of the blurs in msec */
+static double
+time_blur (cairo_t      *cr,
+           GTimer       *timer,
+           int           radius,
+           GskBlurFlags  flags)
+{
+  BlurRun run = { cr, timer, radius, flags };
+
+  return benchmark_median (run_blur, &run, NULL);
+}
+
 int
 main (int argc, char **argv)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
   GTimer *timer;
-  double msec;
-  int i, j;
+  double x, y, xy;
+  int radius, step;
   int size;
 
-  timer = g_timer_new ();
+  /* Usage: blur-performance [SIZE [STEP]] */
+  size = argc > 1 ? atoi (argv[1]) : 2000;
+  step = argc > 2 ? MAX (atoi (argv[2]), 1) : 1;
 
-  size = 2000;
+  timer = g_timer_new ();
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_A8, size, size);
 
   cr = cairo_create (surface);
 
-  /* We do everything three times, first two as warmup */
-  for (j = 0; j < 2; j++)
+  g_print ("# %dx%d pixels, median of %d runs, msec\n", size, size, BENCHMARK_N_RUNS);
+  g_print ("# radius        x        y      x+y  kpixels/msec\n");
+
+  /* Radius 1, then every multiple of step */
+  for (radius = 1; radius <= MAX_RADIUS; radius = (radius == 1 && step > 1) ? step : radius + step)
     {
-      for (i = 1; i < 16; i++)
-	{
-	  init_surface (cr);
-	  g_timer_start (timer);
-	  gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
-	  msec = g_timer_elapsed (timer, NULL) * 1000;
-	  if (j == 1)
-	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec:\n", i, msec, size*size/(msec*1000));
-	}
+      x = time_blur (cr, timer, radius, GSK_BLUR_X);
+      y = time_blur (cr, timer, radius, GSK_BLUR_Y);
+      xy = time_blur (cr, timer, radius, GSK_BLUR_X | GSK_BLUR_Y);
+
+      g_print ("%8d %8.2f %8.2f %8.2f %12.2f\n",
+               radius, x, y, xy, xy > 0 ? size * size / (xy * 1000) : 0.0);
     }
 
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
   g_timer_destroy (timer);
 
   return 0;
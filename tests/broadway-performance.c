@@ -0,0 +1,592 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Replays render nodes through the Broadway renderer while taking the
+ * place of the web browser, to measure what broadwayd sends for every
+ * frame. Run it against a gtk4-broadwayd that has no browser connected:
+ *
+ *   gtk4-broadwayd :5 &
+ *   GDK_BACKEND=broadway BROADWAY_DISPLAY=:5 broadway-performance FRAME.node...
+ *
+ * Every file is one frame, like the ones gsk_render_node_write_to_file()
+ * and the recorder in the inspector save.
+ */
+
+#include <gtk/gtk.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdk/broadway/broadway-protocol.h"
+
+#define N_OPS (BROADWAY_OP_ROUNDTRIP + 2)
+#define UNKNOWN_OP (N_OPS - 1)
+
+static const char *op_names[N_OPS] = {
+  "grab-pointer",
+  "ungrab-pointer",
+  "new-surface",
+  "show-surface",
+  "hide-surface",
+  "raise-surface",
+  "lower-surface",
+  "destroy-surface",
+  "move-resize",
+  "set-transient-for",
+  "disconnected",
+  "surface-update",
+  "set-show-keyboard",
+  "upload-texture",
+  "release-texture",
+  "set-nodes",
+  "roundtrip",
+  "unknown",
+};
+
+static int port = 0;
+static gboolean deflate = FALSE;
+static int runs = 1;
+
+static GOptionEntry options[] = {
+  { "port", 'p', 0, G_OPTION_ARG_INT, &port, "Port of gtk4-broadwayd", "PORT" },
+  { "deflate", 'd', 0, G_OPTION_ARG_NONE, &deflate, "Ask for permessage-deflate", NULL },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Replay the frames N times", "N" },
+  { NULL }
+};
+
+typedef struct
+{
+  guint64 wire_bytes; /* Including the websocket framing */
+  guint64 payload_bytes; /* After inflating */
+  guint64 n_ws_messages;
+  guint64 n_messages[N_OPS];
+  guint64 op_bytes[N_OPS];
+} Stats;
+
+typedef struct
+{
+  GSocketConnection *connection;
+  GConverter *decompressor; /* Set if permessage-deflate was negotiated */
+
+  GMutex lock;
+  gboolean busy; /* The reader thread is in the middle of a message */
+  Stats stats;
+} Client;
+
+static guint32
+read_uint32 (const guchar *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((guint32) p[3] << 24);
+}
+
+/* Returns the size of the message at the start of @data, which is
+ * one byte for the op and 4 for the serial, followed by the op's
+ * arguments, see broadway-output.c */
+static gsize
+get_message_size (const guchar *data,
+                  gsize         len,
+                  guint        *op)
+{
+  *op = data[0];
+
+  if (len < 5)
+    {
+      *op = UNKNOWN_OP;
+      return len;
+    }
+
+  switch (*op)
+    {
+    case BROADWAY_OP_UNGRAB_POINTER:
+    case BROADWAY_OP_DISCONNECTED:
+      return 5;
+    case BROADWAY_OP_SHOW_SURFACE:
+    case BROADWAY_OP_HIDE_SURFACE:
+    case BROADWAY_OP_RAISE_SURFACE:
+    case BROADWAY_OP_LOWER_SURFACE:
+    case BROADWAY_OP_DESTROY_SURFACE:
+    case BROADWAY_OP_SET_SHOW_KEYBOARD:
+      return 5 + 2;
+    case BROADWAY_OP_GRAB_POINTER:
+      return 5 + 3;
+    case BROADWAY_OP_SET_TRANSIENT_FOR:
+    case BROADWAY_OP_RELEASE_TEXTURE:
+      return 5 + 4;
+    case BROADWAY_OP_ROUNDTRIP:
+      return 5 + 6;
+    case BROADWAY_OP_NEW_SURFACE:
+      return 5 + 11;
+    case BROADWAY_OP_MOVE_RESIZE:
+      if (len < 8)
+        break;
+      return 5 + 3 + (data[7] & 1 ? 4 : 0) + (data[7] & 2 ? 4 : 0);
+    case BROADWAY_OP_UPLOAD_TEXTURE:
+      if (len < 13)
+        break;
+      return 5 + 8 + read_uint32 (data + 9);
+    case BROADWAY_OP_SET_NODES:
+      if (len < 15)
+        break;
+      return 5 + 10 + read_uint32 (data + 11);
+    default:
+      break;
+    }
+
+  *op = UNKNOWN_OP;
+  return len;
+}
+
+static void
+count_messages (Stats        *stats,
+                const guchar *data,
+                gsize         len)
+{
+  gsize pos, size;
+  guint op;
+
+  stats->payload_bytes += len;
+
+  for (pos = 0; pos < len; pos += size)
+    {
+      size = MIN (get_message_size (data + pos, len - pos, &op), len - pos);
+      stats->n_messages[op]++;
+      stats->op_bytes[op] += size;
+    }
+}
+
+/* Inflates a message, the end of the sync flush was stripped,
+ * see RFC 7692, 7.2.2 */
+static gboolean
+inflate_message (GConverter   *decompressor,
+                 const guchar *data,
+                 gsize         len,
+                 GByteArray   *out)
+{
+  static const guchar trailer[] = { 0x00, 0x00, 0xff, 0xff };
+  GByteArray *in;
+  guchar buffer[16384];
+  gsize pos, bytes_read, bytes_written;
+  gboolean res;
+
+  in = g_byte_array_sized_new (len + sizeof (trailer));
+  g_byte_array_append (in, data, len);
+  g_byte_array_append (in, trailer, sizeof (trailer));
+  g_byte_array_set_size (out, 0);
+
+  res = TRUE;
+  for (pos = 0; ; pos += bytes_read)
+    {
+      if (g_converter_convert (decompressor,
+                               in->data + pos, in->len - pos,
+                               buffer, sizeof (buffer),
+                               G_CONVERTER_FLUSH,
+                               &bytes_read, &bytes_written,
+                               NULL) == G_CONVERTER_ERROR)
+        {
+          res = FALSE;
+          break;
+        }
+
+      g_byte_array_append (out, buffer, bytes_written);
+
+      /* Everything got flushed once there is output space left over */
+      if (pos + bytes_read == in->len && bytes_written < sizeof (buffer))
+        break;
+    }
+
+  g_byte_array_unref (in);
+
+  return res;
+}
+
+static gboolean
+read_bytes (GInputStream *in,
+            guchar       *buffer,
+            gsize         count)
+{
+  gsize bytes_read;
+
+  return g_input_stream_read_all (in, buffer, count, &bytes_read, NULL, NULL) &&
+         bytes_read == count;
+}
+
+static gpointer
+read_thread (gpointer data)
+{
+  Client *client = data;
+  GInputStream *in;
+  GByteArray *inflated;
+  guchar header[10];
+  gsize header_size;
+  guint64 len;
+  guchar *payload;
+
+  in = g_io_stream_get_input_stream (G_IO_STREAM (client->connection));
+  inflated = g_byte_array_new ();
+
+  while (read_bytes (in, header, 2))
+    {
+      g_mutex_lock (&client->lock);
+      client->busy = TRUE;
+      g_mutex_unlock (&client->lock);
+
+      /* The server never masks its messages */
+      len = header[1] & 0x7f;
+      header_size = 2;
+      if (len == 126)
+        {
+          if (!read_bytes (in, header + 2, 2))
+            break;
+          len = (header[2] << 8) | header[3];
+          header_size += 2;
+        }
+      else if (len == 127)
+        {
+          int i;
+
+          if (!read_bytes (in, header + 2, 8))
+            break;
+          len = 0;
+          for (i = 0; i < 8; i++)
+            len = (len << 8) | header[2 + i];
+          header_size += 8;
+        }
+
+      payload = g_malloc (len);
+      if (!read_bytes (in, payload, len))
+        {
+          g_free (payload);
+          break;
+        }
+
+      g_mutex_lock (&client->lock);
+
+      client->stats.wire_bytes += header_size + len;
+      client->stats.n_ws_messages++;
+
+      if ((header[0] & 0x0f) == 2) /* Binary */
+        {
+          if ((header[0] & 0x40) && client->decompressor)
+            {
+              if (inflate_message (client->decompressor, payload, len, inflated))
+                count_messages (&client->stats, inflated->data, inflated->len);
+              else
+                g_printerr ("Could not inflate message\n");
+            }
+          else
+            count_messages (&client->stats, payload, len);
+        }
+
+      client->busy = FALSE;
+      g_mutex_unlock (&client->lock);
+
+      g_free (payload);
+    }
+
+  g_byte_array_unref (inflated);
+
+  return NULL;
+}
+
+static Client *
+client_connect (int       port,
+                gboolean  deflate,
+                GError  **error)
+{
+  GSocketClient *socket_client;
+  GSocketConnection *connection;
+  GInputStream *in;
+  GString *response;
+  char *request;
+  Client *client;
+  guchar c;
+
+  socket_client = g_socket_client_new ();
+  connection = g_socket_client_connect_to_host (socket_client, "127.0.0.1", port, NULL, error);
+  g_object_unref (socket_client);
+  if (connection == NULL)
+    return NULL;
+
+  request = g_strdup_printf ("GET /socket HTTP/1.1\r\n"
+                             "Host: 127.0.0.1:%d\r\n"
+                             "Upgrade: websocket\r\n"
+                             "Connection: Upgrade\r\n"
+                             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                             "Sec-WebSocket-Version: 13\r\n"
+                             "Sec-WebSocket-Protocol: broadway\r\n"
+                             "%s"
+                             "\r\n",
+                             port,
+                             deflate ? "Sec-WebSocket-Extensions: permessage-deflate\r\n" : "");
+  if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                                  request, strlen (request), NULL, NULL, error))
+    {
+      g_free (request);
+      g_object_unref (connection);
+      return NULL;
+    }
+  g_free (request);
+
+  /* Read the response one byte at a time, to not read into the
+   * messages that follow it */
+  in = g_io_stream_get_input_stream (G_IO_STREAM (connection));
+  response = g_string_new (NULL);
+  while (!g_str_has_suffix (response->str, "\r\n\r\n"))
+    {
+      if (!read_bytes (in, &c, 1))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Connection closed during handshake");
+          g_string_free (response, TRUE);
+          g_object_unref (connection);
+          return NULL;
+        }
+      g_string_append_c (response, c);
+    }
+
+  if (!g_str_has_prefix (response->str, "HTTP/1.1 101"))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Unexpected response: %s", response->str);
+      g_string_free (response, TRUE);
+      g_object_unref (connection);
+      return NULL;
+    }
+
+  client = g_new0 (Client, 1);
+  client->connection = connection;
+  g_mutex_init (&client->lock);
+  if (strstr (response->str, "permessage-deflate") != NULL)
+    client->decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+  else if (deflate)
+    g_printerr ("gtk4-broadwayd did not accept permessage-deflate\n");
+
+  g_string_free (response, TRUE);
+
+  g_thread_unref (g_thread_new ("broadway-reader", read_thread, client));
+
+  return client;
+}
+
+/* Waits until the reader thread has counted everything that arrived.
+ * broadwayd sends out what it has before it replies to a sync, so
+ * after gdk_display_sync() this is everything of the frame. */
+static void
+client_get_stats (Client *client,
+                  Stats  *stats)
+{
+  GSocket *socket = g_socket_connection_get_socket (client->connection);
+  gboolean busy;
+
+  while (TRUE)
+    {
+      g_mutex_lock (&client->lock);
+      busy = client->busy;
+      if (!busy && (g_socket_condition_check (socket, G_IO_IN) & G_IO_IN) == 0)
+        {
+          *stats = client->stats;
+          g_mutex_unlock (&client->lock);
+          return;
+        }
+      g_mutex_unlock (&client->lock);
+
+      g_usleep (100);
+    }
+}
+
+static guint64
+count_all_messages (const Stats *stats)
+{
+  guint64 n = 0;
+  int i;
+
+  for (i = 0; i < N_OPS; i++)
+    n += stats->n_messages[i];
+
+  return n;
+}
+
+static void
+deserialize_error_func (const GtkCssSection *section,
+                        const GError        *error,
+                        gpointer             user_data)
+{
+  char *section_str = gtk_css_section_to_string (section);
+
+  g_warning ("Error at %s: %s", section_str, error->message);
+
+  free (section_str);
+}
+
+static GskRenderNode *
+load_node (const char *filename)
+{
+  GskRenderNode *node;
+  GError *error = NULL;
+  GBytes *bytes;
+  char *contents;
+  gsize len;
+
+  if (!g_file_get_contents (filename, &contents, &len, &error))
+    {
+      g_printerr ("Could not open node file: %s\n", error->message);
+      g_error_free (error);
+      return NULL;
+    }
+
+  bytes = g_bytes_new_take (contents, len);
+  node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  g_bytes_unref (bytes);
+
+  return node;
+}
+
+static int
+get_default_port (void)
+{
+  const char *display = g_getenv ("BROADWAY_DISPLAY");
+
+  /* Like gtk4-broadwayd does it */
+  if (display != NULL && display[0] == ':' && g_ascii_isdigit (display[1]))
+    return 8080 + strtol (display + 1, NULL, 10);
+
+  return 8080;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GskRenderNode **nodes;
+  graphene_rect_t bounds;
+  GdkSurface *surface;
+  GskRenderer *renderer;
+  cairo_region_t *region;
+  Client *client;
+  Stats start, before, after;
+  int n_nodes, run, i;
+  guint64 n_frames;
+  gint64 encode_time, total_encode_time;
+
+  context = g_option_context_new ("NODE-FILE...");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  gtk_init ();
+
+  if (argc < 2 || runs < 1)
+    {
+      g_printerr ("Usage: %s [OPTIONS] NODE-FILE...\n", argv[0]);
+      return 1;
+    }
+
+  if (strcmp (G_OBJECT_TYPE_NAME (gdk_display_get_default ()), "GdkBroadwayDisplay") != 0)
+    {
+      g_printerr ("This needs GDK_BACKEND=broadway\n");
+      return 1;
+    }
+
+  n_nodes = argc - 1;
+  nodes = g_new (GskRenderNode *, n_nodes);
+  for (i = 0; i < n_nodes; i++)
+    {
+      nodes[i] = load_node (argv[i + 1]);
+      if (nodes[i] == NULL)
+        return 1;
+    }
+
+  client = client_connect (port ? port : get_default_port (), deflate, &error);
+  if (client == NULL)
+    {
+      g_printerr ("Could not connect to gtk4-broadwayd: %s\n", error->message);
+      return 1;
+    }
+
+  gsk_render_node_get_bounds (nodes[0], &bounds);
+  surface = gdk_surface_new_toplevel (gdk_display_get_default (),
+                                      MAX (ceil (bounds.origin.x + bounds.size.width), 1),
+                                      MAX (ceil (bounds.origin.y + bounds.size.height), 1));
+  gdk_surface_show (surface);
+  renderer = gsk_renderer_new_for_surface (surface);
+  if (renderer == NULL ||
+      strcmp (G_OBJECT_TYPE_NAME (renderer), "GskBroadwayRenderer") != 0)
+    {
+      g_printerr ("This needs the Broadway renderer\n");
+      return 1;
+    }
+
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                            0, 0,
+                                            gdk_surface_get_width (surface),
+                                            gdk_surface_get_height (surface)
+                                          });
+
+  gdk_display_sync (gdk_display_get_default ());
+  client_get_stats (client, &start);
+
+  /* One line per frame, tab-separated, so the output can be
+   * fed to other tools to compare runs. */
+  g_print ("# run\tframe\tencode-ms\twire-bytes\tpayload-bytes\tmessages\n");
+
+  n_frames = 0;
+  total_encode_time = 0;
+  after = start;
+  for (run = 0; run < runs; run++)
+    {
+      for (i = 0; i < n_nodes; i++)
+        {
+          before = after;
+
+          /* This includes broadwayd encoding the frame, as it
+           * handles the sync after the frame */
+          encode_time = g_get_monotonic_time ();
+          gsk_renderer_render (renderer, nodes[i], region);
+          gdk_display_sync (gdk_display_get_default ());
+          encode_time = g_get_monotonic_time () - encode_time;
+
+          client_get_stats (client, &after);
+
+          g_print ("%d\t%s\t%.3f\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\n",
+                   run, argv[i + 1], (double) encode_time / 1000,
+                   after.wire_bytes - before.wire_bytes,
+                   after.payload_bytes - before.payload_bytes,
+                   count_all_messages (&after) - count_all_messages (&before));
+
+          total_encode_time += encode_time;
+          n_frames++;
+        }
+    }
+
+  g_print ("# %" G_GUINT64_FORMAT " frames, %.3f ms encode time, %.0f wire bytes, %.0f payload bytes per frame%s\n",
+           n_frames,
+           (double) total_encode_time / n_frames / 1000,
+           (double) (after.wire_bytes - start.wire_bytes) / n_frames,
+           (double) (after.payload_bytes - start.payload_bytes) / n_frames,
+           client->decompressor ? " (deflate)" : "");
+  g_print ("# %" G_GUINT64_FORMAT " websocket messages\n",
+           after.n_ws_messages - start.n_ws_messages);
+  g_print ("# message\tcount\tbytes\n");
+  for (i = 0; i < N_OPS; i++)
+    {
+      if (after.n_messages[i] == start.n_messages[i])
+        continue;
+
+      g_print ("# %s\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\n",
+               op_names[i],
+               after.n_messages[i] - start.n_messages[i],
+               after.op_bytes[i] - start.op_bytes[i]);
+    }
+
+  cairo_region_destroy (region);
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+  gdk_surface_destroy (surface);
+  for (i = 0; i < n_nodes; i++)
+    gsk_render_node_unref (nodes[i]);
+  g_free (nodes);
+
+  return 0;
+}
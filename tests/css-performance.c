@@ -0,0 +1,349 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+static const char css[] =
+  "box.toggled label { color: red; }\n"
+  "box label { margin: 2px; padding: 1px 3px; border: 1px solid blue; }\n"
+  "box label:hover { background-color: yellow; }\n"
+  "box label.special { font-weight: bold; }\n";
+
+/* Every label gets its own class, so no two labels can share a style
+ * and every restyle has to compute all of them. */
+static GtkWidget **
+create_labels (GtkWidget *box,
+               int        n_labels)
+{
+  GtkWidget **labels;
+  int i;
+
+  labels = g_new (GtkWidget *, n_labels);
+
+  for (i = 0; i < n_labels; i++)
+    {
+      char *class_name = g_strdup_printf ("label%d", i);
+
+      labels[i] = gtk_label_new ("Hello");
+      gtk_style_context_add_class (gtk_widget_get_style_context (labels[i]), class_name);
+      if (i % 10 == 0)
+        gtk_style_context_add_class (gtk_widget_get_style_context (labels[i]), "special");
+      gtk_container_add (GTK_CONTAINER (box), labels[i]);
+
+      g_free (class_name);
+    }
+
+  return labels;
+}
+
+typedef struct
+{
+  GtkWidget  *box;
+  GtkWidget **labels;
+  int         n_labels;
+  int         n_iterations;
+  GTimer     *timer;
+} RestyleRun;
+
+static double
+run_restyle (gpointer data)
+{
+  RestyleRun *run = data;
+  GtkStyleContext *context = gtk_widget_get_style_context (run->box);
+  GdkRGBA color;
+  int i, j;
+
+  g_timer_start (run->timer);
+
+  for (i = 0; i < run->n_iterations; i++)
+    {
+      if (gtk_style_context_has_class (context, "toggled"))
+        gtk_style_context_remove_class (context, "toggled");
+      else
+        gtk_style_context_add_class (context, "toggled");
+
+      /* Querying the color forces the style to be computed */
+      for (j = 0; j < run->n_labels; j++)
+        gtk_style_context_get_color (gtk_widget_get_style_context (run->labels[j]), &color);
+    }
+
+  return (double) run->n_labels * run->n_iterations / g_timer_elapsed (run->timer, NULL);
+}
+
+/* Returns the median number of styles computed per second when
+ * toggling a class on the box restyles all the labels. */
+static double
+time_restyle (GtkWidget  *box,
+              GtkWidget **labels,
+              int         n_labels,
+              int         n_iterations)
+{
+  RestyleRun run = { box, labels, n_labels, n_iterations, g_timer_new () };
+  double result;
+
+  result = benchmark_median (run_restyle, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  return result;
+}
+
+/* Forces the style of all widgets to be computed */
+static void
+compute_styles (GPtrArray *widgets)
+{
+  GdkRGBA color;
+  guint i;
+
+  for (i = 0; i < widgets->len; i++)
+    gtk_style_context_get_color (gtk_widget_get_style_context (g_ptr_array_index (widgets, i)), &color);
+}
+
+static void
+compute_subtree_styles (GtkWidget *widget)
+{
+  GtkWidget *child;
+  GdkRGBA color;
+
+  gtk_style_context_get_color (gtk_widget_get_style_context (widget), &color);
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    compute_subtree_styles (child);
+}
+
+static void
+add_widget (GPtrArray *widgets,
+            GtkWidget *parent,
+            GtkWidget *child)
+{
+  gtk_container_add (GTK_CONTAINER (parent), child);
+  g_ptr_array_add (widgets, child);
+}
+
+/* Builds a list like the ones in settings panels and file choosers,
+ * styled by the default theme: every row has an icon, a title, a dimmed
+ * subtitle and every few rows a button or a switch. */
+static GtkWidget *
+create_list (int         n_rows,
+             GPtrArray **rows_out,
+             GPtrArray **widgets_out)
+{
+  GPtrArray *rows, *widgets;
+  GtkWidget *list;
+  int i;
+
+  rows = g_ptr_array_new ();
+  widgets = g_ptr_array_new ();
+
+  list = gtk_list_box_new ();
+  g_object_ref_sink (list);
+  g_ptr_array_add (widgets, list);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GtkWidget *row, *hbox, *vbox, *label;
+
+      row = gtk_list_box_row_new ();
+      add_widget (widgets, list, row);
+      g_ptr_array_add (rows, row);
+
+      hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+      add_widget (widgets, row, hbox);
+
+      add_widget (widgets, hbox, gtk_image_new_from_icon_name ("folder-symbolic"));
+
+      vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+      add_widget (widgets, hbox, vbox);
+
+      add_widget (widgets, vbox, gtk_label_new ("Title"));
+      label = gtk_label_new ("Subtitle");
+      gtk_style_context_add_class (gtk_widget_get_style_context (label), "dim-label");
+      add_widget (widgets, vbox, label);
+
+      if (i % 5 == 0)
+        add_widget (widgets, hbox, gtk_switch_new ());
+      else if (i % 3 == 0)
+        add_widget (widgets, hbox, gtk_button_new_with_label ("Open"));
+
+      if (i % 7 == 0)
+        gtk_widget_set_sensitive (row, FALSE);
+    }
+
+  *rows_out = rows;
+  *widgets_out = widgets;
+
+  return list;
+}
+
+typedef struct
+{
+  int        n_rows;
+  GPtrArray *rows;
+  GPtrArray *widgets;
+  GTimer    *timer;
+} ListRun;
+
+static double
+run_initial_styles (gpointer data)
+{
+  ListRun *run = data;
+  GPtrArray *rows, *widgets;
+  GtkWidget *list;
+  double msecs;
+
+  g_timer_start (run->timer);
+
+  list = create_list (run->n_rows, &rows, &widgets);
+  compute_styles (widgets);
+
+  msecs = g_timer_elapsed (run->timer, NULL) * 1000;
+
+  g_ptr_array_unref (rows);
+  g_ptr_array_unref (widgets);
+  g_object_unref (list);
+
+  return msecs;
+}
+
+/* Returns the median time in milliseconds to create a list and compute
+ * all of its styles the first time. */
+static double
+time_initial_styles (int n_rows)
+{
+  ListRun run = { n_rows, NULL, NULL, g_timer_new () };
+  double result;
+
+  result = benchmark_median (run_initial_styles, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  return result;
+}
+
+static double
+run_hover (gpointer data)
+{
+  ListRun *run = data;
+  GPtrArray *rows = run->rows;
+  guint i;
+
+  g_timer_start (run->timer);
+
+  for (i = 0; i < rows->len; i++)
+    {
+      if (i > 0)
+        {
+          gtk_widget_unset_state_flags (g_ptr_array_index (rows, i - 1), GTK_STATE_FLAG_PRELIGHT);
+          compute_subtree_styles (g_ptr_array_index (rows, i - 1));
+        }
+      gtk_widget_set_state_flags (g_ptr_array_index (rows, i), GTK_STATE_FLAG_PRELIGHT, FALSE);
+      compute_subtree_styles (g_ptr_array_index (rows, i));
+    }
+  gtk_widget_unset_state_flags (g_ptr_array_index (rows, rows->len - 1), GTK_STATE_FLAG_PRELIGHT);
+
+  return rows->len / g_timer_elapsed (run->timer, NULL);
+}
+
+/* Returns the median number of hover changes per second when the
+ * pointer moves down the list, one row at a time. Only the rows that
+ * gain or lose the hover state need to be restyled. */
+static double
+time_hover (GPtrArray *rows)
+{
+  ListRun run = { rows->len, rows, NULL, g_timer_new () };
+  double result;
+
+  result = benchmark_median (run_hover, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  return result;
+}
+
+static double
+run_theme_reload (gpointer data)
+{
+  ListRun *run = data;
+  GtkSettings *settings = gtk_settings_get_default ();
+  gboolean dark;
+
+  g_object_get (settings, "gtk-application-prefer-dark-theme", &dark, NULL);
+
+  g_timer_start (run->timer);
+
+  g_object_set (settings, "gtk-application-prefer-dark-theme", !dark, NULL);
+  compute_styles (run->widgets);
+
+  return g_timer_elapsed (run->timer, NULL) * 1000;
+}
+
+/* Returns the median time in milliseconds to switch between the light
+ * and dark variant of the theme and restyle the list. */
+static double
+time_theme_reload (GPtrArray *widgets)
+{
+  ListRun run = { 0, NULL, widgets, g_timer_new () };
+  double result;
+
+  result = benchmark_median (run_theme_reload, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkCssProvider *provider;
+  GtkWidget *box;
+  GtkWidget **labels;
+  GtkWidget *list;
+  GPtrArray *rows, *widgets;
+  int n_labels, n_iterations;
+
+  /* Usage: css-performance [N_LABELS [N_ITERATIONS]]
+   * N_LABELS is also the number of rows in the theme benchmarks. */
+  n_labels = argc > 1 ? MAX (atoi (argv[1]), 1) : 1000;
+  n_iterations = argc > 2 ? MAX (atoi (argv[2]), 1) : 20;
+
+  gtk_init ();
+
+  /* The theme benchmarks run first, so the custom CSS below does not
+   * apply to them */
+  list = create_list (n_labels, &rows, &widgets);
+  compute_styles (widgets);
+
+  g_print ("# %d rows, %u widgets with the default theme, median of %d runs\n", n_labels, widgets->len, BENCHMARK_N_RUNS);
+  g_print ("%.2f ms initial styling\n", time_initial_styles (n_labels));
+  g_print ("%.0f hover changes/sec\n", time_hover (rows));
+  g_print ("%.2f ms theme reload\n", time_theme_reload (widgets));
+
+  g_ptr_array_unref (rows);
+  g_ptr_array_unref (widgets);
+  g_object_unref (list);
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider, css, -1);
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  g_object_ref_sink (box);
+  labels = create_labels (box, n_labels);
+
+  g_print ("# %d labels, %d restyles, median of %d runs\n", n_labels, n_iterations, BENCHMARK_N_RUNS);
+  g_print ("%.0f styles/sec\n", time_restyle (box, labels, n_labels, n_iterations));
+
+  g_free (labels);
+  g_object_unref (box);
+  g_object_unref (provider);
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures the cost of looking up a key press in a GtkKeyHash,
+ * which windows use for accelerators and mnemonics and binding
+ * sets use for key bindings. */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "gtk/gtkkeyhash.h"
+
+#include "benchmark.h"
+
+#define N_LOOKUPS 100000
+
+static const GdkModifierType modifier_combos[] = {
+  0,
+  GDK_CONTROL_MASK,
+  GDK_SHIFT_MASK,
+  GDK_MOD1_MASK,
+  GDK_CONTROL_MASK | GDK_SHIFT_MASK,
+  GDK_CONTROL_MASK | GDK_MOD1_MASK,
+  GDK_SHIFT_MASK | GDK_MOD1_MASK,
+  GDK_CONTROL_MASK | GDK_SHIFT_MASK | GDK_MOD1_MASK,
+};
+
+typedef struct
+{
+  guint16 keycode;
+  GdkModifierType state;
+} KeyPress;
+
+static GArray *
+get_keyvals (GdkKeymap *keymap)
+{
+  GArray *keyvals;
+  guint keyval;
+
+  keyvals = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (keyval = GDK_KEY_a; keyval <= GDK_KEY_z; keyval++)
+    g_array_append_val (keyvals, keyval);
+  for (keyval = GDK_KEY_0; keyval <= GDK_KEY_9; keyval++)
+    g_array_append_val (keyvals, keyval);
+  for (keyval = GDK_KEY_F1; keyval <= GDK_KEY_F12; keyval++)
+    g_array_append_val (keyvals, keyval);
+
+  return keyvals;
+}
+
+/* Adds n_entries accelerators for keyvals with all modifier
+ * combinations, repeating them like several actions on the same
+ * accelerator once all combinations are used */
+static GtkKeyHash *
+create_key_hash (GdkKeymap *keymap,
+                 GArray    *keyvals,
+                 guint      n_entries)
+{
+  GtkKeyHash *hash;
+  guint i;
+
+  hash = _gtk_key_hash_new (keymap, NULL);
+
+  for (i = 0; i < n_entries; i++)
+    {
+      guint keyval = g_array_index (keyvals, guint, i % keyvals->len);
+      GdkModifierType modifiers = modifier_combos[(i / keyvals->len) % G_N_ELEMENTS (modifier_combos)];
+
+      _gtk_key_hash_add_entry (hash, keyval, modifiers, GUINT_TO_POINTER (i + 1));
+    }
+
+  return hash;
+}
+
+/* Typing is mostly keys without accelerators, with some
+ * accelerators in between */
+static KeyPress *
+create_key_presses (GdkKeymap *keymap,
+                    GArray    *keyvals)
+{
+  KeyPress *presses;
+  GRand *rand;
+  guint i;
+
+  presses = g_new (KeyPress, N_LOOKUPS);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < N_LOOKUPS; i++)
+    {
+      guint keyval = g_array_index (keyvals, guint, g_rand_int_range (rand, 0, keyvals->len));
+      GdkKeymapKey *keys;
+      gint n_keys;
+
+      presses[i].keycode = 0;
+      if (gdk_keymap_get_entries_for_keyval (keymap, keyval, &keys, &n_keys))
+        {
+          presses[i].keycode = keys[0].keycode;
+          g_free (keys);
+        }
+
+      if (g_rand_int_range (rand, 0, 10) == 0)
+        presses[i].state = modifier_combos[g_rand_int_range (rand, 1, G_N_ELEMENTS (modifier_combos))];
+      else
+        presses[i].state = 0;
+    }
+
+  g_rand_free (rand);
+
+  return presses;
+}
+
+typedef struct
+{
+  GtkKeyHash *hash;
+  KeyPress   *presses;
+  guint       n_found;
+  GTimer     *timer;
+} LookupRun;
+
+static double
+run_lookup_loop (gpointer data)
+{
+  LookupRun *run = data;
+  guint i;
+
+  run->n_found = 0;
+
+  g_timer_start (run->timer);
+  for (i = 0; i < N_LOOKUPS; i++)
+    {
+      GSList *found = _gtk_key_hash_lookup (run->hash,
+                                            run->presses[i].keycode,
+                                            run->presses[i].state,
+                                            gtk_accelerator_get_default_mod_mask (),
+                                            0);
+      if (found)
+        run->n_found++;
+      g_slist_free (found);
+    }
+  g_timer_stop (run->timer);
+
+  return g_timer_elapsed (run->timer, NULL);
+}
+
+/* Prints the median time of BENCHMARK_N_RUNS runs of N_LOOKUPS
+ * lookups. The first run of each hash starts with nothing remembered. */
+static void
+run_lookups (GdkKeymap *keymap,
+             GArray    *keyvals,
+             KeyPress  *presses,
+             guint      n_entries)
+{
+  LookupRun run;
+  double first, median;
+
+  run.hash = create_key_hash (keymap, keyvals, n_entries);
+  run.presses = presses;
+  run.n_found = 0;
+  run.timer = g_timer_new ();
+
+  median = benchmark_median (run_lookup_loop, &run, &first);
+
+  g_timer_destroy (run.timer);
+  _gtk_key_hash_free (run.hash);
+
+  g_print ("%u\t%u\t%u\t%.3f\t%.3f\n",
+           n_entries, N_LOOKUPS, run.n_found,
+           first * G_USEC_PER_SEC / N_LOOKUPS,
+           median * G_USEC_PER_SEC / N_LOOKUPS);
+}
+
+int
+main (int argc, char **argv)
+{
+  GdkKeymap *keymap;
+  GArray *keyvals;
+  KeyPress *presses;
+  guint n_entries, max_entries;
+
+  gtk_init ();
+
+  /* Usage: keyhash-performance [MAX_ENTRIES] */
+  max_entries = argc > 1 ? MAX (atoi (argv[1]), 10) : 10000;
+
+  keymap = gdk_display_get_keymap (gdk_display_get_default ());
+  keyvals = get_keyvals (keymap);
+  presses = create_key_presses (keymap, keyvals);
+
+  g_print ("# entries\tlookups\tfound\tfirst-usec-per-lookup\tusec-per-lookup\n");
+
+  for (n_entries = 10; n_entries <= max_entries; n_entries *= 10)
+    run_lookups (keymap, keyvals, presses, n_entries);
+
+  g_free (presses);
+  g_array_unref (keyvals);
+
+  return 0;
+}
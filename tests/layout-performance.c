@@ -0,0 +1,363 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures size requests, allocation and snapshots of a few large
+ * standard UIs while they get resized, scrolled and change state.
+ * Unlike the interactive frame-stats tests, every step is driven
+ * directly instead of by the frame clock, so runs are reproducible.
+ * It prints one line per scenario and phase, which makes it usable
+ * for tracking numbers over time, also with GDK_BACKEND=broadway.
+ *
+ * Usage: layout-performance [N_STEPS] */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#define WIDTH 800
+#define HEIGHT 600
+
+typedef enum {
+  PHASE_MEASURE,
+  PHASE_ALLOCATE,
+  PHASE_SNAPSHOT,
+  N_PHASES
+} Phase;
+
+static const char *phase_names[N_PHASES] = {
+  "measure",
+  "allocate",
+  "snapshot",
+};
+
+typedef struct
+{
+  const char *name;
+  GtkWidget * (* create) (void);
+} Scenario;
+
+static GtkWidget *
+wrap_in_scrolled_window (GtkWidget *child)
+{
+  GtkWidget *sw;
+
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (sw), child);
+
+  return sw;
+}
+
+static GtkWidget *
+create_list_box (void)
+{
+  GtkWidget *list;
+  int i;
+
+  list = gtk_list_box_new ();
+
+  for (i = 0; i < 10000; i++)
+    {
+      GtkWidget *box;
+      char *text;
+
+      box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+      gtk_container_add (GTK_CONTAINER (box), gtk_image_new_from_icon_name ("document-open-symbolic"));
+      text = g_strdup_printf ("Row %d", i);
+      gtk_container_add (GTK_CONTAINER (box), gtk_label_new (text));
+      g_free (text);
+      if (i % 4 == 0)
+        gtk_container_add (GTK_CONTAINER (box), gtk_check_button_new ());
+
+      gtk_container_add (GTK_CONTAINER (list), box);
+    }
+
+  return wrap_in_scrolled_window (list);
+}
+
+static GtkWidget *
+create_grid_level (int depth)
+{
+  GtkWidget *grid;
+  int x, y;
+
+  if (depth == 0)
+    return gtk_label_new ("Cell");
+
+  grid = gtk_grid_new ();
+  for (y = 0; y < 3; y++)
+    for (x = 0; x < 3; x++)
+      gtk_grid_attach (GTK_GRID (grid), create_grid_level (depth - 1), x, y, 1, 1);
+
+  return grid;
+}
+
+static GtkWidget *
+create_grid (void)
+{
+  /* 3^5 = 243 labels in 121 nested grids */
+  return wrap_in_scrolled_window (create_grid_level (5));
+}
+
+static GtkWidget *
+create_text_view (void)
+{
+  GtkWidget *text_view;
+  GtkTextBuffer *buffer;
+  GString *text;
+  int i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 5000; i++)
+    g_string_append_printf (text, "Line %d: The quick brown fox jumps over the lazy dog. "
+                            "Pack my box with five dozen liquor jugs.\n", i);
+
+  text_view = gtk_text_view_new ();
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (text_view), GTK_WRAP_WORD);
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (text_view));
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+
+  g_string_free (text, TRUE);
+
+  return wrap_in_scrolled_window (text_view);
+}
+
+static GtkWidget *
+create_tree_view (void)
+{
+  GtkWidget *tree_view;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  int i;
+
+  store = gtk_list_store_new (3, G_TYPE_STRING, G_TYPE_INT, G_TYPE_BOOLEAN);
+  for (i = 0; i < 10000; i++)
+    {
+      char *text = g_strdup_printf ("Item %d", i);
+
+      gtk_list_store_insert_with_values (store, &iter, -1,
+                                         0, text,
+                                         1, i * 7 % 1000,
+                                         2, i % 3 == 0,
+                                         -1);
+      g_free (text);
+    }
+
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_unref (store);
+
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view), -1, "Name",
+                                               gtk_cell_renderer_text_new (), "text", 0, NULL);
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view), -1, "Size",
+                                               gtk_cell_renderer_text_new (), "text", 1, NULL);
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view), -1, "Active",
+                                               gtk_cell_renderer_toggle_new (), "active", 2, NULL);
+
+  return wrap_in_scrolled_window (tree_view);
+}
+
+static const Scenario scenarios[] = {
+  { "listbox", create_list_box },
+  { "grid", create_grid },
+  { "textview", create_text_view },
+  { "treeview", create_tree_view },
+};
+
+/* Runs one layout and snapshot pass of child at the given size and
+ * adds the time of each phase to times */
+static void
+run_pass (GtkWidget *window,
+          GtkWidget *child,
+          int        width,
+          int        height,
+          double    *times)
+{
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+  int min, nat;
+  gint64 start, end;
+
+  start = g_get_monotonic_time ();
+  gtk_widget_measure (child, GTK_ORIENTATION_HORIZONTAL, -1, &min, &nat, NULL, NULL);
+  gtk_widget_measure (child, GTK_ORIENTATION_VERTICAL, MAX (width, min), &min, &nat, NULL, NULL);
+  end = g_get_monotonic_time ();
+  times[PHASE_MEASURE] = (end - start) / 1000.;
+
+  start = end;
+  gtk_widget_size_allocate (child, &(GtkAllocation) { 0, 0, width, MAX (height, min) }, -1);
+  end = g_get_monotonic_time ();
+  times[PHASE_ALLOCATE] = (end - start) / 1000.;
+
+  start = end;
+  snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot_child (window, child, snapshot);
+  node = gtk_snapshot_free_to_node (snapshot);
+  end = g_get_monotonic_time ();
+  times[PHASE_SNAPSHOT] = (end - start) / 1000.;
+
+  if (node)
+    gsk_render_node_unref (node);
+}
+
+static GtkWidget *
+find_scrollable (GtkWidget *widget)
+{
+  GtkWidget *child;
+
+  if (GTK_IS_SCROLLABLE (widget))
+    return widget;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GtkWidget *result = find_scrollable (child);
+
+      if (result)
+        return result;
+    }
+
+  return NULL;
+}
+
+/* Flips the hover state of the widget at the given position in the
+ * tree, or of the scrollable itself if there is no such child */
+static void
+toggle_state (GtkWidget *scrollable,
+              int        step)
+{
+  GtkWidget *widget;
+  int i;
+
+  widget = gtk_widget_get_first_child (scrollable);
+  for (i = 0; widget != NULL && i < step; i++)
+    widget = gtk_widget_get_next_sibling (widget);
+  if (widget == NULL)
+    widget = scrollable;
+
+  if (gtk_widget_get_state_flags (widget) & GTK_STATE_FLAG_PRELIGHT)
+    gtk_widget_unset_state_flags (widget, GTK_STATE_FLAG_PRELIGHT);
+  else
+    gtk_widget_set_state_flags (widget, GTK_STATE_FLAG_PRELIGHT, FALSE);
+}
+
+static void
+print_phase (const char *scenario,
+             const char *change,
+             Phase       phase,
+             double     *samples,
+             int         n_samples)
+{
+  double total = 0;
+  int i;
+
+  for (i = 0; i < n_samples; i++)
+    total += samples[i];
+
+  benchmark_sort (samples, n_samples);
+
+  g_print ("%-10s %-8s %-10s mean %8.3f ms  median %8.3f ms  95%% %8.3f ms\n",
+           scenario, change, phase_names[phase],
+           total / n_samples,
+           samples[n_samples / 2],
+           samples[MIN (n_samples - 1, n_samples * 95 / 100)]);
+}
+
+static void
+run_scenario (const Scenario *scenario,
+              int             n_steps)
+{
+  const char *changes[] = { "resize", "scroll", "state" };
+  GtkWidget *window, *child, *scrollable;
+  GtkAdjustment *vadjustment;
+  double *samples[N_PHASES];
+  double times[N_PHASES];
+  gint64 start;
+  guint c;
+  int step, p;
+
+  start = g_get_monotonic_time ();
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), WIDTH, HEIGHT);
+  child = scenario->create ();
+  gtk_container_add (GTK_CONTAINER (window), child);
+  gtk_widget_show (window);
+
+  /* Snapshots are only taken of mapped widgets */
+  while (!gtk_widget_get_mapped (child))
+    g_main_context_iteration (NULL, TRUE);
+
+  run_pass (window, child, WIDTH, HEIGHT, times);
+  g_print ("%-10s %-8s %-10s %8.3f ms\n", scenario->name, "create", "total",
+           (g_get_monotonic_time () - start) / 1000.);
+
+  scrollable = find_scrollable (child);
+  vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (scrollable));
+
+  for (p = 0; p < N_PHASES; p++)
+    samples[p] = g_new (double, n_steps);
+
+  for (c = 0; c < G_N_ELEMENTS (changes); c++)
+    {
+      for (step = 0; step < n_steps; step++)
+        {
+          int width = WIDTH, height = HEIGHT;
+
+          switch (c)
+            {
+            case 0:
+              /* Shrink and grow by up to 400 pixels in each direction */
+              width = WIDTH - 400 + (step * 37) % 800;
+              height = HEIGHT - 300 + (step * 23) % 600;
+              break;
+
+            case 1:
+              gtk_adjustment_set_value (vadjustment,
+                                        gtk_adjustment_get_lower (vadjustment) +
+                                        (gtk_adjustment_get_upper (vadjustment) -
+                                         gtk_adjustment_get_page_size (vadjustment) -
+                                         gtk_adjustment_get_lower (vadjustment)) * step / n_steps);
+              break;
+
+            case 2:
+              toggle_state (scrollable, step);
+              break;
+
+            default:
+              g_assert_not_reached ();
+            }
+
+          run_pass (window, child, width, height, times);
+
+          for (p = 0; p < N_PHASES; p++)
+            samples[p][step] = times[p];
+        }
+
+      for (p = 0; p < N_PHASES; p++)
+        print_phase (scenario->name, changes[c], p, samples[p], n_steps);
+    }
+
+  for (p = 0; p < N_PHASES; p++)
+    g_free (samples[p]);
+
+  gtk_widget_destroy (window);
+}
+
+int
+main (int argc, char **argv)
+{
+  int n_steps;
+  guint i;
+
+  n_steps = argc > 1 ? MAX (atoi (argv[1]), 1) : 100;
+
+  gtk_init ();
+
+  g_print ("# %d steps per change, %dx%d\n", n_steps, WIDTH, HEIGHT);
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    run_scenario (&scenarios[i], n_steps);
+
+  return 0;
+}
@@ -0,0 +1,378 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#define MAX_LOOKUPS 100000
+#define N_CHANGES 1000
+
+typedef struct
+{
+  GObject parent;
+
+  guint number;
+} MyObject;
+
+typedef struct
+{
+  GObjectClass parent_class;
+} MyObjectClass;
+
+G_DEFINE_TYPE (MyObject, my_object, G_TYPE_OBJECT)
+
+static void
+my_object_init (MyObject *obj)
+{
+}
+
+static void
+my_object_class_init (MyObjectClass *class)
+{
+}
+
+static guint filter_modulo = 2;
+static gboolean sort_reversed = FALSE;
+
+static gboolean
+filter_func (gpointer item,
+             gpointer data)
+{
+  return ((MyObject *) item)->number % filter_modulo == 0;
+}
+
+static int
+compare_func (gconstpointer a,
+              gconstpointer b,
+              gpointer      data)
+{
+  guint na = ((const MyObject *) a)->number;
+  guint nb = ((const MyObject *) b)->number;
+  int result = na < nb ? -1 : (na > nb ? 1 : 0);
+
+  return sort_reversed ? -result : result;
+}
+
+static gpointer
+map_func (gpointer item,
+          gpointer data)
+{
+  return g_object_ref (item);
+}
+
+static GListModel *
+create_store (GObject **items,
+              guint     size)
+{
+  GListStore *store = g_list_store_new (G_TYPE_OBJECT);
+
+  g_list_store_splice (store, 0, 0, (gpointer *) items, size);
+
+  return G_LIST_MODEL (store);
+}
+
+static GListModel *
+create_store_model (GListModel *store)
+{
+  return g_object_ref (store);
+}
+
+static GListModel *
+create_filter_model (GListModel *store)
+{
+  return G_LIST_MODEL (gtk_filter_list_model_new (store, filter_func, NULL, NULL));
+}
+
+static GListModel *
+create_sort_model (GListModel *store)
+{
+  return G_LIST_MODEL (gtk_sort_list_model_new (store, compare_func, NULL, NULL));
+}
+
+static GListModel *
+create_map_model (GListModel *store)
+{
+  return G_LIST_MODEL (gtk_map_list_model_new (G_TYPE_OBJECT, store, map_func, NULL, NULL));
+}
+
+static GListModel *
+create_slice_model (GListModel *store)
+{
+  guint size = g_list_model_get_n_items (store);
+
+  return G_LIST_MODEL (gtk_slice_list_model_new (store, size / 4, size / 2));
+}
+
+static void
+update_filter_model (GListModel *model)
+{
+  filter_modulo = filter_modulo == 2 ? 3 : 2;
+  gtk_filter_list_model_refilter (GTK_FILTER_LIST_MODEL (model));
+}
+
+static void
+update_sort_model (GListModel *model)
+{
+  sort_reversed = !sort_reversed;
+  gtk_sort_list_model_resort (GTK_SORT_LIST_MODEL (model));
+}
+
+typedef struct
+{
+  const char *name;
+  GListModel * (* create) (GListModel *store);
+  const char *update_name;
+  void (* update) (GListModel *model);
+} Model;
+
+static const Model models[] = {
+  { "GListStore", create_store_model, NULL, NULL },
+  { "GtkFilterListModel", create_filter_model, "refilter", update_filter_model },
+  { "GtkSortListModel", create_sort_model, "resort", update_sort_model },
+  { "GtkMapListModel", create_map_model, NULL, NULL },
+  { "GtkSliceListModel", create_slice_model, NULL, NULL },
+};
+
+typedef struct
+{
+  const Model *model;
+  GObject **items;
+  guint size;
+
+  GListModel *store;
+  GListModel *list;
+} Bench;
+
+/* Each benchmark function does one run and returns the number of
+ * operations it did. All of them but construct leave the store
+ * unchanged, so they can share one model. */
+typedef guint (* BenchFunc) (Bench  *bench,
+                             GTimer *timer);
+
+static guint
+bench_construct (Bench  *bench,
+                 GTimer *timer)
+{
+  GListModel *store, *list;
+
+  /* This includes filling the store so the numbers of the store
+   * itself mean something. */
+  g_timer_start (timer);
+  store = create_store (bench->items, bench->size);
+  list = bench->model->create (store);
+  g_timer_stop (timer);
+
+  g_object_unref (list);
+  g_object_unref (store);
+
+  return 1;
+}
+
+static guint
+bench_get_random (Bench  *bench,
+                  GTimer *timer)
+{
+  guint i, n_items, n_lookups;
+  guint *positions;
+  GRand *rand;
+
+  n_items = g_list_model_get_n_items (bench->list);
+  if (n_items == 0)
+    return 0;
+
+  n_lookups = MIN (n_items, MAX_LOOKUPS);
+  positions = g_new (guint, n_lookups);
+  rand = g_rand_new_with_seed (42);
+  for (i = 0; i < n_lookups; i++)
+    positions[i] = g_rand_int_range (rand, 0, n_items);
+  g_rand_free (rand);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_lookups; i++)
+    g_object_unref (g_list_model_get_item (bench->list, positions[i]));
+  g_timer_stop (timer);
+
+  g_free (positions);
+
+  return n_lookups;
+}
+
+static guint
+bench_iterate (Bench  *bench,
+               GTimer *timer)
+{
+  guint i, n_items;
+
+  n_items = g_list_model_get_n_items (bench->list);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_items; i++)
+    g_object_unref (g_list_model_get_item (bench->list, i));
+  g_timer_stop (timer);
+
+  return n_items;
+}
+
+/* Inserts and removes single items at random positions of the store */
+static guint
+bench_change_single (Bench  *bench,
+                     GTimer *timer)
+{
+  guint i, n_changes;
+  guint *positions;
+  GRand *rand;
+
+  n_changes = MIN (bench->size, N_CHANGES);
+  positions = g_new (guint, n_changes);
+  rand = g_rand_new_with_seed (42);
+  for (i = 0; i < n_changes; i++)
+    positions[i] = g_rand_int_range (rand, 0, bench->size);
+  g_rand_free (rand);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_changes; i++)
+    {
+      g_list_store_insert (G_LIST_STORE (bench->store), positions[i], bench->items[i]);
+      g_list_store_remove (G_LIST_STORE (bench->store), positions[i]);
+    }
+  g_timer_stop (timer);
+
+  g_free (positions);
+
+  return 2 * n_changes;
+}
+
+/* Removes a tenth of the store and adds it back */
+static guint
+bench_change_bulk (Bench  *bench,
+                   GTimer *timer)
+{
+  guint position = bench->size / 2;
+  guint n = bench->size / 10;
+
+  g_timer_start (timer);
+  g_list_store_splice (G_LIST_STORE (bench->store), position, n, NULL, 0);
+  g_list_store_splice (G_LIST_STORE (bench->store), position, 0, (gpointer *) bench->items + position, n);
+  g_timer_stop (timer);
+
+  return 2;
+}
+
+static guint
+bench_update (Bench  *bench,
+              GTimer *timer)
+{
+  g_timer_start (timer);
+  bench->model->update (bench->list);
+  g_timer_stop (timer);
+
+  return 1;
+}
+
+typedef struct
+{
+  Bench     *bench;
+  BenchFunc  func;
+  guint      n_ops;
+  GTimer    *timer;
+} BenchRun;
+
+static double
+run_bench_once (gpointer data)
+{
+  BenchRun *run = data;
+
+  run->n_ops = run->func (run->bench, run->timer);
+
+  return g_timer_elapsed (run->timer, NULL);
+}
+
+/* Prints the median time of BENCHMARK_N_RUNS runs, after one run for warmup */
+static void
+run_bench (Bench      *bench,
+           const char *name,
+           BenchFunc   func)
+{
+  BenchRun run = { bench, func, 0, g_timer_new () };
+  double median;
+
+  median = benchmark_median (run_bench_once, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  g_print ("%s\t%s\t%u\t%u\t%.9f\n",
+           bench->model->name, name, bench->size, run.n_ops, median);
+}
+
+static GObject **
+create_items (guint size)
+{
+  GObject **items;
+  GRand *rand;
+  guint i;
+
+  items = g_new (GObject *, size);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < size; i++)
+    {
+      MyObject *obj = g_object_new (my_object_get_type (), NULL);
+
+      obj->number = g_rand_int (rand);
+      items[i] = G_OBJECT (obj);
+    }
+
+  g_rand_free (rand);
+
+  return items;
+}
+
+int
+main (int argc, char **argv)
+{
+  GObject **items;
+  guint size, max_size, i, j;
+
+  /* Usage: listmodel-performance [MAX_SIZE] */
+  max_size = argc > 1 ? MAX (atoi (argv[1]), 1000) : 1000000;
+
+  /* One line per result, tab-separated, so the output can be
+   * fed to other tools to compare runs. */
+  g_print ("# model\tbenchmark\tsize\toperations\tseconds\n");
+
+  for (size = 1000; size <= max_size; size *= 10)
+    {
+      items = create_items (size);
+
+      for (i = 0; i < G_N_ELEMENTS (models); i++)
+        {
+          Bench bench = { &models[i], items, size, NULL, NULL };
+
+          run_bench (&bench, "construct", bench_construct);
+
+          bench.store = create_store (items, size);
+          bench.list = bench.model->create (bench.store);
+
+          run_bench (&bench, "get-item-random", bench_get_random);
+          run_bench (&bench, "iterate", bench_iterate);
+          run_bench (&bench, "items-changed-single", bench_change_single);
+          run_bench (&bench, "items-changed-bulk", bench_change_bulk);
+          if (bench.model->update)
+            run_bench (&bench, bench.model->update_name, bench_update);
+
+          g_object_unref (bench.list);
+          g_object_unref (bench.store);
+        }
+
+      for (j = 0; j < size; j++)
+        g_object_unref (items[j]);
+      g_free (items);
+
+      if (size > G_MAXUINT / 10)
+        break;
+    }
+
+  return 0;
+}
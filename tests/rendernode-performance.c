@@ -0,0 +1,263 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how long the renderers take to draw serialized render
+ * nodes offscreen with gsk_renderer_render_texture(). Each run
+ * includes downloading the texture, so the GPU work of hardware
+ * renderers is part of the numbers.
+ *
+ * Without arguments, the reftest nodes in testsuite/gsk/compare are
+ * used. */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+static int runs = 20;
+static char **renderer_names = NULL;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render each node N times", "N" },
+  { "renderer", 'R', 0, G_OPTION_ARG_STRING_ARRAY, &renderer_names, "Only use this renderer (cairo, opengl, vulkan)", "NAME" },
+  { NULL }
+};
+
+typedef struct
+{
+  const char *name;
+  GskRenderer * (* create) (void);
+} RendererInfo;
+
+static const RendererInfo renderers[] = {
+  { "cairo", gsk_cairo_renderer_new },
+  { "opengl", gsk_gl_renderer_new },
+#ifdef GDK_RENDERING_VULKAN
+  { "vulkan", gsk_vulkan_renderer_new },
+#endif
+};
+
+static void
+deserialize_error_func (const GtkCssSection *section,
+                        const GError        *error,
+                        gpointer             user_data)
+{
+  char *section_str = gtk_css_section_to_string (section);
+
+  g_warning ("Error at %s: %s", section_str, error->message);
+
+  g_free (section_str);
+}
+
+static GskRenderNode *
+load_node (const char *filename)
+{
+  GskRenderNode *node;
+  GError *error = NULL;
+  GMappedFile *mapped_file;
+  GBytes *bytes;
+
+  mapped_file = g_mapped_file_new (filename, FALSE, &error);
+  if (mapped_file == NULL)
+    {
+      g_printerr ("Could not open node file: %s\n", error->message);
+      g_error_free (error);
+      return NULL;
+    }
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  g_mapped_file_unref (mapped_file);
+  node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  g_bytes_unref (bytes);
+
+  return node;
+}
+
+static void
+add_node_files (GPtrArray  *files,
+                const char *path)
+{
+  GDir *dir;
+  const char *name;
+  GPtrArray *names;
+  guint i;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      g_ptr_array_add (files, g_strdup (path));
+      return;
+    }
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  names = g_ptr_array_new ();
+  while ((name = g_dir_read_name (dir)))
+    {
+      if (g_str_has_suffix (name, ".node"))
+        g_ptr_array_add (names, g_build_filename (path, name, NULL));
+    }
+  g_dir_close (dir);
+
+  g_ptr_array_sort (names, (GCompareFunc) g_strcmp0);
+  for (i = 0; i < names->len; i++)
+    g_ptr_array_add (files, g_ptr_array_index (names, i));
+  g_ptr_array_free (names, TRUE);
+}
+
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  gint64 t1 = *(const gint64 *) a;
+  gint64 t2 = *(const gint64 *) b;
+
+  return t1 < t2 ? -1 : t1 > t2;
+}
+
+/* Renders node runs times and prints the mean and percentiles */
+static void
+benchmark_node (GskRenderer   *renderer,
+                const char    *renderer_name,
+                const char    *filename,
+                GskRenderNode *node)
+{
+  gint64 *times;
+  gint64 total = 0;
+  char *basename;
+  guchar *data;
+  int width, height;
+  GdkTexture *texture;
+  int run;
+
+  /* Warm up caches and compile shaders outside of the measurement */
+  texture = gsk_renderer_render_texture (renderer, node, NULL);
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  data = g_malloc (width * height * 4);
+  gdk_texture_download (texture, data, width * 4);
+  g_object_unref (texture);
+
+  times = g_new (gint64, runs);
+  for (run = 0; run < runs; run++)
+    {
+      gint64 start = g_get_monotonic_time ();
+
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      gdk_texture_download (texture, data, width * 4);
+      g_object_unref (texture);
+
+      times[run] = g_get_monotonic_time () - start;
+      total += times[run];
+    }
+
+  qsort (times, runs, sizeof (gint64), compare_times);
+
+  basename = g_path_get_basename (filename);
+  g_print ("%-8s %-40s %5dx%-5d mean %8.3f ms  median %8.3f ms  95%% %8.3f ms  max %8.3f ms\n",
+           renderer_name, basename, width, height,
+           (double) total / runs / 1000.,
+           times[runs / 2] / 1000.,
+           times[MIN (runs - 1, runs * 95 / 100)] / 1000.,
+           times[runs - 1] / 1000.);
+
+  g_free (basename);
+  g_free (times);
+  g_free (data);
+}
+
+static gboolean
+use_renderer (const char *name)
+{
+  if (renderer_names == NULL)
+    return TRUE;
+
+  return g_strv_contains ((const char * const *) renderer_names, name);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GPtrArray *files;
+  GPtrArray *nodes;
+  GdkSurface *surface;
+  guint i, j;
+
+  context = g_option_context_new ("[NODE-FILE|DIRECTORY…]");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (runs < 1)
+    {
+      g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
+      return 1;
+    }
+
+  gtk_init ();
+
+  files = g_ptr_array_new_with_free_func (g_free);
+  if (argc < 2)
+    add_node_files (files, GTK_SRCDIR "/../testsuite/gsk/compare");
+  for (i = 1; i < argc; i++)
+    add_node_files (files, argv[i]);
+
+  nodes = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_render_node_unref);
+  for (i = 0; i < files->len; i++)
+    {
+      GskRenderNode *node = load_node (g_ptr_array_index (files, i));
+
+      if (node == NULL)
+        {
+          g_ptr_array_remove_index (files, i--);
+          continue;
+        }
+
+      g_ptr_array_add (nodes, node);
+    }
+
+  if (nodes->len == 0)
+    {
+      g_printerr ("No render nodes to benchmark.\n");
+      return 1;
+    }
+
+  surface = gdk_surface_new_toplevel (gdk_display_get_default (), 10, 10);
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      GskRenderer *renderer;
+
+      if (!use_renderer (renderers[i].name))
+        continue;
+
+      renderer = renderers[i].create ();
+      if (!gsk_renderer_realize (renderer, surface, &error))
+        {
+          g_print ("%-8s skipped: %s\n", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_object_unref (renderer);
+          continue;
+        }
+
+      for (j = 0; j < nodes->len; j++)
+        benchmark_node (renderer,
+                        renderers[i].name,
+                        g_ptr_array_index (files, j),
+                        g_ptr_array_index (nodes, j));
+
+      gsk_renderer_unrealize (renderer);
+      g_object_unref (renderer);
+    }
+
+  g_object_unref (surface);
+  g_ptr_array_unref (nodes);
+  g_ptr_array_unref (files);
+
+  return 0;
+}
@@ -1,5 +1,10 @@
 /* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
 
+/* Scrolls a viewport with a lot of widgets in both directions on every
+ * frame. With the GL renderer, compare the frame stats against a run
+ * with GSK_SCROLL_LAYERS=1, which only draws what got scrolled into view.
+ */
+
 #include <gtk/gtk.h>
 #include <math.h>
 
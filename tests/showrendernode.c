@@ -125,8 +125,7 @@ main (int argc, char **argv)
 {
   GtkWidget *window;
   GtkWidget *nodeview;
-  char *contents;
-  gsize len;
+  GMappedFile *mapped_file;
   GBytes *bytes;
   graphene_rect_t node_bounds;
   GOptionContext *option_context;
@@ -156,14 +155,16 @@ main (int argc, char **argv)
 
   gtk_window_set_decorated (GTK_WINDOW (window), FALSE);
 
-  g_file_get_contents (argv[1], &contents, &len, &error);
+  /* Map the file instead of reading it, recordings can be huge */
+  mapped_file = g_mapped_file_new (argv[1], FALSE, &error);
   if (error)
     {
       g_warning ("%s", error->message);
       return -1;
     }
 
-  bytes = g_bytes_new_take (contents, len);
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  g_mapped_file_unref (mapped_file);
   GTK_NODE_VIEW (nodeview)->node = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
   g_bytes_unref (bytes);
 
@@ -0,0 +1,139 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char *name;
+  GdkMemoryFormat format;
+  int bpp;
+} formats[] = {
+  { "B8G8R8A8_PREMULTIPLIED", GDK_MEMORY_B8G8R8A8_PREMULTIPLIED, 4 },
+  { "A8R8G8B8_PREMULTIPLIED", GDK_MEMORY_A8R8G8B8_PREMULTIPLIED, 4 },
+  { "B8G8R8A8", GDK_MEMORY_B8G8R8A8, 4 },
+  { "A8R8G8B8", GDK_MEMORY_A8R8G8B8, 4 },
+  { "R8G8B8A8", GDK_MEMORY_R8G8B8A8, 4 },
+  { "A8B8G8R8", GDK_MEMORY_A8B8G8R8, 4 },
+  { "R8G8B8", GDK_MEMORY_R8G8B8, 3 },
+  { "B8G8R8", GDK_MEMORY_B8G8R8, 3 },
+};
+
+/* Fills the image like an icon: a partially transparent border
+ * around an opaque center, with transparent pixels in between. */
+static GBytes *
+create_data (int width,
+             int height,
+             int bpp)
+{
+  guchar *data;
+  GRand *rand;
+  int x, y, i;
+
+  data = g_malloc (width * height * bpp);
+  rand = g_rand_new_with_seed (42);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        guchar *pixel = data + (y * width + x) * bpp;
+        int border = MIN (MIN (x, width - 1 - x), MIN (y, height - 1 - y));
+
+        for (i = 0; i < bpp; i++)
+          pixel[i] = g_rand_int_range (rand, 0, 256);
+
+        if (bpp == 4)
+          {
+            guchar alpha = border < width / 8 ? (border < width / 16 ? 0 : 0x80) : 0xFF;
+
+            /* Alpha is the first or the last byte, and the colors
+             * must not exceed it for the premultiplied formats */
+            pixel[0] = alpha;
+            pixel[1] = MIN (pixel[1], alpha);
+            pixel[2] = MIN (pixel[2], alpha);
+            pixel[3] = alpha;
+          }
+      }
+
+  g_rand_free (rand);
+
+  return g_bytes_new_take (data, width * height * bpp);
+}
+
+typedef struct
+{
+  GdkTexture *texture;
+  int         n_iterations;
+  guchar     *data;
+  GTimer     *timer;
+} DownloadRun;
+
+static double
+run_download (gpointer data)
+{
+  DownloadRun *run = data;
+  int width = gdk_texture_get_width (run->texture);
+  int height = gdk_texture_get_height (run->texture);
+  int i;
+
+  g_timer_start (run->timer);
+
+  for (i = 0; i < run->n_iterations; i++)
+    gdk_texture_download (run->texture, run->data, width * 4);
+
+  return (double) width * height * run->n_iterations / g_timer_elapsed (run->timer, NULL) / 1000000;
+}
+
+/* Returns the median number of megapixels downloaded per second */
+static double
+time_download (GdkTexture *texture,
+               int         n_iterations)
+{
+  int width = gdk_texture_get_width (texture);
+  int height = gdk_texture_get_height (texture);
+  DownloadRun run;
+  double result;
+
+  run.texture = texture;
+  run.n_iterations = n_iterations;
+  run.data = g_malloc (width * height * 4);
+  run.timer = g_timer_new ();
+
+  result = benchmark_median (run_download, &run, NULL);
+
+  g_timer_destroy (run.timer);
+  g_free (run.data);
+
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  int size, n_iterations;
+  guint i;
+
+  /* Usage: texture-performance [SIZE [N_ITERATIONS]] */
+  size = argc > 1 ? MAX (atoi (argv[1]), 16) : 1024;
+  n_iterations = argc > 2 ? MAX (atoi (argv[2]), 1) : 20;
+
+  g_print ("# %dx%d textures, %d downloads, median of %d runs\n", size, size, n_iterations, BENCHMARK_N_RUNS);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      GdkTexture *texture;
+      GBytes *bytes;
+
+      bytes = create_data (size, size, formats[i].bpp);
+      texture = gdk_memory_texture_new (size, size, formats[i].format, bytes, size * formats[i].bpp);
+
+      g_print ("%s\t%.1f Mpixels/sec\n", formats[i].name, time_download (texture, n_iterations));
+
+      g_object_unref (texture);
+      g_bytes_unref (bytes);
+    }
+
+  return 0;
+}
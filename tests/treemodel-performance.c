@@ -0,0 +1,267 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how GtkTreeModelSort and GtkTreeModelFilter, alone and
+ * stacked, keep up with changes to a large GtkListStore. */
+
+#include <gtk/gtk.h>
+
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#define N_CHANGES 1000
+
+enum {
+  COLUMN_NUMBER,
+  COLUMN_TEXT
+};
+
+static gboolean
+visible_func (GtkTreeModel *model,
+              GtkTreeIter  *iter,
+              gpointer      data)
+{
+  guint number;
+
+  gtk_tree_model_get (model, iter, COLUMN_NUMBER, &number, -1);
+
+  return number % 3 != 0;
+}
+
+static GtkTreeModel *
+create_sort_model (GtkTreeModel *store)
+{
+  GtkTreeModel *sort;
+
+  sort = gtk_tree_model_sort_new_with_model (store);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort),
+                                        COLUMN_NUMBER, GTK_SORT_ASCENDING);
+
+  return sort;
+}
+
+static GtkTreeModel *
+create_filter_model (GtkTreeModel *store)
+{
+  GtkTreeModel *filter;
+
+  filter = gtk_tree_model_filter_new (store, NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          visible_func, NULL, NULL);
+
+  return filter;
+}
+
+static GtkTreeModel *
+create_stacked_model (GtkTreeModel *store)
+{
+  GtkTreeModel *sort, *filter;
+
+  sort = create_sort_model (store);
+  filter = create_filter_model (sort);
+  g_object_unref (sort);
+
+  return filter;
+}
+
+typedef struct
+{
+  const char *name;
+  GtkTreeModel * (* create) (GtkTreeModel *store);
+} Model;
+
+static const Model models[] = {
+  { "GtkTreeModelSort", create_sort_model },
+  { "GtkTreeModelFilter", create_filter_model },
+  { "filter-over-sort", create_stacked_model },
+};
+
+typedef struct
+{
+  const Model *model;
+  guint size;
+
+  GtkListStore *store;
+  GtkTreeModel *model_on_top;
+  GtkTreeIter *rows;
+} Bench;
+
+/* Each benchmark function does one run and returns the number of
+ * operations it did, like in listmodel-performance */
+typedef guint (* BenchFunc) (Bench  *bench,
+                             GTimer *timer);
+
+static GtkListStore *
+create_store (guint         size,
+              GtkTreeIter **rows)
+{
+  GtkListStore *store;
+  GRand *rand;
+  guint i;
+
+  store = gtk_list_store_new (2, G_TYPE_UINT, G_TYPE_STRING);
+  rand = g_rand_new_with_seed (42);
+  *rows = g_new (GtkTreeIter, size);
+
+  for (i = 0; i < size; i++)
+    gtk_list_store_insert_with_values (store, &(*rows)[i], -1,
+                                       COLUMN_NUMBER, g_rand_int (rand),
+                                       COLUMN_TEXT, "row",
+                                       -1);
+
+  g_rand_free (rand);
+
+  return store;
+}
+
+/* Walks all rows, so the models build their levels */
+static guint
+iterate (GtkTreeModel *model)
+{
+  GtkTreeIter iter;
+  guint n = 0;
+
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+      do
+        n++;
+      while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+  return n;
+}
+
+static guint
+bench_construct (Bench  *bench,
+                 GTimer *timer)
+{
+  GtkTreeModel *model;
+
+  g_timer_start (timer);
+  model = bench->model->create (GTK_TREE_MODEL (bench->store));
+  iterate (model);
+  g_timer_stop (timer);
+
+  g_object_unref (model);
+
+  return 1;
+}
+
+/* Changes a column the models don't look at */
+static guint
+bench_change_text (Bench  *bench,
+                   GTimer *timer)
+{
+  GRand *rand;
+  guint i;
+
+  rand = g_rand_new_with_seed (42);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_CHANGES; i++)
+    gtk_list_store_set (bench->store, &bench->rows[g_rand_int_range (rand, 0, bench->size)],
+                        COLUMN_TEXT, i % 2 ? "row" : "changed row",
+                        -1);
+  g_timer_stop (timer);
+
+  g_rand_free (rand);
+
+  return N_CHANGES;
+}
+
+/* Changes the column that is sorted and filtered on */
+static guint
+bench_change_number (Bench  *bench,
+                     GTimer *timer)
+{
+  GRand *rand;
+  guint i;
+
+  rand = g_rand_new_with_seed (42);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_CHANGES; i++)
+    gtk_list_store_set (bench->store, &bench->rows[g_rand_int_range (rand, 0, bench->size)],
+                        COLUMN_NUMBER, g_rand_int (rand),
+                        -1);
+  g_timer_stop (timer);
+
+  g_rand_free (rand);
+
+  return N_CHANGES;
+}
+
+typedef struct
+{
+  Bench     *bench;
+  BenchFunc  func;
+  guint      n_ops;
+  GTimer    *timer;
+} BenchRun;
+
+static double
+run_bench_once (gpointer data)
+{
+  BenchRun *run = data;
+
+  run->n_ops = run->func (run->bench, run->timer);
+
+  return g_timer_elapsed (run->timer, NULL);
+}
+
+/* Prints the median time of BENCHMARK_N_RUNS runs, after one run for warmup */
+static void
+run_bench (Bench      *bench,
+           const char *name,
+           BenchFunc   func)
+{
+  BenchRun run = { bench, func, 0, g_timer_new () };
+  double median;
+
+  median = benchmark_median (run_bench_once, &run, NULL);
+
+  g_timer_destroy (run.timer);
+
+  g_print ("%s\t%s\t%u\t%u\t%.9f\n",
+           bench->model->name, name, bench->size, run.n_ops, median);
+}
+
+int
+main (int argc, char **argv)
+{
+  guint size, max_size, i;
+
+  gtk_init ();
+
+  /* Usage: treemodel-performance [MAX_SIZE] */
+  max_size = argc > 1 ? MAX (atoi (argv[1]), 1000) : 100000;
+
+  g_print ("# model\tbenchmark\tsize\toperations\tseconds\n");
+
+  for (size = 1000; size <= max_size; size *= 10)
+    {
+      for (i = 0; i < G_N_ELEMENTS (models); i++)
+        {
+          Bench bench = { &models[i], size, NULL, NULL, NULL };
+
+          bench.store = create_store (size, &bench.rows);
+
+          run_bench (&bench, "construct", bench_construct);
+
+          bench.model_on_top = bench.model->create (GTK_TREE_MODEL (bench.store));
+          iterate (bench.model_on_top);
+
+          run_bench (&bench, "row-changed-unsorted-column", bench_change_text);
+          run_bench (&bench, "row-changed-sorted-column", bench_change_number);
+
+          g_object_unref (bench.model_on_top);
+          g_object_unref (bench.store);
+          g_free (bench.rows);
+        }
+
+      if (size > G_MAXUINT / 10)
+        break;
+    }
+
+  return 0;
+}
@@ -19,6 +19,7 @@ main (int argc, char **argv)
   GskRenderNode *node;
   GskRenderNode *deserialized;
   GBytes *bytes;
+  char *expected, *result;
   GFile *file;
 
   g_assert (argc == 2);
@@ -47,6 +48,23 @@ main (int argc, char **argv)
   g_assert_cmpint (gsk_render_node_get_node_type (deserialized), ==,
                    gsk_render_node_get_node_type (node));
 
+  /* The binary format should be lossless */
+  g_clear_pointer (&deserialized, gsk_render_node_unref);
+  g_bytes_unref (bytes);
+  bytes = gsk_render_node_serialize_binary (node);
+  deserialized = gsk_render_node_deserialize (bytes, deserialize_error_func, NULL);
+  g_assert (deserialized != NULL);
+
+  g_bytes_unref (bytes);
+  bytes = gsk_render_node_serialize (node);
+  expected = g_strndup (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  g_bytes_unref (bytes);
+  bytes = gsk_render_node_serialize (deserialized);
+  result = g_strndup (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+  g_assert_cmpstr (result, ==, expected);
+  g_free (expected);
+  g_free (result);
+
 
   g_clear_error (&error);
   g_clear_pointer (&node, gsk_render_node_unref);
@@ -0,0 +1,126 @@
+/* action.c - test action groups of widgets
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+static GActionGroup *
+create_group (void)
+{
+  GSimpleActionGroup *group;
+  GSimpleAction *action;
+
+  group = g_simple_action_group_new ();
+  action = g_simple_action_new ("ok", NULL);
+  g_action_map_add_action (G_ACTION_MAP (group), G_ACTION (action));
+  g_object_unref (action);
+
+  return G_ACTION_GROUP (group);
+}
+
+/* Actionable widgets are only sensitive while their action exists
+ * and is enabled, so their sensitivity shows what they were told */
+static void
+test_insert_remove (void)
+{
+  GtkWidget *box, *button;
+  GActionGroup *group;
+  GAction *action;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box);
+  button = gtk_button_new ();
+  gtk_actionable_set_action_name (GTK_ACTIONABLE (button), "test.ok");
+  gtk_container_add (GTK_CONTAINER (box), button);
+
+  g_assert_false (gtk_widget_get_sensitive (button));
+
+  group = create_group ();
+  gtk_widget_insert_action_group (box, "test", group);
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  action = g_action_map_lookup_action (G_ACTION_MAP (group), "ok");
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), FALSE);
+  g_assert_false (gtk_widget_get_sensitive (button));
+  g_simple_action_set_enabled (G_SIMPLE_ACTION (action), TRUE);
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  gtk_widget_insert_action_group (box, "test", NULL);
+  g_assert_false (gtk_widget_get_sensitive (button));
+
+  gtk_widget_insert_action_group (box, "other", group);
+  g_assert_false (gtk_widget_get_sensitive (button));
+
+  g_object_unref (group);
+  g_object_unref (box);
+}
+
+static void
+test_reparent (void)
+{
+  GtkWidget *box1, *box2, *inner, *button;
+  GActionGroup *group;
+
+  box1 = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box1);
+  box2 = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box2);
+  inner = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  button = gtk_button_new ();
+  gtk_actionable_set_action_name (GTK_ACTIONABLE (button), "test.ok");
+  gtk_container_add (GTK_CONTAINER (inner), button);
+
+  group = create_group ();
+  gtk_widget_insert_action_group (box1, "test", group);
+  g_object_unref (group);
+
+  gtk_container_add (GTK_CONTAINER (box1), inner);
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  g_object_ref (inner);
+  gtk_container_remove (GTK_CONTAINER (box1), inner);
+  g_assert_false (gtk_widget_get_sensitive (button));
+
+  gtk_container_add (GTK_CONTAINER (box2), inner);
+  g_assert_false (gtk_widget_get_sensitive (button));
+
+  gtk_container_remove (GTK_CONTAINER (box2), inner);
+  gtk_container_add (GTK_CONTAINER (box1), inner);
+  g_object_unref (inner);
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  /* The button's own muxer has no children, unlike the one of inner */
+  g_object_ref (button);
+  gtk_container_remove (GTK_CONTAINER (inner), button);
+  g_assert_false (gtk_widget_get_sensitive (button));
+  gtk_container_add (GTK_CONTAINER (box1), button);
+  g_object_unref (button);
+  g_assert_true (gtk_widget_get_sensitive (button));
+
+  g_object_unref (box1);
+  g_object_unref (box2);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/action/insert-remove", test_insert_remove);
+  g_test_add_func ("/action/reparent", test_reparent);
+
+  return g_test_run ();
+}
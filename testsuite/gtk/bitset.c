@@ -0,0 +1,170 @@
+/* GtkBitset tests.
+ *
+ * Copyright (C) 2019, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include "../../gtk/gtkbitsetprivate.h"
+
+#include <string.h>
+
+/* how often we run the random tests */
+#define N_RUNS 20
+
+/* how many tries we do in our random tests */
+#define N_TRIES 100
+
+/* the maximum size we use for bitsets */
+#define MAX_SIZE 5000
+
+/* checks the bitset against an array of booleans */
+static void
+assert_bitset (GtkBitset *set,
+               GArray    *array)
+{
+  guint i, n_set;
+
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, array->len);
+
+  n_set = 0;
+  for (i = 0; i < array->len; i++)
+    {
+      gboolean value = g_array_index (array, gboolean, i);
+
+      g_assert_cmpint (gtk_bitset_get (set, i), ==, value);
+      g_assert_cmpuint (gtk_bitset_rank (set, i), ==, n_set);
+      if (value)
+        {
+          g_assert_cmpuint (gtk_bitset_select (set, n_set), ==, i);
+          n_set++;
+        }
+    }
+
+  g_assert_cmpuint (gtk_bitset_rank (set, array->len), ==, n_set);
+  g_assert_cmpuint (gtk_bitset_get_n_set (set), ==, n_set);
+  g_assert_cmpuint (gtk_bitset_select (set, n_set), ==, G_MAXUINT);
+}
+
+static void
+test_empty (void)
+{
+  GtkBitset *set;
+
+  set = gtk_bitset_new ();
+
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, 0);
+  g_assert_cmpuint (gtk_bitset_get_n_set (set), ==, 0);
+  g_assert_cmpuint (gtk_bitset_rank (set, 0), ==, 0);
+  g_assert_cmpuint (gtk_bitset_select (set, 0), ==, G_MAXUINT);
+  g_assert_false (gtk_bitset_get (set, 0));
+
+  gtk_bitset_free (set);
+}
+
+static void
+test_set_range (void)
+{
+  GtkBitset *set;
+
+  set = gtk_bitset_new ();
+  gtk_bitset_splice (set, 0, 0, 1000);
+  gtk_bitset_set_range (set, 0, 1000, TRUE);
+
+  g_assert_cmpuint (gtk_bitset_get_n_set (set), ==, 1000);
+  g_assert_cmpuint (gtk_bitset_select (set, 999), ==, 999);
+
+  gtk_bitset_set_range (set, 10, 980, FALSE);
+  g_assert_cmpuint (gtk_bitset_get_n_set (set), ==, 20);
+  g_assert_cmpuint (gtk_bitset_select (set, 10), ==, 990);
+  g_assert_cmpuint (gtk_bitset_rank (set, 995), ==, 15);
+
+  gtk_bitset_free (set);
+}
+
+static void
+test_random (void)
+{
+  GtkBitset *set;
+  GArray *array;
+  guint i, j, position, removed, added, size;
+  gboolean value;
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      set = gtk_bitset_new ();
+      array = g_array_new (FALSE, FALSE, sizeof (gboolean));
+
+      for (j = 0; j < N_TRIES; j++)
+        {
+          size = array->len;
+
+          switch (g_test_rand_int_range (0, 3))
+            {
+            case 0:
+              position = g_test_rand_int_range (0, size + 1);
+              removed = g_test_rand_int_range (0, size - position + 1);
+              added = g_test_rand_int_range (0, MAX_SIZE - size + removed + 1) / 4;
+              gtk_bitset_splice (set, position, removed, added);
+              g_array_remove_range (array, position, removed);
+              value = FALSE;
+              for (; added > 0; added--)
+                g_array_insert_val (array, position, value);
+              break;
+
+            case 1:
+              if (size == 0)
+                break;
+              position = g_test_rand_int_range (0, size);
+              value = g_test_rand_bit ();
+              gtk_bitset_set (set, position, value);
+              g_array_index (array, gboolean, position) = value;
+              break;
+
+            case 2:
+              position = g_test_rand_int_range (0, size + 1);
+              added = g_test_rand_int_range (0, size - position + 1);
+              value = g_test_rand_bit ();
+              gtk_bitset_set_range (set, position, added, value);
+              for (; added > 0; added--)
+                g_array_index (array, gboolean, position + added - 1) = value;
+              break;
+
+            default:
+              g_assert_not_reached ();
+              break;
+            }
+
+          assert_bitset (set, array);
+        }
+
+      g_array_unref (array);
+      gtk_bitset_free (set);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/bitset/empty", test_empty);
+  g_test_add_func ("/bitset/set_range", test_set_range);
+  g_test_add_func ("/bitset/random", test_random);
+
+  return g_test_run ();
+}
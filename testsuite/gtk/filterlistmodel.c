@@ -190,6 +190,15 @@ is_not_near (gpointer item,
   return ABS (GPOINTER_TO_INT (g_object_get_qdata (item, number_quark)) - GPOINTER_TO_INT (data)) > 2;
 }
 
+static gboolean
+is_smaller_than_limit (gpointer item,
+                       gpointer data)
+{
+  guint *limit = data;
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) < *limit;
+}
+
 static void
 test_create (void)
 {
@@ -306,6 +315,55 @@ test_change_filter_func (void)
   g_object_unref (filter);
 }
 
+static void
+test_filter_changed (void)
+{
+  GtkFilterListModel *filter;
+  guint limit = 7;
+
+  filter = new_model (10, is_smaller_than_limit, &limit);
+  assert_model (filter, "1 2 3 4 5 6");
+  assert_changes (filter, "");
+
+  limit = 4;
+  gtk_filter_list_model_filter_changed (filter, GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT);
+  assert_model (filter, "1 2 3");
+  assert_changes (filter, "3-3");
+
+  limit = 8;
+  gtk_filter_list_model_filter_changed (filter, GTK_FILTER_LIST_MODEL_CHANGE_LESS_STRICT);
+  assert_model (filter, "1 2 3 4 5 6 7");
+  assert_changes (filter, "3+4");
+
+  g_object_unref (filter);
+}
+
+static void
+test_incremental (void)
+{
+  GtkFilterListModel *filter;
+  guint limit = 7;
+
+  filter = new_model (10, is_smaller_than_limit, &limit);
+  gtk_filter_list_model_set_incremental (filter, TRUE);
+  assert_model (filter, "1 2 3 4 5 6");
+  assert_changes (filter, "");
+
+  limit = 2;
+  gtk_filter_list_model_filter_changed (filter, GTK_FILTER_LIST_MODEL_CHANGE_MORE_STRICT);
+  assert_model (filter, "1 2 3 4 5 6");
+  assert_changes (filter, "");
+  g_assert_cmpuint (gtk_filter_list_model_get_pending (filter), ==, 10);
+
+  while (gtk_filter_list_model_get_pending (filter) > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  assert_model (filter, "1");
+  assert_changes (filter, "1-5");
+
+  g_object_unref (filter);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -318,6 +376,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/create", test_create);
   g_test_add_func ("/filterlistmodel/empty_set_filter_func", test_empty_set_filter_func);
   g_test_add_func ("/filterlistmodel/change_filter_func", test_change_filter_func);
+  g_test_add_func ("/filterlistmodel/filter_changed", test_filter_changed);
+  g_test_add_func ("/filterlistmodel/incremental", test_incremental);
 
   return g_test_run ();
 }
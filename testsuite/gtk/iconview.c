@@ -0,0 +1,82 @@
+/* iconview.c - test GtkIconView
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define LONG_TEXT "Some text that is long enough to be wrapped into a good number " \
+                  "of lines by the text cell of the icon view, which makes the " \
+                  "item a lot taller than one with a single word in it"
+
+static int
+get_height (GtkWidget *widget)
+{
+  int minimum, natural;
+
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, -1,
+                      &minimum, &natural, NULL, NULL);
+
+  return minimum;
+}
+
+/* The icon view remembers the sizes of its items, so changes to
+ * the model have to make it measure them again */
+static void
+test_item_sizes (void)
+{
+  GtkWidget *view;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  int short_height, height;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "Short", -1);
+
+  view = gtk_icon_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+  gtk_icon_view_set_text_column (GTK_ICON_VIEW (view), 0);
+  gtk_icon_view_set_columns (GTK_ICON_VIEW (view), 1);
+
+  short_height = get_height (view);
+  g_assert_cmpint (get_height (view), ==, short_height);
+
+  gtk_list_store_set (store, &iter, 0, LONG_TEXT, -1);
+  height = get_height (view);
+  g_assert_cmpint (height, >, short_height);
+
+  gtk_list_store_set (store, &iter, 0, "Short", -1);
+  g_assert_cmpint (get_height (view), ==, short_height);
+
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, LONG_TEXT, -1);
+  g_assert_cmpint (get_height (view), >, height);
+
+  gtk_list_store_clear (store);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "Short", -1);
+  g_assert_cmpint (get_height (view), ==, short_height);
+
+  g_object_unref (view);
+  g_object_unref (store);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/iconview/item-sizes", test_item_sizes);
+
+  return g_test_run ();
+}
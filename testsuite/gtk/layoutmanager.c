@@ -0,0 +1,176 @@
+/* layoutmanager.c - test when layout managers redo their layout
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define WIDTH 400
+#define HEIGHT 100
+
+static void
+allocate (GtkWidget *widget)
+{
+  int minimum, natural;
+
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, &minimum, &natural, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, WIDTH, &minimum, &natural, NULL, NULL);
+  gtk_widget_size_allocate (widget, &(GtkAllocation) { 0, 0, WIDTH, HEIGHT }, -1);
+}
+
+static int
+get_x (GtkWidget *widget)
+{
+  GtkAllocation allocation;
+
+  gtk_widget_get_allocation (widget, &allocation);
+
+  return allocation.x;
+}
+
+/* Children that keep their request don't change the layout, but
+ * everything else that does must still be picked up */
+static void
+test_child_changes (void)
+{
+  GtkWidget *box, *first, *second;
+  int x;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box);
+  first = gtk_label_new ("first");
+  second = gtk_label_new ("second");
+  gtk_container_add (GTK_CONTAINER (box), first);
+  gtk_container_add (GTK_CONTAINER (box), second);
+
+  allocate (box);
+  x = get_x (second);
+  g_assert_cmpint (x, >, 0);
+
+  gtk_label_set_text (GTK_LABEL (first), "first");
+  allocate (box);
+  g_assert_cmpint (get_x (second), ==, x);
+
+  gtk_label_set_text (GTK_LABEL (first), "a much longer first label");
+  allocate (box);
+  g_assert_cmpint (get_x (second), >, x);
+  x = get_x (second);
+
+  gtk_widget_set_hexpand (first, TRUE);
+  allocate (box);
+  g_assert_cmpint (get_x (second), >, x);
+  x = get_x (second);
+
+  gtk_widget_hide (first);
+  allocate (box);
+  g_assert_cmpint (get_x (second), ==, 0);
+
+  g_object_unref (box);
+}
+
+/* Changes to the layout itself redo it too */
+static void
+test_layout_changes (void)
+{
+  GtkWidget *box, *first, *second;
+  int x;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box);
+  first = gtk_label_new ("first");
+  second = gtk_label_new ("second");
+  gtk_container_add (GTK_CONTAINER (box), first);
+  gtk_container_add (GTK_CONTAINER (box), second);
+
+  allocate (box);
+  x = get_x (second);
+
+  gtk_box_set_spacing (GTK_BOX (box), 10);
+  allocate (box);
+  g_assert_cmpint (get_x (second), ==, x + 10);
+
+  gtk_box_reorder_child_after (GTK_BOX (box), second, NULL);
+  allocate (box);
+  g_assert_cmpint (get_x (second), ==, 0);
+  g_assert_cmpint (get_x (first), >, 0);
+
+  g_object_unref (box);
+}
+
+static int
+measure (GtkWidget      *widget,
+         GtkOrientation  orientation,
+         int             for_size)
+{
+  int minimum, natural;
+
+  gtk_widget_measure (widget, orientation, for_size, &minimum, &natural, NULL, NULL);
+
+  return natural;
+}
+
+/* The layouts keep what the children requested between measure
+ * calls, until the children change */
+static void
+test_request_caches (void)
+{
+  GtkWidget *box, *grid, *label;
+  int width, height;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box);
+  label = gtk_label_new ("label");
+  gtk_container_add (GTK_CONTAINER (box), label);
+  gtk_container_add (GTK_CONTAINER (box), gtk_label_new ("other label"));
+
+  height = measure (box, GTK_ORIENTATION_VERTICAL, WIDTH);
+  g_assert_cmpint (measure (box, GTK_ORIENTATION_VERTICAL, WIDTH / 2), ==, height);
+
+  gtk_label_set_text (GTK_LABEL (label), "a\nlabel\nwith\nlines");
+  g_assert_cmpint (measure (box, GTK_ORIENTATION_VERTICAL, WIDTH), >, height);
+
+  g_object_unref (box);
+
+  grid = gtk_grid_new ();
+  g_object_ref_sink (grid);
+  label = gtk_label_new ("label");
+  gtk_grid_attach (GTK_GRID (grid), label, 0, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (grid), gtk_label_new ("other label"), 1, 0, 1, 1);
+
+  width = measure (grid, GTK_ORIENTATION_HORIZONTAL, -1);
+  allocate (grid);
+  g_assert_cmpint (measure (grid, GTK_ORIENTATION_HORIZONTAL, -1), ==, width);
+
+  gtk_label_set_text (GTK_LABEL (label), "a much longer label");
+  g_assert_cmpint (measure (grid, GTK_ORIENTATION_HORIZONTAL, -1), >, width);
+  width = measure (grid, GTK_ORIENTATION_HORIZONTAL, -1);
+
+  gtk_grid_set_column_spacing (GTK_GRID (grid), 10);
+  g_assert_cmpint (measure (grid, GTK_ORIENTATION_HORIZONTAL, -1), ==, width + 10);
+
+  g_object_unref (grid);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/layoutmanager/child-changes", test_child_changes);
+  g_test_add_func ("/layoutmanager/layout-changes", test_layout_changes);
+  g_test_add_func ("/layoutmanager/request-caches", test_request_caches);
+
+  return g_test_run ();
+}
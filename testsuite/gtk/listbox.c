@@ -434,6 +434,73 @@ test_header (void)
   g_object_unref (list);
 }
 
+static GtkWidget *
+create_label (gpointer item,
+              gpointer user_data)
+{
+  return gtk_label_new ("Item");
+}
+
+static guint
+count_children (GtkWidget *widget)
+{
+  GList *children;
+  guint n;
+
+  children = gtk_container_get_children (GTK_CONTAINER (widget));
+  n = g_list_length (children);
+  g_list_free (children);
+
+  return n;
+}
+
+static void
+test_bind_model (void)
+{
+  GtkWidget *viewport;
+  GtkListBox *list;
+  GListStore *store;
+  gint i;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  for (i = 0; i < 1000; i++)
+    {
+      GObject *item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  /* Without a scrollable parent, all rows are created right away */
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  g_object_ref_sink (list);
+  gtk_list_box_bind_model (list, G_LIST_MODEL (store), create_label, NULL, NULL);
+  g_assert_cmpuint (count_children (GTK_WIDGET (list)), ==, 1000);
+
+  g_list_store_remove (store, 0);
+  g_assert_cmpuint (count_children (GTK_WIDGET (list)), ==, 999);
+  g_object_unref (list);
+
+  /* Inside a viewport, rows are only created when needed */
+  viewport = gtk_viewport_new (NULL, NULL);
+  g_object_ref_sink (viewport);
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  gtk_container_add (GTK_CONTAINER (viewport), GTK_WIDGET (list));
+  gtk_list_box_bind_model (list, G_LIST_MODEL (store), create_label, NULL, NULL);
+  g_assert_cmpuint (count_children (GTK_WIDGET (list)), <, 999);
+
+  g_assert_nonnull (gtk_list_box_get_row_at_index (list, 99));
+  g_assert_cmpuint (count_children (GTK_WIDGET (list)), >=, 100);
+  g_assert_null (gtk_list_box_get_row_at_index (list, 999));
+
+  g_list_store_remove (store, 0);
+  g_assert_nonnull (gtk_list_box_get_row_at_index (list, 997));
+  g_assert_null (gtk_list_box_get_row_at_index (list, 998));
+  g_assert_cmpuint (count_children (GTK_WIDGET (list)), ==, 998);
+
+  g_object_unref (viewport);
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -444,6 +511,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
   g_test_add_func ("/listbox/header", test_header);
+  g_test_add_func ("/listbox/bind-model", test_bind_model);
 
   return g_test_run ();
 }
@@ -472,6 +472,44 @@ list_store_set_gvalue_to_transform (void)
   gtk_list_store_set_value (store, &iter, 0, &value);
 }
 
+static void
+list_store_set_last_column_first (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gchar *text;
+  gint number;
+  GObject *object;
+  GObject *got_object;
+
+  store = gtk_list_store_new (3, G_TYPE_STRING, G_TYPE_INT, G_TYPE_OBJECT);
+  object = g_object_new (G_TYPE_OBJECT, NULL);
+
+  /* Cells that were never set read as empty */
+  gtk_list_store_insert_with_values (store, &iter, -1, 2, object, -1);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &text, 1, &number, 2, &got_object, -1);
+  g_assert (text == NULL);
+  g_assert_cmpint (number, ==, 0);
+  g_assert (got_object == object);
+  g_object_unref (got_object);
+
+  gtk_list_store_set (store, &iter, 0, "text", 1, 42, -1);
+  gtk_list_store_set (store, &iter, 0, "other text", -1);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &text, 1, &number, -1);
+  g_assert_cmpstr (text, ==, "other text");
+  g_assert_cmpint (number, ==, 42);
+  g_free (text);
+
+  /* Removing the row drops its references */
+  g_object_add_weak_pointer (object, (gpointer *) &object);
+  g_object_unref (object);
+  g_assert (object != NULL);
+  gtk_list_store_remove (store, &iter);
+  g_assert (object == NULL);
+
+  g_object_unref (store);
+}
+
 /* removal */
 static void
 list_store_test_remove_begin (ListStore     *fixture,
@@ -1037,6 +1075,8 @@ register_list_store_tests (void)
   /* setting values (FIXME) */
   g_test_add_func ("/ListStore/set-gvalue-to-transform",
                    list_store_set_gvalue_to_transform);
+  g_test_add_func ("/ListStore/set-last-column-first",
+                   list_store_set_last_column_first);
 
   /* removal */
   g_test_add ("/ListStore/remove-begin", ListStore, NULL,
@@ -281,6 +281,73 @@ test_set_map_func (void)
   g_object_unref (map);
 }
 
+static gpointer
+map_count (gpointer item,
+           gpointer data)
+{
+  guint *count = data;
+
+  (*count)++;
+
+  return map_multiply (item, GUINT_TO_POINTER (1));
+}
+
+static void
+test_cache (void)
+{
+  GtkMapListModel *map;
+  GListStore *store;
+  gpointer item;
+  guint count = 0;
+
+  store = new_store (1, 5, 1);
+  map = gtk_map_list_model_new (G_TYPE_OBJECT, G_LIST_MODEL (store), map_count, &count, NULL);
+
+  item = g_list_model_get_item (G_LIST_MODEL (map), 2);
+  g_object_unref (item);
+  item = g_list_model_get_item (G_LIST_MODEL (map), 2);
+  g_object_unref (item);
+  g_assert_cmpuint (count, ==, 1);
+
+  g_list_store_remove (store, 1);
+  item = g_list_model_get_item (G_LIST_MODEL (map), 1);
+  g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)), ==, 3);
+  g_object_unref (item);
+  g_assert_cmpuint (count, ==, 1);
+
+  g_list_store_remove (store, 1);
+  item = g_list_model_get_item (G_LIST_MODEL (map), 1);
+  g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)), ==, 4);
+  g_object_unref (item);
+  g_assert_cmpuint (count, ==, 2);
+
+  g_object_unref (store);
+  g_object_unref (map);
+}
+
+static void
+test_changes (void)
+{
+  GtkMapListModel *map;
+  GListStore *store;
+
+  store = new_store (1, 5, 1);
+  map = new_model (store);
+  assert_model (map, "2 4 6 8 10");
+  assert_changes (map, "");
+
+  g_list_store_remove (store, 3);
+  assert_model (map, "2 4 6 10");
+  assert_changes (map, "-3");
+
+  g_list_store_remove (store, 0);
+  assert_model (map, "4 6 10");
+  assert_changes (map, "-0");
+
+  g_object_unref (store);
+  g_object_unref (map);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -294,6 +361,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/maplistmodel/create", test_create);
   g_test_add_func ("/maplistmodel/set-model", test_set_model);
   g_test_add_func ("/maplistmodel/set-map-func", test_set_map_func);
+  g_test_add_func ("/maplistmodel/cache", test_cache);
+  g_test_add_func ("/maplistmodel/changes", test_changes);
 
   return g_test_run ();
 }
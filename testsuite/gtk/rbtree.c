@@ -508,6 +508,83 @@ test_reorder (void)
   g_free (reorder);
 }
 
+static void
+test_fill (void)
+{
+  GtkTreeRBTree *tree, *children;
+  GtkTreeRBNode *node;
+  guint n, i;
+
+  for (n = 1; n <= 100; n++)
+    {
+      tree = gtk_tree_rbtree_new ();
+      gtk_tree_rbtree_fill (tree, n, 10, n % 2);
+      gtk_tree_rbtree_test (tree);
+      g_assert (tree->root->count == n);
+      g_assert (tree->root->total_count == n);
+      g_assert (tree->root->offset == n * 10);
+      g_assert (GTK_TREE_RBNODE_FLAG_SET (tree->root, GTK_TREE_RBNODE_DESCENDANTS_INVALID) == !(n % 2));
+
+      /* The tree must keep working as a normal tree */
+      node = gtk_tree_rbtree_find_count (tree, n / 2 + 1);
+      gtk_tree_rbtree_insert_after (tree, node, 5, TRUE);
+      gtk_tree_rbtree_test (tree);
+      gtk_tree_rbtree_remove_node (tree, gtk_tree_rbtree_first (tree));
+      gtk_tree_rbtree_test (tree);
+      g_assert (tree->root->count == n);
+
+      gtk_tree_rbtree_free (tree);
+    }
+
+  /* Filling a child tree updates its parents */
+  tree = create_rbtree (1, 5, TRUE);
+  node = gtk_tree_rbtree_find_count (tree, 3);
+  children = gtk_tree_rbtree_new ();
+  children->parent_tree = tree;
+  children->parent_node = node;
+  node->children = children;
+  gtk_tree_rbtree_fill (children, 20, 1, FALSE);
+  gtk_tree_rbtree_test (tree);
+  g_assert (tree->root->total_count == 25);
+  g_assert (tree->root->offset == 15 + 20);
+  g_assert (GTK_TREE_RBNODE_FLAG_SET (tree->root, GTK_TREE_RBNODE_DESCENDANTS_INVALID));
+
+  for (node = gtk_tree_rbtree_first (children), i = 0;
+       node != NULL;
+       node = gtk_tree_rbtree_next (children, node), i++)
+    g_assert (GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID));
+  g_assert (i == 20);
+
+  gtk_tree_rbtree_free (tree);
+}
+
+static void
+test_set_fixed_height (void)
+{
+  GtkTreeRBTree *tree;
+
+  tree = create_rbtree (3, 5, TRUE);
+  gtk_tree_rbtree_mark_invalid (tree);
+  gtk_tree_rbtree_test (tree);
+
+  gtk_tree_rbtree_set_fixed_height (tree, 10, FALSE);
+  gtk_tree_rbtree_test (tree);
+  g_assert (tree->root->offset == 155 * 10);
+  g_assert (GTK_TREE_RBNODE_FLAG_SET (tree->root, GTK_TREE_RBNODE_DESCENDANTS_INVALID));
+
+  gtk_tree_rbtree_set_fixed_height (tree, 20, TRUE);
+  gtk_tree_rbtree_test (tree);
+  g_assert (tree->root->offset == 155 * 20);
+  g_assert (!GTK_TREE_RBNODE_FLAG_SET (tree->root, GTK_TREE_RBNODE_DESCENDANTS_INVALID));
+
+  /* Only invalid rows get the new height */
+  gtk_tree_rbtree_set_fixed_height (tree, 30, TRUE);
+  gtk_tree_rbtree_test (tree);
+  g_assert (tree->root->offset == 155 * 20);
+
+  gtk_tree_rbtree_free (tree);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -521,6 +598,8 @@ main (int   argc,
   g_test_add_func ("/rbtree/remove_node", test_remove_node);
   g_test_add_func ("/rbtree/remove_root", test_remove_root);
   g_test_add_func ("/rbtree/reorder", test_reorder);
+  g_test_add_func ("/rbtree/fill", test_fill);
+  g_test_add_func ("/rbtree/set_fixed_height", test_set_fixed_height);
 
   return g_test_run ();
 }
@@ -380,6 +380,60 @@ test_remove_items (void)
   g_object_unref (sort);
 }
 
+static void
+test_stable (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+
+  /* items that compare equal keep the order of the model */
+  store = new_store ((guint[]) { 1, 11, 21, 2, 12, 0 });
+  sort = new_model (store);
+  gtk_sort_list_model_set_sort_func (sort, compare_modulo, GUINT_TO_POINTER (10), NULL);
+  assert_model (sort, "1 11 21 2 12");
+  assert_changes (sort, "0-5+5");
+
+  splice (store, 1, 0, (guint[]) { 31 }, 1);
+  assert_model (sort, "1 31 11 21 2 12");
+  assert_changes (sort, "+1");
+
+  splice (store, 2, 1, NULL, 0);
+  assert_model (sort, "1 31 21 2 12");
+  assert_changes (sort, "-2");
+
+  gtk_sort_list_model_resort (sort);
+  assert_model (sort, "1 31 21 2 12");
+  assert_changes (sort, "0-5+5");
+
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+static void
+test_incremental (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+
+  store = new_store ((guint[]) { 4, 8, 2, 6, 10, 0 });
+  sort = new_model (NULL);
+  gtk_sort_list_model_set_incremental (sort, TRUE);
+  gtk_sort_list_model_set_sort_func (sort, compare, NULL, NULL);
+  gtk_sort_list_model_set_model (sort, G_LIST_MODEL (store));
+  assert_model (sort, "4 8 2 6 10");
+  assert_changes (sort, "0+5");
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (sort), >, 0);
+
+  while (gtk_sort_list_model_get_pending (sort) > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  assert_model (sort, "2 4 6 8 10");
+  assert_changes (sort, "0-4+4");
+
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -393,9 +447,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/sortlistmodel/create", test_create);
   g_test_add_func ("/sortlistmodel/set-model", test_set_model);
   g_test_add_func ("/sortlistmodel/set-sort-func", test_set_sort_func);
+  g_test_add_func ("/sortlistmodel/incremental", test_incremental);
 #if GLIB_CHECK_VERSION (2, 58, 0) /* g_list_store_splice() is broken before 2.58 */
   g_test_add_func ("/sortlistmodel/add_items", test_add_items);
   g_test_add_func ("/sortlistmodel/remove_items", test_remove_items);
+  g_test_add_func ("/sortlistmodel/stable", test_stable);
 #endif
 
   return g_test_run ();
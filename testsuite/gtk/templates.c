@@ -69,6 +69,29 @@ test_message_dialog_basic (void)
   gtk_widget_destroy (dialog);
 }
 
+/* Instances after the first one are built from the precompiled
+ * template, check they get the same children */
+static void
+test_message_dialog_instances (void)
+{
+  GtkWidget *dialog;
+  GtkWidget *area;
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      dialog = gtk_message_dialog_new (NULL, 0,
+                                       GTK_MESSAGE_INFO,
+                                       GTK_BUTTONS_CLOSE,
+                                       "Do it hard !");
+      area = gtk_message_dialog_get_message_area (GTK_MESSAGE_DIALOG (dialog));
+      g_assert (GTK_IS_BOX (area));
+      g_assert (gtk_widget_get_first_child (area) != NULL);
+      g_assert (gtk_dialog_get_widget_for_response (GTK_DIALOG (dialog), GTK_RESPONSE_CLOSE) != NULL);
+      gtk_widget_destroy (dialog);
+    }
+}
+
 static void
 test_about_dialog_basic (void)
 {
@@ -344,6 +367,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Template/GtkDialog/Basic", test_dialog_basic);
   g_test_add_func ("/Template/GtkDialog/OverrideProperty", test_dialog_override_property);
   g_test_add_func ("/Template/GtkMessageDialog/Basic", test_message_dialog_basic);
+  g_test_add_func ("/Template/GtkMessageDialog/Instances", test_message_dialog_instances);
   g_test_add_func ("/Template/GtkAboutDialog/Basic", test_about_dialog_basic);
   g_test_add_func ("/Template/GtkInfoBar/Basic", test_info_bar_basic);
   g_test_add_func ("/Template/GtkLockButton/Basic", test_lock_button_basic);
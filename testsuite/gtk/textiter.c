@@ -194,6 +194,61 @@ test_search (void)
   check_found_backward ("aa \303\200", "aa", 0, 0, 2, "aa");
 }
 
+static void
+test_search_many_lines (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter i, s, e, limit;
+  GString *haystack;
+  gboolean res;
+  int n;
+
+  /* enough lines that the text is searched in several parts */
+  haystack = g_string_new (NULL);
+  for (n = 0; n < 1000; n++)
+    g_string_append_printf (haystack, "line %03d\n", n);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, haystack->str, -1);
+
+  gtk_text_buffer_get_start_iter (buffer, &i);
+  res = gtk_text_iter_forward_search (&i, "line 600", 0, &s, &e, NULL);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 600 * 9);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 600 * 9 + 8);
+
+  res = gtk_text_iter_forward_search (&i, "LINE 999\n", GTK_TEXT_SEARCH_CASE_INSENSITIVE, &s, &e, NULL);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 999 * 9);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 1000 * 9);
+
+  /* the limit is checked against the end of the match */
+  gtk_text_buffer_get_iter_at_offset (buffer, &limit, 600 * 9 + 8);
+  res = gtk_text_iter_forward_search (&i, "line 600", 0, &s, &e, &limit);
+  g_assert (res);
+  gtk_text_iter_backward_char (&limit);
+  res = gtk_text_iter_forward_search (&i, "line 600", 0, &s, &e, &limit);
+  g_assert (!res);
+
+  /* searching starts at the iter */
+  gtk_text_iter_forward_char (&s);
+  res = gtk_text_iter_forward_search (&s, "line 600", 0, NULL, NULL, NULL);
+  g_assert (!res);
+
+  g_object_unref (buffer);
+  g_string_free (haystack, TRUE);
+}
+
+static void
+test_search_line_separators (void)
+{
+  /* a needle without a \n still can't span lines */
+  check_found_forward ("foo\rbar", "foo\r", 0, 0, 4, "foo\r");
+  check_found_forward ("foo\rbar", "bar", 0, 4, 7, "bar");
+  check_not_found ("foo\rbar", "o\rb", 0);
+  check_not_found ("foo\342\200\251bar", "o\342\200\251b", 0);
+}
+
 static void
 test_search_caseless (void)
 {
@@ -789,6 +844,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search Many Lines", test_search_many_lines);
+  g_test_add_func ("/TextIter/Search Line Separators", test_search_line_separators);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
@@ -155,7 +155,7 @@ create_sub_model_cb (gpointer item,
                      gpointer unused)
 {
   if (G_IS_LIST_MODEL (item))
-    return item;
+    return g_object_ref (item);
 
   return NULL;
 }
@@ -213,6 +213,34 @@ test_expand (void)
   g_object_unref (tree);
 }
 
+static void
+test_expand_all (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkTreeListRow *row;
+
+  assert_model (tree, "100");
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  g_assert_false (gtk_tree_list_row_get_expanded (row));
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "0-1+111");
+  g_assert_true (gtk_tree_list_row_get_expanded (row));
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_changes (tree, "");
+
+  gtk_tree_list_model_collapse_all (tree);
+  assert_model (tree, "100");
+  assert_changes (tree, "0-111+1");
+  g_assert_false (gtk_tree_list_row_get_expanded (row));
+
+  g_object_unref (row);
+  g_object_unref (tree);
+}
+
 static void
 test_remove_some (void)
 {
@@ -259,6 +287,7 @@ main (int argc, char *argv[])
   changes_quark = g_quark_from_static_string ("What did I see? Can I believe what I saw?");
 
   g_test_add_func ("/treelistmodel/expand", test_expand);
+  g_test_add_func ("/treelistmodel/expand_all", test_expand_all);
   g_test_add_func ("/treelistmodel/remove_some", test_remove_some);
 
   return g_test_run ();